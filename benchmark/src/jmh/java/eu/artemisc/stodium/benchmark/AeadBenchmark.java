@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2017 Project ArteMisc
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+package eu.artemisc.stodium.benchmark;
+
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Setup;
+
+import java.nio.ByteBuffer;
+
+import eu.artemisc.stodium.aead.AEAD;
+import eu.artemisc.stodium.exceptions.StodiumException;
+
+/**
+ * AeadBenchmark measures the combined mode encrypt and decrypt of every AEAD
+ * construction. aes256gcm fails its setup on CPUs without AES-NI.
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+public class AeadBenchmark {
+    public static class Input extends SizedState {
+        @Param({"aes256gcm", "chacha20poly1305", "chacha20poly1305_ietf", "xchacha20poly1305_ietf"})
+        public String primitive;
+
+        AEAD       aead;
+        ByteBuffer key;
+        ByteBuffer nonce;
+        ByteBuffer ad;
+        ByteBuffer plain;
+        ByteBuffer cipher;
+        ByteBuffer dstPlain;
+        ByteBuffer dstCipher;
+
+        @Setup
+        public void setup() throws StodiumException {
+            if ("aes256gcm".equals(primitive)) {
+                aead = AEAD.aesInstance();
+                if (aead == null) {
+                    throw new IllegalStateException("aes256gcm is not available on this CPU");
+                }
+            } else if ("chacha20poly1305".equals(primitive)) {
+                aead = AEAD.chachaInstance();
+            } else if ("chacha20poly1305_ietf".equals(primitive)) {
+                aead = AEAD.chachaIetfInstance();
+            } else {
+                aead = AEAD.xchachaIetfInstance();
+            }
+
+            key       = BufferKind.key(aead.keyBytes());
+            nonce     = BufferKind.key(aead.npubBytes());
+            ad        = kind.input(0);
+            plain     = kind.input(size);
+            dstPlain  = kind.output(size);
+            dstCipher = kind.output(size + aead.aBytes());
+
+            final ByteBuffer tmp = BufferKind.DIRECT.output(size + aead.aBytes());
+            aead.encrypt(tmp, BufferKind.DIRECT.copyOf(plain), ad, nonce, key);
+            cipher = kind.copyOf(tmp);
+        }
+    }
+
+    @Benchmark
+    public ByteBuffer encrypt(final Input in) throws StodiumException {
+        in.aead.encrypt(in.dstCipher, in.plain, in.ad, in.nonce, in.key);
+        return in.dstCipher;
+    }
+
+    @Benchmark
+    public boolean decrypt(final Input in) throws StodiumException {
+        return in.aead.decrypt(in.dstPlain, in.cipher, in.ad, in.nonce, in.key);
+    }
+}
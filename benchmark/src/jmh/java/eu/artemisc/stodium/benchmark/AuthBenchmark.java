@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2017 Project ArteMisc
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+package eu.artemisc.stodium.benchmark;
+
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Setup;
+
+import java.nio.ByteBuffer;
+
+import eu.artemisc.stodium.auth.Auth;
+import eu.artemisc.stodium.exceptions.StodiumException;
+
+/**
+ * AuthBenchmark measures mac and verify of every HMAC construction.
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+public class AuthBenchmark {
+    public static class Input extends SizedState {
+        @Param({"hmacsha256", "hmacsha512", "hmacsha512256"})
+        public String primitive;
+
+        Auth       auth;
+        ByteBuffer key;
+        ByteBuffer src;
+        ByteBuffer mac;
+        ByteBuffer dstMac;
+
+        @Setup
+        public void setup() throws StodiumException {
+            if ("hmacsha256".equals(primitive)) {
+                auth = Auth.HmacSha256Instance();
+            } else if ("hmacsha512".equals(primitive)) {
+                auth = Auth.HmacSha512Instance();
+            } else {
+                auth = Auth.HmacSha512256Instance();
+            }
+
+            key    = BufferKind.key(auth.keyBytes());
+            src    = kind.input(size);
+            dstMac = kind.output(auth.bytes());
+
+            final ByteBuffer tmp = BufferKind.DIRECT.output(auth.bytes());
+            auth.mac(tmp, BufferKind.DIRECT.copyOf(src), key);
+            mac = kind.copyOf(tmp);
+        }
+    }
+
+    @Benchmark
+    public ByteBuffer mac(final Input in) throws StodiumException {
+        in.auth.mac(in.dstMac, in.src, in.key);
+        return in.dstMac;
+    }
+
+    @Benchmark
+    public boolean verify(final Input in) throws StodiumException {
+        return in.auth.verify(in.mac, in.src, in.key);
+    }
+}
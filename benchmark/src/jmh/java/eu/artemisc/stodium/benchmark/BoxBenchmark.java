@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2017 Project ArteMisc
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+package eu.artemisc.stodium.benchmark;
+
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Setup;
+
+import java.nio.ByteBuffer;
+
+import eu.artemisc.stodium.box.Box;
+import eu.artemisc.stodium.exceptions.StodiumException;
+
+/**
+ * BoxBenchmark measures both Box constructions, with the key exchange done
+ * on every call (easy) and with a precomputed shared key (easyAfternm).
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+public class BoxBenchmark {
+    public static class Input extends SizedState {
+        @Param({"curve25519xsalsa20poly1305", "curve25519xchacha20poly1305"})
+        public String primitive;
+
+        Box        box;
+        ByteBuffer pub;
+        ByteBuffer priv;
+        ByteBuffer shared;
+        ByteBuffer nonce;
+        ByteBuffer plain;
+        ByteBuffer cipher;
+        ByteBuffer dstPlain;
+        ByteBuffer dstCipher;
+
+        @Setup
+        public void setup() throws StodiumException {
+            box = "curve25519xchacha20poly1305".equals(primitive)
+                    ? Box.curve25519xchacha20poly1305Instance()
+                    : Box.curve25519xsalsa20poly1305Instance();
+
+            pub    = BufferKind.DIRECT.output(box.publicBytes());
+            priv   = BufferKind.DIRECT.output(box.secretBytes());
+            shared = BufferKind.DIRECT.output(box.beforenmBytes());
+            box.keypair(pub, priv);
+            box.beforenm(shared, pub, priv);
+
+            nonce     = BufferKind.key(box.nonceBytes());
+            plain     = kind.input(size);
+            dstPlain  = kind.output(size);
+            dstCipher = kind.output(size + box.macBytes());
+
+            final ByteBuffer tmp = BufferKind.DIRECT.output(size + box.macBytes());
+            box.easyAfternm(tmp, BufferKind.DIRECT.copyOf(plain), nonce, shared);
+            cipher = kind.copyOf(tmp);
+        }
+    }
+
+    @Benchmark
+    public ByteBuffer easy(final Input in) throws StodiumException {
+        in.box.easy(in.dstCipher, in.plain, in.nonce, in.pub, in.priv);
+        return in.dstCipher;
+    }
+
+    @Benchmark
+    public boolean openEasy(final Input in) throws StodiumException {
+        return in.box.openEasy(in.dstPlain, in.cipher, in.nonce, in.pub, in.priv);
+    }
+
+    @Benchmark
+    public ByteBuffer easyAfternm(final Input in) throws StodiumException {
+        in.box.easyAfternm(in.dstCipher, in.plain, in.nonce, in.shared);
+        return in.dstCipher;
+    }
+
+    @Benchmark
+    public boolean openEasyAfternm(final Input in) throws StodiumException {
+        return in.box.openEasyAfternm(in.dstPlain, in.cipher, in.nonce, in.shared);
+    }
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2017 Project ArteMisc
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+package eu.artemisc.stodium.benchmark;
+
+import org.jetbrains.annotations.NotNull;
+
+import java.nio.ByteBuffer;
+import java.util.Random;
+
+/**
+ * BufferKind enumerates the kinds of ByteBuffer the benchmarks pass to the
+ * wrappers. Each kind takes a different path through stodium_get_buffer:
+ * direct buffers are used as-is, heap buffers are pinned or copied, and
+ * sliced buffers start at an unaligned address inside a larger allocation.
+ * <p>
+ * Destinations can never be read-only, so {@link #READONLY_HEAP} only affects
+ * the inputs; its outputs are regular heap buffers.
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+public enum BufferKind {
+    DIRECT {
+        @NotNull
+        @Override
+        public ByteBuffer output(final int size) {
+            return ByteBuffer.allocateDirect(size);
+        }
+    },
+    HEAP {
+        @NotNull
+        @Override
+        public ByteBuffer output(final int size) {
+            return ByteBuffer.allocate(size);
+        }
+    },
+    READONLY_HEAP {
+        @NotNull
+        @Override
+        public ByteBuffer output(final int size) {
+            return ByteBuffer.allocate(size);
+        }
+
+        @NotNull
+        @Override
+        public ByteBuffer copyOf(final @NotNull ByteBuffer src) {
+            return super.copyOf(src).asReadOnlyBuffer();
+        }
+    },
+    SLICED {
+        @NotNull
+        @Override
+        public ByteBuffer output(final int size) {
+            final ByteBuffer parent = ByteBuffer.allocateDirect(size + 2 * SLICE_OFFSET);
+            parent.position(SLICE_OFFSET);
+            parent.limit(SLICE_OFFSET + size);
+            return parent.slice();
+        }
+    };
+
+    /** Offset of a sliced buffer inside its parent; odd, to break alignment. */
+    static final int SLICE_OFFSET = 7;
+
+    /**
+     * output allocates a writable buffer of this kind.
+     *
+     * @param size the capacity of the buffer
+     * @return a buffer with its position at 0 and its limit at size
+     */
+    @NotNull
+    public abstract ByteBuffer output(final int size);
+
+    /**
+     * input allocates a buffer of this kind, filled with pseudo-random bytes.
+     * The contents are seeded, so every run hashes and encrypts the same data.
+     *
+     * @param size the capacity of the buffer
+     * @return a buffer with its position at 0 and its limit at size
+     */
+    @NotNull
+    public final ByteBuffer input(final int size) {
+        final byte[] data = new byte[size];
+        new Random(size).nextBytes(data);
+        return copyOf(ByteBuffer.wrap(data));
+    }
+
+    /**
+     * copyOf allocates a buffer of this kind holding the remaining bytes of
+     * src, e.g. to turn a ciphertext into the input of a decrypt benchmark.
+     *
+     * @param src the contents of the new buffer, its position is not changed
+     * @return a buffer with its position at 0 and its limit at src.remaining()
+     */
+    @NotNull
+    public ByteBuffer copyOf(final @NotNull ByteBuffer src) {
+        final ByteBuffer buffer = output(src.remaining());
+        buffer.put(src.duplicate());
+        buffer.flip();
+        return buffer;
+    }
+
+    /**
+     * key allocates a direct buffer of len random bytes, for keys, nonces
+     * and salts, which are kept constant across buffer kinds.
+     *
+     * @param len the length of the key
+     * @return the new key
+     */
+    @NotNull
+    public static ByteBuffer key(final int len) {
+        return DIRECT.input(len);
+    }
+}
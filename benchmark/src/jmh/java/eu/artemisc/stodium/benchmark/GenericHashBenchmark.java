@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2017 Project ArteMisc
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+package eu.artemisc.stodium.benchmark;
+
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.Setup;
+
+import java.nio.ByteBuffer;
+
+import eu.artemisc.stodium.NativeMultipart;
+import eu.artemisc.stodium.exceptions.StodiumException;
+import eu.artemisc.stodium.generichash.GenericHash;
+import eu.artemisc.stodium.hash.Hash;
+
+/**
+ * GenericHashBenchmark measures blake2b, keyed and unkeyed, as a single call
+ * and through the native multipart state.
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+public class GenericHashBenchmark {
+    public static class Input extends SizedState {
+        GenericHash hash;
+        ByteBuffer  key;
+        ByteBuffer  src;
+        ByteBuffer  dst;
+
+        @Setup
+        public void setup() {
+            hash = GenericHash.blake2bInstance();
+            key  = BufferKind.key(hash.keyBytes());
+            src  = kind.input(size);
+            dst  = kind.output(hash.bytes());
+        }
+    }
+
+    @Benchmark
+    public ByteBuffer hash(final Input in) throws StodiumException {
+        in.hash.hash(in.dst, in.src, null);
+        return in.dst;
+    }
+
+    @Benchmark
+    public ByteBuffer hashKeyed(final Input in) throws StodiumException {
+        in.hash.hash(in.dst, in.src, in.key);
+        return in.dst;
+    }
+
+    @Benchmark
+    public ByteBuffer multipartNative(final Input in) throws StodiumException {
+        final NativeMultipart<Hash> multipart = in.hash.initNative(null, in.hash.bytes());
+        try {
+            multipart.update(in.src);
+            multipart.doFinal(in.dst);
+        } finally {
+            multipart.close();
+        }
+        return in.dst;
+    }
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2017 Project ArteMisc
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+package eu.artemisc.stodium.benchmark;
+
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Setup;
+
+import java.nio.ByteBuffer;
+
+import eu.artemisc.stodium.Multipart;
+import eu.artemisc.stodium.NativeMultipart;
+import eu.artemisc.stodium.exceptions.StodiumException;
+import eu.artemisc.stodium.hash.Hash;
+
+/**
+ * HashBenchmark measures sha256 and sha512, as a single call and through the
+ * Java-side and native multipart states.
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+public class HashBenchmark {
+    public static class Input extends SizedState {
+        @Param({"sha256", "sha512"})
+        public String primitive;
+
+        Hash       hash;
+        ByteBuffer src;
+        ByteBuffer dst;
+
+        @Setup
+        public void setup() {
+            hash = "sha512".equals(primitive)
+                    ? Hash.sha512Instance()
+                    : Hash.sha256Instance();
+
+            src = kind.input(size);
+            dst = kind.output(hash.bytes());
+        }
+    }
+
+    @Benchmark
+    public ByteBuffer hash(final Input in) throws StodiumException {
+        in.hash.hash(in.dst, in.src);
+        return in.dst;
+    }
+
+    @Benchmark
+    public ByteBuffer multipart(final Input in) throws StodiumException {
+        final Multipart<Hash> multipart = in.hash.init();
+        try {
+            multipart.update(in.src);
+            multipart.doFinal(in.dst);
+        } finally {
+            multipart.close();
+        }
+        return in.dst;
+    }
+
+    @Benchmark
+    public ByteBuffer multipartNative(final Input in) throws StodiumException {
+        final NativeMultipart<Hash> multipart = in.hash.initNative();
+        try {
+            multipart.update(in.src);
+            multipart.doFinal(in.dst);
+        } finally {
+            multipart.close();
+        }
+        return in.dst;
+    }
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2017 Project ArteMisc
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+package eu.artemisc.stodium.benchmark;
+
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+
+import java.nio.ByteBuffer;
+
+import eu.artemisc.stodium.Stodium;
+import eu.artemisc.stodium.StodiumJNI;
+
+/**
+ * JniBenchmark measures the fixed costs that every wrapper pays, to separate
+ * the JNI overhead from the cost of the primitive itself: an empty native
+ * call, and the buffer checks done before each call.
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+public class JniBenchmark {
+    @State(Scope.Thread)
+    public static class Input {
+        ByteBuffer direct;
+        ByteBuffer heap;
+        ByteBuffer readOnly;
+
+        @Setup
+        public void setup() {
+            direct   = BufferKind.DIRECT.input(16);
+            heap     = BufferKind.HEAP.input(16);
+            readOnly = BufferKind.READONLY_HEAP.input(16);
+        }
+    }
+
+    @Benchmark
+    public int emptyNative() {
+        return StodiumJNI.stodium_pool_size();
+    }
+
+    @Benchmark
+    public ByteBuffer ensureUsableDirect(final Input in) {
+        return Stodium.ensureUsableByteBuffer(in.direct);
+    }
+
+    @Benchmark
+    public ByteBuffer ensureUsableHeap(final Input in) {
+        return Stodium.ensureUsableByteBuffer(in.heap);
+    }
+
+    @Benchmark
+    public ByteBuffer ensureUsableReadOnly(final Input in) {
+        return Stodium.ensureUsableByteBuffer(in.readOnly);
+    }
+}
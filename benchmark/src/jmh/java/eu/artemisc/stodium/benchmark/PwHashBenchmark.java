@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2017 Project ArteMisc
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+package eu.artemisc.stodium.benchmark;
+
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.BenchmarkMode;
+import org.openjdk.jmh.annotations.Mode;
+import org.openjdk.jmh.annotations.OutputTimeUnit;
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+
+import java.nio.ByteBuffer;
+import java.util.concurrent.TimeUnit;
+
+import eu.artemisc.stodium.exceptions.StodiumException;
+import eu.artemisc.stodium.pwhash.PwHash;
+
+/**
+ * PwHashBenchmark measures argon2i and scrypt at their interactive limits.
+ * The cost of a password hash does not depend on the password length, so
+ * only the buffer kind is varied, over a password of a typical length.
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.MILLISECONDS)
+public class PwHashBenchmark {
+    @State(Scope.Thread)
+    public static class Input {
+        @Param({"argon2i", "scrypt"})
+        public String primitive;
+
+        @Param({"DIRECT", "HEAP", "READONLY_HEAP", "SLICED"})
+        public BufferKind kind;
+
+        PwHash     pwHash;
+        ByteBuffer passwd;
+        ByteBuffer salt;
+        ByteBuffer dst;
+
+        @Setup
+        public void setup() {
+            pwHash = "scrypt".equals(primitive)
+                    ? PwHash.scryptInstance()
+                    : PwHash.argon2iInstance();
+
+            passwd = kind.input(16);
+            salt   = BufferKind.key(pwHash.saltBytes());
+            dst    = kind.output(32);
+        }
+    }
+
+    @Benchmark
+    public ByteBuffer hash(final Input in) throws StodiumException {
+        in.pwHash.hash(in.dst, in.passwd, in.salt);
+        return in.dst;
+    }
+}
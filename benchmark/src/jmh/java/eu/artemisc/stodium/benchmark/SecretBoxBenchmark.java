@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2017 Project ArteMisc
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+package eu.artemisc.stodium.benchmark;
+
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Setup;
+
+import java.nio.ByteBuffer;
+
+import eu.artemisc.stodium.exceptions.StodiumException;
+import eu.artemisc.stodium.secretbox.SecretBox;
+
+/**
+ * SecretBoxBenchmark measures easy and easyOpen of both SecretBox
+ * constructions.
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+public class SecretBoxBenchmark {
+    public static class Input extends SizedState {
+        @Param({"xsalsa20poly1305", "xchacha20poly1305"})
+        public String primitive;
+
+        SecretBox  box;
+        ByteBuffer key;
+        ByteBuffer nonce;
+        ByteBuffer plain;
+        ByteBuffer cipher;
+        ByteBuffer dstPlain;
+        ByteBuffer dstCipher;
+
+        @Setup
+        public void setup() throws StodiumException {
+            box = "xchacha20poly1305".equals(primitive)
+                    ? SecretBox.xchacha20poly1305Instance()
+                    : SecretBox.xsalsa20poly1305Instance();
+
+            key       = BufferKind.key(box.keyBytes());
+            nonce     = BufferKind.key(box.nonceBytes());
+            plain     = kind.input(size);
+            dstPlain  = kind.output(size);
+            dstCipher = kind.output(size + box.macBytes());
+
+            final ByteBuffer tmp = BufferKind.DIRECT.output(size + box.macBytes());
+            box.easy(tmp, BufferKind.DIRECT.copyOf(plain), nonce, key);
+            cipher = kind.copyOf(tmp);
+        }
+    }
+
+    @Benchmark
+    public ByteBuffer easy(final Input in) throws StodiumException {
+        in.box.easy(in.dstCipher, in.plain, in.nonce, in.key);
+        return in.dstCipher;
+    }
+
+    @Benchmark
+    public boolean easyOpen(final Input in) throws StodiumException {
+        return in.box.easyOpen(in.dstPlain, in.cipher, in.nonce, in.key);
+    }
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2017 Project ArteMisc
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+package eu.artemisc.stodium.benchmark;
+
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Setup;
+
+import java.nio.ByteBuffer;
+
+import eu.artemisc.stodium.exceptions.StodiumException;
+import eu.artemisc.stodium.shorthash.ShortHash;
+
+/**
+ * ShortHashBenchmark measures siphash24 and siphashx24. Short hashes are
+ * mostly used on small inputs, where the cost of the JNI call dominates.
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+public class ShortHashBenchmark {
+    public static class Input extends SizedState {
+        @Param({"siphash24", "siphashx24"})
+        public String primitive;
+
+        ShortHash  hash;
+        ByteBuffer key;
+        ByteBuffer src;
+        ByteBuffer dst;
+
+        @Setup
+        public void setup() {
+            hash = "siphashx24".equals(primitive)
+                    ? ShortHash.siphashx24Instance()
+                    : ShortHash.siphash24Instance();
+
+            key = BufferKind.key(hash.keyBytes());
+            src = kind.input(size);
+            dst = kind.output(hash.bytes());
+        }
+    }
+
+    @Benchmark
+    public ByteBuffer hash(final Input in) throws StodiumException {
+        in.hash.hash(in.dst, in.src, in.key);
+        return in.dst;
+    }
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2017 Project ArteMisc
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+package eu.artemisc.stodium.benchmark;
+
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.Setup;
+
+import java.nio.ByteBuffer;
+
+import eu.artemisc.stodium.exceptions.StodiumException;
+import eu.artemisc.stodium.sign.Sign;
+
+/**
+ * SignBenchmark measures detached ed25519 signatures and their verification.
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+public class SignBenchmark {
+    public static class Input extends SizedState {
+        Sign       sign;
+        ByteBuffer pub;
+        ByteBuffer priv;
+        ByteBuffer msg;
+        ByteBuffer sig;
+        ByteBuffer dstSig;
+
+        @Setup
+        public void setup() throws StodiumException {
+            sign = Sign.ed25519Instance();
+
+            pub  = BufferKind.DIRECT.output(sign.publicKeyBytes());
+            priv = BufferKind.DIRECT.output(sign.secretKeyBytes());
+            sign.keypair(pub, priv);
+
+            msg    = kind.input(size);
+            dstSig = kind.output(sign.bytes());
+
+            final ByteBuffer tmp = BufferKind.DIRECT.output(sign.bytes());
+            sign.signDetached(tmp, BufferKind.DIRECT.copyOf(msg), priv);
+            sig = kind.copyOf(tmp);
+        }
+    }
+
+    @Benchmark
+    public ByteBuffer signDetached(final Input in) throws StodiumException {
+        in.sign.signDetached(in.dstSig, in.msg, in.priv);
+        return in.dstSig;
+    }
+
+    @Benchmark
+    public boolean verifyDetached(final Input in) throws StodiumException {
+        return in.sign.verifyDetached(in.sig, in.msg, in.pub);
+    }
+}
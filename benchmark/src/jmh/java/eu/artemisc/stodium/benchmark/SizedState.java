@@ -0,0 +1,28 @@
+/*
+ * Copyright (c) 2017 Project ArteMisc
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+package eu.artemisc.stodium.benchmark;
+
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.State;
+
+/**
+ * SizedState holds the parameters shared by the benchmarks that work on
+ * messages: the message size and the kind of buffer the message is in.
+ * Benchmarks extend it with their own setup.
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+@State(Scope.Thread)
+public abstract class SizedState {
+    @Param({"16", "256", "4096", "65536", "1048576", "16777216"})
+    public int size;
+
+    @Param({"DIRECT", "HEAP", "READONLY_HEAP", "SLICED"})
+    public BufferKind kind;
+}
@@ -37,6 +37,15 @@ ifeq ($(MY_ARCH_FOLDER),mips64)
     MY_ARCH_FOLDER = mips64r6
 endif
 
+# libsodium selects its AES-NI, AVX2, AVX-512 and NEON implementations at
+# runtime, in sodium_init (see CpuFeatures), so one archive per ABI runs the
+# fastest code on every device. The folder only sets the baseline the rest of
+# libsodium is compiled for, and can be overridden for a specific build:
+#   ndk-build SODIUM_ARCH_FOLDER=armv8-a
+ifdef SODIUM_ARCH_FOLDER
+    MY_ARCH_FOLDER = $(SODIUM_ARCH_FOLDER)
+endif
+
 
 include $(CLEAR_VARS)
 LOCAL_MODULE     := sodium
@@ -51,13 +60,25 @@ include $(PREBUILT_STATIC_LIBRARY)
 include $(CLEAR_VARS)
 LOCAL_MODULE    := stodiumjni
 LOCAL_SRC_FILES :=  \
-	sodium_jni_buffer.c
+	sodium_jni_buffer.c \
+	stodium_codecs.c \
+	stodium_pool.c \
+	stodium_siphash.c \
+	stodium_stats.c
 APP_UNIFIED_HEADERS := true
 LOCAL_LDFLAGS   += -fPIC
 #LOCAL_LDLIBS   += -Wl,--no-warn-shared-textrel
 #LOCAL_DISABLE_FATAL_LINKER_WARNINGS := true
 LOCAL_CFLAGS    += -Wall -g -pedantic -Wno-variadic-macros -std=c99 #-v
 
+# The Stats counters are compiled out unless asked for:
+#   ndk-build STODIUM_STATS=1
+# Their 64-bit atomics need libatomic on some 32-bit ABIs.
+ifeq ($(STODIUM_STATS),1)
+    LOCAL_CFLAGS += -DSTODIUM_STATS=1
+    LOCAL_LDLIBS += -latomic
+endif
+
 LOCAL_C_INCLUDES += $(abspath $(LOCAL_PATH))/../libsodium/libsodium-android-$(MY_ARCH_FOLDER)/include ../libsodium/libsodium-android-$(MY_ARCH_FOLDER)/include/sodium /usr/local/include
 LOCAL_STATIC_LIBRARIES += sodium
 #LOCAL_LDFLAGS := -Wl,-Bsymbolic # to work around error "shared library text segment is not shareable"
@@ -0,0 +1,888 @@
+/**
+ * This file implements a standalone benchmark and fuzz harness for the buffer
+ * marshalling of sodium_jni_buffer.c. It starts a JVM through the invocation
+ * API, lets it load libstodiumjni (so that JNI_OnLoad runs as it would for
+ * an application), and then calls the exported entry points directly, with
+ * ByteBuffers made through JNI.
+ *
+ *   stodium_bench <classpath>                        benchmark
+ *   stodium_bench <classpath> fuzz [rounds [seed]]   fuzz, under -Xcheck:jni
+ *
+ * classpath holds the compiled eu.artemisc.stodium classes. The library is
+ * loaded from the directory of the copy linked into this program.
+ *
+ * The benchmark calls every entry point of the table below for every kind of
+ * buffer and a range of message sizes, and the same libsodium function on
+ * plain native memory. The difference is the cost of stodium_get_* and
+ * stodium_release_* (and the stats counters) for that number of buffer
+ * arguments. Times are in TSC cycles on x86, and in nanoseconds elsewhere.
+ *
+ * The fuzzer places the input and output windows at random positions, limits
+ * and slice offsets in direct, heap, read-only heap and sliced buffers, and
+ * checks the output against libsodium, and that no byte outside the output
+ * windows was written.
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+#define _GNU_SOURCE
+#include <dlfcn.h>
+#include <jni.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "sodium.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#define STODIUM_JNI(type, method) JNIEXPORT type JNICALL Java_eu_artemisc_stodium_StodiumJNI_##method
+
+/**
+ * The entry points of libstodiumjni that are measured or fuzzed.
+ */
+STODIUM_JNI(jint, stodium_1supports_1readonly_1heap) (JNIEnv *, jclass);
+STODIUM_JNI(void, randombytes_1buf) (JNIEnv *, jclass, jobject);
+STODIUM_JNI(jint, crypto_1hash_1sha256) (JNIEnv *, jclass, jobject, jobject);
+STODIUM_JNI(jint, crypto_1onetimeauth_1poly1305) (JNIEnv *, jclass, jobject, jobject, jobject);
+STODIUM_JNI(jint, crypto_1auth_1hmacsha256) (JNIEnv *, jclass, jobject, jobject, jobject);
+STODIUM_JNI(jint, crypto_1generichash_1blake2b) (JNIEnv *, jclass, jobject, jobject, jobject);
+STODIUM_JNI(jint, crypto_1secretbox_1xsalsa20poly1305_1easy) (JNIEnv *, jclass, jobject, jobject, jobject, jobject);
+STODIUM_JNI(jint, crypto_1secretbox_1xsalsa20poly1305_1detached_1gather) (JNIEnv *, jclass,
+        jobjectArray, jobject, jobjectArray, jobject, jobject);
+STODIUM_JNI(jint, crypto_1secretbox_1xsalsa20poly1305_1open_1detached_1gather) (JNIEnv *, jclass,
+        jobjectArray, jobjectArray, jobject, jobject, jobject);
+STODIUM_JNI(jint, crypto_1aead_1chacha20poly1305_1ietf_1encrypt) (JNIEnv *, jclass,
+        jobject, jobject, jobject, jobject, jobject);
+
+/** ****************************************************************************
+ *
+ * Timing and random numbers
+ *
+ **************************************************************************** */
+
+#if defined(__x86_64__) || defined(__i386__)
+#define STODIUM_BENCH_UNIT "cycles"
+static inline uint64_t stodium_bench_ticks(void) {
+    return (uint64_t) __rdtsc();
+}
+#else
+#define STODIUM_BENCH_UNIT "ns"
+static inline uint64_t stodium_bench_ticks(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+#endif
+
+/**
+ * stodium_bench_next is a xorshift64* generator, so that a failing fuzz round
+ * can be replayed from its seed.
+ */
+static uint64_t stodium_bench_next(uint64_t *state) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * UINT64_C(2685821657736338717);
+}
+
+static size_t stodium_bench_below(uint64_t *state, size_t bound) {
+    return bound == 0 ? 0 : (size_t) (stodium_bench_next(state) % bound);
+}
+
+static void stodium_bench_fill(uint64_t *state, unsigned char *dst, size_t len) {
+    size_t i;
+    for (i = 0; i < len; i++) {
+        dst[i] = (unsigned char) stodium_bench_next(state);
+    }
+}
+
+/** ****************************************************************************
+ *
+ * ByteBuffers
+ *
+ **************************************************************************** */
+
+/**
+ * The kinds of buffers passed to the entry points, as in the JMH benchmarks:
+ * direct, heap and read-only heap buffers, and slices of direct and heap
+ * buffers at an odd offset (a non-zero arrayOffset for the latter).
+ */
+#define STODIUM_BENCH_DIRECT        0
+#define STODIUM_BENCH_HEAP          1
+#define STODIUM_BENCH_READONLY_HEAP 2
+#define STODIUM_BENCH_SLICED_DIRECT 3
+#define STODIUM_BENCH_SLICED_HEAP   4
+#define STODIUM_BENCH_KINDS         5
+
+#define STODIUM_BENCH_SLICE_OFFSET 7
+
+static const char *const stodium_bench_kind_names[STODIUM_BENCH_KINDS] = {
+    "direct", "heap", "readonly-heap", "sliced-direct", "sliced-heap"
+};
+
+/**
+ * stodium_bench_jni holds the classes and methods used to make and inspect
+ * ByteBuffers. Read-only heap buffers are only passed to the native code if
+ * it can read them (readonly_heap); otherwise the Java side copies them to a
+ * direct buffer first, and they are benchmarked as heap buffers.
+ */
+typedef struct stodium_bench_jni {
+    JNIEnv   *jenv;
+    bool      readonly_heap;
+    jclass    byte_buffer;
+    jmethodID allocate;
+    jmethodID allocate_direct;
+    jmethodID as_read_only;
+    jmethodID slice;
+    jmethodID duplicate;
+    jmethodID clear;
+    jmethodID position;
+    jmethodID limit;
+    jmethodID put;
+    jmethodID get;
+} stodium_bench_jni;
+
+static bool stodium_bench_jni_init(stodium_bench_jni *jb, JNIEnv *jenv) {
+    jclass buffer = (*jenv)->FindClass(jenv, "java/nio/Buffer");
+    jb->jenv          = jenv;
+    jb->readonly_heap = Java_eu_artemisc_stodium_StodiumJNI_stodium_1supports_1readonly_1heap(jenv, NULL) != 0;
+    jb->byte_buffer = (*jenv)->FindClass(jenv, "java/nio/ByteBuffer");
+    if (buffer == NULL || jb->byte_buffer == NULL) {
+        return false;
+    }
+
+    jb->allocate        = (*jenv)->GetStaticMethodID(jenv, jb->byte_buffer, "allocate", "(I)Ljava/nio/ByteBuffer;");
+    jb->allocate_direct = (*jenv)->GetStaticMethodID(jenv, jb->byte_buffer, "allocateDirect", "(I)Ljava/nio/ByteBuffer;");
+    jb->as_read_only    = (*jenv)->GetMethodID(jenv, jb->byte_buffer, "asReadOnlyBuffer", "()Ljava/nio/ByteBuffer;");
+    jb->slice           = (*jenv)->GetMethodID(jenv, jb->byte_buffer, "slice", "()Ljava/nio/ByteBuffer;");
+    jb->duplicate       = (*jenv)->GetMethodID(jenv, jb->byte_buffer, "duplicate", "()Ljava/nio/ByteBuffer;");
+    jb->put             = (*jenv)->GetMethodID(jenv, jb->byte_buffer, "put", "([B)Ljava/nio/ByteBuffer;");
+    jb->get             = (*jenv)->GetMethodID(jenv, jb->byte_buffer, "get", "([B)Ljava/nio/ByteBuffer;");
+    jb->clear           = (*jenv)->GetMethodID(jenv, buffer, "clear", "()Ljava/nio/Buffer;");
+    jb->position        = (*jenv)->GetMethodID(jenv, buffer, "position", "(I)Ljava/nio/Buffer;");
+    jb->limit           = (*jenv)->GetMethodID(jenv, buffer, "limit", "(I)Ljava/nio/Buffer;");
+    return !(*jenv)->ExceptionCheck(jenv);
+}
+
+static void stodium_bench_release(stodium_bench_jni *jb, jobject obj) {
+    (*jb->jenv)->DeleteLocalRef(jb->jenv, obj);
+}
+
+/**
+ * stodium_bench_set calls a Buffer method taking an int and returning the
+ * buffer itself, and drops the returned reference.
+ */
+static void stodium_bench_set(stodium_bench_jni *jb, jobject buffer, jmethodID method, jint value) {
+    stodium_bench_release(jb, (*jb->jenv)->CallObjectMethod(jb->jenv, buffer, method, value));
+}
+
+/**
+ * stodium_bench_write copies len bytes of src to buffer, from index at, without
+ * moving its position.
+ */
+static void stodium_bench_write(stodium_bench_jni *jb, jobject buffer, size_t at,
+        const unsigned char *src, size_t len) {
+    JNIEnv    *jenv  = jb->jenv;
+    jbyteArray array = (*jenv)->NewByteArray(jenv, (jsize) len);
+    jobject    dup   = (*jenv)->CallObjectMethod(jenv, buffer, jb->duplicate);
+
+    (*jenv)->SetByteArrayRegion(jenv, array, 0, (jsize) len, (const jbyte *) src);
+    stodium_bench_release(jb, (*jenv)->CallObjectMethod(jenv, dup, jb->clear));
+    stodium_bench_set(jb, dup, jb->position, (jint) at);
+    stodium_bench_release(jb, (*jenv)->CallObjectMethod(jenv, dup, jb->put, array));
+    stodium_bench_release(jb, dup);
+    stodium_bench_release(jb, array);
+}
+
+/**
+ * stodium_bench_read copies len bytes of buffer, from index at, to dst.
+ */
+static void stodium_bench_read(stodium_bench_jni *jb, jobject buffer, size_t at,
+        unsigned char *dst, size_t len) {
+    JNIEnv    *jenv  = jb->jenv;
+    jbyteArray array = (*jenv)->NewByteArray(jenv, (jsize) len);
+    jobject    dup   = (*jenv)->CallObjectMethod(jenv, buffer, jb->duplicate);
+
+    stodium_bench_release(jb, (*jenv)->CallObjectMethod(jenv, dup, jb->clear));
+    stodium_bench_set(jb, dup, jb->position, (jint) at);
+    stodium_bench_release(jb, (*jenv)->CallObjectMethod(jenv, dup, jb->get, array));
+    (*jenv)->GetByteArrayRegion(jenv, array, 0, (jsize) len, (jbyte *) dst);
+    stodium_bench_release(jb, dup);
+    stodium_bench_release(jb, array);
+}
+
+/**
+ * stodium_bench_window is a buffer of some kind whose position and limit
+ * enclose a window of length bytes into a larger parent buffer. offset is the
+ * index of the window in the parent, total the capacity of the parent.
+ */
+typedef struct stodium_bench_window {
+    jobject parent;
+    jobject view;
+    size_t  offset;
+    size_t  length;
+    size_t  total;
+} stodium_bench_window;
+
+/**
+ * stodium_bench_new_window makes a window of len bytes, with before and after
+ * bytes around it, holding the total bytes of content. A read-only kind is
+ * made writable for outputs.
+ */
+static void stodium_bench_new_window(stodium_bench_jni *jb, stodium_bench_window *window,
+        int kind, bool output,
+        size_t before, size_t len, size_t after,
+        const unsigned char *content) {
+    JNIEnv *jenv  = jb->jenv;
+    const bool sliced = kind == STODIUM_BENCH_SLICED_DIRECT || kind == STODIUM_BENCH_SLICED_HEAP;
+    const bool direct = kind == STODIUM_BENCH_DIRECT || kind == STODIUM_BENCH_SLICED_DIRECT;
+    const size_t skip = sliced ? STODIUM_BENCH_SLICE_OFFSET : 0;
+    jobject view;
+
+    window->total  = skip + before + len + after;
+    window->offset = skip + before;
+    window->length = len;
+    window->parent = (*jenv)->CallStaticObjectMethod(jenv, jb->byte_buffer,
+            direct ? jb->allocate_direct : jb->allocate, (jint) window->total);
+    if (content != NULL) {
+        stodium_bench_write(jb, window->parent, 0, content, window->total);
+    }
+
+    if (sliced) {
+        jobject dup = (*jenv)->CallObjectMethod(jenv, window->parent, jb->duplicate);
+        stodium_bench_set(jb, dup, jb->position, (jint) skip);
+        view = (*jenv)->CallObjectMethod(jenv, dup, jb->slice);
+        stodium_bench_release(jb, dup);
+    } else {
+        view = (*jenv)->CallObjectMethod(jenv, window->parent, jb->duplicate);
+    }
+    if (kind == STODIUM_BENCH_READONLY_HEAP && !output && jb->readonly_heap) {
+        jobject read_only = (*jenv)->CallObjectMethod(jenv, view, jb->as_read_only);
+        stodium_bench_release(jb, view);
+        view = read_only;
+    }
+
+    stodium_bench_set(jb, view, jb->limit, (jint) (before + len));
+    stodium_bench_set(jb, view, jb->position, (jint) before);
+    window->view = view;
+}
+
+static void stodium_bench_free_window(stodium_bench_jni *jb, stodium_bench_window *window) {
+    stodium_bench_release(jb, window->view);
+    stodium_bench_release(jb, window->parent);
+}
+
+/** ****************************************************************************
+ *
+ * Benchmark
+ *
+ **************************************************************************** */
+
+/**
+ * The roles of the buffer arguments of an entry point: the message, an output
+ * of the message size plus extra bytes, or a fixed size input or output.
+ */
+#define STODIUM_BENCH_MSG       0
+#define STODIUM_BENCH_OUT       1
+#define STODIUM_BENCH_IN_FIXED  2
+#define STODIUM_BENCH_OUT_FIXED 3
+
+typedef struct stodium_bench_arg {
+    int    role;
+    size_t size;
+} stodium_bench_arg;
+
+/**
+ * stodium_bench_entry is a row of the benchmark: an entry point, called with
+ * ByteBuffers, and the libsodium function it wraps, called with the native
+ * pointers of the same arguments.
+ */
+typedef struct stodium_bench_entry {
+    const char        *name;
+    size_t             args;
+    stodium_bench_arg  arg[5];
+    void             (*jni)(JNIEnv *jenv, const jobject *args);
+    void             (*direct)(unsigned char *const *args, size_t len);
+} stodium_bench_entry;
+
+static void stodium_bench_jni_randombytes(JNIEnv *jenv, const jobject *a) {
+    Java_eu_artemisc_stodium_StodiumJNI_randombytes_1buf(jenv, NULL, a[0]);
+}
+static void stodium_bench_direct_randombytes(unsigned char *const *a, size_t len) {
+    randombytes_buf(a[0], len);
+}
+
+static void stodium_bench_jni_sha256(JNIEnv *jenv, const jobject *a) {
+    Java_eu_artemisc_stodium_StodiumJNI_crypto_1hash_1sha256(jenv, NULL, a[0], a[1]);
+}
+static void stodium_bench_direct_sha256(unsigned char *const *a, size_t len) {
+    crypto_hash_sha256(a[0], a[1], len);
+}
+
+static void stodium_bench_jni_poly1305(JNIEnv *jenv, const jobject *a) {
+    Java_eu_artemisc_stodium_StodiumJNI_crypto_1onetimeauth_1poly1305(jenv, NULL, a[0], a[1], a[2]);
+}
+static void stodium_bench_direct_poly1305(unsigned char *const *a, size_t len) {
+    crypto_onetimeauth_poly1305(a[0], a[1], len, a[2]);
+}
+
+static void stodium_bench_jni_hmacsha256(JNIEnv *jenv, const jobject *a) {
+    Java_eu_artemisc_stodium_StodiumJNI_crypto_1auth_1hmacsha256(jenv, NULL, a[0], a[1], a[2]);
+}
+static void stodium_bench_direct_hmacsha256(unsigned char *const *a, size_t len) {
+    crypto_auth_hmacsha256(a[0], a[1], len, a[2]);
+}
+
+static void stodium_bench_jni_blake2b(JNIEnv *jenv, const jobject *a) {
+    Java_eu_artemisc_stodium_StodiumJNI_crypto_1generichash_1blake2b(jenv, NULL, a[0], a[1], a[2]);
+}
+static void stodium_bench_direct_blake2b(unsigned char *const *a, size_t len) {
+    crypto_generichash_blake2b(a[0], 32, a[1], len, a[2], 32);
+}
+
+static void stodium_bench_jni_secretbox(JNIEnv *jenv, const jobject *a) {
+    Java_eu_artemisc_stodium_StodiumJNI_crypto_1secretbox_1xsalsa20poly1305_1easy(jenv, NULL, a[0], a[1], a[2], a[3]);
+}
+static void stodium_bench_direct_secretbox(unsigned char *const *a, size_t len) {
+    crypto_secretbox_easy(a[0], a[1], len, a[2], a[3]);
+}
+
+static void stodium_bench_jni_aead(JNIEnv *jenv, const jobject *a) {
+    Java_eu_artemisc_stodium_StodiumJNI_crypto_1aead_1chacha20poly1305_1ietf_1encrypt(jenv, NULL, a[0], a[1], a[2], a[3], a[4]);
+}
+static void stodium_bench_direct_aead(unsigned char *const *a, size_t len) {
+    crypto_aead_chacha20poly1305_ietf_encrypt(a[0], NULL, a[1], len, a[2], 16, NULL, a[3], a[4]);
+}
+
+/**
+ * The entry points are ordered by their number of buffer arguments.
+ * randombytes_buf goes through stodium_get_buffer, the others through
+ * stodium_get_critical_*. A row is all that is needed to add an entry point.
+ */
+static const stodium_bench_entry stodium_bench_entries[] = {
+    { "randombytes_buf", 1,
+        { { STODIUM_BENCH_OUT, 0 } },
+        stodium_bench_jni_randombytes, stodium_bench_direct_randombytes },
+    { "crypto_hash_sha256", 2,
+        { { STODIUM_BENCH_OUT_FIXED, 32 }, { STODIUM_BENCH_MSG, 0 } },
+        stodium_bench_jni_sha256, stodium_bench_direct_sha256 },
+    { "crypto_onetimeauth_poly1305", 3,
+        { { STODIUM_BENCH_OUT_FIXED, 16 }, { STODIUM_BENCH_MSG, 0 }, { STODIUM_BENCH_IN_FIXED, 32 } },
+        stodium_bench_jni_poly1305, stodium_bench_direct_poly1305 },
+    { "crypto_auth_hmacsha256", 3,
+        { { STODIUM_BENCH_OUT_FIXED, 32 }, { STODIUM_BENCH_MSG, 0 }, { STODIUM_BENCH_IN_FIXED, 32 } },
+        stodium_bench_jni_hmacsha256, stodium_bench_direct_hmacsha256 },
+    { "crypto_generichash_blake2b", 3,
+        { { STODIUM_BENCH_OUT_FIXED, 32 }, { STODIUM_BENCH_MSG, 0 }, { STODIUM_BENCH_IN_FIXED, 32 } },
+        stodium_bench_jni_blake2b, stodium_bench_direct_blake2b },
+    { "crypto_secretbox_easy", 4,
+        { { STODIUM_BENCH_OUT, 16 }, { STODIUM_BENCH_MSG, 0 }, { STODIUM_BENCH_IN_FIXED, 24 },
+          { STODIUM_BENCH_IN_FIXED, 32 } },
+        stodium_bench_jni_secretbox, stodium_bench_direct_secretbox },
+    { "crypto_aead_chacha20poly1305_ietf_encrypt", 5,
+        { { STODIUM_BENCH_OUT, 16 }, { STODIUM_BENCH_MSG, 0 }, { STODIUM_BENCH_IN_FIXED, 16 },
+          { STODIUM_BENCH_IN_FIXED, 12 }, { STODIUM_BENCH_IN_FIXED, 32 } },
+        stodium_bench_jni_aead, stodium_bench_direct_aead },
+};
+
+static const size_t stodium_bench_sizes[] = { 0, 64, 1024, 16384 };
+
+/**
+ * STODIUM_BENCH_FRAME is the number of calls made in one local frame. The
+ * entry points create local references (to backing arrays), which are only
+ * freed when the frame is popped, as no Java method returns in between.
+ */
+#define STODIUM_BENCH_FRAME 64
+#define STODIUM_BENCH_REPEAT 5
+
+static size_t stodium_bench_arg_size(const stodium_bench_arg *arg, size_t len) {
+    switch (arg->role) {
+    case STODIUM_BENCH_MSG: return len;
+    case STODIUM_BENCH_OUT: return len + arg->size;
+    default:                return arg->size;
+    }
+}
+
+/**
+ * stodium_bench_time returns the best mean time of a call to entry, over
+ * STODIUM_BENCH_REPEAT runs of iterations calls each, through JNI if args is
+ * not NULL, or directly on ptrs otherwise.
+ */
+static double stodium_bench_time(JNIEnv *jenv, const stodium_bench_entry *entry,
+        const jobject        *args,
+        unsigned char *const *ptrs,
+        size_t                len,
+        size_t                iterations) {
+    const size_t frames = (iterations + STODIUM_BENCH_FRAME - 1) / STODIUM_BENCH_FRAME;
+    double best = -1.0;
+    size_t run, i, j;
+
+    for (run = 0; run < STODIUM_BENCH_REPEAT; run++) {
+        const uint64_t start = stodium_bench_ticks();
+        for (i = 0; i < frames; i++) {
+            if (args != NULL) {
+                (*jenv)->PushLocalFrame(jenv, (jint) (2 * STODIUM_BENCH_FRAME * entry->args));
+                for (j = 0; j < STODIUM_BENCH_FRAME; j++) {
+                    entry->jni(jenv, args);
+                }
+                (*jenv)->PopLocalFrame(jenv, NULL);
+            } else {
+                for (j = 0; j < STODIUM_BENCH_FRAME; j++) {
+                    entry->direct(ptrs, len);
+                }
+            }
+        }
+        const double mean = (double) (stodium_bench_ticks() - start)
+                / (double) (frames * STODIUM_BENCH_FRAME);
+        if (best < 0.0 || mean < best) {
+            best = mean;
+        }
+    }
+    return best;
+}
+
+static void stodium_bench_run(stodium_bench_jni *jb) {
+    size_t e, s, a;
+    int kind;
+    uint64_t seed = 1;
+
+    printf("%-42s %4s %-14s %6s %12s %12s %12s %10s %10s\n",
+            "entry point", "args", "buffers", "bytes",
+            "jni/call", "direct/call", "overhead", "per-buffer", "jni/byte");
+    printf("(times in %s%s)\n", STODIUM_BENCH_UNIT,
+            jb->readonly_heap ? "" : "; read-only heap buffers are not readable natively, passed as heap");
+
+    for (e = 0; e < sizeof stodium_bench_entries / sizeof stodium_bench_entries[0]; e++) {
+        const stodium_bench_entry *entry = &stodium_bench_entries[e];
+        for (s = 0; s < sizeof stodium_bench_sizes / sizeof stodium_bench_sizes[0]; s++) {
+            const size_t len        = stodium_bench_sizes[s];
+            const size_t iterations = (size_t) (1u << 22) / (len + 256);
+            stodium_bench_window windows[5];
+            unsigned char *ptrs[5];
+            jobject args[5];
+            double direct;
+
+            for (a = 0; a < entry->args; a++) {
+                const size_t size = stodium_bench_arg_size(&entry->arg[a], len);
+                ptrs[a] = (unsigned char *) malloc(size + 1);
+                stodium_bench_fill(&seed, ptrs[a], size);
+            }
+            direct = stodium_bench_time(jb->jenv, entry, NULL, ptrs, len, iterations);
+
+            for (kind = 0; kind < STODIUM_BENCH_KINDS; kind++) {
+                double jni;
+                for (a = 0; a < entry->args; a++) {
+                    const int  role   = entry->arg[a].role;
+                    const bool output = role == STODIUM_BENCH_OUT || role == STODIUM_BENCH_OUT_FIXED;
+                    stodium_bench_new_window(jb, &windows[a], kind, output,
+                            0, stodium_bench_arg_size(&entry->arg[a], len), 0, NULL);
+                    stodium_bench_write(jb, windows[a].parent, windows[a].offset,
+                            ptrs[a], stodium_bench_arg_size(&entry->arg[a], len));
+                    args[a] = windows[a].view;
+                }
+
+                jni = stodium_bench_time(jb->jenv, entry, args, NULL, len, iterations);
+                printf("%-42s %4zu %-14s %6zu %12.1f %12.1f %12.1f %10.1f ",
+                        entry->name, entry->args, stodium_bench_kind_names[kind], len,
+                        jni, direct, jni - direct, (jni - direct) / (double) entry->args);
+                if (len > 0) {
+                    printf("%10.2f\n", jni / (double) len);
+                } else {
+                    printf("%10s\n", "-");
+                }
+
+                for (a = 0; a < entry->args; a++) {
+                    stodium_bench_free_window(jb, &windows[a]);
+                }
+            }
+
+            for (a = 0; a < entry->args; a++) {
+                free(ptrs[a]);
+            }
+        }
+    }
+}
+
+/** ****************************************************************************
+ *
+ * Fuzzer
+ *
+ **************************************************************************** */
+
+/**
+ * stodium_bench_fuzz_buffer is a randomly placed window, with a copy of the
+ * content of its parent, to check the parent against after the call.
+ */
+typedef struct stodium_bench_fuzz_buffer {
+    stodium_bench_window window;
+    int                  kind;
+    unsigned char       *content;
+} stodium_bench_fuzz_buffer;
+
+static void stodium_bench_fuzz_new(stodium_bench_jni *jb, uint64_t *rng,
+        stodium_bench_fuzz_buffer *buffer, bool output, size_t len) {
+    const size_t before = stodium_bench_below(rng, 40);
+    const size_t after  = stodium_bench_below(rng, 40);
+
+    buffer->kind    = (int) stodium_bench_below(rng, STODIUM_BENCH_KINDS);
+    buffer->content = (unsigned char *) malloc(STODIUM_BENCH_SLICE_OFFSET + before + len + after + 1);
+    stodium_bench_fill(rng, buffer->content, STODIUM_BENCH_SLICE_OFFSET + before + len + after);
+    stodium_bench_new_window(jb, &buffer->window, buffer->kind, output, before, len, after, buffer->content);
+}
+
+/**
+ * stodium_bench_fuzz_check reads back the parent of buffer, and checks that
+ * its window holds the bytes of expected (or is unchanged for NULL), and that
+ * every other byte is unchanged.
+ */
+static bool stodium_bench_fuzz_check(stodium_bench_jni *jb, const stodium_bench_fuzz_buffer *buffer,
+        const unsigned char *expected) {
+    const stodium_bench_window *window = &buffer->window;
+    const size_t len = window->length;
+    unsigned char *found = (unsigned char *) malloc(window->total + 1);
+    bool ok;
+
+    stodium_bench_read(jb, window->parent, 0, found, window->total);
+    ok = memcmp(found, buffer->content, window->offset) == 0 &&
+            memcmp(found + window->offset + len, buffer->content + window->offset + len,
+                    window->total - window->offset - len) == 0 &&
+            memcmp(found + window->offset, expected != NULL ? expected : buffer->content + window->offset, len) == 0;
+    free(found);
+    return ok;
+}
+
+static void stodium_bench_fuzz_free(stodium_bench_jni *jb, stodium_bench_fuzz_buffer *buffer) {
+    stodium_bench_free_window(jb, &buffer->window);
+    free(buffer->content);
+}
+
+/**
+ * stodium_bench_fuzz_input returns the content of the window of buffer.
+ */
+static const unsigned char *stodium_bench_fuzz_input(const stodium_bench_fuzz_buffer *buffer) {
+    return buffer->content + buffer->window.offset;
+}
+
+/**
+ * Fuzzes crypto_generichash_blake2b: an output window of 16 to 64 bytes
+ * (whose length is the length of the hash), a message, and an optional key.
+ */
+static bool stodium_bench_fuzz_blake2b(stodium_bench_jni *jb, uint64_t *rng) {
+    const size_t dlen  = crypto_generichash_blake2b_BYTES_MIN + stodium_bench_below(rng,
+            crypto_generichash_blake2b_BYTES_MAX - crypto_generichash_blake2b_BYTES_MIN + 1);
+    const size_t mlen  = stodium_bench_below(rng, 300);
+    const bool   keyed = stodium_bench_below(rng, 2) == 0;
+    const size_t klen  = keyed ? crypto_generichash_blake2b_KEYBYTES_MIN + stodium_bench_below(rng,
+            crypto_generichash_blake2b_KEYBYTES_MAX - crypto_generichash_blake2b_KEYBYTES_MIN + 1) : 0;
+    stodium_bench_fuzz_buffer dst, src, key;
+    unsigned char expected[crypto_generichash_blake2b_BYTES_MAX];
+    bool ok;
+
+    stodium_bench_fuzz_new(jb, rng, &dst, true, dlen);
+    stodium_bench_fuzz_new(jb, rng, &src, false, mlen);
+    if (keyed) {
+        stodium_bench_fuzz_new(jb, rng, &key, false, klen);
+    }
+
+    crypto_generichash_blake2b(expected, dlen, stodium_bench_fuzz_input(&src), mlen,
+            keyed ? stodium_bench_fuzz_input(&key) : NULL, klen);
+    ok = Java_eu_artemisc_stodium_StodiumJNI_crypto_1generichash_1blake2b(jb->jenv, NULL,
+            dst.window.view, src.window.view, keyed ? key.window.view : NULL) == 0;
+    ok = ok && stodium_bench_fuzz_check(jb, &dst, expected) && stodium_bench_fuzz_check(jb, &src, NULL);
+    if (!ok) {
+        printf("crypto_generichash_blake2b: dst %s/%zu src %s/%zu key %s/%zu\n",
+                stodium_bench_kind_names[dst.kind], dlen, stodium_bench_kind_names[src.kind], mlen,
+                keyed ? stodium_bench_kind_names[key.kind] : "null", klen);
+    }
+
+    stodium_bench_fuzz_free(jb, &dst);
+    stodium_bench_fuzz_free(jb, &src);
+    if (keyed) {
+        stodium_bench_fuzz_free(jb, &key);
+    }
+    return ok;
+}
+
+/**
+ * Fuzzes crypto_secretbox_easy with an output window that may be larger than
+ * the ciphertext; the bytes after the ciphertext must be left alone.
+ */
+static bool stodium_bench_fuzz_secretbox(stodium_bench_jni *jb, uint64_t *rng) {
+    const size_t mlen  = stodium_bench_below(rng, 300);
+    const size_t clen  = mlen + crypto_secretbox_MACBYTES;
+    const size_t extra = stodium_bench_below(rng, 2) == 0 ? 0 : stodium_bench_below(rng, 20);
+    stodium_bench_fuzz_buffer dst, src, nonce, key;
+    unsigned char *expected = (unsigned char *) malloc(clen + extra);
+    bool ok;
+
+    stodium_bench_fuzz_new(jb, rng, &dst, true, clen + extra);
+    stodium_bench_fuzz_new(jb, rng, &src, false, mlen);
+    stodium_bench_fuzz_new(jb, rng, &nonce, false, crypto_secretbox_NONCEBYTES);
+    stodium_bench_fuzz_new(jb, rng, &key, false, crypto_secretbox_KEYBYTES);
+
+    crypto_secretbox_easy(expected, stodium_bench_fuzz_input(&src), mlen,
+            stodium_bench_fuzz_input(&nonce), stodium_bench_fuzz_input(&key));
+    memcpy(expected + clen, stodium_bench_fuzz_input(&dst) + clen, extra);
+    ok = Java_eu_artemisc_stodium_StodiumJNI_crypto_1secretbox_1xsalsa20poly1305_1easy(jb->jenv, NULL,
+            dst.window.view, src.window.view, nonce.window.view, key.window.view) == 0;
+    ok = ok && stodium_bench_fuzz_check(jb, &dst, expected) &&
+            stodium_bench_fuzz_check(jb, &src, NULL) &&
+            stodium_bench_fuzz_check(jb, &nonce, NULL) &&
+            stodium_bench_fuzz_check(jb, &key, NULL);
+    if (!ok) {
+        printf("crypto_secretbox_easy: dst %s/%zu src %s/%zu nonce %s key %s\n",
+                stodium_bench_kind_names[dst.kind], clen + extra, stodium_bench_kind_names[src.kind], mlen,
+                stodium_bench_kind_names[nonce.kind], stodium_bench_kind_names[key.kind]);
+    }
+
+    stodium_bench_fuzz_free(jb, &dst);
+    stodium_bench_fuzz_free(jb, &src);
+    stodium_bench_fuzz_free(jb, &nonce);
+    stodium_bench_fuzz_free(jb, &key);
+    free(expected);
+    return ok;
+}
+
+#define STODIUM_BENCH_MAX_FRAGMENTS 6
+
+/**
+ * stodium_bench_fuzz_split splits len bytes over a random number of windows,
+ * some of them empty, and returns them as a ByteBuffer[].
+ */
+static jobjectArray stodium_bench_fuzz_split(stodium_bench_jni *jb, uint64_t *rng,
+        stodium_bench_fuzz_buffer *fragments, size_t *count, bool output, size_t len) {
+    JNIEnv *jenv = jb->jenv;
+    jobjectArray array;
+    size_t i, left = len;
+
+    *count = 1 + stodium_bench_below(rng, STODIUM_BENCH_MAX_FRAGMENTS);
+    array  = (*jenv)->NewObjectArray(jenv, (jsize) *count, jb->byte_buffer, NULL);
+    for (i = 0; i < *count; i++) {
+        const size_t n = i + 1 == *count ? left : stodium_bench_below(rng, left + 1);
+        stodium_bench_fuzz_new(jb, rng, &fragments[i], output, n);
+        (*jenv)->SetObjectArrayElement(jenv, array, (jsize) i, fragments[i].window.view);
+        left -= n;
+    }
+    return array;
+}
+
+/**
+ * stodium_bench_fuzz_check_split checks the windows of fragments against the
+ * consecutive bytes of expected (or that they are unchanged, for NULL).
+ */
+static bool stodium_bench_fuzz_check_split(stodium_bench_jni *jb,
+        const stodium_bench_fuzz_buffer *fragments, size_t count,
+        const unsigned char *expected) {
+    bool ok = true;
+    size_t i;
+    for (i = 0; i < count; i++) {
+        ok = stodium_bench_fuzz_check(jb, &fragments[i], expected) && ok;
+        if (expected != NULL) {
+            expected += fragments[i].window.length;
+        }
+    }
+    return ok;
+}
+
+static void stodium_bench_fuzz_free_split(stodium_bench_jni *jb, jobjectArray array,
+        stodium_bench_fuzz_buffer *fragments, size_t count) {
+    size_t i;
+    for (i = 0; i < count; i++) {
+        stodium_bench_fuzz_free(jb, &fragments[i]);
+    }
+    stodium_bench_release(jb, array);
+}
+
+/**
+ * Fuzzes the gather/scatter secretbox: the message and the ciphertext are
+ * split up differently, and must match crypto_secretbox_detached. The
+ * ciphertext is then opened over a third split, first with a forged tag,
+ * which must leave the output alone.
+ */
+static bool stodium_bench_fuzz_gather_secretbox(stodium_bench_jni *jb, uint64_t *rng) {
+    const size_t mlen = stodium_bench_below(rng, 400);
+    stodium_bench_fuzz_buffer srcs[STODIUM_BENCH_MAX_FRAGMENTS];
+    stodium_bench_fuzz_buffer dsts[STODIUM_BENCH_MAX_FRAGMENTS];
+    stodium_bench_fuzz_buffer opens[STODIUM_BENCH_MAX_FRAGMENTS];
+    stodium_bench_fuzz_buffer mac, nonce, key;
+    jobjectArray src_array, dst_array, open_array;
+    size_t nsrc, ndst, nopen, i, at;
+    unsigned char *message  = (unsigned char *) malloc(mlen + 1);
+    unsigned char *expected = (unsigned char *) malloc(mlen + 1);
+    unsigned char expected_mac[crypto_secretbox_MACBYTES];
+    unsigned char forged_mac[crypto_secretbox_MACBYTES];
+    bool ok;
+
+    src_array  = stodium_bench_fuzz_split(jb, rng, srcs, &nsrc, false, mlen);
+    dst_array  = stodium_bench_fuzz_split(jb, rng, dsts, &ndst, true, mlen);
+    open_array = stodium_bench_fuzz_split(jb, rng, opens, &nopen, true, mlen);
+    stodium_bench_fuzz_new(jb, rng, &mac, true, crypto_secretbox_MACBYTES);
+    stodium_bench_fuzz_new(jb, rng, &nonce, false, crypto_secretbox_NONCEBYTES);
+    stodium_bench_fuzz_new(jb, rng, &key, false, crypto_secretbox_KEYBYTES);
+
+    for (i = 0, at = 0; i < nsrc; i++) {
+        memcpy(message + at, stodium_bench_fuzz_input(&srcs[i]), srcs[i].window.length);
+        at += srcs[i].window.length;
+    }
+    crypto_secretbox_detached(expected, expected_mac, message, mlen,
+            stodium_bench_fuzz_input(&nonce), stodium_bench_fuzz_input(&key));
+
+    ok = Java_eu_artemisc_stodium_StodiumJNI_crypto_1secretbox_1xsalsa20poly1305_1detached_1gather(jb->jenv, NULL,
+            dst_array, mac.window.view, src_array, nonce.window.view, key.window.view) == 0;
+    ok = ok && stodium_bench_fuzz_check_split(jb, dsts, ndst, expected) &&
+            stodium_bench_fuzz_check(jb, &mac, expected_mac) &&
+            stodium_bench_fuzz_check_split(jb, srcs, nsrc, NULL);
+
+    if (ok) {
+        memcpy(forged_mac, expected_mac, sizeof forged_mac);
+        forged_mac[stodium_bench_below(rng, sizeof forged_mac)] ^= 1;
+        stodium_bench_write(jb, mac.window.parent, mac.window.offset, forged_mac, sizeof forged_mac);
+        ok = Java_eu_artemisc_stodium_StodiumJNI_crypto_1secretbox_1xsalsa20poly1305_1open_1detached_1gather(jb->jenv, NULL,
+                open_array, dst_array, mac.window.view, nonce.window.view, key.window.view) != 0 &&
+                stodium_bench_fuzz_check_split(jb, opens, nopen, NULL);
+
+        stodium_bench_write(jb, mac.window.parent, mac.window.offset, expected_mac, sizeof expected_mac);
+        ok = ok && Java_eu_artemisc_stodium_StodiumJNI_crypto_1secretbox_1xsalsa20poly1305_1open_1detached_1gather(jb->jenv, NULL,
+                open_array, dst_array, mac.window.view, nonce.window.view, key.window.view) == 0 &&
+                stodium_bench_fuzz_check_split(jb, opens, nopen, message);
+    }
+    if (!ok) {
+        printf("crypto_secretbox_detached_gather: %zu bytes, %zu source, %zu destination and %zu opened fragments\n",
+                mlen, nsrc, ndst, nopen);
+    }
+
+    stodium_bench_fuzz_free_split(jb, src_array, srcs, nsrc);
+    stodium_bench_fuzz_free_split(jb, dst_array, dsts, ndst);
+    stodium_bench_fuzz_free_split(jb, open_array, opens, nopen);
+    stodium_bench_fuzz_free(jb, &mac);
+    stodium_bench_fuzz_free(jb, &nonce);
+    stodium_bench_fuzz_free(jb, &key);
+    free(message);
+    free(expected);
+    return ok;
+}
+
+/**
+ * stodium_bench_fuzz runs rounds of every fuzz case, and returns the number
+ * of rounds that failed.
+ */
+static size_t stodium_bench_fuzz(stodium_bench_jni *jb, size_t rounds, uint64_t seed) {
+    static bool (*const cases[])(stodium_bench_jni *, uint64_t *) = {
+        stodium_bench_fuzz_blake2b,
+        stodium_bench_fuzz_secretbox,
+        stodium_bench_fuzz_gather_secretbox,
+    };
+    size_t round, c, failed = 0;
+
+    for (round = 0; round < rounds; round++) {
+        for (c = 0; c < sizeof cases / sizeof cases[0]; c++) {
+            // a round only depends on the seed, so a failure reproduces with the same seed
+            uint64_t rng = (seed + 1) * UINT64_C(0x9E3779B97F4A7C15) + round * 8 + c;
+            (*jb->jenv)->PushLocalFrame(jb->jenv, 256);
+            if (!cases[c](jb, &rng)) {
+                printf("  round %zu failed (seed %llu)\n", round, (unsigned long long) seed);
+                failed++;
+            }
+            (*jb->jenv)->PopLocalFrame(jb->jenv, NULL);
+            if ((*jb->jenv)->ExceptionCheck(jb->jenv)) {
+                (*jb->jenv)->ExceptionDescribe(jb->jenv);
+                return failed + 1;
+            }
+        }
+    }
+    return failed;
+}
+
+/** ****************************************************************************
+ *
+ * Main
+ *
+ **************************************************************************** */
+
+/**
+ * stodium_bench_library_dir returns the directory of the libstodiumjni linked
+ * into this program, so that the JVM loads that same copy (and runs its
+ * JNI_OnLoad) instead of another one on its library path. dladdr takes the
+ * function as a void *, which ISO C leaves to POSIX.
+ */
+static bool stodium_bench_library_dir(char *dst, size_t len) {
+    Dl_info info;
+    const char *slash;
+
+    if (dladdr(__extension__ (void *) &Java_eu_artemisc_stodium_StodiumJNI_crypto_1hash_1sha256, &info) == 0 ||
+            info.dli_fname == NULL || (slash = strrchr(info.dli_fname, '/')) == NULL ||
+            (size_t) (slash - info.dli_fname) >= len) {
+        return false;
+    }
+    memcpy(dst, info.dli_fname, (size_t) (slash - info.dli_fname));
+    dst[slash - info.dli_fname] = '\0';
+    return true;
+}
+
+int main(int argc, char **argv) {
+    const bool fuzz = argc > 2 && strcmp(argv[2], "fuzz") == 0;
+    char library_dir[4096];
+    char *class_path, *library_path;
+    JavaVMOption options[3];
+    JavaVMInitArgs init_args;
+    JavaVM *jvm;
+    JNIEnv *jenv;
+    jclass stodium;
+    stodium_bench_jni jb;
+    int status = 0;
+
+    if (argc < 2 || (argc > 2 && !fuzz)) {
+        fprintf(stderr, "usage: %s <classpath> [fuzz [rounds [seed]]]\n", argv[0]);
+        return 2;
+    }
+    if (sodium_init() < 0 || !stodium_bench_library_dir(library_dir, sizeof library_dir)) {
+        fprintf(stderr, "could not initialize libsodium or locate libstodiumjni\n");
+        return 1;
+    }
+
+    class_path   = (char *) malloc(strlen(argv[1]) + 32);
+    library_path = (char *) malloc(strlen(library_dir) + 32);
+    sprintf(class_path,   "-Djava.class.path=%s", argv[1]);
+    sprintf(library_path, "-Djava.library.path=%s", library_dir);
+    options[0].optionString = class_path;
+    options[1].optionString = library_path;
+    options[2].optionString = (char *) "-Xcheck:jni";
+
+    // -Xcheck:jni also reports JNI calls made inside a critical region
+    init_args.version            = JNI_VERSION_1_6;
+    init_args.nOptions           = fuzz ? 3 : 2;
+    init_args.options            = options;
+    init_args.ignoreUnrecognized = JNI_FALSE;
+    if (JNI_CreateJavaVM(&jvm, (void **) &jenv, &init_args) != JNI_OK) {
+        fprintf(stderr, "could not create the JVM\n");
+        return 1;
+    }
+
+    // GetStaticMethodID initializes StodiumJNI, which loads the library
+    stodium = (*jenv)->FindClass(jenv, "eu/artemisc/stodium/StodiumJNI");
+    if (stodium == NULL || (*jenv)->GetStaticMethodID(jenv, stodium, "stodium_init", "()I") == NULL ||
+            !stodium_bench_jni_init(&jb, jenv)) {
+        (*jenv)->ExceptionDescribe(jenv);
+        (*jvm)->DestroyJavaVM(jvm);
+        return 1;
+    }
+
+    if (fuzz) {
+        const size_t   rounds = argc > 3 ? (size_t) strtoull(argv[3], NULL, 10) : 10000;
+        const uint64_t seed   = argc > 4 ? (uint64_t) strtoull(argv[4], NULL, 10) : (uint64_t) time(NULL);
+        const size_t   failed = stodium_bench_fuzz(&jb, rounds, seed);
+        printf("%zu rounds, seed %llu: %zu failed\n", rounds, (unsigned long long) seed, failed);
+        status = failed == 0 ? 0 : 1;
+    } else {
+        stodium_bench_run(&jb);
+    }
+
+    (*jvm)->DestroyJavaVM(jvm);
+    free(class_path);
+    free(library_path);
+    return status;
+}
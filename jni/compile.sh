@@ -24,6 +24,6 @@ fi
 
 #sudo cp /usr/local/lib/libsodium.* /usr/lib
 
-gcc -I${JAVA_HOME}/include -I${JAVA_HOME}/include/linux sodium_jni_buffer.c -Wno-variadic-macros -shared -fPIC -L/usr/lib -lsodium -o $jnilib
+gcc -I${JAVA_HOME}/include -I${JAVA_HOME}/include/linux sodium_jni_buffer.c stodium_codecs.c stodium_pool.c stodium_siphash.c stodium_stats.c -Wno-variadic-macros -shared -fPIC -pthread -L/usr/lib -lsodium -o $jnilib
 sudo rm -f $destlib/$jnilib  
 sudo cp $jnilib $destlib
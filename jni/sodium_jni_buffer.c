@@ -6,52 +6,47 @@
  */
 
 // Required headers
+#include <errno.h>
 #include <jni.h>
+#include <pthread.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 #include "sodium.h"
+#include "stodium_codecs.h"
+#include "stodium_constants.h"
+#include "stodium_pool.h"
+#include "stodium_siphash.h"
+#include "stodium_stats.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 #define STODIUM_JNI(type, method) JNIEXPORT type JNICALL Java_eu_artemisc_stodium_StodiumJNI_##method
 
 /**
- * STODIUM_CONSTANT is a utility macro for crypto_primitive_sthsize() methods.
- * It can be used for every method that takes 0 arguments and returns a jint
- * value.
- *
- * @group:     the group the primitive belongs to (e.g. core, stream, aead)
- * @primitive: the name of the primitive (e.g. ed25519, blake2b)
- * @constant:  the name of the constant in lower case (e.g. inputbytes, constbytes)
- */
-#define STODIUM_CONSTANT(group, primitive, constant) \
-    STODIUM_JNI(jint, crypto_1##group##_1##primitive##_1##constant) (JNIEnv *jenv, jclass jcls) { \
-        return (jint) crypto_##group##_##primitive##_##constant (); }
-
-/**
- * STODIUM_CONSTANT_STR does the same as STODIUM_CONSTANT, except it returns a
- * Java String instead of a jint. Used for crypto_*_primitive() wrappers.
+ * STODIUM_CONSTANT_STR wraps the crypto_*_primitive() methods, returning a Java
+ * String. The numeric constants are listed in stodium_constants.h instead.
  */
 #define STODIUM_CONSTANT_STR(group) \
     STODIUM_JNI(jstring, crypto_1##group##_1primitive) (JNIEnv *jenv, jclass jcls) { \
         return (*jenv)->NewStringUTF(jenv, crypto_##group##_primitive ()); }
 
 /**
- * STODIUM_CONSTANT_HL does the same as STODIUM_CONSTANT, except it works for
- * High Level API's (without explicit implementation identifiers), excluding the
- * primitive from the argument list.
- */
-#define STODIUM_CONSTANT_HL(group, constant) \
-    STODIUM_JNI(jint, crypto_1##group##_1##constant) (JNIEnv *jenv, jclass jcls) { \
-        return (jint) crypto_##group##_##constant (); }
-
-/**
- * AS_INPUT, AS_OUTPUT, AS_INPUT_LEN and AS_OUTPUT_LEN are utility macros to
- * reduce the effort of writing casting code and buffer references in every
- * wrapper function.
+ * AS_INPUT, AS_OUTPUT and AS_INPUT_LEN are utility macros to reduce the effort
+ * of writing casting code and buffer references in every wrapper function.
+ *
+ * The optional output length arguments of libsodium (clen_p, mlen_p, etc.) are
+ * passed as NULL, as the lengths are already known on the Java side.
  */
 #define AS_INPUT(type, buffer)      ((const type *) (buffer.content + buffer.offset))
 #define AS_OUTPUT(type, buffer)     ((type *)       (buffer.content + buffer.offset))
 
 #define AS_INPUT_LEN(type, buffer)  ((type)   (buffer.capacity))
-#define AS_OUTPUT_LEN(type, buffer) ((type *) (buffer.capacity))
 
 /**
  * Beginning of the real C code.
@@ -67,24 +62,73 @@ extern "C" {
 static jclass    stodium_g_byte_buffer_class;
 static jmethodID stodium_g_byte_buffer_method_array;
 static jmethodID stodium_g_byte_buffer_method_array_offset;
-static jmethodID stodium_g_byte_buffer_method_remaining;
+static jmethodID stodium_g_byte_buffer_method_position;
+static jmethodID stodium_g_byte_buffer_method_limit;
+
+/**
+ * The field IDs below allow reading the state of a heap ByteBuffer without
+ * calling back into Java. They are implementation details of the JVM's
+ * java.nio classes, so they are looked up optionally: when one of them can not
+ * be found, the method IDs above are used instead.
+ */
+static jfieldID  stodium_g_buffer_field_position;
+static jfieldID  stodium_g_buffer_field_limit;
+static jfieldID  stodium_g_byte_buffer_field_hb;
+static jfieldID  stodium_g_byte_buffer_field_offset;
+
+/**
+ * The descriptor of a java.io.FileDescriptor, used to read files natively. It
+ * is optional as well: the Windows JVMs keep a handle instead.
+ */
+static jfieldID  stodium_g_file_descriptor_field_fd;
+
+/**
+ * STODIUM_CRITICAL_MAX_BYTES limits the size of heap buffers that are pinned
+ * with GetPrimitiveArrayCritical. Larger buffers would keep the garbage
+ * collector blocked for too long, and are copied instead.
+ */
+#ifndef STODIUM_CRITICAL_MAX_BYTES
+#define STODIUM_CRITICAL_MAX_BYTES (64 * 1024)
+#endif
+
+/**
+ * stodium_find_field looks up an optional field ID, clearing the pending
+ * NoSuchFieldError if the JVM does not have the field.
+ */
+static jfieldID stodium_find_field(JNIEnv *jenv, jclass jcls, const char *name, const char *sig) {
+    jfieldID field = (*jenv)->GetFieldID(jenv, jcls, name, sig);
+    if ((*jenv)->ExceptionCheck(jenv)) {
+        (*jenv)->ExceptionClear(jenv);
+        return NULL;
+    }
+    return field;
+}
 
 /**
  * JNI_OnLoad caches the methods called on indirect (backing array) versions of
  * ByteBuffers passed to Stodium methods, to avoid repreated calls to
- * GetMethodID.
+ * GetMethodID. The fields of Buffer and ByteBuffer are cached as well, where
+ * the JVM provides them.
  */
-jint JNI_OnLoad(JavaVM* jvm, void* reserved) {
+static bool stodium_register_constants(JNIEnv *jenv);
+
+JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM* jvm, void* reserved) {
     JNIEnv *jenv;
     if ((*jvm)->GetEnv(jvm, (void**)(&jenv), JNI_VERSION_1_6) != JNI_OK) {
         return -1;
     }
 
-    stodium_g_byte_buffer_class = (*jenv)->FindClass(jenv, "java/nio/ByteBuffer");
+    jclass byte_buffer_class = (*jenv)->FindClass(jenv, "java/nio/ByteBuffer");
     if ((*jenv)->ExceptionCheck(jenv)) {
         return -1;
     }
 
+    stodium_g_byte_buffer_class = (jclass) (*jenv)->NewGlobalRef(jenv, byte_buffer_class);
+    (*jenv)->DeleteLocalRef(jenv, byte_buffer_class);
+    if (stodium_g_byte_buffer_class == NULL) {
+        return -1;
+    }
+
     stodium_g_byte_buffer_method_array = (*jenv)->GetMethodID(jenv, stodium_g_byte_buffer_class, "array", "()[B");
     if ((*jenv)->ExceptionCheck(jenv)) {
         return -1;
@@ -95,11 +139,39 @@ jint JNI_OnLoad(JavaVM* jvm, void* reserved) {
         return -1;
     }
 
-    stodium_g_byte_buffer_method_remaining = (*jenv)->GetMethodID(jenv, stodium_g_byte_buffer_class, "remaining", "()I");
+    stodium_g_byte_buffer_method_position = (*jenv)->GetMethodID(jenv, stodium_g_byte_buffer_class, "position", "()I");
+    if ((*jenv)->ExceptionCheck(jenv)) {
+        return -1;
+    }
+
+    stodium_g_byte_buffer_method_limit = (*jenv)->GetMethodID(jenv, stodium_g_byte_buffer_class, "limit", "()I");
+    if ((*jenv)->ExceptionCheck(jenv)) {
+        return -1;
+    }
+
+    jclass buffer_class = (*jenv)->FindClass(jenv, "java/nio/Buffer");
+    if ((*jenv)->ExceptionCheck(jenv)) {
+        return -1;
+    }
+
+    stodium_g_buffer_field_position    = stodium_find_field(jenv, buffer_class, "position", "I");
+    stodium_g_buffer_field_limit       = stodium_find_field(jenv, buffer_class, "limit", "I");
+    stodium_g_byte_buffer_field_hb     = stodium_find_field(jenv, stodium_g_byte_buffer_class, "hb", "[B");
+    stodium_g_byte_buffer_field_offset = stodium_find_field(jenv, stodium_g_byte_buffer_class, "offset", "I");
+    (*jenv)->DeleteLocalRef(jenv, buffer_class);
+
+    jclass file_descriptor_class = (*jenv)->FindClass(jenv, "java/io/FileDescriptor");
     if ((*jenv)->ExceptionCheck(jenv)) {
         return -1;
     }
 
+    stodium_g_file_descriptor_field_fd = stodium_find_field(jenv, file_descriptor_class, "fd", "I");
+    (*jenv)->DeleteLocalRef(jenv, file_descriptor_class);
+
+    if (!stodium_register_constants(jenv)) {
+        return -1;
+    }
+
     return JNI_VERSION_1_6;
 }
 
@@ -114,13 +186,47 @@ typedef struct stodium_buffers {
     size_t         offset;
     size_t         capacity;
     bool           is_direct;
+    bool           is_critical;   // Only defined for the stodium_get_critical_* methods
+    jint           release_mode;  // Only defined for the stodium_get_critical_* methods
     jbyteArray     backing_array; // Only defined if the buffer was not direct
+    bool           is_copy;       // Whether content is a copy of the array made by the JVM
+    size_t         copied;        // Length of the array, if GetByteArrayElements copied it
 } stodium_buffer;
 
 /**
+ * stodium_get_bounds reads the position and limit of a ByteBuffer, from their
+ * fields if these were found during JNI_OnLoad, or by calling the Buffer
+ * methods otherwise.
+ */
+static void stodium_get_bounds(JNIEnv *jenv, jobject jbuffer, jint *position, jint *limit) {
+    if (stodium_g_buffer_field_position != NULL && stodium_g_buffer_field_limit != NULL) {
+        *position = (*jenv)->GetIntField(jenv, jbuffer, stodium_g_buffer_field_position);
+        *limit    = (*jenv)->GetIntField(jenv, jbuffer, stodium_g_buffer_field_limit);
+        return;
+    }
+
+    *position = (*jenv)->CallIntMethod(jenv, jbuffer, stodium_g_byte_buffer_method_position);
+    *limit    = (*jenv)->CallIntMethod(jenv, jbuffer, stodium_g_byte_buffer_method_limit);
+}
+
+/**
+ * stodium_resolve_buffer fills in the fields of dst, without making the array
+ * of a heap buffer available yet. The content of a heap buffer is left at 0,
+ * and has to be obtained by the caller.
  *
+ * Both direct and heap buffers are resolved to the region between their
+ * position and limit, so slices of a larger buffer can be passed by moving the
+ * position and limit instead of calling slice().
  */
-void stodium_get_buffer(JNIEnv *jenv, stodium_buffer *dst, jobject jbuffer) {
+static void stodium_resolve_buffer(JNIEnv *jenv, stodium_buffer *dst, jobject jbuffer) {
+    jint position, limit;
+
+    dst->is_critical   = false;
+    dst->release_mode  = 0;
+    dst->backing_array = NULL;
+    dst->is_copy       = false;
+    dst->copied        = 0;
+
     if (jbuffer == NULL) {
         dst->content   = 0;
         dst->offset    = 0;
@@ -131,24 +237,110 @@ void stodium_get_buffer(JNIEnv *jenv, stodium_buffer *dst, jobject jbuffer) {
 
     // FIXME can byte[] arrays be passed as jobjects? if so, we could support them as well
 
+    stodium_get_bounds(jenv, jbuffer, &position, &limit);
+    dst->capacity = (size_t) (limit - position);
+
     dst->content = (unsigned char *) (*jenv)->GetDirectBufferAddress(jenv, jbuffer);
     if (dst->content != NULL) {
-        dst->offset    = 0;
-        dst->capacity  = (size_t) (*jenv)->GetDirectBufferCapacity(jenv, jbuffer);
+        dst->offset    = (size_t) position;
         dst->is_direct = true;
         return;
     }
 
-    // indirect (backing array). HALP
-    // FIXME is isCopy is stored, we can explicitely call sodium_memzero on the
-    // FIXME copied data to avoid leaking sensitive data even in the event of a
-    // FIXME copied key value
+    dst->content   = 0;
+    dst->is_direct = false;
+
+    if (stodium_g_byte_buffer_field_hb != NULL && stodium_g_byte_buffer_field_offset != NULL) {
+        dst->backing_array = (jbyteArray) (*jenv)->GetObjectField(jenv, jbuffer, stodium_g_byte_buffer_field_hb);
+        dst->offset        = (size_t) ((*jenv)->GetIntField(jenv, jbuffer, stodium_g_byte_buffer_field_offset) + position);
+        return;
+    }
+
     dst->backing_array = (jbyteArray) (*jenv)->CallObjectMethod(jenv, jbuffer, stodium_g_byte_buffer_method_array);
-    dst->content       = (unsigned char *) (*jenv)->GetByteArrayElements(jenv, dst->backing_array, NULL);
-    dst->offset        = (size_t) (*jenv)->CallIntMethod(jenv, jbuffer, stodium_g_byte_buffer_method_array_offset);
-    dst->capacity      = (size_t) (*jenv)->CallIntMethod(jenv, jbuffer, stodium_g_byte_buffer_method_remaining);
-    dst->is_direct     = false;
-    return;
+    dst->offset        = (size_t) ((*jenv)->CallIntMethod(jenv, jbuffer, stodium_g_byte_buffer_method_array_offset) + position);
+}
+
+/**
+ * stodium_count_buffer counts a buffer passed to a wrapper as a direct or a
+ * heap buffer. Null buffers are not counted.
+ */
+static void stodium_count_buffer(jobject jbuffer, const stodium_buffer *buffer) {
+    if (jbuffer != NULL) {
+        STODIUM_STATS_ADD(buffer->is_direct ? STODIUM_STATS_DIRECT : STODIUM_STATS_INDIRECT, 1);
+    }
+}
+
+/**
+ * stodium_get_array_elements obtains the content of a heap buffer through
+ * GetByteArrayElements, counting the bytes if the JVM copied the array.
+ */
+static void stodium_get_array_elements(JNIEnv *jenv, stodium_buffer *dst) {
+    jboolean is_copy = JNI_FALSE;
+
+    dst->content = (unsigned char *) (*jenv)->GetByteArrayElements(jenv, dst->backing_array, &is_copy);
+    if (dst->content != 0 && is_copy) {
+        dst->is_copy = true;
+        dst->copied  = (size_t) (*jenv)->GetArrayLength(jenv, dst->backing_array);
+        STODIUM_STATS_ADD(STODIUM_STATS_COPIED, dst->copied);
+    }
+}
+
+/**
+ * stodium_release_array_elements releases the content obtained by
+ * stodium_get_array_elements. Releasing with mode 0 copies the array back.
+ *
+ * If the JVM made a copy, the copy is wiped before it is freed, so keys
+ * passed in heap buffers do not linger in native memory: the content is
+ * copied back with JNI_COMMIT first, then wiped and freed with JNI_ABORT.
+ */
+static void stodium_release_array_elements(JNIEnv *jenv, stodium_buffer *buffer, jint mode) {
+    if (!buffer->is_copy) {
+        (*jenv)->ReleaseByteArrayElements(jenv, buffer->backing_array, (jbyte *) (buffer->content), mode);
+        return;
+    }
+
+    if (mode == 0) {
+        (*jenv)->ReleaseByteArrayElements(jenv, buffer->backing_array, (jbyte *) (buffer->content), JNI_COMMIT);
+        STODIUM_STATS_ADD(STODIUM_STATS_COPIED, buffer->copied);
+    }
+    sodium_memzero(buffer->content, buffer->copied);
+    (*jenv)->ReleaseByteArrayElements(jenv, buffer->backing_array, (jbyte *) (buffer->content), JNI_ABORT);
+}
+
+/**
+ * stodium_release_critical releases an array pinned by stodium_critical_begin.
+ * If the JVM copied the array instead of pinning it, the copy is wiped like in
+ * stodium_release_array_elements. The length of the array cannot be asked for
+ * while it is held, so the copy is wiped up to the end of the buffer.
+ */
+static void stodium_release_critical(JNIEnv *jenv, stodium_buffer *buffer) {
+    if (!buffer->is_copy) {
+        (*jenv)->ReleasePrimitiveArrayCritical(jenv, buffer->backing_array, buffer->content, buffer->release_mode);
+        return;
+    }
+
+    if (buffer->release_mode == 0) {
+        (*jenv)->ReleasePrimitiveArrayCritical(jenv, buffer->backing_array, buffer->content, JNI_COMMIT);
+    }
+    sodium_memzero(buffer->content, buffer->offset + buffer->capacity);
+    (*jenv)->ReleasePrimitiveArrayCritical(jenv, buffer->backing_array, buffer->content, JNI_ABORT);
+}
+
+/**
+ * stodium_get_buffer makes the content of the ByteBuffer available to the
+ * native code. Heap buffers are accessed through GetByteArrayElements, which
+ * copies the array on most JVMs. This is the method to use for long running
+ * calls (e.g. pwhash), which should not block the garbage collector.
+ */
+void stodium_get_buffer(JNIEnv *jenv, stodium_buffer *dst, jobject jbuffer) {
+    stodium_resolve_buffer(jenv, dst, jbuffer);
+    stodium_count_buffer(jbuffer, dst);
+    if (dst->is_direct) {
+        return;
+    }
+
+    // indirect (backing array), copies are wiped on release
+    stodium_get_array_elements(jenv, dst);
 }
 
 /**
@@ -160,19 +352,273 @@ void stodium_release_output(JNIEnv *jenv, jobject output, stodium_buffer *buffer
     }
     
     // Release with copying of the native buffer
-    (*jenv)->ReleaseByteArrayElements(jenv, buffer->backing_array, (jbyte *) (buffer->content), 0);
+    stodium_release_array_elements(jenv, buffer, 0);
 }
 
 /**
  *
  */
 void stodium_release_input(JNIEnv *jenv, jobject output, stodium_buffer *buffer) {
+    STODIUM_STATS_ADD(STODIUM_STATS_BYTES, buffer->capacity);
     if (buffer->is_direct || buffer->content == 0) {
         return; // No need for copying or releasing
     }
 
     // Release without copying the native buffer
-    (*jenv)->ReleaseByteArrayElements(jenv, buffer->backing_array, (jbyte *) (buffer->content), JNI_ABORT);
+    stodium_release_array_elements(jenv, buffer, JNI_ABORT);
+}
+
+/**
+ * stodium_get_critical_output and stodium_get_critical_input prepare a buffer
+ * for use between STODIUM_CRITICAL_BEGIN and STODIUM_CRITICAL_END. They only
+ * resolve the buffer; the array of a heap buffer is pinned by
+ * stodium_critical_begin, after all buffers of the call were resolved, as no
+ * other JNI methods may be called while a critical array is held.
+ *
+ * This is the method to use for short, non-blocking primitives (e.g. AEAD,
+ * auth, hash, shorthash).
+ */
+void stodium_get_critical_output(JNIEnv *jenv, stodium_buffer *dst, jobject jbuffer) {
+    stodium_resolve_buffer(jenv, dst, jbuffer);
+    stodium_count_buffer(jbuffer, dst);
+    dst->is_critical  = !dst->is_direct && dst->capacity <= STODIUM_CRITICAL_MAX_BYTES;
+    dst->release_mode = 0;
+}
+
+void stodium_get_critical_input(JNIEnv *jenv, stodium_buffer *dst, jobject jbuffer) {
+    stodium_resolve_buffer(jenv, dst, jbuffer);
+    stodium_count_buffer(jbuffer, dst);
+    STODIUM_STATS_ADD(STODIUM_STATS_BYTES, dst->capacity);
+    dst->is_critical  = !dst->is_direct && dst->capacity <= STODIUM_CRITICAL_MAX_BYTES;
+    dst->release_mode = JNI_ABORT;
+}
+
+/**
+ * stodium_critical_end releases the buffers obtained by stodium_critical_begin.
+ * The critical arrays are released first, as the copied arrays need a call to
+ * ReleaseByteArrayElements.
+ */
+void stodium_critical_end(JNIEnv *jenv, stodium_buffer **buffers, size_t count) {
+    size_t i;
+    for (i = count; i-- > 0;) {
+        if (buffers[i]->is_critical && buffers[i]->content != 0) {
+            stodium_release_critical(jenv, buffers[i]);
+            buffers[i]->content = 0;
+        }
+    }
+    for (i = count; i-- > 0;) {
+        if (!buffers[i]->is_direct && !buffers[i]->is_critical && buffers[i]->content != 0) {
+            stodium_release_array_elements(jenv, buffers[i], buffers[i]->release_mode);
+            buffers[i]->content = 0;
+        }
+    }
+}
+
+/**
+ * stodium_critical_begin obtains the content of all heap buffers in the list.
+ * Buffers too large to be pinned are copied first, after which the other
+ * arrays are pinned with GetPrimitiveArrayCritical.
+ *
+ * Returns false if any of the arrays could not be obtained, in which case all
+ * buffers have already been released.
+ */
+bool stodium_critical_begin(JNIEnv *jenv, stodium_buffer **buffers, size_t count) {
+    size_t i;
+    for (i = 0; i < count; i++) {
+        if (!buffers[i]->is_direct && !buffers[i]->is_critical) {
+            stodium_get_array_elements(jenv, buffers[i]);
+            if (buffers[i]->content == 0) {
+                stodium_critical_end(jenv, buffers, count);
+                return false;
+            }
+        }
+    }
+    for (i = 0; i < count; i++) {
+        if (buffers[i]->is_critical) {
+            jboolean is_copy = JNI_FALSE;
+            buffers[i]->content = (unsigned char *) (*jenv)->GetPrimitiveArrayCritical(jenv, buffers[i]->backing_array, &is_copy);
+            buffers[i]->is_copy = buffers[i]->content != 0 && is_copy;
+            if (buffers[i]->content == 0) {
+                stodium_critical_end(jenv, buffers, count);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * STODIUM_CRITICAL_BEGIN and STODIUM_CRITICAL_END enclose the call to a
+ * libsodium method for buffers obtained with stodium_get_critical_*. No JNI
+ * methods may be called between the two macros.
+ *
+ * STODIUM_CRITICAL_BEGIN returns -1 from the wrapper if not all arrays could be
+ * obtained.
+ */
+#define STODIUM_CRITICAL_BEGIN(jenv, ...) \
+    stodium_buffer *stodium_critical_buffers[] = { __VA_ARGS__ }; \
+    if (!stodium_critical_begin(jenv, stodium_critical_buffers, sizeof(stodium_critical_buffers) / sizeof(stodium_buffer *))) { \
+        return -1; }
+
+#define STODIUM_CRITICAL_END(jenv) \
+    stodium_critical_end(jenv, stodium_critical_buffers, sizeof(stodium_critical_buffers) / sizeof(stodium_buffer *))
+
+/**
+ * stodium_fragments holds the buffers of a ByteBuffer[] passed to a gather or
+ * scatter wrapper, each resolved to the region between its position and
+ * limit.
+ */
+typedef struct stodium_fragments {
+    stodium_buffer *buffers;
+    size_t          count;
+    size_t          length; // The sum of the lengths of the fragments
+} stodium_fragments;
+
+/**
+ * stodium_get_critical_fragments resolves every buffer of array, as
+ * stodium_get_critical_output (output) or stodium_get_critical_input do for
+ * a single buffer. A null array has no fragments. Returns false if the array
+ * holds a null buffer, or the fragments could not be allocated.
+ */
+static bool stodium_get_critical_fragments(JNIEnv *jenv, stodium_fragments *fragments,
+        jobjectArray array,
+        bool         output) {
+    jsize count = array == NULL ? 0 : (*jenv)->GetArrayLength(jenv, array);
+    jsize i;
+
+    fragments->buffers = NULL;
+    fragments->count   = 0;
+    fragments->length  = 0;
+    if (count == 0) {
+        return true;
+    }
+    // every heap fragment keeps a local reference to its array until the end
+    // of the call
+    if ((*jenv)->EnsureLocalCapacity(jenv, count) != 0) {
+        return false;
+    }
+    fragments->buffers = (stodium_buffer *) calloc((size_t) count, sizeof(stodium_buffer));
+    if (fragments->buffers == NULL) {
+        return false;
+    }
+
+    for (i = 0; i < count; i++) {
+        jobject element = (*jenv)->GetObjectArrayElement(jenv, array, i);
+        if (element == NULL) {
+            free(fragments->buffers);
+            fragments->buffers = NULL;
+            return false;
+        }
+        if (output) {
+            stodium_get_critical_output(jenv, &fragments->buffers[i], element);
+        } else {
+            stodium_get_critical_input(jenv, &fragments->buffers[i], element);
+        }
+        (*jenv)->DeleteLocalRef(jenv, element);
+        fragments->length += fragments->buffers[i].capacity;
+        fragments->count   = (size_t) i + 1;
+    }
+    return true;
+}
+
+/**
+ * stodium_fragments_begin obtains the content of the fragments of a and b
+ * (which may be NULL) and of the extra buffers of the call, with a single
+ * stodium_critical_begin. Returns the list to pass to stodium_fragments_end,
+ * or NULL if not all buffers could be obtained.
+ */
+static stodium_buffer **stodium_fragments_begin(JNIEnv *jenv,
+        const stodium_fragments *a,
+        const stodium_fragments *b,
+        stodium_buffer         **extra,
+        size_t                   extras,
+        size_t                  *count) {
+    const size_t     nb   = b == NULL ? 0 : b->count;
+    stodium_buffer **list = (stodium_buffer **) malloc((a->count + nb + extras + 1) * sizeof(stodium_buffer *));
+    size_t i, n = 0;
+
+    if (list == NULL) {
+        return NULL;
+    }
+    for (i = 0; i < a->count; i++) {
+        list[n++] = &a->buffers[i];
+    }
+    for (i = 0; i < nb; i++) {
+        list[n++] = &b->buffers[i];
+    }
+    for (i = 0; i < extras; i++) {
+        list[n++] = extra[i];
+    }
+
+    if (!stodium_critical_begin(jenv, list, n)) {
+        free(list);
+        return NULL;
+    }
+    *count = n;
+    return list;
+}
+
+static void stodium_fragments_end(JNIEnv *jenv, stodium_buffer **list, size_t count) {
+    stodium_critical_end(jenv, list, count);
+    free(list);
+}
+
+static void stodium_fragments_release(stodium_fragments *fragments) {
+    free(fragments->buffers);
+    fragments->buffers = NULL;
+}
+
+/**
+ * stodium_fragment_cursor walks the bytes of a list of fragments in order.
+ * stodium_fragment_span returns the number of contiguous bytes from the
+ * cursor, and points *at to them.
+ */
+typedef struct stodium_fragment_cursor {
+    const stodium_fragments *fragments;
+    size_t                   index;
+    size_t                   offset;
+} stodium_fragment_cursor;
+
+static size_t stodium_fragment_span(stodium_fragment_cursor *cursor, unsigned char **at) {
+    while (cursor->index < cursor->fragments->count) {
+        const stodium_buffer *buffer = &cursor->fragments->buffers[cursor->index];
+        if (cursor->offset < buffer->capacity) {
+            *at = buffer->content + buffer->offset + cursor->offset;
+            return buffer->capacity - cursor->offset;
+        }
+        cursor->index++;
+        cursor->offset = 0;
+    }
+    return 0;
+}
+
+static void stodium_fragment_advance(stodium_fragment_cursor *cursor, size_t n) {
+    cursor->offset += n;
+}
+
+/**
+ * stodium_fragments_overlap returns true if dst and src share a byte that is
+ * not at the same offset in the message in both, i.e. if writing dst could
+ * overwrite a byte of src that is still to be read. Fragments that are
+ * exactly in place, or do not overlap at all, are fine.
+ */
+static bool stodium_fragments_overlap(const stodium_fragments *dst, const stodium_fragments *src) {
+    size_t i, j, dpos = 0;
+    for (i = 0; i < dst->count; i++) {
+        const uintptr_t d    = (uintptr_t) AS_INPUT(unsigned char, dst->buffers[i]);
+        const size_t    dlen = dst->buffers[i].capacity;
+        size_t spos = 0;
+        for (j = 0; j < src->count; j++) {
+            const uintptr_t s    = (uintptr_t) AS_INPUT(unsigned char, src->buffers[j]);
+            const size_t    slen = src->buffers[j].capacity;
+            if (dlen > 0 && slen > 0 && d < s + slen && s < d + dlen && d - dpos != s - spos) {
+                return true;
+            }
+            spos += slen;
+        }
+        dpos += dlen;
+    }
+    return false;
 }
 
 /**
@@ -182,6 +628,169 @@ STODIUM_JNI(jint, stodium_1init) (JNIEnv *jenv, jclass jcls) {
     return (jint) sodium_init();
 }
 
+/**
+ * Returns 1 if the backing array of a heap buffer is read through its fields,
+ * in which case read-only heap buffers can be passed as input directly.
+ */
+STODIUM_JNI(jint, stodium_1supports_1readonly_1heap) (JNIEnv *jenv, jclass jcls) {
+    return (jint) (stodium_g_byte_buffer_field_hb != NULL && stodium_g_byte_buffer_field_offset != NULL);
+}
+
+/**
+ * Starts the native worker pool used by the batch methods. Returns 0 on
+ * success, -1 if a pool is already running or the threads could not be
+ * started.
+ */
+STODIUM_JNI(jint, stodium_1pool_1start) (JNIEnv *jenv, jclass jcls,
+        jint threads) {
+    return threads > 0 && stodium_pool_start((size_t) threads) ? 0 : -1;
+}
+
+/**
+ * Stops the native worker pool, after the running batch has finished.
+ */
+STODIUM_JNI(void, stodium_1pool_1stop) (JNIEnv *jenv, jclass jcls) {
+    stodium_pool_stop();
+}
+
+/**
+ * Returns the number of threads in the native worker pool.
+ */
+STODIUM_JNI(jint, stodium_1pool_1size) (JNIEnv *jenv, jclass jcls) {
+    return (jint) stodium_pool_size();
+}
+
+/**
+ * Writes a snapshot of the instrumentation counters to dst, as
+ * STODIUM_STATS_GROUPS * STODIUM_STATS_COUNTERS 64-bit values in native byte
+ * order. Returns the number of values written, 0 if the counters were
+ * compiled out, or -1 if dst is not a direct buffer or is too small.
+ */
+STODIUM_JNI(jint, stodium_1stats) (JNIEnv *jenv, jclass jcls,
+        jobject dst) {
+    uint64_t values[STODIUM_STATS_GROUPS * STODIUM_STATS_COUNTERS];
+    stodium_buffer dst_buffer;
+
+    // Resolved without stodium_get_buffer, so the snapshot is not counted
+    stodium_resolve_buffer(jenv, &dst_buffer, dst);
+    if (dst == NULL || !dst_buffer.is_direct || dst_buffer.capacity < sizeof(values)) {
+        return -1;
+    }
+    if (!STODIUM_STATS) {
+        return 0;
+    }
+
+    stodium_stats_snapshot(values);
+    memcpy(AS_OUTPUT(unsigned char, dst_buffer), values, sizeof(values));
+    return (jint) (sizeof(values) / sizeof(uint64_t));
+}
+
+/**
+ * The bits of the mask returned by stodium_1cpu_1features, one for every CPU
+ * feature detected by libsodium in sodium_init.
+ */
+#define STODIUM_CPU_NEON    (1 << 0)
+#define STODIUM_CPU_SSE2    (1 << 1)
+#define STODIUM_CPU_SSE3    (1 << 2)
+#define STODIUM_CPU_SSSE3   (1 << 3)
+#define STODIUM_CPU_SSE41   (1 << 4)
+#define STODIUM_CPU_AVX     (1 << 5)
+#define STODIUM_CPU_AVX2    (1 << 6)
+#define STODIUM_CPU_AVX512F (1 << 7)
+#define STODIUM_CPU_PCLMUL  (1 << 8)
+#define STODIUM_CPU_AESNI   (1 << 9)
+#define STODIUM_CPU_RDRAND  (1 << 10)
+
+/**
+ * Returns the CPU features found by libsodium's runtime detection, which also
+ * decides which implementations (e.g. the AVX2 BLAKE2b or Argon2) libsodium
+ * uses. sodium_init must have been called.
+ */
+STODIUM_JNI(jint, stodium_1cpu_1features) (JNIEnv *jenv, jclass jcls) {
+    jint features = 0;
+    if (sodium_runtime_has_neon())    features |= STODIUM_CPU_NEON;
+    if (sodium_runtime_has_sse2())    features |= STODIUM_CPU_SSE2;
+    if (sodium_runtime_has_sse3())    features |= STODIUM_CPU_SSE3;
+    if (sodium_runtime_has_ssse3())   features |= STODIUM_CPU_SSSE3;
+    if (sodium_runtime_has_sse41())   features |= STODIUM_CPU_SSE41;
+    if (sodium_runtime_has_avx())     features |= STODIUM_CPU_AVX;
+    if (sodium_runtime_has_avx2())    features |= STODIUM_CPU_AVX2;
+    if (sodium_runtime_has_avx512f()) features |= STODIUM_CPU_AVX512F;
+    if (sodium_runtime_has_pclmul())  features |= STODIUM_CPU_PCLMUL;
+    if (sodium_runtime_has_aesni())   features |= STODIUM_CPU_AESNI;
+    if (sodium_runtime_has_rdrand())  features |= STODIUM_CPU_RDRAND;
+    return features;
+}
+
+/** ****************************************************************************
+ *
+ * CONSTANTS
+ *
+ **************************************************************************** */
+
+/**
+ * The getters of the constants in stodium_constants.h. They are not exported,
+ * but bound to StodiumJNI by stodium_register_constants: the JVM does not have
+ * to look up a symbol for each of them on first use.
+ */
+#define STODIUM_CONSTANT_GETTER(type, name) \
+    static type JNICALL stodium_constant_##name (JNIEnv *jenv, jclass jcls) { \
+        return (type) crypto_##name (); }
+
+STODIUM_CONSTANTS(STODIUM_CONSTANT_GETTER)
+
+#define STODIUM_CONSTANT_SIG_jint  "()I"
+#define STODIUM_CONSTANT_SIG_jlong "()J"
+
+// JNINativeMethod stores the function as a void *; ISO C has no conversion
+// from a function pointer to an object pointer, so it is marked as a (POSIX)
+// extension
+#define STODIUM_CONSTANT_METHOD(type, name) \
+    { (char *) "crypto_" #name, (char *) STODIUM_CONSTANT_SIG_##type, __extension__ (void *) stodium_constant_##name },
+
+static const JNINativeMethod stodium_constant_methods[] = {
+    STODIUM_CONSTANTS(STODIUM_CONSTANT_METHOD)
+};
+
+/**
+ * stodium_register_constants binds the constant getters to StodiumJNI. Called
+ * from JNI_OnLoad.
+ */
+static bool stodium_register_constants(JNIEnv *jenv) {
+    jclass jcls = (*jenv)->FindClass(jenv, "eu/artemisc/stodium/StodiumJNI");
+    if (jcls == NULL) {
+        return false;
+    }
+
+    jint result = (*jenv)->RegisterNatives(jenv, jcls, stodium_constant_methods,
+            (jint) (sizeof(stodium_constant_methods) / sizeof(JNINativeMethod)));
+    (*jenv)->DeleteLocalRef(jenv, jcls);
+    return result == JNI_OK;
+}
+
+/**
+ * Writes every constant in stodium_constants.h to dst, in order, as 64-bit
+ * values in native byte order. Returns the number of values written, or -1 if
+ * dst is not a direct buffer or is too small.
+ */
+STODIUM_JNI(jint, stodium_1constants) (JNIEnv *jenv, jclass jcls,
+        jobject dst) {
+#define STODIUM_CONSTANT_VALUE(type, name) (int64_t) crypto_##name (),
+    const int64_t values[] = {
+        STODIUM_CONSTANTS(STODIUM_CONSTANT_VALUE)
+    };
+#undef STODIUM_CONSTANT_VALUE
+    stodium_buffer dst_buffer;
+
+    stodium_resolve_buffer(jenv, &dst_buffer, dst);
+    if (dst == NULL || !dst_buffer.is_direct || dst_buffer.capacity < sizeof(values)) {
+        return -1;
+    }
+
+    memcpy(AS_OUTPUT(unsigned char, dst_buffer), values, sizeof(values));
+    return (jint) (sizeof(values) / sizeof(int64_t));
+}
+
 /** ****************************************************************************
  *
  * Libsodium library methods
@@ -196,6 +805,74 @@ STODIUM_JNI(jstring, sodium_1version_1string) (JNIEnv *jenv, jclass jcls) {
     return (*jenv)->NewStringUTF(jenv, sodium_version_string());
 }
 
+/**
+ * Compares a and b in constant time. Returns 0 if both hold the same bytes,
+ * -1 if they differ or have a different length.
+ */
+STODIUM_JNI(jint, sodium_1memcmp) (JNIEnv *jenv, jclass jcls,
+        jobject a,
+        jobject b) {
+    STODIUM_STATS_CALL(STODIUM_STATS_UTILS);
+    stodium_buffer a_buffer, b_buffer;
+    stodium_get_critical_input(jenv, &a_buffer, a);
+    stodium_get_critical_input(jenv, &b_buffer, b);
+    if (a_buffer.capacity != b_buffer.capacity) {
+        return -1;
+    }
+
+    STODIUM_CRITICAL_BEGIN(jenv, &a_buffer, &b_buffer);
+    jint result = (jint) sodium_memcmp(
+            AS_INPUT(unsigned char, a_buffer),
+            AS_INPUT(unsigned char, b_buffer),
+            AS_INPUT_LEN(size_t, a_buffer));
+    STODIUM_CRITICAL_END(jenv);
+
+    return result;
+}
+
+/**
+ * Wipes the bytes between the position and limit of dst. Returns 0, or -1 if
+ * the buffer could not be accessed.
+ */
+STODIUM_JNI(jint, sodium_1memzero) (JNIEnv *jenv, jclass jcls,
+        jobject dst) {
+    STODIUM_STATS_CALL(STODIUM_STATS_UTILS);
+    stodium_buffer dst_buffer;
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer);
+    sodium_memzero(AS_OUTPUT(unsigned char, dst_buffer), AS_INPUT_LEN(size_t, dst_buffer));
+    STODIUM_CRITICAL_END(jenv);
+
+    return 0;
+}
+
+/**
+ * Compares a and b as little-endian numbers in constant time. Returns -1, 0 or
+ * 1 if a is smaller than, equal to or larger than b, and -2 if they have a
+ * different length.
+ */
+STODIUM_JNI(jint, sodium_1compare) (JNIEnv *jenv, jclass jcls,
+        jobject a,
+        jobject b) {
+    STODIUM_STATS_CALL(STODIUM_STATS_UTILS);
+    stodium_buffer a_buffer, b_buffer;
+    stodium_get_critical_input(jenv, &a_buffer, a);
+    stodium_get_critical_input(jenv, &b_buffer, b);
+    if (a_buffer.capacity != b_buffer.capacity) {
+        return -2;
+    }
+
+    STODIUM_CRITICAL_BEGIN(jenv, &a_buffer, &b_buffer);
+    jint result = (jint) sodium_compare(
+            AS_INPUT(unsigned char, a_buffer),
+            AS_INPUT(unsigned char, b_buffer),
+            AS_INPUT_LEN(size_t, a_buffer));
+    STODIUM_CRITICAL_END(jenv);
+
+    return result;
+}
+
 /** ****************************************************************************
  *
  * RANDOM DATA
@@ -212,6 +889,7 @@ STODIUM_JNI(jint, randombytes_1uniform) (JNIEnv *jenv, jclass jcls, jint upper_b
 
 STODIUM_JNI(void, randombytes_1buf) (JNIEnv *jenv, jclass jcls,
         jobject dst) {
+    STODIUM_STATS_CALL(STODIUM_STATS_RANDOMBYTES);
     stodium_buffer dst_buffer;
     stodium_get_buffer(jenv, &dst_buffer, dst);
 
@@ -226,16 +904,64 @@ STODIUM_JNI(jint, randombytes_1close) (JNIEnv *jenv, jclass jcls) {
     return (jint) randombytes_close();
 }
 
-/** ****************************************************************************
- *
- * AEAD - AES-256-GCM
- *
- **************************************************************************** */
+/**
+ * stodium_fork_generation is incremented in the child process after every
+ * fork(), so random bytes buffered before the fork are not used by both the
+ * parent and the child. It is read from Java through a direct buffer, without
+ * a native call.
+ */
+static uint32_t       stodium_fork_generation = 0;
+static pthread_once_t stodium_fork_once       = PTHREAD_ONCE_INIT;
+
+static void stodium_fork_child(void) {
+    __atomic_add_fetch(&stodium_fork_generation, 1, __ATOMIC_RELAXED);
+}
+
+static void stodium_fork_register(void) {
+#ifndef _WIN32
+    pthread_atfork(NULL, NULL, stodium_fork_child);
+#endif
+}
+
+/**
+ * Returns a direct buffer over the fork generation counter, a 32-bit value in
+ * native byte order.
+ */
+STODIUM_JNI(jobject, stodium_1fork_1generation) (JNIEnv *jenv, jclass jcls) {
+    pthread_once(&stodium_fork_once, stodium_fork_register);
+    return (*jenv)->NewDirectByteBuffer(jenv, &stodium_fork_generation, sizeof stodium_fork_generation);
+}
+
+/**
+ * Fills dst with the ChaCha20 keystream of randombytes_buf_deterministic, under
+ * a key freshly taken from randombytes_buf. Refilling a large buffer costs a
+ * single call to the system CSPRNG.
+ */
+STODIUM_JNI(jint, stodium_1random_1refill) (JNIEnv *jenv, jclass jcls,
+        jobject dst) {
+    STODIUM_STATS_CALL(STODIUM_STATS_RANDOMBYTES);
+    unsigned char seed[randombytes_SEEDBYTES];
+    stodium_buffer dst_buffer;
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer);
+    randombytes_buf(seed, sizeof seed);
+    randombytes_buf_deterministic(
+            AS_OUTPUT(void, dst_buffer),
+            AS_INPUT_LEN(size_t, dst_buffer),
+            seed);
+    STODIUM_CRITICAL_END(jenv);
+
+    sodium_memzero(seed, sizeof seed);
+    return 0;
+}
+
+/** ****************************************************************************
+ *
+ * AEAD - AES-256-GCM
+ *
+ **************************************************************************** */
 
-STODIUM_CONSTANT(aead, aes256gcm, keybytes)
-STODIUM_CONSTANT(aead, aes256gcm, nsecbytes)
-STODIUM_CONSTANT(aead, aes256gcm, npubbytes)
-STODIUM_CONSTANT(aead, aes256gcm, abytes)
 
 STODIUM_JNI(jint, crypto_1aead_1aes256gcm_1is_1available) (JNIEnv *jenv, jclass jcls) {
        return (jint) crypto_aead_aes256gcm_is_available();
@@ -248,18 +974,19 @@ STODIUM_JNI(jint, crypto_1aead_1aes256gcm_1encrypt_1detached) (JNIEnv *jenv, jcl
         jobject ad,
         jobject nonce,
         jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_AEAD);
     stodium_buffer dst_buffer, mac_buffer, src_buffer, ad_buffer, nonce_buffer, key_buffer;
-    stodium_get_buffer(jenv, &dst_buffer,   dst);
-    stodium_get_buffer(jenv, &mac_buffer,   mac);
-    stodium_get_buffer(jenv, &src_buffer,   src);
-    stodium_get_buffer(jenv, &ad_buffer,    ad);
-    stodium_get_buffer(jenv, &nonce_buffer, nonce);
-    stodium_get_buffer(jenv, &key_buffer,   key);
- 
+    stodium_get_critical_output(jenv, &dst_buffer,   dst);
+    stodium_get_critical_output(jenv, &mac_buffer,   mac);
+    stodium_get_critical_input(jenv,  &src_buffer,   src);
+    stodium_get_critical_input(jenv,  &ad_buffer,    ad);
+    stodium_get_critical_input(jenv,  &nonce_buffer, nonce);
+    stodium_get_critical_input(jenv,  &key_buffer,   key);
+
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &mac_buffer, &src_buffer, &ad_buffer, &nonce_buffer, &key_buffer);
     jint result = (jint) crypto_aead_aes256gcm_encrypt_detached(
             AS_OUTPUT(unsigned char, dst_buffer),
             AS_OUTPUT(unsigned char, mac_buffer),
-            //AS_OUTPUT_LEN(unsigned long long, mac_buffer),
             NULL,
             AS_INPUT(unsigned char, src_buffer),
             AS_INPUT_LEN(unsigned long long, src_buffer),
@@ -268,13 +995,7 @@ STODIUM_JNI(jint, crypto_1aead_1aes256gcm_1encrypt_1detached) (JNIEnv *jenv, jcl
             NULL, // nsec
             AS_INPUT(unsigned char, nonce_buffer),
             AS_INPUT(unsigned char, key_buffer));
-
-    stodium_release_output(jenv, dst,   &dst_buffer);
-    stodium_release_output(jenv, mac,   &mac_buffer);
-    stodium_release_input(jenv,  src,   &src_buffer);
-    stodium_release_input(jenv,  ad,    &ad_buffer);
-    stodium_release_input(jenv,  nonce, &nonce_buffer);
-    stodium_release_input(jenv,  key,   &key_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -285,13 +1006,15 @@ STODIUM_JNI(jint, crypto_1aead_1aes256gcm_1encrypt) (JNIEnv *jenv, jclass jcls,
         jobject ad,
         jobject nonce,
         jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_AEAD);
     stodium_buffer dst_buffer, src_buffer, ad_buffer, nonce_buffer, key_buffer;
-    stodium_get_buffer(jenv, &dst_buffer,   dst);
-    stodium_get_buffer(jenv, &src_buffer,   src);
-    stodium_get_buffer(jenv, &ad_buffer,    ad);
-    stodium_get_buffer(jenv, &nonce_buffer, nonce);
-    stodium_get_buffer(jenv, &key_buffer,   key);
- 
+    stodium_get_critical_output(jenv, &dst_buffer,   dst);
+    stodium_get_critical_input(jenv,  &src_buffer,   src);
+    stodium_get_critical_input(jenv,  &ad_buffer,    ad);
+    stodium_get_critical_input(jenv,  &nonce_buffer, nonce);
+    stodium_get_critical_input(jenv,  &key_buffer,   key);
+
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &src_buffer, &ad_buffer, &nonce_buffer, &key_buffer);
     jint result = (jint) crypto_aead_aes256gcm_encrypt(
             AS_OUTPUT(unsigned char, dst_buffer),
             NULL,
@@ -302,12 +1025,7 @@ STODIUM_JNI(jint, crypto_1aead_1aes256gcm_1encrypt) (JNIEnv *jenv, jclass jcls,
             NULL, // nsec
             AS_INPUT(unsigned char, nonce_buffer),
             AS_INPUT(unsigned char, key_buffer));
-
-    stodium_release_output(jenv, dst,   &dst_buffer);
-    stodium_release_input(jenv,  src,   &src_buffer);
-    stodium_release_input(jenv,  ad,    &ad_buffer);
-    stodium_release_input(jenv,  nonce, &nonce_buffer);
-    stodium_release_input(jenv,  key,   &key_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -319,14 +1037,16 @@ STODIUM_JNI(jint, crypto_1aead_1aes256gcm_1decrypt_1detached) (JNIEnv *jenv, jcl
         jobject ad,
         jobject nonce,
         jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_AEAD);
     stodium_buffer dst_buffer, mac_buffer, src_buffer, ad_buffer, nonce_buffer, key_buffer;
-    stodium_get_buffer(jenv, &dst_buffer,   dst);
-    stodium_get_buffer(jenv, &src_buffer,   src);
-    stodium_get_buffer(jenv, &mac_buffer,   mac);
-    stodium_get_buffer(jenv, &ad_buffer,    ad);
-    stodium_get_buffer(jenv, &nonce_buffer, nonce);
-    stodium_get_buffer(jenv, &key_buffer,   key);
- 
+    stodium_get_critical_output(jenv, &dst_buffer,   dst);
+    stodium_get_critical_input(jenv,  &src_buffer,   src);
+    stodium_get_critical_input(jenv,  &mac_buffer,   mac);
+    stodium_get_critical_input(jenv,  &ad_buffer,    ad);
+    stodium_get_critical_input(jenv,  &nonce_buffer, nonce);
+    stodium_get_critical_input(jenv,  &key_buffer,   key);
+
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &src_buffer, &mac_buffer, &ad_buffer, &nonce_buffer, &key_buffer);
     jint result = (jint) crypto_aead_aes256gcm_decrypt_detached(
             AS_OUTPUT(unsigned char, dst_buffer),
             NULL, // nsec
@@ -337,13 +1057,7 @@ STODIUM_JNI(jint, crypto_1aead_1aes256gcm_1decrypt_1detached) (JNIEnv *jenv, jcl
             AS_INPUT_LEN(unsigned long long, ad_buffer),
             AS_INPUT(unsigned char, nonce_buffer),
             AS_INPUT(unsigned char, key_buffer));
-
-    stodium_release_output(jenv, dst,   &dst_buffer);
-    stodium_release_input(jenv,  mac,   &mac_buffer);
-    stodium_release_input(jenv,  src,   &src_buffer);
-    stodium_release_input(jenv,  ad,    &ad_buffer);
-    stodium_release_input(jenv,  nonce, &nonce_buffer);
-    stodium_release_input(jenv,  key,   &key_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -354,16 +1068,18 @@ STODIUM_JNI(jint, crypto_1aead_1aes256gcm_1decrypt) (JNIEnv *jenv, jclass jcls,
         jobject ad,
         jobject nonce,
         jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_AEAD);
     stodium_buffer dst_buffer, src_buffer, ad_buffer, nonce_buffer, key_buffer;
-    stodium_get_buffer(jenv, &dst_buffer,   dst);
-    stodium_get_buffer(jenv, &src_buffer,   src);
-    stodium_get_buffer(jenv, &ad_buffer,    ad);
-    stodium_get_buffer(jenv, &nonce_buffer, nonce);
-    stodium_get_buffer(jenv, &key_buffer,   key);
- 
+    stodium_get_critical_output(jenv, &dst_buffer,   dst);
+    stodium_get_critical_input(jenv,  &src_buffer,   src);
+    stodium_get_critical_input(jenv,  &ad_buffer,    ad);
+    stodium_get_critical_input(jenv,  &nonce_buffer, nonce);
+    stodium_get_critical_input(jenv,  &key_buffer,   key);
+
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &src_buffer, &ad_buffer, &nonce_buffer, &key_buffer);
     jint result = (jint) crypto_aead_aes256gcm_decrypt(
             AS_OUTPUT(unsigned char, dst_buffer),
-            AS_OUTPUT_LEN(unsigned long long, dst_buffer),
+            NULL,
             NULL, // nsec
             AS_INPUT(unsigned char, src_buffer),
             AS_INPUT_LEN(unsigned long long, src_buffer),
@@ -371,12 +1087,7 @@ STODIUM_JNI(jint, crypto_1aead_1aes256gcm_1decrypt) (JNIEnv *jenv, jclass jcls,
             AS_INPUT_LEN(unsigned long long, ad_buffer),
             AS_INPUT(unsigned char, nonce_buffer),
             AS_INPUT(unsigned char, key_buffer));
-
-    stodium_release_output(jenv, dst,   &dst_buffer);
-    stodium_release_input(jenv,  src,   &src_buffer);
-    stodium_release_input(jenv,  ad,    &ad_buffer);
-    stodium_release_input(jenv,  nonce, &nonce_buffer);
-    stodium_release_input(jenv,  key,   &key_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -387,10 +1098,6 @@ STODIUM_JNI(jint, crypto_1aead_1aes256gcm_1decrypt) (JNIEnv *jenv, jclass jcls,
  *
  **************************************************************************** */
 
-STODIUM_CONSTANT(aead, chacha20poly1305, keybytes)
-STODIUM_CONSTANT(aead, chacha20poly1305, nsecbytes)
-STODIUM_CONSTANT(aead, chacha20poly1305, npubbytes)
-STODIUM_CONSTANT(aead, chacha20poly1305, abytes)
 
 STODIUM_JNI(jint, crypto_1aead_1chacha20poly1305_1encrypt_1detached) (JNIEnv *jenv, jclass jcls,
         jobject dst,
@@ -399,18 +1106,20 @@ STODIUM_JNI(jint, crypto_1aead_1chacha20poly1305_1encrypt_1detached) (JNIEnv *je
         jobject ad,
         jobject nonce,
         jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_AEAD);
     stodium_buffer dst_buffer, mac_buffer, src_buffer, ad_buffer, nonce_buffer, key_buffer;
-    stodium_get_buffer(jenv, &dst_buffer,   dst);
-    stodium_get_buffer(jenv, &mac_buffer,   mac);
-    stodium_get_buffer(jenv, &src_buffer,   src);
-    stodium_get_buffer(jenv, &ad_buffer,    ad);
-    stodium_get_buffer(jenv, &nonce_buffer, nonce);
-    stodium_get_buffer(jenv, &key_buffer,   key);
- 
+    stodium_get_critical_output(jenv, &dst_buffer,   dst);
+    stodium_get_critical_output(jenv, &mac_buffer,   mac);
+    stodium_get_critical_input(jenv,  &src_buffer,   src);
+    stodium_get_critical_input(jenv,  &ad_buffer,    ad);
+    stodium_get_critical_input(jenv,  &nonce_buffer, nonce);
+    stodium_get_critical_input(jenv,  &key_buffer,   key);
+
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &mac_buffer, &src_buffer, &ad_buffer, &nonce_buffer, &key_buffer);
     jint result = (jint) crypto_aead_chacha20poly1305_encrypt_detached(
             AS_OUTPUT(unsigned char, dst_buffer),
             AS_OUTPUT(unsigned char, mac_buffer),
-            AS_OUTPUT_LEN(unsigned long long, mac_buffer),
+            NULL,
             AS_INPUT(unsigned char, src_buffer),
             AS_INPUT_LEN(unsigned long long, src_buffer),
             AS_INPUT(unsigned char, ad_buffer),
@@ -418,13 +1127,7 @@ STODIUM_JNI(jint, crypto_1aead_1chacha20poly1305_1encrypt_1detached) (JNIEnv *je
             NULL, // nsec
             AS_INPUT(unsigned char, nonce_buffer),
             AS_INPUT(unsigned char, key_buffer));
-
-    stodium_release_output(jenv, dst,   &dst_buffer);
-    stodium_release_output(jenv, mac,   &mac_buffer);
-    stodium_release_input(jenv,  src,   &src_buffer);
-    stodium_release_input(jenv,  ad,    &ad_buffer);
-    stodium_release_input(jenv,  nonce, &nonce_buffer);
-    stodium_release_input(jenv,  key,   &key_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -435,16 +1138,18 @@ STODIUM_JNI(jint, crypto_1aead_1chacha20poly1305_1encrypt) (JNIEnv *jenv, jclass
         jobject ad,
         jobject nonce,
         jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_AEAD);
     stodium_buffer dst_buffer, src_buffer, ad_buffer, nonce_buffer, key_buffer;
-    stodium_get_buffer(jenv, &dst_buffer,   dst);
-    stodium_get_buffer(jenv, &src_buffer,   src);
-    stodium_get_buffer(jenv, &ad_buffer,    ad);
-    stodium_get_buffer(jenv, &nonce_buffer, nonce);
-    stodium_get_buffer(jenv, &key_buffer,   key);
- 
+    stodium_get_critical_output(jenv, &dst_buffer,   dst);
+    stodium_get_critical_input(jenv,  &src_buffer,   src);
+    stodium_get_critical_input(jenv,  &ad_buffer,    ad);
+    stodium_get_critical_input(jenv,  &nonce_buffer, nonce);
+    stodium_get_critical_input(jenv,  &key_buffer,   key);
+
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &src_buffer, &ad_buffer, &nonce_buffer, &key_buffer);
     jint result = (jint) crypto_aead_chacha20poly1305_encrypt(
             AS_OUTPUT(unsigned char, dst_buffer),
-            AS_OUTPUT_LEN(unsigned long long, dst_buffer),
+            NULL,
             AS_INPUT(unsigned char, src_buffer),
             AS_INPUT_LEN(unsigned long long, src_buffer),
             AS_INPUT(unsigned char, ad_buffer),
@@ -452,12 +1157,7 @@ STODIUM_JNI(jint, crypto_1aead_1chacha20poly1305_1encrypt) (JNIEnv *jenv, jclass
             NULL, // nsec
             AS_INPUT(unsigned char, nonce_buffer),
             AS_INPUT(unsigned char, key_buffer));
-
-    stodium_release_output(jenv, dst,   &dst_buffer);
-    stodium_release_input(jenv,  src,   &src_buffer);
-    stodium_release_input(jenv,  ad,    &ad_buffer);
-    stodium_release_input(jenv,  nonce, &nonce_buffer);
-    stodium_release_input(jenv,  key,   &key_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -469,14 +1169,16 @@ STODIUM_JNI(jint, crypto_1aead_1chacha20poly1305_1decrypt_1detached) (JNIEnv *je
         jobject ad,
         jobject nonce,
         jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_AEAD);
     stodium_buffer dst_buffer, mac_buffer, src_buffer, ad_buffer, nonce_buffer, key_buffer;
-    stodium_get_buffer(jenv, &dst_buffer,   dst);
-    stodium_get_buffer(jenv, &src_buffer,   src);
-    stodium_get_buffer(jenv, &mac_buffer,   mac);
-    stodium_get_buffer(jenv, &ad_buffer,    ad);
-    stodium_get_buffer(jenv, &nonce_buffer, nonce);
-    stodium_get_buffer(jenv, &key_buffer,   key);
- 
+    stodium_get_critical_output(jenv, &dst_buffer,   dst);
+    stodium_get_critical_input(jenv,  &src_buffer,   src);
+    stodium_get_critical_input(jenv,  &mac_buffer,   mac);
+    stodium_get_critical_input(jenv,  &ad_buffer,    ad);
+    stodium_get_critical_input(jenv,  &nonce_buffer, nonce);
+    stodium_get_critical_input(jenv,  &key_buffer,   key);
+
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &src_buffer, &mac_buffer, &ad_buffer, &nonce_buffer, &key_buffer);
     jint result = (jint) crypto_aead_chacha20poly1305_decrypt_detached(
             AS_OUTPUT(unsigned char, dst_buffer),
             NULL, // nsec
@@ -487,13 +1189,7 @@ STODIUM_JNI(jint, crypto_1aead_1chacha20poly1305_1decrypt_1detached) (JNIEnv *je
             AS_INPUT_LEN(unsigned long long, ad_buffer),
             AS_INPUT(unsigned char, nonce_buffer),
             AS_INPUT(unsigned char, key_buffer));
-
-    stodium_release_output(jenv, dst,   &dst_buffer);
-    stodium_release_input(jenv,  mac,   &mac_buffer);
-    stodium_release_input(jenv,  src,   &src_buffer);
-    stodium_release_input(jenv,  ad,    &ad_buffer);
-    stodium_release_input(jenv,  nonce, &nonce_buffer);
-    stodium_release_input(jenv,  key,   &key_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -504,16 +1200,18 @@ STODIUM_JNI(jint, crypto_1aead_1chacha20poly1305_1decrypt) (JNIEnv *jenv, jclass
         jobject ad,
         jobject nonce,
         jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_AEAD);
     stodium_buffer dst_buffer, src_buffer, ad_buffer, nonce_buffer, key_buffer;
-    stodium_get_buffer(jenv, &dst_buffer,   dst);
-    stodium_get_buffer(jenv, &src_buffer,   src);
-    stodium_get_buffer(jenv, &ad_buffer,    ad);
-    stodium_get_buffer(jenv, &nonce_buffer, nonce);
-    stodium_get_buffer(jenv, &key_buffer,   key);
- 
+    stodium_get_critical_output(jenv, &dst_buffer,   dst);
+    stodium_get_critical_input(jenv,  &src_buffer,   src);
+    stodium_get_critical_input(jenv,  &ad_buffer,    ad);
+    stodium_get_critical_input(jenv,  &nonce_buffer, nonce);
+    stodium_get_critical_input(jenv,  &key_buffer,   key);
+
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &src_buffer, &ad_buffer, &nonce_buffer, &key_buffer);
     jint result = (jint) crypto_aead_chacha20poly1305_decrypt(
             AS_OUTPUT(unsigned char, dst_buffer),
-            AS_OUTPUT_LEN(unsigned long long, dst_buffer),
+            NULL,
             NULL, // nsec
             AS_INPUT(unsigned char, src_buffer),
             AS_INPUT_LEN(unsigned long long, src_buffer),
@@ -521,12 +1219,7 @@ STODIUM_JNI(jint, crypto_1aead_1chacha20poly1305_1decrypt) (JNIEnv *jenv, jclass
             AS_INPUT_LEN(unsigned long long, ad_buffer),
             AS_INPUT(unsigned char, nonce_buffer),
             AS_INPUT(unsigned char, key_buffer));
-
-    stodium_release_output(jenv, dst,   &dst_buffer);
-    stodium_release_input(jenv,  src,   &src_buffer);
-    stodium_release_input(jenv,  ad,    &ad_buffer);
-    stodium_release_input(jenv,  nonce, &nonce_buffer);
-    stodium_release_input(jenv,  key,   &key_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -537,18 +1230,6 @@ STODIUM_JNI(jint, crypto_1aead_1chacha20poly1305_1decrypt) (JNIEnv *jenv, jclass
  *
  **************************************************************************** */
 
-STODIUM_JNI(jint, crypto_1aead_1chacha20poly1305_1ietf_1keybytes) (JNIEnv *jenv, jclass jcls) {
-       return (jint) crypto_aead_chacha20poly1305_ietf_keybytes();
-}
-STODIUM_JNI(jint, crypto_1aead_1chacha20poly1305_1ietf_1nsecbytes) (JNIEnv *jenv, jclass jcls) {
-       return (jint) crypto_aead_chacha20poly1305_ietf_nsecbytes();
-}
-STODIUM_JNI(jint, crypto_1aead_1chacha20poly1305_1ietf_1npubbytes) (JNIEnv *jenv, jclass jcls) {
-       return (jint) crypto_aead_chacha20poly1305_ietf_npubbytes();
-}
-STODIUM_JNI(jint, crypto_1aead_1chacha20poly1305_1ietf_1abytes) (JNIEnv *jenv, jclass jcls) {
-       return (jint) crypto_aead_chacha20poly1305_ietf_abytes();
-}
 
 STODIUM_JNI(jint, crypto_1aead_1chacha20poly1305_1ietf_1encrypt_1detached) (JNIEnv *jenv, jclass jcls,
         jobject dst,
@@ -557,18 +1238,20 @@ STODIUM_JNI(jint, crypto_1aead_1chacha20poly1305_1ietf_1encrypt_1detached) (JNIE
         jobject ad,
         jobject nonce,
         jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_AEAD);
     stodium_buffer dst_buffer, mac_buffer, src_buffer, ad_buffer, nonce_buffer, key_buffer;
-    stodium_get_buffer(jenv, &dst_buffer,   dst);
-    stodium_get_buffer(jenv, &mac_buffer,   mac);
-    stodium_get_buffer(jenv, &src_buffer,   src);
-    stodium_get_buffer(jenv, &ad_buffer,    ad);
-    stodium_get_buffer(jenv, &nonce_buffer, nonce);
-    stodium_get_buffer(jenv, &key_buffer,   key);
- 
+    stodium_get_critical_output(jenv, &dst_buffer,   dst);
+    stodium_get_critical_output(jenv, &mac_buffer,   mac);
+    stodium_get_critical_input(jenv,  &src_buffer,   src);
+    stodium_get_critical_input(jenv,  &ad_buffer,    ad);
+    stodium_get_critical_input(jenv,  &nonce_buffer, nonce);
+    stodium_get_critical_input(jenv,  &key_buffer,   key);
+
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &mac_buffer, &src_buffer, &ad_buffer, &nonce_buffer, &key_buffer);
     jint result = (jint) crypto_aead_chacha20poly1305_ietf_encrypt_detached(
             AS_OUTPUT(unsigned char, dst_buffer),
             AS_OUTPUT(unsigned char, mac_buffer),
-            AS_OUTPUT_LEN(unsigned long long, mac_buffer),
+            NULL,
             AS_INPUT(unsigned char, src_buffer),
             AS_INPUT_LEN(unsigned long long, src_buffer),
             AS_INPUT(unsigned char, ad_buffer),
@@ -576,13 +1259,7 @@ STODIUM_JNI(jint, crypto_1aead_1chacha20poly1305_1ietf_1encrypt_1detached) (JNIE
             NULL, // nsec
             AS_INPUT(unsigned char, nonce_buffer),
             AS_INPUT(unsigned char, key_buffer));
-
-    stodium_release_output(jenv, dst,   &dst_buffer);
-    stodium_release_output(jenv, mac,   &mac_buffer);
-    stodium_release_input(jenv,  src,   &src_buffer);
-    stodium_release_input(jenv,  ad,    &ad_buffer);
-    stodium_release_input(jenv,  nonce, &nonce_buffer);
-    stodium_release_input(jenv,  key,   &key_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -593,16 +1270,18 @@ STODIUM_JNI(jint, crypto_1aead_1chacha20poly1305_1ietf_1encrypt) (JNIEnv *jenv,
         jobject ad,
         jobject nonce,
         jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_AEAD);
     stodium_buffer dst_buffer, src_buffer, ad_buffer, nonce_buffer, key_buffer;
-    stodium_get_buffer(jenv, &dst_buffer,   dst);
-    stodium_get_buffer(jenv, &src_buffer,   src);
-    stodium_get_buffer(jenv, &ad_buffer,    ad);
-    stodium_get_buffer(jenv, &nonce_buffer, nonce);
-    stodium_get_buffer(jenv, &key_buffer,   key);
- 
+    stodium_get_critical_output(jenv, &dst_buffer,   dst);
+    stodium_get_critical_input(jenv,  &src_buffer,   src);
+    stodium_get_critical_input(jenv,  &ad_buffer,    ad);
+    stodium_get_critical_input(jenv,  &nonce_buffer, nonce);
+    stodium_get_critical_input(jenv,  &key_buffer,   key);
+
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &src_buffer, &ad_buffer, &nonce_buffer, &key_buffer);
     jint result = (jint) crypto_aead_chacha20poly1305_ietf_encrypt(
             AS_OUTPUT(unsigned char, dst_buffer),
-            AS_OUTPUT_LEN(unsigned long long, dst_buffer),
+            NULL,
             AS_INPUT(unsigned char, src_buffer),
             AS_INPUT_LEN(unsigned long long, src_buffer),
             AS_INPUT(unsigned char, ad_buffer),
@@ -610,12 +1289,7 @@ STODIUM_JNI(jint, crypto_1aead_1chacha20poly1305_1ietf_1encrypt) (JNIEnv *jenv,
             NULL, // nsec
             AS_INPUT(unsigned char, nonce_buffer),
             AS_INPUT(unsigned char, key_buffer));
-
-    stodium_release_output(jenv, dst,   &dst_buffer);
-    stodium_release_input(jenv,  src,   &src_buffer);
-    stodium_release_input(jenv,  ad,    &ad_buffer);
-    stodium_release_input(jenv,  nonce, &nonce_buffer);
-    stodium_release_input(jenv,  key,   &key_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -627,14 +1301,16 @@ STODIUM_JNI(jint, crypto_1aead_1chacha20poly1305_1ietf_1decrypt_1detached) (JNIE
         jobject ad,
         jobject nonce,
         jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_AEAD);
     stodium_buffer dst_buffer, mac_buffer, src_buffer, ad_buffer, nonce_buffer, key_buffer;
-    stodium_get_buffer(jenv, &dst_buffer,   dst);
-    stodium_get_buffer(jenv, &src_buffer,   src);
-    stodium_get_buffer(jenv, &mac_buffer,   mac);
-    stodium_get_buffer(jenv, &ad_buffer,    ad);
-    stodium_get_buffer(jenv, &nonce_buffer, nonce);
-    stodium_get_buffer(jenv, &key_buffer,   key);
- 
+    stodium_get_critical_output(jenv, &dst_buffer,   dst);
+    stodium_get_critical_input(jenv,  &src_buffer,   src);
+    stodium_get_critical_input(jenv,  &mac_buffer,   mac);
+    stodium_get_critical_input(jenv,  &ad_buffer,    ad);
+    stodium_get_critical_input(jenv,  &nonce_buffer, nonce);
+    stodium_get_critical_input(jenv,  &key_buffer,   key);
+
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &src_buffer, &mac_buffer, &ad_buffer, &nonce_buffer, &key_buffer);
     jint result = (jint) crypto_aead_chacha20poly1305_ietf_decrypt_detached(
             AS_OUTPUT(unsigned char, dst_buffer),
             NULL, // nsec
@@ -645,13 +1321,7 @@ STODIUM_JNI(jint, crypto_1aead_1chacha20poly1305_1ietf_1decrypt_1detached) (JNIE
             AS_INPUT_LEN(unsigned long long, ad_buffer),
             AS_INPUT(unsigned char, nonce_buffer),
             AS_INPUT(unsigned char, key_buffer));
-
-    stodium_release_output(jenv, dst,   &dst_buffer);
-    stodium_release_input(jenv,  mac,   &mac_buffer);
-    stodium_release_input(jenv,  src,   &src_buffer);
-    stodium_release_input(jenv,  ad,    &ad_buffer);
-    stodium_release_input(jenv,  nonce, &nonce_buffer);
-    stodium_release_input(jenv,  key,   &key_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -662,16 +1332,18 @@ STODIUM_JNI(jint, crypto_1aead_1chacha20poly1305_1ietf_1decrypt) (JNIEnv *jenv,
         jobject ad,
         jobject nonce,
         jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_AEAD);
     stodium_buffer dst_buffer, src_buffer, ad_buffer, nonce_buffer, key_buffer;
-    stodium_get_buffer(jenv, &dst_buffer,   dst);
-    stodium_get_buffer(jenv, &src_buffer,   src);
-    stodium_get_buffer(jenv, &ad_buffer,    ad);
-    stodium_get_buffer(jenv, &nonce_buffer, nonce);
-    stodium_get_buffer(jenv, &key_buffer,   key);
- 
+    stodium_get_critical_output(jenv, &dst_buffer,   dst);
+    stodium_get_critical_input(jenv,  &src_buffer,   src);
+    stodium_get_critical_input(jenv,  &ad_buffer,    ad);
+    stodium_get_critical_input(jenv,  &nonce_buffer, nonce);
+    stodium_get_critical_input(jenv,  &key_buffer,   key);
+
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &src_buffer, &ad_buffer, &nonce_buffer, &key_buffer);
     jint result = (jint) crypto_aead_chacha20poly1305_ietf_decrypt(
             AS_OUTPUT(unsigned char, dst_buffer),
-            AS_OUTPUT_LEN(unsigned long long, dst_buffer),
+            NULL,
             NULL, // nsec
             AS_INPUT(unsigned char, src_buffer),
             AS_INPUT_LEN(unsigned long long, src_buffer),
@@ -679,12 +1351,7 @@ STODIUM_JNI(jint, crypto_1aead_1chacha20poly1305_1ietf_1decrypt) (JNIEnv *jenv,
             AS_INPUT_LEN(unsigned long long, ad_buffer),
             AS_INPUT(unsigned char, nonce_buffer),
             AS_INPUT(unsigned char, key_buffer));
-
-    stodium_release_output(jenv, dst,   &dst_buffer);
-    stodium_release_input(jenv,  src,   &src_buffer);
-    stodium_release_input(jenv,  ad,    &ad_buffer);
-    stodium_release_input(jenv,  nonce, &nonce_buffer);
-    stodium_release_input(jenv,  key,   &key_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -696,18 +1363,6 @@ STODIUM_JNI(jint, crypto_1aead_1chacha20poly1305_1ietf_1decrypt) (JNIEnv *jenv,
  *
  **************************************************************************** */
 
-STODIUM_JNI(jint, crypto_1aead_1xchacha20poly1305_1ietf_1keybytes) (JNIEnv *jenv, jclass jcls) {
-       return (jint) crypto_aead_xchacha20poly1305_ietf_keybytes();
-}
-STODIUM_JNI(jint, crypto_1aead_1xchacha20poly1305_1ietf_1nsecbytes) (JNIEnv *jenv, jclass jcls) {
-       return (jint) crypto_aead_xchacha20poly1305_ietf_nsecbytes();
-}
-STODIUM_JNI(jint, crypto_1aead_1xchacha20poly1305_1ietf_1npubbytes) (JNIEnv *jenv, jclass jcls) {
-       return (jint) crypto_aead_xchacha20poly1305_ietf_npubbytes();
-}
-STODIUM_JNI(jint, crypto_1aead_1xchacha20poly1305_1ietf_1abytes) (JNIEnv *jenv, jclass jcls) {
-       return (jint) crypto_aead_xchacha20poly1305_ietf_abytes();
-}
 
 STODIUM_JNI(jint, crypto_1aead_1xchacha20poly1305_1ietf_1encrypt_1detached) (JNIEnv *jenv, jclass jcls,
         jobject dst,
@@ -716,18 +1371,20 @@ STODIUM_JNI(jint, crypto_1aead_1xchacha20poly1305_1ietf_1encrypt_1detached) (JNI
         jobject ad,
         jobject nonce,
         jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_AEAD);
     stodium_buffer dst_buffer, mac_buffer, src_buffer, ad_buffer, nonce_buffer, key_buffer;
-    stodium_get_buffer(jenv, &dst_buffer,   dst);
-    stodium_get_buffer(jenv, &mac_buffer,   mac);
-    stodium_get_buffer(jenv, &src_buffer,   src);
-    stodium_get_buffer(jenv, &ad_buffer,    ad);
-    stodium_get_buffer(jenv, &nonce_buffer, nonce);
-    stodium_get_buffer(jenv, &key_buffer,   key);
- 
+    stodium_get_critical_output(jenv, &dst_buffer,   dst);
+    stodium_get_critical_output(jenv, &mac_buffer,   mac);
+    stodium_get_critical_input(jenv,  &src_buffer,   src);
+    stodium_get_critical_input(jenv,  &ad_buffer,    ad);
+    stodium_get_critical_input(jenv,  &nonce_buffer, nonce);
+    stodium_get_critical_input(jenv,  &key_buffer,   key);
+
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &mac_buffer, &src_buffer, &ad_buffer, &nonce_buffer, &key_buffer);
     jint result = (jint) crypto_aead_xchacha20poly1305_ietf_encrypt_detached(
             AS_OUTPUT(unsigned char, dst_buffer),
             AS_OUTPUT(unsigned char, mac_buffer),
-            AS_OUTPUT_LEN(unsigned long long, mac_buffer),
+            NULL,
             AS_INPUT(unsigned char, src_buffer),
             AS_INPUT_LEN(unsigned long long, src_buffer),
             AS_INPUT(unsigned char, ad_buffer),
@@ -735,13 +1392,7 @@ STODIUM_JNI(jint, crypto_1aead_1xchacha20poly1305_1ietf_1encrypt_1detached) (JNI
             NULL, // nsec
             AS_INPUT(unsigned char, nonce_buffer),
             AS_INPUT(unsigned char, key_buffer));
-
-    stodium_release_output(jenv, dst,   &dst_buffer);
-    stodium_release_output(jenv, mac,   &mac_buffer);
-    stodium_release_input(jenv,  src,   &src_buffer);
-    stodium_release_input(jenv,  ad,    &ad_buffer);
-    stodium_release_input(jenv,  nonce, &nonce_buffer);
-    stodium_release_input(jenv,  key,   &key_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -752,16 +1403,18 @@ STODIUM_JNI(jint, crypto_1aead_1xchacha20poly1305_1ietf_1encrypt) (JNIEnv *jenv,
         jobject ad,
         jobject nonce,
         jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_AEAD);
     stodium_buffer dst_buffer, src_buffer, ad_buffer, nonce_buffer, key_buffer;
-    stodium_get_buffer(jenv, &dst_buffer,   dst);
-    stodium_get_buffer(jenv, &src_buffer,   src);
-    stodium_get_buffer(jenv, &ad_buffer,    ad);
-    stodium_get_buffer(jenv, &nonce_buffer, nonce);
-    stodium_get_buffer(jenv, &key_buffer,   key);
- 
+    stodium_get_critical_output(jenv, &dst_buffer,   dst);
+    stodium_get_critical_input(jenv,  &src_buffer,   src);
+    stodium_get_critical_input(jenv,  &ad_buffer,    ad);
+    stodium_get_critical_input(jenv,  &nonce_buffer, nonce);
+    stodium_get_critical_input(jenv,  &key_buffer,   key);
+
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &src_buffer, &ad_buffer, &nonce_buffer, &key_buffer);
     jint result = (jint) crypto_aead_xchacha20poly1305_ietf_encrypt(
             AS_OUTPUT(unsigned char, dst_buffer),
-            AS_OUTPUT_LEN(unsigned long long, dst_buffer),
+            NULL,
             AS_INPUT(unsigned char, src_buffer),
             AS_INPUT_LEN(unsigned long long, src_buffer),
             AS_INPUT(unsigned char, ad_buffer),
@@ -769,12 +1422,7 @@ STODIUM_JNI(jint, crypto_1aead_1xchacha20poly1305_1ietf_1encrypt) (JNIEnv *jenv,
             NULL, // nsec
             AS_INPUT(unsigned char, nonce_buffer),
             AS_INPUT(unsigned char, key_buffer));
-
-    stodium_release_output(jenv, dst,   &dst_buffer);
-    stodium_release_input(jenv,  src,   &src_buffer);
-    stodium_release_input(jenv,  ad,    &ad_buffer);
-    stodium_release_input(jenv,  nonce, &nonce_buffer);
-    stodium_release_input(jenv,  key,   &key_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -786,14 +1434,16 @@ STODIUM_JNI(jint, crypto_1aead_1xchacha20poly1305_1ietf_1decrypt_1detached) (JNI
         jobject ad,
         jobject nonce,
         jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_AEAD);
     stodium_buffer dst_buffer, mac_buffer, src_buffer, ad_buffer, nonce_buffer, key_buffer;
-    stodium_get_buffer(jenv, &dst_buffer,   dst);
-    stodium_get_buffer(jenv, &src_buffer,   src);
-    stodium_get_buffer(jenv, &mac_buffer,   mac);
-    stodium_get_buffer(jenv, &ad_buffer,    ad);
-    stodium_get_buffer(jenv, &nonce_buffer, nonce);
-    stodium_get_buffer(jenv, &key_buffer,   key);
- 
+    stodium_get_critical_output(jenv, &dst_buffer,   dst);
+    stodium_get_critical_input(jenv,  &src_buffer,   src);
+    stodium_get_critical_input(jenv,  &mac_buffer,   mac);
+    stodium_get_critical_input(jenv,  &ad_buffer,    ad);
+    stodium_get_critical_input(jenv,  &nonce_buffer, nonce);
+    stodium_get_critical_input(jenv,  &key_buffer,   key);
+
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &src_buffer, &mac_buffer, &ad_buffer, &nonce_buffer, &key_buffer);
     jint result = (jint) crypto_aead_xchacha20poly1305_ietf_decrypt_detached(
             AS_OUTPUT(unsigned char, dst_buffer),
             NULL, // nsec
@@ -804,13 +1454,7 @@ STODIUM_JNI(jint, crypto_1aead_1xchacha20poly1305_1ietf_1decrypt_1detached) (JNI
             AS_INPUT_LEN(unsigned long long, ad_buffer),
             AS_INPUT(unsigned char, nonce_buffer),
             AS_INPUT(unsigned char, key_buffer));
-
-    stodium_release_output(jenv, dst,   &dst_buffer);
-    stodium_release_input(jenv,  mac,   &mac_buffer);
-    stodium_release_input(jenv,  src,   &src_buffer);
-    stodium_release_input(jenv,  ad,    &ad_buffer);
-    stodium_release_input(jenv,  nonce, &nonce_buffer);
-    stodium_release_input(jenv,  key,   &key_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -821,16 +1465,18 @@ STODIUM_JNI(jint, crypto_1aead_1xchacha20poly1305_1ietf_1decrypt) (JNIEnv *jenv,
         jobject ad,
         jobject nonce,
         jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_AEAD);
     stodium_buffer dst_buffer, src_buffer, ad_buffer, nonce_buffer, key_buffer;
-    stodium_get_buffer(jenv, &dst_buffer,   dst);
-    stodium_get_buffer(jenv, &src_buffer,   src);
-    stodium_get_buffer(jenv, &ad_buffer,    ad);
-    stodium_get_buffer(jenv, &nonce_buffer, nonce);
-    stodium_get_buffer(jenv, &key_buffer,   key);
- 
+    stodium_get_critical_output(jenv, &dst_buffer,   dst);
+    stodium_get_critical_input(jenv,  &src_buffer,   src);
+    stodium_get_critical_input(jenv,  &ad_buffer,    ad);
+    stodium_get_critical_input(jenv,  &nonce_buffer, nonce);
+    stodium_get_critical_input(jenv,  &key_buffer,   key);
+
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &src_buffer, &ad_buffer, &nonce_buffer, &key_buffer);
     jint result = (jint) crypto_aead_xchacha20poly1305_ietf_decrypt(
             AS_OUTPUT(unsigned char, dst_buffer),
-            AS_OUTPUT_LEN(unsigned long long, dst_buffer),
+            NULL,
             NULL, // nsec
             AS_INPUT(unsigned char, src_buffer),
             AS_INPUT_LEN(unsigned long long, src_buffer),
@@ -838,434 +1484,1514 @@ STODIUM_JNI(jint, crypto_1aead_1xchacha20poly1305_1ietf_1decrypt) (JNIEnv *jenv,
             AS_INPUT_LEN(unsigned long long, ad_buffer),
             AS_INPUT(unsigned char, nonce_buffer),
             AS_INPUT(unsigned char, key_buffer));
-
-    stodium_release_output(jenv, dst,   &dst_buffer);
-    stodium_release_input(jenv,  src,   &src_buffer);
-    stodium_release_input(jenv,  ad,    &ad_buffer);
-    stodium_release_input(jenv,  nonce, &nonce_buffer);
-    stodium_release_input(jenv,  key,   &key_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
 
 /** ****************************************************************************
  *
- * AUTH
+ * AEAD - Batch
  *
  **************************************************************************** */
 
-STODIUM_CONSTANT_STR(auth)
+/**
+ * The nonce modes of the batch methods. STODIUM_NONCE_EACH reads one nonce per
+ * message, STODIUM_NONCE_COUNTER reads a single base nonce that is incremented
+ * (as with sodium_increment) for every following message.
+ */
+#define STODIUM_NONCE_EACH    0
+#define STODIUM_NONCE_COUNTER 1
 
-/** ****************************************************************************
- *
- * AUTH - HMAC-256
- *
- **************************************************************************** */
+/**
+ * The signatures shared by the combined-mode encrypt and decrypt methods of
+ * every AEAD construction in libsodium.
+ */
+typedef int (*stodium_aead_encrypt_fn)(
+        unsigned char *c, unsigned long long *clen_p,
+        const unsigned char *m, unsigned long long mlen,
+        const unsigned char *ad, unsigned long long adlen,
+        const unsigned char *nsec, const unsigned char *npub, const unsigned char *k);
+typedef int (*stodium_aead_decrypt_fn)(
+        unsigned char *m, unsigned long long *mlen_p, unsigned char *nsec,
+        const unsigned char *c, unsigned long long clen,
+        const unsigned char *ad, unsigned long long adlen,
+        const unsigned char *npub, const unsigned char *k);
 
-STODIUM_CONSTANT(auth, hmacsha256, bytes)
-STODIUM_CONSTANT(auth, hmacsha256, keybytes)
-STODIUM_CONSTANT(auth, hmacsha256, statebytes)
+/**
+ * stodium_aead_batch describes a batch of messages that share a key and the
+ * additional data. The table holds an (offset, length) pair for every message
+ * in src; the results are written back to back to dst, in the same order.
+ * chunks holds the offset in dst of the first result of every chunk of
+ * STODIUM_POOL_GRAIN messages, so the chunks can be handled independently.
+ */
+typedef struct stodium_aead_batch {
+    stodium_aead_encrypt_fn encrypt; // Only defined for encryption batches
+    stodium_aead_decrypt_fn decrypt; // Only defined for decryption batches
+    size_t                  keybytes;
+    size_t                  npubbytes;
+    size_t                  abytes;
+    size_t                  count;
+    unsigned char          *dst;
+    const unsigned char    *src;
+    const jint             *table;
+    const unsigned char    *ad;
+    unsigned long long      adlen;
+    const unsigned char    *nonces;
+    jint                    nonce_mode;
+    const unsigned char    *key;
+    jint                   *status;
+    size_t                 *chunks;
+} stodium_aead_batch;
 
-STODIUM_JNI(jint, crypto_1auth_1hmacsha256) (JNIEnv *jenv, jclass jcls,
-        jobject mac,
-        jobject src,
-        jobject key) {
-    stodium_buffer mac_buffer, src_buffer, key_buffer;
-    stodium_get_buffer(jenv, &mac_buffer, mac);
-    stodium_get_buffer(jenv, &src_buffer, src);
-    stodium_get_buffer(jenv, &key_buffer, key);
+/**
+ * stodium_nonce_add writes base + n to dst, treating both as little-endian
+ * numbers of len bytes, matching the order used by sodium_increment.
+ */
+static void stodium_nonce_add(unsigned char *dst, const unsigned char *base, size_t len, uint64_t n) {
+    unsigned int carry = 0;
+    size_t i;
+    for (i = 0; i < len; i++) {
+        carry  += (unsigned int) base[i] + (unsigned int) (n & 0xff);
+        dst[i]  = (unsigned char) carry;
+        carry >>= 8;
+        n     >>= 8;
+    }
+}
 
-    jint result = (jint) crypto_auth_hmacsha256(
-            AS_OUTPUT(unsigned char, mac_buffer),
-            AS_INPUT(unsigned char, src_buffer),
-            AS_INPUT_LEN(unsigned long long, src_buffer),
-            AS_INPUT(unsigned char, key_buffer));
+/**
+ * stodium_aead_batch_check verifies that every message in the table lies within
+ * src, that the results fit in dst and that enough nonces were passed, before
+ * any of the messages is handled.
+ */
+static bool stodium_aead_batch_check(const stodium_aead_batch *batch,
+        size_t src_len, size_t dst_len, size_t nonces_len, size_t key_len) {
+    size_t i, total = 0;
 
-    stodium_release_output(jenv, mac, &mac_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
-    stodium_release_input(jenv, key, &key_buffer);
+    if (key_len < batch->keybytes) {
+        return false;
+    }
+    if (nonces_len / batch->npubbytes < (batch->nonce_mode == STODIUM_NONCE_COUNTER ? 1 : batch->count)) {
+        return false;
+    }
 
-    return result;
+    for (i = 0; i < batch->count; i++) {
+        jint offset = batch->table[2 * i];
+        jint length = batch->table[2 * i + 1];
+        if (i % STODIUM_POOL_GRAIN == 0) {
+            batch->chunks[i / STODIUM_POOL_GRAIN] = total;
+        }
+        if (offset < 0 || length < 0
+                || (size_t) offset > src_len
+                || (size_t) length > src_len - (size_t) offset) {
+            return false;
+        }
+
+        if (batch->encrypt != NULL) {
+            total += (size_t) length + batch->abytes;
+        } else if ((size_t) length >= batch->abytes) {
+            total += (size_t) length - batch->abytes;
+        } else {
+            return false;
+        }
+        if (total > dst_len) {
+            return false;
+        }
+    }
+    return true;
 }
 
-STODIUM_JNI(jint, crypto_1auth_1hmacsha256_1verify) (JNIEnv *jenv, jclass jcls,
-        jobject mac,
-        jobject src,
-        jobject key) {
-    stodium_buffer mac_buffer, src_buffer, key_buffer;
-    stodium_get_buffer(jenv, &mac_buffer, mac);
-    stodium_get_buffer(jenv, &src_buffer, src);
-    stodium_get_buffer(jenv, &key_buffer, key);
-
-    jint result = (jint) crypto_auth_hmacsha256_verify(
-            AS_OUTPUT(unsigned char, mac_buffer),
-            AS_INPUT(unsigned char, src_buffer),
-            AS_INPUT_LEN(unsigned long long, src_buffer),
-            AS_INPUT(unsigned char, key_buffer));
-
-    stodium_release_input(jenv, mac, &mac_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
-    stodium_release_input(jenv, key, &key_buffer);
+/**
+ * stodium_aead_batch_run handles the messages [begin, end) of the batch, where
+ * dst_offset is the offset in dst of the result for message begin. The status
+ * of every message is stored separately, so a single forged message does not
+ * affect the rest of the batch. The output of a message that failed to decrypt
+ * is zeroed.
+ *
+ * Returns the number of messages that failed.
+ */
+static size_t stodium_aead_batch_run(const stodium_aead_batch *batch,
+        size_t begin, size_t end, size_t dst_offset) {
+    unsigned char nonce[32];
+    size_t i, failed = 0;
+
+    for (i = begin; i < end; i++) {
+        const unsigned char *src    = batch->src + batch->table[2 * i];
+        size_t               length = (size_t) batch->table[2 * i + 1];
+        unsigned char       *dst    = batch->dst + dst_offset;
+        const unsigned char *npub   = nonce;
+        int result;
+
+        if (batch->nonce_mode == STODIUM_NONCE_COUNTER) {
+            stodium_nonce_add(nonce, batch->nonces, batch->npubbytes, (uint64_t) i);
+        } else {
+            npub = batch->nonces + i * batch->npubbytes;
+        }
+
+        if (batch->encrypt != NULL) {
+            result = batch->encrypt(dst, NULL, src, length,
+                    batch->ad, batch->adlen, NULL, npub, batch->key);
+            dst_offset += length + batch->abytes;
+        } else {
+            result = batch->decrypt(dst, NULL, NULL, src, length,
+                    batch->ad, batch->adlen, npub, batch->key);
+            if (result != 0) {
+                sodium_memzero(dst, length - batch->abytes);
+            }
+            dst_offset += length - batch->abytes;
+        }
+
+        batch->status[i] = (jint) result;
+        failed += result != 0;
+    }
+    return failed;
+}
 
-    return result;
+/**
+ * stodium_aead_batch_task is the stodium_pool_task for an AEAD batch.
+ */
+static void stodium_aead_batch_task(void *ctx, size_t begin, size_t end) {
+    const stodium_aead_batch *batch = (const stodium_aead_batch *) ctx;
+    stodium_aead_batch_run(batch, begin, end, batch->chunks[begin / STODIUM_POOL_GRAIN]);
 }
 
-STODIUM_JNI(jint, crypto_1auth_1hmacsha256_1init) (JNIEnv *jenv, jclass jcls,
-        jobject dst,
-        jobject key) {
-    stodium_buffer dst_buffer, key_buffer;
-    stodium_get_buffer(jenv, &dst_buffer, dst);
-    stodium_get_buffer(jenv, &key_buffer, key);
+/**
+ * stodium_aead_batch_call resolves the arguments of a batch call and runs the
+ * batch, on the worker pool if one was started. Returns the number of messages
+ * that failed, or -1 if the arguments (including an unknown nonce_mode) were
+ * invalid.
+ */
+static jint stodium_aead_batch_call(JNIEnv *jenv, stodium_aead_batch *batch,
+        jobject    dst,
+        jobject    src,
+        jintArray  table,
+        jobject    ad,
+        jobject    nonces,
+        jint       nonce_mode,
+        jobject    key,
+        jintArray  status) {
+    STODIUM_STATS_CALL(STODIUM_STATS_AEAD);
+    jint *table_elements, *status_elements;
+    jint result = -1;
+    size_t i;
+
+    if (nonce_mode != STODIUM_NONCE_EACH && nonce_mode != STODIUM_NONCE_COUNTER) {
+        return -1;
+    }
+    batch->count      = (size_t) ((*jenv)->GetArrayLength(jenv, table) / 2);
+    batch->nonce_mode = nonce_mode;
+    if ((size_t) (*jenv)->GetArrayLength(jenv, status) < batch->count) {
+        return -1;
+    }
 
-    jint result = (jint) crypto_auth_hmacsha256_init(
-            AS_OUTPUT(crypto_auth_hmacsha256_state, dst_buffer),
-            AS_INPUT(unsigned char, key_buffer),
-            AS_INPUT_LEN(size_t, key_buffer));
+    batch->chunks = (size_t *) malloc((batch->count / STODIUM_POOL_GRAIN + 1) * sizeof(size_t));
+    if (batch->chunks == NULL) {
+        return -1;
+    }
+    table_elements = (*jenv)->GetIntArrayElements(jenv, table, NULL);
+    if (table_elements == NULL) {
+        free(batch->chunks);
+        return -1;
+    }
+    status_elements = (*jenv)->GetIntArrayElements(jenv, status, NULL);
+    if (status_elements == NULL) {
+        (*jenv)->ReleaseIntArrayElements(jenv, table, table_elements, JNI_ABORT);
+        free(batch->chunks);
+        return -1;
+    }
 
-    stodium_release_output(jenv, dst, &dst_buffer);
-    stodium_release_input(jenv, key, &key_buffer);
+    stodium_buffer dst_buffer, src_buffer, ad_buffer, nonces_buffer, key_buffer;
+    stodium_get_critical_output(jenv, &dst_buffer,    dst);
+    stodium_get_critical_input(jenv,  &src_buffer,    src);
+    stodium_get_critical_input(jenv,  &ad_buffer,     ad);
+    stodium_get_critical_input(jenv,  &nonces_buffer, nonces);
+    stodium_get_critical_input(jenv,  &key_buffer,    key);
+
+    stodium_buffer *buffers[] = { &dst_buffer, &src_buffer, &ad_buffer, &nonces_buffer, &key_buffer };
+    if (stodium_critical_begin(jenv, buffers, 5)) {
+        batch->dst    = AS_OUTPUT(unsigned char, dst_buffer);
+        batch->src    = AS_INPUT(unsigned char, src_buffer);
+        batch->table  = table_elements;
+        batch->ad     = AS_INPUT(unsigned char, ad_buffer);
+        batch->adlen  = AS_INPUT_LEN(unsigned long long, ad_buffer);
+        batch->nonces = AS_INPUT(unsigned char, nonces_buffer);
+        batch->key    = AS_INPUT(unsigned char, key_buffer);
+        batch->status = status_elements;
+
+        if (stodium_aead_batch_check(batch, src_buffer.capacity, dst_buffer.capacity,
+                    nonces_buffer.capacity, key_buffer.capacity)) {
+            stodium_pool_run(stodium_aead_batch_task, batch, batch->count, STODIUM_POOL_GRAIN);
+            for (result = 0, i = 0; i < batch->count; i++) {
+                result += status_elements[i] != 0;
+            }
+        }
+        stodium_critical_end(jenv, buffers, 5);
+    }
+
+    (*jenv)->ReleaseIntArrayElements(jenv, status, status_elements, result < 0 ? JNI_ABORT : 0);
+    (*jenv)->ReleaseIntArrayElements(jenv, table, table_elements, JNI_ABORT);
+    free(batch->chunks);
 
     return result;
 }
 
-STODIUM_JNI(jint, crypto_1auth_1hmacsha256_1update) (JNIEnv *jenv, jclass jcls,
+/**
+ * STODIUM_AEAD_BATCH defines the encrypt_batch and decrypt_batch wrappers for
+ * an AEAD construction.
+ *
+ * @jname:     the name of the construction, escaped for use in a JNI name
+ * @primitive: the name of the construction (e.g. chacha20poly1305_ietf)
+ */
+#define STODIUM_AEAD_BATCH(jname, primitive) \
+    STODIUM_JNI(jint, crypto_1aead_1##jname##_1encrypt_1batch) (JNIEnv *jenv, jclass jcls, \
+            jobject dst, jobject src, jintArray table, jobject ad, jobject nonces, jint nonce_mode, jobject key, jintArray status) { \
+        stodium_aead_batch batch = { .encrypt = crypto_aead_##primitive##_encrypt, \
+                .keybytes  = crypto_aead_##primitive##_keybytes(), \
+                .npubbytes = crypto_aead_##primitive##_npubbytes(), \
+                .abytes    = crypto_aead_##primitive##_abytes() }; \
+        return stodium_aead_batch_call(jenv, &batch, dst, src, table, ad, nonces, nonce_mode, key, status); } \
+    STODIUM_JNI(jint, crypto_1aead_1##jname##_1decrypt_1batch) (JNIEnv *jenv, jclass jcls, \
+            jobject dst, jobject src, jintArray table, jobject ad, jobject nonces, jint nonce_mode, jobject key, jintArray status) { \
+        stodium_aead_batch batch = { .decrypt = crypto_aead_##primitive##_decrypt, \
+                .keybytes  = crypto_aead_##primitive##_keybytes(), \
+                .npubbytes = crypto_aead_##primitive##_npubbytes(), \
+                .abytes    = crypto_aead_##primitive##_abytes() }; \
+        return stodium_aead_batch_call(jenv, &batch, dst, src, table, ad, nonces, nonce_mode, key, status); }
+
+STODIUM_AEAD_BATCH(aes256gcm, aes256gcm)
+STODIUM_AEAD_BATCH(chacha20poly1305, chacha20poly1305)
+STODIUM_AEAD_BATCH(chacha20poly1305_1ietf, chacha20poly1305_ietf)
+STODIUM_AEAD_BATCH(xchacha20poly1305_1ietf, xchacha20poly1305_ietf)
+
+/**
+ * stodium_aead_encrypt_prefixed encrypts src to dst as the nonce followed by
+ * the ciphertext, then increments the nonce with sodium_increment, so the same
+ * buffer holds the nonce of the next message. Returns the status of the
+ * encryption, or -1 if the arguments were invalid.
+ */
+static jint stodium_aead_encrypt_prefixed(JNIEnv *jenv, stodium_aead_encrypt_fn encrypt,
+        size_t  keybytes,
+        size_t  npubbytes,
+        size_t  abytes,
         jobject dst,
-        jobject src) {
-    stodium_buffer dst_buffer, src_buffer;
-    stodium_get_buffer(jenv, &dst_buffer, dst);
-    stodium_get_buffer(jenv, &src_buffer, src);
+        jobject src,
+        jobject ad,
+        jobject nonce,
+        jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_AEAD);
+    stodium_buffer dst_buffer, src_buffer, ad_buffer, nonce_buffer, key_buffer;
+    stodium_get_critical_output(jenv, &dst_buffer,   dst);
+    stodium_get_critical_input(jenv,  &src_buffer,   src);
+    stodium_get_critical_input(jenv,  &ad_buffer,    ad);
+    stodium_get_critical_output(jenv, &nonce_buffer, nonce);
+    stodium_get_critical_input(jenv,  &key_buffer,   key);
+    if (nonce_buffer.capacity != npubbytes || key_buffer.capacity != keybytes ||
+            dst_buffer.capacity < npubbytes + abytes ||
+            dst_buffer.capacity - npubbytes - abytes < src_buffer.capacity) {
+        return -1;
+    }
 
-    jint result = (jint) crypto_auth_hmacsha256_update(
-            AS_OUTPUT(crypto_auth_hmacsha256_state, dst_buffer),
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &src_buffer, &ad_buffer, &nonce_buffer, &key_buffer);
+    unsigned char *out = AS_OUTPUT(unsigned char, dst_buffer);
+    unsigned char *npub = AS_OUTPUT(unsigned char, nonce_buffer);
+    memcpy(out, npub, npubbytes);
+    jint result = (jint) encrypt(
+            out + npubbytes,
+            NULL,
             AS_INPUT(unsigned char, src_buffer),
-            AS_INPUT_LEN(unsigned long long, src_buffer));
-
-    stodium_release_output(jenv, dst, &dst_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
+            AS_INPUT_LEN(unsigned long long, src_buffer),
+            AS_INPUT(unsigned char, ad_buffer),
+            AS_INPUT_LEN(unsigned long long, ad_buffer),
+            NULL, // nsec
+            out,
+            AS_INPUT(unsigned char, key_buffer));
+    if (result == 0) {
+        sodium_increment(npub, npubbytes);
+    }
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
 
-STODIUM_JNI(jint, crypto_1auth_1hmacsha256_1final) (JNIEnv *jenv, jclass jcls,
-        jobject state,
-        jobject dst) {
-    stodium_buffer state_buffer, dst_buffer;
-    stodium_get_buffer(jenv, &state_buffer, state);
-    stodium_get_buffer(jenv, &dst_buffer, dst);
-
-    jint result = (jint) crypto_auth_hmacsha256_final(
-            AS_OUTPUT(crypto_auth_hmacsha256_state, state_buffer),
-            AS_OUTPUT(unsigned char, dst_buffer));
+/**
+ * stodium_aead_decrypt_prefixed decrypts src, the nonce followed by the
+ * ciphertext as written by stodium_aead_encrypt_prefixed, to dst. Returns the
+ * status of the decryption, or -1 if the arguments were invalid.
+ */
+static jint stodium_aead_decrypt_prefixed(JNIEnv *jenv, stodium_aead_decrypt_fn decrypt,
+        size_t  keybytes,
+        size_t  npubbytes,
+        size_t  abytes,
+        jobject dst,
+        jobject src,
+        jobject ad,
+        jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_AEAD);
+    stodium_buffer dst_buffer, src_buffer, ad_buffer, key_buffer;
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
+    stodium_get_critical_input(jenv,  &ad_buffer,  ad);
+    stodium_get_critical_input(jenv,  &key_buffer, key);
+    if (key_buffer.capacity != keybytes || src_buffer.capacity < npubbytes + abytes ||
+            dst_buffer.capacity < src_buffer.capacity - npubbytes - abytes) {
+        return -1;
+    }
 
-    stodium_release_output(jenv, state, &state_buffer);
-    stodium_release_output(jenv, dst, &dst_buffer);
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &src_buffer, &ad_buffer, &key_buffer);
+    const unsigned char *in = AS_INPUT(unsigned char, src_buffer);
+    jint result = (jint) decrypt(
+            AS_OUTPUT(unsigned char, dst_buffer),
+            NULL,
+            NULL, // nsec
+            in + npubbytes,
+            AS_INPUT_LEN(unsigned long long, src_buffer) - npubbytes,
+            AS_INPUT(unsigned char, ad_buffer),
+            AS_INPUT_LEN(unsigned long long, ad_buffer),
+            in,
+            AS_INPUT(unsigned char, key_buffer));
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
 
+/**
+ * STODIUM_AEAD_PREFIXED defines the encrypt_prefixed and decrypt_prefixed
+ * wrappers for an AEAD construction.
+ *
+ * @jname:     the name of the construction, escaped for use in a JNI name
+ * @primitive: the name of the construction (e.g. chacha20poly1305_ietf)
+ */
+#define STODIUM_AEAD_PREFIXED(jname, primitive) \
+    STODIUM_JNI(jint, crypto_1aead_1##jname##_1encrypt_1prefixed) (JNIEnv *jenv, jclass jcls, \
+            jobject dst, jobject src, jobject ad, jobject nonce, jobject key) { \
+        return stodium_aead_encrypt_prefixed(jenv, crypto_aead_##primitive##_encrypt, \
+                crypto_aead_##primitive##_keybytes(), crypto_aead_##primitive##_npubbytes(), crypto_aead_##primitive##_abytes(), \
+                dst, src, ad, nonce, key); } \
+    STODIUM_JNI(jint, crypto_1aead_1##jname##_1decrypt_1prefixed) (JNIEnv *jenv, jclass jcls, \
+            jobject dst, jobject src, jobject ad, jobject key) { \
+        return stodium_aead_decrypt_prefixed(jenv, crypto_aead_##primitive##_decrypt, \
+                crypto_aead_##primitive##_keybytes(), crypto_aead_##primitive##_npubbytes(), crypto_aead_##primitive##_abytes(), \
+                dst, src, ad, key); }
+
+STODIUM_AEAD_PREFIXED(aes256gcm, aes256gcm)
+STODIUM_AEAD_PREFIXED(chacha20poly1305, chacha20poly1305)
+STODIUM_AEAD_PREFIXED(chacha20poly1305_1ietf, chacha20poly1305_ietf)
+STODIUM_AEAD_PREFIXED(xchacha20poly1305_1ietf, xchacha20poly1305_ietf)
+
 /** ****************************************************************************
  *
- * AUTH - HMAC-512
+ * AEAD - In-place and verify-only
  *
  **************************************************************************** */
 
-STODIUM_CONSTANT(auth, hmacsha512, bytes)
-STODIUM_CONSTANT(auth, hmacsha512, keybytes)
-STODIUM_CONSTANT(auth, hmacsha512, statebytes)
+/**
+ * The signatures shared by the detached-mode encrypt and decrypt methods of
+ * every AEAD construction in libsodium.
+ */
+typedef int (*stodium_aead_encrypt_detached_fn)(
+        unsigned char *c, unsigned char *mac, unsigned long long *maclen_p,
+        const unsigned char *m, unsigned long long mlen,
+        const unsigned char *ad, unsigned long long adlen,
+        const unsigned char *nsec, const unsigned char *npub, const unsigned char *k);
+typedef int (*stodium_aead_decrypt_detached_fn)(
+        unsigned char *m, unsigned char *nsec,
+        const unsigned char *c, unsigned long long clen,
+        const unsigned char *mac,
+        const unsigned char *ad, unsigned long long adlen,
+        const unsigned char *npub, const unsigned char *k);
 
-STODIUM_JNI(jint, crypto_1auth_1hmacsha512) (JNIEnv *jenv, jclass jcls,
-        jobject mac,
-        jobject src,
-        jobject key) {
-    stodium_buffer mac_buffer, src_buffer, key_buffer;
-    stodium_get_buffer(jenv, &mac_buffer, mac);
-    stodium_get_buffer(jenv, &src_buffer, src);
-    stodium_get_buffer(jenv, &key_buffer, key);
+/**
+ * stodium_aead_verify_fn checks the detached tag of a ciphertext without
+ * decrypting it. Returns 0 if the tag is valid, -1 otherwise.
+ */
+typedef int (*stodium_aead_verify_fn)(
+        const unsigned char *c, unsigned long long clen,
+        const unsigned char *mac,
+        const unsigned char *ad, unsigned long long adlen,
+        const unsigned char *npub, const unsigned char *k);
 
-    jint result = (jint) crypto_auth_hmacsha512(
-            AS_OUTPUT(unsigned char, mac_buffer),
-            AS_INPUT(unsigned char, src_buffer),
-            AS_INPUT_LEN(unsigned long long, src_buffer),
-            AS_INPUT(unsigned char, key_buffer));
+/**
+ * stodium_aead_constants are the sizes of an AEAD construction, and its
+ * detached-mode and verify-only functions.
+ */
+typedef struct stodium_aead_constants {
+    size_t                           keybytes;
+    size_t                           npubbytes;
+    size_t                           abytes;
+    stodium_aead_encrypt_fn          encrypt;
+    stodium_aead_decrypt_fn          decrypt;
+    stodium_aead_encrypt_detached_fn encrypt_detached;
+    stodium_aead_decrypt_detached_fn decrypt_detached;
+    stodium_aead_verify_fn           verify;
+} stodium_aead_constants;
+
+static void stodium_poly1305_update_length(crypto_onetimeauth_poly1305_state *state,
+        unsigned long long len) {
+    unsigned char block[8];
+    size_t i;
+    for (i = 0; i < 8; i++) {
+        block[i] = (unsigned char) (len >> (8 * i));
+    }
+    crypto_onetimeauth_poly1305_update(state, block, sizeof block);
+}
 
-    stodium_release_output(jenv, mac, &mac_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
-    stodium_release_input(jenv, key, &key_buffer);
+static void stodium_poly1305_update_pad(crypto_onetimeauth_poly1305_state *state,
+        unsigned long long len) {
+    static const unsigned char zero[16] = { 0 };
+    crypto_onetimeauth_poly1305_update(state, zero, (16 - len % 16) % 16);
+}
 
+/**
+ * stodium_chacha20poly1305_verify_tag computes the Poly1305 tag of a
+ * ChaCha20-Poly1305 ciphertext, as libsodium does before decrypting: with the
+ * one-time key of the first ChaCha20 block (block0), over the original or the
+ * IETF padding of ad and c. It compares the tag with mac in constant time.
+ */
+static int stodium_chacha20poly1305_verify_tag(const unsigned char block0[64],
+        bool ietf,
+        const unsigned char *c, unsigned long long clen,
+        const unsigned char *mac,
+        const unsigned char *ad, unsigned long long adlen) {
+    crypto_onetimeauth_poly1305_state state;
+    unsigned char computed[crypto_onetimeauth_poly1305_BYTES];
+    int result;
+
+    crypto_onetimeauth_poly1305_init(&state, block0);
+    crypto_onetimeauth_poly1305_update(&state, ad, adlen);
+    if (ietf) {
+        stodium_poly1305_update_pad(&state, adlen);
+    } else {
+        stodium_poly1305_update_length(&state, adlen);
+    }
+    crypto_onetimeauth_poly1305_update(&state, c, clen);
+    if (ietf) {
+        stodium_poly1305_update_pad(&state, clen);
+        stodium_poly1305_update_length(&state, adlen);
+    }
+    stodium_poly1305_update_length(&state, clen);
+    crypto_onetimeauth_poly1305_final(&state, computed);
+
+    result = crypto_verify_16(computed, mac);
+    sodium_memzero(&state, sizeof state);
+    sodium_memzero(computed, sizeof computed);
     return result;
 }
 
-STODIUM_JNI(jint, crypto_1auth_1hmacsha512_1verify) (JNIEnv *jenv, jclass jcls,
-        jobject mac,
-        jobject src,
-        jobject key) {
-    stodium_buffer mac_buffer, src_buffer, key_buffer;
-    stodium_get_buffer(jenv, &mac_buffer, mac);
-    stodium_get_buffer(jenv, &src_buffer, src);
-    stodium_get_buffer(jenv, &key_buffer, key);
+static int stodium_chacha20poly1305_verify(const unsigned char *c, unsigned long long clen,
+        const unsigned char *mac,
+        const unsigned char *ad, unsigned long long adlen,
+        const unsigned char *npub, const unsigned char *k) {
+    unsigned char block0[64];
+    int result;
 
-    jint result = (jint) crypto_auth_hmacsha512_verify(
-            AS_OUTPUT(unsigned char, mac_buffer),
-            AS_INPUT(unsigned char, src_buffer),
-            AS_INPUT_LEN(unsigned long long, src_buffer),
-            AS_INPUT(unsigned char, key_buffer));
+    crypto_stream_chacha20(block0, sizeof block0, npub, k);
+    result = stodium_chacha20poly1305_verify_tag(block0, false, c, clen, mac, ad, adlen);
+    sodium_memzero(block0, sizeof block0);
+    return result;
+}
 
-    stodium_release_input(jenv, mac, &mac_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
-    stodium_release_input(jenv, key, &key_buffer);
+static int stodium_chacha20poly1305_ietf_verify(const unsigned char *c, unsigned long long clen,
+        const unsigned char *mac,
+        const unsigned char *ad, unsigned long long adlen,
+        const unsigned char *npub, const unsigned char *k) {
+    unsigned char block0[64];
+    int result;
 
+    crypto_stream_chacha20_ietf(block0, sizeof block0, npub, k);
+    result = stodium_chacha20poly1305_verify_tag(block0, true, c, clen, mac, ad, adlen);
+    sodium_memzero(block0, sizeof block0);
     return result;
 }
 
-STODIUM_JNI(jint, crypto_1auth_1hmacsha512_1init) (JNIEnv *jenv, jclass jcls,
-        jobject dst,
-        jobject key) {
-    stodium_buffer dst_buffer, key_buffer;
-    stodium_get_buffer(jenv, &dst_buffer, dst);
-    stodium_get_buffer(jenv, &key_buffer, key);
+static int stodium_xchacha20poly1305_ietf_verify(const unsigned char *c, unsigned long long clen,
+        const unsigned char *mac,
+        const unsigned char *ad, unsigned long long adlen,
+        const unsigned char *npub, const unsigned char *k) {
+    unsigned char subkey[crypto_core_hchacha20_OUTPUTBYTES];
+    unsigned char npub2[crypto_aead_chacha20poly1305_ietf_NPUBBYTES] = { 0 };
+    int result;
 
-    jint result = (jint) crypto_auth_hmacsha512_init(
-            AS_OUTPUT(crypto_auth_hmacsha512_state, dst_buffer),
-            AS_INPUT(unsigned char, key_buffer),
-            AS_INPUT_LEN(size_t, key_buffer));
+    crypto_core_hchacha20(subkey, npub, k, NULL);
+    memcpy(npub2 + 4, npub + crypto_core_hchacha20_INPUTBYTES,
+            crypto_aead_chacha20poly1305_ietf_NPUBBYTES - 4);
+    result = stodium_chacha20poly1305_ietf_verify(c, clen, mac, ad, adlen, npub2, subkey);
+    sodium_memzero(subkey, sizeof subkey);
+    return result;
+}
 
-    stodium_release_output(jenv, dst, &dst_buffer);
-    stodium_release_input(jenv, key, &key_buffer);
+/**
+ * stodium_aes256gcm_verify checks an AES-256-GCM tag by decrypting to a
+ * scratch buffer: libsodium does not expose GHASH, and its AES-NI code
+ * computes the tag while decrypting.
+ */
+static int stodium_aes256gcm_verify(const unsigned char *c, unsigned long long clen,
+        const unsigned char *mac,
+        const unsigned char *ad, unsigned long long adlen,
+        const unsigned char *npub, const unsigned char *k) {
+    unsigned char *scratch = (unsigned char *) malloc((size_t) clen + 1);
+    int result;
+
+    if (scratch == NULL) {
+        return -1;
+    }
+    result = crypto_aead_aes256gcm_decrypt_detached(scratch, NULL, c, clen, mac,
+            ad, adlen, npub, k);
+    sodium_memzero(scratch, (size_t) clen);
+    free(scratch);
+    return result;
+}
+
+/**
+ * stodium_aead_encrypt_inplace encrypts the mlen bytes at the start of buf in
+ * place, and writes the tag after them (combined). When mac is not NULL, it
+ * encrypts all of buf and writes the tag to mac instead (detached). Returns the status of the encryption, or -1 if the
+ * arguments were invalid.
+ */
+static jint stodium_aead_encrypt_inplace(JNIEnv *jenv, const stodium_aead_constants *aead,
+        jobject buf,
+        jint    mlen,
+        jobject mac,
+        jobject ad,
+        jobject nonce,
+        jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_AEAD);
+    stodium_buffer buf_buffer, mac_buffer, ad_buffer, nonce_buffer, key_buffer;
+    stodium_get_critical_output(jenv, &buf_buffer,   buf);
+    stodium_get_critical_output(jenv, &mac_buffer,   mac);
+    stodium_get_critical_input(jenv,  &ad_buffer,    ad);
+    stodium_get_critical_input(jenv,  &nonce_buffer, nonce);
+    stodium_get_critical_input(jenv,  &key_buffer,   key);
+    if (mac != NULL) {
+        mlen = (jint) buf_buffer.capacity;
+    }
+    if (mlen < 0 || nonce_buffer.capacity < aead->npubbytes || key_buffer.capacity != aead->keybytes ||
+            (mac == NULL && buf_buffer.capacity - (size_t) mlen < aead->abytes) ||
+            (mac != NULL && mac_buffer.capacity < aead->abytes) ||
+            buf_buffer.capacity < (size_t) mlen) {
+        return -1;
+    }
+
+    STODIUM_CRITICAL_BEGIN(jenv, &buf_buffer, &mac_buffer, &ad_buffer, &nonce_buffer, &key_buffer);
+    unsigned char *data = AS_OUTPUT(unsigned char, buf_buffer);
+    jint result = mac == NULL
+            ? (jint) aead->encrypt(
+                    data, NULL,
+                    data, (unsigned long long) mlen,
+                    AS_INPUT(unsigned char, ad_buffer),
+                    AS_INPUT_LEN(unsigned long long, ad_buffer),
+                    NULL, // nsec
+                    AS_INPUT(unsigned char, nonce_buffer),
+                    AS_INPUT(unsigned char, key_buffer))
+            : (jint) aead->encrypt_detached(
+                    data, AS_OUTPUT(unsigned char, mac_buffer), NULL,
+                    data, (unsigned long long) mlen,
+                    AS_INPUT(unsigned char, ad_buffer),
+                    AS_INPUT_LEN(unsigned long long, ad_buffer),
+                    NULL, // nsec
+                    AS_INPUT(unsigned char, nonce_buffer),
+                    AS_INPUT(unsigned char, key_buffer));
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
 
-STODIUM_JNI(jint, crypto_1auth_1hmacsha512_1update) (JNIEnv *jenv, jclass jcls,
-        jobject dst,
-        jobject src) {
-    stodium_buffer dst_buffer, src_buffer;
-    stodium_get_buffer(jenv, &dst_buffer, dst);
-    stodium_get_buffer(jenv, &src_buffer, src);
+/**
+ * stodium_aead_decrypt_inplace decrypts buf in place: the ciphertext followed
+ * by its tag (combined), or the ciphertext alone with the tag in mac
+ * (detached, when mac is not NULL). Returns the status of the decryption, or
+ * -1 if the arguments were invalid.
+ */
+static jint stodium_aead_decrypt_inplace(JNIEnv *jenv, const stodium_aead_constants *aead,
+        jobject buf,
+        jobject mac,
+        jobject ad,
+        jobject nonce,
+        jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_AEAD);
+    stodium_buffer buf_buffer, mac_buffer, ad_buffer, nonce_buffer, key_buffer;
+    stodium_get_critical_output(jenv, &buf_buffer,   buf);
+    stodium_get_critical_input(jenv,  &mac_buffer,   mac);
+    stodium_get_critical_input(jenv,  &ad_buffer,    ad);
+    stodium_get_critical_input(jenv,  &nonce_buffer, nonce);
+    stodium_get_critical_input(jenv,  &key_buffer,   key);
+    if (nonce_buffer.capacity < aead->npubbytes || key_buffer.capacity != aead->keybytes ||
+            (mac == NULL && buf_buffer.capacity < aead->abytes) ||
+            (mac != NULL && mac_buffer.capacity < aead->abytes)) {
+        return -1;
+    }
 
-    jint result = (jint) crypto_auth_hmacsha512_update(
-            AS_OUTPUT(crypto_auth_hmacsha512_state, dst_buffer),
+    STODIUM_CRITICAL_BEGIN(jenv, &buf_buffer, &mac_buffer, &ad_buffer, &nonce_buffer, &key_buffer);
+    unsigned char *data = AS_OUTPUT(unsigned char, buf_buffer);
+    jint result = mac == NULL
+            ? (jint) aead->decrypt(
+                    data, NULL,
+                    NULL, // nsec
+                    data, AS_INPUT_LEN(unsigned long long, buf_buffer),
+                    AS_INPUT(unsigned char, ad_buffer),
+                    AS_INPUT_LEN(unsigned long long, ad_buffer),
+                    AS_INPUT(unsigned char, nonce_buffer),
+                    AS_INPUT(unsigned char, key_buffer))
+            : (jint) aead->decrypt_detached(
+                    data,
+                    NULL, // nsec
+                    data, AS_INPUT_LEN(unsigned long long, buf_buffer),
+                    AS_INPUT(unsigned char, mac_buffer),
+                    AS_INPUT(unsigned char, ad_buffer),
+                    AS_INPUT_LEN(unsigned long long, ad_buffer),
+                    AS_INPUT(unsigned char, nonce_buffer),
+                    AS_INPUT(unsigned char, key_buffer));
+    STODIUM_CRITICAL_END(jenv);
+
+    return result;
+}
+
+/**
+ * stodium_aead_verify_detached checks the tag mac of the ciphertext src,
+ * without writing any plaintext. Returns 0 if the tag is valid, and -1 if it
+ * is not or the arguments were invalid.
+ */
+static jint stodium_aead_verify_detached(JNIEnv *jenv, const stodium_aead_constants *aead,
+        jobject src,
+        jobject mac,
+        jobject ad,
+        jobject nonce,
+        jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_AEAD);
+    stodium_buffer src_buffer, mac_buffer, ad_buffer, nonce_buffer, key_buffer;
+    stodium_get_critical_input(jenv, &src_buffer,   src);
+    stodium_get_critical_input(jenv, &mac_buffer,   mac);
+    stodium_get_critical_input(jenv, &ad_buffer,    ad);
+    stodium_get_critical_input(jenv, &nonce_buffer, nonce);
+    stodium_get_critical_input(jenv, &key_buffer,   key);
+    if (mac_buffer.capacity < aead->abytes || nonce_buffer.capacity < aead->npubbytes ||
+            key_buffer.capacity != aead->keybytes) {
+        return -1;
+    }
+
+    STODIUM_CRITICAL_BEGIN(jenv, &src_buffer, &mac_buffer, &ad_buffer, &nonce_buffer, &key_buffer);
+    jint result = (jint) aead->verify(
             AS_INPUT(unsigned char, src_buffer),
-            AS_INPUT_LEN(unsigned long long, src_buffer));
+            AS_INPUT_LEN(unsigned long long, src_buffer),
+            AS_INPUT(unsigned char, mac_buffer),
+            AS_INPUT(unsigned char, ad_buffer),
+            AS_INPUT_LEN(unsigned long long, ad_buffer),
+            AS_INPUT(unsigned char, nonce_buffer),
+            AS_INPUT(unsigned char, key_buffer));
+    STODIUM_CRITICAL_END(jenv);
 
-    stodium_release_output(jenv, dst, &dst_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
+    return result;
+}
+
+/**
+ * STODIUM_AEAD_INPLACE defines the in-place and verify-only wrappers for an
+ * AEAD construction.
+ *
+ * @jname:     the name of the construction, escaped for use in a JNI name
+ * @primitive: the name of the construction (e.g. chacha20poly1305_ietf)
+ */
+#define STODIUM_AEAD_INPLACE(jname, primitive) \
+    static const stodium_aead_constants stodium_aead_##primitive = { \
+            crypto_aead_##primitive##_KEYBYTES, crypto_aead_##primitive##_NPUBBYTES, crypto_aead_##primitive##_ABYTES, \
+            crypto_aead_##primitive##_encrypt, crypto_aead_##primitive##_decrypt, \
+            crypto_aead_##primitive##_encrypt_detached, crypto_aead_##primitive##_decrypt_detached, \
+            stodium_##primitive##_verify }; \
+    STODIUM_JNI(jint, crypto_1aead_1##jname##_1encrypt_1inplace) (JNIEnv *jenv, jclass jcls, \
+            jobject buf, jint mlen, jobject ad, jobject nonce, jobject key) { \
+        return stodium_aead_encrypt_inplace(jenv, &stodium_aead_##primitive, buf, mlen, NULL, ad, nonce, key); } \
+    STODIUM_JNI(jint, crypto_1aead_1##jname##_1decrypt_1inplace) (JNIEnv *jenv, jclass jcls, \
+            jobject buf, jobject ad, jobject nonce, jobject key) { \
+        return stodium_aead_decrypt_inplace(jenv, &stodium_aead_##primitive, buf, NULL, ad, nonce, key); } \
+    STODIUM_JNI(jint, crypto_1aead_1##jname##_1encrypt_1detached_1inplace) (JNIEnv *jenv, jclass jcls, \
+            jobject buf, jobject mac, jobject ad, jobject nonce, jobject key) { \
+        return stodium_aead_encrypt_inplace(jenv, &stodium_aead_##primitive, buf, -1, mac, ad, nonce, key); } \
+    STODIUM_JNI(jint, crypto_1aead_1##jname##_1decrypt_1detached_1inplace) (JNIEnv *jenv, jclass jcls, \
+            jobject buf, jobject mac, jobject ad, jobject nonce, jobject key) { \
+        return stodium_aead_decrypt_inplace(jenv, &stodium_aead_##primitive, buf, mac, ad, nonce, key); } \
+    STODIUM_JNI(jint, crypto_1aead_1##jname##_1verify_1detached) (JNIEnv *jenv, jclass jcls, \
+            jobject src, jobject mac, jobject ad, jobject nonce, jobject key) { \
+        return stodium_aead_verify_detached(jenv, &stodium_aead_##primitive, src, mac, ad, nonce, key); }
+
+STODIUM_AEAD_INPLACE(aes256gcm, aes256gcm)
+STODIUM_AEAD_INPLACE(chacha20poly1305, chacha20poly1305)
+STODIUM_AEAD_INPLACE(chacha20poly1305_1ietf, chacha20poly1305_ietf)
+STODIUM_AEAD_INPLACE(xchacha20poly1305_1ietf, xchacha20poly1305_ietf)
+
+/** ****************************************************************************
+ *
+ * AEAD - Gather/scatter
+ *
+ * The ChaCha20 and Salsa20 based constructions are run over the fragments as
+ * a stream: each piece of a fragment is XORed with the keystream at its
+ * offset in the message (with the _xor_ic primitives), and fed to an
+ * incremental Poly1305, so the fragments are never concatenated.
+ *
+ **************************************************************************** */
+
+/**
+ * The layouts of the data authenticated by Poly1305: the original
+ * ChaCha20-Poly1305 (ad, its length, c, its length), the IETF constructions
+ * (ad and c each padded to 16 bytes, then both lengths), and secretbox (c).
+ */
+#define STODIUM_GATHER_AEAD      0
+#define STODIUM_GATHER_AEAD_IETF 1
+#define STODIUM_GATHER_SECRETBOX 2
+
+/**
+ * stodium_stream_xor_ic_fn is the signature of the _xor_ic stream primitives,
+ * with a 64-bit block counter for all of them.
+ */
+typedef int (*stodium_stream_xor_ic_fn)(
+        unsigned char *c, const unsigned char *m, unsigned long long mlen,
+        const unsigned char *n, uint64_t ic, const unsigned char *k);
+
+static int stodium_chacha20_xor_ic(unsigned char *c, const unsigned char *m, unsigned long long mlen,
+        const unsigned char *n, uint64_t ic, const unsigned char *k) {
+    return crypto_stream_chacha20_xor_ic(c, m, mlen, n, ic, k);
+}
+
+static int stodium_chacha20_ietf_xor_ic(unsigned char *c, const unsigned char *m, unsigned long long mlen,
+        const unsigned char *n, uint64_t ic, const unsigned char *k) {
+    return crypto_stream_chacha20_ietf_xor_ic(c, m, mlen, n, (uint32_t) ic, k);
+}
+
+static int stodium_salsa20_xor_ic(unsigned char *c, const unsigned char *m, unsigned long long mlen,
+        const unsigned char *n, uint64_t ic, const unsigned char *k) {
+    return crypto_stream_salsa20_xor_ic(c, m, mlen, n, ic, k);
+}
+
+/**
+ * stodium_gather_cipher is a construction set up for one message: the stream
+ * and its (sub)key and nonce, the layout of the authenticated data, and the
+ * number of keystream bytes before the message, which are used for the
+ * Poly1305 key.
+ */
+typedef struct stodium_gather_cipher {
+    stodium_stream_xor_ic_fn xor_ic;
+    int                      layout;
+    uint64_t                 skip;
+    unsigned char            nonce[crypto_aead_chacha20poly1305_ietf_NPUBBYTES];
+    unsigned char            key[crypto_stream_chacha20_KEYBYTES];
+} stodium_gather_cipher;
+
+/**
+ * stodium_gather_setup_fn sets up cipher for the nonce npub and key k.
+ */
+typedef void (*stodium_gather_setup_fn)(stodium_gather_cipher *cipher,
+        const unsigned char *npub, const unsigned char *k);
+
+static void stodium_chacha20poly1305_gather_setup(stodium_gather_cipher *cipher,
+        const unsigned char *npub, const unsigned char *k) {
+    cipher->xor_ic = stodium_chacha20_xor_ic;
+    cipher->layout = STODIUM_GATHER_AEAD;
+    cipher->skip   = 64;
+    memcpy(cipher->nonce, npub, crypto_aead_chacha20poly1305_NPUBBYTES);
+    memcpy(cipher->key, k, crypto_aead_chacha20poly1305_KEYBYTES);
+}
+
+static void stodium_chacha20poly1305_ietf_gather_setup(stodium_gather_cipher *cipher,
+        const unsigned char *npub, const unsigned char *k) {
+    cipher->xor_ic = stodium_chacha20_ietf_xor_ic;
+    cipher->layout = STODIUM_GATHER_AEAD_IETF;
+    cipher->skip   = 64;
+    memcpy(cipher->nonce, npub, crypto_aead_chacha20poly1305_ietf_NPUBBYTES);
+    memcpy(cipher->key, k, crypto_aead_chacha20poly1305_ietf_KEYBYTES);
+}
+
+static void stodium_xchacha20poly1305_ietf_gather_setup(stodium_gather_cipher *cipher,
+        const unsigned char *npub, const unsigned char *k) {
+    cipher->xor_ic = stodium_chacha20_ietf_xor_ic;
+    cipher->layout = STODIUM_GATHER_AEAD_IETF;
+    cipher->skip   = 64;
+    memset(cipher->nonce, 0, 4);
+    memcpy(cipher->nonce + 4, npub + crypto_core_hchacha20_INPUTBYTES,
+            crypto_aead_chacha20poly1305_ietf_NPUBBYTES - 4);
+    crypto_core_hchacha20(cipher->key, npub, k, NULL);
+}
+
+static void stodium_secretbox_xsalsa20poly1305_gather_setup(stodium_gather_cipher *cipher,
+        const unsigned char *npub, const unsigned char *k) {
+    cipher->xor_ic = stodium_salsa20_xor_ic;
+    cipher->layout = STODIUM_GATHER_SECRETBOX;
+    cipher->skip   = crypto_onetimeauth_poly1305_KEYBYTES;
+    memcpy(cipher->nonce, npub + crypto_core_hsalsa20_INPUTBYTES, 8);
+    crypto_core_hsalsa20(cipher->key, npub, k, NULL);
+}
+
+static void stodium_secretbox_xchacha20poly1305_gather_setup(stodium_gather_cipher *cipher,
+        const unsigned char *npub, const unsigned char *k) {
+    cipher->xor_ic = stodium_chacha20_xor_ic;
+    cipher->layout = STODIUM_GATHER_SECRETBOX;
+    cipher->skip   = crypto_onetimeauth_poly1305_KEYBYTES;
+    memcpy(cipher->nonce, npub + crypto_core_hchacha20_INPUTBYTES, 8);
+    crypto_core_hchacha20(cipher->key, npub, k, NULL);
+}
+
+/**
+ * stodium_gather_xor XORs len bytes of in with the keystream from byte offset,
+ * to out. Only a piece that does not start on a block boundary costs an extra
+ * keystream block.
+ */
+static void stodium_gather_xor(const stodium_gather_cipher *cipher,
+        unsigned char       *out,
+        const unsigned char *in,
+        size_t               len,
+        uint64_t             offset) {
+    if (offset % 64 != 0 && len > 0) {
+        unsigned char block[64] = { 0 };
+        const size_t skip = (size_t) (offset % 64);
+        const size_t lead = len < 64 - skip ? len : 64 - skip;
+        size_t i;
+
+        cipher->xor_ic(block, block, sizeof block, cipher->nonce, offset / 64, cipher->key);
+        for (i = 0; i < lead; i++) {
+            out[i] = in[i] ^ block[skip + i];
+        }
+        sodium_memzero(block, sizeof block);
+        out    += lead;
+        in     += lead;
+        len    -= lead;
+        offset += lead;
+    }
+    if (len > 0) {
+        cipher->xor_ic(out, in, len, cipher->nonce, offset / 64, cipher->key);
+    }
+}
+
+/**
+ * stodium_gather_trailer feeds what follows the ciphertext in the layout of
+ * cipher to the Poly1305 state.
+ */
+static void stodium_gather_trailer(const stodium_gather_cipher *cipher,
+        crypto_onetimeauth_poly1305_state *state,
+        unsigned long long adlen,
+        unsigned long long clen) {
+    switch (cipher->layout) {
+    case STODIUM_GATHER_AEAD:
+        stodium_poly1305_update_length(state, clen);
+        break;
+    case STODIUM_GATHER_AEAD_IETF:
+        stodium_poly1305_update_pad(state, clen);
+        stodium_poly1305_update_length(state, adlen);
+        stodium_poly1305_update_length(state, clen);
+        break;
+    }
+}
+
+/**
+ * stodium_gather_run encrypts (or verifies and decrypts) the fragments of src
+ * to those of dst, which may be laid out differently but must hold at least
+ * as many bytes, and writes (or checks) the tag mac. Decryption checks the
+ * tag over all of src before anything is written to dst. Returns 0, or -1 if
+ * the tag was invalid.
+ */
+static int stodium_gather_run(const stodium_gather_cipher *cipher,
+        bool                     encrypt,
+        const stodium_fragments *dst,
+        const stodium_fragments *src,
+        unsigned char           *mac,
+        const unsigned char     *ad,
+        unsigned long long       adlen) {
+    crypto_onetimeauth_poly1305_state state;
+    unsigned char block0[64] = { 0 };
+    unsigned char computed[crypto_onetimeauth_poly1305_BYTES];
+    stodium_fragment_cursor in  = { src, 0, 0 };
+    stodium_fragment_cursor out = { dst, 0, 0 };
+    uint64_t pos = 0;
+    size_t   i;
+    int      result = 0;
+
+    cipher->xor_ic(block0, block0, sizeof block0, cipher->nonce, 0, cipher->key);
+    crypto_onetimeauth_poly1305_init(&state, block0);
+    sodium_memzero(block0, sizeof block0);
+
+    if (cipher->layout != STODIUM_GATHER_SECRETBOX) {
+        crypto_onetimeauth_poly1305_update(&state, ad, adlen);
+        if (cipher->layout == STODIUM_GATHER_AEAD_IETF) {
+            stodium_poly1305_update_pad(&state, adlen);
+        } else {
+            stodium_poly1305_update_length(&state, adlen);
+        }
+    }
+
+    if (!encrypt) {
+        for (i = 0; i < src->count; i++) {
+            crypto_onetimeauth_poly1305_update(&state,
+                    AS_INPUT(unsigned char, src->buffers[i]),
+                    AS_INPUT_LEN(unsigned long long, src->buffers[i]));
+        }
+        stodium_gather_trailer(cipher, &state, adlen, src->length);
+        crypto_onetimeauth_poly1305_final(&state, computed);
+        result = crypto_verify_16(computed, mac);
+    }
+
+    while (result == 0 && pos < src->length) {
+        unsigned char *from, *to;
+        size_t n = stodium_fragment_span(&in, &from);
+        size_t m = stodium_fragment_span(&out, &to);
+        if (m < n) {
+            n = m;
+        }
+
+        stodium_gather_xor(cipher, to, from, n, cipher->skip + pos);
+        if (encrypt) {
+            crypto_onetimeauth_poly1305_update(&state, to, n);
+        }
+        stodium_fragment_advance(&in, n);
+        stodium_fragment_advance(&out, n);
+        pos += n;
+    }
 
+    if (encrypt) {
+        stodium_gather_trailer(cipher, &state, adlen, src->length);
+        crypto_onetimeauth_poly1305_final(&state, mac);
+    }
+    sodium_memzero(&state, sizeof state);
+    sodium_memzero(computed, sizeof computed);
     return result;
 }
 
-STODIUM_JNI(jint, crypto_1auth_1hmacsha512_1final) (JNIEnv *jenv, jclass jcls,
-        jobject state,
-        jobject dst) {
-    stodium_buffer state_buffer, dst_buffer;
-    stodium_get_buffer(jenv, &state_buffer, state);
-    stodium_get_buffer(jenv, &dst_buffer, dst);
+/**
+ * stodium_gather_copy copies the fragments to and from a contiguous buffer.
+ */
+static void stodium_gather_copy(unsigned char *dst, const stodium_fragments *src) {
+    size_t i;
+    for (i = 0; i < src->count; i++) {
+        memcpy(dst, AS_INPUT(unsigned char, src->buffers[i]), src->buffers[i].capacity);
+        dst += src->buffers[i].capacity;
+    }
+}
 
-    jint result = (jint) crypto_auth_hmacsha512_final(
-            AS_OUTPUT(crypto_auth_hmacsha512_state, state_buffer),
-            AS_OUTPUT(unsigned char, dst_buffer));
+static void stodium_scatter_copy(const stodium_fragments *dst, const unsigned char *src, size_t len) {
+    size_t i;
+    for (i = 0; i < dst->count && len > 0; i++) {
+        const size_t n = dst->buffers[i].capacity < len ? dst->buffers[i].capacity : len;
+        memcpy(AS_OUTPUT(unsigned char, dst->buffers[i]), src, n);
+        src += n;
+        len -= n;
+    }
+}
 
-    stodium_release_output(jenv, state, &state_buffer);
-    stodium_release_output(jenv, dst, &dst_buffer);
+/**
+ * stodium_gather_scratch runs a construction without a stream form
+ * (AES-256-GCM, whose GHASH libsodium does not expose) over a native scratch
+ * copy of the fragments, which is wiped afterwards.
+ */
+static int stodium_gather_scratch(const stodium_aead_constants *aead,
+        bool                     encrypt,
+        const stodium_fragments *dst,
+        const stodium_fragments *src,
+        unsigned char           *mac,
+        const unsigned char     *ad,
+        unsigned long long       adlen,
+        const unsigned char     *npub,
+        const unsigned char     *k) {
+    unsigned char *scratch = (unsigned char *) malloc(src->length + 1);
+    int result;
+
+    if (scratch == NULL) {
+        return -1;
+    }
+    stodium_gather_copy(scratch, src);
+    result = encrypt
+            ? aead->encrypt_detached(scratch, mac, NULL, scratch, src->length, ad, adlen, NULL, npub, k)
+            : aead->decrypt_detached(scratch, NULL, scratch, src->length, mac, ad, adlen, npub, k);
+    if (result == 0) {
+        stodium_scatter_copy(dst, scratch, src->length);
+    }
+    sodium_memzero(scratch, src->length);
+    free(scratch);
+    return result;
+}
+
+/**
+ * stodium_gather_call resolves the arguments of a gather/scatter wrapper, and
+ * runs the construction set up by setup, or the scratch fallback for aead if
+ * setup is NULL. Returns the status of the operation, or -1 if the arguments
+ * were invalid, which includes dst and src overlapping other than in place.
+ */
+static jint stodium_gather_call(JNIEnv *jenv, int group,
+        size_t                        keybytes,
+        size_t                        npubbytes,
+        size_t                        abytes,
+        stodium_gather_setup_fn       setup,
+        const stodium_aead_constants *aead,
+        bool                          encrypt,
+        jobjectArray                  dst,
+        jobjectArray                  src,
+        jobject                       mac,
+        jobject                       ad,
+        jobject                       nonce,
+        jobject                       key) {
+    STODIUM_STATS_CALL(group);
+    stodium_fragments dst_fragments, src_fragments;
+    stodium_buffer mac_buffer, ad_buffer, nonce_buffer, key_buffer;
+    stodium_buffer **list;
+    size_t count;
+    jint result = -1;
+
+    if (!stodium_get_critical_fragments(jenv, &dst_fragments, dst, true)) {
+        return -1;
+    }
+    if (!stodium_get_critical_fragments(jenv, &src_fragments, src, false)) {
+        stodium_fragments_release(&dst_fragments);
+        return -1;
+    }
+    if (encrypt) {
+        stodium_get_critical_output(jenv, &mac_buffer, mac);
+    } else {
+        stodium_get_critical_input(jenv, &mac_buffer, mac);
+    }
+    stodium_get_critical_input(jenv, &ad_buffer,    ad);
+    stodium_get_critical_input(jenv, &nonce_buffer, nonce);
+    stodium_get_critical_input(jenv, &key_buffer,   key);
+
+    if (dst_fragments.length >= src_fragments.length && mac_buffer.capacity >= abytes &&
+            nonce_buffer.capacity >= npubbytes && key_buffer.capacity == keybytes) {
+        stodium_buffer *extra[] = { &mac_buffer, &ad_buffer, &nonce_buffer, &key_buffer };
+        list = stodium_fragments_begin(jenv, &dst_fragments, &src_fragments, extra, 4, &count);
+        if (list != NULL) {
+            if (stodium_fragments_overlap(&dst_fragments, &src_fragments)) {
+                result = -1;
+            } else if (setup != NULL) {
+                stodium_gather_cipher cipher;
+                setup(&cipher, AS_INPUT(unsigned char, nonce_buffer), AS_INPUT(unsigned char, key_buffer));
+                result = (jint) stodium_gather_run(&cipher, encrypt, &dst_fragments, &src_fragments,
+                        AS_OUTPUT(unsigned char, mac_buffer),
+                        AS_INPUT(unsigned char, ad_buffer),
+                        AS_INPUT_LEN(unsigned long long, ad_buffer));
+                sodium_memzero(&cipher, sizeof cipher);
+            } else {
+                result = (jint) stodium_gather_scratch(aead, encrypt, &dst_fragments, &src_fragments,
+                        AS_OUTPUT(unsigned char, mac_buffer),
+                        AS_INPUT(unsigned char, ad_buffer),
+                        AS_INPUT_LEN(unsigned long long, ad_buffer),
+                        AS_INPUT(unsigned char, nonce_buffer),
+                        AS_INPUT(unsigned char, key_buffer));
+            }
+            stodium_fragments_end(jenv, list, count);
+        }
+    }
 
+    stodium_fragments_release(&dst_fragments);
+    stodium_fragments_release(&src_fragments);
     return result;
 }
 
+/**
+ * STODIUM_AEAD_GATHER defines the gather/scatter wrappers of an AEAD
+ * construction, in detached mode.
+ *
+ * @jname:     the name of the construction, escaped for use in a JNI name
+ * @primitive: the name of the construction (e.g. chacha20poly1305_ietf)
+ * @setup:     the stream setup of the construction, or NULL
+ */
+#define STODIUM_AEAD_GATHER(jname, primitive, setup) \
+    STODIUM_JNI(jint, crypto_1aead_1##jname##_1encrypt_1detached_1gather) (JNIEnv *jenv, jclass jcls, \
+            jobjectArray dst, jobject mac, jobjectArray src, jobject ad, jobject nonce, jobject key) { \
+        return stodium_gather_call(jenv, STODIUM_STATS_AEAD, \
+                crypto_aead_##primitive##_KEYBYTES, crypto_aead_##primitive##_NPUBBYTES, crypto_aead_##primitive##_ABYTES, \
+                setup, &stodium_aead_##primitive, true, dst, src, mac, ad, nonce, key); } \
+    STODIUM_JNI(jint, crypto_1aead_1##jname##_1decrypt_1detached_1gather) (JNIEnv *jenv, jclass jcls, \
+            jobjectArray dst, jobjectArray src, jobject mac, jobject ad, jobject nonce, jobject key) { \
+        return stodium_gather_call(jenv, STODIUM_STATS_AEAD, \
+                crypto_aead_##primitive##_KEYBYTES, crypto_aead_##primitive##_NPUBBYTES, crypto_aead_##primitive##_ABYTES, \
+                setup, &stodium_aead_##primitive, false, dst, src, mac, ad, nonce, key); }
+
+STODIUM_AEAD_GATHER(aes256gcm, aes256gcm, NULL)
+STODIUM_AEAD_GATHER(chacha20poly1305, chacha20poly1305, stodium_chacha20poly1305_gather_setup)
+STODIUM_AEAD_GATHER(chacha20poly1305_1ietf, chacha20poly1305_ietf, stodium_chacha20poly1305_ietf_gather_setup)
+STODIUM_AEAD_GATHER(xchacha20poly1305_1ietf, xchacha20poly1305_ietf, stodium_xchacha20poly1305_ietf_gather_setup)
+
 /** ****************************************************************************
  *
- * AUTH - HMAC-512/256
+ * AUTH
+ *
+ **************************************************************************** */
+
+STODIUM_CONSTANT_STR(auth)
+
+/** ****************************************************************************
+ *
+ * AUTH - HMAC-256
  *
  **************************************************************************** */
 
-STODIUM_CONSTANT(auth, hmacsha512256, bytes)
-STODIUM_CONSTANT(auth, hmacsha512256, keybytes)
-STODIUM_CONSTANT(auth, hmacsha512256, statebytes)
 
-STODIUM_JNI(jint, crypto_1auth_1hmacsha512256) (JNIEnv *jenv, jclass jcls,
+STODIUM_JNI(jint, crypto_1auth_1hmacsha256) (JNIEnv *jenv, jclass jcls,
         jobject mac,
         jobject src,
         jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_AUTH);
     stodium_buffer mac_buffer, src_buffer, key_buffer;
-    stodium_get_buffer(jenv, &mac_buffer, mac);
-    stodium_get_buffer(jenv, &src_buffer, src);
-    stodium_get_buffer(jenv, &key_buffer, key);
+    stodium_get_critical_output(jenv, &mac_buffer, mac);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
+    stodium_get_critical_input(jenv,  &key_buffer, key);
 
-    jint result = (jint) crypto_auth_hmacsha512256(
+    STODIUM_CRITICAL_BEGIN(jenv, &mac_buffer, &src_buffer, &key_buffer);
+    jint result = (jint) crypto_auth_hmacsha256(
             AS_OUTPUT(unsigned char, mac_buffer),
             AS_INPUT(unsigned char, src_buffer),
             AS_INPUT_LEN(unsigned long long, src_buffer),
             AS_INPUT(unsigned char, key_buffer));
-
-    stodium_release_output(jenv, mac, &mac_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
-    stodium_release_input(jenv, key, &key_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
 
-STODIUM_JNI(jint, crypto_1auth_1hmacsha512256_1verify) (JNIEnv *jenv, jclass jcls,
+STODIUM_JNI(jint, crypto_1auth_1hmacsha256_1verify) (JNIEnv *jenv, jclass jcls,
         jobject mac,
         jobject src,
         jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_AUTH);
     stodium_buffer mac_buffer, src_buffer, key_buffer;
-    stodium_get_buffer(jenv, &mac_buffer, mac);
-    stodium_get_buffer(jenv, &src_buffer, src);
-    stodium_get_buffer(jenv, &key_buffer, key);
+    stodium_get_critical_input(jenv,  &mac_buffer, mac);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
+    stodium_get_critical_input(jenv,  &key_buffer, key);
 
-    jint result = (jint) crypto_auth_hmacsha512256_verify(
+    STODIUM_CRITICAL_BEGIN(jenv, &mac_buffer, &src_buffer, &key_buffer);
+    jint result = (jint) crypto_auth_hmacsha256_verify(
             AS_OUTPUT(unsigned char, mac_buffer),
             AS_INPUT(unsigned char, src_buffer),
             AS_INPUT_LEN(unsigned long long, src_buffer),
             AS_INPUT(unsigned char, key_buffer));
-
-    stodium_release_input(jenv, mac, &mac_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
-    stodium_release_input(jenv, key, &key_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
 
-STODIUM_JNI(jint, crypto_1auth_1hmacsha512256_1init) (JNIEnv *jenv, jclass jcls,
+STODIUM_JNI(jint, crypto_1auth_1hmacsha256_1init) (JNIEnv *jenv, jclass jcls,
         jobject dst,
         jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_AUTH);
     stodium_buffer dst_buffer, key_buffer;
-    stodium_get_buffer(jenv, &dst_buffer, dst);
-    stodium_get_buffer(jenv, &key_buffer, key);
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+    stodium_get_critical_input(jenv,  &key_buffer, key);
 
-    jint result = (jint) crypto_auth_hmacsha512256_init(
-            AS_OUTPUT(crypto_auth_hmacsha512256_state, dst_buffer),
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &key_buffer);
+    jint result = (jint) crypto_auth_hmacsha256_init(
+            AS_OUTPUT(crypto_auth_hmacsha256_state, dst_buffer),
             AS_INPUT(unsigned char, key_buffer),
             AS_INPUT_LEN(size_t, key_buffer));
-
-    stodium_release_output(jenv, dst, &dst_buffer);
-    stodium_release_input(jenv, key, &key_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
 
-STODIUM_JNI(jint, crypto_1auth_1hmacsha512256_1update) (JNIEnv *jenv, jclass jcls,
+STODIUM_JNI(jint, crypto_1auth_1hmacsha256_1update) (JNIEnv *jenv, jclass jcls,
         jobject dst,
         jobject src) {
+    STODIUM_STATS_CALL(STODIUM_STATS_AUTH);
     stodium_buffer dst_buffer, src_buffer;
-    stodium_get_buffer(jenv, &dst_buffer, dst);
-    stodium_get_buffer(jenv, &src_buffer, src);
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
 
-    jint result = (jint) crypto_auth_hmacsha512256_update(
-            AS_OUTPUT(crypto_auth_hmacsha512256_state, dst_buffer),
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &src_buffer);
+    jint result = (jint) crypto_auth_hmacsha256_update(
+            AS_OUTPUT(crypto_auth_hmacsha256_state, dst_buffer),
             AS_INPUT(unsigned char, src_buffer),
             AS_INPUT_LEN(unsigned long long, src_buffer));
-
-    stodium_release_output(jenv, dst, &dst_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
 
-STODIUM_JNI(jint, crypto_1auth_1hmacsha512256_1final) (JNIEnv *jenv, jclass jcls,
+STODIUM_JNI(jint, crypto_1auth_1hmacsha256_1final) (JNIEnv *jenv, jclass jcls,
         jobject state,
         jobject dst) {
+    STODIUM_STATS_CALL(STODIUM_STATS_AUTH);
     stodium_buffer state_buffer, dst_buffer;
-    stodium_get_buffer(jenv, &state_buffer, state);
-    stodium_get_buffer(jenv, &dst_buffer, dst);
+    stodium_get_critical_output(jenv, &state_buffer, state);
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
 
-    jint result = (jint) crypto_auth_hmacsha512256_final(
-            AS_OUTPUT(crypto_auth_hmacsha512256_state, state_buffer),
+    STODIUM_CRITICAL_BEGIN(jenv, &state_buffer, &dst_buffer);
+    jint result = (jint) crypto_auth_hmacsha256_final(
+            AS_OUTPUT(crypto_auth_hmacsha256_state, state_buffer),
             AS_OUTPUT(unsigned char, dst_buffer));
-
-    stodium_release_output(jenv, state, &state_buffer);
-    stodium_release_output(jenv, dst, &dst_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
 
 /** ****************************************************************************
  *
- * BOX
+ * AUTH - HMAC-512
  *
  **************************************************************************** */
 
-STODIUM_CONSTANT_STR(box)
-STODIUM_CONSTANT_HL(box, sealbytes)
 
-STODIUM_JNI(jint, crypto_1box_1seal) (JNIEnv *jenv, jclass jcls,
-        jobject dst,
+STODIUM_JNI(jint, crypto_1auth_1hmacsha512) (JNIEnv *jenv, jclass jcls,
+        jobject mac,
         jobject src,
-        jobject pub) {
-    stodium_buffer dst_buffer, src_buffer, pub_buffer;
-    stodium_get_buffer(jenv, &dst_buffer, dst);
-    stodium_get_buffer(jenv, &src_buffer, src);
-    stodium_get_buffer(jenv, &pub_buffer, pub);
+        jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_AUTH);
+    stodium_buffer mac_buffer, src_buffer, key_buffer;
+    stodium_get_critical_output(jenv, &mac_buffer, mac);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
+    stodium_get_critical_input(jenv,  &key_buffer, key);
 
-    jint result = (jint) crypto_box_seal(
-            AS_OUTPUT(unsigned char, dst_buffer),
+    STODIUM_CRITICAL_BEGIN(jenv, &mac_buffer, &src_buffer, &key_buffer);
+    jint result = (jint) crypto_auth_hmacsha512(
+            AS_OUTPUT(unsigned char, mac_buffer),
             AS_INPUT(unsigned char, src_buffer),
             AS_INPUT_LEN(unsigned long long, src_buffer),
-            AS_INPUT(unsigned char, pub_buffer));
-
-    stodium_release_output(jenv, dst, &dst_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
-    stodium_release_input(jenv, pub, &pub_buffer);
+            AS_INPUT(unsigned char, key_buffer));
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
 
-STODIUM_JNI(jint, crypto_1box_1seal_1open) (JNIEnv *jenv, jclass jcls,
-        jobject dst,
+STODIUM_JNI(jint, crypto_1auth_1hmacsha512_1verify) (JNIEnv *jenv, jclass jcls,
+        jobject mac,
         jobject src,
-        jobject pub,
-        jobject priv) {
-    stodium_buffer dst_buffer, src_buffer, pub_buffer, priv_buffer;
-    stodium_get_buffer(jenv, &dst_buffer, dst);
-    stodium_get_buffer(jenv, &src_buffer, src);
-    stodium_get_buffer(jenv, &pub_buffer, pub);
-    stodium_get_buffer(jenv, &priv_buffer, priv);
+        jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_AUTH);
+    stodium_buffer mac_buffer, src_buffer, key_buffer;
+    stodium_get_critical_input(jenv,  &mac_buffer, mac);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
+    stodium_get_critical_input(jenv,  &key_buffer, key);
 
-    jint result = (jint) crypto_box_seal_open(
-            AS_OUTPUT(unsigned char, dst_buffer),
+    STODIUM_CRITICAL_BEGIN(jenv, &mac_buffer, &src_buffer, &key_buffer);
+    jint result = (jint) crypto_auth_hmacsha512_verify(
+            AS_OUTPUT(unsigned char, mac_buffer),
             AS_INPUT(unsigned char, src_buffer),
             AS_INPUT_LEN(unsigned long long, src_buffer),
-            AS_INPUT(unsigned char, pub_buffer),
-            AS_INPUT(unsigned char, priv_buffer));
-
-    stodium_release_output(jenv, dst, &dst_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
-    stodium_release_input(jenv, pub, &pub_buffer);
-    stodium_release_input(jenv, priv, &priv_buffer);
+            AS_INPUT(unsigned char, key_buffer));
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
 
-/** ****************************************************************************
- *
- * BOX - X25519XSalsa20Poly1305
- *
- **************************************************************************** */
-
-STODIUM_CONSTANT(box, curve25519xsalsa20poly1305, seedbytes)
-STODIUM_CONSTANT(box, curve25519xsalsa20poly1305, publickeybytes)
-STODIUM_CONSTANT(box, curve25519xsalsa20poly1305, secretkeybytes)
-STODIUM_CONSTANT(box, curve25519xsalsa20poly1305, beforenmbytes)
-STODIUM_CONSTANT(box, curve25519xsalsa20poly1305, noncebytes)
-STODIUM_CONSTANT(box, curve25519xsalsa20poly1305, zerobytes)
-STODIUM_CONSTANT(box, curve25519xsalsa20poly1305, boxzerobytes)
-STODIUM_CONSTANT(box, curve25519xsalsa20poly1305, macbytes)
-
-STODIUM_JNI(jint, crypto_1box_1curve25519xsalsa20poly1305_1seed_1keypair) (JNIEnv *jenv, jclass jcls,
+STODIUM_JNI(jint, crypto_1auth_1hmacsha512_1init) (JNIEnv *jenv, jclass jcls,
+        jobject dst,
+        jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_AUTH);
+    stodium_buffer dst_buffer, key_buffer;
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+    stodium_get_critical_input(jenv,  &key_buffer, key);
+
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &key_buffer);
+    jint result = (jint) crypto_auth_hmacsha512_init(
+            AS_OUTPUT(crypto_auth_hmacsha512_state, dst_buffer),
+            AS_INPUT(unsigned char, key_buffer),
+            AS_INPUT_LEN(size_t, key_buffer));
+    STODIUM_CRITICAL_END(jenv);
+
+    return result;
+}
+
+STODIUM_JNI(jint, crypto_1auth_1hmacsha512_1update) (JNIEnv *jenv, jclass jcls,
+        jobject dst,
+        jobject src) {
+    STODIUM_STATS_CALL(STODIUM_STATS_AUTH);
+    stodium_buffer dst_buffer, src_buffer;
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
+
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &src_buffer);
+    jint result = (jint) crypto_auth_hmacsha512_update(
+            AS_OUTPUT(crypto_auth_hmacsha512_state, dst_buffer),
+            AS_INPUT(unsigned char, src_buffer),
+            AS_INPUT_LEN(unsigned long long, src_buffer));
+    STODIUM_CRITICAL_END(jenv);
+
+    return result;
+}
+
+STODIUM_JNI(jint, crypto_1auth_1hmacsha512_1final) (JNIEnv *jenv, jclass jcls,
+        jobject state,
+        jobject dst) {
+    STODIUM_STATS_CALL(STODIUM_STATS_AUTH);
+    stodium_buffer state_buffer, dst_buffer;
+    stodium_get_critical_output(jenv, &state_buffer, state);
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+
+    STODIUM_CRITICAL_BEGIN(jenv, &state_buffer, &dst_buffer);
+    jint result = (jint) crypto_auth_hmacsha512_final(
+            AS_OUTPUT(crypto_auth_hmacsha512_state, state_buffer),
+            AS_OUTPUT(unsigned char, dst_buffer));
+    STODIUM_CRITICAL_END(jenv);
+
+    return result;
+}
+
+/** ****************************************************************************
+ *
+ * AUTH - HMAC-512/256
+ *
+ **************************************************************************** */
+
+
+STODIUM_JNI(jint, crypto_1auth_1hmacsha512256) (JNIEnv *jenv, jclass jcls,
+        jobject mac,
+        jobject src,
+        jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_AUTH);
+    stodium_buffer mac_buffer, src_buffer, key_buffer;
+    stodium_get_critical_output(jenv, &mac_buffer, mac);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
+    stodium_get_critical_input(jenv,  &key_buffer, key);
+
+    STODIUM_CRITICAL_BEGIN(jenv, &mac_buffer, &src_buffer, &key_buffer);
+    jint result = (jint) crypto_auth_hmacsha512256(
+            AS_OUTPUT(unsigned char, mac_buffer),
+            AS_INPUT(unsigned char, src_buffer),
+            AS_INPUT_LEN(unsigned long long, src_buffer),
+            AS_INPUT(unsigned char, key_buffer));
+    STODIUM_CRITICAL_END(jenv);
+
+    return result;
+}
+
+STODIUM_JNI(jint, crypto_1auth_1hmacsha512256_1verify) (JNIEnv *jenv, jclass jcls,
+        jobject mac,
+        jobject src,
+        jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_AUTH);
+    stodium_buffer mac_buffer, src_buffer, key_buffer;
+    stodium_get_critical_input(jenv,  &mac_buffer, mac);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
+    stodium_get_critical_input(jenv,  &key_buffer, key);
+
+    STODIUM_CRITICAL_BEGIN(jenv, &mac_buffer, &src_buffer, &key_buffer);
+    jint result = (jint) crypto_auth_hmacsha512256_verify(
+            AS_OUTPUT(unsigned char, mac_buffer),
+            AS_INPUT(unsigned char, src_buffer),
+            AS_INPUT_LEN(unsigned long long, src_buffer),
+            AS_INPUT(unsigned char, key_buffer));
+    STODIUM_CRITICAL_END(jenv);
+
+    return result;
+}
+
+STODIUM_JNI(jint, crypto_1auth_1hmacsha512256_1init) (JNIEnv *jenv, jclass jcls,
+        jobject dst,
+        jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_AUTH);
+    stodium_buffer dst_buffer, key_buffer;
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+    stodium_get_critical_input(jenv,  &key_buffer, key);
+
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &key_buffer);
+    jint result = (jint) crypto_auth_hmacsha512256_init(
+            AS_OUTPUT(crypto_auth_hmacsha512256_state, dst_buffer),
+            AS_INPUT(unsigned char, key_buffer),
+            AS_INPUT_LEN(size_t, key_buffer));
+    STODIUM_CRITICAL_END(jenv);
+
+    return result;
+}
+
+STODIUM_JNI(jint, crypto_1auth_1hmacsha512256_1update) (JNIEnv *jenv, jclass jcls,
+        jobject dst,
+        jobject src) {
+    STODIUM_STATS_CALL(STODIUM_STATS_AUTH);
+    stodium_buffer dst_buffer, src_buffer;
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
+
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &src_buffer);
+    jint result = (jint) crypto_auth_hmacsha512256_update(
+            AS_OUTPUT(crypto_auth_hmacsha512256_state, dst_buffer),
+            AS_INPUT(unsigned char, src_buffer),
+            AS_INPUT_LEN(unsigned long long, src_buffer));
+    STODIUM_CRITICAL_END(jenv);
+
+    return result;
+}
+
+STODIUM_JNI(jint, crypto_1auth_1hmacsha512256_1final) (JNIEnv *jenv, jclass jcls,
+        jobject state,
+        jobject dst) {
+    STODIUM_STATS_CALL(STODIUM_STATS_AUTH);
+    stodium_buffer state_buffer, dst_buffer;
+    stodium_get_critical_output(jenv, &state_buffer, state);
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+
+    STODIUM_CRITICAL_BEGIN(jenv, &state_buffer, &dst_buffer);
+    jint result = (jint) crypto_auth_hmacsha512256_final(
+            AS_OUTPUT(crypto_auth_hmacsha512256_state, state_buffer),
+            AS_OUTPUT(unsigned char, dst_buffer));
+    STODIUM_CRITICAL_END(jenv);
+
+    return result;
+}
+
+/** ****************************************************************************
+ *
+ * BOX
+ *
+ **************************************************************************** */
+
+STODIUM_CONSTANT_STR(box)
+
+STODIUM_JNI(jint, crypto_1box_1seal) (JNIEnv *jenv, jclass jcls,
+        jobject dst,
+        jobject src,
+        jobject pub) {
+    STODIUM_STATS_CALL(STODIUM_STATS_BOX);
+    stodium_buffer dst_buffer, src_buffer, pub_buffer;
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
+    stodium_get_critical_input(jenv,  &pub_buffer, pub);
+
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &src_buffer, &pub_buffer);
+    jint result = (jint) crypto_box_seal(
+            AS_OUTPUT(unsigned char, dst_buffer),
+            AS_INPUT(unsigned char, src_buffer),
+            AS_INPUT_LEN(unsigned long long, src_buffer),
+            AS_INPUT(unsigned char, pub_buffer));
+    STODIUM_CRITICAL_END(jenv);
+
+    return result;
+}
+
+STODIUM_JNI(jint, crypto_1box_1seal_1open) (JNIEnv *jenv, jclass jcls,
+        jobject dst,
+        jobject src,
+        jobject pub,
+        jobject priv) {
+    STODIUM_STATS_CALL(STODIUM_STATS_BOX);
+    stodium_buffer dst_buffer, src_buffer, pub_buffer, priv_buffer;
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
+    stodium_get_critical_input(jenv,  &pub_buffer, pub);
+    stodium_get_critical_input(jenv,  &priv_buffer, priv);
+
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &src_buffer, &pub_buffer, &priv_buffer);
+    jint result = (jint) crypto_box_seal_open(
+            AS_OUTPUT(unsigned char, dst_buffer),
+            AS_INPUT(unsigned char, src_buffer),
+            AS_INPUT_LEN(unsigned long long, src_buffer),
+            AS_INPUT(unsigned char, pub_buffer),
+            AS_INPUT(unsigned char, priv_buffer));
+    STODIUM_CRITICAL_END(jenv);
+
+    return result;
+}
+
+/** ****************************************************************************
+ *
+ * BOX - X25519XSalsa20Poly1305
+ *
+ **************************************************************************** */
+
+
+STODIUM_JNI(jint, crypto_1box_1curve25519xsalsa20poly1305_1seed_1keypair) (JNIEnv *jenv, jclass jcls,
         jobject pk,
         jobject sk,
         jobject seed) {
+    STODIUM_STATS_CALL(STODIUM_STATS_BOX);
     stodium_buffer pk_buffer, sk_buffer, seed_buffer;
-    stodium_get_buffer(jenv, &pk_buffer, pk);
-    stodium_get_buffer(jenv, &sk_buffer, sk);
-    stodium_get_buffer(jenv, &seed_buffer, seed);
+    stodium_get_critical_output(jenv, &pk_buffer, pk);
+    stodium_get_critical_output(jenv, &sk_buffer, sk);
+    stodium_get_critical_input(jenv,  &seed_buffer, seed);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &pk_buffer, &sk_buffer, &seed_buffer);
     jint result = (jint) crypto_box_curve25519xsalsa20poly1305_seed_keypair(
             AS_OUTPUT(unsigned char, pk_buffer),
             AS_OUTPUT(unsigned char, sk_buffer),
             AS_INPUT(unsigned char, seed_buffer));
-
-    stodium_release_output(jenv, pk, &pk_buffer);
-    stodium_release_output(jenv, sk, &sk_buffer);
-    stodium_release_input(jenv, seed, &seed_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -1273,6 +2999,7 @@ STODIUM_JNI(jint, crypto_1box_1curve25519xsalsa20poly1305_1seed_1keypair) (JNIEn
 STODIUM_JNI(jint, crypto_1box_1curve25519xsalsa20poly1305_1keypair) (JNIEnv *jenv, jclass jcls,
         jobject pk,
         jobject sk) {
+    STODIUM_STATS_CALL(STODIUM_STATS_BOX);
     stodium_buffer pk_buffer, sk_buffer;
     stodium_get_buffer(jenv, &pk_buffer, pk);
     stodium_get_buffer(jenv, &sk_buffer, sk);
@@ -1291,19 +3018,18 @@ STODIUM_JNI(jint, crypto_1box_1curve25519xsalsa20poly1305_1beforenm) (JNIEnv *je
         jobject dst,
         jobject pub,
         jobject priv) {
+    STODIUM_STATS_CALL(STODIUM_STATS_BOX);
     stodium_buffer dst_buffer, pub_buffer, priv_buffer;
-    stodium_get_buffer(jenv, &dst_buffer, dst);
-    stodium_get_buffer(jenv, &pub_buffer, pub);
-    stodium_get_buffer(jenv, &priv_buffer, priv);
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+    stodium_get_critical_input(jenv,  &pub_buffer, pub);
+    stodium_get_critical_input(jenv,  &priv_buffer, priv);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &pub_buffer, &priv_buffer);
     jint result = (jint) crypto_box_curve25519xsalsa20poly1305_beforenm(
             AS_OUTPUT(unsigned char, dst_buffer),
             AS_INPUT(unsigned char, pub_buffer),
             AS_INPUT(unsigned char, priv_buffer));
-
-    stodium_release_output(jenv, dst, &dst_buffer);
-    stodium_release_input(jenv, pub, &pub_buffer);
-    stodium_release_input(jenv, priv, &priv_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -1313,23 +3039,21 @@ STODIUM_JNI(jint, crypto_1box_1curve25519xsalsa20poly1305_1afternm) (JNIEnv *jen
         jobject src,
         jobject nonce,
         jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_BOX);
     stodium_buffer dst_buffer, src_buffer, nonce_buffer, key_buffer;
-    stodium_get_buffer(jenv, &dst_buffer, dst);
-    stodium_get_buffer(jenv, &src_buffer, src);
-    stodium_get_buffer(jenv, &nonce_buffer, nonce);
-    stodium_get_buffer(jenv, &key_buffer, key);
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
+    stodium_get_critical_input(jenv,  &nonce_buffer, nonce);
+    stodium_get_critical_input(jenv,  &key_buffer, key);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &src_buffer, &nonce_buffer, &key_buffer);
     jint result = (jint) crypto_box_curve25519xsalsa20poly1305_afternm(
             AS_OUTPUT(unsigned char, dst_buffer),
             AS_INPUT(unsigned char, src_buffer),
             AS_INPUT_LEN(unsigned long long, src_buffer),
             AS_INPUT(unsigned char, nonce_buffer),
             AS_INPUT(unsigned char, key_buffer));
-
-    stodium_release_output(jenv, dst, &dst_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
-    stodium_release_input(jenv, nonce, &nonce_buffer);
-    stodium_release_input(jenv, key, &key_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -1339,23 +3063,21 @@ STODIUM_JNI(jint, crypto_1box_1curve25519xsalsa20poly1305_1open_1afternm) (JNIEn
         jobject src,
         jobject nonce,
         jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_BOX);
     stodium_buffer dst_buffer, src_buffer, nonce_buffer, key_buffer;
-    stodium_get_buffer(jenv, &dst_buffer, dst);
-    stodium_get_buffer(jenv, &src_buffer, src);
-    stodium_get_buffer(jenv, &nonce_buffer, nonce);
-    stodium_get_buffer(jenv, &key_buffer, key);
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
+    stodium_get_critical_input(jenv,  &nonce_buffer, nonce);
+    stodium_get_critical_input(jenv,  &key_buffer, key);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &src_buffer, &nonce_buffer, &key_buffer);
     jint result = (jint) crypto_box_curve25519xsalsa20poly1305_open_afternm(
             AS_OUTPUT(unsigned char, dst_buffer),
             AS_INPUT(unsigned char, src_buffer),
             AS_INPUT_LEN(unsigned long long, src_buffer),
             AS_INPUT(unsigned char, nonce_buffer),
             AS_INPUT(unsigned char, key_buffer));
-
-    stodium_release_output(jenv, dst, &dst_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
-    stodium_release_input(jenv, nonce, &nonce_buffer);
-    stodium_release_input(jenv, key, &key_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -1366,13 +3088,15 @@ STODIUM_JNI(jint, crypto_1box_1curve25519xsalsa20poly1305) (JNIEnv *jenv, jclass
         jobject nonce,
         jobject pub,
         jobject priv) {
+    STODIUM_STATS_CALL(STODIUM_STATS_BOX);
     stodium_buffer dst_buffer, src_buffer, nonce_buffer, pub_buffer, priv_buffer;
-    stodium_get_buffer(jenv, &dst_buffer, dst);
-    stodium_get_buffer(jenv, &src_buffer, src);
-    stodium_get_buffer(jenv, &nonce_buffer, nonce);
-    stodium_get_buffer(jenv, &pub_buffer, pub);
-    stodium_get_buffer(jenv, &priv_buffer, priv);
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
+    stodium_get_critical_input(jenv,  &nonce_buffer, nonce);
+    stodium_get_critical_input(jenv,  &pub_buffer, pub);
+    stodium_get_critical_input(jenv,  &priv_buffer, priv);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &src_buffer, &nonce_buffer, &pub_buffer, &priv_buffer);
     jint result = (jint) crypto_box_curve25519xsalsa20poly1305(
             AS_OUTPUT(unsigned char, dst_buffer),
             AS_INPUT(unsigned char, src_buffer),
@@ -1380,12 +3104,7 @@ STODIUM_JNI(jint, crypto_1box_1curve25519xsalsa20poly1305) (JNIEnv *jenv, jclass
             AS_INPUT(unsigned char, nonce_buffer),
             AS_INPUT(unsigned char, pub_buffer),
             AS_INPUT(unsigned char, priv_buffer));
-
-    stodium_release_output(jenv, dst, &dst_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
-    stodium_release_input(jenv, nonce, &nonce_buffer);
-    stodium_release_input(jenv, pub, &pub_buffer);
-    stodium_release_input(jenv, priv, &priv_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -1396,13 +3115,15 @@ STODIUM_JNI(jint, crypto_1box_1curve25519xsalsa20poly1305_1open) (JNIEnv *jenv,
         jobject nonce,
         jobject pub,
         jobject priv) {
+    STODIUM_STATS_CALL(STODIUM_STATS_BOX);
     stodium_buffer dst_buffer, src_buffer, nonce_buffer, pub_buffer, priv_buffer;
-    stodium_get_buffer(jenv, &dst_buffer, dst);
-    stodium_get_buffer(jenv, &src_buffer, src);
-    stodium_get_buffer(jenv, &nonce_buffer, nonce);
-    stodium_get_buffer(jenv, &pub_buffer, pub);
-    stodium_get_buffer(jenv, &priv_buffer, priv);
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
+    stodium_get_critical_input(jenv,  &nonce_buffer, nonce);
+    stodium_get_critical_input(jenv,  &pub_buffer, pub);
+    stodium_get_critical_input(jenv,  &priv_buffer, priv);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &src_buffer, &nonce_buffer, &pub_buffer, &priv_buffer);
     jint result = (jint) crypto_box_curve25519xsalsa20poly1305_open(
             AS_OUTPUT(unsigned char, dst_buffer),
             AS_INPUT(unsigned char, src_buffer),
@@ -1410,12 +3131,7 @@ STODIUM_JNI(jint, crypto_1box_1curve25519xsalsa20poly1305_1open) (JNIEnv *jenv,
             AS_INPUT(unsigned char, nonce_buffer),
             AS_INPUT(unsigned char, pub_buffer),
             AS_INPUT(unsigned char, priv_buffer));
-
-    stodium_release_output(jenv, dst, &dst_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
-    stodium_release_input(jenv, nonce, &nonce_buffer);
-    stodium_release_input(jenv, pub, &pub_buffer);
-    stodium_release_input(jenv, priv, &priv_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -1426,30 +3142,23 @@ STODIUM_JNI(jint, crypto_1box_1curve25519xsalsa20poly1305_1open) (JNIEnv *jenv,
  *
  **************************************************************************** */
 
-STODIUM_CONSTANT(box, curve25519xchacha20poly1305, seedbytes)
-STODIUM_CONSTANT(box, curve25519xchacha20poly1305, publickeybytes)
-STODIUM_CONSTANT(box, curve25519xchacha20poly1305, secretkeybytes)
-STODIUM_CONSTANT(box, curve25519xchacha20poly1305, beforenmbytes)
-STODIUM_CONSTANT(box, curve25519xchacha20poly1305, noncebytes)
-STODIUM_CONSTANT(box, curve25519xchacha20poly1305, macbytes)
 
 STODIUM_JNI(jint, crypto_1box_1curve25519xchacha20poly1305_1seed_1keypair) (JNIEnv *jenv, jclass jcls,
         jobject pk,
         jobject sk,
         jobject seed) {
+    STODIUM_STATS_CALL(STODIUM_STATS_BOX);
     stodium_buffer pk_buffer, sk_buffer, seed_buffer;
-    stodium_get_buffer(jenv, &pk_buffer, pk);
-    stodium_get_buffer(jenv, &sk_buffer, sk);
-    stodium_get_buffer(jenv, &seed_buffer, seed);
+    stodium_get_critical_output(jenv, &pk_buffer, pk);
+    stodium_get_critical_output(jenv, &sk_buffer, sk);
+    stodium_get_critical_input(jenv,  &seed_buffer, seed);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &pk_buffer, &sk_buffer, &seed_buffer);
     jint result = (jint) crypto_box_curve25519xchacha20poly1305_seed_keypair(
             AS_OUTPUT(unsigned char, pk_buffer),
             AS_OUTPUT(unsigned char, sk_buffer),
             AS_INPUT(unsigned char, seed_buffer));
-
-    stodium_release_output(jenv, pk, &pk_buffer);
-    stodium_release_output(jenv, sk, &sk_buffer);
-    stodium_release_input(jenv, seed, &seed_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -1457,6 +3166,7 @@ STODIUM_JNI(jint, crypto_1box_1curve25519xchacha20poly1305_1seed_1keypair) (JNIE
 STODIUM_JNI(jint, crypto_1box_1curve25519xchacha20poly1305_1keypair) (JNIEnv *jenv, jclass jcls,
         jobject pk,
         jobject sk) {
+    STODIUM_STATS_CALL(STODIUM_STATS_BOX);
     stodium_buffer pk_buffer, sk_buffer;
     stodium_get_buffer(jenv, &pk_buffer, pk);
     stodium_get_buffer(jenv, &sk_buffer, sk);
@@ -1475,19 +3185,18 @@ STODIUM_JNI(jint, crypto_1box_1curve25519xchacha20poly1305_1beforenm) (JNIEnv *j
         jobject dst,
         jobject pub,
         jobject priv) {
+    STODIUM_STATS_CALL(STODIUM_STATS_BOX);
     stodium_buffer dst_buffer, pub_buffer, priv_buffer;
-    stodium_get_buffer(jenv, &dst_buffer, dst);
-    stodium_get_buffer(jenv, &pub_buffer, pub);
-    stodium_get_buffer(jenv, &priv_buffer, priv);
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+    stodium_get_critical_input(jenv,  &pub_buffer, pub);
+    stodium_get_critical_input(jenv,  &priv_buffer, priv);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &pub_buffer, &priv_buffer);
     jint result = (jint) crypto_box_curve25519xchacha20poly1305_beforenm(
             AS_OUTPUT(unsigned char, dst_buffer),
             AS_INPUT(unsigned char, pub_buffer),
             AS_INPUT(unsigned char, priv_buffer));
-
-    stodium_release_output(jenv, dst, &dst_buffer);
-    stodium_release_input(jenv, pub, &pub_buffer);
-    stodium_release_input(jenv, priv, &priv_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -1497,23 +3206,21 @@ STODIUM_JNI(jint, crypto_1box_1curve25519xchacha20poly1305_1easy_1afternm) (JNIE
         jobject src,
         jobject nonce,
         jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_BOX);
     stodium_buffer dst_buffer, src_buffer, nonce_buffer, key_buffer;
-    stodium_get_buffer(jenv, &dst_buffer, dst);
-    stodium_get_buffer(jenv, &src_buffer, src);
-    stodium_get_buffer(jenv, &nonce_buffer, nonce);
-    stodium_get_buffer(jenv, &key_buffer, key);
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
+    stodium_get_critical_input(jenv,  &nonce_buffer, nonce);
+    stodium_get_critical_input(jenv,  &key_buffer, key);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &src_buffer, &nonce_buffer, &key_buffer);
     jint result = (jint) crypto_box_curve25519xchacha20poly1305_easy_afternm(
             AS_OUTPUT(unsigned char, dst_buffer),
             AS_INPUT(unsigned char, src_buffer),
             AS_INPUT_LEN(unsigned long long, src_buffer),
             AS_INPUT(unsigned char, nonce_buffer),
             AS_INPUT(unsigned char, key_buffer));
-
-    stodium_release_output(jenv, dst, &dst_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
-    stodium_release_input(jenv, nonce, &nonce_buffer);
-    stodium_release_input(jenv, key, &key_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -1523,23 +3230,21 @@ STODIUM_JNI(jint, crypto_1box_1curve25519xchacha20poly1305_1open_1easy_1afternm)
         jobject src,
         jobject nonce,
         jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_BOX);
     stodium_buffer dst_buffer, src_buffer, nonce_buffer, key_buffer;
-    stodium_get_buffer(jenv, &dst_buffer, dst);
-    stodium_get_buffer(jenv, &src_buffer, src);
-    stodium_get_buffer(jenv, &nonce_buffer, nonce);
-    stodium_get_buffer(jenv, &key_buffer, key);
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
+    stodium_get_critical_input(jenv,  &nonce_buffer, nonce);
+    stodium_get_critical_input(jenv,  &key_buffer, key);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &src_buffer, &nonce_buffer, &key_buffer);
     jint result = (jint) crypto_box_curve25519xchacha20poly1305_open_easy_afternm(
             AS_OUTPUT(unsigned char, dst_buffer),
             AS_INPUT(unsigned char, src_buffer),
             AS_INPUT_LEN(unsigned long long, src_buffer),
             AS_INPUT(unsigned char, nonce_buffer),
             AS_INPUT(unsigned char, key_buffer));
-
-    stodium_release_output(jenv, dst, &dst_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
-    stodium_release_input(jenv, nonce, &nonce_buffer);
-    stodium_release_input(jenv, key, &key_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -1550,13 +3255,15 @@ STODIUM_JNI(jint, crypto_1box_1curve25519xchacha20poly1305_1easy) (JNIEnv *jenv,
         jobject nonce,
         jobject pub,
         jobject priv) {
+    STODIUM_STATS_CALL(STODIUM_STATS_BOX);
     stodium_buffer dst_buffer, src_buffer, nonce_buffer, pub_buffer, priv_buffer;
-    stodium_get_buffer(jenv, &dst_buffer, dst);
-    stodium_get_buffer(jenv, &src_buffer, src);
-    stodium_get_buffer(jenv, &nonce_buffer, nonce);
-    stodium_get_buffer(jenv, &pub_buffer, pub);
-    stodium_get_buffer(jenv, &priv_buffer, priv);
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
+    stodium_get_critical_input(jenv,  &nonce_buffer, nonce);
+    stodium_get_critical_input(jenv,  &pub_buffer, pub);
+    stodium_get_critical_input(jenv,  &priv_buffer, priv);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &src_buffer, &nonce_buffer, &pub_buffer, &priv_buffer);
     jint result = (jint) crypto_box_curve25519xchacha20poly1305_easy(
             AS_OUTPUT(unsigned char, dst_buffer),
             AS_INPUT(unsigned char, src_buffer),
@@ -1564,12 +3271,7 @@ STODIUM_JNI(jint, crypto_1box_1curve25519xchacha20poly1305_1easy) (JNIEnv *jenv,
             AS_INPUT(unsigned char, nonce_buffer),
             AS_INPUT(unsigned char, pub_buffer),
             AS_INPUT(unsigned char, priv_buffer));
-
-    stodium_release_output(jenv, dst, &dst_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
-    stodium_release_input(jenv, nonce, &nonce_buffer);
-    stodium_release_input(jenv, pub, &pub_buffer);
-    stodium_release_input(jenv, priv, &priv_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -1580,13 +3282,15 @@ STODIUM_JNI(jint, crypto_1box_1curve25519xchacha20poly1305_1open_1easy) (JNIEnv
         jobject nonce,
         jobject pub,
         jobject priv) {
+    STODIUM_STATS_CALL(STODIUM_STATS_BOX);
     stodium_buffer dst_buffer, src_buffer, nonce_buffer, pub_buffer, priv_buffer;
-    stodium_get_buffer(jenv, &dst_buffer, dst);
-    stodium_get_buffer(jenv, &src_buffer, src);
-    stodium_get_buffer(jenv, &nonce_buffer, nonce);
-    stodium_get_buffer(jenv, &pub_buffer, pub);
-    stodium_get_buffer(jenv, &priv_buffer, priv);
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
+    stodium_get_critical_input(jenv,  &nonce_buffer, nonce);
+    stodium_get_critical_input(jenv,  &pub_buffer, pub);
+    stodium_get_critical_input(jenv,  &priv_buffer, priv);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &src_buffer, &nonce_buffer, &pub_buffer, &priv_buffer);
     jint result = (jint) crypto_box_curve25519xchacha20poly1305_open_easy(
             AS_OUTPUT(unsigned char, dst_buffer),
             AS_INPUT(unsigned char, src_buffer),
@@ -1594,50 +3298,401 @@ STODIUM_JNI(jint, crypto_1box_1curve25519xchacha20poly1305_1open_1easy) (JNIEnv
             AS_INPUT(unsigned char, nonce_buffer),
             AS_INPUT(unsigned char, pub_buffer),
             AS_INPUT(unsigned char, priv_buffer));
-
-    stodium_release_output(jenv, dst, &dst_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
-    stodium_release_input(jenv, nonce, &nonce_buffer);
-    stodium_release_input(jenv, pub, &pub_buffer);
-    stodium_release_input(jenv, priv, &priv_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
 
 /** ****************************************************************************
  *
- * CODECS
- *
- **************************************************************************** */
-
-/** ****************************************************************************
- *
- * CODECS - HEX
+ * BOX - SHARED KEY CACHE
  *
  **************************************************************************** */
 
-STODIUM_JNI(jint, sodium_1bin2hex) (JNIEnv *jenv, jclass jcls,
-        jobject dst,
-        jobject src) {
-    stodium_buffer dst_buffer, src_buffer;
-    stodium_get_buffer(jenv, &dst_buffer, dst);
-    stodium_get_buffer(jenv, &src_buffer, src);
+/**
+ * STODIUM_BOX_KEYBYTES is the size of a slot in the shared key cache. Both the
+ * shared keys and the local secret key of every Box construction are 32 bytes.
+ */
+#define STODIUM_BOX_KEYBYTES 32
 
-    sodium_bin2hex(
-            AS_OUTPUT(char, dst_buffer),
-            AS_INPUT_LEN(size_t, dst_buffer),
-            AS_INPUT(unsigned char, src_buffer),
-            AS_INPUT_LEN(size_t, src_buffer));
+/**
+ * stodium_box_keys holds the precomputed shared keys of a BoxSession. The keys
+ * live in guarded sodium_malloc memory: count shared keys, followed by the
+ * local secret key they were computed with. The Java side decides which peer
+ * is kept in which slot.
+ */
+typedef struct stodium_box_keys {
+    size_t         count;
+    unsigned char *keys;
+} stodium_box_keys;
 
-    stodium_release_output(jenv, dst, &dst_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
-    
-    return (jint) 0;
+/**
+ * stodium_box_keys_slot returns the key in slot, or NULL if the handle or slot
+ * is invalid.
+ */
+static unsigned char *stodium_box_keys_slot(jlong handle, jint slot) {
+    stodium_box_keys *keys = (stodium_box_keys *) (uintptr_t) handle;
+    if (keys == NULL || slot < 0 || (size_t) slot >= keys->count) {
+        return NULL;
+    }
+    return keys->keys + (size_t) slot * STODIUM_BOX_KEYBYTES;
 }
 
-STODIUM_JNI(jint, sodium_1hex2bin) (JNIEnv *jenv, jclass jcls,
+/**
+ * Allocates a cache of count shared keys, computed with the local secret key
+ * sk, which is copied into the cache. Returns the handle of the cache, or 0 if
+ * it could not be allocated.
+ */
+STODIUM_JNI(jlong, stodium_1box_1keys_1create) (JNIEnv *jenv, jclass jcls,
+        jint    count,
+        jobject sk) {
+    STODIUM_STATS_CALL(STODIUM_STATS_BOX);
+    stodium_box_keys *keys;
+
+    if (count <= 0) {
+        return 0;
+    }
+    keys = (stodium_box_keys *) malloc(sizeof(stodium_box_keys));
+    if (keys == NULL) {
+        return 0;
+    }
+    keys->count = (size_t) count;
+    keys->keys  = (unsigned char *) sodium_allocarray(keys->count + 1, STODIUM_BOX_KEYBYTES);
+    if (keys->keys == NULL) {
+        free(keys);
+        return 0;
+    }
+
+    stodium_buffer sk_buffer;
+    stodium_get_critical_input(jenv, &sk_buffer, sk);
+
+    stodium_buffer *buffers[] = { &sk_buffer };
+    jint result = -1;
+    if (stodium_critical_begin(jenv, buffers, 1)) {
+        if (sk_buffer.capacity == STODIUM_BOX_KEYBYTES) {
+            memcpy(keys->keys + keys->count * STODIUM_BOX_KEYBYTES,
+                    AS_INPUT(unsigned char, sk_buffer), STODIUM_BOX_KEYBYTES);
+            result = 0;
+        }
+        stodium_critical_end(jenv, buffers, 1);
+    }
+
+    if (result != 0) {
+        sodium_free(keys->keys);
+        free(keys);
+        return 0;
+    }
+    return (jlong) (uintptr_t) keys;
+}
+
+/**
+ * Wipes and frees a cache created by stodium_box_keys_create.
+ */
+STODIUM_JNI(void, stodium_1box_1keys_1free) (JNIEnv *jenv, jclass jcls,
+        jlong handle) {
+    stodium_box_keys *keys = (stodium_box_keys *) (uintptr_t) handle;
+    if (keys == NULL) {
+        return;
+    }
+    sodium_free(keys->keys);
+    free(keys);
+}
+
+/**
+ * STODIUM_BOX_KEYS defines the wrappers that use the shared key cache for a
+ * Box construction:
+ *
+ * stodium_box_keys_<jname>_beforenm computes the key shared with pk into slot.
+ * stodium_box_keys_<jname>_easy and _open_easy use the key in slot.
+ *
+ * @jname:  the name of the construction, escaped for use in a JNI name
+ * @prefix: the prefix of the libsodium functions (e.g. box for crypto_box_*)
+ */
+#define STODIUM_BOX_KEYS(jname, prefix) \
+    STODIUM_JNI(jint, stodium_1box_1keys_1##jname##_1beforenm) (JNIEnv *jenv, jclass jcls, \
+            jlong handle, jint slot, jobject pk) { \
+        STODIUM_STATS_CALL(STODIUM_STATS_BOX); \
+        unsigned char *key = stodium_box_keys_slot(handle, slot); \
+        stodium_box_keys *keys = (stodium_box_keys *) (uintptr_t) handle; \
+        if (key == NULL) { \
+            return -1; } \
+        stodium_buffer pk_buffer; \
+        stodium_get_critical_input(jenv, &pk_buffer, pk); \
+        STODIUM_CRITICAL_BEGIN(jenv, &pk_buffer); \
+        jint result = (jint) crypto_##prefix##_beforenm(key, \
+                AS_INPUT(unsigned char, pk_buffer), \
+                keys->keys + keys->count * STODIUM_BOX_KEYBYTES); \
+        STODIUM_CRITICAL_END(jenv); \
+        return result; } \
+    STODIUM_JNI(jint, stodium_1box_1keys_1##jname##_1easy) (JNIEnv *jenv, jclass jcls, \
+            jlong handle, jint slot, jobject dst, jobject src, jobject nonce) { \
+        STODIUM_STATS_CALL(STODIUM_STATS_BOX); \
+        const unsigned char *key = stodium_box_keys_slot(handle, slot); \
+        if (key == NULL) { \
+            return -1; } \
+        stodium_buffer dst_buffer, src_buffer, nonce_buffer; \
+        stodium_get_critical_output(jenv, &dst_buffer, dst); \
+        stodium_get_critical_input(jenv,  &src_buffer, src); \
+        stodium_get_critical_input(jenv,  &nonce_buffer, nonce); \
+        STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &src_buffer, &nonce_buffer); \
+        jint result = (jint) crypto_##prefix##_easy_afternm( \
+                AS_OUTPUT(unsigned char, dst_buffer), \
+                AS_INPUT(unsigned char, src_buffer), \
+                AS_INPUT_LEN(unsigned long long, src_buffer), \
+                AS_INPUT(unsigned char, nonce_buffer), \
+                key); \
+        STODIUM_CRITICAL_END(jenv); \
+        return result; } \
+    STODIUM_JNI(jint, stodium_1box_1keys_1##jname##_1open_1easy) (JNIEnv *jenv, jclass jcls, \
+            jlong handle, jint slot, jobject dst, jobject src, jobject nonce) { \
+        STODIUM_STATS_CALL(STODIUM_STATS_BOX); \
+        const unsigned char *key = stodium_box_keys_slot(handle, slot); \
+        if (key == NULL) { \
+            return -1; } \
+        stodium_buffer dst_buffer, src_buffer, nonce_buffer; \
+        stodium_get_critical_output(jenv, &dst_buffer, dst); \
+        stodium_get_critical_input(jenv,  &src_buffer, src); \
+        stodium_get_critical_input(jenv,  &nonce_buffer, nonce); \
+        STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &src_buffer, &nonce_buffer); \
+        jint result = (jint) crypto_##prefix##_open_easy_afternm( \
+                AS_OUTPUT(unsigned char, dst_buffer), \
+                AS_INPUT(unsigned char, src_buffer), \
+                AS_INPUT_LEN(unsigned long long, src_buffer), \
+                AS_INPUT(unsigned char, nonce_buffer), \
+                key); \
+        STODIUM_CRITICAL_END(jenv); \
+        return result; }
+
+// crypto_box_* is crypto_box_curve25519xsalsa20poly1305, with the easy API
+STODIUM_BOX_KEYS(curve25519xsalsa20poly1305, box)
+STODIUM_BOX_KEYS(curve25519xchacha20poly1305, box_curve25519xchacha20poly1305)
+
+/** ****************************************************************************
+ *
+ * CODECS
+ *
+ **************************************************************************** */
+
+/**
+ * STODIUM_CODEC_BLOCK is the number of bytes encoded, or characters decoded,
+ * at a time for a char[], which is converted from or to bytes on the stack.
+ * It is a multiple of every group size.
+ */
+#define STODIUM_CODEC_BLOCK 3072
+
+static bool stodium_codec_valid(jint variant) {
+    return variant == STODIUM_CODEC_HEX
+            || variant == sodium_base64_VARIANT_ORIGINAL
+            || variant == sodium_base64_VARIANT_ORIGINAL_NO_PADDING
+            || variant == sodium_base64_VARIANT_URLSAFE
+            || variant == sodium_base64_VARIANT_URLSAFE_NO_PADDING;
+}
+
+STODIUM_JNI(jint, stodium_1codec_1encode) (JNIEnv *jenv, jclass jcls,
+        jobject dst,
+        jobject src,
+        jint    variant) {
+    STODIUM_STATS_CALL(STODIUM_STATS_UTILS);
+    if (!stodium_codec_valid(variant)) {
+        return -1;
+    }
+
+    stodium_buffer dst_buffer, src_buffer;
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
+    if (dst_buffer.capacity < stodium_codec_encoded_len(src_buffer.capacity, variant)) {
+        return -1;
+    }
+
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &src_buffer);
+    jint result = (jint) stodium_codec_encode(
+            AS_OUTPUT(unsigned char, dst_buffer),
+            AS_INPUT(unsigned char, src_buffer),
+            AS_INPUT_LEN(size_t, src_buffer),
+            variant);
+    STODIUM_CRITICAL_END(jenv);
+
+    return result;
+}
+
+STODIUM_JNI(jint, stodium_1codec_1decode) (JNIEnv *jenv, jclass jcls,
+        jobject dst,
+        jobject src,
+        jint    variant) {
+    STODIUM_STATS_CALL(STODIUM_STATS_UTILS);
+    jint result = -1;
+    long len;
+
+    if (!stodium_codec_valid(variant)) {
+        return -1;
+    }
+
+    stodium_buffer dst_buffer, src_buffer;
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
+
+    stodium_buffer *buffers[] = { &dst_buffer, &src_buffer };
+    if (stodium_critical_begin(jenv, buffers, 2)) {
+        len = stodium_codec_decoded_len(
+                AS_INPUT(unsigned char, src_buffer),
+                AS_INPUT_LEN(size_t, src_buffer),
+                variant);
+        if (len >= 0 && (size_t) len <= dst_buffer.capacity) {
+            result = (jint) stodium_codec_decode(
+                    AS_OUTPUT(unsigned char, dst_buffer),
+                    AS_INPUT(unsigned char, src_buffer),
+                    AS_INPUT_LEN(size_t, src_buffer),
+                    variant);
+        }
+        stodium_critical_end(jenv, buffers, 2);
+    }
+
+    return result;
+}
+
+STODIUM_JNI(jint, stodium_1codec_1encode_1chars) (JNIEnv *jenv, jclass jcls,
+        jcharArray dst,
+        jint       dst_offset,
+        jobject    src,
+        jint       variant) {
+    STODIUM_STATS_CALL(STODIUM_STATS_UTILS);
+    unsigned char block[2 * STODIUM_CODEC_BLOCK];
+    jint result = -1;
+    size_t done, i, n;
+
+    if (!stodium_codec_valid(variant) || dst_offset < 0
+            || dst_offset > (*jenv)->GetArrayLength(jenv, dst)) {
+        return -1;
+    }
+
+    stodium_buffer src_buffer;
+    stodium_get_critical_input(jenv, &src_buffer, src);
+    if ((size_t) ((*jenv)->GetArrayLength(jenv, dst) - dst_offset)
+            < stodium_codec_encoded_len(src_buffer.capacity, variant)) {
+        return -1;
+    }
+
+    stodium_buffer *buffers[] = { &src_buffer };
+    if (stodium_critical_begin(jenv, buffers, 1)) {
+        jchar *chars = (jchar *) (*jenv)->GetPrimitiveArrayCritical(jenv, dst, NULL);
+        if (chars != NULL) {
+            jchar *out = chars + dst_offset;
+            for (done = 0; done < src_buffer.capacity; done += n) {
+                n = src_buffer.capacity - done < STODIUM_CODEC_BLOCK
+                        ? src_buffer.capacity - done
+                        : STODIUM_CODEC_BLOCK;
+                size_t encoded = stodium_codec_encode(block, AS_INPUT(unsigned char, src_buffer) + done, n, variant);
+                for (i = 0; i < encoded; i++) {
+                    out[i] = (jchar) block[i];
+                }
+                out += encoded;
+            }
+            result = (jint) (out - (chars + dst_offset));
+            (*jenv)->ReleasePrimitiveArrayCritical(jenv, dst, chars, 0);
+        }
+        stodium_critical_end(jenv, buffers, 1);
+    }
+    sodium_memzero(block, sizeof block);
+
+    return result;
+}
+
+STODIUM_JNI(jint, stodium_1codec_1decode_1chars) (JNIEnv *jenv, jclass jcls,
+        jobject    dst,
+        jcharArray src,
+        jint       src_offset,
+        jint       src_length,
+        jint       variant) {
+    STODIUM_STATS_CALL(STODIUM_STATS_UTILS);
+    unsigned char block[STODIUM_CODEC_BLOCK];
+    jint result = -1;
+    size_t done, i, n;
+    long len, written;
+
+    if (!stodium_codec_valid(variant) || src_offset < 0 || src_length < 0
+            || src_offset > (*jenv)->GetArrayLength(jenv, src)
+            || src_length > (*jenv)->GetArrayLength(jenv, src) - src_offset) {
+        return -1;
+    }
+
+    stodium_buffer dst_buffer;
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+
+    stodium_buffer *buffers[] = { &dst_buffer };
+    if (stodium_critical_begin(jenv, buffers, 1)) {
+        jchar *chars = (jchar *) (*jenv)->GetPrimitiveArrayCritical(jenv, src, NULL);
+        if (chars != NULL) {
+            const jchar   *in  = chars + src_offset;
+            unsigned char *out = AS_OUTPUT(unsigned char, dst_buffer);
+
+            // the padding, if any, is in the last two characters
+            n = src_length < 2 ? (size_t) src_length : 2;
+            for (i = 0; i < n; i++) {
+                block[i] = (unsigned char) in[(size_t) src_length - n + i];
+            }
+            len    = stodium_codec_decoded_len(block, (size_t) src_length, variant);
+            result = len >= 0 && (size_t) len <= dst_buffer.capacity ? (jint) len : -1;
+
+            for (done = 0; result >= 0 && done < (size_t) src_length; done += n) {
+                n = (size_t) src_length - done < STODIUM_CODEC_BLOCK
+                        ? (size_t) src_length - done
+                        : STODIUM_CODEC_BLOCK;
+                // characters beyond ASCII become 0xFF, which is never valid
+                for (i = 0; i < n; i++) {
+                    block[i] = (unsigned char) (in[done + i] | (((0x7FU - in[done + i]) >> 16) & 0xFF));
+                }
+                written = stodium_codec_decode(out, block, n, variant);
+                // a block before the last one decodes to whole groups, without padding
+                if (written < 0 || (done + n < (size_t) src_length
+                        && (size_t) written != (variant == STODIUM_CODEC_HEX ? n / 2 : n / 4 * 3))) {
+                    result = -1;
+                }
+                out += written;
+            }
+            (*jenv)->ReleasePrimitiveArrayCritical(jenv, src, chars, JNI_ABORT);
+        }
+        stodium_critical_end(jenv, buffers, 1);
+    }
+    sodium_memzero(block, sizeof block);
+
+    return result;
+}
+
+/** ****************************************************************************
+ *
+ * CODECS - HEX
+ *
+ **************************************************************************** */
+
+STODIUM_JNI(jint, sodium_1bin2hex) (JNIEnv *jenv, jclass jcls,
+        jobject dst,
+        jobject src) {
+    STODIUM_STATS_CALL(STODIUM_STATS_UTILS);
+    stodium_buffer dst_buffer, src_buffer;
+    stodium_get_buffer(jenv, &dst_buffer, dst);
+    stodium_get_buffer(jenv, &src_buffer, src);
+
+    // sodium_bin2hex would need room for a NUL terminator as well
+    jint result = -1;
+    if (AS_INPUT_LEN(size_t, dst_buffer) >= stodium_codec_encoded_len(AS_INPUT_LEN(size_t, src_buffer), STODIUM_CODEC_HEX)) {
+        stodium_codec_encode(
+                AS_OUTPUT(unsigned char, dst_buffer),
+                AS_INPUT(unsigned char, src_buffer),
+                AS_INPUT_LEN(size_t, src_buffer),
+                STODIUM_CODEC_HEX);
+        result = 0;
+    }
+
+    stodium_release_output(jenv, dst, &dst_buffer);
+    stodium_release_input(jenv, src, &src_buffer);
+
+    return result;
+}
+
+STODIUM_JNI(jint, sodium_1hex2bin) (JNIEnv *jenv, jclass jcls,
         jobject dst,
         jobject src) {
+    STODIUM_STATS_CALL(STODIUM_STATS_UTILS);
     stodium_buffer dst_buffer, src_buffer;
     stodium_get_buffer(jenv, &dst_buffer, dst);
     stodium_get_buffer(jenv, &src_buffer, src);
@@ -1663,16 +3718,16 @@ STODIUM_JNI(jint, sodium_1hex2bin) (JNIEnv *jenv, jclass jcls,
  *
  **************************************************************************** */
 
-STODIUM_JNI(jint, stodium_1base64_1variant_1original) (JNIEnv *jenv, jclass jcls) {
+STODIUM_JNI(jint, sodium_1base64_1variant_1original) (JNIEnv *jenv, jclass jcls) {
         return (jint) sodium_base64_VARIANT_ORIGINAL;
 }
-STODIUM_JNI(jint, stodium_1base64_1variant_1original_1no_1padding) (JNIEnv *jenv, jclass jcls) {
+STODIUM_JNI(jint, sodium_1base64_1variant_1original_1no_1padding) (JNIEnv *jenv, jclass jcls) {
         return (jint) sodium_base64_VARIANT_ORIGINAL_NO_PADDING;
 }
-STODIUM_JNI(jint, stodium_1base64_1variant_1urlsafe) (JNIEnv *jenv, jclass jcls) {
+STODIUM_JNI(jint, sodium_1base64_1variant_1urlsafe) (JNIEnv *jenv, jclass jcls) {
         return (jint) sodium_base64_VARIANT_URLSAFE;
 }
-STODIUM_JNI(jint, stodium_1base64_1variant_1urlsafe_1no_1padding) (JNIEnv *jenv, jclass jcls) {
+STODIUM_JNI(jint, sodium_1base64_1variant_1urlsafe_1no_1padding) (JNIEnv *jenv, jclass jcls) {
         return (jint) sodium_base64_VARIANT_URLSAFE_NO_PADDING;
 }
 
@@ -1688,27 +3743,34 @@ STODIUM_JNI(jint, sodium_1bin2base64) (JNIEnv *jenv, jclass jcls,
         jobject dst,
         jobject src,
         jint variant) {
+    STODIUM_STATS_CALL(STODIUM_STATS_UTILS);
     stodium_buffer dst_buffer, src_buffer;
     stodium_get_buffer(jenv, &dst_buffer, dst);
     stodium_get_buffer(jenv, &src_buffer, src);
 
-    sodium_bin2base64(
-            AS_OUTPUT(char, dst_buffer),
-            AS_INPUT_LEN(size_t, dst_buffer),
-            AS_INPUT(unsigned char, src_buffer),
-            AS_INPUT_LEN(size_t, src_buffer),
-            (const int) variant);
+    // sodium_bin2base64 would need room for a NUL terminator as well
+    jint result = -1;
+    if (stodium_codec_valid(variant) && variant != STODIUM_CODEC_HEX
+            && AS_INPUT_LEN(size_t, dst_buffer) >= stodium_codec_encoded_len(AS_INPUT_LEN(size_t, src_buffer), variant)) {
+        stodium_codec_encode(
+                AS_OUTPUT(unsigned char, dst_buffer),
+                AS_INPUT(unsigned char, src_buffer),
+                AS_INPUT_LEN(size_t, src_buffer),
+                variant);
+        result = 0;
+    }
 
     stodium_release_output(jenv, dst, &dst_buffer);
     stodium_release_input(jenv, src, &src_buffer);
-    
-    return 0;
+
+    return result;
 }
 
 STODIUM_JNI(jint, sodium_1base642bin) (JNIEnv *jenv, jclass jcls,
         jobject dst,
         jobject src,
         jint variant) {
+    STODIUM_STATS_CALL(STODIUM_STATS_UTILS);
     stodium_buffer dst_buffer, src_buffer;
     stodium_get_buffer(jenv, &dst_buffer, dst);
     stodium_get_buffer(jenv, &src_buffer, src);
@@ -1719,7 +3781,7 @@ STODIUM_JNI(jint, sodium_1base642bin) (JNIEnv *jenv, jclass jcls,
             AS_INPUT(char, src_buffer),
             AS_INPUT_LEN(size_t, src_buffer),
             NULL,
-            AS_OUTPUT_LEN(size_t, dst_buffer),
+            NULL,
             NULL,
             (const int) variant);
 
@@ -1735,32 +3797,26 @@ STODIUM_JNI(jint, sodium_1base642bin) (JNIEnv *jenv, jclass jcls,
  *
  **************************************************************************** */
 
-STODIUM_CONSTANT(core, hchacha20, outputbytes)
-STODIUM_CONSTANT(core, hchacha20, inputbytes)
-STODIUM_CONSTANT(core, hchacha20, keybytes)
-STODIUM_CONSTANT(core, hchacha20, constbytes)
 
 STODIUM_JNI(jint, crypto_1core_1hchacha20) (JNIEnv *jenv, jclass jcls,
         jobject dst,
         jobject src,
         jobject key,
         jobject constant) {
+    STODIUM_STATS_CALL(STODIUM_STATS_CORE);
     stodium_buffer dst_buffer, src_buffer, key_buffer, const_buffer;
-    stodium_get_buffer(jenv, &dst_buffer,   dst);
-    stodium_get_buffer(jenv, &src_buffer,   src);
-    stodium_get_buffer(jenv, &key_buffer,   key);
-    stodium_get_buffer(jenv, &const_buffer, constant);
+    stodium_get_critical_output(jenv, &dst_buffer,   dst);
+    stodium_get_critical_input(jenv,  &src_buffer,   src);
+    stodium_get_critical_input(jenv,  &key_buffer,   key);
+    stodium_get_critical_input(jenv,  &const_buffer, constant);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &src_buffer, &key_buffer, &const_buffer);
     jint result = (jint) crypto_core_hchacha20(
             AS_OUTPUT(unsigned char, dst_buffer),
             AS_INPUT(unsigned char, src_buffer),
             AS_INPUT(unsigned char, key_buffer),
             AS_INPUT(unsigned char, const_buffer));
-
-    stodium_release_output(jenv, dst, &dst_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
-    stodium_release_input(jenv, key, &key_buffer);
-    stodium_release_input(jenv, constant, &const_buffer);
+    STODIUM_CRITICAL_END(jenv);
     
     return result;
 }
@@ -1771,32 +3827,26 @@ STODIUM_JNI(jint, crypto_1core_1hchacha20) (JNIEnv *jenv, jclass jcls,
  *
  **************************************************************************** */
 
-STODIUM_CONSTANT(core, hsalsa20, outputbytes)
-STODIUM_CONSTANT(core, hsalsa20, inputbytes)
-STODIUM_CONSTANT(core, hsalsa20, keybytes)
-STODIUM_CONSTANT(core, hsalsa20, constbytes)
 
 STODIUM_JNI(jint, crypto_1core_1hsalsa20) (JNIEnv *jenv, jclass jcls,
         jobject dst,
         jobject src,
         jobject key,
         jobject constant) {
+    STODIUM_STATS_CALL(STODIUM_STATS_CORE);
     stodium_buffer dst_buffer, src_buffer, key_buffer, const_buffer;
-    stodium_get_buffer(jenv, &dst_buffer,   dst);
-    stodium_get_buffer(jenv, &src_buffer,   src);
-    stodium_get_buffer(jenv, &key_buffer,   key);
-    stodium_get_buffer(jenv, &const_buffer, constant);
+    stodium_get_critical_output(jenv, &dst_buffer,   dst);
+    stodium_get_critical_input(jenv,  &src_buffer,   src);
+    stodium_get_critical_input(jenv,  &key_buffer,   key);
+    stodium_get_critical_input(jenv,  &const_buffer, constant);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &src_buffer, &key_buffer, &const_buffer);
     jint result = (jint) crypto_core_hsalsa20(
             AS_OUTPUT(unsigned char, dst_buffer),
             AS_INPUT(unsigned char, src_buffer),
             AS_INPUT(unsigned char, key_buffer),
             AS_INPUT(unsigned char, const_buffer));
-
-    stodium_release_output(jenv, dst, &dst_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
-    stodium_release_input(jenv, key, &key_buffer);
-    stodium_release_input(jenv, constant, &const_buffer);
+    STODIUM_CRITICAL_END(jenv);
     
     return result;
 }
@@ -1814,33 +3864,18 @@ STODIUM_CONSTANT_STR(generichash)
  * GENERICHASH - Blake2b
  *
  **************************************************************************** */
-STODIUM_CONSTANT(generichash, blake2b, bytes)
-STODIUM_CONSTANT(generichash, blake2b, keybytes)
-STODIUM_CONSTANT(generichash, blake2b, saltbytes)
-STODIUM_CONSTANT(generichash, blake2b, personalbytes)
-STODIUM_CONSTANT(generichash, blake2b, statebytes)
-STODIUM_JNI(jint, crypto_1generichash_1blake2b_1bytes_1min) (JNIEnv *jenv, jclass jcls) {
-    return (jint) crypto_generichash_blake2b_bytes_min();
-}
-STODIUM_JNI(jint, crypto_1generichash_1blake2b_1bytes_1max) (JNIEnv *jenv, jclass jcls) {
-    return (jint) crypto_generichash_blake2b_bytes_max();
-}
-STODIUM_JNI(jint, crypto_1generichash_1blake2b_1keybytes_1min) (JNIEnv *jenv, jclass jcls) {
-    return (jint) crypto_generichash_blake2b_keybytes_min();
-}
-STODIUM_JNI(jint, crypto_1generichash_1blake2b_1keybytes_1max) (JNIEnv *jenv, jclass jcls) {
-    return (jint) crypto_generichash_blake2b_keybytes_max();
-}
 
 STODIUM_JNI(jint, crypto_1generichash_1blake2b) (JNIEnv *jenv, jclass jcls,
         jobject dst,
         jobject src,
         jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_GENERICHASH);
     stodium_buffer dst_buffer, src_buffer, key_buffer;
-    stodium_get_buffer(jenv, &dst_buffer, dst);
-    stodium_get_buffer(jenv, &src_buffer, src);
-    stodium_get_buffer(jenv, &key_buffer, key);
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
+    stodium_get_critical_input(jenv,  &key_buffer, key);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &src_buffer, &key_buffer);
     jint result = (jint) crypto_generichash_blake2b(
             AS_OUTPUT(unsigned char, dst_buffer),
             AS_INPUT_LEN(size_t, dst_buffer),
@@ -1848,10 +3883,7 @@ STODIUM_JNI(jint, crypto_1generichash_1blake2b) (JNIEnv *jenv, jclass jcls,
             AS_INPUT_LEN(unsigned long long, src_buffer),
             AS_INPUT(unsigned char, key_buffer),
             AS_INPUT_LEN(size_t, key_buffer));
-
-    stodium_release_output(jenv, dst, &dst_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
-    stodium_release_input(jenv, key, &key_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -1862,13 +3894,15 @@ STODIUM_JNI(jint, crypto_1generichash_1blake2b_1salt_1personal) (JNIEnv *jenv, j
         jobject key,
         jobject salt,
         jobject personal) {
+    STODIUM_STATS_CALL(STODIUM_STATS_GENERICHASH);
     stodium_buffer dst_buffer, src_buffer, key_buffer, salt_buffer, pers_buffer;
-    stodium_get_buffer(jenv, &dst_buffer, dst);
-    stodium_get_buffer(jenv, &src_buffer, src);
-    stodium_get_buffer(jenv, &key_buffer, key);
-    stodium_get_buffer(jenv, &salt_buffer, salt);
-    stodium_get_buffer(jenv, &pers_buffer, personal);
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
+    stodium_get_critical_input(jenv,  &key_buffer, key);
+    stodium_get_critical_input(jenv,  &salt_buffer, salt);
+    stodium_get_critical_input(jenv,  &pers_buffer, personal);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &src_buffer, &key_buffer, &salt_buffer, &pers_buffer);
     jint result = (jint) crypto_generichash_blake2b_salt_personal(
             AS_OUTPUT(unsigned char, dst_buffer),
             AS_INPUT_LEN(size_t, dst_buffer),
@@ -1878,12 +3912,7 @@ STODIUM_JNI(jint, crypto_1generichash_1blake2b_1salt_1personal) (JNIEnv *jenv, j
             AS_INPUT_LEN(size_t, key_buffer),
             AS_INPUT(unsigned char, salt_buffer),
             AS_INPUT(unsigned char, pers_buffer));
-
-    stodium_release_output(jenv, dst, &dst_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
-    stodium_release_input(jenv, key, &key_buffer);
-    stodium_release_input(jenv, salt, &salt_buffer);
-    stodium_release_input(jenv, personal, &pers_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -1893,18 +3922,18 @@ STODIUM_JNI(jint, crypto_1generichash_1blake2b_1init) (JNIEnv *jenv, jclass jcls
         jobject state,
         jobject key,
         jint    outlen) {
+    STODIUM_STATS_CALL(STODIUM_STATS_GENERICHASH);
     stodium_buffer dst_buffer, key_buffer;
-    stodium_get_buffer(jenv, &dst_buffer, state);
-    stodium_get_buffer(jenv, &key_buffer, key);
+    stodium_get_critical_output(jenv, &dst_buffer, state);
+    stodium_get_critical_input(jenv,  &key_buffer, key);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &key_buffer);
     jint result = (jint) crypto_generichash_blake2b_init(
             AS_OUTPUT(crypto_generichash_blake2b_state, dst_buffer),
             AS_INPUT(unsigned char, key_buffer),
             AS_INPUT_LEN(size_t, key_buffer),
             (size_t) outlen);
-
-    stodium_release_output(jenv, state, &dst_buffer);
-    stodium_release_input(jenv, key, &key_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -1912,34 +3941,393 @@ STODIUM_JNI(jint, crypto_1generichash_1blake2b_1init) (JNIEnv *jenv, jclass jcls
 STODIUM_JNI(jint, crypto_1generichash_1blake2b_1update) (JNIEnv *jenv, jclass jcls,
         jobject state,
         jobject src) {
+    STODIUM_STATS_CALL(STODIUM_STATS_GENERICHASH);
     stodium_buffer dst_buffer, src_buffer;
-    stodium_get_buffer(jenv, &dst_buffer, state);
-    stodium_get_buffer(jenv, &src_buffer, src);
+    stodium_get_critical_output(jenv, &dst_buffer, state);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &src_buffer);
     jint result = (jint) crypto_generichash_blake2b_update(
             AS_OUTPUT(crypto_generichash_blake2b_state, dst_buffer),
             AS_INPUT(unsigned char, src_buffer),
             AS_INPUT_LEN(unsigned long long, src_buffer));
-
-    stodium_release_output(jenv, state, &dst_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
+    STODIUM_CRITICAL_END(jenv);
     return result;
 }
 
 STODIUM_JNI(jint, crypto_1generichash_1blake2b_1final) (JNIEnv *jenv, jclass jcls,
         jobject state,
         jobject dst) {
+    STODIUM_STATS_CALL(STODIUM_STATS_GENERICHASH);
     stodium_buffer state_buffer, dst_buffer;
-    stodium_get_buffer(jenv, &dst_buffer, dst);
-    stodium_get_buffer(jenv, &state_buffer, state);
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+    stodium_get_critical_output(jenv, &state_buffer, state);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &state_buffer);
     jint result = (jint) crypto_generichash_blake2b_final(
             AS_OUTPUT(crypto_generichash_blake2b_state, state_buffer),
             AS_OUTPUT(unsigned char, dst_buffer),
             AS_INPUT_LEN(size_t, dst_buffer));
+    STODIUM_CRITICAL_END(jenv);
 
-    stodium_release_output(jenv, dst, &dst_buffer);
-    stodium_release_output(jenv, state, &state_buffer);
+    return result;
+}
+
+/**
+ * stodium_generichash_batch describes a batch of messages hashed with the same
+ * key. The table holds an (offset, length) pair for every message in src; the
+ * digests of outlen bytes are written back to back to dst, in the same order.
+ * failed counts the messages libsodium failed to hash, over every thread of
+ * the pool.
+ */
+typedef struct stodium_generichash_batch {
+    size_t               count;
+    size_t               failed;
+    unsigned char       *dst;
+    size_t               outlen;
+    const unsigned char *src;
+    const jint          *table;
+    const unsigned char *key;
+    size_t               keylen;
+} stodium_generichash_batch;
+
+/**
+ * stodium_generichash_batch_task is the stodium_pool_task for a Blake2b batch.
+ */
+static void stodium_generichash_batch_task(void *ctx, size_t begin, size_t end) {
+    stodium_generichash_batch *batch = (stodium_generichash_batch *) ctx;
+    size_t i, failed = 0;
+
+    for (i = begin; i < end; i++) {
+        failed += crypto_generichash_blake2b(batch->dst + i * batch->outlen, batch->outlen,
+                batch->src + batch->table[2 * i], (unsigned long long) batch->table[2 * i + 1],
+                batch->key, batch->keylen) != 0;
+    }
+    if (failed != 0) {
+        __atomic_add_fetch(&batch->failed, failed, __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * Hashes the messages of a batch, see stodium_generichash_batch. Returns 0, or
+ * -1 if the arguments were invalid or any of the messages failed to hash.
+ */
+STODIUM_JNI(jint, crypto_1generichash_1blake2b_1batch) (JNIEnv *jenv, jclass jcls,
+        jobject   dst,
+        jint      outlen,
+        jobject   src,
+        jintArray table,
+        jobject   key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_GENERICHASH);
+    stodium_generichash_batch batch;
+    jint *table_elements;
+    jint result = -1;
+    size_t i;
+
+    batch.count  = (size_t) ((*jenv)->GetArrayLength(jenv, table) / 2);
+    batch.failed = 0;
+    batch.outlen = (size_t) outlen;
+    if (outlen < (jint) crypto_generichash_blake2b_bytes_min()
+            || outlen > (jint) crypto_generichash_blake2b_bytes_max()) {
+        return -1;
+    }
+
+    table_elements = (*jenv)->GetIntArrayElements(jenv, table, NULL);
+    if (table_elements == NULL) {
+        return -1;
+    }
+
+    stodium_buffer dst_buffer, src_buffer, key_buffer;
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
+    stodium_get_critical_input(jenv,  &key_buffer, key);
+
+    stodium_buffer *buffers[] = { &dst_buffer, &src_buffer, &key_buffer };
+    if (stodium_critical_begin(jenv, buffers, 3)) {
+        batch.dst    = AS_OUTPUT(unsigned char, dst_buffer);
+        batch.src    = AS_INPUT(unsigned char, src_buffer);
+        batch.table  = table_elements;
+        batch.key    = AS_INPUT(unsigned char, key_buffer);
+        batch.keylen = AS_INPUT_LEN(size_t, key_buffer);
+
+        result = dst_buffer.capacity / batch.outlen >= batch.count
+                && batch.keylen <= crypto_generichash_blake2b_keybytes_max() ? 0 : -1;
+        for (i = 0; result == 0 && i < batch.count; i++) {
+            jint offset = table_elements[2 * i];
+            jint length = table_elements[2 * i + 1];
+            if (offset < 0 || length < 0
+                    || (size_t) offset > src_buffer.capacity
+                    || (size_t) length > src_buffer.capacity - (size_t) offset) {
+                result = -1;
+            }
+        }
+
+        if (result == 0) {
+            stodium_pool_run(stodium_generichash_batch_task, &batch, batch.count, STODIUM_POOL_GRAIN);
+            result = batch.failed == 0 ? 0 : -1;
+        }
+        stodium_critical_end(jenv, buffers, 3);
+    }
+
+    (*jenv)->ReleaseIntArrayElements(jenv, table, table_elements, JNI_ABORT);
+
+    return result;
+}
+
+/** ****************************************************************************
+ *
+ * GENERICHASH - Blake2b tree
+ *
+ **************************************************************************** */
+
+/**
+ * A Blake2b tree is a binary Merkle tree over the fixed-size leaves of a
+ * message. Leaf i is the Blake2b of 0x00 || leaf, every parent the Blake2b of
+ * 0x01 || left || right (or 0x01 || left for the last node of an odd level),
+ * all of outlen bytes and with the same optional key.
+ *
+ * The tree lives in a single buffer: the digests of every level, from the
+ * leaves up to the root, followed by a flag byte for every node. The flags
+ * let a root be recomputed from only the leaves that were changed since the
+ * last root, and catch leaves that were never hashed.
+ */
+#define STODIUM_TREE_UNSET   0
+#define STODIUM_TREE_CHANGED 1
+#define STODIUM_TREE_CLEAN   2
+
+#define STODIUM_TREE_LEVELS_MAX 33
+
+/**
+ * STODIUM_TREE_LEAF_GRAIN is the number of leaf bytes a worker hashes at
+ * least, so small leaves are handed out in slices.
+ */
+#define STODIUM_TREE_LEAF_GRAIN 65536
+
+/**
+ * stodium_tree_levels writes the index of the first node and the number of
+ * nodes of every level of a tree of leaves leaves, and returns the number of
+ * levels. The total number of nodes is first[levels - 1] + 1.
+ */
+static size_t stodium_tree_levels(size_t leaves, size_t *first, size_t *count) {
+    size_t levels = 0, nodes = 0;
+    do {
+        first[levels] = nodes;
+        count[levels] = leaves;
+        nodes        += leaves;
+        leaves        = (leaves + 1) / 2;
+        levels++;
+    } while (count[levels - 1] > 1);
+    return levels;
+}
+
+/**
+ * stodium_tree describes a Blake2b tree for the stodium_pool_tasks below.
+ */
+typedef struct stodium_tree {
+    unsigned char       *digests;
+    unsigned char       *flags;
+    size_t               outlen;
+    const unsigned char *key;
+    size_t               keylen;
+
+    // the leaves being hashed
+    const unsigned char *src;
+    size_t               srclen;
+    size_t               leaf_size;
+    size_t               leaf_first;
+
+    // the level whose parents are being hashed
+    size_t               child_first;
+    size_t               child_count;
+    size_t               parent_first;
+} stodium_tree;
+
+static void stodium_tree_hash(const stodium_tree *tree, unsigned char *dst, unsigned char prefix,
+        const unsigned char *in, size_t inlen) {
+    crypto_generichash_blake2b_state state;
+    crypto_generichash_blake2b_init(&state, tree->key, tree->keylen, tree->outlen);
+    crypto_generichash_blake2b_update(&state, &prefix, 1);
+    crypto_generichash_blake2b_update(&state, in, (unsigned long long) inlen);
+    crypto_generichash_blake2b_final(&state, dst, tree->outlen);
+    sodium_memzero(&state, sizeof state);
+}
+
+/**
+ * stodium_tree_leaf_task is the stodium_pool_task hashing the leaves in src.
+ */
+static void stodium_tree_leaf_task(void *ctx, size_t begin, size_t end) {
+    const stodium_tree *tree = (const stodium_tree *) ctx;
+    size_t i;
+
+    for (i = begin; i < end; i++) {
+        size_t offset = i * tree->leaf_size;
+        size_t len    = tree->srclen - offset < tree->leaf_size ? tree->srclen - offset : tree->leaf_size;
+        size_t node   = tree->leaf_first + i;
+
+        stodium_tree_hash(tree, tree->digests + node * tree->outlen, 0x00, tree->src + offset, len);
+        tree->flags[node] = STODIUM_TREE_CHANGED;
+    }
+}
+
+/**
+ * stodium_tree_parent_task is the stodium_pool_task rehashing the parents of
+ * the changed nodes on one level. A parent only touches its own two children,
+ * so the tasks need no locking.
+ */
+static void stodium_tree_parent_task(void *ctx, size_t begin, size_t end) {
+    const stodium_tree *tree = (const stodium_tree *) ctx;
+    size_t i;
+
+    for (i = begin; i < end; i++) {
+        size_t child    = tree->child_first + 2 * i;
+        size_t children = 2 * i + 1 < tree->child_count ? 2 : 1;
+
+        if (tree->flags[child] != STODIUM_TREE_CHANGED
+                && (children == 1 || tree->flags[child + 1] != STODIUM_TREE_CHANGED)) {
+            continue;
+        }
+        stodium_tree_hash(tree, tree->digests + (tree->parent_first + i) * tree->outlen, 0x01,
+                tree->digests + child * tree->outlen, children * tree->outlen);
+        tree->flags[child] = STODIUM_TREE_CLEAN;
+        if (children == 2) {
+            tree->flags[child + 1] = STODIUM_TREE_CLEAN;
+        }
+        tree->flags[tree->parent_first + i] = STODIUM_TREE_CHANGED;
+    }
+}
+
+/**
+ * stodium_tree_bytes returns the size of the buffer of a tree, or 0 if the
+ * arguments are not valid.
+ */
+static size_t stodium_tree_bytes(jint leaves, jint outlen) {
+    size_t first[STODIUM_TREE_LEVELS_MAX], count[STODIUM_TREE_LEVELS_MAX];
+    size_t levels;
+
+    if (leaves < 1
+            || outlen < (jint) crypto_generichash_blake2b_bytes_min()
+            || outlen > (jint) crypto_generichash_blake2b_bytes_max()) {
+        return 0;
+    }
+    levels = stodium_tree_levels((size_t) leaves, first, count);
+    return (first[levels - 1] + 1) * ((size_t) outlen + 1);
+}
+
+/**
+ * stodium_tree_resolve fills tree from the tree buffer and the key, or returns
+ * false if the buffer is too small for a tree of leaves leaves.
+ */
+static bool stodium_tree_resolve(stodium_tree *tree, stodium_buffer *tree_buffer,
+        stodium_buffer *key_buffer, jint leaves, jint outlen) {
+    size_t bytes = stodium_tree_bytes(leaves, outlen);
+    if (bytes == 0 || tree_buffer->capacity < bytes) {
+        return false;
+    }
+    tree->outlen  = (size_t) outlen;
+    tree->digests = AS_OUTPUT(unsigned char, (*tree_buffer));
+    tree->flags   = tree->digests + bytes / (tree->outlen + 1) * tree->outlen;
+    tree->key     = AS_INPUT(unsigned char, (*key_buffer));
+    tree->keylen  = AS_INPUT_LEN(size_t, (*key_buffer));
+    return true;
+}
+
+STODIUM_JNI(jlong, crypto_1generichash_1blake2b_1tree_1bytes) (JNIEnv *jenv, jclass jcls,
+        jint leaves,
+        jint outlen) {
+    STODIUM_STATS_CALL(STODIUM_STATS_GENERICHASH);
+    return (jlong) stodium_tree_bytes(leaves, outlen);
+}
+
+STODIUM_JNI(jint, crypto_1generichash_1blake2b_1tree_1leaves) (JNIEnv *jenv, jclass jcls,
+        jobject tree,
+        jint    leaves,
+        jint    outlen,
+        jint    first,
+        jint    leaf_size,
+        jobject src,
+        jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_GENERICHASH);
+    stodium_tree tree_desc;
+    jint result = -1;
+    size_t count;
+
+    if (first < 0 || leaf_size < 1) {
+        return -1;
+    }
+
+    stodium_buffer tree_buffer, src_buffer, key_buffer;
+    stodium_get_critical_output(jenv, &tree_buffer, tree);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
+    stodium_get_critical_input(jenv,  &key_buffer, key);
+
+    // an empty src is the single, empty leaf of an empty message
+    count = src_buffer.capacity == 0
+            ? 1
+            : (src_buffer.capacity + (size_t) leaf_size - 1) / (size_t) leaf_size;
+
+    stodium_buffer *buffers[] = { &tree_buffer, &src_buffer, &key_buffer };
+    if (stodium_critical_begin(jenv, buffers, 3)) {
+        if (first < leaves && count <= (size_t) (leaves - first)
+                && stodium_tree_resolve(&tree_desc, &tree_buffer, &key_buffer, leaves, outlen)) {
+            tree_desc.src        = AS_INPUT(unsigned char, src_buffer);
+            tree_desc.srclen     = src_buffer.capacity;
+            tree_desc.leaf_size  = (size_t) leaf_size;
+            tree_desc.leaf_first = (size_t) first;
+
+            stodium_pool_run(stodium_tree_leaf_task, &tree_desc, count,
+                    leaf_size >= STODIUM_TREE_LEAF_GRAIN ? 1 : STODIUM_TREE_LEAF_GRAIN / (size_t) leaf_size);
+            result = 0;
+        }
+        stodium_critical_end(jenv, buffers, 3);
+    }
+
+    return result;
+}
+
+STODIUM_JNI(jint, crypto_1generichash_1blake2b_1tree_1root) (JNIEnv *jenv, jclass jcls,
+        jobject tree,
+        jint    leaves,
+        jint    outlen,
+        jobject dst,
+        jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_GENERICHASH);
+    size_t first[STODIUM_TREE_LEVELS_MAX], count[STODIUM_TREE_LEVELS_MAX];
+    size_t levels, level, i;
+    stodium_tree tree_desc;
+    jint result = -1;
+
+    stodium_buffer tree_buffer, dst_buffer, key_buffer;
+    stodium_get_critical_output(jenv, &tree_buffer, tree);
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+    stodium_get_critical_input(jenv,  &key_buffer, key);
+
+    stodium_buffer *buffers[] = { &tree_buffer, &dst_buffer, &key_buffer };
+    if (stodium_critical_begin(jenv, buffers, 3)) {
+        if (stodium_tree_resolve(&tree_desc, &tree_buffer, &key_buffer, leaves, outlen)
+                && dst_buffer.capacity >= (size_t) outlen) {
+            result = 0;
+            for (i = 0; result == 0 && i < (size_t) leaves; i++) {
+                if (tree_desc.flags[i] == STODIUM_TREE_UNSET) {
+                    result = -1;
+                }
+            }
+        }
+
+        if (result == 0) {
+            levels = stodium_tree_levels((size_t) leaves, first, count);
+            for (level = 0; level + 1 < levels; level++) {
+                tree_desc.child_first  = first[level];
+                tree_desc.child_count  = count[level];
+                tree_desc.parent_first = first[level + 1];
+                stodium_pool_run(stodium_tree_parent_task, &tree_desc, count[level + 1], STODIUM_POOL_GRAIN);
+            }
+            tree_desc.flags[first[levels - 1]] = STODIUM_TREE_CLEAN;
+            memcpy(AS_OUTPUT(unsigned char, dst_buffer),
+                    tree_desc.digests + first[levels - 1] * tree_desc.outlen,
+                    tree_desc.outlen);
+        }
+        stodium_critical_end(jenv, buffers, 3);
+    }
 
     return result;
 }
@@ -1958,36 +4346,35 @@ STODIUM_CONSTANT_STR(hash)
  *
  **************************************************************************** */
 
-STODIUM_CONSTANT(hash, sha256, bytes)
-STODIUM_CONSTANT(hash, sha256, statebytes)
 
 STODIUM_JNI(jint, crypto_1hash_1sha256) (JNIEnv *jenv, jclass jcls,
         jobject mac,
         jobject src) {
+    STODIUM_STATS_CALL(STODIUM_STATS_HASH);
     stodium_buffer mac_buffer, src_buffer;
-    stodium_get_buffer(jenv, &mac_buffer, mac);
-    stodium_get_buffer(jenv, &src_buffer, src);
+    stodium_get_critical_output(jenv, &mac_buffer, mac);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &mac_buffer, &src_buffer);
     jint result = (jint) crypto_hash_sha256(
             AS_OUTPUT(unsigned char, mac_buffer),
             AS_INPUT(unsigned char, src_buffer),
             AS_INPUT_LEN(unsigned long long, src_buffer));
-
-    stodium_release_output(jenv, mac, &mac_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
 
 STODIUM_JNI(jint, crypto_1hash_1sha256_1init) (JNIEnv *jenv, jclass jcls,
         jobject dst) {
+    STODIUM_STATS_CALL(STODIUM_STATS_HASH);
     stodium_buffer dst_buffer;
-    stodium_get_buffer(jenv, &dst_buffer, dst);
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer);
     jint result = (jint) crypto_hash_sha256_init(
             AS_OUTPUT(crypto_hash_sha256_state, dst_buffer));
-
-    stodium_release_output(jenv, dst, &dst_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -1995,17 +4382,17 @@ STODIUM_JNI(jint, crypto_1hash_1sha256_1init) (JNIEnv *jenv, jclass jcls,
 STODIUM_JNI(jint, crypto_1hash_1sha256_1update) (JNIEnv *jenv, jclass jcls,
         jobject dst,
         jobject src) {
+    STODIUM_STATS_CALL(STODIUM_STATS_HASH);
     stodium_buffer dst_buffer, src_buffer;
-    stodium_get_buffer(jenv, &dst_buffer, dst);
-    stodium_get_buffer(jenv, &src_buffer, src);
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &src_buffer);
     jint result = (jint) crypto_hash_sha256_update(
             AS_OUTPUT(crypto_hash_sha256_state, dst_buffer),
             AS_INPUT(unsigned char, src_buffer),
             AS_INPUT_LEN(unsigned long long, src_buffer));
-
-    stodium_release_output(jenv, dst, &dst_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -2013,16 +4400,16 @@ STODIUM_JNI(jint, crypto_1hash_1sha256_1update) (JNIEnv *jenv, jclass jcls,
 STODIUM_JNI(jint, crypto_1hash_1sha256_1final) (JNIEnv *jenv, jclass jcls,
         jobject state,
         jobject dst) {
+    STODIUM_STATS_CALL(STODIUM_STATS_HASH);
     stodium_buffer state_buffer, dst_buffer;
-    stodium_get_buffer(jenv, &state_buffer, state);
-    stodium_get_buffer(jenv, &dst_buffer, dst);
+    stodium_get_critical_output(jenv, &state_buffer, state);
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &state_buffer, &dst_buffer);
     jint result = (jint) crypto_hash_sha256_final(
             AS_OUTPUT(crypto_hash_sha256_state, state_buffer),
             AS_OUTPUT(unsigned char, dst_buffer));
-
-    stodium_release_output(jenv, state, &state_buffer);
-    stodium_release_output(jenv, dst, &dst_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -2033,36 +4420,35 @@ STODIUM_JNI(jint, crypto_1hash_1sha256_1final) (JNIEnv *jenv, jclass jcls,
  *
  **************************************************************************** */
 
-STODIUM_CONSTANT(hash, sha512, bytes)
-STODIUM_CONSTANT(hash, sha512, statebytes)
 
 STODIUM_JNI(jint, crypto_1hash_1sha512) (JNIEnv *jenv, jclass jcls,
         jobject mac,
         jobject src) {
+    STODIUM_STATS_CALL(STODIUM_STATS_HASH);
     stodium_buffer mac_buffer, src_buffer;
-    stodium_get_buffer(jenv, &mac_buffer, mac);
-    stodium_get_buffer(jenv, &src_buffer, src);
+    stodium_get_critical_output(jenv, &mac_buffer, mac);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &mac_buffer, &src_buffer);
     jint result = (jint) crypto_hash_sha512(
             AS_OUTPUT(unsigned char, mac_buffer),
             AS_INPUT(unsigned char, src_buffer),
             AS_INPUT_LEN(unsigned long long, src_buffer));
-
-    stodium_release_output(jenv, mac, &mac_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
 
 STODIUM_JNI(jint, crypto_1hash_1sha512_1init) (JNIEnv *jenv, jclass jcls,
         jobject dst) {
+    STODIUM_STATS_CALL(STODIUM_STATS_HASH);
     stodium_buffer dst_buffer;
-    stodium_get_buffer(jenv, &dst_buffer, dst);
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer);
     jint result = (jint) crypto_hash_sha512_init(
             AS_OUTPUT(crypto_hash_sha512_state, dst_buffer));
-
-    stodium_release_output(jenv, dst, &dst_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -2070,17 +4456,17 @@ STODIUM_JNI(jint, crypto_1hash_1sha512_1init) (JNIEnv *jenv, jclass jcls,
 STODIUM_JNI(jint, crypto_1hash_1sha512_1update) (JNIEnv *jenv, jclass jcls,
         jobject dst,
         jobject src) {
+    STODIUM_STATS_CALL(STODIUM_STATS_HASH);
     stodium_buffer dst_buffer, src_buffer;
-    stodium_get_buffer(jenv, &dst_buffer, dst);
-    stodium_get_buffer(jenv, &src_buffer, src);
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &src_buffer);
     jint result = (jint) crypto_hash_sha512_update(
             AS_OUTPUT(crypto_hash_sha512_state, dst_buffer),
             AS_INPUT(unsigned char, src_buffer),
             AS_INPUT_LEN(unsigned long long, src_buffer));
-
-    stodium_release_output(jenv, dst, &dst_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -2088,16 +4474,16 @@ STODIUM_JNI(jint, crypto_1hash_1sha512_1update) (JNIEnv *jenv, jclass jcls,
 STODIUM_JNI(jint, crypto_1hash_1sha512_1final) (JNIEnv *jenv, jclass jcls,
         jobject state,
         jobject dst) {
+    STODIUM_STATS_CALL(STODIUM_STATS_HASH);
     stodium_buffer state_buffer, dst_buffer;
-    stodium_get_buffer(jenv, &state_buffer, state);
-    stodium_get_buffer(jenv, &dst_buffer, dst);
+    stodium_get_critical_output(jenv, &state_buffer, state);
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &state_buffer, &dst_buffer);
     jint result = (jint) crypto_hash_sha512_final(
             AS_OUTPUT(crypto_hash_sha512_state, state_buffer),
             AS_OUTPUT(unsigned char, dst_buffer));
-
-    stodium_release_output(jenv, state, &state_buffer);
-    stodium_release_output(jenv, dst, &dst_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -2116,35 +4502,194 @@ STODIUM_CONSTANT_STR(kdf)
  *
  **************************************************************************** */
 
-STODIUM_CONSTANT(kdf, blake2b, contextbytes)
-STODIUM_CONSTANT(kdf, blake2b, keybytes)
-STODIUM_JNI(jint, crypto_1kdf_1blake2b_1bytes_1min) (JNIEnv *jenv, jclass jcls) {
-    return (jint) crypto_kdf_blake2b_bytes_min();
-}
-STODIUM_JNI(jint, crypto_1kdf_1blake2b_1bytes_1max) (JNIEnv *jenv, jclass jcls) {
-    return (jint) crypto_kdf_blake2b_bytes_max();
-}
 
 STODIUM_JNI(jint, crypto_1kdf_1blake2b_1derive_1from_1key) (JNIEnv *jenv, jclass jcls,
         jobject sub,
         jlong   subid,
         jobject ctx,
         jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_KDF);
     stodium_buffer sub_buffer, ctx_buffer, key_buffer;
-    stodium_get_buffer(jenv, &sub_buffer, sub);
-    stodium_get_buffer(jenv, &ctx_buffer, ctx);
-    stodium_get_buffer(jenv, &key_buffer, key);
+    stodium_get_critical_output(jenv, &sub_buffer, sub);
+    stodium_get_critical_input(jenv,  &ctx_buffer, ctx);
+    stodium_get_critical_input(jenv,  &key_buffer, key);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &sub_buffer, &ctx_buffer, &key_buffer);
     jint result = (jint) crypto_kdf_blake2b_derive_from_key(
             AS_OUTPUT(unsigned char, sub_buffer),
             AS_INPUT_LEN(size_t, sub_buffer),
             (uint64_t) subid,
             AS_INPUT(char, ctx_buffer),
             AS_INPUT(unsigned char, key_buffer));
+    STODIUM_CRITICAL_END(jenv);
+
+    return result;
+}
+
+/**
+ * STODIUM_KDF_GRAIN is the least number of subkeys a worker derives. A
+ * subkey costs a single Blake2b compression, well under a microsecond.
+ */
+#define STODIUM_KDF_GRAIN 1024
+
+/**
+ * stodium_kdf_prepared is the prepared context of crypto_kdf_blake2b: the
+ * master key, and the context zero-padded to the Blake2b personalisation it
+ * is used as. Only the salt, which holds the subkey id, changes from one
+ * subkey to the next.
+ */
+typedef struct stodium_kdf_prepared {
+    unsigned char key[crypto_kdf_blake2b_KEYBYTES];
+    unsigned char personal[crypto_generichash_blake2b_PERSONALBYTES];
+} stodium_kdf_prepared;
+
+/**
+ * stodium_kdf_range describes a run of count subkeys of len bytes, with the
+ * ids first to first + count - 1, written back to back to dst.
+ */
+typedef struct stodium_kdf_range {
+    unsigned char              *dst;
+    size_t                      len;
+    uint64_t                    first;
+    const stodium_kdf_prepared *prepared;
+} stodium_kdf_range;
+
+static void stodium_kdf_prepare(stodium_kdf_prepared *prepared,
+        const unsigned char *ctx,
+        const unsigned char *key) {
+    memcpy(prepared->key, key, crypto_kdf_blake2b_KEYBYTES);
+    memset(prepared->personal, 0, sizeof prepared->personal);
+    memcpy(prepared->personal, ctx, crypto_kdf_blake2b_CONTEXTBYTES);
+}
+
+/**
+ * stodium_kdf_range_task is the stodium_pool_task for a run of subkeys. It
+ * computes what crypto_kdf_blake2b_derive_from_key computes, from the
+ * prepared parameters.
+ */
+static void stodium_kdf_range_task(void *ctx, size_t begin, size_t end) {
+    const stodium_kdf_range *range = (const stodium_kdf_range *) ctx;
+    unsigned char salt[crypto_generichash_blake2b_SALTBYTES] = { 0 };
+    size_t i;
+
+    for (i = begin; i < end; i++) {
+        uint64_t id = range->first + (uint64_t) i;
+        size_t   b;
+        for (b = 0; b < 8; b++) {
+            salt[b] = (unsigned char) (id >> (8 * b));
+        }
+        crypto_generichash_blake2b_salt_personal(range->dst + i * range->len, range->len,
+                NULL, 0,
+                range->prepared->key, crypto_kdf_blake2b_KEYBYTES,
+                salt, range->prepared->personal);
+    }
+    sodium_memzero(salt, sizeof salt);
+}
+
+/**
+ * stodium_kdf_range_run derives count subkeys of len bytes into dst, which
+ * holds at least count * len bytes.
+ */
+static jint stodium_kdf_range_run(stodium_buffer *dst_buffer,
+        jint    len,
+        jlong   first,
+        jint    count,
+        const stodium_kdf_prepared *prepared) {
+    stodium_kdf_range range;
+
+    if (len < crypto_kdf_blake2b_BYTES_MIN || len > crypto_kdf_blake2b_BYTES_MAX
+            || count < 0 || dst_buffer->capacity / (size_t) len < (size_t) count) {
+        return -1;
+    }
+
+    range.dst      = AS_OUTPUT(unsigned char, (*dst_buffer));
+    range.len      = (size_t) len;
+    range.first    = (uint64_t) first;
+    range.prepared = prepared;
+
+    stodium_pool_run(stodium_kdf_range_task, &range, (size_t) count, STODIUM_KDF_GRAIN);
+    return 0;
+}
+
+STODIUM_JNI(jint, crypto_1kdf_1blake2b_1derive_1range) (JNIEnv *jenv, jclass jcls,
+        jobject dst,
+        jint    sublen,
+        jlong   first,
+        jint    count,
+        jobject ctx,
+        jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_KDF);
+    stodium_kdf_prepared prepared;
+    stodium_buffer dst_buffer, ctx_buffer, key_buffer;
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+    stodium_get_critical_input(jenv,  &ctx_buffer, ctx);
+    stodium_get_critical_input(jenv,  &key_buffer, key);
+
+    stodium_buffer *buffers[] = { &dst_buffer, &ctx_buffer, &key_buffer };
+    jint result = -1;
+    if (stodium_critical_begin(jenv, buffers, 3)) {
+        if (ctx_buffer.capacity >= crypto_kdf_blake2b_CONTEXTBYTES
+                && key_buffer.capacity >= crypto_kdf_blake2b_KEYBYTES) {
+            stodium_kdf_prepare(&prepared,
+                    AS_INPUT(unsigned char, ctx_buffer),
+                    AS_INPUT(unsigned char, key_buffer));
+            result = stodium_kdf_range_run(&dst_buffer, sublen, first, count, &prepared);
+            sodium_memzero(&prepared, sizeof prepared);
+        }
+        stodium_critical_end(jenv, buffers, 3);
+    }
+
+    return result;
+}
+
+STODIUM_JNI(jint, crypto_1kdf_1blake2b_1preparedbytes) (JNIEnv *jenv, jclass jcls) {
+    return (jint) sizeof(stodium_kdf_prepared);
+}
+
+STODIUM_JNI(jint, crypto_1kdf_1blake2b_1prepare) (JNIEnv *jenv, jclass jcls,
+        jobject prepared,
+        jobject ctx,
+        jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_KDF);
+    stodium_buffer prepared_buffer, ctx_buffer, key_buffer;
+    stodium_get_critical_output(jenv, &prepared_buffer, prepared);
+    stodium_get_critical_input(jenv,  &ctx_buffer, ctx);
+    stodium_get_critical_input(jenv,  &key_buffer, key);
+
+    if (prepared_buffer.capacity < sizeof(stodium_kdf_prepared)
+            || ctx_buffer.capacity < crypto_kdf_blake2b_CONTEXTBYTES
+            || key_buffer.capacity < crypto_kdf_blake2b_KEYBYTES) {
+        return -1;
+    }
+
+    STODIUM_CRITICAL_BEGIN(jenv, &prepared_buffer, &ctx_buffer, &key_buffer);
+    stodium_kdf_prepare(AS_OUTPUT(stodium_kdf_prepared, prepared_buffer),
+            AS_INPUT(unsigned char, ctx_buffer),
+            AS_INPUT(unsigned char, key_buffer));
+    STODIUM_CRITICAL_END(jenv);
+
+    return 0;
+}
+
+STODIUM_JNI(jint, crypto_1kdf_1blake2b_1derive_1prepared) (JNIEnv *jenv, jclass jcls,
+        jobject dst,
+        jint    sublen,
+        jlong   first,
+        jint    count,
+        jobject prepared) {
+    STODIUM_STATS_CALL(STODIUM_STATS_KDF);
+    stodium_buffer dst_buffer, prepared_buffer;
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+    stodium_get_critical_input(jenv,  &prepared_buffer, prepared);
+
+    if (prepared_buffer.capacity < sizeof(stodium_kdf_prepared)) {
+        return -1;
+    }
 
-    stodium_release_output(jenv, sub, &sub_buffer);
-    stodium_release_input(jenv, ctx, &ctx_buffer);
-    stodium_release_input(jenv, key, &key_buffer);
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &prepared_buffer);
+    jint result = stodium_kdf_range_run(&dst_buffer, sublen, first, count,
+            AS_INPUT(stodium_kdf_prepared, prepared_buffer));
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -2156,14 +4701,11 @@ STODIUM_JNI(jint, crypto_1kdf_1blake2b_1derive_1from_1key) (JNIEnv *jenv, jclass
  **************************************************************************** */
 
 STODIUM_CONSTANT_STR(kx)
-STODIUM_CONSTANT_HL(kx, publickeybytes)
-STODIUM_CONSTANT_HL(kx, secretkeybytes)
-STODIUM_CONSTANT_HL(kx, seedbytes)
-STODIUM_CONSTANT_HL(kx, sessionkeybytes)
 
 STODIUM_JNI(jint, crypto_1kx_1keypair) (JNIEnv *jenv, jclass jcls,
         jobject pub,
         jobject priv) {
+    STODIUM_STATS_CALL(STODIUM_STATS_KX);
     stodium_buffer pub_buffer, priv_buffer;
     stodium_get_buffer(jenv, &pub_buffer, pub);
     stodium_get_buffer(jenv, &priv_buffer, priv);
@@ -2182,19 +4724,18 @@ STODIUM_JNI(jint, crypto_1kx_1seed_1keypair) (JNIEnv *jenv, jclass jcls,
         jobject pub,
         jobject priv,
         jobject seed) {
+    STODIUM_STATS_CALL(STODIUM_STATS_KX);
     stodium_buffer pub_buffer, priv_buffer, seed_buffer;
-    stodium_get_buffer(jenv, &pub_buffer, pub);
-    stodium_get_buffer(jenv, &priv_buffer, priv);
-    stodium_get_buffer(jenv, &seed_buffer, seed);
+    stodium_get_critical_output(jenv, &pub_buffer, pub);
+    stodium_get_critical_output(jenv, &priv_buffer, priv);
+    stodium_get_critical_input(jenv,  &seed_buffer, seed);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &pub_buffer, &priv_buffer, &seed_buffer);
     jint result = (jint) crypto_kx_seed_keypair(
             AS_OUTPUT(unsigned char, pub_buffer),
             AS_OUTPUT(unsigned char, priv_buffer),
             AS_INPUT(unsigned char, seed_buffer));
-
-    stodium_release_output(jenv, pub, &pub_buffer);
-    stodium_release_output(jenv, priv, &priv_buffer);
-    stodium_release_input(jenv, seed, &seed_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -2205,25 +4746,22 @@ STODIUM_JNI(jint, crypto_1kx_1server_1session_1keys) (JNIEnv *jenv, jclass jcls,
             jobject spk,
             jobject ssk,
             jobject cpk) {
+    STODIUM_STATS_CALL(STODIUM_STATS_KX);
     stodium_buffer rx_buffer, tx_buffer, spk_buffer, ssk_buffer, cpk_buffer;
-    stodium_get_buffer(jenv, &rx_buffer, rx);
-    stodium_get_buffer(jenv, &tx_buffer, tx);
-    stodium_get_buffer(jenv, &spk_buffer, spk);
-    stodium_get_buffer(jenv, &ssk_buffer, ssk);
-    stodium_get_buffer(jenv, &cpk_buffer, cpk);
+    stodium_get_critical_output(jenv, &rx_buffer, rx);
+    stodium_get_critical_output(jenv, &tx_buffer, tx);
+    stodium_get_critical_input(jenv,  &spk_buffer, spk);
+    stodium_get_critical_input(jenv,  &ssk_buffer, ssk);
+    stodium_get_critical_input(jenv,  &cpk_buffer, cpk);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &rx_buffer, &tx_buffer, &spk_buffer, &ssk_buffer, &cpk_buffer);
     jint result = (jint) crypto_kx_server_session_keys(
             AS_OUTPUT(unsigned char, rx_buffer),
             AS_OUTPUT(unsigned char, tx_buffer),
             AS_INPUT(unsigned char, spk_buffer),
             AS_INPUT(unsigned char, ssk_buffer),
             AS_INPUT(unsigned char, cpk_buffer));
-
-    stodium_release_output(jenv, rx, &rx_buffer);
-    stodium_release_output(jenv, tx, &tx_buffer);
-    stodium_release_input(jenv, spk, &spk_buffer);
-    stodium_release_input(jenv, ssk, &ssk_buffer);
-    stodium_release_input(jenv, cpk, &cpk_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -2234,25 +4772,22 @@ STODIUM_JNI(jint, crypto_1kx_1client_1session_1keys) (JNIEnv *jenv, jclass jcls,
             jobject cpk,
             jobject csk,
             jobject spk) {
+    STODIUM_STATS_CALL(STODIUM_STATS_KX);
     stodium_buffer rx_buffer, tx_buffer, cpk_buffer, csk_buffer, spk_buffer;
-    stodium_get_buffer(jenv, &rx_buffer, rx);
-    stodium_get_buffer(jenv, &tx_buffer, tx);
-    stodium_get_buffer(jenv, &cpk_buffer, cpk);
-    stodium_get_buffer(jenv, &csk_buffer, csk);
-    stodium_get_buffer(jenv, &spk_buffer, spk);
+    stodium_get_critical_output(jenv, &rx_buffer, rx);
+    stodium_get_critical_output(jenv, &tx_buffer, tx);
+    stodium_get_critical_input(jenv,  &cpk_buffer, cpk);
+    stodium_get_critical_input(jenv,  &csk_buffer, csk);
+    stodium_get_critical_input(jenv,  &spk_buffer, spk);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &rx_buffer, &tx_buffer, &cpk_buffer, &csk_buffer, &spk_buffer);
     jint result = (jint) crypto_kx_client_session_keys(
             AS_OUTPUT(unsigned char, rx_buffer),
             AS_OUTPUT(unsigned char, tx_buffer),
             AS_INPUT(unsigned char, cpk_buffer),
             AS_INPUT(unsigned char, csk_buffer),
             AS_INPUT(unsigned char, spk_buffer));
-
-    stodium_release_output(jenv, rx, &rx_buffer);
-    stodium_release_output(jenv, tx, &tx_buffer);
-    stodium_release_input(jenv, cpk, &cpk_buffer);
-    stodium_release_input(jenv, csk, &csk_buffer);
-    stodium_release_input(jenv, spk, &spk_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -2271,28 +4806,24 @@ STODIUM_CONSTANT_STR(onetimeauth)
  *
  **************************************************************************** */
 
-STODIUM_CONSTANT(onetimeauth, poly1305, bytes)
-STODIUM_CONSTANT(onetimeauth, poly1305, keybytes)
-STODIUM_CONSTANT(onetimeauth, poly1305, statebytes)
 
 STODIUM_JNI(jint, crypto_1onetimeauth_1poly1305) (JNIEnv *jenv, jclass jcls,
         jobject mac,
         jobject src,
         jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_ONETIMEAUTH);
     stodium_buffer mac_buffer, src_buffer, key_buffer;
-    stodium_get_buffer(jenv, &mac_buffer, mac);
-    stodium_get_buffer(jenv, &src_buffer, src);
-    stodium_get_buffer(jenv, &key_buffer, key);
+    stodium_get_critical_output(jenv, &mac_buffer, mac);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
+    stodium_get_critical_input(jenv,  &key_buffer, key);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &mac_buffer, &src_buffer, &key_buffer);
     jint result = (jint) crypto_onetimeauth_poly1305(
             AS_OUTPUT(unsigned char, mac_buffer),
             AS_INPUT(unsigned char, src_buffer),
             AS_INPUT_LEN(unsigned long long, src_buffer),
             AS_INPUT(unsigned char, key_buffer));
-
-    stodium_release_output(jenv, mac, &mac_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
-    stodium_release_input(jenv, key, &key_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -2301,20 +4832,19 @@ STODIUM_JNI(jint, crypto_1onetimeauth_1poly1305_1verify) (JNIEnv *jenv, jclass j
         jobject mac,
         jobject src,
         jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_ONETIMEAUTH);
     stodium_buffer mac_buffer, src_buffer, key_buffer;
-    stodium_get_buffer(jenv, &mac_buffer, mac);
-    stodium_get_buffer(jenv, &src_buffer, src);
-    stodium_get_buffer(jenv, &key_buffer, key);
+    stodium_get_critical_input(jenv,  &mac_buffer, mac);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
+    stodium_get_critical_input(jenv,  &key_buffer, key);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &mac_buffer, &src_buffer, &key_buffer);
     jint result = (jint) crypto_onetimeauth_poly1305_verify(
             AS_OUTPUT(unsigned char, mac_buffer),
             AS_INPUT(unsigned char, src_buffer),
             AS_INPUT_LEN(unsigned long long, src_buffer),
             AS_INPUT(unsigned char, key_buffer));
-
-    stodium_release_input(jenv, mac, &mac_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
-    stodium_release_input(jenv, key, &key_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -2322,16 +4852,16 @@ STODIUM_JNI(jint, crypto_1onetimeauth_1poly1305_1verify) (JNIEnv *jenv, jclass j
 STODIUM_JNI(jint, crypto_1onetimeauth_1poly1305_1init) (JNIEnv *jenv, jclass jcls,
         jobject dst,
         jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_ONETIMEAUTH);
     stodium_buffer dst_buffer, key_buffer;
-    stodium_get_buffer(jenv, &dst_buffer, dst);
-    stodium_get_buffer(jenv, &key_buffer, key);
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+    stodium_get_critical_input(jenv,  &key_buffer, key);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &key_buffer);
     jint result = (jint) crypto_onetimeauth_poly1305_init(
             AS_OUTPUT(crypto_onetimeauth_poly1305_state, dst_buffer),
             AS_INPUT(unsigned char, key_buffer));
-
-    stodium_release_output(jenv, dst, &dst_buffer);
-    stodium_release_input(jenv, key, &key_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -2339,17 +4869,17 @@ STODIUM_JNI(jint, crypto_1onetimeauth_1poly1305_1init) (JNIEnv *jenv, jclass jcl
 STODIUM_JNI(jint, crypto_1onetimeauth_1poly1305_1update) (JNIEnv *jenv, jclass jcls,
         jobject dst,
         jobject src) {
+    STODIUM_STATS_CALL(STODIUM_STATS_ONETIMEAUTH);
     stodium_buffer dst_buffer, src_buffer;
-    stodium_get_buffer(jenv, &dst_buffer, dst);
-    stodium_get_buffer(jenv, &src_buffer, src);
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &src_buffer);
     jint result = (jint) crypto_onetimeauth_poly1305_update(
             AS_OUTPUT(crypto_onetimeauth_poly1305_state, dst_buffer),
             AS_INPUT(unsigned char, src_buffer),
             AS_INPUT_LEN(unsigned long long, src_buffer));
-
-    stodium_release_output(jenv, dst, &dst_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -2357,16 +4887,16 @@ STODIUM_JNI(jint, crypto_1onetimeauth_1poly1305_1update) (JNIEnv *jenv, jclass j
 STODIUM_JNI(jint, crypto_1onetimeauth_1poly1305_1final) (JNIEnv *jenv, jclass jcls,
         jobject state,
         jobject dst) {
+    STODIUM_STATS_CALL(STODIUM_STATS_ONETIMEAUTH);
     stodium_buffer state_buffer, dst_buffer;
-    stodium_get_buffer(jenv, &state_buffer, state);
-    stodium_get_buffer(jenv, &dst_buffer, dst);
+    stodium_get_critical_output(jenv, &state_buffer, state);
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &state_buffer, &dst_buffer);
     jint result = (jint) crypto_onetimeauth_poly1305_final(
             AS_OUTPUT(crypto_onetimeauth_poly1305_state, state_buffer),
             AS_OUTPUT(unsigned char, dst_buffer));
-
-    stodium_release_output(jenv, state, &state_buffer);
-    stodium_release_output(jenv, dst, &dst_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -2385,47 +4915,9 @@ STODIUM_CONSTANT_STR(pwhash)
  *
  **************************************************************************** */
 
-STODIUM_JNI(jlong, crypto_1pwhash_1argon2i_1bytes_1min) (JNIEnv *jenv, jclass jcls) {
-       return (jlong) crypto_pwhash_argon2i_bytes_min();
-}
-STODIUM_JNI(jlong, crypto_1pwhash_1argon2i_1bytes_1max) (JNIEnv *jenv, jclass jcls) {
-       return (jlong) crypto_pwhash_argon2i_bytes_max();
-}
-STODIUM_JNI(jlong, crypto_1pwhash_1argon2i_1passwd_1min) (JNIEnv *jenv, jclass jcls) {
-       return (jlong) crypto_pwhash_argon2i_passwd_min();
-}
-STODIUM_JNI(jlong, crypto_1pwhash_1argon2i_1passwd_1max) (JNIEnv *jenv, jclass jcls) {
-       return (jlong) crypto_pwhash_argon2i_passwd_max();
-}
-STODIUM_CONSTANT(pwhash, argon2i, saltbytes)
-STODIUM_CONSTANT(pwhash, argon2i, strbytes)
 STODIUM_JNI(jstring, crypto_1pwhash_1argon2i_1strprefix) (JNIEnv *jenv, jclass jcls) {
         return (*jenv)->NewStringUTF(jenv, crypto_pwhash_argon2i_strprefix());
 }
-STODIUM_JNI(jlong, crypto_1pwhash_1argon2i_1opslimit_1min) (JNIEnv *jenv, jclass jcls) {
-       return (jlong) crypto_pwhash_argon2i_opslimit_min();
-}
-STODIUM_JNI(jlong, crypto_1pwhash_1argon2i_1opslimit_1max) (JNIEnv *jenv, jclass jcls) {
-       return (jlong) crypto_pwhash_argon2i_opslimit_max();
-}
-STODIUM_JNI(jint, crypto_1pwhash_1argon2i_1memlimit_1min) (JNIEnv *jenv, jclass jcls) {
-       return (jlong) crypto_pwhash_argon2i_memlimit_min();
-}
-STODIUM_JNI(jlong, crypto_1pwhash_1argon2i_1memlimit_1max) (JNIEnv *jenv, jclass jcls) {
-       return (jlong) crypto_pwhash_argon2i_memlimit_max();
-}
-STODIUM_JNI(jlong, crypto_1pwhash_1argon2i_1opslimit_1interactive) (JNIEnv *jenv, jclass jcls) {
-       return (jlong) crypto_pwhash_argon2i_opslimit_interactive();
-}
-STODIUM_JNI(jlong, crypto_1pwhash_1argon2i_1memlimit_1interactive) (JNIEnv *jenv, jclass jcls) {
-       return (jlong) crypto_pwhash_argon2i_memlimit_interactive();
-}
-STODIUM_JNI(jlong, crypto_1pwhash_1argon2i_1opslimit_1sensitive) (JNIEnv *jenv, jclass jcls) {
-       return (jlong) crypto_pwhash_argon2i_opslimit_sensitive();
-}
-STODIUM_JNI(jlong, crypto_1pwhash_1argon2i_1memlimit_1sensitive) (JNIEnv *jenv, jclass jcls) {
-       return (jlong) crypto_pwhash_argon2i_memlimit_sensitive();
-}
 
 STODIUM_JNI(jint, crypto_1pwhash_1argon2i) (JNIEnv *jenv, jclass jcls,
         jobject dst,
@@ -2433,6 +4925,7 @@ STODIUM_JNI(jint, crypto_1pwhash_1argon2i) (JNIEnv *jenv, jclass jcls,
         jobject salt,
         jlong opslimit,
         jlong memlimit) {
+    STODIUM_STATS_CALL(STODIUM_STATS_PWHASH);
     stodium_buffer dst_buffer, pw_buffer, salt_buffer;
     stodium_get_buffer(jenv, &dst_buffer, dst);
     stodium_get_buffer(jenv, &pw_buffer, password);
@@ -2446,7 +4939,7 @@ STODIUM_JNI(jint, crypto_1pwhash_1argon2i) (JNIEnv *jenv, jclass jcls,
             AS_INPUT(unsigned char, salt_buffer),
             (unsigned long long) opslimit,
             (size_t) memlimit,
-            crypto_pwhash_ALG_DEFAULT);
+            crypto_pwhash_argon2i_ALG_ARGON2I13);
 
     stodium_release_output(jenv, dst, &dst_buffer);
     stodium_release_input(jenv, password, &pw_buffer);
@@ -2460,6 +4953,7 @@ STODIUM_JNI(jint, crypto_1pwhash_1argon2i_1str) (JNIEnv *jenv, jclass jcls,
         jobject password,
         jlong opslimit,
         jlong memlimit) {
+    STODIUM_STATS_CALL(STODIUM_STATS_PWHASH);
     stodium_buffer dst_buffer, pw_buffer;
     stodium_get_buffer(jenv, &dst_buffer, dst);
     stodium_get_buffer(jenv, &pw_buffer, password);
@@ -2480,6 +4974,7 @@ STODIUM_JNI(jint, crypto_1pwhash_1argon2i_1str) (JNIEnv *jenv, jclass jcls,
 STODIUM_JNI(jint, crypto_1pwhash_1argon2i_1str_1verify) (JNIEnv *jenv, jclass jcls,
         jobject dst,
         jobject password) {
+    STODIUM_STATS_CALL(STODIUM_STATS_PWHASH);
     stodium_buffer dst_buffer, pw_buffer;
     stodium_get_buffer(jenv, &dst_buffer, dst);
     stodium_get_buffer(jenv, &pw_buffer, password);
@@ -2498,51 +4993,95 @@ STODIUM_JNI(jint, crypto_1pwhash_1argon2i_1str_1verify) (JNIEnv *jenv, jclass jc
 
 /** ****************************************************************************
  *
- * PWHASH - Scrypt
+ * PWHASH - Argon2id
  *
  **************************************************************************** */
 
-STODIUM_JNI(jlong, crypto_1pwhash_1scryptsalsa208sha256_1bytes_1min) (JNIEnv *jenv, jclass jcls) {
-       return (jlong) crypto_pwhash_scryptsalsa208sha256_bytes_min();
+STODIUM_JNI(jstring, crypto_1pwhash_1argon2id_1strprefix) (JNIEnv *jenv, jclass jcls) {
+        return (*jenv)->NewStringUTF(jenv, crypto_pwhash_argon2id_strprefix());
 }
-STODIUM_JNI(jlong, crypto_1pwhash_1scryptsalsa208sha256_1bytes_1max) (JNIEnv *jenv, jclass jcls) {
-       return (jlong) crypto_pwhash_scryptsalsa208sha256_bytes_max();
+
+STODIUM_JNI(jint, crypto_1pwhash_1argon2id) (JNIEnv *jenv, jclass jcls,
+        jobject dst,
+        jobject password,
+        jobject salt,
+        jlong opslimit,
+        jlong memlimit) {
+    STODIUM_STATS_CALL(STODIUM_STATS_PWHASH);
+    stodium_buffer dst_buffer, pw_buffer, salt_buffer;
+    stodium_get_buffer(jenv, &dst_buffer, dst);
+    stodium_get_buffer(jenv, &pw_buffer, password);
+    stodium_get_buffer(jenv, &salt_buffer, salt);
+
+    jint result = (jint) crypto_pwhash_argon2id(
+            AS_OUTPUT(unsigned char, dst_buffer),
+            AS_INPUT_LEN(unsigned long long, dst_buffer),
+            AS_INPUT(char, pw_buffer),
+            AS_INPUT_LEN(unsigned long long, pw_buffer),
+            AS_INPUT(unsigned char, salt_buffer),
+            (unsigned long long) opslimit,
+            (size_t) memlimit,
+            crypto_pwhash_argon2id_ALG_ARGON2ID13);
+
+    stodium_release_output(jenv, dst, &dst_buffer);
+    stodium_release_input(jenv, password, &pw_buffer);
+    stodium_release_input(jenv, salt, &salt_buffer);
+
+    return result;
 }
-STODIUM_JNI(jlong, crypto_1pwhash_1scryptsalsa208sha256_1passwd_1min) (JNIEnv *jenv, jclass jcls) {
-       return (jlong) crypto_pwhash_scryptsalsa208sha256_passwd_min();
+
+STODIUM_JNI(jint, crypto_1pwhash_1argon2id_1str) (JNIEnv *jenv, jclass jcls,
+        jobject dst,
+        jobject password,
+        jlong opslimit,
+        jlong memlimit) {
+    STODIUM_STATS_CALL(STODIUM_STATS_PWHASH);
+    stodium_buffer dst_buffer, pw_buffer;
+    stodium_get_buffer(jenv, &dst_buffer, dst);
+    stodium_get_buffer(jenv, &pw_buffer, password);
+
+    jint result = (jint) crypto_pwhash_argon2id_str(
+            AS_OUTPUT(char, dst_buffer),
+            AS_INPUT(char, pw_buffer),
+            AS_INPUT_LEN(unsigned long long, pw_buffer),
+            (unsigned long long) opslimit,
+            (size_t) memlimit);
+
+    stodium_release_output(jenv, dst, &dst_buffer);
+    stodium_release_input(jenv, password, &pw_buffer);
+
+    return result;
 }
-STODIUM_JNI(jlong, crypto_1pwhash_1scryptsalsa208sha256_1passwd_1max) (JNIEnv *jenv, jclass jcls) {
-       return (jlong) crypto_pwhash_scryptsalsa208sha256_passwd_max();
+
+STODIUM_JNI(jint, crypto_1pwhash_1argon2id_1str_1verify) (JNIEnv *jenv, jclass jcls,
+        jobject dst,
+        jobject password) {
+    STODIUM_STATS_CALL(STODIUM_STATS_PWHASH);
+    stodium_buffer dst_buffer, pw_buffer;
+    stodium_get_buffer(jenv, &dst_buffer, dst);
+    stodium_get_buffer(jenv, &pw_buffer, password);
+
+    jint result = (jint) crypto_pwhash_argon2id_str_verify(
+            AS_OUTPUT(char, dst_buffer),
+            AS_INPUT(char, pw_buffer),
+            AS_INPUT_LEN(unsigned long long, pw_buffer));
+
+    stodium_release_input(jenv, dst, &dst_buffer);
+    stodium_release_input(jenv, password, &pw_buffer);
+
+    return result;
 }
-STODIUM_CONSTANT(pwhash, scryptsalsa208sha256, saltbytes)
-STODIUM_CONSTANT(pwhash, scryptsalsa208sha256, strbytes)
+
+
+/** ****************************************************************************
+ *
+ * PWHASH - Scrypt
+ *
+ **************************************************************************** */
+
 STODIUM_JNI(jstring, crypto_1pwhash_1scryptsalsa208sha256_1strprefix) (JNIEnv *jenv, jclass jcls) {
         return (*jenv)->NewStringUTF(jenv, crypto_pwhash_scryptsalsa208sha256_strprefix());
 }
-STODIUM_JNI(jlong, crypto_1pwhash_1scryptsalsa208sha256_1opslimit_1min) (JNIEnv *jenv, jclass jcls) {
-       return (jlong) crypto_pwhash_scryptsalsa208sha256_opslimit_min();
-}
-STODIUM_JNI(jlong, crypto_1pwhash_1scryptsalsa208sha256_1opslimit_1max) (JNIEnv *jenv, jclass jcls) {
-       return (jlong) crypto_pwhash_scryptsalsa208sha256_opslimit_max();
-}
-STODIUM_JNI(jlong, crypto_1pwhash_1scryptsalsa208sha256_1memlimit_1min) (JNIEnv *jenv, jclass jcls) {
-       return (jlong) crypto_pwhash_scryptsalsa208sha256_memlimit_min();
-}
-STODIUM_JNI(jlong, crypto_1pwhash_1scryptsalsa208sha256_1memlimit_1max) (JNIEnv *jenv, jclass jcls) {
-       return (jlong) crypto_pwhash_scryptsalsa208sha256_memlimit_max();
-}
-STODIUM_JNI(jlong, crypto_1pwhash_1scryptsalsa208sha256_1opslimit_1interactive) (JNIEnv *jenv, jclass jcls) {
-       return (jlong) crypto_pwhash_scryptsalsa208sha256_opslimit_interactive();
-}
-STODIUM_JNI(jlong, crypto_1pwhash_1scryptsalsa208sha256_1memlimit_1interactive) (JNIEnv *jenv, jclass jcls) {
-       return (jlong) crypto_pwhash_scryptsalsa208sha256_memlimit_interactive();
-}
-STODIUM_JNI(jlong, crypto_1pwhash_1scryptsalsa208sha256_1opslimit_1sensitive) (JNIEnv *jenv, jclass jcls) {
-       return (jlong) crypto_pwhash_scryptsalsa208sha256_opslimit_sensitive();
-}
-STODIUM_JNI(jlong, crypto_1pwhash_1scryptsalsa208sha256_1memlimit_1sensitive) (JNIEnv *jenv, jclass jcls) {
-       return (jlong) crypto_pwhash_scryptsalsa208sha256_memlimit_sensitive();
-}
 
 STODIUM_JNI(jint, crypto_1pwhash_1scryptsalsa208sha256) (JNIEnv *jenv, jclass jcls,
         jobject dst,
@@ -2550,6 +5089,7 @@ STODIUM_JNI(jint, crypto_1pwhash_1scryptsalsa208sha256) (JNIEnv *jenv, jclass jc
         jobject salt,
         jlong opslimit,
         jlong memlimit) {
+    STODIUM_STATS_CALL(STODIUM_STATS_PWHASH);
     stodium_buffer dst_buffer, pw_buffer, salt_buffer;
     stodium_get_buffer(jenv, &dst_buffer, dst);
     stodium_get_buffer(jenv, &pw_buffer, password);
@@ -2576,6 +5116,7 @@ STODIUM_JNI(jint, crypto_1pwhash_1scryptsalsa208sha256_1str) (JNIEnv *jenv, jcla
         jobject password,
         jlong opslimit,
         jlong memlimit) {
+    STODIUM_STATS_CALL(STODIUM_STATS_PWHASH);
     stodium_buffer dst_buffer, pw_buffer;
     stodium_get_buffer(jenv, &dst_buffer, dst);
     stodium_get_buffer(jenv, &pw_buffer, password);
@@ -2596,6 +5137,7 @@ STODIUM_JNI(jint, crypto_1pwhash_1scryptsalsa208sha256_1str) (JNIEnv *jenv, jcla
 STODIUM_JNI(jint, crypto_1pwhash_1scryptsalsa208sha256_1str_1verify) (JNIEnv *jenv, jclass jcls,
         jobject dst,
         jobject password) {
+    STODIUM_STATS_CALL(STODIUM_STATS_PWHASH);
     stodium_buffer dst_buffer, pw_buffer;
     stodium_get_buffer(jenv, &dst_buffer, dst);
     stodium_get_buffer(jenv, &pw_buffer, password);
@@ -2618,26 +5160,23 @@ STODIUM_JNI(jint, crypto_1pwhash_1scryptsalsa208sha256_1str_1verify) (JNIEnv *je
  **************************************************************************** */
 STODIUM_CONSTANT_STR(scalarmult)
 
-STODIUM_CONSTANT(scalarmult, curve25519, bytes)
-STODIUM_CONSTANT(scalarmult, curve25519, scalarbytes)
 
 STODIUM_JNI(jint, crypto_1scalarmult_1curve25519) (JNIEnv *jenv, jclass jcls,
         jobject dst,
         jobject priv,
         jobject pub) {
+    STODIUM_STATS_CALL(STODIUM_STATS_SCALARMULT);
     stodium_buffer dst_buffer, priv_buffer, pub_buffer;
-    stodium_get_buffer(jenv, &dst_buffer,  dst);
-    stodium_get_buffer(jenv, &priv_buffer, priv);
-    stodium_get_buffer(jenv, &pub_buffer,  pub);
+    stodium_get_critical_output(jenv, &dst_buffer,  dst);
+    stodium_get_critical_input(jenv,  &priv_buffer, priv);
+    stodium_get_critical_input(jenv,  &pub_buffer,  pub);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &priv_buffer, &pub_buffer);
     jint result = (jint) crypto_scalarmult_curve25519(
             AS_OUTPUT(unsigned char, dst_buffer),
             AS_INPUT(unsigned char,  priv_buffer),
             AS_INPUT(unsigned char,  pub_buffer));
-
-    stodium_release_output(jenv, dst, &dst_buffer);
-    stodium_release_input(jenv, priv, &priv_buffer);
-    stodium_release_input(jenv, pub, &pub_buffer);
+    STODIUM_CRITICAL_END(jenv);
     
     return result;
 }
@@ -2645,16 +5184,16 @@ STODIUM_JNI(jint, crypto_1scalarmult_1curve25519) (JNIEnv *jenv, jclass jcls,
 STODIUM_JNI(jint, crypto_1scalarmult_1curve25519_1base) (JNIEnv *jenv, jclass jcls,
         jobject dst,
         jobject src) {
+    STODIUM_STATS_CALL(STODIUM_STATS_SCALARMULT);
     stodium_buffer dst_buffer, src_buffer;
-    stodium_get_buffer(jenv, &dst_buffer, dst);
-    stodium_get_buffer(jenv, &src_buffer, src);
-    
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
+
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &src_buffer);
     jint result = (jint) crypto_scalarmult_curve25519_base(
             AS_OUTPUT(unsigned char, dst_buffer),
             AS_INPUT(unsigned char, src_buffer));
-
-    stodium_release_output(jenv, dst, &dst_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
+    STODIUM_CRITICAL_END(jenv);
     
     return result;
 }
@@ -2673,32 +5212,27 @@ STODIUM_CONSTANT_STR(secretbox)
  *
  **************************************************************************** */
 
-STODIUM_CONSTANT(secretbox, xsalsa20poly1305, keybytes)
-STODIUM_CONSTANT(secretbox, xsalsa20poly1305, macbytes)
-STODIUM_CONSTANT(secretbox, xsalsa20poly1305, noncebytes)
 
 STODIUM_JNI(jint, crypto_1secretbox_1xsalsa20poly1305_1easy) (JNIEnv *jenv, jclass jcls,
         jobject dst,
         jobject src,
         jobject nonce,
         jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_SECRETBOX);
     stodium_buffer dst_buffer, src_buffer, nonce_buffer, key_buffer;
-    stodium_get_buffer(jenv, &dst_buffer, dst);
-    stodium_get_buffer(jenv, &src_buffer, src);
-    stodium_get_buffer(jenv, &nonce_buffer, nonce);
-    stodium_get_buffer(jenv, &key_buffer, key);
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
+    stodium_get_critical_input(jenv,  &nonce_buffer, nonce);
+    stodium_get_critical_input(jenv,  &key_buffer, key);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &src_buffer, &nonce_buffer, &key_buffer);
     jint result = (jint) crypto_secretbox_easy(
             AS_OUTPUT(unsigned char, dst_buffer),
             AS_INPUT(unsigned char, src_buffer),
             AS_INPUT_LEN(unsigned long long, src_buffer),
             AS_INPUT(unsigned char, nonce_buffer),
             AS_INPUT(unsigned char, key_buffer));
-
-    stodium_release_output(jenv, dst, &dst_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
-    stodium_release_input(jenv, nonce, &nonce_buffer);
-    stodium_release_input(jenv, key, &key_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -2708,40 +5242,40 @@ STODIUM_JNI(jint, crypto_1secretbox_1xsalsa20poly1305_1open_1easy) (JNIEnv *jenv
         jobject src,
         jobject nonce,
         jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_SECRETBOX);
     stodium_buffer dst_buffer, src_buffer, nonce_buffer, key_buffer;
-    stodium_get_buffer(jenv, &dst_buffer, dst);
-    stodium_get_buffer(jenv, &src_buffer, src);
-    stodium_get_buffer(jenv, &nonce_buffer, nonce);
-    stodium_get_buffer(jenv, &key_buffer, key);
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
+    stodium_get_critical_input(jenv,  &nonce_buffer, nonce);
+    stodium_get_critical_input(jenv,  &key_buffer, key);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &src_buffer, &nonce_buffer, &key_buffer);
     jint result = (jint) crypto_secretbox_open_easy(
             AS_OUTPUT(unsigned char, dst_buffer),
             AS_INPUT(unsigned char, src_buffer),
             AS_INPUT_LEN(unsigned long long, src_buffer),
             AS_INPUT(unsigned char, nonce_buffer),
             AS_INPUT(unsigned char, key_buffer));
-
-    stodium_release_output(jenv, dst, &dst_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
-    stodium_release_input(jenv, nonce, &nonce_buffer);
-    stodium_release_input(jenv, key, &key_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
 
-STODIUM_JNI(jint, crypto_1secretbox_xsalsa20poly1305_1detached) (JNIEnv *jenv, jclass jcls,
+STODIUM_JNI(jint, crypto_1secretbox_1xsalsa20poly1305_1detached) (JNIEnv *jenv, jclass jcls,
         jobject dst,
         jobject dst_mac,
         jobject src,
         jobject nonce,
         jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_SECRETBOX);
     stodium_buffer dst_buffer, mac_buffer, src_buffer, nonce_buffer, key_buffer;
-    stodium_get_buffer(jenv, &dst_buffer, dst);
-    stodium_get_buffer(jenv, &mac_buffer, dst_mac);
-    stodium_get_buffer(jenv, &src_buffer, src);
-    stodium_get_buffer(jenv, &nonce_buffer, nonce);
-    stodium_get_buffer(jenv, &key_buffer, key);
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+    stodium_get_critical_output(jenv, &mac_buffer, dst_mac);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
+    stodium_get_critical_input(jenv,  &nonce_buffer, nonce);
+    stodium_get_critical_input(jenv,  &key_buffer, key);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &mac_buffer, &src_buffer, &nonce_buffer, &key_buffer);
     jint result = (jint) crypto_secretbox_detached(
             AS_OUTPUT(unsigned char, dst_buffer),
             AS_OUTPUT(unsigned char, mac_buffer),
@@ -2749,12 +5283,7 @@ STODIUM_JNI(jint, crypto_1secretbox_xsalsa20poly1305_1detached) (JNIEnv *jenv, j
             AS_INPUT_LEN(unsigned long long, src_buffer),
             AS_INPUT(unsigned char, nonce_buffer),
             AS_INPUT(unsigned char, key_buffer));
-
-    stodium_release_output(jenv, dst, &dst_buffer);
-    stodium_release_output(jenv, dst_mac, &mac_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
-    stodium_release_input(jenv, nonce, &nonce_buffer);
-    stodium_release_input(jenv, key, &key_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -2765,13 +5294,15 @@ STODIUM_JNI(jint, crypto_1secretbox_1xsalsa20poly1305_1open_1detached) (JNIEnv *
         jobject src_mac,
         jobject nonce,
         jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_SECRETBOX);
     stodium_buffer dst_buffer, mac_buffer, src_buffer, nonce_buffer, key_buffer;
-    stodium_get_buffer(jenv, &dst_buffer, dst);
-    stodium_get_buffer(jenv, &mac_buffer, src_mac);
-    stodium_get_buffer(jenv, &src_buffer, src);
-    stodium_get_buffer(jenv, &nonce_buffer, nonce);
-    stodium_get_buffer(jenv, &key_buffer, key);
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+    stodium_get_critical_input(jenv,  &mac_buffer, src_mac);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
+    stodium_get_critical_input(jenv,  &nonce_buffer, nonce);
+    stodium_get_critical_input(jenv,  &key_buffer, key);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &mac_buffer, &src_buffer, &nonce_buffer, &key_buffer);
     jint result = (jint) crypto_secretbox_open_detached(
             AS_OUTPUT(unsigned char, dst_buffer),
             AS_INPUT(unsigned char, src_buffer),
@@ -2779,12 +5310,7 @@ STODIUM_JNI(jint, crypto_1secretbox_1xsalsa20poly1305_1open_1detached) (JNIEnv *
             AS_INPUT_LEN(unsigned long long, src_buffer),
             AS_INPUT(unsigned char, nonce_buffer),
             AS_INPUT(unsigned char, key_buffer));
-
-    stodium_release_output(jenv, dst, &dst_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
-    stodium_release_input(jenv, src_mac, &mac_buffer);
-    stodium_release_input(jenv, nonce, &nonce_buffer);
-    stodium_release_input(jenv, key, &key_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -2795,32 +5321,27 @@ STODIUM_JNI(jint, crypto_1secretbox_1xsalsa20poly1305_1open_1detached) (JNIEnv *
  *
  **************************************************************************** */
 
-STODIUM_CONSTANT(secretbox, xchacha20poly1305, keybytes)
-STODIUM_CONSTANT(secretbox, xchacha20poly1305, macbytes)
-STODIUM_CONSTANT(secretbox, xchacha20poly1305, noncebytes)
 
 STODIUM_JNI(jint, crypto_1secretbox_1xchacha20poly1305_1easy) (JNIEnv *jenv, jclass jcls,
         jobject dst,
         jobject src,
         jobject nonce,
         jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_SECRETBOX);
     stodium_buffer dst_buffer, src_buffer, nonce_buffer, key_buffer;
-    stodium_get_buffer(jenv, &dst_buffer, dst);
-    stodium_get_buffer(jenv, &src_buffer, src);
-    stodium_get_buffer(jenv, &nonce_buffer, nonce);
-    stodium_get_buffer(jenv, &key_buffer, key);
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
+    stodium_get_critical_input(jenv,  &nonce_buffer, nonce);
+    stodium_get_critical_input(jenv,  &key_buffer, key);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &src_buffer, &nonce_buffer, &key_buffer);
     jint result = (jint) crypto_secretbox_xchacha20poly1305_easy(
             AS_OUTPUT(unsigned char, dst_buffer),
             AS_INPUT(unsigned char, src_buffer),
             AS_INPUT_LEN(unsigned long long, src_buffer),
             AS_INPUT(unsigned char, nonce_buffer),
             AS_INPUT(unsigned char, key_buffer));
-
-    stodium_release_output(jenv, dst, &dst_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
-    stodium_release_input(jenv, nonce, &nonce_buffer);
-    stodium_release_input(jenv, key, &key_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -2830,40 +5351,40 @@ STODIUM_JNI(jint, crypto_1secretbox_1xchacha20poly1305_1open_1easy) (JNIEnv *jen
         jobject src,
         jobject nonce,
         jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_SECRETBOX);
     stodium_buffer dst_buffer, src_buffer, nonce_buffer, key_buffer;
-    stodium_get_buffer(jenv, &dst_buffer, dst);
-    stodium_get_buffer(jenv, &src_buffer, src);
-    stodium_get_buffer(jenv, &nonce_buffer, nonce);
-    stodium_get_buffer(jenv, &key_buffer, key);
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
+    stodium_get_critical_input(jenv,  &nonce_buffer, nonce);
+    stodium_get_critical_input(jenv,  &key_buffer, key);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &src_buffer, &nonce_buffer, &key_buffer);
     jint result = (jint) crypto_secretbox_xchacha20poly1305_open_easy(
             AS_OUTPUT(unsigned char, dst_buffer),
             AS_INPUT(unsigned char, src_buffer),
             AS_INPUT_LEN(unsigned long long, src_buffer),
             AS_INPUT(unsigned char, nonce_buffer),
             AS_INPUT(unsigned char, key_buffer));
-
-    stodium_release_output(jenv, dst, &dst_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
-    stodium_release_input(jenv, nonce, &nonce_buffer);
-    stodium_release_input(jenv, key, &key_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
 
-STODIUM_JNI(jint, crypto_1secretbox_xchacha20poly1305_1detached) (JNIEnv *jenv, jclass jcls,
+STODIUM_JNI(jint, crypto_1secretbox_1xchacha20poly1305_1detached) (JNIEnv *jenv, jclass jcls,
         jobject dst,
         jobject dst_mac,
         jobject src,
         jobject nonce,
         jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_SECRETBOX);
     stodium_buffer dst_buffer, mac_buffer, src_buffer, nonce_buffer, key_buffer;
-    stodium_get_buffer(jenv, &dst_buffer, dst);
-    stodium_get_buffer(jenv, &mac_buffer, dst_mac);
-    stodium_get_buffer(jenv, &src_buffer, src);
-    stodium_get_buffer(jenv, &nonce_buffer, nonce);
-    stodium_get_buffer(jenv, &key_buffer, key);
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+    stodium_get_critical_output(jenv, &mac_buffer, dst_mac);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
+    stodium_get_critical_input(jenv,  &nonce_buffer, nonce);
+    stodium_get_critical_input(jenv,  &key_buffer, key);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &mac_buffer, &src_buffer, &nonce_buffer, &key_buffer);
     jint result = (jint) crypto_secretbox_xchacha20poly1305_detached(
             AS_OUTPUT(unsigned char, dst_buffer),
             AS_OUTPUT(unsigned char, mac_buffer),
@@ -2871,12 +5392,7 @@ STODIUM_JNI(jint, crypto_1secretbox_xchacha20poly1305_1detached) (JNIEnv *jenv,
             AS_INPUT_LEN(unsigned long long, src_buffer),
             AS_INPUT(unsigned char, nonce_buffer),
             AS_INPUT(unsigned char, key_buffer));
-
-    stodium_release_output(jenv, dst, &dst_buffer);
-    stodium_release_output(jenv, dst_mac, &mac_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
-    stodium_release_input(jenv, nonce, &nonce_buffer);
-    stodium_release_input(jenv, key, &key_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -2887,13 +5403,15 @@ STODIUM_JNI(jint, crypto_1secretbox_1xchacha20poly1305_1open_1detached) (JNIEnv
         jobject src_mac,
         jobject nonce,
         jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_SECRETBOX);
     stodium_buffer dst_buffer, mac_buffer, src_buffer, nonce_buffer, key_buffer;
-    stodium_get_buffer(jenv, &dst_buffer, dst);
-    stodium_get_buffer(jenv, &mac_buffer, src_mac);
-    stodium_get_buffer(jenv, &src_buffer, src);
-    stodium_get_buffer(jenv, &nonce_buffer, nonce);
-    stodium_get_buffer(jenv, &key_buffer, key);
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+    stodium_get_critical_input(jenv,  &mac_buffer, src_mac);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
+    stodium_get_critical_input(jenv,  &nonce_buffer, nonce);
+    stodium_get_critical_input(jenv,  &key_buffer, key);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &mac_buffer, &src_buffer, &nonce_buffer, &key_buffer);
     jint result = (jint) crypto_secretbox_xchacha20poly1305_open_detached(
             AS_OUTPUT(unsigned char, dst_buffer),
             AS_INPUT(unsigned char, src_buffer),
@@ -2901,84 +5419,345 @@ STODIUM_JNI(jint, crypto_1secretbox_1xchacha20poly1305_1open_1detached) (JNIEnv
             AS_INPUT_LEN(unsigned long long, src_buffer),
             AS_INPUT(unsigned char, nonce_buffer),
             AS_INPUT(unsigned char, key_buffer));
-
-    stodium_release_output(jenv, dst, &dst_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
-    stodium_release_input(jenv, src_mac, &mac_buffer);
-    stodium_release_input(jenv, nonce, &nonce_buffer);
-    stodium_release_input(jenv, key, &key_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
 
 /** ****************************************************************************
  *
- * SHORTHASH
+ * SECRETBOX - Gather/scatter
  *
  **************************************************************************** */
 
-STODIUM_CONSTANT_STR(shorthash)
+/**
+ * STODIUM_SECRETBOX_GATHER defines the gather/scatter wrappers of a secretbox
+ * construction, in detached mode, on the stream engine of the AEAD
+ * gather/scatter section.
+ */
+#define STODIUM_SECRETBOX_GATHER(jname, primitive) \
+    STODIUM_JNI(jint, crypto_1secretbox_1##jname##_1detached_1gather) (JNIEnv *jenv, jclass jcls, \
+            jobjectArray dst, jobject mac, jobjectArray src, jobject nonce, jobject key) { \
+        return stodium_gather_call(jenv, STODIUM_STATS_SECRETBOX, \
+                crypto_secretbox_##primitive##_KEYBYTES, crypto_secretbox_##primitive##_NONCEBYTES, crypto_secretbox_##primitive##_MACBYTES, \
+                stodium_secretbox_##primitive##_gather_setup, NULL, true, dst, src, mac, NULL, nonce, key); } \
+    STODIUM_JNI(jint, crypto_1secretbox_1##jname##_1open_1detached_1gather) (JNIEnv *jenv, jclass jcls, \
+            jobjectArray dst, jobjectArray src, jobject mac, jobject nonce, jobject key) { \
+        return stodium_gather_call(jenv, STODIUM_STATS_SECRETBOX, \
+                crypto_secretbox_##primitive##_KEYBYTES, crypto_secretbox_##primitive##_NONCEBYTES, crypto_secretbox_##primitive##_MACBYTES, \
+                stodium_secretbox_##primitive##_gather_setup, NULL, false, dst, src, mac, NULL, nonce, key); }
+
+STODIUM_SECRETBOX_GATHER(xsalsa20poly1305, xsalsa20poly1305)
+STODIUM_SECRETBOX_GATHER(xchacha20poly1305, xchacha20poly1305)
 
 /** ****************************************************************************
  *
- * SHORTHASH - SipHash-2-4
+ * SECRETSTREAM - XChacha20Poly1305
  *
  **************************************************************************** */
-STODIUM_CONSTANT(shorthash, siphash24, bytes)
-STODIUM_CONSTANT(shorthash, siphash24, keybytes)
 
-STODIUM_JNI(jint, crypto_1shorthash_1siphash24) (JNIEnv *jenv, jclass jcls,
-        jobject dst,
-        jobject src,
-        jobject key) {
-    stodium_buffer dst_buffer, src_buffer, key_buffer;
-    stodium_get_buffer(jenv, &dst_buffer, dst);
-    stodium_get_buffer(jenv, &src_buffer, src);
-    stodium_get_buffer(jenv, &key_buffer, key);
 
-    jint result = (jint) crypto_shorthash_siphash24(
-            AS_OUTPUT(unsigned char, dst_buffer),
-            AS_INPUT(unsigned char, src_buffer),
-            AS_INPUT_LEN(unsigned long long, src_buffer),
+STODIUM_JNI(jint, crypto_1secretstream_1xchacha20poly1305_1init_1push) (JNIEnv *jenv, jclass jcls,
+        jobject state,
+        jobject header,
+        jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_SECRETSTREAM);
+    stodium_buffer state_buffer, header_buffer, key_buffer;
+    stodium_get_critical_output(jenv, &state_buffer,  state);
+    stodium_get_critical_output(jenv, &header_buffer, header);
+    stodium_get_critical_input(jenv,  &key_buffer,    key);
+
+    STODIUM_CRITICAL_BEGIN(jenv, &state_buffer, &header_buffer, &key_buffer);
+    jint result = (jint) crypto_secretstream_xchacha20poly1305_init_push(
+            AS_OUTPUT(crypto_secretstream_xchacha20poly1305_state, state_buffer),
+            AS_OUTPUT(unsigned char, header_buffer),
             AS_INPUT(unsigned char, key_buffer));
-
-    stodium_release_output(jenv, dst, &dst_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
-    stodium_release_input(jenv, key, &key_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
 
-/** ****************************************************************************
- *
- * SHORTHASH - SipHashx-2-4
- *
- **************************************************************************** */
-STODIUM_CONSTANT(shorthash, siphashx24, bytes)
-STODIUM_CONSTANT(shorthash, siphashx24, keybytes)
-
-STODIUM_JNI(jint, crypto_1shorthash_1siphashx24) (JNIEnv *jenv, jclass jcls,
+STODIUM_JNI(jint, crypto_1secretstream_1xchacha20poly1305_1push) (JNIEnv *jenv, jclass jcls,
+        jobject state,
         jobject dst,
         jobject src,
-        jobject key) {
-    stodium_buffer dst_buffer, src_buffer, key_buffer;
-    stodium_get_buffer(jenv, &dst_buffer, dst);
-    stodium_get_buffer(jenv, &src_buffer, src);
-    stodium_get_buffer(jenv, &key_buffer, key);
-
-    jint result = (jint) crypto_shorthash_siphashx24(
+        jobject ad,
+        jint    tag) {
+    STODIUM_STATS_CALL(STODIUM_STATS_SECRETSTREAM);
+    stodium_buffer state_buffer, dst_buffer, src_buffer, ad_buffer;
+    stodium_get_critical_output(jenv, &state_buffer, state);
+    stodium_get_critical_output(jenv, &dst_buffer,   dst);
+    stodium_get_critical_input(jenv,  &src_buffer,   src);
+    stodium_get_critical_input(jenv,  &ad_buffer,    ad);
+
+    STODIUM_CRITICAL_BEGIN(jenv, &state_buffer, &dst_buffer, &src_buffer, &ad_buffer);
+    jint result = (jint) crypto_secretstream_xchacha20poly1305_push(
+            AS_OUTPUT(crypto_secretstream_xchacha20poly1305_state, state_buffer),
             AS_OUTPUT(unsigned char, dst_buffer),
+            NULL,
             AS_INPUT(unsigned char, src_buffer),
             AS_INPUT_LEN(unsigned long long, src_buffer),
-            AS_INPUT(unsigned char, key_buffer));
+            AS_INPUT(unsigned char, ad_buffer),
+            AS_INPUT_LEN(unsigned long long, ad_buffer),
+            (unsigned char) tag);
+    STODIUM_CRITICAL_END(jenv);
 
-    stodium_release_output(jenv, dst, &dst_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
-    stodium_release_input(jenv, key, &key_buffer);
+    return result;
+}
+
+STODIUM_JNI(jint, crypto_1secretstream_1xchacha20poly1305_1init_1pull) (JNIEnv *jenv, jclass jcls,
+        jobject state,
+        jobject header,
+        jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_SECRETSTREAM);
+    stodium_buffer state_buffer, header_buffer, key_buffer;
+    stodium_get_critical_output(jenv, &state_buffer,  state);
+    stodium_get_critical_input(jenv,  &header_buffer, header);
+    stodium_get_critical_input(jenv,  &key_buffer,    key);
+
+    STODIUM_CRITICAL_BEGIN(jenv, &state_buffer, &header_buffer, &key_buffer);
+    jint result = (jint) crypto_secretstream_xchacha20poly1305_init_pull(
+            AS_OUTPUT(crypto_secretstream_xchacha20poly1305_state, state_buffer),
+            AS_INPUT(unsigned char, header_buffer),
+            AS_INPUT(unsigned char, key_buffer));
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
 
+/**
+ * Returns the tag of the message on success, or -1 if the message could not
+ * be verified.
+ */
+STODIUM_JNI(jint, crypto_1secretstream_1xchacha20poly1305_1pull) (JNIEnv *jenv, jclass jcls,
+        jobject state,
+        jobject dst,
+        jobject src,
+        jobject ad) {
+    STODIUM_STATS_CALL(STODIUM_STATS_SECRETSTREAM);
+    unsigned char tag = 0;
+    stodium_buffer state_buffer, dst_buffer, src_buffer, ad_buffer;
+    stodium_get_critical_output(jenv, &state_buffer, state);
+    stodium_get_critical_output(jenv, &dst_buffer,   dst);
+    stodium_get_critical_input(jenv,  &src_buffer,   src);
+    stodium_get_critical_input(jenv,  &ad_buffer,    ad);
+
+    STODIUM_CRITICAL_BEGIN(jenv, &state_buffer, &dst_buffer, &src_buffer, &ad_buffer);
+    jint result = (jint) crypto_secretstream_xchacha20poly1305_pull(
+            AS_OUTPUT(crypto_secretstream_xchacha20poly1305_state, state_buffer),
+            AS_OUTPUT(unsigned char, dst_buffer),
+            NULL,
+            &tag,
+            AS_INPUT(unsigned char, src_buffer),
+            AS_INPUT_LEN(unsigned long long, src_buffer),
+            AS_INPUT(unsigned char, ad_buffer),
+            AS_INPUT_LEN(unsigned long long, ad_buffer));
+    STODIUM_CRITICAL_END(jenv);
+
+    return result == 0 ? (jint) tag : -1;
+}
+
+STODIUM_JNI(void, crypto_1secretstream_1xchacha20poly1305_1rekey) (JNIEnv *jenv, jclass jcls,
+        jobject state) {
+    STODIUM_STATS_CALL(STODIUM_STATS_SECRETSTREAM);
+    stodium_buffer state_buffer;
+    stodium_get_critical_output(jenv, &state_buffer, state);
+
+    stodium_buffer *buffers[] = { &state_buffer };
+    if (stodium_critical_begin(jenv, buffers, 1)) {
+        crypto_secretstream_xchacha20poly1305_rekey(
+                AS_OUTPUT(crypto_secretstream_xchacha20poly1305_state, state_buffer));
+        stodium_critical_end(jenv, buffers, 1);
+    }
+}
+
+/** ****************************************************************************
+ *
+ * SHORTHASH
+ *
+ **************************************************************************** */
+
+STODIUM_CONSTANT_STR(shorthash)
+
+/** ****************************************************************************
+ *
+ * SHORTHASH - SipHash-2-4
+ *
+ **************************************************************************** */
+
+STODIUM_JNI(jint, crypto_1shorthash_1siphash24) (JNIEnv *jenv, jclass jcls,
+        jobject dst,
+        jobject src,
+        jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_SHORTHASH);
+    stodium_buffer dst_buffer, src_buffer, key_buffer;
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
+    stodium_get_critical_input(jenv,  &key_buffer, key);
+
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &src_buffer, &key_buffer);
+    jint result = (jint) crypto_shorthash_siphash24(
+            AS_OUTPUT(unsigned char, dst_buffer),
+            AS_INPUT(unsigned char, src_buffer),
+            AS_INPUT_LEN(unsigned long long, src_buffer),
+            AS_INPUT(unsigned char, key_buffer));
+    STODIUM_CRITICAL_END(jenv);
+
+    return result;
+}
+
+/** ****************************************************************************
+ *
+ * SHORTHASH - SipHashx-2-4
+ *
+ **************************************************************************** */
+
+STODIUM_JNI(jint, crypto_1shorthash_1siphashx24) (JNIEnv *jenv, jclass jcls,
+        jobject dst,
+        jobject src,
+        jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_SHORTHASH);
+    stodium_buffer dst_buffer, src_buffer, key_buffer;
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
+    stodium_get_critical_input(jenv,  &key_buffer, key);
+
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &src_buffer, &key_buffer);
+    jint result = (jint) crypto_shorthash_siphashx24(
+            AS_OUTPUT(unsigned char, dst_buffer),
+            AS_INPUT(unsigned char, src_buffer),
+            AS_INPUT_LEN(unsigned long long, src_buffer),
+            AS_INPUT(unsigned char, key_buffer));
+    STODIUM_CRITICAL_END(jenv);
+
+    return result;
+}
+
+/** ****************************************************************************
+ *
+ * SHORTHASH - Batch
+ *
+ **************************************************************************** */
+
+/**
+ * STODIUM_SHORTHASH_GRAIN is the least number of messages a worker hashes.
+ * A SipHash of a short key takes some tens of nanoseconds, so much larger
+ * slices than STODIUM_POOL_GRAIN are needed to pay for waking a worker.
+ */
+#define STODIUM_SHORTHASH_GRAIN 4096
+
+/**
+ * stodium_shorthash_batch describes a batch of messages hashed with the same
+ * SipHash key, as stodium_generichash_batch does for Blake2b; the hashes of
+ * words longs are written back to back to dst.
+ */
+typedef struct stodium_shorthash_batch {
+    uint64_t            *dst;
+    size_t               words;
+    const unsigned char *src;
+    const int32_t       *table;
+    const unsigned char *key;
+} stodium_shorthash_batch;
+
+/**
+ * stodium_shorthash_batch_task is the stodium_pool_task for a SipHash batch.
+ */
+static void stodium_shorthash_batch_task(void *ctx, size_t begin, size_t end) {
+    const stodium_shorthash_batch *batch = (const stodium_shorthash_batch *) ctx;
+
+    stodium_siphash_batch(batch->dst + begin * batch->words, batch->words,
+            batch->src, batch->table + 2 * begin, end - begin, batch->key);
+}
+
+/**
+ * stodium_shorthash_batch_run hashes the messages of table in src into the
+ * long array dst from dst_offset, with SipHash-2-4 (words 1) or SipHash-x-2-4
+ * (words 2). The buffers are checked as in crypto_generichash_blake2b_batch.
+ */
+static jint stodium_shorthash_batch_run(JNIEnv *jenv,
+        jlongArray dst,
+        jint       dst_offset,
+        jobject    src,
+        jintArray  table,
+        jobject    key,
+        size_t     words) {
+    stodium_shorthash_batch batch;
+    jint *table_elements;
+    jint result = -1;
+    size_t count, i;
+
+    count = (size_t) ((*jenv)->GetArrayLength(jenv, table) / 2);
+    if (dst_offset < 0
+            || (size_t) dst_offset > (size_t) (*jenv)->GetArrayLength(jenv, dst)
+            || ((size_t) (*jenv)->GetArrayLength(jenv, dst) - (size_t) dst_offset) / words < count) {
+        return -1;
+    }
+
+    table_elements = (*jenv)->GetIntArrayElements(jenv, table, NULL);
+    if (table_elements == NULL) {
+        return -1;
+    }
+
+    stodium_buffer src_buffer, key_buffer;
+    stodium_get_critical_input(jenv, &src_buffer, src);
+    stodium_get_critical_input(jenv, &key_buffer, key);
+
+    stodium_buffer *buffers[] = { &src_buffer, &key_buffer };
+    if (stodium_critical_begin(jenv, buffers, 2)) {
+        result = key_buffer.capacity >= crypto_shorthash_siphash24_KEYBYTES ? 0 : -1;
+        for (i = 0; result == 0 && i < count; i++) {
+            jint offset = table_elements[2 * i];
+            jint length = table_elements[2 * i + 1];
+            if (offset < 0 || length < 0
+                    || (size_t) offset > src_buffer.capacity
+                    || (size_t) length > src_buffer.capacity - (size_t) offset) {
+                result = -1;
+            }
+        }
+
+        jlong *dst_elements = result == 0
+                ? (jlong *) (*jenv)->GetPrimitiveArrayCritical(jenv, dst, NULL)
+                : NULL;
+        if (dst_elements != NULL) {
+            batch.dst   = (uint64_t *) (dst_elements + dst_offset);
+            batch.words = words;
+            batch.src   = AS_INPUT(unsigned char, src_buffer);
+            batch.table = (const int32_t *) table_elements;
+            batch.key   = AS_INPUT(unsigned char, key_buffer);
+
+            stodium_pool_run(stodium_shorthash_batch_task, &batch, count, STODIUM_SHORTHASH_GRAIN);
+            (*jenv)->ReleasePrimitiveArrayCritical(jenv, dst, dst_elements, 0);
+        } else {
+            result = -1;
+        }
+        stodium_critical_end(jenv, buffers, 2);
+    }
+
+    (*jenv)->ReleaseIntArrayElements(jenv, table, table_elements, JNI_ABORT);
+
+    return result;
+}
+
+STODIUM_JNI(jint, crypto_1shorthash_1siphash24_1batch) (JNIEnv *jenv, jclass jcls,
+        jlongArray dst,
+        jint       dst_offset,
+        jobject    src,
+        jintArray  table,
+        jobject    key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_SHORTHASH);
+    return stodium_shorthash_batch_run(jenv, dst, dst_offset, src, table, key, 1);
+}
+
+STODIUM_JNI(jint, crypto_1shorthash_1siphashx24_1batch) (JNIEnv *jenv, jclass jcls,
+        jlongArray dst,
+        jint       dst_offset,
+        jobject    src,
+        jintArray  table,
+        jobject    key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_SHORTHASH);
+    return stodium_shorthash_batch_run(jenv, dst, dst_offset, src, table, key, 2);
+}
+
 /** ****************************************************************************
  *
  * SIGN
@@ -2992,15 +5771,11 @@ STODIUM_CONSTANT_STR(sign)
  * SIGN - Ed25519/Ed25519ph
  *
  **************************************************************************** */
-STODIUM_CONSTANT(sign, ed25519, publickeybytes)
-STODIUM_CONSTANT(sign, ed25519, secretkeybytes)
-STODIUM_CONSTANT(sign, ed25519, bytes)
-STODIUM_CONSTANT(sign, ed25519, seedbytes)
-STODIUM_CONSTANT(sign, ed25519ph, statebytes)
 
 STODIUM_JNI(jint, crypto_1sign_1ed25519_1keypair) (JNIEnv *jenv, jclass jcls,
         jobject pub,
         jobject priv) {
+    STODIUM_STATS_CALL(STODIUM_STATS_SIGN);
     stodium_buffer pub_buffer, priv_buffer;
     stodium_get_buffer(jenv, &pub_buffer, pub);
     stodium_get_buffer(jenv, &priv_buffer, priv);
@@ -3019,19 +5794,18 @@ STODIUM_JNI(jint, crypto_1sign_1ed25519_1seed_1keypair) (JNIEnv *jenv, jclass jc
         jobject pub,
         jobject priv,
         jobject seed) {
+    STODIUM_STATS_CALL(STODIUM_STATS_SIGN);
     stodium_buffer pub_buffer, priv_buffer, seed_buffer;
-    stodium_get_buffer(jenv, &pub_buffer, pub);
-    stodium_get_buffer(jenv, &priv_buffer, priv);
-    stodium_get_buffer(jenv, &seed_buffer, seed);
+    stodium_get_critical_output(jenv, &pub_buffer, pub);
+    stodium_get_critical_output(jenv, &priv_buffer, priv);
+    stodium_get_critical_input(jenv,  &seed_buffer, seed);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &pub_buffer, &priv_buffer, &seed_buffer);
     jint result = (jint) crypto_sign_ed25519_seed_keypair(
             AS_OUTPUT(unsigned char, pub_buffer),
             AS_OUTPUT(unsigned char, priv_buffer),
             AS_INPUT(unsigned char, seed_buffer));
-
-    stodium_release_output(jenv, pub, &pub_buffer);
-    stodium_release_output(jenv, priv, &priv_buffer);
-    stodium_release_input(jenv, seed, &seed_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -3040,21 +5814,20 @@ STODIUM_JNI(jint, crypto_1sign_1ed25519) (JNIEnv *jenv, jclass jcls,
         jobject dst,
         jobject src,
         jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_SIGN);
     stodium_buffer dst_buffer, src_buffer, key_buffer;
-    stodium_get_buffer(jenv, &dst_buffer, dst);
-    stodium_get_buffer(jenv, &src_buffer, src);
-    stodium_get_buffer(jenv, &key_buffer, key);
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
+    stodium_get_critical_input(jenv,  &key_buffer, key);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &src_buffer, &key_buffer);
     jint result = (jint) crypto_sign_ed25519(
             AS_OUTPUT(unsigned char, dst_buffer),
-            AS_OUTPUT_LEN(unsigned long long, dst_buffer),
+            NULL,
             AS_OUTPUT(unsigned char, src_buffer),
             AS_INPUT_LEN(unsigned long long, src_buffer),
             AS_INPUT(unsigned char, key_buffer));
-
-    stodium_release_output(jenv, dst, &dst_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
-    stodium_release_input(jenv, key, &key_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -3063,21 +5836,20 @@ STODIUM_JNI(jint, crypto_1sign_1ed25519_1open) (JNIEnv *jenv, jclass jcls,
         jobject dst,
         jobject src,
         jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_SIGN);
     stodium_buffer dst_buffer, src_buffer, key_buffer;
-    stodium_get_buffer(jenv, &dst_buffer, dst);
-    stodium_get_buffer(jenv, &src_buffer, src);
-    stodium_get_buffer(jenv, &key_buffer, key);
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
+    stodium_get_critical_input(jenv,  &key_buffer, key);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &src_buffer, &key_buffer);
     jint result = (jint) crypto_sign_ed25519_open(
             AS_OUTPUT(unsigned char, dst_buffer),
-            AS_OUTPUT_LEN(unsigned long long, dst_buffer),
+            NULL,
             AS_OUTPUT(unsigned char, src_buffer),
             AS_INPUT_LEN(unsigned long long, src_buffer),
             AS_INPUT(unsigned char, key_buffer));
-
-    stodium_release_output(jenv, dst, &dst_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
-    stodium_release_input(jenv, key, &key_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -3086,21 +5858,20 @@ STODIUM_JNI(jint, crypto_1sign_1ed25519_1detached) (JNIEnv *jenv, jclass jcls,
         jobject dst,
         jobject src,
         jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_SIGN);
     stodium_buffer dst_buffer, src_buffer, key_buffer;
-    stodium_get_buffer(jenv, &dst_buffer, dst);
-    stodium_get_buffer(jenv, &src_buffer, src);
-    stodium_get_buffer(jenv, &key_buffer, key);
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
+    stodium_get_critical_input(jenv,  &key_buffer, key);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &dst_buffer, &src_buffer, &key_buffer);
     jint result = (jint) crypto_sign_ed25519_detached(
             AS_OUTPUT(unsigned char, dst_buffer),
-            AS_OUTPUT_LEN(unsigned long long, dst_buffer),
+            NULL,
             AS_OUTPUT(unsigned char, src_buffer),
             AS_INPUT_LEN(unsigned long long, src_buffer),
             AS_INPUT(unsigned char, key_buffer));
-
-    stodium_release_output(jenv, dst, &dst_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
-    stodium_release_input(jenv, key, &key_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -3109,33 +5880,168 @@ STODIUM_JNI(jint, crypto_1sign_1ed25519_1verify_1detached) (JNIEnv *jenv, jclass
         jobject sig,
         jobject src,
         jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_SIGN);
     stodium_buffer sig_buffer, src_buffer, key_buffer;
-    stodium_get_buffer(jenv, &sig_buffer, sig);
-    stodium_get_buffer(jenv, &src_buffer, src);
-    stodium_get_buffer(jenv, &key_buffer, key);
+    stodium_get_critical_input(jenv,  &sig_buffer, sig);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
+    stodium_get_critical_input(jenv,  &key_buffer, key);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &sig_buffer, &src_buffer, &key_buffer);
     jint result = (jint) crypto_sign_ed25519_verify_detached(
             AS_OUTPUT(unsigned char, sig_buffer),
             AS_OUTPUT(unsigned char, src_buffer),
             AS_INPUT_LEN(unsigned long long, src_buffer),
             AS_INPUT(unsigned char, key_buffer));
+    STODIUM_CRITICAL_END(jenv);
 
-    stodium_release_input(jenv, sig, &sig_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
-    stodium_release_input(jenv, key, &key_buffer);
+    return result;
+}
+
+/**
+ * stodium_sign_batch describes a batch of detached Ed25519 signatures. The
+ * public keys are stored once; keys[i] is the index of the key of message i.
+ * The result of message i is bit (i % 8) of results[i / 8].
+ */
+typedef struct stodium_sign_batch {
+    size_t               count;
+    const unsigned char *sigs;
+    const unsigned char *src;
+    const jint          *table;
+    const unsigned char *pubs;
+    const jint          *keys;
+    unsigned char       *results;
+} stodium_sign_batch;
+
+/**
+ * stodium_sign_batch_task is the stodium_pool_task for a batch verification.
+ * Chunks start at a multiple of STODIUM_POOL_GRAIN, which is a multiple of 8,
+ * so no two threads write to the same byte of the bitmap.
+ */
+static void stodium_sign_batch_task(void *ctx, size_t begin, size_t end) {
+    const stodium_sign_batch *batch = (const stodium_sign_batch *) ctx;
+    size_t i;
+
+    for (i = begin; i < end; i++) {
+        if (i % 8 == 0) {
+            batch->results[i / 8] = 0;
+        }
+        if (crypto_sign_ed25519_verify_detached(
+                    batch->sigs + i * crypto_sign_ed25519_BYTES,
+                    batch->src + batch->table[2 * i], (unsigned long long) batch->table[2 * i + 1],
+                    batch->pubs + (size_t) batch->keys[i] * crypto_sign_ed25519_PUBLICKEYBYTES) == 0) {
+            batch->results[i / 8] |= (unsigned char) (1 << (i % 8));
+        }
+    }
+}
+
+/**
+ * stodium_sign_batch_check validates the messages, signatures and key indices
+ * of a batch against the sizes of their buffers.
+ */
+static bool stodium_sign_batch_check(const stodium_sign_batch *batch,
+        size_t sigs_len,
+        size_t src_len,
+        size_t pubs_len) {
+    size_t i, pubs_count = pubs_len / crypto_sign_ed25519_PUBLICKEYBYTES;
+
+    if (sigs_len / crypto_sign_ed25519_BYTES < batch->count) {
+        return false;
+    }
+    for (i = 0; i < batch->count; i++) {
+        jint offset = batch->table[2 * i];
+        jint length = batch->table[2 * i + 1];
+        if (offset < 0 || length < 0
+                || (size_t) offset > src_len
+                || (size_t) length > src_len - (size_t) offset
+                || batch->keys[i] < 0
+                || (size_t) batch->keys[i] >= pubs_count) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Verifies a batch of detached signatures, spread over the worker pool if it
+ * is running. Returns the number of signatures that failed verification, or
+ * -1 if the batch is invalid.
+ */
+STODIUM_JNI(jint, crypto_1sign_1ed25519_1verify_1detached_1batch) (JNIEnv *jenv, jclass jcls,
+        jobject    sigs,
+        jobject    src,
+        jintArray  table,
+        jobject    pubs,
+        jintArray  keys,
+        jbyteArray results) {
+    STODIUM_STATS_CALL(STODIUM_STATS_SIGN);
+    stodium_sign_batch batch;
+    jint *table_elements, *keys_elements;
+    jbyte *results_elements;
+    jint result = -1;
+    size_t i;
+
+    batch.count = (size_t) ((*jenv)->GetArrayLength(jenv, table) / 2);
+    if ((size_t) (*jenv)->GetArrayLength(jenv, keys) != batch.count
+            || (size_t) (*jenv)->GetArrayLength(jenv, results) < (batch.count + 7) / 8) {
+        return -1;
+    }
+
+    table_elements = (*jenv)->GetIntArrayElements(jenv, table, NULL);
+    if (table_elements == NULL) {
+        return -1;
+    }
+    keys_elements = (*jenv)->GetIntArrayElements(jenv, keys, NULL);
+    if (keys_elements == NULL) {
+        (*jenv)->ReleaseIntArrayElements(jenv, table, table_elements, JNI_ABORT);
+        return -1;
+    }
+    results_elements = (*jenv)->GetByteArrayElements(jenv, results, NULL);
+    if (results_elements == NULL) {
+        (*jenv)->ReleaseIntArrayElements(jenv, keys, keys_elements, JNI_ABORT);
+        (*jenv)->ReleaseIntArrayElements(jenv, table, table_elements, JNI_ABORT);
+        return -1;
+    }
+
+    stodium_buffer sigs_buffer, src_buffer, pubs_buffer;
+    stodium_get_critical_input(jenv, &sigs_buffer, sigs);
+    stodium_get_critical_input(jenv, &src_buffer,  src);
+    stodium_get_critical_input(jenv, &pubs_buffer, pubs);
+
+    stodium_buffer *buffers[] = { &sigs_buffer, &src_buffer, &pubs_buffer };
+    if (stodium_critical_begin(jenv, buffers, 3)) {
+        batch.sigs    = AS_INPUT(unsigned char, sigs_buffer);
+        batch.src     = AS_INPUT(unsigned char, src_buffer);
+        batch.table   = table_elements;
+        batch.pubs    = AS_INPUT(unsigned char, pubs_buffer);
+        batch.keys    = keys_elements;
+        batch.results = (unsigned char *) results_elements;
+
+        if (stodium_sign_batch_check(&batch, sigs_buffer.capacity, src_buffer.capacity, pubs_buffer.capacity)) {
+            stodium_pool_run(stodium_sign_batch_task, &batch, batch.count, STODIUM_POOL_GRAIN);
+            for (result = 0, i = 0; i < batch.count; i++) {
+                result += (batch.results[i / 8] >> (i % 8) & 1) == 0;
+            }
+        }
+        stodium_critical_end(jenv, buffers, 3);
+    }
+
+    (*jenv)->ReleaseByteArrayElements(jenv, results, results_elements, result < 0 ? JNI_ABORT : 0);
+    (*jenv)->ReleaseIntArrayElements(jenv, keys, keys_elements, JNI_ABORT);
+    (*jenv)->ReleaseIntArrayElements(jenv, table, table_elements, JNI_ABORT);
 
     return result;
 }
 
 STODIUM_JNI(jint, crypto_1sign_1ed25519ph_1init) (JNIEnv *jenv, jclass jcls,
         jobject state) {
+    STODIUM_STATS_CALL(STODIUM_STATS_SIGN);
     stodium_buffer state_buffer;
-    stodium_get_buffer(jenv, &state_buffer, state);
+    stodium_get_critical_output(jenv, &state_buffer, state);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &state_buffer);
     jint result = (jint) crypto_sign_ed25519ph_init(
             AS_OUTPUT(crypto_sign_ed25519ph_state, state_buffer));
-
-    stodium_release_output(jenv, state, &state_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -3143,17 +6049,17 @@ STODIUM_JNI(jint, crypto_1sign_1ed25519ph_1init) (JNIEnv *jenv, jclass jcls,
 STODIUM_JNI(jint, crypto_1sign_1ed25519ph_1update) (JNIEnv *jenv, jclass jcls,
         jobject state,
         jobject src) {
+    STODIUM_STATS_CALL(STODIUM_STATS_SIGN);
     stodium_buffer state_buffer, src_buffer;
-    stodium_get_buffer(jenv, &state_buffer, state);
-    stodium_get_buffer(jenv, &src_buffer, src);
+    stodium_get_critical_output(jenv, &state_buffer, state);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &state_buffer, &src_buffer);
     jint result = (jint) crypto_sign_ed25519ph_update(
             AS_OUTPUT(crypto_sign_ed25519ph_state, state_buffer),
             AS_INPUT(unsigned char, src_buffer),
             AS_INPUT_LEN(unsigned long long, src_buffer));
-
-    stodium_release_output(jenv, state, &state_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -3162,20 +6068,19 @@ STODIUM_JNI(jint, crypto_1sign_1ed25519ph_1final_1create) (JNIEnv *jenv, jclass
         jobject state,
         jobject dst,
         jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_SIGN);
     stodium_buffer state_buffer, dst_buffer, key_buffer;
-    stodium_get_buffer(jenv, &state_buffer, state);
-    stodium_get_buffer(jenv, &dst_buffer, dst);
-    stodium_get_buffer(jenv, &key_buffer, key);
+    stodium_get_critical_output(jenv, &state_buffer, state);
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+    stodium_get_critical_input(jenv,  &key_buffer, key);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &state_buffer, &dst_buffer, &key_buffer);
     jint result = (jint) crypto_sign_ed25519ph_final_create(
             AS_OUTPUT(crypto_sign_ed25519ph_state, state_buffer),
             AS_OUTPUT(unsigned char, dst_buffer),
-            AS_OUTPUT_LEN(unsigned long long, dst_buffer),
+            NULL,
             AS_INPUT(unsigned char, key_buffer));
-
-    stodium_release_output(jenv, state, &state_buffer);
-    stodium_release_output(jenv, dst, &dst_buffer);
-    stodium_release_input(jenv, key, &key_buffer);
+    STODIUM_CRITICAL_END(jenv);
 
     return result;
 }
@@ -3184,24 +6089,986 @@ STODIUM_JNI(jint, crypto_1sign_1ed25519ph_1final_1verify) (JNIEnv *jenv, jclass
         jobject state,
         jobject src,
         jobject key) {
+    STODIUM_STATS_CALL(STODIUM_STATS_SIGN);
     stodium_buffer state_buffer, src_buffer, key_buffer;
-    stodium_get_buffer(jenv, &state_buffer, state);
-    stodium_get_buffer(jenv, &src_buffer, src);
-    stodium_get_buffer(jenv, &key_buffer, key);
+    stodium_get_critical_output(jenv, &state_buffer, state);
+    stodium_get_critical_input(jenv,  &src_buffer, src);
+    stodium_get_critical_input(jenv,  &key_buffer, key);
 
+    STODIUM_CRITICAL_BEGIN(jenv, &state_buffer, &src_buffer, &key_buffer);
     jint result = (jint) crypto_sign_ed25519ph_final_verify(
             AS_OUTPUT(crypto_sign_ed25519ph_state, state_buffer),
             // FIXME this is supposed to be input, but the libsodium method expects a non-const. This is probably not intended.
             AS_OUTPUT(unsigned char, src_buffer),
             AS_INPUT(unsigned char, key_buffer));
+    STODIUM_CRITICAL_END(jenv);
 
-    stodium_release_output(jenv, state, &state_buffer);
-    stodium_release_input(jenv, src, &src_buffer);
-    stodium_release_input(jenv, key, &key_buffer);
+    return result;
+}
+
+/** ****************************************************************************
+ *
+ * STATE HANDLES
+ *
+ * The multipart states below live in a native arena instead of a Java direct
+ * buffer, and are passed to Java as an opaque handle. Update calls on a handle
+ * do not need to resolve a state buffer, and slots are reused instead of
+ * allocated for every multipart operation.
+ *
+ **************************************************************************** */
+
+/**
+ * The kinds of state a slot can hold. STODIUM_STATE_FREE marks slots on the
+ * free list.
+ */
+#define STODIUM_STATE_FREE          0
+#define STODIUM_STATE_BLAKE2B       1
+#define STODIUM_STATE_SHA256        2
+#define STODIUM_STATE_SHA512        3
+#define STODIUM_STATE_HMACSHA256    4
+#define STODIUM_STATE_HMACSHA512    5
+#define STODIUM_STATE_HMACSHA512256 6
+#define STODIUM_STATE_POLY1305      7
+#define STODIUM_STATE_ED25519PH     8
+
+/**
+ * STODIUM_STATE_SLAB_SLOTS is the number of slots the arena grows by when the
+ * free list is empty. Slabs and slots are aligned to STODIUM_STATE_ALIGN
+ * bytes, the strictest alignment of the libsodium state types.
+ *
+ * A handle is the address of its slot, with the generation of the slot in
+ * the low bits that this alignment leaves clear (STODIUM_STATE_TAG_MASK). The
+ * generation is bumped whenever the slot is released, so a stale handle is
+ * rejected after its slot was reused, until the tag wraps around.
+ *
+ * Calls that use a state pin its slot for the duration of the call. A release
+ * that races such a call (e.g. finalize() on the GC thread while another
+ * object copies the state) invalidates the handle at once, but the slot is
+ * only wiped and reused when the last pin is dropped.
+ */
+#define STODIUM_STATE_SLAB_SLOTS 64
+#define STODIUM_STATE_ALIGN      64
+#define STODIUM_STATE_TAG_MASK   ((uintptr_t) (STODIUM_STATE_ALIGN - 1))
+
+typedef struct stodium_state_slot {
+    union {
+        crypto_generichash_blake2b_state  blake2b;
+        crypto_hash_sha256_state          sha256;
+        crypto_hash_sha512_state          sha512;
+        crypto_auth_hmacsha256_state      hmacsha256;
+        crypto_auth_hmacsha512_state      hmacsha512;
+        crypto_auth_hmacsha512256_state   hmacsha512256;
+        crypto_onetimeauth_poly1305_state poly1305;
+        crypto_sign_ed25519ph_state       ed25519ph;
+    } state;
+    struct stodium_state_slot *next;       // The next free slot, while on the free list
+    size_t                     outlen;     // The length of the final output
+    int                        kind;
+    unsigned int               generation; // The number of times the slot was released
+    unsigned int               pins;       // The number of calls using the slot
+    bool                       released;   // The handle was released while pinned
+} stodium_state_slot;
+
+#define STODIUM_STATE_STRIDE \
+    ((sizeof(stodium_state_slot) + STODIUM_STATE_ALIGN - 1) & ~(size_t) (STODIUM_STATE_ALIGN - 1))
+
+static pthread_mutex_t     stodium_state_mutex = PTHREAD_MUTEX_INITIALIZER;
+static stodium_state_slot *stodium_state_free_list;
+
+/**
+ * stodium_state_alloc takes a slot from the free list, growing the arena by a
+ * slab if needed. Slabs are never returned to the system; their slots are
+ * reused instead. Returns NULL if the arena could not grow.
+ */
+static stodium_state_slot *stodium_state_alloc(int kind, size_t outlen) {
+    stodium_state_slot *slot;
+    size_t i;
+
+    pthread_mutex_lock(&stodium_state_mutex);
+    if (stodium_state_free_list == NULL) {
+        unsigned char *raw = (unsigned char *) malloc(
+                STODIUM_STATE_SLAB_SLOTS * STODIUM_STATE_STRIDE + STODIUM_STATE_ALIGN - 1);
+        if (raw == NULL) {
+            pthread_mutex_unlock(&stodium_state_mutex);
+            return NULL;
+        }
+
+        unsigned char *slab = (unsigned char *)
+                (((uintptr_t) raw + STODIUM_STATE_ALIGN - 1) & ~STODIUM_STATE_TAG_MASK);
+        for (i = 0; i < STODIUM_STATE_SLAB_SLOTS; i++) {
+            slot = (stodium_state_slot *) (void *) (slab + i * STODIUM_STATE_STRIDE);
+            slot->kind              = STODIUM_STATE_FREE;
+            slot->generation        = 0;
+            slot->pins              = 0;
+            slot->released          = false;
+            slot->next              = stodium_state_free_list;
+            stodium_state_free_list = slot;
+        }
+    }
+
+    slot                    = stodium_state_free_list;
+    stodium_state_free_list = slot->next;
+    slot->next              = NULL;
+    slot->outlen            = outlen;
+    slot->kind              = kind;
+    pthread_mutex_unlock(&stodium_state_mutex);
+
+    return slot;
+}
+
+/**
+ * stodium_state_handle returns the handle of slot, tagged with its current
+ * generation.
+ */
+static jlong stodium_state_handle(const stodium_state_slot *slot) {
+    return (jlong) ((uintptr_t) slot | ((uintptr_t) slot->generation & STODIUM_STATE_TAG_MASK));
+}
+
+/**
+ * stodium_state_lookup returns the slot referenced by handle, or NULL if the
+ * handle was released, or its slot since reused. Called with
+ * stodium_state_mutex held.
+ */
+static stodium_state_slot *stodium_state_lookup(jlong handle) {
+    stodium_state_slot *slot = (stodium_state_slot *) (uintptr_t) ((uintptr_t) handle & ~STODIUM_STATE_TAG_MASK);
+    if (slot == NULL
+            || slot->kind == STODIUM_STATE_FREE
+            || ((uintptr_t) slot->generation & STODIUM_STATE_TAG_MASK) != ((uintptr_t) handle & STODIUM_STATE_TAG_MASK)) {
+        return NULL;
+    }
+    return slot;
+}
+
+/**
+ * stodium_state_recycle wipes slot and returns it to the free list. Called
+ * with stodium_state_mutex held.
+ */
+static void stodium_state_recycle(stodium_state_slot *slot) {
+    sodium_memzero(&slot->state, sizeof slot->state);
+    slot->kind              = STODIUM_STATE_FREE;
+    slot->released          = false;
+    slot->next              = stodium_state_free_list;
+    stodium_state_free_list = slot;
+}
+
+/**
+ * stodium_state_pin returns the slot referenced by handle, pinned so that it
+ * is not reused until stodium_state_unpin, or NULL if the handle is not
+ * valid.
+ */
+static stodium_state_slot *stodium_state_pin(jlong handle) {
+    pthread_mutex_lock(&stodium_state_mutex);
+    stodium_state_slot *slot = stodium_state_lookup(handle);
+    if (slot != NULL) {
+        slot->pins++;
+    }
+    pthread_mutex_unlock(&stodium_state_mutex);
+    return slot;
+}
+
+/**
+ * stodium_state_unpin drops a pin taken by stodium_state_pin, and recycles
+ * the slot if its handle was released in the meantime.
+ */
+static void stodium_state_unpin(stodium_state_slot *slot) {
+    pthread_mutex_lock(&stodium_state_mutex);
+    if (--slot->pins == 0 && slot->released) {
+        stodium_state_recycle(slot);
+    }
+    pthread_mutex_unlock(&stodium_state_mutex);
+}
+
+/**
+ * stodium_state_release invalidates handle by bumping the generation of its
+ * slot, and wipes and recycles the slot unless it is pinned. Releasing a
+ * handle that was already released has no effect, so of two racing releases
+ * (e.g. close() and finalize()) only the first counts.
+ */
+static void stodium_state_release(jlong handle) {
+    pthread_mutex_lock(&stodium_state_mutex);
+    stodium_state_slot *slot = stodium_state_lookup(handle);
+    if (slot != NULL) {
+        slot->generation++;
+        if (slot->pins == 0) {
+            stodium_state_recycle(slot);
+        } else {
+            slot->released = true;
+        }
+    }
+    pthread_mutex_unlock(&stodium_state_mutex);
+}
+
+/**
+ * stodium_state_stats_groups maps the kind of a slot to the group its calls are
+ * counted towards.
+ */
+#if STODIUM_STATS
+static const int stodium_state_stats_groups[] = {
+    STODIUM_STATS_UTILS,       // STODIUM_STATE_FREE
+    STODIUM_STATS_GENERICHASH, // STODIUM_STATE_BLAKE2B
+    STODIUM_STATS_HASH,        // STODIUM_STATE_SHA256
+    STODIUM_STATS_HASH,        // STODIUM_STATE_SHA512
+    STODIUM_STATS_AUTH,        // STODIUM_STATE_HMACSHA256
+    STODIUM_STATS_AUTH,        // STODIUM_STATE_HMACSHA512
+    STODIUM_STATS_AUTH,        // STODIUM_STATE_HMACSHA512256
+    STODIUM_STATS_ONETIMEAUTH, // STODIUM_STATE_POLY1305
+    STODIUM_STATS_SIGN,        // STODIUM_STATE_ED25519PH
+};
+#endif
+
+/**
+ * stodium_state_init allocates a slot of the given kind and initializes the
+ * state with the (optional) key. Returns the handle of the slot, or 0 if the
+ * state could not be initialized.
+ */
+static jlong stodium_state_init(JNIEnv *jenv, int kind, size_t outlen, jobject key) {
+    STODIUM_STATS_CALL(stodium_state_stats_groups[kind]);
+    stodium_state_slot *slot = stodium_state_alloc(kind, outlen);
+    if (slot == NULL) {
+        return 0;
+    }
 
+    stodium_buffer key_buffer;
+    stodium_get_critical_input(jenv, &key_buffer, key);
+
+    stodium_buffer *buffers[] = { &key_buffer };
+    int result = -1;
+    if (stodium_critical_begin(jenv, buffers, 1)) {
+        const unsigned char *k    = AS_INPUT(unsigned char, key_buffer);
+        size_t               klen = AS_INPUT_LEN(size_t, key_buffer);
+
+        switch (kind) {
+        case STODIUM_STATE_BLAKE2B:
+            result = crypto_generichash_blake2b_init(&slot->state.blake2b, k, klen, outlen);
+            break;
+        case STODIUM_STATE_SHA256:
+            result = crypto_hash_sha256_init(&slot->state.sha256);
+            break;
+        case STODIUM_STATE_SHA512:
+            result = crypto_hash_sha512_init(&slot->state.sha512);
+            break;
+        case STODIUM_STATE_HMACSHA256:
+            result = crypto_auth_hmacsha256_init(&slot->state.hmacsha256, k, klen);
+            break;
+        case STODIUM_STATE_HMACSHA512:
+            result = crypto_auth_hmacsha512_init(&slot->state.hmacsha512, k, klen);
+            break;
+        case STODIUM_STATE_HMACSHA512256:
+            result = crypto_auth_hmacsha512256_init(&slot->state.hmacsha512256, k, klen);
+            break;
+        case STODIUM_STATE_POLY1305:
+            if (klen >= crypto_onetimeauth_poly1305_KEYBYTES) {
+                result = crypto_onetimeauth_poly1305_init(&slot->state.poly1305, k);
+            }
+            break;
+        case STODIUM_STATE_ED25519PH:
+            result = crypto_sign_ed25519ph_init(&slot->state.ed25519ph);
+            break;
+        }
+        stodium_critical_end(jenv, buffers, 1);
+    }
+
+    jlong handle = stodium_state_handle(slot);
+    if (result != 0) {
+        stodium_state_release(handle);
+        return 0;
+    }
+    return handle;
+}
+
+STODIUM_JNI(jlong, stodium_1state_1blake2b_1init) (JNIEnv *jenv, jclass jcls,
+        jobject key,
+        jint    outlen) {
+    if (outlen < (jint) crypto_generichash_blake2b_BYTES_MIN || outlen > (jint) crypto_generichash_blake2b_BYTES_MAX) {
+        return 0;
+    }
+    return stodium_state_init(jenv, STODIUM_STATE_BLAKE2B, (size_t) outlen, key);
+}
+
+STODIUM_JNI(jlong, stodium_1state_1sha256_1init) (JNIEnv *jenv, jclass jcls) {
+    return stodium_state_init(jenv, STODIUM_STATE_SHA256, crypto_hash_sha256_BYTES, NULL);
+}
+
+STODIUM_JNI(jlong, stodium_1state_1sha512_1init) (JNIEnv *jenv, jclass jcls) {
+    return stodium_state_init(jenv, STODIUM_STATE_SHA512, crypto_hash_sha512_BYTES, NULL);
+}
+
+STODIUM_JNI(jlong, stodium_1state_1hmacsha256_1init) (JNIEnv *jenv, jclass jcls,
+        jobject key) {
+    return stodium_state_init(jenv, STODIUM_STATE_HMACSHA256, crypto_auth_hmacsha256_BYTES, key);
+}
+
+STODIUM_JNI(jlong, stodium_1state_1hmacsha512_1init) (JNIEnv *jenv, jclass jcls,
+        jobject key) {
+    return stodium_state_init(jenv, STODIUM_STATE_HMACSHA512, crypto_auth_hmacsha512_BYTES, key);
+}
+
+STODIUM_JNI(jlong, stodium_1state_1hmacsha512256_1init) (JNIEnv *jenv, jclass jcls,
+        jobject key) {
+    return stodium_state_init(jenv, STODIUM_STATE_HMACSHA512256, crypto_auth_hmacsha512256_BYTES, key);
+}
+
+STODIUM_JNI(jlong, stodium_1state_1poly1305_1init) (JNIEnv *jenv, jclass jcls,
+        jobject key) {
+    return stodium_state_init(jenv, STODIUM_STATE_POLY1305, crypto_onetimeauth_poly1305_BYTES, key);
+}
+
+STODIUM_JNI(jlong, stodium_1state_1ed25519ph_1init) (JNIEnv *jenv, jclass jcls) {
+    return stodium_state_init(jenv, STODIUM_STATE_ED25519PH, crypto_sign_ed25519_BYTES, NULL);
+}
+
+/**
+ * stodium_state_update_slot feeds inlen bytes to the state held by slot.
+ */
+static jint stodium_state_update_slot(stodium_state_slot *slot, const unsigned char *in, unsigned long long inlen) {
+    switch (slot->kind) {
+    case STODIUM_STATE_BLAKE2B:
+        return (jint) crypto_generichash_blake2b_update(&slot->state.blake2b, in, inlen);
+    case STODIUM_STATE_SHA256:
+        return (jint) crypto_hash_sha256_update(&slot->state.sha256, in, inlen);
+    case STODIUM_STATE_SHA512:
+        return (jint) crypto_hash_sha512_update(&slot->state.sha512, in, inlen);
+    case STODIUM_STATE_HMACSHA256:
+        return (jint) crypto_auth_hmacsha256_update(&slot->state.hmacsha256, in, inlen);
+    case STODIUM_STATE_HMACSHA512:
+        return (jint) crypto_auth_hmacsha512_update(&slot->state.hmacsha512, in, inlen);
+    case STODIUM_STATE_HMACSHA512256:
+        return (jint) crypto_auth_hmacsha512256_update(&slot->state.hmacsha512256, in, inlen);
+    case STODIUM_STATE_POLY1305:
+        return (jint) crypto_onetimeauth_poly1305_update(&slot->state.poly1305, in, inlen);
+    case STODIUM_STATE_ED25519PH:
+        return (jint) crypto_sign_ed25519ph_update(&slot->state.ed25519ph, in, inlen);
+    }
+    return -1;
+}
+
+STODIUM_JNI(jint, stodium_1state_1update) (JNIEnv *jenv, jclass jcls,
+        jlong   handle,
+        jobject src) {
+    stodium_state_slot *slot = stodium_state_pin(handle);
+    if (slot == NULL) {
+        return -1;
+    }
+    STODIUM_STATS_CALL(stodium_state_stats_groups[slot->kind]);
+
+    stodium_buffer src_buffer;
+    stodium_get_critical_input(jenv, &src_buffer, src);
+
+    stodium_buffer *buffers[] = { &src_buffer };
+    jint result = -1;
+    if (stodium_critical_begin(jenv, buffers, 1)) {
+        result = stodium_state_update_slot(slot,
+                AS_INPUT(unsigned char, src_buffer),
+                AS_INPUT_LEN(unsigned long long, src_buffer));
+        stodium_critical_end(jenv, buffers, 1);
+    }
+
+    stodium_state_unpin(slot);
+    return result;
+}
+
+/**
+ * Updates a state with every buffer of src in order, in a single call,
+ * without concatenating them.
+ */
+STODIUM_JNI(jint, stodium_1state_1update_1gather) (JNIEnv *jenv, jclass jcls,
+        jlong        handle,
+        jobjectArray src) {
+    stodium_state_slot *slot = stodium_state_pin(handle);
+    if (slot == NULL) {
+        return -1;
+    }
+    STODIUM_STATS_CALL(stodium_state_stats_groups[slot->kind]);
+
+    stodium_fragments src_fragments;
+    stodium_buffer **list;
+    size_t count, i;
+    jint result = -1;
+
+    if (!stodium_get_critical_fragments(jenv, &src_fragments, src, false)) {
+        stodium_state_unpin(slot);
+        return -1;
+    }
+    list = stodium_fragments_begin(jenv, &src_fragments, NULL, NULL, 0, &count);
+    if (list != NULL) {
+        result = 0;
+        for (i = 0; i < src_fragments.count && result == 0; i++) {
+            result = stodium_state_update_slot(slot,
+                    AS_INPUT(unsigned char, src_fragments.buffers[i]),
+                    AS_INPUT_LEN(unsigned long long, src_fragments.buffers[i]));
+        }
+        stodium_fragments_end(jenv, list, count);
+    }
+    stodium_fragments_release(&src_fragments);
+
+    stodium_state_unpin(slot);
+    return result;
+}
+
+/**
+ * STODIUM_FILE_WINDOW is the number of bytes read from a file, or prefetched
+ * from a mapping, at a time by the update methods below.
+ */
+#ifndef STODIUM_FILE_WINDOW
+#define STODIUM_FILE_WINDOW (1024 * 1024)
+#endif
+
+/**
+ * Updates a state with length bytes of an open file, starting at offset, or
+ * with the rest of the file if length is negative. The whole file is read in
+ * this call, in windows of STODIUM_FILE_WINDOW bytes, without moving the
+ * position of the file. Returns -1 if the file can not be read, or ends before
+ * offset + length.
+ */
+STODIUM_JNI(jint, stodium_1state_1update_1fd) (JNIEnv *jenv, jclass jcls,
+        jlong   handle,
+        jobject fd,
+        jlong   offset,
+        jlong   length) {
+#ifdef _WIN32
+    return -1;
+#else
+    if (fd == NULL || stodium_g_file_descriptor_field_fd == NULL || offset < 0) {
+        return -1;
+    }
+
+    int   file = (int) (*jenv)->GetIntField(jenv, fd, stodium_g_file_descriptor_field_fd);
+    off_t pos  = (off_t) offset;
+    if (file < 0 || (jlong) pos != offset) {
+        return -1; // closed, or an offset beyond a 32-bit off_t
+    }
+
+    unsigned char *window = (unsigned char *) malloc(STODIUM_FILE_WINDOW);
+    if (window == NULL) {
+        return -1;
+    }
+
+    stodium_state_slot *slot = stodium_state_pin(handle);
+    if (slot == NULL) {
+        free(window);
+        return -1;
+    }
+    STODIUM_STATS_CALL(stodium_state_stats_groups[slot->kind]);
+
+#if defined(POSIX_FADV_SEQUENTIAL) && (!defined(__ANDROID__) || __ANDROID_API__ >= 21)
+    posix_fadvise(file, pos, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    jint result = 0;
+    while (result == 0 && length != 0) {
+        size_t want = STODIUM_FILE_WINDOW;
+        if (length > 0 && length < (jlong) want) {
+            want = (size_t) length;
+        }
+
+        ssize_t got = pread(file, window, want, pos);
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            if (got < 0 || length > 0) {
+                result = -1; // read error, or the file was shorter than length
+            }
+            break;
+        }
+
+        STODIUM_STATS_ADD(STODIUM_STATS_BYTES, got);
+        result = stodium_state_update_slot(slot, window, (unsigned long long) got);
+        pos += got;
+        if (length > 0) {
+            length -= got;
+        }
+    }
+
+    stodium_state_unpin(slot);
+    sodium_memzero(window, STODIUM_FILE_WINDOW);
+    free(window);
+    return result;
+#endif
+}
+
+/**
+ * Updates a state with the remaining bytes of a direct buffer, typically a
+ * MappedByteBuffer over a file. The mapping is advised to be read
+ * sequentially, and every window of STODIUM_FILE_WINDOW bytes is prefetched
+ * while the one before it is hashed. No critical region is entered, so the
+ * page faults of a large mapping do not hold up the garbage collector.
+ */
+STODIUM_JNI(jint, stodium_1state_1update_1mapped) (JNIEnv *jenv, jclass jcls,
+        jlong   handle,
+        jobject src) {
+    stodium_state_slot *slot = stodium_state_pin(handle);
+    if (slot == NULL) {
+        return -1;
+    }
+    STODIUM_STATS_CALL(stodium_state_stats_groups[slot->kind]);
+
+    stodium_buffer src_buffer;
+    stodium_resolve_buffer(jenv, &src_buffer, src);
+    stodium_count_buffer(src, &src_buffer);
+    if (src == NULL || !src_buffer.is_direct) {
+        stodium_state_unpin(slot);
+        return -1;
+    }
+
+    const unsigned char *in    = AS_INPUT(unsigned char, src_buffer);
+    size_t               inlen = AS_INPUT_LEN(size_t, src_buffer);
+    STODIUM_STATS_ADD(STODIUM_STATS_BYTES, inlen);
+
+#ifndef _WIN32
+    uintptr_t page = (uintptr_t) sysconf(_SC_PAGESIZE);
+    uintptr_t base = (uintptr_t) in & ~(page - 1);
+    madvise((void *) base, (uintptr_t) in + inlen - base, MADV_SEQUENTIAL);
+#endif
+
+    jint   result = 0;
+    size_t done   = 0;
+    while (result == 0 && done < inlen) {
+        size_t n = inlen - done < STODIUM_FILE_WINDOW ? inlen - done : STODIUM_FILE_WINDOW;
+#ifndef _WIN32
+        if (done + n < inlen) {
+            uintptr_t next = ((uintptr_t) in + done + n) & ~(page - 1);
+            size_t    rest = inlen - done - n;
+            madvise((void *) next, rest < STODIUM_FILE_WINDOW ? rest : STODIUM_FILE_WINDOW, MADV_WILLNEED);
+        }
+#endif
+        result = stodium_state_update_slot(slot, in + done, (unsigned long long) n);
+        done += n;
+    }
+
+    stodium_state_unpin(slot);
+    return result;
+}
+
+/**
+ * Writes the final output of a hash or authenticator state to dst, and
+ * releases the handle, also if dst is too short to hold the output.
+ */
+STODIUM_JNI(jint, stodium_1state_1final) (JNIEnv *jenv, jclass jcls,
+        jlong   handle,
+        jobject dst) {
+    stodium_state_slot *slot = stodium_state_pin(handle);
+    if (slot == NULL) {
+        return -1;
+    }
+    STODIUM_STATS_CALL(stodium_state_stats_groups[slot->kind]);
+
+    stodium_buffer dst_buffer;
+    stodium_get_critical_output(jenv, &dst_buffer, dst);
+
+    stodium_buffer *buffers[] = { &dst_buffer };
+    jint result = -1;
+    if (dst_buffer.capacity >= slot->outlen && stodium_critical_begin(jenv, buffers, 1)) {
+        unsigned char *out = AS_OUTPUT(unsigned char, dst_buffer);
+
+        switch (slot->kind) {
+        case STODIUM_STATE_BLAKE2B:
+            result = (jint) crypto_generichash_blake2b_final(&slot->state.blake2b, out, slot->outlen);
+            break;
+        case STODIUM_STATE_SHA256:
+            result = (jint) crypto_hash_sha256_final(&slot->state.sha256, out);
+            break;
+        case STODIUM_STATE_SHA512:
+            result = (jint) crypto_hash_sha512_final(&slot->state.sha512, out);
+            break;
+        case STODIUM_STATE_HMACSHA256:
+            result = (jint) crypto_auth_hmacsha256_final(&slot->state.hmacsha256, out);
+            break;
+        case STODIUM_STATE_HMACSHA512:
+            result = (jint) crypto_auth_hmacsha512_final(&slot->state.hmacsha512, out);
+            break;
+        case STODIUM_STATE_HMACSHA512256:
+            result = (jint) crypto_auth_hmacsha512256_final(&slot->state.hmacsha512256, out);
+            break;
+        case STODIUM_STATE_POLY1305:
+            result = (jint) crypto_onetimeauth_poly1305_final(&slot->state.poly1305, out);
+            break;
+        }
+        stodium_critical_end(jenv, buffers, 1);
+    }
+
+    stodium_state_release(handle);
+    stodium_state_unpin(slot);
+    return result;
+}
+
+/**
+ * Creates the Ed25519ph signature of an ed25519ph state, and releases the
+ * handle.
+ */
+STODIUM_JNI(jint, stodium_1state_1ed25519ph_1final_1create) (JNIEnv *jenv, jclass jcls,
+        jlong   handle,
+        jobject dst,
+        jobject priv) {
+    stodium_state_slot *slot = stodium_state_pin(handle);
+    if (slot == NULL) {
+        return -1;
+    }
+    STODIUM_STATS_CALL(stodium_state_stats_groups[slot->kind]);
+
+    stodium_buffer dst_buffer, priv_buffer;
+    stodium_get_critical_output(jenv, &dst_buffer,  dst);
+    stodium_get_critical_input(jenv,  &priv_buffer, priv);
+
+    stodium_buffer *buffers[] = { &dst_buffer, &priv_buffer };
+    jint result = -1;
+    if (slot->kind == STODIUM_STATE_ED25519PH
+            && dst_buffer.capacity >= crypto_sign_ed25519_BYTES
+            && priv_buffer.capacity >= crypto_sign_ed25519_SECRETKEYBYTES
+            && stodium_critical_begin(jenv, buffers, 2)) {
+        result = (jint) crypto_sign_ed25519ph_final_create(
+                &slot->state.ed25519ph,
+                AS_OUTPUT(unsigned char, dst_buffer),
+                NULL,
+                AS_INPUT(unsigned char, priv_buffer));
+        stodium_critical_end(jenv, buffers, 2);
+    }
+
+    stodium_state_release(handle);
+    stodium_state_unpin(slot);
     return result;
 }
 
+/**
+ * Verifies an Ed25519ph signature against an ed25519ph state, and releases the
+ * handle.
+ */
+STODIUM_JNI(jint, stodium_1state_1ed25519ph_1final_1verify) (JNIEnv *jenv, jclass jcls,
+        jlong   handle,
+        jobject sig,
+        jobject pub) {
+    stodium_state_slot *slot = stodium_state_pin(handle);
+    if (slot == NULL) {
+        return -1;
+    }
+    STODIUM_STATS_CALL(stodium_state_stats_groups[slot->kind]);
+
+    stodium_buffer sig_buffer, pub_buffer;
+    stodium_get_critical_input(jenv, &sig_buffer, sig);
+    stodium_get_critical_input(jenv, &pub_buffer, pub);
+
+    stodium_buffer *buffers[] = { &sig_buffer, &pub_buffer };
+    jint result = -1;
+    if (slot->kind == STODIUM_STATE_ED25519PH
+            && sig_buffer.capacity >= crypto_sign_ed25519_BYTES
+            && pub_buffer.capacity >= crypto_sign_ed25519_PUBLICKEYBYTES
+            && stodium_critical_begin(jenv, buffers, 2)) {
+        result = (jint) crypto_sign_ed25519ph_final_verify(
+                &slot->state.ed25519ph,
+                // The signature is only read, libsodium did not mark it const
+                AS_OUTPUT(unsigned char, sig_buffer),
+                AS_INPUT(unsigned char, pub_buffer));
+        stodium_critical_end(jenv, buffers, 2);
+    }
+
+    stodium_state_release(handle);
+    stodium_state_unpin(slot);
+    return result;
+}
+
+/**
+ * Returns a new handle holding a copy of the state of handle, or 0 if the copy
+ * could not be allocated.
+ */
+STODIUM_JNI(jlong, stodium_1state_1copy) (JNIEnv *jenv, jclass jcls,
+        jlong handle) {
+    stodium_state_slot *slot = stodium_state_pin(handle);
+    if (slot == NULL) {
+        return 0;
+    }
+
+    stodium_state_slot *copy = stodium_state_alloc(slot->kind, slot->outlen);
+    if (copy != NULL) {
+        memcpy(&copy->state, &slot->state, sizeof slot->state);
+    }
+    stodium_state_unpin(slot);
+    return copy == NULL ? 0 : stodium_state_handle(copy);
+}
+
+/**
+ * Wipes and releases a handle that will not be finalized.
+ */
+STODIUM_JNI(void, stodium_1state_1free) (JNIEnv *jenv, jclass jcls,
+        jlong handle) {
+    stodium_state_release(handle);
+}
+
+/** ****************************************************************************
+ *
+ * SECURE MEMORY
+ *
+ **************************************************************************** */
+
+/**
+ * STODIUM_SECURE_ALIGN is the granularity of the blocks handed out by a slab.
+ * Blocks up to STODIUM_SECURE_CLASSES * STODIUM_SECURE_ALIGN bytes are reused
+ * through a free list per size; larger blocks through a single list that is
+ * searched for a block of the same size.
+ */
+#define STODIUM_SECURE_ALIGN   16
+#define STODIUM_SECURE_CLASSES 16
+
+#define STODIUM_SECURE_NOACCESS  0
+#define STODIUM_SECURE_READONLY  1
+#define STODIUM_SECURE_READWRITE 2
+
+/**
+ * stodium_secure_block is written into a released block, to link it into the
+ * free list of its size.
+ */
+typedef struct stodium_secure_block {
+    struct stodium_secure_block *next;
+    size_t                       size;
+} stodium_secure_block;
+
+/**
+ * stodium_secure_slab is a single sodium_malloc region, which is guarded by
+ * inaccessible pages, locked in memory (if the OS allows it) and wiped by
+ * sodium_free. Blocks are carved from the region front to back; released
+ * blocks are wiped and kept in a free list. The protection of the region
+ * applies to every block in it.
+ *
+ * live has a bit for every STODIUM_SECURE_ALIGN bytes of the region, which is
+ * set while a block that starts there is handed out, so that a block can not
+ * be released twice.
+ */
+typedef struct stodium_secure_slab {
+    unsigned char        *base;
+    unsigned char        *live;
+    size_t                capacity;
+    size_t                used;
+    int                   protection;
+    stodium_secure_block *classes[STODIUM_SECURE_CLASSES];
+    stodium_secure_block *large;
+} stodium_secure_slab;
+
+static int stodium_secure_mprotect(stodium_secure_slab *slab, int protection) {
+    switch (protection) {
+    case STODIUM_SECURE_NOACCESS:  return sodium_mprotect_noaccess(slab->base);
+    case STODIUM_SECURE_READONLY:  return sodium_mprotect_readonly(slab->base);
+    case STODIUM_SECURE_READWRITE: return sodium_mprotect_readwrite(slab->base);
+    default:                       return -1;
+    }
+}
+
+/**
+ * stodium_secure_free_list returns the free list that holds blocks of size.
+ */
+static stodium_secure_block **stodium_secure_free_list(stodium_secure_slab *slab, size_t size) {
+    size_t class = size / STODIUM_SECURE_ALIGN - 1;
+    return class < STODIUM_SECURE_CLASSES ? &slab->classes[class] : &slab->large;
+}
+
+/**
+ * stodium_secure_live returns the live bit of the block at ptr, and
+ * stodium_secure_mark sets or clears it.
+ */
+static int stodium_secure_live(const stodium_secure_slab *slab, const unsigned char *ptr) {
+    const size_t granule = (size_t) (ptr - slab->base) / STODIUM_SECURE_ALIGN;
+    return (slab->live[granule / 8] >> (granule % 8)) & 1;
+}
+
+static void stodium_secure_mark(stodium_secure_slab *slab, const unsigned char *ptr, int live) {
+    const size_t        granule = (size_t) (ptr - slab->base) / STODIUM_SECURE_ALIGN;
+    const unsigned char bit     = (unsigned char) (1U << (granule % 8));
+    if (live) {
+        slab->live[granule / 8] |= bit;
+    } else {
+        slab->live[granule / 8] &= (unsigned char) ~bit;
+    }
+}
+
+/**
+ * stodium_secure_take returns a block of size bytes, which must be a multiple
+ * of STODIUM_SECURE_ALIGN, or NULL if the slab has no room for it. The slab
+ * must be writable.
+ */
+static unsigned char *stodium_secure_take(stodium_secure_slab *slab, size_t size) {
+    stodium_secure_block **link = stodium_secure_free_list(slab, size);
+    for (; *link != NULL; link = &(*link)->next) {
+        stodium_secure_block *block = *link;
+        if (block->size == size) {
+            *link = block->next;
+            sodium_memzero(block, sizeof(stodium_secure_block));
+            stodium_secure_mark(slab, (unsigned char *) block, 1);
+            return (unsigned char *) block;
+        }
+    }
+
+    if (slab->capacity - slab->used < size) {
+        return NULL;
+    }
+    unsigned char *block = slab->base + slab->used;
+    slab->used += size;
+    stodium_secure_mark(slab, block, 1);
+    return block;
+}
+
+/**
+ * stodium_secure_put wipes a block and returns it to the slab. The slab must
+ * be writable.
+ */
+static void stodium_secure_put(stodium_secure_slab *slab, unsigned char *ptr, size_t size) {
+    stodium_secure_mark(slab, ptr, 0);
+    sodium_memzero(ptr, size);
+    if (ptr + size == slab->base + slab->used) {
+        slab->used -= size;
+        return;
+    }
+
+    stodium_secure_block **list  = stodium_secure_free_list(slab, size);
+    stodium_secure_block  *block = (stodium_secure_block *) ptr;
+    block->next = *list;
+    block->size = size;
+    *list = block;
+}
+
+/**
+ * stodium_secure_round rounds size up to a multiple of STODIUM_SECURE_ALIGN,
+ * returning 0 if size is not positive.
+ */
+static size_t stodium_secure_round(jlong size) {
+    if (size <= 0 || (uint64_t) size > SIZE_MAX - STODIUM_SECURE_ALIGN) {
+        return 0;
+    }
+    return ((size_t) size + STODIUM_SECURE_ALIGN - 1) & ~((size_t) STODIUM_SECURE_ALIGN - 1);
+}
+
+/**
+ * Allocates a slab of capacity bytes (rounded up to STODIUM_SECURE_ALIGN).
+ * Returns the handle of the slab, or 0 if it could not be allocated.
+ */
+STODIUM_JNI(jlong, stodium_1secure_1slab_1create) (JNIEnv *jenv, jclass jcls,
+        jint capacity) {
+    STODIUM_STATS_CALL(STODIUM_STATS_UTILS);
+    size_t rounded = stodium_secure_round(capacity);
+    if (rounded == 0) {
+        return 0;
+    }
+
+    stodium_secure_slab *slab = (stodium_secure_slab *) calloc(1, sizeof(stodium_secure_slab));
+    if (slab == NULL) {
+        return 0;
+    }
+    slab->live = (unsigned char *) calloc(rounded / STODIUM_SECURE_ALIGN / 8 + 1, 1);
+    slab->base = (unsigned char *) sodium_malloc(rounded);
+    if (slab->live == NULL || slab->base == NULL) {
+        free(slab->live);
+        sodium_free(slab->base);
+        free(slab);
+        return 0;
+    }
+    sodium_memzero(slab->base, rounded);
+    slab->capacity   = rounded;
+    slab->protection = STODIUM_SECURE_READWRITE;
+    return (jlong) (uintptr_t) slab;
+}
+
+/**
+ * Wipes and releases a slab. Every buffer allocated from it becomes invalid.
+ */
+STODIUM_JNI(void, stodium_1secure_1slab_1free) (JNIEnv *jenv, jclass jcls,
+        jlong handle) {
+    stodium_secure_slab *slab = (stodium_secure_slab *) (uintptr_t) handle;
+    if (slab != NULL) {
+        sodium_free(slab->base);
+        free(slab->live);
+        free(slab);
+    }
+}
+
+/**
+ * stodium_secure_unlock makes a slab writable, if it is protected, so blocks
+ * can be taken from or returned to it. stodium_secure_lock restores the
+ * protection set by stodium_1secure_1protect.
+ */
+static void stodium_secure_unlock(stodium_secure_slab *slab) {
+    if (slab->protection != STODIUM_SECURE_READWRITE) {
+        sodium_mprotect_readwrite(slab->base);
+    }
+}
+
+static void stodium_secure_lock(stodium_secure_slab *slab) {
+    if (slab->protection != STODIUM_SECURE_READWRITE) {
+        stodium_secure_mprotect(slab, slab->protection);
+    }
+}
+
+/**
+ * Allocates size bytes from a slab, returning a direct ByteBuffer over the
+ * (zeroed) block, or NULL if the slab has no room left.
+ */
+STODIUM_JNI(jobject, stodium_1secure_1alloc) (JNIEnv *jenv, jclass jcls,
+        jlong handle,
+        jint  size) {
+    STODIUM_STATS_CALL(STODIUM_STATS_UTILS);
+    stodium_secure_slab *slab    = (stodium_secure_slab *) (uintptr_t) handle;
+    size_t               rounded = stodium_secure_round(size);
+    if (slab == NULL || rounded == 0 || rounded > slab->capacity) {
+        return NULL;
+    }
+
+    stodium_secure_unlock(slab);
+    unsigned char *block = stodium_secure_take(slab, rounded);
+    stodium_secure_lock(slab);
+    if (block == NULL) {
+        return NULL;
+    }
+
+    jobject buffer = (*jenv)->NewDirectByteBuffer(jenv, block, (jlong) size);
+    if (buffer == NULL) {
+        stodium_secure_unlock(slab);
+        stodium_secure_put(slab, block, rounded);
+        stodium_secure_lock(slab);
+    }
+    return buffer;
+}
+
+/**
+ * Wipes a block allocated by stodium_1secure_1alloc and returns it to its
+ * slab. Returns 0 on success, -1 if buffer was not allocated from the slab or
+ * was already released.
+ */
+STODIUM_JNI(jint, stodium_1secure_1release) (JNIEnv *jenv, jclass jcls,
+        jlong   handle,
+        jobject buffer) {
+    STODIUM_STATS_CALL(STODIUM_STATS_UTILS);
+    stodium_secure_slab *slab = (stodium_secure_slab *) (uintptr_t) handle;
+    if (slab == NULL || buffer == NULL) {
+        return -1;
+    }
+
+    unsigned char *block   = (unsigned char *) (*jenv)->GetDirectBufferAddress(jenv, buffer);
+    size_t         rounded = stodium_secure_round((*jenv)->GetDirectBufferCapacity(jenv, buffer));
+    if (block == NULL || rounded == 0 || block < slab->base ||
+            (size_t) (block - slab->base) + rounded > slab->used ||
+            (size_t) (block - slab->base) % STODIUM_SECURE_ALIGN != 0 ||
+            !stodium_secure_live(slab, block)) {
+        return -1;
+    }
+
+    stodium_secure_unlock(slab);
+    stodium_secure_put(slab, block, rounded);
+    stodium_secure_lock(slab);
+    return 0;
+}
+
+/**
+ * Changes the protection of every block in a slab to STODIUM_SECURE_NOACCESS,
+ * STODIUM_SECURE_READONLY or STODIUM_SECURE_READWRITE. Returns 0 on success,
+ * -1 if the mode is invalid or the protection could not be changed.
+ */
+STODIUM_JNI(jint, stodium_1secure_1protect) (JNIEnv *jenv, jclass jcls,
+        jlong handle,
+        jint  mode) {
+    stodium_secure_slab *slab = (stodium_secure_slab *) (uintptr_t) handle;
+    if (slab == NULL || stodium_secure_mprotect(slab, mode) != 0) {
+        return -1;
+    }
+    slab->protection = mode;
+    return 0;
+}
+
 #ifdef __cplusplus
 }
 #endif
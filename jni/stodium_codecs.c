@@ -0,0 +1,244 @@
+/**
+ * This file implements the codec kernels declared in stodium_codecs.h.
+ *
+ * The character mapping is the branch-free arithmetic of libsodium's
+ * utils.c, so no table lookup or branch depends on the data. The loops over
+ * whole groups carry nothing from one iteration to the next, which lets the
+ * compiler vectorise them: the hex loops on every ABI, and the Base64 group
+ * loops, which need byte shuffles for their 3:4 interleaving, with SSSE3
+ * (the x86 baseline of Android) or NEON.
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+#include "sodium.h"
+#include "stodium_codecs.h"
+
+#define STODIUM_B64_NO_PADDING 0x2U
+#define STODIUM_B64_URLSAFE    0x4U
+
+#define STODIUM_B64_BLOCK      256
+
+// 0xFF if x == y, x < y or x > y, respectively, else 0
+#define STODIUM_EQ(x, y) ((((0U - ((unsigned int) (x) ^ (unsigned int) (y))) >> 8) & 0xFF) ^ 0xFF)
+#define STODIUM_GT(x, y) ((((unsigned int) (y) - (unsigned int) (x)) >> 8) & 0xFF)
+#define STODIUM_GE(x, y) (STODIUM_GT(y, x) ^ 0xFF)
+#define STODIUM_LT(x, y) STODIUM_GT(y, x)
+#define STODIUM_LE(x, y) STODIUM_GE(y, x)
+
+/** ****************************************************************************
+ *
+ * HEX
+ *
+ **************************************************************************** */
+
+static unsigned char stodium_hex_char(unsigned int n) {
+    return (unsigned char) (87U + n + (((n - 10U) >> 8) & ~38U));
+}
+
+/**
+ * stodium_hex_value returns the value of the hex digit c, or a value with bit
+ * 8 set if c is not one.
+ */
+static unsigned int stodium_hex_value(unsigned int c) {
+    const unsigned int num    = c ^ 48U;
+    const unsigned int num0   = ((num - 10U) >> 8) & 0xFF;
+    const unsigned int alpha  = (c & ~32U) - 55U;
+    const unsigned int alpha0 = (((alpha - 10U) ^ (alpha - 16U)) >> 8) & 0xFF;
+
+    return (((num0 & num) | (alpha0 & alpha)) & 0x0F) | ((~(num0 | alpha0) & 0xFF) << 1);
+}
+
+static size_t stodium_hex_encode(unsigned char *dst, const unsigned char *src, size_t len) {
+    size_t i;
+    for (i = 0; i < len; i++) {
+        dst[2 * i]     = stodium_hex_char(src[i] >> 4);
+        dst[2 * i + 1] = stodium_hex_char(src[i] & 0x0F);
+    }
+    return 2 * len;
+}
+
+static long stodium_hex_decode(unsigned char *dst, const unsigned char *src, size_t len) {
+    unsigned int bad = 0;
+    size_t i;
+
+    if (len % 2 != 0) {
+        return -1;
+    }
+    for (i = 0; i < len / 2; i++) {
+        const unsigned int hi = stodium_hex_value(src[2 * i]);
+        const unsigned int lo = stodium_hex_value(src[2 * i + 1]);
+        dst[i] = (unsigned char) ((hi << 4) | (lo & 0x0F));
+        bad   |= hi | lo;
+    }
+    return (bad >> 8) == 0 ? (long) (len / 2) : -1;
+}
+
+/** ****************************************************************************
+ *
+ * BASE64
+ *
+ **************************************************************************** */
+
+static unsigned char stodium_b64_char(unsigned int x, unsigned int c62, unsigned int c63) {
+    return (unsigned char) ((STODIUM_LT(x, 26) & (x + 'A'))
+            | (STODIUM_GE(x, 26) & STODIUM_LT(x, 52) & (x + ('a' - 26)))
+            | (STODIUM_GE(x, 52) & STODIUM_LT(x, 62) & (x + ('0' - 52)))
+            | (STODIUM_EQ(x, 62) & c62)
+            | (STODIUM_EQ(x, 63) & c63));
+}
+
+/**
+ * stodium_b64_value returns the value of the Base64 character c, or 0xFF if c
+ * is not one.
+ */
+static unsigned int stodium_b64_value(unsigned int c, unsigned int c62, unsigned int c63) {
+    const unsigned int x = (STODIUM_GE(c, 'A') & STODIUM_LE(c, 'Z') & (c - 'A'))
+            | (STODIUM_GE(c, 'a') & STODIUM_LE(c, 'z') & (c - ('a' - 26)))
+            | (STODIUM_GE(c, '0') & STODIUM_LE(c, '9') & (c - ('0' - 52)))
+            | (STODIUM_EQ(c, c62) & 62)
+            | (STODIUM_EQ(c, c63) & 63);
+    return x | (STODIUM_EQ(x, 0) & (STODIUM_EQ(c, 'A') ^ 0xFF));
+}
+
+static size_t stodium_b64_encode(unsigned char *dst, const unsigned char *src, size_t len,
+        unsigned int variant) {
+    const unsigned int c62 = (variant & STODIUM_B64_URLSAFE) ? '-' : '+';
+    const unsigned int c63 = (variant & STODIUM_B64_URLSAFE) ? '_' : '/';
+    const size_t groups = len / 3;
+    size_t i, out = 4 * groups;
+
+    for (i = 0; i < groups; i++) {
+        const unsigned int b0 = src[3 * i], b1 = src[3 * i + 1], b2 = src[3 * i + 2];
+        dst[4 * i]     = stodium_b64_char(b0 >> 2, c62, c63);
+        dst[4 * i + 1] = stodium_b64_char(((b0 & 0x03) << 4) | (b1 >> 4), c62, c63);
+        dst[4 * i + 2] = stodium_b64_char(((b1 & 0x0F) << 2) | (b2 >> 6), c62, c63);
+        dst[4 * i + 3] = stodium_b64_char(b2 & 0x3F, c62, c63);
+    }
+
+    if (len % 3 != 0) {
+        const unsigned int b0 = src[3 * groups];
+        const unsigned int b1 = len % 3 == 2 ? src[3 * groups + 1] : 0;
+        dst[out++] = stodium_b64_char(b0 >> 2, c62, c63);
+        dst[out++] = stodium_b64_char(((b0 & 0x03) << 4) | (b1 >> 4), c62, c63);
+        if (len % 3 == 2) {
+            dst[out++] = stodium_b64_char((b1 & 0x0F) << 2, c62, c63);
+        }
+        if ((variant & STODIUM_B64_NO_PADDING) == 0) {
+            for (; out % 4 != 0; out++) {
+                dst[out] = '=';
+            }
+        }
+    }
+    return out;
+}
+
+static long stodium_b64_decode(unsigned char *dst, const unsigned char *src, size_t len,
+        unsigned int variant) {
+    const unsigned int c62 = (variant & STODIUM_B64_URLSAFE) ? '-' : '+';
+    const unsigned int c63 = (variant & STODIUM_B64_URLSAFE) ? '_' : '/';
+    size_t groups, tail, i, out;
+    unsigned int bad = 0;
+
+    // the padding of the last group, if any, leaves a shorter tail to decode
+    tail = len % 4;
+    if ((variant & STODIUM_B64_NO_PADDING) == 0) {
+        if (tail != 0) {
+            return -1;
+        }
+        if (len >= 4 && src[len - 1] == '=') {
+            tail = src[len - 2] == '=' ? 2 : 3;
+            len -= 4;
+        }
+    } else if (tail == 1) {
+        return -1;
+    }
+    groups = (len - (len % 4)) / 4;
+
+    // the characters are mapped to their values a block at a time, so that
+    // packing the values into bytes is a separate loop that vectorises
+    for (i = 0; i < groups; i += STODIUM_B64_BLOCK / 4) {
+        unsigned char values[STODIUM_B64_BLOCK];
+        const size_t n = groups - i < STODIUM_B64_BLOCK / 4 ? groups - i : STODIUM_B64_BLOCK / 4;
+        const unsigned char *in = src + 4 * i;
+        unsigned char *o = dst + 3 * i;
+        size_t j;
+
+        for (j = 0; j < 4 * n; j++) {
+            const unsigned int v = stodium_b64_value(in[j], c62, c63);
+            values[j] = (unsigned char) v;
+            bad      |= v;
+        }
+        for (j = 0; j < n; j++) {
+            const unsigned int v0 = values[4 * j],     v1 = values[4 * j + 1];
+            const unsigned int v2 = values[4 * j + 2], v3 = values[4 * j + 3];
+            o[3 * j]     = (unsigned char) ((v0 << 2) | ((v1 >> 4) & 0x03));
+            o[3 * j + 1] = (unsigned char) ((v1 << 4) | ((v2 >> 2) & 0x0F));
+            o[3 * j + 2] = (unsigned char) ((v2 << 6) | (v3 & 0x3F));
+        }
+    }
+    out = 3 * groups;
+
+    if (tail != 0) {
+        const unsigned char *t = src + 4 * groups;
+        const unsigned int v0 = stodium_b64_value(t[0], c62, c63);
+        const unsigned int v1 = stodium_b64_value(t[1], c62, c63);
+        const unsigned int v2 = tail == 3 ? stodium_b64_value(t[2], c62, c63) : 0;
+        bad |= v0 | v1 | v2;
+        dst[out++] = (unsigned char) ((v0 << 2) | ((v1 >> 4) & 0x03));
+        if (tail == 3) {
+            dst[out++] = (unsigned char) ((v1 << 4) | ((v2 >> 2) & 0x0F));
+            bad |= ((0U - (v2 & 0x03)) >> 8) & 0xC0; // the unused bits must be zero
+        } else {
+            bad |= ((0U - (v1 & 0x0F)) >> 8) & 0xC0;
+        }
+    }
+    return (bad & 0xC0) == 0 ? (long) out : -1;
+}
+
+/** ****************************************************************************
+ *
+ * DISPATCH
+ *
+ **************************************************************************** */
+
+size_t stodium_codec_encoded_len(size_t len, int variant) {
+    if (variant == STODIUM_CODEC_HEX) {
+        return 2 * len;
+    }
+    if ((variant & STODIUM_B64_NO_PADDING) == 0) {
+        return (len + 2) / 3 * 4;
+    }
+    return len / 3 * 4 + (len % 3 == 0 ? 0 : len % 3 + 1);
+}
+
+long stodium_codec_decoded_len(const unsigned char *src, size_t len, int variant) {
+    if (variant == STODIUM_CODEC_HEX) {
+        return len % 2 == 0 ? (long) (len / 2) : -1;
+    }
+    if ((variant & STODIUM_B64_NO_PADDING) == 0) {
+        if (len % 4 != 0) {
+            return -1;
+        }
+        if (len >= 4 && src[len - 1] == '=') {
+            return (long) (len / 4 * 3 - (src[len - 2] == '=' ? 2 : 1));
+        }
+        return (long) (len / 4 * 3);
+    }
+    return len % 4 == 1 ? -1 : (long) (len / 4 * 3 + (len % 4 == 0 ? 0 : len % 4 - 1));
+}
+
+size_t stodium_codec_encode(unsigned char *dst,
+        const unsigned char *src, size_t len, int variant) {
+    if (variant == STODIUM_CODEC_HEX) {
+        return stodium_hex_encode(dst, src, len);
+    }
+    return stodium_b64_encode(dst, src, len, (unsigned int) variant);
+}
+
+long stodium_codec_decode(unsigned char *dst,
+        const unsigned char *src, size_t len, int variant) {
+    if (variant == STODIUM_CODEC_HEX) {
+        return stodium_hex_decode(dst, src, len);
+    }
+    return stodium_b64_decode(dst, src, len, (unsigned int) variant);
+}
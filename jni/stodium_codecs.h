@@ -0,0 +1,63 @@
+/**
+ * This file declares the constant-time hex and Base64 kernels behind the
+ * codecs. Unlike sodium_bin2hex and sodium_bin2base64 they write no NUL
+ * terminator and return the number of bytes written, so that the output can
+ * go straight into a caller's buffer and a stream can be encoded piece by
+ * piece.
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+#ifndef STODIUM_CODECS_H
+#define STODIUM_CODECS_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * STODIUM_CODEC_HEX is the variant of the hex codec. The Base64 variants are
+ * those of libsodium: sodium_base64_VARIANT_ORIGINAL and the others.
+ */
+#define STODIUM_CODEC_HEX 0
+
+/**
+ * stodium_codec_encoded_len returns the length of the encoding of len bytes,
+ * including the padding of the final group where the variant has it.
+ */
+size_t stodium_codec_encoded_len(size_t len, int variant);
+
+/**
+ * stodium_codec_encode writes the encoding of the len bytes at src to dst,
+ * which must have room for stodium_codec_encoded_len(len, variant) bytes, and
+ * returns the number of bytes written.
+ */
+size_t stodium_codec_encode(unsigned char *dst,
+        const unsigned char *src, size_t len, int variant);
+
+/**
+ * stodium_codec_decoded_len returns the length of the decoding of the len
+ * characters at src, or -1 if no valid encoding has that length. Only the
+ * padding at the end of src is read.
+ */
+long stodium_codec_decoded_len(const unsigned char *src, size_t len, int variant);
+
+/**
+ * stodium_codec_decode decodes the len characters at src to dst, which must
+ * have room for stodium_codec_decoded_len(src, len, variant) bytes. It returns
+ * the number of bytes written, or -1 if src is not a complete and valid
+ * encoding.
+ *
+ * The characters are examined in constant time; only the length of src and
+ * the position of the padding, which both follow from the length of the
+ * output, decide the branches taken.
+ */
+long stodium_codec_decode(unsigned char *dst,
+        const unsigned char *src, size_t len, int variant);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,177 @@
+/**
+ * This file lists the numeric constants of libsodium that are exposed through
+ * StodiumJNI, as an X-macro: STODIUM_CONSTANTS(X) expands X(type, name) for
+ * every constant, where crypto_<name>() is the libsodium function returning it
+ * and type is its JNI type. The list generates the getters, the table passed
+ * to RegisterNatives and stodium_constants, so they can not get out of sync.
+ *
+ * The order is shared with eu.artemisc.stodium.Constants; new constants are
+ * added at the end of their group in both.
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+#ifndef STODIUM_CONSTANTS_H
+#define STODIUM_CONSTANTS_H
+
+#define STODIUM_CONSTANTS(X) \
+    /* core */ \
+    X(jint,  core_hsalsa20_outputbytes) \
+    X(jint,  core_hsalsa20_inputbytes) \
+    X(jint,  core_hsalsa20_keybytes) \
+    X(jint,  core_hsalsa20_constbytes) \
+    X(jint,  core_hchacha20_outputbytes) \
+    X(jint,  core_hchacha20_inputbytes) \
+    X(jint,  core_hchacha20_keybytes) \
+    X(jint,  core_hchacha20_constbytes) \
+    /* aead */ \
+    X(jint,  aead_aes256gcm_keybytes) \
+    X(jint,  aead_aes256gcm_nsecbytes) \
+    X(jint,  aead_aes256gcm_npubbytes) \
+    X(jint,  aead_aes256gcm_abytes) \
+    X(jint,  aead_chacha20poly1305_keybytes) \
+    X(jint,  aead_chacha20poly1305_nsecbytes) \
+    X(jint,  aead_chacha20poly1305_npubbytes) \
+    X(jint,  aead_chacha20poly1305_abytes) \
+    X(jint,  aead_chacha20poly1305_ietf_keybytes) \
+    X(jint,  aead_chacha20poly1305_ietf_nsecbytes) \
+    X(jint,  aead_chacha20poly1305_ietf_npubbytes) \
+    X(jint,  aead_chacha20poly1305_ietf_abytes) \
+    X(jint,  aead_xchacha20poly1305_ietf_keybytes) \
+    X(jint,  aead_xchacha20poly1305_ietf_nsecbytes) \
+    X(jint,  aead_xchacha20poly1305_ietf_npubbytes) \
+    X(jint,  aead_xchacha20poly1305_ietf_abytes) \
+    /* auth */ \
+    X(jint,  auth_hmacsha256_bytes) \
+    X(jint,  auth_hmacsha256_keybytes) \
+    X(jint,  auth_hmacsha256_statebytes) \
+    X(jint,  auth_hmacsha512_bytes) \
+    X(jint,  auth_hmacsha512_keybytes) \
+    X(jint,  auth_hmacsha512_statebytes) \
+    X(jint,  auth_hmacsha512256_bytes) \
+    X(jint,  auth_hmacsha512256_keybytes) \
+    X(jint,  auth_hmacsha512256_statebytes) \
+    /* box */ \
+    X(jint,  box_sealbytes) \
+    X(jint,  box_curve25519xsalsa20poly1305_seedbytes) \
+    X(jint,  box_curve25519xsalsa20poly1305_publickeybytes) \
+    X(jint,  box_curve25519xsalsa20poly1305_secretkeybytes) \
+    X(jint,  box_curve25519xsalsa20poly1305_beforenmbytes) \
+    X(jint,  box_curve25519xsalsa20poly1305_noncebytes) \
+    X(jint,  box_curve25519xsalsa20poly1305_zerobytes) \
+    X(jint,  box_curve25519xsalsa20poly1305_boxzerobytes) \
+    X(jint,  box_curve25519xsalsa20poly1305_macbytes) \
+    X(jint,  box_curve25519xchacha20poly1305_seedbytes) \
+    X(jint,  box_curve25519xchacha20poly1305_publickeybytes) \
+    X(jint,  box_curve25519xchacha20poly1305_secretkeybytes) \
+    X(jint,  box_curve25519xchacha20poly1305_beforenmbytes) \
+    X(jint,  box_curve25519xchacha20poly1305_noncebytes) \
+    X(jint,  box_curve25519xchacha20poly1305_macbytes) \
+    /* generichash */ \
+    X(jint,  generichash_blake2b_bytes) \
+    X(jint,  generichash_blake2b_bytes_min) \
+    X(jint,  generichash_blake2b_bytes_max) \
+    X(jint,  generichash_blake2b_keybytes) \
+    X(jint,  generichash_blake2b_keybytes_min) \
+    X(jint,  generichash_blake2b_keybytes_max) \
+    X(jint,  generichash_blake2b_personalbytes) \
+    X(jint,  generichash_blake2b_saltbytes) \
+    X(jint,  generichash_blake2b_statebytes) \
+    /* hash */ \
+    X(jint,  hash_sha256_bytes) \
+    X(jint,  hash_sha256_statebytes) \
+    X(jint,  hash_sha512_bytes) \
+    X(jint,  hash_sha512_statebytes) \
+    /* kdf */ \
+    X(jint,  kdf_blake2b_bytes_min) \
+    X(jint,  kdf_blake2b_bytes_max) \
+    X(jint,  kdf_blake2b_contextbytes) \
+    X(jint,  kdf_blake2b_keybytes) \
+    /* kx */ \
+    X(jint,  kx_publickeybytes) \
+    X(jint,  kx_secretkeybytes) \
+    X(jint,  kx_seedbytes) \
+    X(jint,  kx_sessionkeybytes) \
+    /* onetimeauth */ \
+    X(jint,  onetimeauth_poly1305_bytes) \
+    X(jint,  onetimeauth_poly1305_keybytes) \
+    X(jint,  onetimeauth_poly1305_statebytes) \
+    /* pwhash */ \
+    X(jlong, pwhash_argon2i_bytes_min) \
+    X(jlong, pwhash_argon2i_bytes_max) \
+    X(jlong, pwhash_argon2i_passwd_min) \
+    X(jlong, pwhash_argon2i_passwd_max) \
+    X(jint,  pwhash_argon2i_saltbytes) \
+    X(jint,  pwhash_argon2i_strbytes) \
+    X(jlong, pwhash_argon2i_opslimit_min) \
+    X(jlong, pwhash_argon2i_opslimit_max) \
+    X(jlong, pwhash_argon2i_memlimit_min) \
+    X(jlong, pwhash_argon2i_memlimit_max) \
+    X(jlong, pwhash_argon2i_opslimit_interactive) \
+    X(jlong, pwhash_argon2i_memlimit_interactive) \
+    X(jlong, pwhash_argon2i_opslimit_moderate) \
+    X(jlong, pwhash_argon2i_memlimit_moderate) \
+    X(jlong, pwhash_argon2i_opslimit_sensitive) \
+    X(jlong, pwhash_argon2i_memlimit_sensitive) \
+    X(jlong, pwhash_argon2id_bytes_min) \
+    X(jlong, pwhash_argon2id_bytes_max) \
+    X(jlong, pwhash_argon2id_passwd_min) \
+    X(jlong, pwhash_argon2id_passwd_max) \
+    X(jint,  pwhash_argon2id_saltbytes) \
+    X(jint,  pwhash_argon2id_strbytes) \
+    X(jlong, pwhash_argon2id_opslimit_min) \
+    X(jlong, pwhash_argon2id_opslimit_max) \
+    X(jlong, pwhash_argon2id_memlimit_min) \
+    X(jlong, pwhash_argon2id_memlimit_max) \
+    X(jlong, pwhash_argon2id_opslimit_interactive) \
+    X(jlong, pwhash_argon2id_memlimit_interactive) \
+    X(jlong, pwhash_argon2id_opslimit_moderate) \
+    X(jlong, pwhash_argon2id_memlimit_moderate) \
+    X(jlong, pwhash_argon2id_opslimit_sensitive) \
+    X(jlong, pwhash_argon2id_memlimit_sensitive) \
+    X(jlong, pwhash_scryptsalsa208sha256_bytes_min) \
+    X(jlong, pwhash_scryptsalsa208sha256_bytes_max) \
+    X(jlong, pwhash_scryptsalsa208sha256_passwd_min) \
+    X(jlong, pwhash_scryptsalsa208sha256_passwd_max) \
+    X(jint,  pwhash_scryptsalsa208sha256_saltbytes) \
+    X(jint,  pwhash_scryptsalsa208sha256_strbytes) \
+    X(jlong, pwhash_scryptsalsa208sha256_opslimit_min) \
+    X(jlong, pwhash_scryptsalsa208sha256_opslimit_max) \
+    X(jlong, pwhash_scryptsalsa208sha256_memlimit_min) \
+    X(jlong, pwhash_scryptsalsa208sha256_memlimit_max) \
+    X(jlong, pwhash_scryptsalsa208sha256_opslimit_interactive) \
+    X(jlong, pwhash_scryptsalsa208sha256_memlimit_interactive) \
+    X(jlong, pwhash_scryptsalsa208sha256_opslimit_sensitive) \
+    X(jlong, pwhash_scryptsalsa208sha256_memlimit_sensitive) \
+    /* scalarmult */ \
+    X(jint,  scalarmult_curve25519_bytes) \
+    X(jint,  scalarmult_curve25519_scalarbytes) \
+    /* secretbox */ \
+    X(jint,  secretbox_xsalsa20poly1305_keybytes) \
+    X(jint,  secretbox_xsalsa20poly1305_macbytes) \
+    X(jint,  secretbox_xsalsa20poly1305_noncebytes) \
+    X(jint,  secretbox_xchacha20poly1305_keybytes) \
+    X(jint,  secretbox_xchacha20poly1305_macbytes) \
+    X(jint,  secretbox_xchacha20poly1305_noncebytes) \
+    /* secretstream */ \
+    X(jint,  secretstream_xchacha20poly1305_abytes) \
+    X(jint,  secretstream_xchacha20poly1305_headerbytes) \
+    X(jint,  secretstream_xchacha20poly1305_keybytes) \
+    X(jint,  secretstream_xchacha20poly1305_statebytes) \
+    X(jlong, secretstream_xchacha20poly1305_messagebytes_max) \
+    X(jint,  secretstream_xchacha20poly1305_tag_message) \
+    X(jint,  secretstream_xchacha20poly1305_tag_push) \
+    X(jint,  secretstream_xchacha20poly1305_tag_rekey) \
+    X(jint,  secretstream_xchacha20poly1305_tag_final) \
+    /* shorthash */ \
+    X(jint,  shorthash_siphash24_bytes) \
+    X(jint,  shorthash_siphash24_keybytes) \
+    X(jint,  shorthash_siphashx24_bytes) \
+    X(jint,  shorthash_siphashx24_keybytes) \
+    /* sign */ \
+    X(jint,  sign_ed25519_publickeybytes) \
+    X(jint,  sign_ed25519_secretkeybytes) \
+    X(jint,  sign_ed25519_bytes) \
+    X(jint,  sign_ed25519_seedbytes) \
+    X(jint,  sign_ed25519ph_statebytes)
+
+#endif
@@ -0,0 +1,218 @@
+/**
+ * This file implements the native worker pool declared in stodium_pool.h.
+ *
+ * A batch is split into chunks of a fixed number of items. Idle threads take
+ * the next chunk from the shared cursor of the running batch, so faster
+ * threads naturally take more chunks than slower ones.
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+#include <pthread.h>
+#include <stdlib.h>
+
+#include "stodium_pool.h"
+
+/**
+ * stodium_pool_job is the batch the pool is currently working on. It lives on
+ * the stack of the thread that called stodium_pool_run.
+ */
+typedef struct stodium_pool_job {
+    stodium_pool_task task;
+    void             *ctx;
+    size_t            count;
+    size_t            grain;
+    size_t            next;      // The first item that was not handed out yet
+    size_t            remaining; // The number of items that did not finish yet
+} stodium_pool_job;
+
+/**
+ * The state of the pool is guarded by stodium_pool_mutex. stodium_pool_busy
+ * is held by the thread that runs a batch, or that starts or stops the pool.
+ */
+static pthread_mutex_t   stodium_pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t   stodium_pool_busy  = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t    stodium_pool_work  = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t    stodium_pool_done  = PTHREAD_COND_INITIALIZER;
+static pthread_t        *stodium_pool_threads;
+static size_t            stodium_pool_threads_len;
+static stodium_pool_job *stodium_pool_current;
+static bool              stodium_pool_stopping;
+
+/**
+ * stodium_pool_take hands out the next chunk of job, if any. Must be called
+ * with stodium_pool_mutex held.
+ */
+static bool stodium_pool_take(stodium_pool_job *job, size_t *begin, size_t *end) {
+    if (job->next >= job->count) {
+        return false;
+    }
+
+    *begin    = job->next;
+    *end      = job->count - *begin > job->grain ? *begin + job->grain : job->count;
+    job->next = *end;
+    return true;
+}
+
+/**
+ * stodium_pool_finish marks a chunk of job as handled. Must be called with
+ * stodium_pool_mutex held.
+ */
+static void stodium_pool_finish(stodium_pool_job *job, size_t begin, size_t end) {
+    job->remaining -= end - begin;
+    if (job->remaining == 0) {
+        pthread_cond_broadcast(&stodium_pool_done);
+    }
+}
+
+static void *stodium_pool_worker(void *arg) {
+    size_t begin, end;
+
+    pthread_mutex_lock(&stodium_pool_mutex);
+    while (!stodium_pool_stopping) {
+        stodium_pool_job *job = stodium_pool_current;
+        if (job == NULL || !stodium_pool_take(job, &begin, &end)) {
+            pthread_cond_wait(&stodium_pool_work, &stodium_pool_mutex);
+            continue;
+        }
+
+        pthread_mutex_unlock(&stodium_pool_mutex);
+        job->task(job->ctx, begin, end);
+        pthread_mutex_lock(&stodium_pool_mutex);
+
+        stodium_pool_finish(job, begin, end);
+    }
+    pthread_mutex_unlock(&stodium_pool_mutex);
+
+    return NULL;
+}
+
+/**
+ * stodium_pool_join stops and joins the first len threads of the pool. Must be
+ * called with stodium_pool_busy held.
+ */
+static void stodium_pool_join(size_t len) {
+    size_t i;
+
+    pthread_mutex_lock(&stodium_pool_mutex);
+    stodium_pool_stopping = true;
+    pthread_cond_broadcast(&stodium_pool_work);
+    pthread_mutex_unlock(&stodium_pool_mutex);
+
+    for (i = 0; i < len; i++) {
+        pthread_join(stodium_pool_threads[i], NULL);
+    }
+
+    pthread_mutex_lock(&stodium_pool_mutex);
+    free(stodium_pool_threads);
+    stodium_pool_threads     = NULL;
+    stodium_pool_threads_len = 0;
+    stodium_pool_stopping    = false;
+    pthread_mutex_unlock(&stodium_pool_mutex);
+}
+
+bool stodium_pool_start(size_t threads) {
+    pthread_t *started;
+    size_t i;
+
+    if (threads == 0) {
+        return false;
+    }
+
+    pthread_mutex_lock(&stodium_pool_busy);
+    if (stodium_pool_threads != NULL) {
+        pthread_mutex_unlock(&stodium_pool_busy);
+        return false;
+    }
+
+    started = (pthread_t *) calloc(threads, sizeof(pthread_t));
+    if (started == NULL) {
+        pthread_mutex_unlock(&stodium_pool_busy);
+        return false;
+    }
+    stodium_pool_threads = started;
+
+    for (i = 0; i < threads; i++) {
+        if (pthread_create(&started[i], NULL, stodium_pool_worker, NULL) != 0) {
+            stodium_pool_join(i);
+            pthread_mutex_unlock(&stodium_pool_busy);
+            return false;
+        }
+    }
+
+    pthread_mutex_lock(&stodium_pool_mutex);
+    stodium_pool_threads_len = threads;
+    pthread_mutex_unlock(&stodium_pool_mutex);
+
+    pthread_mutex_unlock(&stodium_pool_busy);
+    return true;
+}
+
+void stodium_pool_stop(void) {
+    pthread_mutex_lock(&stodium_pool_busy);
+    if (stodium_pool_threads != NULL) {
+        stodium_pool_join(stodium_pool_threads_len);
+    }
+    pthread_mutex_unlock(&stodium_pool_busy);
+}
+
+size_t stodium_pool_size(void) {
+    size_t len;
+
+    pthread_mutex_lock(&stodium_pool_mutex);
+    len = stodium_pool_threads_len;
+    pthread_mutex_unlock(&stodium_pool_mutex);
+
+    return len;
+}
+
+void stodium_pool_run(stodium_pool_task task, void *ctx, size_t count, size_t grain) {
+    stodium_pool_job job;
+    size_t begin, end;
+
+    if (count == 0) {
+        return;
+    }
+    if (grain == 0) {
+        grain = 1;
+    }
+
+    // Small batches, or batches arriving while the pool is busy, are handled
+    // by the calling thread alone
+    if (count <= grain || pthread_mutex_trylock(&stodium_pool_busy) != 0) {
+        task(ctx, 0, count);
+        return;
+    }
+
+    pthread_mutex_lock(&stodium_pool_mutex);
+    if (stodium_pool_threads_len == 0) {
+        pthread_mutex_unlock(&stodium_pool_mutex);
+        pthread_mutex_unlock(&stodium_pool_busy);
+        task(ctx, 0, count);
+        return;
+    }
+
+    job.task      = task;
+    job.ctx       = ctx;
+    job.count     = count;
+    job.grain     = grain;
+    job.next      = 0;
+    job.remaining = count;
+
+    stodium_pool_current = &job;
+    pthread_cond_broadcast(&stodium_pool_work);
+
+    while (stodium_pool_take(&job, &begin, &end)) {
+        pthread_mutex_unlock(&stodium_pool_mutex);
+        task(ctx, begin, end);
+        pthread_mutex_lock(&stodium_pool_mutex);
+
+        stodium_pool_finish(&job, begin, end);
+    }
+    while (job.remaining > 0) {
+        pthread_cond_wait(&stodium_pool_done, &stodium_pool_mutex);
+    }
+
+    stodium_pool_current = NULL;
+    pthread_mutex_unlock(&stodium_pool_mutex);
+    pthread_mutex_unlock(&stodium_pool_busy);
+}
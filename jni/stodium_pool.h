@@ -0,0 +1,60 @@
+/**
+ * This file declares the native worker pool used to spread batches of
+ * independent operations over multiple cores within a single JNI call.
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+#ifndef STODIUM_POOL_H
+#define STODIUM_POOL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * STODIUM_POOL_GRAIN is the number of items of a batch that are handed to a
+ * thread at once; batches of at most this many items are not split at all.
+ */
+#define STODIUM_POOL_GRAIN 64
+
+/**
+ * stodium_pool_task handles the items [begin, end) of a batch. Tasks run on
+ * threads that are not attached to the JVM, so they must not use JNI.
+ * begin is always a multiple of the grain passed to stodium_pool_run.
+ */
+typedef void (*stodium_pool_task)(void *ctx, size_t begin, size_t end);
+
+/**
+ * stodium_pool_start starts a pool of threads worker threads. Returns false if
+ * a pool is already running, or if the threads could not be created.
+ */
+bool stodium_pool_start(size_t threads);
+
+/**
+ * stodium_pool_stop stops the worker threads, after the running batch (if
+ * any) has finished.
+ */
+void stodium_pool_stop(void);
+
+/**
+ * stodium_pool_size returns the number of worker threads, 0 if no pool is
+ * running.
+ */
+size_t stodium_pool_size(void);
+
+/**
+ * stodium_pool_run runs task over the items [0, count) in chunks of grain
+ * items, and returns when all items were handled. The calling thread works on
+ * the batch as well. If no pool is running, or the pool is busy with another
+ * batch, the calling thread handles the whole batch by itself.
+ */
+void stodium_pool_run(stodium_pool_task task, void *ctx, size_t count, size_t grain);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
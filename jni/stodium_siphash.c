@@ -0,0 +1,204 @@
+/**
+ * This file implements the multi-lane SipHash kernels declared in
+ * stodium_siphash.h.
+ *
+ * A single SipHash is a chain of dependent 64-bit additions, rotations and
+ * xors, which leaves most of a core idle. The kernels run the rounds of 2 or
+ * 4 messages side by side in the lanes of a vector register instead. The
+ * kernel is picked once, at the first batch: AVX2 if the CPU supports it,
+ * else SSE2 on 32-bit x86 or NEON, else a scalar loop. On x86-64 two SSE2
+ * lanes are no faster than the scalar loop, whose 64-bit rounds the core
+ * already overlaps, so it is only used where scalar 64-bit arithmetic is
+ * split over register pairs.
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+#include <pthread.h>
+#include <string.h>
+
+#include "sodium.h"
+#include "stodium_siphash.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#include <immintrin.h>
+#define STODIUM_SIPHASH_X86 1
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define STODIUM_SIPHASH_NEON 1
+#endif
+
+#define STODIUM_ROTL64(x, n) (((x) << (n)) | ((x) >> (64 - (n))))
+
+static uint64_t stodium_load64_le(const unsigned char *p) {
+    uint64_t w;
+    memcpy(&w, p, sizeof w);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    w = __builtin_bswap64(w);
+#endif
+    return w;
+}
+
+/**
+ * stodium_siphash_last_block returns the final block of a message: its last
+ * len % 8 bytes, with the low byte of len in the top byte.
+ */
+static uint64_t stodium_siphash_last_block(const unsigned char *tail, size_t len) {
+    uint64_t b = ((uint64_t) len) << 56;
+    switch (len & 7) {
+    case 7: b |= ((uint64_t) tail[6]) << 48; // fallthrough
+    case 6: b |= ((uint64_t) tail[5]) << 40; // fallthrough
+    case 5: b |= ((uint64_t) tail[4]) << 32; // fallthrough
+    case 4: b |= ((uint64_t) tail[3]) << 24; // fallthrough
+    case 3: b |= ((uint64_t) tail[2]) << 16; // fallthrough
+    case 2: b |= ((uint64_t) tail[1]) << 8;  // fallthrough
+    case 1: b |= ((uint64_t) tail[0]);
+    }
+    return b;
+}
+
+static void stodium_siphash_round(uint64_t *v) {
+    v[0] += v[1]; v[1] = STODIUM_ROTL64(v[1], 13); v[1] ^= v[0]; v[0] = STODIUM_ROTL64(v[0], 32);
+    v[2] += v[3]; v[3] = STODIUM_ROTL64(v[3], 16); v[3] ^= v[2];
+    v[0] += v[3]; v[3] = STODIUM_ROTL64(v[3], 21); v[3] ^= v[0];
+    v[2] += v[1]; v[1] = STODIUM_ROTL64(v[1], 17); v[1] ^= v[2]; v[2] = STODIUM_ROTL64(v[2], 32);
+}
+
+static void stodium_siphash_compress(uint64_t *v, uint64_t m) {
+    v[3] ^= m;
+    stodium_siphash_round(v);
+    stodium_siphash_round(v);
+    v[0] ^= m;
+}
+
+/**
+ * stodium_siphash_finish continues the state v over the rest bytes at m,
+ * the remainder of a message of len bytes, and writes the output.
+ */
+static void stodium_siphash_finish(uint64_t *out, size_t words, uint64_t *v,
+        const unsigned char *m, size_t rest, size_t len) {
+    for (; rest >= 8; rest -= 8, m += 8) {
+        stodium_siphash_compress(v, stodium_load64_le(m));
+    }
+    stodium_siphash_compress(v, stodium_siphash_last_block(m, len));
+
+    v[2] ^= words == 2 ? 0xee : 0xff;
+    stodium_siphash_round(v);
+    stodium_siphash_round(v);
+    stodium_siphash_round(v);
+    stodium_siphash_round(v);
+    out[0] = v[0] ^ v[1] ^ v[2] ^ v[3];
+
+    if (words == 2) {
+        v[1] ^= 0xdd;
+        stodium_siphash_round(v);
+        stodium_siphash_round(v);
+        stodium_siphash_round(v);
+        stodium_siphash_round(v);
+        out[1] = v[0] ^ v[1] ^ v[2] ^ v[3];
+    }
+}
+
+typedef void (*stodium_siphash_kernel)(uint64_t *out, size_t words,
+        const unsigned char *src, const int32_t *table, size_t count,
+        const uint64_t *init);
+
+static void stodium_siphash_scalar(uint64_t *out, size_t words,
+        const unsigned char *src, const int32_t *table, size_t count,
+        const uint64_t *init) {
+    size_t i;
+    for (i = 0; i < count; i++) {
+        uint64_t v[4] = { init[0], init[1], init[2], init[3] };
+        stodium_siphash_finish(out + i * words, words, v,
+                src + table[2 * i], (size_t) table[2 * i + 1], (size_t) table[2 * i + 1]);
+    }
+}
+
+#if defined(STODIUM_SIPHASH_X86) && defined(__i386__)
+#define STODIUM_LANES_NAME          stodium_siphash_sse2
+#define STODIUM_LANES_WIDTH         2
+#define STODIUM_LANES_ATTRIBUTES    __attribute__((target("sse2")))
+#define STODIUM_VEC                 __m128i
+#define STODIUM_VEC_SET1(x)         _mm_set1_epi64x((long long) (x))
+#define STODIUM_VEC_LOAD(p)         _mm_loadu_si128((const __m128i *) (const void *) (p))
+#define STODIUM_VEC_STORE(p, v)     _mm_storeu_si128((__m128i *) (void *) (p), (v))
+#define STODIUM_VEC_ADD(a, b)       _mm_add_epi64((a), (b))
+#define STODIUM_VEC_XOR(a, b)       _mm_xor_si128((a), (b))
+#define STODIUM_VEC_ROTL(v, n)      _mm_or_si128(_mm_slli_epi64((v), (n)), _mm_srli_epi64((v), 64 - (n)))
+#define STODIUM_VEC_ROTL32(v)       _mm_shuffle_epi32((v), _MM_SHUFFLE(2, 3, 0, 1))
+#include "stodium_siphash_lanes.h"
+#endif
+
+#ifdef STODIUM_SIPHASH_X86
+#define STODIUM_LANES_NAME          stodium_siphash_avx2
+#define STODIUM_LANES_WIDTH         4
+#define STODIUM_LANES_ATTRIBUTES    __attribute__((target("avx2")))
+#define STODIUM_VEC                 __m256i
+#define STODIUM_VEC_SET1(x)         _mm256_set1_epi64x((long long) (x))
+#define STODIUM_VEC_LOAD(p)         _mm256_loadu_si256((const __m256i *) (const void *) (p))
+#define STODIUM_VEC_STORE(p, v)     _mm256_storeu_si256((__m256i *) (void *) (p), (v))
+#define STODIUM_VEC_ADD(a, b)       _mm256_add_epi64((a), (b))
+#define STODIUM_VEC_XOR(a, b)       _mm256_xor_si256((a), (b))
+#define STODIUM_VEC_ROTL(v, n)      _mm256_or_si256(_mm256_slli_epi64((v), (n)), _mm256_srli_epi64((v), 64 - (n)))
+#define STODIUM_VEC_ROTL32(v)       _mm256_shuffle_epi32((v), _MM_SHUFFLE(2, 3, 0, 1))
+#include "stodium_siphash_lanes.h"
+#endif
+
+#ifdef STODIUM_SIPHASH_NEON
+#define STODIUM_LANES_NAME          stodium_siphash_neon
+#define STODIUM_LANES_WIDTH         2
+#define STODIUM_LANES_ATTRIBUTES
+#define STODIUM_VEC                 uint64x2_t
+#define STODIUM_VEC_SET1(x)         vdupq_n_u64((uint64_t) (x))
+#define STODIUM_VEC_LOAD(p)         vld1q_u64(p)
+#define STODIUM_VEC_STORE(p, v)     vst1q_u64((p), (v))
+#define STODIUM_VEC_ADD(a, b)       vaddq_u64((a), (b))
+#define STODIUM_VEC_XOR(a, b)       veorq_u64((a), (b))
+#define STODIUM_VEC_ROTL(v, n)      vorrq_u64(vshlq_n_u64((v), (n)), vshrq_n_u64((v), 64 - (n)))
+#define STODIUM_VEC_ROTL32(v)       vreinterpretq_u64_u32(vrev64q_u32(vreinterpretq_u32_u64(v)))
+#include "stodium_siphash_lanes.h"
+#endif
+
+static stodium_siphash_kernel stodium_siphash_selected = stodium_siphash_scalar;
+static size_t                 stodium_siphash_width    = 1;
+static pthread_once_t         stodium_siphash_once     = PTHREAD_ONCE_INIT;
+
+static void stodium_siphash_select(void) {
+#ifdef STODIUM_SIPHASH_X86
+    if (sodium_runtime_has_avx2()) {
+        stodium_siphash_selected = stodium_siphash_avx2;
+        stodium_siphash_width    = 4;
+    }
+#if defined(__i386__)
+    else if (sodium_runtime_has_sse2()) {
+        stodium_siphash_selected = stodium_siphash_sse2;
+        stodium_siphash_width    = 2;
+    }
+#endif
+#elif defined(STODIUM_SIPHASH_NEON)
+    stodium_siphash_selected = stodium_siphash_neon;
+    stodium_siphash_width    = 2;
+#endif
+}
+
+size_t stodium_siphash_lanes(void) {
+    pthread_once(&stodium_siphash_once, stodium_siphash_select);
+    return stodium_siphash_width;
+}
+
+void stodium_siphash_batch(uint64_t *out, size_t words,
+        const unsigned char *src, const int32_t *table, size_t count,
+        const unsigned char *key) {
+    const uint64_t k0 = stodium_load64_le(key);
+    const uint64_t k1 = stodium_load64_le(key + 8);
+    const uint64_t init[4] = {
+        k0 ^ 0x736f6d6570736575ULL,
+        k1 ^ 0x646f72616e646f6dULL ^ (words == 2 ? 0xee : 0),
+        k0 ^ 0x6c7967656e657261ULL,
+        k1 ^ 0x7465646279746573ULL,
+    };
+
+    pthread_once(&stodium_siphash_once, stodium_siphash_select);
+    stodium_siphash_selected(out, words, src, table, count, init);
+}
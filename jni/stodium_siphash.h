@@ -0,0 +1,42 @@
+/**
+ * This file declares the multi-lane SipHash kernels behind the shorthash batch
+ * methods. They compute the same values as crypto_shorthash_siphash24 and
+ * crypto_shorthash_siphashx24, for many messages under a single key.
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+#ifndef STODIUM_SIPHASH_H
+#define STODIUM_SIPHASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * stodium_siphash_batch hashes count messages with the 16 byte key. The table
+ * holds an (offset, length) pair for every message in src, which the caller
+ * has checked to lie within src.
+ *
+ * With words 1, the SipHash-2-4 of every message is written to out; with words
+ * 2, its SipHash-x-2-4, as two words. A word is the little-endian reading of 8
+ * bytes of the libsodium output, in native byte order.
+ */
+void stodium_siphash_batch(uint64_t *out, size_t words,
+        const unsigned char *src, const int32_t *table, size_t count,
+        const unsigned char *key);
+
+/**
+ * stodium_siphash_lanes returns the number of messages the kernel picked at
+ * runtime hashes at once: 4 with AVX2, 2 with SSE2
+ * (32-bit x86 only) or NEON, 1 otherwise.
+ */
+size_t stodium_siphash_lanes(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
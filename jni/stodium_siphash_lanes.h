@@ -0,0 +1,147 @@
+/**
+ * This file is the template of a multi-lane SipHash kernel, included by
+ * stodium_siphash.c once for every instruction set. Before including it, the
+ * following must be defined:
+ *
+ * STODIUM_LANES_NAME         the name of the kernel function
+ * STODIUM_LANES_WIDTH        the number of 64-bit lanes of a vector
+ * STODIUM_LANES_ATTRIBUTES   the function attributes (e.g. a target) or nothing
+ * STODIUM_VEC                the vector type
+ * STODIUM_VEC_SET1(x)        broadcasts a uint64_t to every lane
+ * STODIUM_VEC_LOAD(p)        loads WIDTH uint64_t from p
+ * STODIUM_VEC_STORE(p, v)    stores WIDTH uint64_t to p
+ * STODIUM_VEC_ADD(a, b)      adds the lanes of a and b
+ * STODIUM_VEC_XOR(a, b)      xors the lanes of a and b
+ * STODIUM_VEC_ROTL(v, n)     rotates the lanes of v left by n bits, n != 32
+ * STODIUM_VEC_ROTL32(v)      rotates the lanes of v by 32 bits
+ *
+ * All of them are undefined again at the end of this file.
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+
+#define STODIUM_VEC_ROUND(v0, v1, v2, v3) do { \
+        v0 = STODIUM_VEC_ADD(v0, v1); v1 = STODIUM_VEC_ROTL(v1, 13); \
+        v1 = STODIUM_VEC_XOR(v1, v0); v0 = STODIUM_VEC_ROTL32(v0); \
+        v2 = STODIUM_VEC_ADD(v2, v3); v3 = STODIUM_VEC_ROTL(v3, 16); \
+        v3 = STODIUM_VEC_XOR(v3, v2); \
+        v0 = STODIUM_VEC_ADD(v0, v3); v3 = STODIUM_VEC_ROTL(v3, 21); \
+        v3 = STODIUM_VEC_XOR(v3, v0); \
+        v2 = STODIUM_VEC_ADD(v2, v1); v1 = STODIUM_VEC_ROTL(v1, 17); \
+        v1 = STODIUM_VEC_XOR(v1, v2); v2 = STODIUM_VEC_ROTL32(v2); \
+    } while (0)
+
+#define STODIUM_VEC_COMPRESS(v0, v1, v2, v3, m) do { \
+        v3 = STODIUM_VEC_XOR(v3, m); \
+        STODIUM_VEC_ROUND(v0, v1, v2, v3); \
+        STODIUM_VEC_ROUND(v0, v1, v2, v3); \
+        v0 = STODIUM_VEC_XOR(v0, m); \
+    } while (0)
+
+/**
+ * The kernel hashes the messages WIDTH at a time. Messages of the same length
+ * (the common case for hash table keys) are hashed in the lanes from the first
+ * block to the output; otherwise only the blocks they all have are, and every
+ * message is finished on its own.
+ */
+STODIUM_LANES_ATTRIBUTES
+static void STODIUM_LANES_NAME(uint64_t *out, size_t words,
+        const unsigned char *src, const int32_t *table, size_t count,
+        const uint64_t *init) {
+    uint64_t block[STODIUM_LANES_WIDTH];
+    uint64_t state[4][STODIUM_LANES_WIDTH];
+    const unsigned char *m[STODIUM_LANES_WIDTH];
+    size_t len[STODIUM_LANES_WIDTH];
+    size_t i, b, l;
+
+    for (i = 0; i + STODIUM_LANES_WIDTH <= count; i += STODIUM_LANES_WIDTH) {
+        size_t blocks_min = SIZE_MAX, blocks_max = 0;
+        for (l = 0; l < STODIUM_LANES_WIDTH; l++) {
+            m[l]   = src + table[2 * (i + l)];
+            len[l] = (size_t) table[2 * (i + l) + 1];
+            if (len[l] / 8 < blocks_min) {
+                blocks_min = len[l] / 8;
+            }
+            if (len[l] / 8 > blocks_max) {
+                blocks_max = len[l] / 8;
+            }
+        }
+
+        STODIUM_VEC v0 = STODIUM_VEC_SET1(init[0]);
+        STODIUM_VEC v1 = STODIUM_VEC_SET1(init[1]);
+        STODIUM_VEC v2 = STODIUM_VEC_SET1(init[2]);
+        STODIUM_VEC v3 = STODIUM_VEC_SET1(init[3]);
+        STODIUM_VEC mv;
+
+        for (b = 0; b < blocks_min; b++) {
+            for (l = 0; l < STODIUM_LANES_WIDTH; l++) {
+                block[l] = stodium_load64_le(m[l] + 8 * b);
+            }
+            mv = STODIUM_VEC_LOAD(block);
+            STODIUM_VEC_COMPRESS(v0, v1, v2, v3, mv);
+        }
+
+        if (blocks_min != blocks_max) {
+            STODIUM_VEC_STORE(state[0], v0);
+            STODIUM_VEC_STORE(state[1], v1);
+            STODIUM_VEC_STORE(state[2], v2);
+            STODIUM_VEC_STORE(state[3], v3);
+            for (l = 0; l < STODIUM_LANES_WIDTH; l++) {
+                uint64_t v[4] = { state[0][l], state[1][l], state[2][l], state[3][l] };
+                stodium_siphash_finish(out + (i + l) * words, words, v,
+                        m[l] + 8 * blocks_min, len[l] - 8 * blocks_min, len[l]);
+            }
+            continue;
+        }
+
+        // the last block, holding the tail and the length of every message
+        for (l = 0; l < STODIUM_LANES_WIDTH; l++) {
+            block[l] = stodium_siphash_last_block(m[l] + 8 * blocks_min, len[l]);
+        }
+        mv = STODIUM_VEC_LOAD(block);
+        STODIUM_VEC_COMPRESS(v0, v1, v2, v3, mv);
+
+        v2 = STODIUM_VEC_XOR(v2, STODIUM_VEC_SET1(words == 2 ? 0xee : 0xff));
+        STODIUM_VEC_ROUND(v0, v1, v2, v3);
+        STODIUM_VEC_ROUND(v0, v1, v2, v3);
+        STODIUM_VEC_ROUND(v0, v1, v2, v3);
+        STODIUM_VEC_ROUND(v0, v1, v2, v3);
+        STODIUM_VEC_STORE(state[0], STODIUM_VEC_XOR(STODIUM_VEC_XOR(v0, v1), STODIUM_VEC_XOR(v2, v3)));
+
+        if (words == 2) {
+            v1 = STODIUM_VEC_XOR(v1, STODIUM_VEC_SET1(0xdd));
+            STODIUM_VEC_ROUND(v0, v1, v2, v3);
+            STODIUM_VEC_ROUND(v0, v1, v2, v3);
+            STODIUM_VEC_ROUND(v0, v1, v2, v3);
+            STODIUM_VEC_ROUND(v0, v1, v2, v3);
+            STODIUM_VEC_STORE(state[1], STODIUM_VEC_XOR(STODIUM_VEC_XOR(v0, v1), STODIUM_VEC_XOR(v2, v3)));
+        }
+
+        for (l = 0; l < STODIUM_LANES_WIDTH; l++) {
+            out[(i + l) * words] = state[0][l];
+            if (words == 2) {
+                out[(i + l) * words + 1] = state[1][l];
+            }
+        }
+    }
+
+    for (; i < count; i++) {
+        uint64_t v[4] = { init[0], init[1], init[2], init[3] };
+        stodium_siphash_finish(out + i * words, words, v,
+                src + table[2 * i], (size_t) table[2 * i + 1], (size_t) table[2 * i + 1]);
+    }
+}
+
+#undef STODIUM_VEC_COMPRESS
+#undef STODIUM_VEC_ROUND
+#undef STODIUM_LANES_NAME
+#undef STODIUM_LANES_WIDTH
+#undef STODIUM_LANES_ATTRIBUTES
+#undef STODIUM_VEC
+#undef STODIUM_VEC_SET1
+#undef STODIUM_VEC_LOAD
+#undef STODIUM_VEC_STORE
+#undef STODIUM_VEC_ADD
+#undef STODIUM_VEC_XOR
+#undef STODIUM_VEC_ROTL
+#undef STODIUM_VEC_ROTL32
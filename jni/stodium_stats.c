@@ -0,0 +1,171 @@
+/**
+ * This file implements the instrumentation counters declared in
+ * stodium_stats.h.
+ *
+ * Each thread gets a slot on its first counted call, which is linked into a
+ * list of live slots. Only the owning thread writes to a slot, using relaxed
+ * atomic loads and stores so a concurrent snapshot never reads a torn value.
+ * When a thread exits, its counters are moved into stodium_stats_retired.
+ *
+ * The thread's slot is cached in a thread-local pointer, so counting is a
+ * TLS load and an add; the pthread key is only there to retire the slot.
+ * Without STODIUM_STATS only an empty snapshot is compiled, which also keeps
+ * the 64-bit atomics (and libatomic on some 32-bit ABIs) out of the build.
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "stodium_stats.h"
+
+#if STODIUM_STATS
+
+#define STODIUM_STATS_VALUES (STODIUM_STATS_GROUPS * STODIUM_STATS_COUNTERS)
+
+typedef struct stodium_stats_slot {
+    uint64_t                   values[STODIUM_STATS_VALUES];
+    int                        group; // The group of the last counted call
+    struct stodium_stats_slot *prev;
+    struct stodium_stats_slot *next;
+} stodium_stats_slot;
+
+/**
+ * The list of live slots and the retired counters are guarded by
+ * stodium_stats_mutex.
+ */
+static pthread_mutex_t     stodium_stats_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t      stodium_stats_once  = PTHREAD_ONCE_INIT;
+static pthread_key_t       stodium_stats_key;
+static bool                stodium_stats_key_ok;
+static stodium_stats_slot *stodium_stats_live;
+static uint64_t            stodium_stats_retired[STODIUM_STATS_VALUES];
+
+static __thread stodium_stats_slot *stodium_stats_self;
+
+/**
+ * stodium_stats_retire is the destructor of the slot of an exiting thread.
+ */
+static void stodium_stats_retire(void *arg) {
+    stodium_stats_slot *slot = (stodium_stats_slot *) arg;
+    size_t i;
+
+    pthread_mutex_lock(&stodium_stats_mutex);
+    for (i = 0; i < STODIUM_STATS_VALUES; i++) {
+        stodium_stats_retired[i] += slot->values[i];
+    }
+    if (slot->prev != NULL) {
+        slot->prev->next = slot->next;
+    } else {
+        stodium_stats_live = slot->next;
+    }
+    if (slot->next != NULL) {
+        slot->next->prev = slot->prev;
+    }
+    pthread_mutex_unlock(&stodium_stats_mutex);
+
+    stodium_stats_self = NULL;
+    free(slot);
+}
+
+static void stodium_stats_init(void) {
+    stodium_stats_key_ok = pthread_key_create(&stodium_stats_key, stodium_stats_retire) == 0;
+}
+
+/**
+ * stodium_stats_slot_get returns the slot of the calling thread, creating it
+ * on first use. Returns NULL if no slot could be created, in which case the
+ * call is not counted.
+ */
+static stodium_stats_slot *stodium_stats_slot_get(void) {
+    stodium_stats_slot *slot = stodium_stats_self;
+    if (slot != NULL) {
+        return slot;
+    }
+
+    pthread_once(&stodium_stats_once, stodium_stats_init);
+    if (!stodium_stats_key_ok) {
+        return NULL;
+    }
+
+    slot = (stodium_stats_slot *) calloc(1, sizeof(stodium_stats_slot));
+    if (slot == NULL) {
+        return NULL;
+    }
+    slot->group = STODIUM_STATS_NONE;
+    if (pthread_setspecific(stodium_stats_key, slot) != 0) {
+        free(slot);
+        return NULL;
+    }
+
+    pthread_mutex_lock(&stodium_stats_mutex);
+    slot->next = stodium_stats_live;
+    if (stodium_stats_live != NULL) {
+        stodium_stats_live->prev = slot;
+    }
+    stodium_stats_live = slot;
+    pthread_mutex_unlock(&stodium_stats_mutex);
+
+    stodium_stats_self = slot;
+    return slot;
+}
+
+/**
+ * stodium_stats_inc adds n to a value of a slot owned by the calling thread.
+ * There is a single writer, so a load and a store are enough.
+ */
+static void stodium_stats_inc(uint64_t *value, uint64_t n) {
+    __atomic_store_n(value, __atomic_load_n(value, __ATOMIC_RELAXED) + n, __ATOMIC_RELAXED);
+}
+
+void stodium_stats_call(int group) {
+    stodium_stats_slot *slot = stodium_stats_slot_get();
+    if (slot == NULL) {
+        return;
+    }
+
+    slot->group = group;
+    stodium_stats_inc(&slot->values[group * STODIUM_STATS_COUNTERS + STODIUM_STATS_CALLS], 1);
+}
+
+void stodium_stats_add(int counter, uint64_t n) {
+    stodium_stats_slot *slot = stodium_stats_slot_get();
+    if (slot == NULL || slot->group == STODIUM_STATS_NONE) {
+        return;
+    }
+
+    stodium_stats_inc(&slot->values[slot->group * STODIUM_STATS_COUNTERS + counter], n);
+}
+
+void stodium_stats_snapshot(uint64_t *dst) {
+    stodium_stats_slot *slot;
+    size_t i;
+
+    pthread_mutex_lock(&stodium_stats_mutex);
+    memcpy(dst, stodium_stats_retired, sizeof(stodium_stats_retired));
+    for (slot = stodium_stats_live; slot != NULL; slot = slot->next) {
+        for (i = 0; i < STODIUM_STATS_VALUES; i++) {
+            dst[i] += __atomic_load_n(&slot->values[i], __ATOMIC_RELAXED);
+        }
+    }
+    pthread_mutex_unlock(&stodium_stats_mutex);
+}
+
+#else
+
+void stodium_stats_call(int group) {
+    (void) group;
+}
+
+void stodium_stats_add(int counter, uint64_t n) {
+    (void) counter;
+    (void) n;
+}
+
+void stodium_stats_snapshot(uint64_t *dst) {
+    memset(dst, 0, STODIUM_STATS_GROUPS * STODIUM_STATS_COUNTERS * sizeof(uint64_t));
+}
+
+#endif
@@ -0,0 +1,98 @@
+/**
+ * This file declares the instrumentation counters of the JNI wrappers. Every
+ * thread counts into its own slot, so counting does not need any locking; the
+ * slots are only merged when a snapshot is taken.
+ *
+ * The counters are compiled out by default, so the wrappers pay nothing for
+ * them, and are compiled in by building with -DSTODIUM_STATS=1 (the CMake
+ * option STODIUM_STATS, or ndk-build STODIUM_STATS=1).
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+#ifndef STODIUM_STATS_H
+#define STODIUM_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef STODIUM_STATS
+#define STODIUM_STATS 0
+#endif
+
+/**
+ * The groups of primitives that are counted separately. The order is shared
+ * with eu.artemisc.stodium.Stats.
+ */
+#define STODIUM_STATS_AEAD         0
+#define STODIUM_STATS_AUTH         1
+#define STODIUM_STATS_BOX          2
+#define STODIUM_STATS_CORE         3
+#define STODIUM_STATS_GENERICHASH  4
+#define STODIUM_STATS_HASH         5
+#define STODIUM_STATS_KDF          6
+#define STODIUM_STATS_KX           7
+#define STODIUM_STATS_ONETIMEAUTH  8
+#define STODIUM_STATS_PWHASH       9
+#define STODIUM_STATS_RANDOMBYTES  10
+#define STODIUM_STATS_SCALARMULT   11
+#define STODIUM_STATS_SECRETBOX    12
+#define STODIUM_STATS_SECRETSTREAM 13
+#define STODIUM_STATS_SHORTHASH    14
+#define STODIUM_STATS_SIGN         15
+#define STODIUM_STATS_UTILS        16
+#define STODIUM_STATS_GROUPS       17
+#define STODIUM_STATS_NONE         (-1) // No call counted yet on this thread
+
+/**
+ * The counters kept for every group:
+ *
+ * CALLS:    the number of calls to the wrappers of the group
+ * BYTES:    the number of input bytes passed to those calls
+ * DIRECT:   the number of direct buffers passed to those calls
+ * INDIRECT: the number of heap buffers passed to those calls
+ * COPIED:   the number of bytes copied by Get/ReleaseByteArrayElements
+ */
+#define STODIUM_STATS_CALLS    0
+#define STODIUM_STATS_BYTES    1
+#define STODIUM_STATS_DIRECT   2
+#define STODIUM_STATS_INDIRECT 3
+#define STODIUM_STATS_COPIED   4
+#define STODIUM_STATS_COUNTERS 5
+
+/**
+ * stodium_stats_call counts a call to a wrapper of group, and makes group the
+ * group that the following stodium_stats_add calls on this thread count
+ * towards.
+ */
+void stodium_stats_call(int group);
+
+/**
+ * stodium_stats_add adds n to counter of the group of the last
+ * stodium_stats_call on this thread, if there was one.
+ */
+void stodium_stats_add(int counter, uint64_t n);
+
+/**
+ * stodium_stats_snapshot merges the counters of all threads into dst, which
+ * holds STODIUM_STATS_GROUPS * STODIUM_STATS_COUNTERS values, ordered by
+ * group first. Counters of threads that have exited are included.
+ */
+void stodium_stats_snapshot(uint64_t *dst);
+
+#if STODIUM_STATS
+#define STODIUM_STATS_CALL(group)     stodium_stats_call(group)
+#define STODIUM_STATS_ADD(counter, n) stodium_stats_add(counter, (uint64_t) (n))
+#else
+#define STODIUM_STATS_CALL(group)     ((void) 0)
+#define STODIUM_STATS_ADD(counter, n) ((void) 0)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,392 @@
+/*
+ * Copyright (c) 2017 Project ArteMisc
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+package eu.artemisc.stodium;
+
+import org.jetbrains.annotations.NotNull;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.LongBuffer;
+
+/**
+ * Constants holds the numeric constants of libsodium (key sizes, nonce sizes,
+ * limits, etc.), read with a single native call when the class is
+ * initialized. This is considerably cheaper at startup than calling every
+ * crypto_*() getter in {@link StodiumJNI} on its own, which the wrappers used
+ * to do in their static initializers.
+ * <p>
+ * The fields are named after the libsodium functions, without the crypto_
+ * prefix, and are in the order of jni/stodium_constants.h.
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+public final class Constants {
+    /**
+     * COUNT is the number of constants written by
+     * {@link StodiumJNI#stodium_constants(ByteBuffer)}.
+     */
+    public static final int COUNT = 144;
+
+    // core
+    public static final int  CORE_HSALSA20_OUTPUTBYTES;
+    public static final int  CORE_HSALSA20_INPUTBYTES;
+    public static final int  CORE_HSALSA20_KEYBYTES;
+    public static final int  CORE_HSALSA20_CONSTBYTES;
+    public static final int  CORE_HCHACHA20_OUTPUTBYTES;
+    public static final int  CORE_HCHACHA20_INPUTBYTES;
+    public static final int  CORE_HCHACHA20_KEYBYTES;
+    public static final int  CORE_HCHACHA20_CONSTBYTES;
+
+    // aead
+    public static final int  AEAD_AES256GCM_KEYBYTES;
+    public static final int  AEAD_AES256GCM_NSECBYTES;
+    public static final int  AEAD_AES256GCM_NPUBBYTES;
+    public static final int  AEAD_AES256GCM_ABYTES;
+    public static final int  AEAD_CHACHA20POLY1305_KEYBYTES;
+    public static final int  AEAD_CHACHA20POLY1305_NSECBYTES;
+    public static final int  AEAD_CHACHA20POLY1305_NPUBBYTES;
+    public static final int  AEAD_CHACHA20POLY1305_ABYTES;
+    public static final int  AEAD_CHACHA20POLY1305_IETF_KEYBYTES;
+    public static final int  AEAD_CHACHA20POLY1305_IETF_NSECBYTES;
+    public static final int  AEAD_CHACHA20POLY1305_IETF_NPUBBYTES;
+    public static final int  AEAD_CHACHA20POLY1305_IETF_ABYTES;
+    public static final int  AEAD_XCHACHA20POLY1305_IETF_KEYBYTES;
+    public static final int  AEAD_XCHACHA20POLY1305_IETF_NSECBYTES;
+    public static final int  AEAD_XCHACHA20POLY1305_IETF_NPUBBYTES;
+    public static final int  AEAD_XCHACHA20POLY1305_IETF_ABYTES;
+
+    // auth
+    public static final int  AUTH_HMACSHA256_BYTES;
+    public static final int  AUTH_HMACSHA256_KEYBYTES;
+    public static final int  AUTH_HMACSHA256_STATEBYTES;
+    public static final int  AUTH_HMACSHA512_BYTES;
+    public static final int  AUTH_HMACSHA512_KEYBYTES;
+    public static final int  AUTH_HMACSHA512_STATEBYTES;
+    public static final int  AUTH_HMACSHA512256_BYTES;
+    public static final int  AUTH_HMACSHA512256_KEYBYTES;
+    public static final int  AUTH_HMACSHA512256_STATEBYTES;
+
+    // box
+    public static final int  BOX_SEALBYTES;
+    public static final int  BOX_CURVE25519XSALSA20POLY1305_SEEDBYTES;
+    public static final int  BOX_CURVE25519XSALSA20POLY1305_PUBLICKEYBYTES;
+    public static final int  BOX_CURVE25519XSALSA20POLY1305_SECRETKEYBYTES;
+    public static final int  BOX_CURVE25519XSALSA20POLY1305_BEFORENMBYTES;
+    public static final int  BOX_CURVE25519XSALSA20POLY1305_NONCEBYTES;
+    public static final int  BOX_CURVE25519XSALSA20POLY1305_ZEROBYTES;
+    public static final int  BOX_CURVE25519XSALSA20POLY1305_BOXZEROBYTES;
+    public static final int  BOX_CURVE25519XSALSA20POLY1305_MACBYTES;
+    public static final int  BOX_CURVE25519XCHACHA20POLY1305_SEEDBYTES;
+    public static final int  BOX_CURVE25519XCHACHA20POLY1305_PUBLICKEYBYTES;
+    public static final int  BOX_CURVE25519XCHACHA20POLY1305_SECRETKEYBYTES;
+    public static final int  BOX_CURVE25519XCHACHA20POLY1305_BEFORENMBYTES;
+    public static final int  BOX_CURVE25519XCHACHA20POLY1305_NONCEBYTES;
+    public static final int  BOX_CURVE25519XCHACHA20POLY1305_MACBYTES;
+
+    // generichash
+    public static final int  GENERICHASH_BLAKE2B_BYTES;
+    public static final int  GENERICHASH_BLAKE2B_BYTES_MIN;
+    public static final int  GENERICHASH_BLAKE2B_BYTES_MAX;
+    public static final int  GENERICHASH_BLAKE2B_KEYBYTES;
+    public static final int  GENERICHASH_BLAKE2B_KEYBYTES_MIN;
+    public static final int  GENERICHASH_BLAKE2B_KEYBYTES_MAX;
+    public static final int  GENERICHASH_BLAKE2B_PERSONALBYTES;
+    public static final int  GENERICHASH_BLAKE2B_SALTBYTES;
+    public static final int  GENERICHASH_BLAKE2B_STATEBYTES;
+
+    // hash
+    public static final int  HASH_SHA256_BYTES;
+    public static final int  HASH_SHA256_STATEBYTES;
+    public static final int  HASH_SHA512_BYTES;
+    public static final int  HASH_SHA512_STATEBYTES;
+
+    // kdf
+    public static final int  KDF_BLAKE2B_BYTES_MIN;
+    public static final int  KDF_BLAKE2B_BYTES_MAX;
+    public static final int  KDF_BLAKE2B_CONTEXTBYTES;
+    public static final int  KDF_BLAKE2B_KEYBYTES;
+
+    // kx
+    public static final int  KX_PUBLICKEYBYTES;
+    public static final int  KX_SECRETKEYBYTES;
+    public static final int  KX_SEEDBYTES;
+    public static final int  KX_SESSIONKEYBYTES;
+
+    // onetimeauth
+    public static final int  ONETIMEAUTH_POLY1305_BYTES;
+    public static final int  ONETIMEAUTH_POLY1305_KEYBYTES;
+    public static final int  ONETIMEAUTH_POLY1305_STATEBYTES;
+
+    // pwhash
+    public static final long PWHASH_ARGON2I_BYTES_MIN;
+    public static final long PWHASH_ARGON2I_BYTES_MAX;
+    public static final long PWHASH_ARGON2I_PASSWD_MIN;
+    public static final long PWHASH_ARGON2I_PASSWD_MAX;
+    public static final int  PWHASH_ARGON2I_SALTBYTES;
+    public static final int  PWHASH_ARGON2I_STRBYTES;
+    public static final long PWHASH_ARGON2I_OPSLIMIT_MIN;
+    public static final long PWHASH_ARGON2I_OPSLIMIT_MAX;
+    public static final long PWHASH_ARGON2I_MEMLIMIT_MIN;
+    public static final long PWHASH_ARGON2I_MEMLIMIT_MAX;
+    public static final long PWHASH_ARGON2I_OPSLIMIT_INTERACTIVE;
+    public static final long PWHASH_ARGON2I_MEMLIMIT_INTERACTIVE;
+    public static final long PWHASH_ARGON2I_OPSLIMIT_MODERATE;
+    public static final long PWHASH_ARGON2I_MEMLIMIT_MODERATE;
+    public static final long PWHASH_ARGON2I_OPSLIMIT_SENSITIVE;
+    public static final long PWHASH_ARGON2I_MEMLIMIT_SENSITIVE;
+    public static final long PWHASH_ARGON2ID_BYTES_MIN;
+    public static final long PWHASH_ARGON2ID_BYTES_MAX;
+    public static final long PWHASH_ARGON2ID_PASSWD_MIN;
+    public static final long PWHASH_ARGON2ID_PASSWD_MAX;
+    public static final int  PWHASH_ARGON2ID_SALTBYTES;
+    public static final int  PWHASH_ARGON2ID_STRBYTES;
+    public static final long PWHASH_ARGON2ID_OPSLIMIT_MIN;
+    public static final long PWHASH_ARGON2ID_OPSLIMIT_MAX;
+    public static final long PWHASH_ARGON2ID_MEMLIMIT_MIN;
+    public static final long PWHASH_ARGON2ID_MEMLIMIT_MAX;
+    public static final long PWHASH_ARGON2ID_OPSLIMIT_INTERACTIVE;
+    public static final long PWHASH_ARGON2ID_MEMLIMIT_INTERACTIVE;
+    public static final long PWHASH_ARGON2ID_OPSLIMIT_MODERATE;
+    public static final long PWHASH_ARGON2ID_MEMLIMIT_MODERATE;
+    public static final long PWHASH_ARGON2ID_OPSLIMIT_SENSITIVE;
+    public static final long PWHASH_ARGON2ID_MEMLIMIT_SENSITIVE;
+    public static final long PWHASH_SCRYPTSALSA208SHA256_BYTES_MIN;
+    public static final long PWHASH_SCRYPTSALSA208SHA256_BYTES_MAX;
+    public static final long PWHASH_SCRYPTSALSA208SHA256_PASSWD_MIN;
+    public static final long PWHASH_SCRYPTSALSA208SHA256_PASSWD_MAX;
+    public static final int  PWHASH_SCRYPTSALSA208SHA256_SALTBYTES;
+    public static final int  PWHASH_SCRYPTSALSA208SHA256_STRBYTES;
+    public static final long PWHASH_SCRYPTSALSA208SHA256_OPSLIMIT_MIN;
+    public static final long PWHASH_SCRYPTSALSA208SHA256_OPSLIMIT_MAX;
+    public static final long PWHASH_SCRYPTSALSA208SHA256_MEMLIMIT_MIN;
+    public static final long PWHASH_SCRYPTSALSA208SHA256_MEMLIMIT_MAX;
+    public static final long PWHASH_SCRYPTSALSA208SHA256_OPSLIMIT_INTERACTIVE;
+    public static final long PWHASH_SCRYPTSALSA208SHA256_MEMLIMIT_INTERACTIVE;
+    public static final long PWHASH_SCRYPTSALSA208SHA256_OPSLIMIT_SENSITIVE;
+    public static final long PWHASH_SCRYPTSALSA208SHA256_MEMLIMIT_SENSITIVE;
+
+    // scalarmult
+    public static final int  SCALARMULT_CURVE25519_BYTES;
+    public static final int  SCALARMULT_CURVE25519_SCALARBYTES;
+
+    // secretbox
+    public static final int  SECRETBOX_XSALSA20POLY1305_KEYBYTES;
+    public static final int  SECRETBOX_XSALSA20POLY1305_MACBYTES;
+    public static final int  SECRETBOX_XSALSA20POLY1305_NONCEBYTES;
+    public static final int  SECRETBOX_XCHACHA20POLY1305_KEYBYTES;
+    public static final int  SECRETBOX_XCHACHA20POLY1305_MACBYTES;
+    public static final int  SECRETBOX_XCHACHA20POLY1305_NONCEBYTES;
+
+    // secretstream
+    public static final int  SECRETSTREAM_XCHACHA20POLY1305_ABYTES;
+    public static final int  SECRETSTREAM_XCHACHA20POLY1305_HEADERBYTES;
+    public static final int  SECRETSTREAM_XCHACHA20POLY1305_KEYBYTES;
+    public static final int  SECRETSTREAM_XCHACHA20POLY1305_STATEBYTES;
+    public static final long SECRETSTREAM_XCHACHA20POLY1305_MESSAGEBYTES_MAX;
+    public static final int  SECRETSTREAM_XCHACHA20POLY1305_TAG_MESSAGE;
+    public static final int  SECRETSTREAM_XCHACHA20POLY1305_TAG_PUSH;
+    public static final int  SECRETSTREAM_XCHACHA20POLY1305_TAG_REKEY;
+    public static final int  SECRETSTREAM_XCHACHA20POLY1305_TAG_FINAL;
+
+    // shorthash
+    public static final int  SHORTHASH_SIPHASH24_BYTES;
+    public static final int  SHORTHASH_SIPHASH24_KEYBYTES;
+    public static final int  SHORTHASH_SIPHASHX24_BYTES;
+    public static final int  SHORTHASH_SIPHASHX24_KEYBYTES;
+
+    // sign
+    public static final int  SIGN_ED25519_PUBLICKEYBYTES;
+    public static final int  SIGN_ED25519_SECRETKEYBYTES;
+    public static final int  SIGN_ED25519_BYTES;
+    public static final int  SIGN_ED25519_SEEDBYTES;
+    public static final int  SIGN_ED25519PH_STATEBYTES;
+
+    static {
+        final ByteBuffer dst = ByteBuffer.allocateDirect(COUNT * 8).order(ByteOrder.nativeOrder());
+        if (StodiumJNI.stodium_constants(dst) != COUNT) {
+            throw new IllegalStateException("Stodium: native library does not match the Constants class");
+        }
+        final @NotNull LongBuffer values = dst.asLongBuffer();
+
+        // core
+        CORE_HSALSA20_OUTPUTBYTES  = (int) values.get();
+        CORE_HSALSA20_INPUTBYTES   = (int) values.get();
+        CORE_HSALSA20_KEYBYTES     = (int) values.get();
+        CORE_HSALSA20_CONSTBYTES   = (int) values.get();
+        CORE_HCHACHA20_OUTPUTBYTES = (int) values.get();
+        CORE_HCHACHA20_INPUTBYTES  = (int) values.get();
+        CORE_HCHACHA20_KEYBYTES    = (int) values.get();
+        CORE_HCHACHA20_CONSTBYTES  = (int) values.get();
+
+        // aead
+        AEAD_AES256GCM_KEYBYTES               = (int) values.get();
+        AEAD_AES256GCM_NSECBYTES              = (int) values.get();
+        AEAD_AES256GCM_NPUBBYTES              = (int) values.get();
+        AEAD_AES256GCM_ABYTES                 = (int) values.get();
+        AEAD_CHACHA20POLY1305_KEYBYTES        = (int) values.get();
+        AEAD_CHACHA20POLY1305_NSECBYTES       = (int) values.get();
+        AEAD_CHACHA20POLY1305_NPUBBYTES       = (int) values.get();
+        AEAD_CHACHA20POLY1305_ABYTES          = (int) values.get();
+        AEAD_CHACHA20POLY1305_IETF_KEYBYTES   = (int) values.get();
+        AEAD_CHACHA20POLY1305_IETF_NSECBYTES  = (int) values.get();
+        AEAD_CHACHA20POLY1305_IETF_NPUBBYTES  = (int) values.get();
+        AEAD_CHACHA20POLY1305_IETF_ABYTES     = (int) values.get();
+        AEAD_XCHACHA20POLY1305_IETF_KEYBYTES  = (int) values.get();
+        AEAD_XCHACHA20POLY1305_IETF_NSECBYTES = (int) values.get();
+        AEAD_XCHACHA20POLY1305_IETF_NPUBBYTES = (int) values.get();
+        AEAD_XCHACHA20POLY1305_IETF_ABYTES    = (int) values.get();
+
+        // auth
+        AUTH_HMACSHA256_BYTES         = (int) values.get();
+        AUTH_HMACSHA256_KEYBYTES      = (int) values.get();
+        AUTH_HMACSHA256_STATEBYTES    = (int) values.get();
+        AUTH_HMACSHA512_BYTES         = (int) values.get();
+        AUTH_HMACSHA512_KEYBYTES      = (int) values.get();
+        AUTH_HMACSHA512_STATEBYTES    = (int) values.get();
+        AUTH_HMACSHA512256_BYTES      = (int) values.get();
+        AUTH_HMACSHA512256_KEYBYTES   = (int) values.get();
+        AUTH_HMACSHA512256_STATEBYTES = (int) values.get();
+
+        // box
+        BOX_SEALBYTES                                  = (int) values.get();
+        BOX_CURVE25519XSALSA20POLY1305_SEEDBYTES       = (int) values.get();
+        BOX_CURVE25519XSALSA20POLY1305_PUBLICKEYBYTES  = (int) values.get();
+        BOX_CURVE25519XSALSA20POLY1305_SECRETKEYBYTES  = (int) values.get();
+        BOX_CURVE25519XSALSA20POLY1305_BEFORENMBYTES   = (int) values.get();
+        BOX_CURVE25519XSALSA20POLY1305_NONCEBYTES      = (int) values.get();
+        BOX_CURVE25519XSALSA20POLY1305_ZEROBYTES       = (int) values.get();
+        BOX_CURVE25519XSALSA20POLY1305_BOXZEROBYTES    = (int) values.get();
+        BOX_CURVE25519XSALSA20POLY1305_MACBYTES        = (int) values.get();
+        BOX_CURVE25519XCHACHA20POLY1305_SEEDBYTES      = (int) values.get();
+        BOX_CURVE25519XCHACHA20POLY1305_PUBLICKEYBYTES = (int) values.get();
+        BOX_CURVE25519XCHACHA20POLY1305_SECRETKEYBYTES = (int) values.get();
+        BOX_CURVE25519XCHACHA20POLY1305_BEFORENMBYTES  = (int) values.get();
+        BOX_CURVE25519XCHACHA20POLY1305_NONCEBYTES     = (int) values.get();
+        BOX_CURVE25519XCHACHA20POLY1305_MACBYTES       = (int) values.get();
+
+        // generichash
+        GENERICHASH_BLAKE2B_BYTES         = (int) values.get();
+        GENERICHASH_BLAKE2B_BYTES_MIN     = (int) values.get();
+        GENERICHASH_BLAKE2B_BYTES_MAX     = (int) values.get();
+        GENERICHASH_BLAKE2B_KEYBYTES      = (int) values.get();
+        GENERICHASH_BLAKE2B_KEYBYTES_MIN  = (int) values.get();
+        GENERICHASH_BLAKE2B_KEYBYTES_MAX  = (int) values.get();
+        GENERICHASH_BLAKE2B_PERSONALBYTES = (int) values.get();
+        GENERICHASH_BLAKE2B_SALTBYTES     = (int) values.get();
+        GENERICHASH_BLAKE2B_STATEBYTES    = (int) values.get();
+
+        // hash
+        HASH_SHA256_BYTES      = (int) values.get();
+        HASH_SHA256_STATEBYTES = (int) values.get();
+        HASH_SHA512_BYTES      = (int) values.get();
+        HASH_SHA512_STATEBYTES = (int) values.get();
+
+        // kdf
+        KDF_BLAKE2B_BYTES_MIN    = (int) values.get();
+        KDF_BLAKE2B_BYTES_MAX    = (int) values.get();
+        KDF_BLAKE2B_CONTEXTBYTES = (int) values.get();
+        KDF_BLAKE2B_KEYBYTES     = (int) values.get();
+
+        // kx
+        KX_PUBLICKEYBYTES  = (int) values.get();
+        KX_SECRETKEYBYTES  = (int) values.get();
+        KX_SEEDBYTES       = (int) values.get();
+        KX_SESSIONKEYBYTES = (int) values.get();
+
+        // onetimeauth
+        ONETIMEAUTH_POLY1305_BYTES      = (int) values.get();
+        ONETIMEAUTH_POLY1305_KEYBYTES   = (int) values.get();
+        ONETIMEAUTH_POLY1305_STATEBYTES = (int) values.get();
+
+        // pwhash
+        PWHASH_ARGON2I_BYTES_MIN                         = values.get();
+        PWHASH_ARGON2I_BYTES_MAX                         = values.get();
+        PWHASH_ARGON2I_PASSWD_MIN                        = values.get();
+        PWHASH_ARGON2I_PASSWD_MAX                        = values.get();
+        PWHASH_ARGON2I_SALTBYTES                         = (int) values.get();
+        PWHASH_ARGON2I_STRBYTES                          = (int) values.get();
+        PWHASH_ARGON2I_OPSLIMIT_MIN                      = values.get();
+        PWHASH_ARGON2I_OPSLIMIT_MAX                      = values.get();
+        PWHASH_ARGON2I_MEMLIMIT_MIN                      = values.get();
+        PWHASH_ARGON2I_MEMLIMIT_MAX                      = values.get();
+        PWHASH_ARGON2I_OPSLIMIT_INTERACTIVE              = values.get();
+        PWHASH_ARGON2I_MEMLIMIT_INTERACTIVE              = values.get();
+        PWHASH_ARGON2I_OPSLIMIT_MODERATE                 = values.get();
+        PWHASH_ARGON2I_MEMLIMIT_MODERATE                 = values.get();
+        PWHASH_ARGON2I_OPSLIMIT_SENSITIVE                = values.get();
+        PWHASH_ARGON2I_MEMLIMIT_SENSITIVE                = values.get();
+        PWHASH_ARGON2ID_BYTES_MIN                        = values.get();
+        PWHASH_ARGON2ID_BYTES_MAX                        = values.get();
+        PWHASH_ARGON2ID_PASSWD_MIN                       = values.get();
+        PWHASH_ARGON2ID_PASSWD_MAX                       = values.get();
+        PWHASH_ARGON2ID_SALTBYTES                        = (int) values.get();
+        PWHASH_ARGON2ID_STRBYTES                         = (int) values.get();
+        PWHASH_ARGON2ID_OPSLIMIT_MIN                     = values.get();
+        PWHASH_ARGON2ID_OPSLIMIT_MAX                     = values.get();
+        PWHASH_ARGON2ID_MEMLIMIT_MIN                     = values.get();
+        PWHASH_ARGON2ID_MEMLIMIT_MAX                     = values.get();
+        PWHASH_ARGON2ID_OPSLIMIT_INTERACTIVE             = values.get();
+        PWHASH_ARGON2ID_MEMLIMIT_INTERACTIVE             = values.get();
+        PWHASH_ARGON2ID_OPSLIMIT_MODERATE                = values.get();
+        PWHASH_ARGON2ID_MEMLIMIT_MODERATE                = values.get();
+        PWHASH_ARGON2ID_OPSLIMIT_SENSITIVE               = values.get();
+        PWHASH_ARGON2ID_MEMLIMIT_SENSITIVE               = values.get();
+        PWHASH_SCRYPTSALSA208SHA256_BYTES_MIN            = values.get();
+        PWHASH_SCRYPTSALSA208SHA256_BYTES_MAX            = values.get();
+        PWHASH_SCRYPTSALSA208SHA256_PASSWD_MIN           = values.get();
+        PWHASH_SCRYPTSALSA208SHA256_PASSWD_MAX           = values.get();
+        PWHASH_SCRYPTSALSA208SHA256_SALTBYTES            = (int) values.get();
+        PWHASH_SCRYPTSALSA208SHA256_STRBYTES             = (int) values.get();
+        PWHASH_SCRYPTSALSA208SHA256_OPSLIMIT_MIN         = values.get();
+        PWHASH_SCRYPTSALSA208SHA256_OPSLIMIT_MAX         = values.get();
+        PWHASH_SCRYPTSALSA208SHA256_MEMLIMIT_MIN         = values.get();
+        PWHASH_SCRYPTSALSA208SHA256_MEMLIMIT_MAX         = values.get();
+        PWHASH_SCRYPTSALSA208SHA256_OPSLIMIT_INTERACTIVE = values.get();
+        PWHASH_SCRYPTSALSA208SHA256_MEMLIMIT_INTERACTIVE = values.get();
+        PWHASH_SCRYPTSALSA208SHA256_OPSLIMIT_SENSITIVE   = values.get();
+        PWHASH_SCRYPTSALSA208SHA256_MEMLIMIT_SENSITIVE   = values.get();
+
+        // scalarmult
+        SCALARMULT_CURVE25519_BYTES       = (int) values.get();
+        SCALARMULT_CURVE25519_SCALARBYTES = (int) values.get();
+
+        // secretbox
+        SECRETBOX_XSALSA20POLY1305_KEYBYTES    = (int) values.get();
+        SECRETBOX_XSALSA20POLY1305_MACBYTES    = (int) values.get();
+        SECRETBOX_XSALSA20POLY1305_NONCEBYTES  = (int) values.get();
+        SECRETBOX_XCHACHA20POLY1305_KEYBYTES   = (int) values.get();
+        SECRETBOX_XCHACHA20POLY1305_MACBYTES   = (int) values.get();
+        SECRETBOX_XCHACHA20POLY1305_NONCEBYTES = (int) values.get();
+
+        // secretstream
+        SECRETSTREAM_XCHACHA20POLY1305_ABYTES           = (int) values.get();
+        SECRETSTREAM_XCHACHA20POLY1305_HEADERBYTES      = (int) values.get();
+        SECRETSTREAM_XCHACHA20POLY1305_KEYBYTES         = (int) values.get();
+        SECRETSTREAM_XCHACHA20POLY1305_STATEBYTES       = (int) values.get();
+        SECRETSTREAM_XCHACHA20POLY1305_MESSAGEBYTES_MAX = values.get();
+        SECRETSTREAM_XCHACHA20POLY1305_TAG_MESSAGE      = (int) values.get();
+        SECRETSTREAM_XCHACHA20POLY1305_TAG_PUSH         = (int) values.get();
+        SECRETSTREAM_XCHACHA20POLY1305_TAG_REKEY        = (int) values.get();
+        SECRETSTREAM_XCHACHA20POLY1305_TAG_FINAL        = (int) values.get();
+
+        // shorthash
+        SHORTHASH_SIPHASH24_BYTES     = (int) values.get();
+        SHORTHASH_SIPHASH24_KEYBYTES  = (int) values.get();
+        SHORTHASH_SIPHASHX24_BYTES    = (int) values.get();
+        SHORTHASH_SIPHASHX24_KEYBYTES = (int) values.get();
+
+        // sign
+        SIGN_ED25519_PUBLICKEYBYTES = (int) values.get();
+        SIGN_ED25519_SECRETKEYBYTES = (int) values.get();
+        SIGN_ED25519_BYTES          = (int) values.get();
+        SIGN_ED25519_SEEDBYTES      = (int) values.get();
+        SIGN_ED25519PH_STATEBYTES   = (int) values.get();
+    }
+
+    private Constants() {}
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2017 Project ArteMisc
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+package eu.artemisc.stodium;
+
+import org.jetbrains.annotations.NotNull;
+
+/**
+ * CpuFeatures reports the CPU features found by libsodium's runtime detection.
+ * Libsodium uses these to pick the fastest implementation of a primitive (e.g.
+ * the AVX2 versions of BLAKE2b, Argon2 and ChaCha20) when it is initialized,
+ * so a single native library is fast on every CPU of an ABI.
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+public final class CpuFeatures {
+    // features, in the order of jni/sodium_jni_buffer.c
+    public static final int NEON    = 1;
+    public static final int SSE2    = 1 << 1;
+    public static final int SSE3    = 1 << 2;
+    public static final int SSSE3   = 1 << 3;
+    public static final int SSE41   = 1 << 4;
+    public static final int AVX     = 1 << 5;
+    public static final int AVX2    = 1 << 6;
+    public static final int AVX512F = 1 << 7;
+    public static final int PCLMUL  = 1 << 8;
+    public static final int AESNI   = 1 << 9;
+    public static final int RDRAND  = 1 << 10;
+
+    private static final @NotNull String[] NAMES = {
+            "neon", "sse2", "sse3", "ssse3", "sse4.1", "avx", "avx2",
+            "avx512f", "pclmul", "aesni", "rdrand"
+    };
+
+    private static final @NotNull Singleton<Integer> MASK = new Singleton<Integer>() {
+        @NotNull
+        @Override
+        protected Integer initialize() {
+            return StodiumJNI.stodium_cpu_features();
+        }
+    };
+
+    private CpuFeatures() {}
+
+    /**
+     *
+     * @return the mask of every feature found
+     */
+    public static int mask() {
+        return MASK.get();
+    }
+
+    /**
+     *
+     * @param features one or more of the feature constants
+     * @return true if the CPU has all of the features
+     */
+    public static boolean has(final int features) {
+        return (mask() & features) == features;
+    }
+
+    /**
+     * describe returns the names of the features found, separated by spaces
+     * (e.g. for logging).
+     *
+     * @return
+     */
+    @NotNull
+    public static String describe() {
+        final int           mask    = mask();
+        final StringBuilder builder = new StringBuilder();
+        for (int i = 0; i < NAMES.length; i++) {
+            if ((mask & (1 << i)) == 0) {
+                continue;
+            }
+            if (builder.length() > 0) {
+                builder.append(' ');
+            }
+            builder.append(NAMES[i]);
+        }
+        return builder.toString();
+    }
+}
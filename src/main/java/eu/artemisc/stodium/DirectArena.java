@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2017 Project ArteMisc
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+package eu.artemisc.stodium;
+
+import org.jetbrains.annotations.NotNull;
+
+import java.nio.ByteBuffer;
+
+/**
+ * DirectArena hands out short-lived direct scratch buffers, such as the direct
+ * copies made by {@link Stodium#ensureUsableByteBuffer(ByteBuffer)}, without
+ * allocating a direct buffer (and a Cleaner) every time.
+ * <p>
+ * Every thread has its own arena, with a slab per size class. A slab is carved
+ * into {@link #DEPTH} slices up front, which are handed out in turn: a scratch
+ * buffer stays valid until its thread has asked for DEPTH more buffers of the
+ * same size class. This is plenty for the arguments of a single native call,
+ * as long as no call asks for more than DEPTH buffers of one class (the
+ * fragments of a gather call share a single scratch buffer, see
+ * {@link Stodium#ensureUsableByteBuffers(ByteBuffer[])}), but scratch buffers
+ * must not be kept beyond the operation they were asked for. Requests larger
+ * than {@link #MAX_SCRATCH} bytes get a buffer of their own.
+ * <p>
+ * The bytes a slice held are wiped when it is handed out again, so a copied
+ * key or plaintext stays in the slab until its thread has asked for DEPTH more
+ * buffers of that size class. {@link #wipe()} wipes them right away.
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+public final class DirectArena {
+    /**
+     * EMPTY is the zero-length direct buffer, returned for requests of 0 bytes
+     * and passed where the native code expects a buffer but no data (e.g. the
+     * state of a multipart operation held in native memory).
+     */
+    public static final @NotNull ByteBuffer EMPTY = ByteBuffer.allocateDirect(0);
+
+    /**
+     * DEPTH is the number of slices in the slab of every size class. It must be
+     * a power of 2.
+     */
+    public static final int DEPTH = 8;
+
+    /**
+     * MAX_SCRATCH is the largest request served from a slab.
+     */
+    public static final int MAX_SCRATCH = 4096;
+
+    /**
+     * CLASSES holds the size of the slices of every slab.
+     */
+    private static final @NotNull int[] CLASSES = { 64, 256, 1024, MAX_SCRATCH };
+
+    private static final @NotNull ThreadLocal<DirectArena> LOCAL = new ThreadLocal<DirectArena>() {
+        @Override
+        protected DirectArena initialValue() {
+            return new DirectArena();
+        }
+    };
+
+    private final @NotNull ByteBuffer[][] slices = new ByteBuffer[CLASSES.length][];
+    private final @NotNull int[][]        dirty  = new int[CLASSES.length][DEPTH];
+    private final @NotNull int[]          next   = new int[CLASSES.length];
+
+    private DirectArena() {}
+
+    /**
+     * scratch returns a direct buffer of size bytes, with its position at 0
+     * and its limit at size. The content of the buffer is undefined.
+     *
+     * @param size
+     * @return
+     */
+    @NotNull
+    public static ByteBuffer scratch(final int size) {
+        if (size == 0) {
+            return EMPTY;
+        }
+        if (size > MAX_SCRATCH) {
+            return ByteBuffer.allocateDirect(size);
+        }
+        return LOCAL.get().take(size);
+    }
+
+    /**
+     * copyOf returns a scratch copy of the remaining bytes of src, without
+     * moving the position of src.
+     *
+     * @param src
+     * @return
+     */
+    @NotNull
+    public static ByteBuffer copyOf(final @NotNull ByteBuffer src) {
+        final ByteBuffer copy = scratch(src.remaining());
+        copy.duplicate().put(src.duplicate());
+        return copy;
+    }
+
+    /**
+     * wipe wipes every scratch buffer handed out on the calling thread. The
+     * scratch buffers the thread still uses are wiped as well.
+     */
+    public static void wipe() {
+        final DirectArena arena = LOCAL.get();
+        for (int cls = 0; cls < CLASSES.length; cls++) {
+            for (int i = 0; i < DEPTH; i++) {
+                arena.clean(cls, i);
+            }
+        }
+    }
+
+    /**
+     *
+     * @param size a size between 1 and MAX_SCRATCH
+     * @return
+     */
+    @NotNull
+    private ByteBuffer take(final int size) {
+        int cls = 0;
+        while (CLASSES[cls] < size) {
+            cls++;
+        }
+
+        ByteBuffer[] slab = slices[cls];
+        if (slab == null) {
+            slab = carve(CLASSES[cls]);
+            slices[cls] = slab;
+        }
+
+        final int        index = next[cls];
+        final ByteBuffer slice = slab[index];
+        next[cls] = (index + 1) & (DEPTH - 1);
+
+        clean(cls, index);
+        dirty[cls][index] = size;
+        slice.clear();
+        slice.limit(size);
+        return slice;
+    }
+
+    /**
+     * clean wipes the bytes of a slice that were handed out since it was last
+     * wiped.
+     *
+     * @param cls
+     * @param index
+     */
+    private void clean(final int cls,
+                       final int index) {
+        if (dirty[cls][index] == 0) {
+            return;
+        }
+
+        final ByteBuffer used = slices[cls][index].duplicate();
+        used.clear();
+        used.limit(dirty[cls][index]);
+        Stodium.wipeBytes(used);
+        dirty[cls][index] = 0;
+    }
+
+    /**
+     * carve allocates the slab of a size class and slices it.
+     *
+     * @param sliceSize
+     * @return
+     */
+    @NotNull
+    private static ByteBuffer[] carve(final int sliceSize) {
+        final ByteBuffer   slab = ByteBuffer.allocateDirect(sliceSize * DEPTH);
+        final ByteBuffer[] out  = new ByteBuffer[DEPTH];
+        for (int i = 0; i < DEPTH; i++) {
+            slab.limit((i + 1) * sliceSize);
+            slab.position(i * sliceSize);
+            out[i] = slab.slice();
+        }
+        return out;
+    }
+}
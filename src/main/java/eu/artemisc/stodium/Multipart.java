@@ -2,14 +2,25 @@ package eu.artemisc.stodium;
 
 import org.jetbrains.annotations.NotNull;
 
+import java.io.Closeable;
 import java.nio.ByteBuffer;
 
 import eu.artemisc.stodium.exceptions.StodiumException;
 
 /**
+ * Multipart holds the state of a multipart (streaming) operation. The state
+ * right after initialization is kept as well, so the object can be
+ * {@link #reset()} and reused for another message with the same key, without
+ * initializing a new state.
+ * <p>
+ * The state buffers come from the {@link StatePool}, and are returned to it
+ * by {@link #close()}. A Multipart is not safe for use by multiple threads at
+ * once.
+ *
  * @author Jan van de Molengraft [jan@artemisc.eu]
  */
-public class Multipart<T> {
+public class Multipart<T>
+        implements Closeable {
 
     /**
      *
@@ -46,24 +57,72 @@ public class Multipart<T> {
      */
     private final @NotNull ByteBuffer state;
 
+    /**
+     * initial holds a copy of the state as it was right after initialization.
+     */
+    private final @NotNull ByteBuffer initial;
+
+    /**
+     *
+     */
+    private boolean closed;
+
     /**
      *
      * @param spec
-     * @param state
+     * @param state the initialized state
      */
     public Multipart(final @NotNull Spec       spec,
                      final @NotNull ByteBuffer state) {
-        this.spec  = spec;
-        this.state = state;
+        this(spec, state, StatePool.copyOf(state));
     }
 
     /**
+     *
+     * @param spec
+     * @param state
+     * @param initial
+     */
+    private Multipart(final @NotNull Spec       spec,
+                      final @NotNull ByteBuffer state,
+                      final @NotNull ByteBuffer initial) {
+        this.spec    = spec;
+        this.state   = state;
+        this.initial = initial;
+    }
+
+    /**
+     *
+     */
+    private void checkOpen() {
+        if (closed) {
+            throw new IllegalStateException("Stodium: multipart state was closed");
+        }
+    }
+
+    /**
+     * duplicate returns an independent copy of the current state, for example
+     * to produce an intermediate digest without ending the operation.
      *
      * @return
      */
     @NotNull
     public Multipart<T> duplicate() {
-        throw new UnsupportedOperationException();
+        checkOpen();
+        return new Multipart<T>(spec, StatePool.copyOf(state), StatePool.copyOf(initial));
+    }
+
+    /**
+     * reset brings the state back to the point right after initialization,
+     * also after {@link #doFinal(ByteBuffer)} was called.
+     *
+     * @return
+     */
+    @NotNull
+    public Multipart<T> reset() {
+        checkOpen();
+        state.duplicate().put(initial.duplicate());
+        return this;
     }
 
     /**
@@ -75,10 +134,30 @@ public class Multipart<T> {
     @NotNull
     public Multipart<?> update(final @NotNull ByteBuffer src)
             throws StodiumException {
+        checkOpen();
         spec.update(state, src);
         return this;
     }
 
+    /**
+     * update feeds the remaining bytes of every buffer of srcs to the state,
+     * in order, as if they were a single buffer. A {@link NativeMultipart}
+     * does so in a single native call.
+     *
+     * @param srcs
+     * @return
+     * @throws StodiumException
+     */
+    @NotNull
+    public Multipart<?> update(final @NotNull ByteBuffer[] srcs)
+            throws StodiumException {
+        checkOpen();
+        for (final ByteBuffer src : srcs) {
+            spec.update(state, src);
+        }
+        return this;
+    }
+
     /**
      *
      * @param dst
@@ -86,6 +165,7 @@ public class Multipart<T> {
      */
     public void doFinal(final @NotNull ByteBuffer dst)
             throws StodiumException {
+        checkOpen();
         spec.doFinal(state, dst);
     }
 
@@ -96,9 +176,21 @@ public class Multipart<T> {
      */
     public boolean verifyFinal(final @NotNull ByteBuffer cmp)
             throws StodiumException {
-        final ByteBuffer tmp;
-        tmp = ByteBuffer.allocateDirect(cmp.remaining());
+        final ByteBuffer tmp = DirectArena.scratch(cmp.remaining());
         doFinal(tmp);
         return Stodium.isEqual(tmp, cmp);
     }
+
+    /**
+     * close wipes the state and returns its buffers to the {@link StatePool}.
+     */
+    @Override
+    public void close() {
+        if (closed) {
+            return;
+        }
+        closed = true;
+        StatePool.release(state);
+        StatePool.release(initial);
+    }
 }
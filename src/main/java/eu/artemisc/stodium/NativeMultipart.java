@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2017 Project ArteMisc
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+package eu.artemisc.stodium;
+
+import org.jetbrains.annotations.NotNull;
+
+import java.io.FileDescriptor;
+import java.nio.ByteBuffer;
+
+import eu.artemisc.stodium.exceptions.StodiumException;
+
+/**
+ * NativeMultipart is a {@link Multipart} whose state is kept in native memory,
+ * see {@link NativeState}. Duplicating and resetting copy the native state,
+ * without going through a buffer on the Java side.
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+public final class NativeMultipart<T>
+        extends Multipart<T> {
+
+    /**
+     *
+     */
+    private final @NotNull NativeState state;
+
+    /**
+     * initial holds a copy of the state as it was right after initialization.
+     */
+    private final @NotNull NativeState initial;
+
+    /**
+     *
+     * @param state the initialized state
+     */
+    public NativeMultipart(final @NotNull NativeState state) {
+        this(state, state.copy());
+    }
+
+    /**
+     *
+     * @param state
+     * @param initial
+     */
+    private NativeMultipart(final @NotNull NativeState state,
+                            final @NotNull NativeState initial) {
+        super(state, NativeState.NO_STATE);
+        this.state   = state;
+        this.initial = initial;
+    }
+
+    @NotNull
+    @Override
+    public Multipart<T> duplicate() {
+        return new NativeMultipart<T>(state.copy(), initial.copy());
+    }
+
+    /**
+     * updateFile hashes length bytes of a file from offset (or the rest of the
+     * file if length is negative) in a single native call.
+     *
+     * @see NativeState#updateFile(FileDescriptor, long, long)
+     * @param fd
+     * @param offset
+     * @param length
+     * @return
+     * @throws StodiumException
+     */
+    @NotNull
+    public NativeMultipart<T> updateFile(final @NotNull FileDescriptor fd,
+                                         final          long           offset,
+                                         final          long           length)
+            throws StodiumException {
+        state.updateFile(fd, offset, length);
+        return this;
+    }
+
+    /**
+     * updateMapped hashes the remaining bytes of a mapped (or other direct)
+     * buffer in a single native call.
+     *
+     * @see NativeState#updateMapped(ByteBuffer)
+     * @param src
+     * @return
+     * @throws StodiumException
+     */
+    @NotNull
+    public NativeMultipart<T> updateMapped(final @NotNull ByteBuffer src)
+            throws StodiumException {
+        state.updateMapped(src);
+        return this;
+    }
+
+    /**
+     * update hashes the remaining bytes of every buffer of srcs, in order, in
+     * a single native call.
+     *
+     * @see NativeState#updateGather(ByteBuffer[])
+     * @param srcs
+     * @return
+     * @throws StodiumException
+     */
+    @NotNull
+    @Override
+    public Multipart<?> update(final @NotNull ByteBuffer[] srcs)
+            throws StodiumException {
+        state.updateGather(srcs);
+        return this;
+    }
+
+    @NotNull
+    @Override
+    public Multipart<T> reset() {
+        state.restore(initial);
+        return this;
+    }
+
+    /**
+     * close releases the native states without finalizing them.
+     */
+    @Override
+    public void close() {
+        state.close();
+        initial.close();
+        super.close();
+    }
+}
@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2017 Project ArteMisc
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+package eu.artemisc.stodium;
+
+import org.jetbrains.annotations.NotNull;
+
+import java.io.Closeable;
+import java.io.FileDescriptor;
+import java.nio.ByteBuffer;
+
+import eu.artemisc.stodium.exceptions.OperationFailedException;
+import eu.artemisc.stodium.exceptions.StodiumException;
+import eu.artemisc.stodium.sign.MultipartSign;
+
+/**
+ * NativeState wraps the handle of a multipart state that is kept in native
+ * memory, instead of in a direct ByteBuffer on the Java side. It implements
+ * both {@link Multipart.Spec} and {@link MultipartSign.Spec}, ignoring the
+ * state buffers passed to it, so it can back the existing multipart objects.
+ * <p>
+ * The handle is released by the final call, by {@link #close()}, or when the
+ * NativeState is garbage collected. A NativeState is not safe for use by
+ * multiple threads at once, but releasing a handle never frees a state that a
+ * native call on another thread (such as a copy) is still reading: the
+ * handle is rejected from then on, and the state is wiped when that call
+ * returns.
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+public final class NativeState
+        implements Multipart.Spec, MultipartSign.Spec, Closeable {
+
+    /**
+     * NO_STATE is passed as the state buffer of multipart objects backed by a
+     * NativeState.
+     */
+    public static final @NotNull ByteBuffer NO_STATE = DirectArena.EMPTY;
+
+    /**
+     *
+     */
+    private long handle;
+
+    /**
+     *
+     * @param handle
+     */
+    private NativeState(final long handle) {
+        this.handle = handle;
+    }
+
+    /**
+     * wrap takes ownership of a handle returned by one of the
+     * stodium_state_*_init methods in {@link StodiumJNI}.
+     *
+     * @param handle the handle, 0 if the state could not be initialized
+     * @return the NativeState owning the handle
+     * @throws StodiumException if handle is 0
+     */
+    @NotNull
+    public static NativeState wrap(final long handle)
+            throws StodiumException {
+        if (handle == 0L) {
+            throw new OperationFailedException("Stodium: could not initialize native state");
+        }
+        return new NativeState(handle);
+    }
+
+    /**
+     *
+     * @return
+     */
+    private long handle() {
+        if (handle == 0L) {
+            throw new IllegalStateException("Stodium: native state was already released");
+        }
+        return handle;
+    }
+
+    /**
+     * copy returns a NativeState holding a copy of the current state.
+     *
+     * @return
+     */
+    @NotNull
+    public NativeState copy() {
+        final long copy = StodiumJNI.stodium_state_copy(handle());
+        if (copy == 0L) {
+            throw new OutOfMemoryError("Stodium: could not allocate native state");
+        }
+        return new NativeState(copy);
+    }
+
+    /**
+     * restore replaces the current state with a copy of snapshot. This also
+     * revives a state that was released by a final call.
+     *
+     * @param snapshot
+     */
+    public void restore(final @NotNull NativeState snapshot) {
+        final long copy = StodiumJNI.stodium_state_copy(snapshot.handle());
+        if (copy == 0L) {
+            throw new OutOfMemoryError("Stodium: could not allocate native state");
+        }
+        close();
+        handle = copy;
+    }
+
+    @Override
+    public void update(final @NotNull ByteBuffer state,
+                       final @NotNull ByteBuffer in)
+            throws StodiumException {
+        Stodium.checkStatus(StodiumJNI.stodium_state_update(
+                handle(), Stodium.ensureUsableByteBuffer(in)));
+    }
+
+    /**
+     * updateGather updates the state with the remaining bytes of every buffer
+     * of in, in order, in a single native call.
+     *
+     * @param in
+     * @throws StodiumException
+     */
+    public void updateGather(final @NotNull ByteBuffer[] in)
+            throws StodiumException {
+        Stodium.checkStatus(StodiumJNI.stodium_state_update_gather(
+                handle(), Stodium.ensureUsableByteBuffers(in)));
+    }
+
+    /**
+     * updateFile updates the state with length bytes of an open file, starting
+     * at offset, or with the rest of the file if length is negative. The file
+     * is read by the native code in a single call, and its position is not
+     * moved.
+     *
+     * @param fd     the descriptor of a file opened for reading, e.g. from
+     *               {@link java.io.FileInputStream#getFD()}
+     * @param offset
+     * @param length
+     * @throws StodiumException if the file could not be read, or ended before
+     *                          offset + length
+     */
+    public void updateFile(final @NotNull FileDescriptor fd,
+                           final          long           offset,
+                           final          long           length)
+            throws StodiumException {
+        Stodium.checkSizeMin(offset, 0L);
+        Stodium.checkStatus(StodiumJNI.stodium_state_update_fd(
+                handle(), fd, offset, length));
+    }
+
+    /**
+     * updateMapped updates the state with the remaining bytes of a direct
+     * buffer, usually a {@link java.nio.MappedByteBuffer} from
+     * {@link java.nio.channels.FileChannel#map}, in a single call. The
+     * mapping is read sequentially and prefetched ahead of the hash.
+     *
+     * @param src
+     * @throws StodiumException
+     */
+    public void updateMapped(final @NotNull ByteBuffer src)
+            throws StodiumException {
+        if (!src.isDirect()) {
+            throw new IllegalArgumentException("Stodium: updateMapped requires a direct buffer");
+        }
+        Stodium.checkStatus(StodiumJNI.stodium_state_update_mapped(handle(), src));
+    }
+
+    @Override
+    public void doFinal(final @NotNull ByteBuffer state,
+                        final @NotNull ByteBuffer dst)
+            throws StodiumException {
+        Stodium.checkDestinationWritable(dst);
+
+        final int status = StodiumJNI.stodium_state_final(
+                handle(), Stodium.ensureUsableByteBuffer(dst));
+        handle = 0L;
+        Stodium.checkStatus(status);
+    }
+
+    @Override
+    public void doFinal(final @NotNull ByteBuffer state,
+                        final @NotNull ByteBuffer dst,
+                        final @NotNull ByteBuffer priv)
+            throws StodiumException {
+        Stodium.checkDestinationWritable(dst);
+
+        final int status = StodiumJNI.stodium_state_ed25519ph_final_create(
+                handle(),
+                Stodium.ensureUsableByteBuffer(dst),
+                Stodium.ensureUsableByteBuffer(priv));
+        handle = 0L;
+        Stodium.checkStatus(status);
+    }
+
+    @Override
+    public boolean doFinalVerify(final @NotNull ByteBuffer state,
+                                 final @NotNull ByteBuffer sign,
+                                 final @NotNull ByteBuffer pub)
+            throws StodiumException {
+        final int status = StodiumJNI.stodium_state_ed25519ph_final_verify(
+                handle(),
+                Stodium.ensureUsableByteBuffer(sign),
+                Stodium.ensureUsableByteBuffer(pub));
+        handle = 0L;
+        return status == StodiumJNI.NOERR;
+    }
+
+    /**
+     * close wipes and releases the state, if it was not finalized yet.
+     */
+    @Override
+    public void close() {
+        if (handle != 0L) {
+            StodiumJNI.stodium_state_free(handle);
+            handle = 0L;
+        }
+    }
+
+    @Override
+    protected void finalize()
+            throws Throwable {
+        try {
+            close();
+        } finally {
+            super.finalize();
+        }
+    }
+}
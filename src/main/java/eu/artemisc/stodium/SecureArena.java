@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2017 Project ArteMisc
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+package eu.artemisc.stodium;
+
+import org.jetbrains.annotations.NotNull;
+
+import java.io.Closeable;
+import java.nio.ByteBuffer;
+import java.util.ArrayList;
+import java.util.List;
+
+import eu.artemisc.stodium.exceptions.OperationFailedException;
+import eu.artemisc.stodium.exceptions.StodiumException;
+
+/**
+ * SecureArena allocates {@link SecureBuffer}s from slabs of guarded native
+ * memory. Every slab is a single sodium_malloc region: it is surrounded by
+ * inaccessible guard pages, locked in memory (if the OS allows it) and wiped
+ * when it is released. Key-sized buffers share a slab, so allocating many keys
+ * does not cost a few pages (and a mlock) per key.
+ * <p>
+ * The page protection is set for the arena as a whole: {@link #noAccess()}
+ * makes every buffer of the arena inaccessible until {@link #readOnly()} or
+ * {@link #readWrite()} is called. Keys that need to be protected on their own
+ * should be allocated from an arena of their own.
+ * <p>
+ * The slabs are only released by {@link #close()}, not when the arena is
+ * garbage collected, as the ByteBuffers of its SecureBuffers do not keep the
+ * arena reachable.
+ * <p>
+ * A SecureArena is safe for use by multiple threads.
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+public final class SecureArena
+        implements Closeable {
+    /**
+     * DEFAULT_SLAB_SIZE is the size of the slabs of
+     * {@link #SecureArena()} and {@link #shared()}.
+     */
+    public static final int DEFAULT_SLAB_SIZE = 16 * 1024;
+
+    // protection modes, in the order of jni/sodium_jni_buffer.c
+    static final int NO_ACCESS  = 0;
+    static final int READ_ONLY  = 1;
+    static final int READ_WRITE = 2;
+
+    private static final @NotNull Singleton<SecureArena> SHARED = new Singleton<SecureArena>() {
+        @NotNull
+        @Override
+        protected SecureArena initialize() {
+            return new SecureArena();
+        }
+    };
+
+    private final @NotNull List<Long> slabs;
+    private final          int        slabSize;
+
+    private int     protection = READ_WRITE;
+    private boolean closed;
+
+    /**
+     *
+     */
+    public SecureArena() {
+        this(DEFAULT_SLAB_SIZE);
+    }
+
+    /**
+     *
+     * @param slabSize the size of the slabs buffers are allocated from. Buffers
+     *                 that are larger get a slab of their own.
+     */
+    public SecureArena(final int slabSize) {
+        if (slabSize < 1) {
+            throw new IllegalArgumentException("Stodium: slabSize must be positive");
+        }
+        this.slabSize = slabSize;
+        this.slabs    = new ArrayList<Long>();
+    }
+
+    /**
+     * shared returns the arena used by {@link SecureBuffer#allocate(int)}. It
+     * must not be closed or protected, as it is shared by the whole process.
+     *
+     * @return the shared arena
+     */
+    @NotNull
+    public static SecureArena shared() {
+        return SHARED.get();
+    }
+
+    /**
+     * allocate returns a zeroed buffer of size bytes.
+     *
+     * @param size
+     * @return the new buffer
+     * @throws StodiumException if no guarded memory could be allocated
+     */
+    @NotNull
+    public synchronized SecureBuffer allocate(final int size)
+            throws StodiumException {
+        Stodium.checkSizeMin(size, 1);
+        checkOpen();
+
+        for (final Long slab : slabs) {
+            final ByteBuffer buffer = StodiumJNI.stodium_secure_alloc(slab, size);
+            if (buffer != null) {
+                return new SecureBuffer(this, slab, buffer);
+            }
+        }
+
+        final long slab = StodiumJNI.stodium_secure_slab_create(Math.max(slabSize, size));
+        if (slab == 0L) {
+            throw new OperationFailedException("Stodium: could not allocate guarded memory");
+        }
+        slabs.add(slab);
+        if (protection != READ_WRITE && StodiumJNI.stodium_secure_protect(slab, protection) != 0) {
+            throw new OperationFailedException("Stodium: could not protect guarded memory");
+        }
+
+        final ByteBuffer buffer = StodiumJNI.stodium_secure_alloc(slab, size);
+        if (buffer == null) {
+            throw new OperationFailedException("Stodium: could not allocate guarded memory");
+        }
+        return new SecureBuffer(this, slab, buffer);
+    }
+
+    /**
+     * noAccess makes every buffer of the arena inaccessible. Touching one of
+     * them, from Java or from native code, crashes the process.
+     *
+     * @throws StodiumException
+     */
+    public void noAccess()
+            throws StodiumException {
+        protect(NO_ACCESS);
+    }
+
+    /**
+     * readOnly makes every buffer of the arena read-only. The buffers can still
+     * be used as the key or input of every primitive.
+     *
+     * @throws StodiumException
+     */
+    public void readOnly()
+            throws StodiumException {
+        protect(READ_ONLY);
+    }
+
+    /**
+     * readWrite makes every buffer of the arena readable and writable again.
+     *
+     * @throws StodiumException
+     */
+    public void readWrite()
+            throws StodiumException {
+        protect(READ_WRITE);
+    }
+
+    /**
+     *
+     * @param mode
+     * @throws StodiumException
+     */
+    private synchronized void protect(final int mode)
+            throws StodiumException {
+        checkOpen();
+        for (final Long slab : slabs) {
+            if (StodiumJNI.stodium_secure_protect(slab, mode) != 0) {
+                throw new OperationFailedException("Stodium: could not protect guarded memory");
+            }
+        }
+        protection = mode;
+    }
+
+    /**
+     * release wipes the block of a buffer and returns it to its slab.
+     *
+     * @param slab
+     * @param buffer
+     */
+    synchronized void release(final          long       slab,
+                              final @NotNull ByteBuffer buffer) {
+        if (!closed) {
+            StodiumJNI.stodium_secure_release(slab, buffer);
+        }
+    }
+
+    private void checkOpen() {
+        if (closed) {
+            throw new IllegalStateException("Stodium: SecureArena is closed");
+        }
+    }
+
+    /**
+     * close wipes and releases every slab. All buffers allocated from the arena
+     * become invalid, and must no longer be used.
+     */
+    @Override
+    public synchronized void close() {
+        if (closed) {
+            return;
+        }
+        for (final Long slab : slabs) {
+            StodiumJNI.stodium_secure_slab_free(slab);
+        }
+        slabs.clear();
+        closed = true;
+    }
+}
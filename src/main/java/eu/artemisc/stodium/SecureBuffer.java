@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2017 Project ArteMisc
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+package eu.artemisc.stodium;
+
+import org.jetbrains.annotations.NotNull;
+import org.jetbrains.annotations.Nullable;
+
+import java.io.Closeable;
+import java.nio.ByteBuffer;
+
+import eu.artemisc.stodium.exceptions.StodiumException;
+
+/**
+ * SecureBuffer is a block of guarded native memory, allocated from a
+ * {@link SecureArena}, meant for keys and other secrets. {@link #buffer()} is a
+ * direct ByteBuffer over the block, which can be passed to every primitive
+ * like any other direct buffer, without any copy or extra cost.
+ * <p>
+ * The block is wiped and returned to the arena by {@link #close()}, and only
+ * then: the ByteBuffer returned by {@link #buffer()} does not keep its
+ * SecureBuffer reachable, so the block is not released when the SecureBuffer
+ * is garbage collected. A SecureBuffer that is never closed keeps its block
+ * until its arena is closed. The ByteBuffer (and any duplicate of it) must not
+ * be used after close, as the block may be handed out again.
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+public final class SecureBuffer
+        implements Closeable {
+    private final @NotNull  SecureArena arena;
+    private final           long        slab;
+    private       @Nullable ByteBuffer  buffer;
+
+    SecureBuffer(final @NotNull SecureArena arena,
+                 final          long        slab,
+                 final @NotNull ByteBuffer  buffer) {
+        this.arena  = arena;
+        this.slab   = slab;
+        this.buffer = buffer;
+    }
+
+    /**
+     * allocate returns a zeroed buffer of size bytes from the shared arena.
+     *
+     * @param size
+     * @return the new buffer
+     * @throws StodiumException if no guarded memory could be allocated
+     */
+    @NotNull
+    public static SecureBuffer allocate(final int size)
+            throws StodiumException {
+        return SecureArena.shared().allocate(size);
+    }
+
+    /**
+     * buffer returns the direct ByteBuffer over the block. Its position and
+     * limit are the caller's to move.
+     *
+     * @return the buffer
+     */
+    @NotNull
+    public ByteBuffer buffer() {
+        if (buffer == null) {
+            throw new IllegalStateException("Stodium: SecureBuffer is closed");
+        }
+        return buffer;
+    }
+
+    /**
+     *
+     * @return the size of the block
+     */
+    public int capacity() {
+        return buffer().capacity();
+    }
+
+    /**
+     * wipe zeroes the whole block, regardless of the position and limit of the
+     * buffer.
+     */
+    public void wipe() {
+        final ByteBuffer all = buffer().duplicate();
+        all.clear();
+        StodiumJNI.sodium_memzero(all);
+    }
+
+    /**
+     * noAccess makes the arena of this buffer inaccessible. Buffers from
+     * {@link #allocate(int)} share an arena with the whole process, and should
+     * not be protected.
+     *
+     * @see SecureArena#noAccess()
+     * @throws StodiumException
+     */
+    public void noAccess()
+            throws StodiumException {
+        arena.noAccess();
+    }
+
+    /**
+     * readOnly makes the arena of this buffer read-only.
+     *
+     * @see SecureArena#readOnly()
+     * @throws StodiumException
+     */
+    public void readOnly()
+            throws StodiumException {
+        arena.readOnly();
+    }
+
+    /**
+     * readWrite makes the arena of this buffer readable and writable.
+     *
+     * @see SecureArena#readWrite()
+     * @throws StodiumException
+     */
+    public void readWrite()
+            throws StodiumException {
+        arena.readWrite();
+    }
+
+    /**
+     * close wipes the block and returns it to the arena.
+     */
+    @Override
+    public synchronized void close() {
+        final ByteBuffer released = buffer;
+        if (released != null) {
+            buffer = null;
+            released.limit(0);
+            arena.release(slab, released);
+        }
+    }
+}
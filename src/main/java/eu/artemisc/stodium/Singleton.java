@@ -13,6 +13,11 @@ import org.jetbrains.annotations.Nullable;
 /**
  * Singleton implements a simple mechanism to support lazy initialization of
  * singleton classes.
+ * <p>
+ * Only the first calls to get() synchronize: once the instance has been
+ * published through the volatile field, get() is a single volatile read,
+ * without taking the monitor. {@link Stodium#preload()} initializes the
+ * primitive instances ahead of their first use.
  *
  * @param <T> the singleton instance's type.
  *
@@ -22,7 +27,7 @@ public abstract class Singleton<T> {
     /**
      *
      */
-    private @Nullable T instance;
+    private volatile @Nullable T instance;
 
     /**
      *
@@ -37,11 +42,17 @@ public abstract class Singleton<T> {
      */
     @NotNull
     public final T get() {
+        final T published = instance;
+        if (published != null) {
+            return published;
+        }
         synchronized (this) {
-            if (instance == null) {
-                instance = initialize();
+            T result = instance;
+            if (result == null) {
+                result = initialize();
+                instance = result;
             }
-            return instance;
+            return result;
         }
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2017 Project ArteMisc
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+package eu.artemisc.stodium;
+
+import org.jetbrains.annotations.NotNull;
+
+import java.nio.ByteBuffer;
+import java.util.concurrent.ConcurrentHashMap;
+import java.util.concurrent.ConcurrentLinkedQueue;
+import java.util.concurrent.atomic.AtomicInteger;
+
+/**
+ * StatePool is a bounded pool of direct ByteBuffers, used for the states and
+ * scratch buffers of multipart operations. Allocating direct buffers is slow
+ * and puts pressure on the garbage collector, while these buffers are small
+ * and short-lived.
+ * <p>
+ * Buffers are pooled per capacity, up to {@link #MAX_POOLED} buffers of every
+ * capacity, and are wiped when they are returned to the pool.
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+public final class StatePool {
+
+    /**
+     * MAX_POOLED is the maximum number of idle buffers kept per capacity.
+     */
+    public static final int MAX_POOLED = 64;
+
+    /**
+     *
+     */
+    private static final class Bucket {
+        final @NotNull ConcurrentLinkedQueue<ByteBuffer> buffers = new ConcurrentLinkedQueue<ByteBuffer>();
+        final @NotNull AtomicInteger                     size    = new AtomicInteger();
+    }
+
+    /**
+     *
+     */
+    private static final @NotNull ConcurrentHashMap<Integer, Bucket> BUCKETS = new ConcurrentHashMap<Integer, Bucket>();
+
+    private StatePool() {}
+
+    /**
+     * acquire returns a direct buffer with the given capacity, with its
+     * position at 0 and its limit at its capacity. The contents of the buffer
+     * are zero.
+     *
+     * @param capacity
+     * @return
+     */
+    @NotNull
+    public static ByteBuffer acquire(final int capacity) {
+        if (capacity == 0) {
+            return DirectArena.EMPTY;
+        }
+
+        final Bucket bucket = BUCKETS.get(capacity);
+        if (bucket != null) {
+            final ByteBuffer buffer = bucket.buffers.poll();
+            if (buffer != null) {
+                bucket.size.decrementAndGet();
+                return buffer;
+            }
+        }
+        return ByteBuffer.allocateDirect(capacity);
+    }
+
+    /**
+     * copyOf returns a pooled copy of the remaining bytes of src, without
+     * moving the position of src.
+     *
+     * @param src
+     * @return
+     */
+    @NotNull
+    public static ByteBuffer copyOf(final @NotNull ByteBuffer src) {
+        final ByteBuffer copy = acquire(src.remaining());
+        copy.duplicate().put(src.duplicate());
+        return copy;
+    }
+
+    /**
+     * release wipes the buffer and returns it to the pool. The buffer must not
+     * be used after it was released.
+     *
+     * @param buffer
+     */
+    public static void release(final @NotNull ByteBuffer buffer) {
+        if (buffer.capacity() == 0 || !buffer.isDirect() || buffer.isReadOnly()) {
+            return;
+        }
+
+        buffer.clear();
+        Stodium.wipeBytes(buffer.duplicate());
+
+        Bucket bucket = BUCKETS.get(buffer.capacity());
+        if (bucket == null) {
+            final Bucket created = new Bucket();
+            bucket = BUCKETS.putIfAbsent(buffer.capacity(), created);
+            if (bucket == null) {
+                bucket = created;
+            }
+        }
+
+        if (bucket.size.incrementAndGet() > MAX_POOLED) {
+            bucket.size.decrementAndGet();
+            return;
+        }
+        bucket.buffers.offer(buffer);
+    }
+}
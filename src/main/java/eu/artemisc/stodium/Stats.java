@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2017 Project ArteMisc
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+package eu.artemisc.stodium;
+
+import org.jetbrains.annotations.NotNull;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+
+/**
+ * Stats is a snapshot of the instrumentation counters of the native wrappers.
+ * Every group of primitives (e.g. {@link #AEAD}, {@link #HASH}) has its own
+ * counters:
+ * <ul>
+ *     <li>{@link #CALLS}: the number of calls</li>
+ *     <li>{@link #BYTES}: the number of input bytes passed to those calls</li>
+ *     <li>{@link #DIRECT}: the number of direct buffers passed</li>
+ *     <li>{@link #INDIRECT}: the number of heap buffers passed</li>
+ *     <li>{@link #COPIED}: the number of bytes copied between the Java heap
+ *         and native memory for heap buffers</li>
+ * </ul>
+ * The counters only ever increase; use {@link #since(Stats)} to get the
+ * counts of an interval. The counters are only compiled into the native
+ * library when it is built with STODIUM_STATS; otherwise {@link #isEnabled()}
+ * returns false and all counters are 0.
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+public final class Stats {
+    // groups, in the order of jni/stodium_stats.h
+    public static final int AEAD         = 0;
+    public static final int AUTH         = 1;
+    public static final int BOX          = 2;
+    public static final int CORE         = 3;
+    public static final int GENERICHASH  = 4;
+    public static final int HASH         = 5;
+    public static final int KDF          = 6;
+    public static final int KX           = 7;
+    public static final int ONETIMEAUTH  = 8;
+    public static final int PWHASH       = 9;
+    public static final int RANDOMBYTES  = 10;
+    public static final int SCALARMULT   = 11;
+    public static final int SECRETBOX    = 12;
+    public static final int SECRETSTREAM = 13;
+    public static final int SHORTHASH    = 14;
+    public static final int SIGN         = 15;
+    public static final int UTILS        = 16;
+    public static final int GROUPS       = 17;
+
+    // counters of every group
+    public static final int CALLS    = 0;
+    public static final int BYTES    = 1;
+    public static final int DIRECT   = 2;
+    public static final int INDIRECT = 3;
+    public static final int COPIED   = 4;
+    public static final int COUNTERS = 5;
+
+    private static final @NotNull String[] GROUP_NAMES = {
+            "aead", "auth", "box", "core", "generichash", "hash", "kdf", "kx",
+            "onetimeauth", "pwhash", "randombytes", "scalarmult", "secretbox",
+            "secretstream", "shorthash", "sign", "utils"
+    };
+
+    private final @NotNull long[]  values;
+    private final          boolean enabled;
+
+    private Stats(final @NotNull long[]  values,
+                  final          boolean enabled) {
+        this.values  = values;
+        this.enabled = enabled;
+    }
+
+    /**
+     * snapshot reads the current counters, merged over all threads.
+     *
+     * @return the counters at the time of the call
+     */
+    @NotNull
+    public static Stats snapshot() {
+        final ByteBuffer dst = ByteBuffer.allocateDirect(GROUPS * COUNTERS * 8)
+                .order(ByteOrder.nativeOrder());
+        final int count = StodiumJNI.stodium_stats(dst);
+        if (count < 0) {
+            throw new IllegalStateException("Stodium: native stats do not match Stats");
+        }
+
+        final long[] values = new long[GROUPS * COUNTERS];
+        for (int i = 0; i < count; i++) {
+            values[i] = dst.getLong(i * 8);
+        }
+        return new Stats(values, count > 0);
+    }
+
+    /**
+     * groupName returns the name of a group, for use as a metric label.
+     *
+     * @param group the group, e.g. {@link #AEAD}
+     * @return the lower case name of the group, e.g. "aead"
+     */
+    @NotNull
+    public static String groupName(final int group) {
+        return GROUP_NAMES[group];
+    }
+
+    /**
+     *
+     * @return false if the native library was built without counters
+     */
+    public boolean isEnabled() {
+        return enabled;
+    }
+
+    /**
+     * get returns a single counter of a group.
+     *
+     * @param group   the group, e.g. {@link #AEAD}
+     * @param counter the counter, e.g. {@link #CALLS}
+     * @return the value of the counter
+     */
+    public long get(final int group,
+                    final int counter) {
+        if (group < 0 || group >= GROUPS || counter < 0 || counter >= COUNTERS) {
+            throw new IndexOutOfBoundsException("Stodium: no such counter");
+        }
+        return values[group * COUNTERS + counter];
+    }
+
+    /**
+     * total returns the sum of a counter over all groups.
+     *
+     * @param counter the counter, e.g. {@link #COPIED}
+     * @return the sum of the counter
+     */
+    public long total(final int counter) {
+        long sum = 0;
+        for (int group = 0; group < GROUPS; group++) {
+            sum += get(group, counter);
+        }
+        return sum;
+    }
+
+    /**
+     * since returns the counts between an earlier snapshot and this one.
+     *
+     * @param earlier a snapshot taken before this one
+     * @return the difference of every counter
+     */
+    @NotNull
+    public Stats since(final @NotNull Stats earlier) {
+        final long[] delta = new long[values.length];
+        for (int i = 0; i < values.length; i++) {
+            delta[i] = values[i] - earlier.values[i];
+        }
+        return new Stats(delta, enabled);
+    }
+}
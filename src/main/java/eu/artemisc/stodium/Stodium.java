@@ -14,10 +14,26 @@ import java.nio.ByteBuffer;
 import java.util.Arrays;
 import java.util.Locale;
 
+import eu.artemisc.stodium.aead.AEAD;
+import eu.artemisc.stodium.auth.Auth;
+import eu.artemisc.stodium.box.Box;
+import eu.artemisc.stodium.codecs.Codec;
+import eu.artemisc.stodium.core.Core;
 import eu.artemisc.stodium.exceptions.ConstraintViolationException;
 import eu.artemisc.stodium.exceptions.OperationFailedException;
 import eu.artemisc.stodium.exceptions.ReadOnlyBufferException;
 import eu.artemisc.stodium.exceptions.StodiumException;
+import eu.artemisc.stodium.generichash.GenericHash;
+import eu.artemisc.stodium.hash.Hash;
+import eu.artemisc.stodium.kdf.Kdf;
+import eu.artemisc.stodium.kx.Kx;
+import eu.artemisc.stodium.onetimeauth.OneTimeAuth;
+import eu.artemisc.stodium.pwhash.PwHash;
+import eu.artemisc.stodium.scalarmult.ScalarMult;
+import eu.artemisc.stodium.secretbox.SecretBox;
+import eu.artemisc.stodium.secretstream.SecretStream;
+import eu.artemisc.stodium.shorthash.ShortHash;
+import eu.artemisc.stodium.sign.Sign;
 
 /**
  * Stodium is an abstract class with static methods. It is an attempt to
@@ -38,6 +54,12 @@ public final class Stodium {
      */
     private static final @NotNull byte[] EMPTY_BUFFER = new byte[1024];
 
+    /**
+     * READONLY_HEAP is true if the native code is able to read the backing
+     * array of read-only heap buffers.
+     */
+    private static final boolean READONLY_HEAP = StodiumJNI.stodium_supports_readonly_heap() != 0;
+
     /**
      *
      * @param status
@@ -118,6 +140,18 @@ public final class Stodium {
         checkSize(src, lower, Integer.MAX_VALUE);
     }
 
+    /**
+     *
+     * @param src
+     * @param lower
+     * @throws ConstraintViolationException
+     */
+    public static void checkSizeMin(final long src,
+                                    final long lower)
+            throws ConstraintViolationException {
+        checkSize(src, lower, Long.MAX_VALUE);
+    }
+
     /**
      *
      * @param src
@@ -196,23 +230,67 @@ public final class Stodium {
     }
 
     /**
+     * isEqual compares the remaining bytes of a and b in constant time, using
+     * sodium_memcmp. Read-only heap buffers that the native code can not read
+     * directly are compared in Java instead, to avoid copying them.
      *
      * @param a
      * @param b
-     * @return
+     * @return true iff a and b hold the same bytes
      */
     public static boolean isEqual(final @NotNull ByteBuffer a,
                                   final @NotNull ByteBuffer b) {
         if (a.remaining() != b.remaining()) {
             return false;
         }
+        if (!isNativeReadable(a) || !isNativeReadable(b)) {
+            return isEqualFallback(a, b);
+        }
+        return StodiumJNI.NOERR == StodiumJNI.sodium_memcmp(a, b);
+    }
+
+    /**
+     * isEqualFallback is the Java version of {@link #isEqual(ByteBuffer, ByteBuffer)},
+     * for buffers of the same length.
+     */
+    private static boolean isEqualFallback(final @NotNull ByteBuffer a,
+                                           final @NotNull ByteBuffer b) {
+        final int length = a.remaining();
+        final int offsetA = a.position();
+        final int offsetB = b.position();
+
         int result = 0;
-        for (int i = 0; i < a.remaining(); i++) {
-            result |= a.get(i) ^ b.get(i);
+        for (int i = 0; i < length; i++) {
+            result |= a.get(offsetA + i) ^ b.get(offsetB + i);
         }
         return result == 0;
     }
 
+    /**
+     * compare compares the remaining bytes of a and b as little-endian numbers
+     * in constant time, using sodium_compare. This is useful for nonces and
+     * counters.
+     *
+     * @param a
+     * @param b
+     * @return -1, 0 or 1 if a is smaller than, equal to or larger than b
+     * @throws ConstraintViolationException if a and b differ in length
+     */
+    public static int compare(final @NotNull ByteBuffer a,
+                              final @NotNull ByteBuffer b)
+            throws ConstraintViolationException {
+        checkSize(b.remaining(), a.remaining());
+        return StodiumJNI.sodium_compare(ensureUsableByteBuffer(a), ensureUsableByteBuffer(b));
+    }
+
+    /**
+     * isNativeReadable returns true if the native code can read buff without
+     * it being copied first by {@link #ensureUsableByteBuffer(ByteBuffer)}.
+     */
+    private static boolean isNativeReadable(final @NotNull ByteBuffer buff) {
+        return buff.isDirect() || !buff.isReadOnly() || READONLY_HEAP;
+    }
+
     /**
      *
      * @param a
@@ -254,20 +332,21 @@ public final class Stodium {
     @NotNull
     public static String bin2hex(final @NotNull ByteBuffer bin)
             throws StodiumException {
-        throw new UnsupportedOperationException();
+        return Codec.hex().encode(bin);
     }
 
     /**
      * based on sodium_hex2bin
      * @param hex
      * @param dst
+     * @throws StodiumException if hex is not a valid hex string
      *
      * @see <a href="https://github.com/jedisct1/libsodium/blob/master/src/libsodium/sodium/utils.c">libsodium source</a>
      */
     public static void hex2bin(final @NotNull CharSequence hex,
                                final @NotNull ByteBuffer   dst)
-            throws ConstraintViolationException {
-        throw new UnsupportedOperationException();
+            throws StodiumException {
+        Codec.hex().decode(dst, hex);
     }
 
     /**
@@ -276,10 +355,15 @@ public final class Stodium {
      * native code.
      * <p>
      * If the passed buff argument represents a JNI usable ByteBuffer, it is
-     * directly returned. Otherwise, the method allocates a direct buffer with
-     * the size of {@code buff.remaining()}, and copies the contents of buff.
+     * directly returned. Otherwise, the contents of buff are copied into a
+     * {@link DirectArena} scratch buffer of {@code buff.remaining()} bytes.
      * This copy is guaranteed to work with the native code (as it is a direct
-     * buffer) and therefore is returned.
+     * buffer) and therefore is returned. It is only valid for the native call
+     * it is passed to.
+     * <p>
+     * The native code honours the position and limit of every buffer, so
+     * slicing is never needed. Read-only heap buffers are only copied on JVMs
+     * where the native code can not read their backing array.
      *
      * @param buff the original buffer
      * @return a ByteBuffer that is guaranteed to function correctly in the
@@ -287,15 +371,61 @@ public final class Stodium {
      */
     @NotNull
     public static ByteBuffer ensureUsableByteBuffer(final @NotNull ByteBuffer buff) {
-        if (buff.isDirect() || !buff.isReadOnly()) {
+        if (isNativeReadable(buff)) {
             return buff;
         }
 
-        final ByteBuffer direct = ByteBuffer.allocateDirect(buff.remaining());
-        direct.mark();
-        direct.put(buff.slice());
-        direct.reset();
-        return direct;
+        return DirectArena.copyOf(buff);
+    }
+
+    /**
+     * ensureUsableByteBuffers is {@link #ensureUsableByteBuffer} for the
+     * fragments of a gather/scatter call. The fragments that have to be copied
+     * are copied side by side into a single scratch buffer, so that any number
+     * of them can be passed to one native call. The array itself is only
+     * copied if one of its fragments had to be.
+     *
+     * @param buffs the fragments
+     * @return fragments that are guaranteed to function correctly in the
+     *         native code
+     */
+    @NotNull
+    public static ByteBuffer[] ensureUsableByteBuffers(final @NotNull ByteBuffer[] buffs) {
+        int     copied = 0;
+        boolean usable = true;
+        for (final ByteBuffer buff : buffs) {
+            if (!isNativeReadable(buff)) {
+                copied += buff.remaining();
+                usable  = false;
+            }
+        }
+        if (usable) {
+            return buffs;
+        }
+
+        final ByteBuffer   scratch = DirectArena.scratch(copied).duplicate();
+        final ByteBuffer[] copies  = buffs.clone();
+        for (int i = 0; i < buffs.length; i++) {
+            if (isNativeReadable(buffs[i])) {
+                continue;
+            }
+            scratch.limit(scratch.position() + buffs[i].remaining());
+            copies[i] = scratch.slice();
+            copies[i].duplicate().put(buffs[i].duplicate());
+            scratch.position(scratch.limit());
+        }
+        return copies;
+    }
+
+    /**
+     * remaining returns the sum of the remaining bytes of the fragments.
+     */
+    public static long remaining(final @NotNull ByteBuffer[] buffs) {
+        long length = 0L;
+        for (final ByteBuffer buff : buffs) {
+            length += buff.remaining();
+        }
+        return length;
     }
 
     /**
@@ -315,6 +445,87 @@ public final class Stodium {
         throw new ReadOnlyBufferException("Stodium: output buffer is readonly");
     }
 
+    /**
+     * checkDestinationWritable checks every fragment of a scatter destination,
+     * as {@link #checkDestinationWritable(ByteBuffer)} does.
+     */
+    public static void checkDestinationWritable(final @NotNull ByteBuffer[] buffs) {
+        for (final ByteBuffer buff : buffs) {
+            checkDestinationWritable(buff);
+        }
+    }
+
+    /**
+     * checkAlias throws an exception if a scatter destination and a gather
+     * source overlap without being exactly in place: a fragment of dst over
+     * the same array as a fragment of src must either not share a byte with
+     * it, or hold every shared byte at the same offset in the message. The
+     * native code rejects the same overlaps between direct fragments, whose
+     * addresses are not visible from Java, by failing the call.
+     *
+     * @param dst the fragments of the output
+     * @param src the fragments of the input
+     * @throws ConstraintViolationException if the fragments overlap
+     */
+    public static void checkAlias(final @NotNull ByteBuffer[] dst,
+                                  final @NotNull ByteBuffer[] src)
+            throws ConstraintViolationException {
+        long dstPos = 0L;
+        for (final ByteBuffer d : dst) {
+            long srcPos = 0L;
+            for (final ByteBuffer s : src) {
+                if (d.hasArray() && s.hasArray() && d.array() == s.array() &&
+                        d.hasRemaining() && s.hasRemaining()) {
+                    final long dStart = d.arrayOffset() + d.position();
+                    final long sStart = s.arrayOffset() + s.position();
+                    if (dStart < sStart + s.remaining() && sStart < dStart + d.remaining() &&
+                            dStart - dstPos != sStart - srcPos) {
+                        throw new ConstraintViolationException("Stodium: buffers overlap without being in place");
+                    }
+                }
+                srcPos += s.remaining();
+            }
+            dstPos += d.remaining();
+        }
+    }
+
+    /**
+     * startWorkerPool starts the native worker pool used by the batch methods
+     * (e.g. {@link eu.artemisc.stodium.aead.AEAD#encryptBatch}), which then
+     * spread large batches over the given number of threads in addition to
+     * the calling thread. Without a pool, batches run on the calling thread.
+     *
+     * @param threads the number of worker threads, usually the number of
+     *                cores minus one
+     * @throws StodiumException if the pool is already running, or the
+     *         threads could not be started
+     */
+    public static void startWorkerPool(final int threads)
+            throws StodiumException {
+        checkSizeMin(threads, 1);
+        if (StodiumJNI.stodium_pool_start(threads) != StodiumJNI.NOERR) {
+            throw new OperationFailedException("Stodium: could not start worker pool");
+        }
+    }
+
+    /**
+     * stopWorkerPool stops the native worker pool, after the batch it is
+     * working on (if any) has finished. Does nothing if no pool is running.
+     */
+    public static void stopWorkerPool() {
+        StodiumJNI.stodium_pool_stop();
+    }
+
+    /**
+     * workerPoolSize returns the number of threads in the native worker pool,
+     * or 0 if it was not started.
+     *
+     * @return the number of worker threads
+     */
+    public static int workerPoolSize() {
+        return StodiumJNI.stodium_pool_size();
+    }
+
     /**
      * version returns the value of sodium_version_string().
      *
@@ -324,5 +535,57 @@ public final class Stodium {
     public static String version() {
         return StodiumJNI.sodium_version_string();
     }
+
+    /**
+     * preload initializes the instance of every primitive, the constants and
+     * the CPU features up front, e.g. from Application.onCreate(), so that
+     * the first call to a factory such as {@link AEAD#instance()} on a hot
+     * path does not pay for class loading and the (synchronized) first
+     * initialization. Later lookups never synchronize, see {@link Singleton}.
+     * <p>
+     * The shared PwHashExecutor and SecureArena are left alone, as they start
+     * threads and lock memory.
+     * <p>
+     * preload is not run from the static initializer of Stodium on purpose.
+     * The primitive classes use Stodium while they initialize, so a thread
+     * initializing Stodium would wait for, e.g., AEAD, while another thread
+     * initializing AEAD waits for Stodium, and neither class would finish.
+     */
+    public static void preload() {
+        CpuFeatures.mask();
+
+        AEAD.aesInstance();
+        AEAD.chachaInstance();
+        AEAD.chachaIetfInstance();
+        AEAD.xchachaIetfInstance();
+        Auth.HmacSha256Instance();
+        Auth.HmacSha512Instance();
+        Auth.HmacSha512256Instance();
+        Box.curve25519xsalsa20poly1305Instance();
+        Box.curve25519xchacha20poly1305Instance();
+        Codec.hex();
+        Codec.base64Original();
+        Codec.base64OriginalNoPadding();
+        Codec.base64UrlSafe();
+        Codec.base64UrlSafeNoPadding();
+        Core.hsalsa20();
+        Core.hchacha20();
+        GenericHash.blake2bInstance();
+        Hash.sha256Instance();
+        Hash.sha512Instance();
+        Kdf.blake2b();
+        Kx.x25519Blake2b();
+        OneTimeAuth.poly1305Instance();
+        PwHash.argon2iInstance();
+        PwHash.argon2idInstance();
+        PwHash.scryptInstance();
+        ScalarMult.curve25519Instance();
+        SecretBox.xsalsa20poly1305Instance();
+        SecretBox.xchacha20poly1305Instance();
+        SecretStream.xchacha20poly1305Instance();
+        ShortHash.siphash24Instance();
+        ShortHash.siphashx24Instance();
+        Sign.ed25519Instance();
+    }
 }
 
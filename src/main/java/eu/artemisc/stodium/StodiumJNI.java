@@ -10,6 +10,7 @@ package eu.artemisc.stodium;
 import org.jetbrains.annotations.NotNull;
 import org.jetbrains.annotations.Nullable;
 
+import java.io.FileDescriptor;
 import java.nio.ByteBuffer;
 
 /**
@@ -30,8 +31,25 @@ public class StodiumJNI {
     // Library methods
     //
     public static native int stodium_init();
+    public static native int stodium_supports_readonly_heap();
+    public static native int stodium_pool_start(int threads);
+    public static native void stodium_pool_stop();
+    public static native int stodium_pool_size();
+    public static native int stodium_cpu_features();
+    public static native int stodium_stats(
+            @NotNull ByteBuffer dst);
+    public static native int stodium_constants(
+            @NotNull ByteBuffer dst);
     public static native @NotNull String sodium_version_string();
-    // TODO: 8-6-17 add constant time utility methods? like sodium_increment
+    public static native int sodium_memcmp(
+            @NotNull ByteBuffer a,
+            @NotNull ByteBuffer b);
+    public static native int sodium_compare(
+            @NotNull ByteBuffer a,
+            @NotNull ByteBuffer b);
+    public static native int sodium_memzero(
+            @NotNull ByteBuffer dst);
+    // TODO: 8-6-17 add the remaining constant time utility methods, like sodium_increment
 
     //
     // Utility methods
@@ -39,6 +57,8 @@ public class StodiumJNI {
     public static native int randombytes_random();
     public static native int randombytes_uniform(int upper_bound);
     public static native void randombytes_buf(@NotNull ByteBuffer dst);
+    public static native @NotNull ByteBuffer stodium_fork_generation();
+    public static native int stodium_random_refill(@NotNull ByteBuffer dst);
 
     //
     // Core
@@ -105,6 +125,79 @@ public class StodiumJNI {
             @NotNull ByteBuffer ad,
             @NotNull ByteBuffer nonce,
             @NotNull ByteBuffer key);
+    public static native int crypto_aead_aes256gcm_encrypt_batch(
+            @NotNull  ByteBuffer dstCipher,
+            @NotNull  ByteBuffer srcPlain,
+            @NotNull  int[]      table,
+            @Nullable ByteBuffer ad,
+            @NotNull  ByteBuffer nonces,
+                      int        nonceMode,
+            @NotNull  ByteBuffer key,
+            @NotNull  int[]      status);
+    public static native int crypto_aead_aes256gcm_decrypt_batch(
+            @NotNull  ByteBuffer dstPlain,
+            @NotNull  ByteBuffer srcCipher,
+            @NotNull  int[]      table,
+            @Nullable ByteBuffer ad,
+            @NotNull  ByteBuffer nonces,
+                      int        nonceMode,
+            @NotNull  ByteBuffer key,
+            @NotNull  int[]      status);
+    public static native int crypto_aead_aes256gcm_encrypt_prefixed(
+            @NotNull  ByteBuffer dstCipher,
+            @NotNull  ByteBuffer srcPlain,
+            @Nullable ByteBuffer ad,
+            @NotNull  ByteBuffer nonce,
+            @NotNull  ByteBuffer key);
+    public static native int crypto_aead_aes256gcm_decrypt_prefixed(
+            @NotNull  ByteBuffer dstPlain,
+            @NotNull  ByteBuffer srcCipher,
+            @Nullable ByteBuffer ad,
+            @NotNull  ByteBuffer key);
+
+    public static native int crypto_aead_aes256gcm_encrypt_inplace(
+            @NotNull  ByteBuffer buffer,
+                      int        plainLength,
+            @Nullable ByteBuffer ad,
+            @NotNull  ByteBuffer nonce,
+            @NotNull  ByteBuffer key);
+    public static native int crypto_aead_aes256gcm_decrypt_inplace(
+            @NotNull  ByteBuffer buffer,
+            @Nullable ByteBuffer ad,
+            @NotNull  ByteBuffer nonce,
+            @NotNull  ByteBuffer key);
+    public static native int crypto_aead_aes256gcm_encrypt_detached_inplace(
+            @NotNull  ByteBuffer buffer,
+            @NotNull  ByteBuffer dstMac,
+            @Nullable ByteBuffer ad,
+            @NotNull  ByteBuffer nonce,
+            @NotNull  ByteBuffer key);
+    public static native int crypto_aead_aes256gcm_decrypt_detached_inplace(
+            @NotNull  ByteBuffer buffer,
+            @NotNull  ByteBuffer srcMac,
+            @Nullable ByteBuffer ad,
+            @NotNull  ByteBuffer nonce,
+            @NotNull  ByteBuffer key);
+    public static native int crypto_aead_aes256gcm_verify_detached(
+            @NotNull  ByteBuffer srcCipher,
+            @NotNull  ByteBuffer srcMac,
+            @Nullable ByteBuffer ad,
+            @NotNull  ByteBuffer nonce,
+            @NotNull  ByteBuffer key);
+    public static native int crypto_aead_aes256gcm_encrypt_detached_gather(
+            @NotNull  ByteBuffer[] dstCipher,
+            @NotNull  ByteBuffer   dstMac,
+            @NotNull  ByteBuffer[] srcPlain,
+            @Nullable ByteBuffer   ad,
+            @NotNull  ByteBuffer   nonce,
+            @NotNull  ByteBuffer   key);
+    public static native int crypto_aead_aes256gcm_decrypt_detached_gather(
+            @NotNull  ByteBuffer[] dstPlain,
+            @NotNull  ByteBuffer[] srcCipher,
+            @NotNull  ByteBuffer   srcMac,
+            @Nullable ByteBuffer   ad,
+            @NotNull  ByteBuffer   nonce,
+            @NotNull  ByteBuffer   key);
 
     //
     // AEAD - Chacha20Poly1305
@@ -140,6 +233,79 @@ public class StodiumJNI {
             @NotNull ByteBuffer ad,
             @NotNull ByteBuffer nonce,
             @NotNull ByteBuffer key);
+    public static native int crypto_aead_chacha20poly1305_encrypt_batch(
+            @NotNull  ByteBuffer dstCipher,
+            @NotNull  ByteBuffer srcPlain,
+            @NotNull  int[]      table,
+            @Nullable ByteBuffer ad,
+            @NotNull  ByteBuffer nonces,
+                      int        nonceMode,
+            @NotNull  ByteBuffer key,
+            @NotNull  int[]      status);
+    public static native int crypto_aead_chacha20poly1305_decrypt_batch(
+            @NotNull  ByteBuffer dstPlain,
+            @NotNull  ByteBuffer srcCipher,
+            @NotNull  int[]      table,
+            @Nullable ByteBuffer ad,
+            @NotNull  ByteBuffer nonces,
+                      int        nonceMode,
+            @NotNull  ByteBuffer key,
+            @NotNull  int[]      status);
+    public static native int crypto_aead_chacha20poly1305_encrypt_prefixed(
+            @NotNull  ByteBuffer dstCipher,
+            @NotNull  ByteBuffer srcPlain,
+            @Nullable ByteBuffer ad,
+            @NotNull  ByteBuffer nonce,
+            @NotNull  ByteBuffer key);
+    public static native int crypto_aead_chacha20poly1305_decrypt_prefixed(
+            @NotNull  ByteBuffer dstPlain,
+            @NotNull  ByteBuffer srcCipher,
+            @Nullable ByteBuffer ad,
+            @NotNull  ByteBuffer key);
+
+    public static native int crypto_aead_chacha20poly1305_encrypt_inplace(
+            @NotNull  ByteBuffer buffer,
+                      int        plainLength,
+            @Nullable ByteBuffer ad,
+            @NotNull  ByteBuffer nonce,
+            @NotNull  ByteBuffer key);
+    public static native int crypto_aead_chacha20poly1305_decrypt_inplace(
+            @NotNull  ByteBuffer buffer,
+            @Nullable ByteBuffer ad,
+            @NotNull  ByteBuffer nonce,
+            @NotNull  ByteBuffer key);
+    public static native int crypto_aead_chacha20poly1305_encrypt_detached_inplace(
+            @NotNull  ByteBuffer buffer,
+            @NotNull  ByteBuffer dstMac,
+            @Nullable ByteBuffer ad,
+            @NotNull  ByteBuffer nonce,
+            @NotNull  ByteBuffer key);
+    public static native int crypto_aead_chacha20poly1305_decrypt_detached_inplace(
+            @NotNull  ByteBuffer buffer,
+            @NotNull  ByteBuffer srcMac,
+            @Nullable ByteBuffer ad,
+            @NotNull  ByteBuffer nonce,
+            @NotNull  ByteBuffer key);
+    public static native int crypto_aead_chacha20poly1305_verify_detached(
+            @NotNull  ByteBuffer srcCipher,
+            @NotNull  ByteBuffer srcMac,
+            @Nullable ByteBuffer ad,
+            @NotNull  ByteBuffer nonce,
+            @NotNull  ByteBuffer key);
+    public static native int crypto_aead_chacha20poly1305_encrypt_detached_gather(
+            @NotNull  ByteBuffer[] dstCipher,
+            @NotNull  ByteBuffer   dstMac,
+            @NotNull  ByteBuffer[] srcPlain,
+            @Nullable ByteBuffer   ad,
+            @NotNull  ByteBuffer   nonce,
+            @NotNull  ByteBuffer   key);
+    public static native int crypto_aead_chacha20poly1305_decrypt_detached_gather(
+            @NotNull  ByteBuffer[] dstPlain,
+            @NotNull  ByteBuffer[] srcCipher,
+            @NotNull  ByteBuffer   srcMac,
+            @Nullable ByteBuffer   ad,
+            @NotNull  ByteBuffer   nonce,
+            @NotNull  ByteBuffer   key);
 
     //
     // AEAD - Chacha20Poly1305 (ietf)
@@ -175,6 +341,79 @@ public class StodiumJNI {
             @NotNull ByteBuffer ad,
             @NotNull ByteBuffer nonce,
             @NotNull ByteBuffer key);
+    public static native int crypto_aead_chacha20poly1305_ietf_encrypt_batch(
+            @NotNull  ByteBuffer dstCipher,
+            @NotNull  ByteBuffer srcPlain,
+            @NotNull  int[]      table,
+            @Nullable ByteBuffer ad,
+            @NotNull  ByteBuffer nonces,
+                      int        nonceMode,
+            @NotNull  ByteBuffer key,
+            @NotNull  int[]      status);
+    public static native int crypto_aead_chacha20poly1305_ietf_decrypt_batch(
+            @NotNull  ByteBuffer dstPlain,
+            @NotNull  ByteBuffer srcCipher,
+            @NotNull  int[]      table,
+            @Nullable ByteBuffer ad,
+            @NotNull  ByteBuffer nonces,
+                      int        nonceMode,
+            @NotNull  ByteBuffer key,
+            @NotNull  int[]      status);
+    public static native int crypto_aead_chacha20poly1305_ietf_encrypt_prefixed(
+            @NotNull  ByteBuffer dstCipher,
+            @NotNull  ByteBuffer srcPlain,
+            @Nullable ByteBuffer ad,
+            @NotNull  ByteBuffer nonce,
+            @NotNull  ByteBuffer key);
+    public static native int crypto_aead_chacha20poly1305_ietf_decrypt_prefixed(
+            @NotNull  ByteBuffer dstPlain,
+            @NotNull  ByteBuffer srcCipher,
+            @Nullable ByteBuffer ad,
+            @NotNull  ByteBuffer key);
+
+    public static native int crypto_aead_chacha20poly1305_ietf_encrypt_inplace(
+            @NotNull  ByteBuffer buffer,
+                      int        plainLength,
+            @Nullable ByteBuffer ad,
+            @NotNull  ByteBuffer nonce,
+            @NotNull  ByteBuffer key);
+    public static native int crypto_aead_chacha20poly1305_ietf_decrypt_inplace(
+            @NotNull  ByteBuffer buffer,
+            @Nullable ByteBuffer ad,
+            @NotNull  ByteBuffer nonce,
+            @NotNull  ByteBuffer key);
+    public static native int crypto_aead_chacha20poly1305_ietf_encrypt_detached_inplace(
+            @NotNull  ByteBuffer buffer,
+            @NotNull  ByteBuffer dstMac,
+            @Nullable ByteBuffer ad,
+            @NotNull  ByteBuffer nonce,
+            @NotNull  ByteBuffer key);
+    public static native int crypto_aead_chacha20poly1305_ietf_decrypt_detached_inplace(
+            @NotNull  ByteBuffer buffer,
+            @NotNull  ByteBuffer srcMac,
+            @Nullable ByteBuffer ad,
+            @NotNull  ByteBuffer nonce,
+            @NotNull  ByteBuffer key);
+    public static native int crypto_aead_chacha20poly1305_ietf_verify_detached(
+            @NotNull  ByteBuffer srcCipher,
+            @NotNull  ByteBuffer srcMac,
+            @Nullable ByteBuffer ad,
+            @NotNull  ByteBuffer nonce,
+            @NotNull  ByteBuffer key);
+    public static native int crypto_aead_chacha20poly1305_ietf_encrypt_detached_gather(
+            @NotNull  ByteBuffer[] dstCipher,
+            @NotNull  ByteBuffer   dstMac,
+            @NotNull  ByteBuffer[] srcPlain,
+            @Nullable ByteBuffer   ad,
+            @NotNull  ByteBuffer   nonce,
+            @NotNull  ByteBuffer   key);
+    public static native int crypto_aead_chacha20poly1305_ietf_decrypt_detached_gather(
+            @NotNull  ByteBuffer[] dstPlain,
+            @NotNull  ByteBuffer[] srcCipher,
+            @NotNull  ByteBuffer   srcMac,
+            @Nullable ByteBuffer   ad,
+            @NotNull  ByteBuffer   nonce,
+            @NotNull  ByteBuffer   key);
 
     //
     // AEAD - XChacha20Poly1305 (ietf)
@@ -210,6 +449,79 @@ public class StodiumJNI {
             @NotNull ByteBuffer ad,
             @NotNull ByteBuffer nonce,
             @NotNull ByteBuffer key);
+    public static native int crypto_aead_xchacha20poly1305_ietf_encrypt_batch(
+            @NotNull  ByteBuffer dstCipher,
+            @NotNull  ByteBuffer srcPlain,
+            @NotNull  int[]      table,
+            @Nullable ByteBuffer ad,
+            @NotNull  ByteBuffer nonces,
+                      int        nonceMode,
+            @NotNull  ByteBuffer key,
+            @NotNull  int[]      status);
+    public static native int crypto_aead_xchacha20poly1305_ietf_decrypt_batch(
+            @NotNull  ByteBuffer dstPlain,
+            @NotNull  ByteBuffer srcCipher,
+            @NotNull  int[]      table,
+            @Nullable ByteBuffer ad,
+            @NotNull  ByteBuffer nonces,
+                      int        nonceMode,
+            @NotNull  ByteBuffer key,
+            @NotNull  int[]      status);
+    public static native int crypto_aead_xchacha20poly1305_ietf_encrypt_prefixed(
+            @NotNull  ByteBuffer dstCipher,
+            @NotNull  ByteBuffer srcPlain,
+            @Nullable ByteBuffer ad,
+            @NotNull  ByteBuffer nonce,
+            @NotNull  ByteBuffer key);
+    public static native int crypto_aead_xchacha20poly1305_ietf_decrypt_prefixed(
+            @NotNull  ByteBuffer dstPlain,
+            @NotNull  ByteBuffer srcCipher,
+            @Nullable ByteBuffer ad,
+            @NotNull  ByteBuffer key);
+
+    public static native int crypto_aead_xchacha20poly1305_ietf_encrypt_inplace(
+            @NotNull  ByteBuffer buffer,
+                      int        plainLength,
+            @Nullable ByteBuffer ad,
+            @NotNull  ByteBuffer nonce,
+            @NotNull  ByteBuffer key);
+    public static native int crypto_aead_xchacha20poly1305_ietf_decrypt_inplace(
+            @NotNull  ByteBuffer buffer,
+            @Nullable ByteBuffer ad,
+            @NotNull  ByteBuffer nonce,
+            @NotNull  ByteBuffer key);
+    public static native int crypto_aead_xchacha20poly1305_ietf_encrypt_detached_inplace(
+            @NotNull  ByteBuffer buffer,
+            @NotNull  ByteBuffer dstMac,
+            @Nullable ByteBuffer ad,
+            @NotNull  ByteBuffer nonce,
+            @NotNull  ByteBuffer key);
+    public static native int crypto_aead_xchacha20poly1305_ietf_decrypt_detached_inplace(
+            @NotNull  ByteBuffer buffer,
+            @NotNull  ByteBuffer srcMac,
+            @Nullable ByteBuffer ad,
+            @NotNull  ByteBuffer nonce,
+            @NotNull  ByteBuffer key);
+    public static native int crypto_aead_xchacha20poly1305_ietf_verify_detached(
+            @NotNull  ByteBuffer srcCipher,
+            @NotNull  ByteBuffer srcMac,
+            @Nullable ByteBuffer ad,
+            @NotNull  ByteBuffer nonce,
+            @NotNull  ByteBuffer key);
+    public static native int crypto_aead_xchacha20poly1305_ietf_encrypt_detached_gather(
+            @NotNull  ByteBuffer[] dstCipher,
+            @NotNull  ByteBuffer   dstMac,
+            @NotNull  ByteBuffer[] srcPlain,
+            @Nullable ByteBuffer   ad,
+            @NotNull  ByteBuffer   nonce,
+            @NotNull  ByteBuffer   key);
+    public static native int crypto_aead_xchacha20poly1305_ietf_decrypt_detached_gather(
+            @NotNull  ByteBuffer[] dstPlain,
+            @NotNull  ByteBuffer[] srcCipher,
+            @NotNull  ByteBuffer   srcMac,
+            @Nullable ByteBuffer   ad,
+            @NotNull  ByteBuffer   nonce,
+            @NotNull  ByteBuffer   key);
 
     //
     // Auth
@@ -401,10 +713,91 @@ public class StodiumJNI {
 
     // todo detached
 
+    //
+    // Box - shared key cache
+    //
+    public static native long stodium_box_keys_create(
+            int count,
+            @NotNull ByteBuffer srcPrivate);
+    public static native void stodium_box_keys_free(
+            long keys);
+    public static native int stodium_box_keys_curve25519xsalsa20poly1305_beforenm(
+            long keys,
+            int  slot,
+            @NotNull ByteBuffer srcPublic);
+    public static native int stodium_box_keys_curve25519xsalsa20poly1305_easy(
+            long keys,
+            int  slot,
+            @NotNull ByteBuffer dstCipher,
+            @NotNull ByteBuffer srcPlain,
+            @NotNull ByteBuffer nonce);
+    public static native int stodium_box_keys_curve25519xsalsa20poly1305_open_easy(
+            long keys,
+            int  slot,
+            @NotNull ByteBuffer dstPlain,
+            @NotNull ByteBuffer srcCipher,
+            @NotNull ByteBuffer nonce);
+    public static native int stodium_box_keys_curve25519xchacha20poly1305_beforenm(
+            long keys,
+            int  slot,
+            @NotNull ByteBuffer srcPublic);
+    public static native int stodium_box_keys_curve25519xchacha20poly1305_easy(
+            long keys,
+            int  slot,
+            @NotNull ByteBuffer dstCipher,
+            @NotNull ByteBuffer srcPlain,
+            @NotNull ByteBuffer nonce);
+    public static native int stodium_box_keys_curve25519xchacha20poly1305_open_easy(
+            long keys,
+            int  slot,
+            @NotNull ByteBuffer dstPlain,
+            @NotNull ByteBuffer srcCipher,
+            @NotNull ByteBuffer nonce);
+
+    //
+    // Secure memory
+    //
+    public static native long stodium_secure_slab_create(
+            int capacity);
+    public static native void stodium_secure_slab_free(
+            long slab);
+    public static native @Nullable ByteBuffer stodium_secure_alloc(
+            long slab,
+            int  size);
+    public static native int stodium_secure_release(
+            long slab,
+            @NotNull ByteBuffer buffer);
+    public static native int stodium_secure_protect(
+            long slab,
+            int  mode);
+
     //
     // Codec
     //
 
+    //
+    // Codec
+    //
+    public static native int stodium_codec_encode(
+            @NotNull ByteBuffer dst,
+            @NotNull ByteBuffer src,
+                     int        variant);
+    public static native int stodium_codec_decode(
+            @NotNull ByteBuffer dst,
+            @NotNull ByteBuffer src,
+                     int        variant);
+    public static native int stodium_codec_encode_chars(
+            @NotNull char[]     dst,
+                     int        dstOffset,
+            @NotNull ByteBuffer src,
+                     int        variant);
+    public static native int stodium_codec_decode_chars(
+            @NotNull ByteBuffer dst,
+            @NotNull char[]     src,
+                     int        srcOffset,
+                     int        srcLength,
+                     int        variant);
+
     //
     // Codec Hex
     //
@@ -474,6 +867,29 @@ public class StodiumJNI {
     public static native int crypto_generichash_blake2b_final(
             @NotNull ByteBuffer state,
             @NotNull ByteBuffer out);
+    public static native int crypto_generichash_blake2b_batch(
+            @NotNull  ByteBuffer dst,
+                      int        outlen,
+            @NotNull  ByteBuffer src,
+            @NotNull  int[]      table,
+            @Nullable ByteBuffer key);
+    public static native long crypto_generichash_blake2b_tree_bytes(
+                      int        leaves,
+                      int        outlen);
+    public static native int crypto_generichash_blake2b_tree_leaves(
+            @NotNull  ByteBuffer tree,
+                      int        leaves,
+                      int        outlen,
+                      int        first,
+                      int        leafSize,
+            @NotNull  ByteBuffer src,
+            @Nullable ByteBuffer key);
+    public static native int crypto_generichash_blake2b_tree_root(
+            @NotNull  ByteBuffer tree,
+                      int        leaves,
+                      int        outlen,
+            @NotNull  ByteBuffer dst,
+            @Nullable ByteBuffer key);
 
     //
     // Hash
@@ -535,6 +951,28 @@ public class StodiumJNI {
             @NotNull ByteBuffer context,
             @NotNull ByteBuffer key);
 
+    public static native int crypto_kdf_blake2b_derive_range(
+            @NotNull ByteBuffer dst,
+                     int        subkeyLength,
+                     long       firstSubId,
+                     int        count,
+            @NotNull ByteBuffer context,
+            @NotNull ByteBuffer key);
+
+    public static native int crypto_kdf_blake2b_preparedbytes();
+
+    public static native int crypto_kdf_blake2b_prepare(
+            @NotNull ByteBuffer prepared,
+            @NotNull ByteBuffer context,
+            @NotNull ByteBuffer key);
+
+    public static native int crypto_kdf_blake2b_derive_prepared(
+            @NotNull ByteBuffer dst,
+                     int        subkeyLength,
+                     long       firstSubId,
+                     int        count,
+            @NotNull ByteBuffer prepared);
+
     //
     // Kx
     //
@@ -618,6 +1056,8 @@ public class StodiumJNI {
     public static native long crypto_pwhash_argon2i_memlimit_max();
     public static native long crypto_pwhash_argon2i_opslimit_interactive();
     public static native long crypto_pwhash_argon2i_memlimit_interactive();
+    public static native long crypto_pwhash_argon2i_opslimit_moderate();
+    public static native long crypto_pwhash_argon2i_memlimit_moderate();
     public static native long crypto_pwhash_argon2i_opslimit_sensitive();
     public static native long crypto_pwhash_argon2i_memlimit_sensitive();
 
@@ -638,6 +1078,44 @@ public class StodiumJNI {
             @NotNull ByteBuffer str,
             @NotNull ByteBuffer password);
 
+    //
+    // PwHash - Argon2id
+    //
+    public static native long crypto_pwhash_argon2id_bytes_min();
+    public static native long crypto_pwhash_argon2id_bytes_max();
+    public static native long crypto_pwhash_argon2id_passwd_min();
+    public static native long crypto_pwhash_argon2id_passwd_max();
+    public static native int crypto_pwhash_argon2id_saltbytes();
+    public static native int crypto_pwhash_argon2id_strbytes();
+    public static native @NotNull String crypto_pwhash_argon2id_strprefix();
+    public static native long crypto_pwhash_argon2id_opslimit_min();
+    public static native long crypto_pwhash_argon2id_opslimit_max();
+    public static native long crypto_pwhash_argon2id_memlimit_min();
+    public static native long crypto_pwhash_argon2id_memlimit_max();
+    public static native long crypto_pwhash_argon2id_opslimit_interactive();
+    public static native long crypto_pwhash_argon2id_memlimit_interactive();
+    public static native long crypto_pwhash_argon2id_opslimit_moderate();
+    public static native long crypto_pwhash_argon2id_memlimit_moderate();
+    public static native long crypto_pwhash_argon2id_opslimit_sensitive();
+    public static native long crypto_pwhash_argon2id_memlimit_sensitive();
+
+    public static native int crypto_pwhash_argon2id(
+            @NotNull ByteBuffer dst,
+            @NotNull ByteBuffer password,
+            @NotNull ByteBuffer salt,
+                     long       opslimit,
+                     long       memlimit);
+
+    public static native int crypto_pwhash_argon2id_str(
+            @NotNull ByteBuffer dst,
+            @NotNull ByteBuffer password,
+                     long       opslimit,
+                     long       memlimit);
+
+    public static native int crypto_pwhash_argon2id_str_verify(
+            @NotNull ByteBuffer str,
+            @NotNull ByteBuffer password);
+
     //
     // PwHash Scrypt
     //
@@ -727,6 +1205,18 @@ public class StodiumJNI {
             @NotNull ByteBuffer mac,
             @NotNull ByteBuffer nonce,
             @NotNull ByteBuffer key);
+    public static native int crypto_secretbox_xsalsa20poly1305_detached_gather(
+            @NotNull ByteBuffer[] dst,
+            @NotNull ByteBuffer   mac,
+            @NotNull ByteBuffer[] src,
+            @NotNull ByteBuffer   nonce,
+            @NotNull ByteBuffer   key);
+    public static native int crypto_secretbox_xsalsa20poly1305_open_detached_gather(
+            @NotNull ByteBuffer[] dst,
+            @NotNull ByteBuffer[] src,
+            @NotNull ByteBuffer   mac,
+            @NotNull ByteBuffer   nonce,
+            @NotNull ByteBuffer   key);
 
     //
     // SecretBox XChacha20Poly1305
@@ -757,6 +1247,53 @@ public class StodiumJNI {
             @NotNull ByteBuffer mac,
             @NotNull ByteBuffer nonce,
             @NotNull ByteBuffer key);
+    public static native int crypto_secretbox_xchacha20poly1305_detached_gather(
+            @NotNull ByteBuffer[] dst,
+            @NotNull ByteBuffer   mac,
+            @NotNull ByteBuffer[] src,
+            @NotNull ByteBuffer   nonce,
+            @NotNull ByteBuffer   key);
+    public static native int crypto_secretbox_xchacha20poly1305_open_detached_gather(
+            @NotNull ByteBuffer[] dst,
+            @NotNull ByteBuffer[] src,
+            @NotNull ByteBuffer   mac,
+            @NotNull ByteBuffer   nonce,
+            @NotNull ByteBuffer   key);
+
+    //
+    // SecretStream XChacha20Poly1305
+    //
+    public static native int crypto_secretstream_xchacha20poly1305_abytes();
+    public static native int crypto_secretstream_xchacha20poly1305_headerbytes();
+    public static native int crypto_secretstream_xchacha20poly1305_keybytes();
+    public static native int crypto_secretstream_xchacha20poly1305_statebytes();
+    public static native long crypto_secretstream_xchacha20poly1305_messagebytes_max();
+    public static native int crypto_secretstream_xchacha20poly1305_tag_message();
+    public static native int crypto_secretstream_xchacha20poly1305_tag_push();
+    public static native int crypto_secretstream_xchacha20poly1305_tag_rekey();
+    public static native int crypto_secretstream_xchacha20poly1305_tag_final();
+
+    public static native int crypto_secretstream_xchacha20poly1305_init_push(
+            @NotNull ByteBuffer state,
+            @NotNull ByteBuffer header,
+            @NotNull ByteBuffer key);
+    public static native int crypto_secretstream_xchacha20poly1305_push(
+            @NotNull  ByteBuffer state,
+            @NotNull  ByteBuffer dst,
+            @NotNull  ByteBuffer src,
+            @Nullable ByteBuffer ad,
+                      int        tag);
+    public static native int crypto_secretstream_xchacha20poly1305_init_pull(
+            @NotNull ByteBuffer state,
+            @NotNull ByteBuffer header,
+            @NotNull ByteBuffer key);
+    public static native int crypto_secretstream_xchacha20poly1305_pull(
+            @NotNull  ByteBuffer state,
+            @NotNull  ByteBuffer dst,
+            @NotNull  ByteBuffer src,
+            @Nullable ByteBuffer ad);
+    public static native void crypto_secretstream_xchacha20poly1305_rekey(
+            @NotNull ByteBuffer state);
 
     //
     // ShortHash
@@ -773,6 +1310,12 @@ public class StodiumJNI {
             @NotNull ByteBuffer out,
             @NotNull ByteBuffer in,
             @NotNull ByteBuffer key);
+    public static native int crypto_shorthash_siphash24_batch(
+            @NotNull long[]     dst,
+                     int        dstOffset,
+            @NotNull ByteBuffer src,
+            @NotNull int[]      table,
+            @NotNull ByteBuffer key);
 
     //
     // ShortHash SipHashx24
@@ -784,6 +1327,12 @@ public class StodiumJNI {
             @NotNull ByteBuffer out,
             @NotNull ByteBuffer in,
             @NotNull ByteBuffer key);
+    public static native int crypto_shorthash_siphashx24_batch(
+            @NotNull long[]     dst,
+                     int        dstOffset,
+            @NotNull ByteBuffer src,
+            @NotNull int[]      table,
+            @NotNull ByteBuffer key);
 
     //
     // Sign
@@ -822,6 +1371,13 @@ public class StodiumJNI {
             @NotNull ByteBuffer srcSig,
             @NotNull ByteBuffer srcMsg,
             @NotNull ByteBuffer priv);
+    public static native int crypto_sign_ed25519_verify_detached_batch(
+            @NotNull ByteBuffer srcSigs,
+            @NotNull ByteBuffer srcMsgs,
+            @NotNull int[]      table,
+            @NotNull ByteBuffer pubs,
+            @NotNull int[]      keys,
+            @NotNull byte[]     results);
     public static native int crypto_sign_ed25519ph_init(
             @NotNull ByteBuffer state);
     public static native int crypto_sign_ed25519ph_update(
@@ -836,6 +1392,53 @@ public class StodiumJNI {
             @NotNull ByteBuffer srcSig,
             @NotNull ByteBuffer priv);
 
+    //
+    // Native state handles
+    //
+    public static native long stodium_state_blake2b_init(
+            @Nullable ByteBuffer key,
+                      int        outlen);
+    public static native long stodium_state_sha256_init();
+    public static native long stodium_state_sha512_init();
+    public static native long stodium_state_hmacsha256_init(
+            @NotNull ByteBuffer key);
+    public static native long stodium_state_hmacsha512_init(
+            @NotNull ByteBuffer key);
+    public static native long stodium_state_hmacsha512256_init(
+            @NotNull ByteBuffer key);
+    public static native long stodium_state_poly1305_init(
+            @NotNull ByteBuffer key);
+    public static native long stodium_state_ed25519ph_init();
+    public static native int stodium_state_update(
+                     long       handle,
+            @NotNull ByteBuffer src);
+    public static native int stodium_state_update_gather(
+                     long         handle,
+            @NotNull ByteBuffer[] src);
+    public static native int stodium_state_update_fd(
+                     long           handle,
+            @NotNull FileDescriptor fd,
+                     long           offset,
+                     long           length);
+    public static native int stodium_state_update_mapped(
+                     long       handle,
+            @NotNull ByteBuffer src);
+    public static native int stodium_state_final(
+                     long       handle,
+            @NotNull ByteBuffer dst);
+    public static native int stodium_state_ed25519ph_final_create(
+                     long       handle,
+            @NotNull ByteBuffer dstSig,
+            @NotNull ByteBuffer priv);
+    public static native int stodium_state_ed25519ph_final_verify(
+                     long       handle,
+            @NotNull ByteBuffer srcSig,
+            @NotNull ByteBuffer pub);
+    public static native long stodium_state_copy(
+            long handle);
+    public static native void stodium_state_free(
+            long handle);
+
     /*
       Load the native library
      */
@@ -867,7 +1470,14 @@ public class StodiumJNI {
                 try { if (in  != null) { in.close();  } } catch (IOException e) { e.printStackTrace(); }
                 try { if (out != null) { out.close(); } } catch (IOException e) { e.printStackTrace(); }
             }*/
-            throw new RuntimeException("Cannot load libstodium native library");
+
+            // Not android (e.g. the benchmarks), use the library installed by
+            // jni/compile.sh, or the one found on java.library.path
+            try {
+                System.loadLibrary("stodiumjni");
+            } catch (final UnsatisfiedLinkError e2) {
+                throw new RuntimeException("Cannot load libstodium native library", e2);
+            }
         }
 
         if (StodiumJNI.stodium_init() != 0) {
@@ -6,6 +6,9 @@ import org.jetbrains.annotations.Nullable;
 import java.nio.ByteBuffer;
 
 import eu.artemisc.stodium.Singleton;
+import eu.artemisc.stodium.Stodium;
+import eu.artemisc.stodium.StodiumJNI;
+import eu.artemisc.stodium.exceptions.ConstraintViolationException;
 import eu.artemisc.stodium.exceptions.StodiumException;
 
 /**
@@ -13,6 +16,21 @@ import eu.artemisc.stodium.exceptions.StodiumException;
  */
 public abstract class AEAD {
 
+    /**
+     * NONCE_EACH indicates that the nonces buffer passed to a batch method
+     * holds a separate nonce for every message in the batch.
+     */
+    public static final int NONCE_EACH = 0;
+
+    /**
+     * NONCE_COUNTER indicates that the nonces buffer passed to a batch method
+     * holds a single base nonce. Message i uses the base nonce incremented i
+     * times, in the same (little-endian) order as sodium_increment. The next
+     * batch should therefore start at the base nonce incremented by the number
+     * of messages in this batch.
+     */
+    public static final int NONCE_COUNTER = 1;
+
     private static final @NotNull Singleton<AEAD> AES = new Singleton<AEAD>() {
         @NotNull
         @Override
@@ -55,6 +73,22 @@ public abstract class AEAD {
         return Aes256Gcm.isAvailable() ? AES.get() : null;
     }
 
+    /**
+     * fastestIetfInstance returns the fastest construction with a 96-bit nonce
+     * on this CPU: AES-256-GCM where libsodium can use AES-NI and PCLMUL, or
+     * ChaCha20-Poly1305-IETF (which libsodium speeds up with SSSE3, AVX2 or
+     * NEON) elsewhere. Both take the same key and nonce sizes, but their
+     * ciphertexts are not interchangeable: the choice has to be stored or
+     * negotiated along with the data.
+     *
+     * @return
+     */
+    @NotNull
+    public static AEAD fastestIetfInstance() {
+        final AEAD aes = aesInstance();
+        return aes != null ? aes : chachaIetfInstance();
+    }
+
     @NotNull
     public static AEAD chachaInstance() {
         return CHACHA.get();
@@ -194,4 +228,590 @@ public abstract class AEAD {
                                     final @NotNull ByteBuffer nonce,
                                     final @NotNull ByteBuffer key)
             throws StodiumException;
+
+    /**
+     * encryptPrefixed encrypts srcPlain under the next nonce of nonces, and
+     * writes the nonce followed by the ciphertext to dstCipher, which receives
+     * {@code npubBytes() + srcPlain.remaining() + aBytes()} bytes. The nonce
+     * is incremented in the same native call.
+     *
+     * @param dstCipher receives the nonce and the ciphertext
+     * @param srcPlain
+     * @param ad        additional data, may be null
+     * @param nonces    the nonce sequence, used with this key only
+     * @param key
+     * @throws StodiumException
+     */
+    public final void encryptPrefixed(final @NotNull  ByteBuffer    dstCipher,
+                                      final @NotNull  ByteBuffer    srcPlain,
+                                      final @Nullable ByteBuffer    ad,
+                                      final @NotNull  NonceSequence nonces,
+                                      final @NotNull  ByteBuffer    key)
+            throws StodiumException {
+        Stodium.checkDestinationWritable(dstCipher);
+
+        Stodium.checkSize(nonces.nonceBytes(), NPUBBYTES);
+        Stodium.checkSizeMin(dstCipher.remaining(), (long) NPUBBYTES + srcPlain.remaining() + ABYTES);
+        Stodium.checkSize(key.remaining(), KEYBYTES);
+
+        Stodium.checkStatus(encryptPrefixedNative(
+                Stodium.ensureUsableByteBuffer(dstCipher),
+                Stodium.ensureUsableByteBuffer(srcPlain),
+                ad == null ? null : Stodium.ensureUsableByteBuffer(ad),
+                nonces.buffer(),
+                Stodium.ensureUsableByteBuffer(key)));
+    }
+
+    /**
+     * decryptPrefixed decrypts and verifies srcCipher, a nonce followed by the
+     * ciphertext as written by {@link #encryptPrefixed}, to dstPlain.
+     *
+     * @param dstPlain  receives {@code srcCipher.remaining() - npubBytes() - aBytes()} bytes
+     * @param srcCipher the nonce and the ciphertext
+     * @param ad        additional data, may be null
+     * @param key
+     * @return true if the message was decrypted, false if it was forged
+     * @throws StodiumException
+     */
+    public final boolean decryptPrefixed(final @NotNull  ByteBuffer dstPlain,
+                                         final @NotNull  ByteBuffer srcCipher,
+                                         final @Nullable ByteBuffer ad,
+                                         final @NotNull  ByteBuffer key)
+            throws StodiumException {
+        Stodium.checkDestinationWritable(dstPlain);
+
+        Stodium.checkSizeMin(srcCipher.remaining(), NPUBBYTES + ABYTES);
+        Stodium.checkSizeMin(dstPlain.remaining(), srcCipher.remaining() - NPUBBYTES - ABYTES);
+        Stodium.checkSize(key.remaining(), KEYBYTES);
+
+        return StodiumJNI.NOERR == decryptPrefixedNative(
+                Stodium.ensureUsableByteBuffer(dstPlain),
+                Stodium.ensureUsableByteBuffer(srcCipher),
+                ad == null ? null : Stodium.ensureUsableByteBuffer(ad),
+                Stodium.ensureUsableByteBuffer(key));
+    }
+
+    /**
+     * encryptInPlace encrypts the first plainLength bytes of buffer in place,
+     * and writes the tag right after them: buffer receives the
+     * {@code plainLength + aBytes()} bytes of the ciphertext from its
+     * position, without a second buffer for the message.
+     *
+     * @param buffer      holds the message, and receives the ciphertext
+     * @param plainLength the length of the message
+     * @param ad          additional data, may be null
+     * @param nonce
+     * @param key
+     * @throws StodiumException
+     */
+    public final void encryptInPlace(final @NotNull  ByteBuffer buffer,
+                                     final           int        plainLength,
+                                     final @Nullable ByteBuffer ad,
+                                     final @NotNull  ByteBuffer nonce,
+                                     final @NotNull  ByteBuffer key)
+            throws StodiumException {
+        Stodium.checkDestinationWritable(buffer);
+
+        Stodium.checkPositive(plainLength);
+        Stodium.checkSizeMin(buffer.remaining(), (long) plainLength + ABYTES);
+        Stodium.checkSizeMin(nonce.remaining(), NPUBBYTES);
+        Stodium.checkSize(key.remaining(), KEYBYTES);
+
+        Stodium.checkStatus(encryptInPlaceNative(
+                Stodium.ensureUsableByteBuffer(buffer),
+                plainLength,
+                ad == null ? null : Stodium.ensureUsableByteBuffer(ad),
+                Stodium.ensureUsableByteBuffer(nonce),
+                Stodium.ensureUsableByteBuffer(key)));
+    }
+
+    /**
+     * decryptInPlace verifies the ciphertext in buffer, including its tag, and
+     * decrypts it in place: the message is written over the first
+     * {@code buffer.remaining() - aBytes()} bytes. If the verification fails,
+     * those bytes are zeroed, by every construction.
+     *
+     * @param buffer holds the ciphertext, and receives the message
+     * @param ad     additional data, may be null
+     * @param nonce
+     * @param key
+     * @return true if the message was decrypted, false if it was forged
+     * @throws StodiumException
+     */
+    public final boolean decryptInPlace(final @NotNull  ByteBuffer buffer,
+                                        final @Nullable ByteBuffer ad,
+                                        final @NotNull  ByteBuffer nonce,
+                                        final @NotNull  ByteBuffer key)
+            throws StodiumException {
+        Stodium.checkDestinationWritable(buffer);
+
+        Stodium.checkSizeMin(buffer.remaining(), ABYTES);
+        Stodium.checkSizeMin(nonce.remaining(), NPUBBYTES);
+        Stodium.checkSize(key.remaining(), KEYBYTES);
+
+        return StodiumJNI.NOERR == decryptInPlaceNative(
+                Stodium.ensureUsableByteBuffer(buffer),
+                ad == null ? null : Stodium.ensureUsableByteBuffer(ad),
+                Stodium.ensureUsableByteBuffer(nonce),
+                Stodium.ensureUsableByteBuffer(key));
+    }
+
+    /**
+     * encryptDetachedInPlace encrypts the remaining bytes of buffer in place,
+     * and writes the tag to dstMac.
+     *
+     * @param buffer holds the message, and receives the ciphertext
+     * @param dstMac receives the aBytes() bytes of the tag
+     * @param ad     additional data, may be null
+     * @param nonce
+     * @param key
+     * @throws StodiumException
+     */
+    public final void encryptDetachedInPlace(final @NotNull  ByteBuffer buffer,
+                                             final @NotNull  ByteBuffer dstMac,
+                                             final @Nullable ByteBuffer ad,
+                                             final @NotNull  ByteBuffer nonce,
+                                             final @NotNull  ByteBuffer key)
+            throws StodiumException {
+        Stodium.checkDestinationWritable(buffer);
+        Stodium.checkDestinationWritable(dstMac);
+
+        Stodium.checkSizeMin(dstMac.remaining(), ABYTES);
+        Stodium.checkSizeMin(nonce.remaining(), NPUBBYTES);
+        Stodium.checkSize(key.remaining(), KEYBYTES);
+        checkAlias(dstMac, buffer);
+
+        Stodium.checkStatus(encryptDetachedInPlaceNative(
+                Stodium.ensureUsableByteBuffer(buffer),
+                Stodium.ensureUsableByteBuffer(dstMac),
+                ad == null ? null : Stodium.ensureUsableByteBuffer(ad),
+                Stodium.ensureUsableByteBuffer(nonce),
+                Stodium.ensureUsableByteBuffer(key)));
+    }
+
+    /**
+     * decryptDetachedInPlace verifies the ciphertext in buffer against srcMac,
+     * and only then decrypts it in place. If the verification fails, the
+     * remaining bytes of buffer are zeroed, by every construction.
+     *
+     * @param buffer holds the ciphertext, and receives the message
+     * @param srcMac the tag of the ciphertext
+     * @param ad     additional data, may be null
+     * @param nonce
+     * @param key
+     * @return true if the message was decrypted, false if it was forged
+     * @throws StodiumException
+     */
+    public final boolean decryptDetachedInPlace(final @NotNull  ByteBuffer buffer,
+                                                final @NotNull  ByteBuffer srcMac,
+                                                final @Nullable ByteBuffer ad,
+                                                final @NotNull  ByteBuffer nonce,
+                                                final @NotNull  ByteBuffer key)
+            throws StodiumException {
+        Stodium.checkDestinationWritable(buffer);
+
+        Stodium.checkSizeMin(srcMac.remaining(), ABYTES);
+        Stodium.checkSizeMin(nonce.remaining(), NPUBBYTES);
+        Stodium.checkSize(key.remaining(), KEYBYTES);
+        checkAlias(buffer, srcMac);
+
+        return StodiumJNI.NOERR == decryptDetachedInPlaceNative(
+                Stodium.ensureUsableByteBuffer(buffer),
+                Stodium.ensureUsableByteBuffer(srcMac),
+                ad == null ? null : Stodium.ensureUsableByteBuffer(ad),
+                Stodium.ensureUsableByteBuffer(nonce),
+                Stodium.ensureUsableByteBuffer(key));
+    }
+
+    /**
+     * verifyDetached checks the tag srcMac of the ciphertext srcCipher without
+     * writing any plaintext, so a forged message can be rejected before a
+     * buffer is allocated for it. The ChaCha20-Poly1305 constructions only
+     * compute the Poly1305 tag; AES-256-GCM decrypts to a native scratch
+     * buffer, as libsodium computes its tag while decrypting.
+     *
+     * @param srcCipher the ciphertext
+     * @param srcMac    the tag of the ciphertext
+     * @param ad        additional data, may be null
+     * @param nonce
+     * @param key
+     * @return true if the tag is valid
+     * @throws StodiumException
+     */
+    public final boolean verifyDetached(final @NotNull  ByteBuffer srcCipher,
+                                        final @NotNull  ByteBuffer srcMac,
+                                        final @Nullable ByteBuffer ad,
+                                        final @NotNull  ByteBuffer nonce,
+                                        final @NotNull  ByteBuffer key)
+            throws StodiumException {
+        Stodium.checkSizeMin(srcMac.remaining(), ABYTES);
+        Stodium.checkSizeMin(nonce.remaining(), NPUBBYTES);
+        Stodium.checkSize(key.remaining(), KEYBYTES);
+
+        return StodiumJNI.NOERR == verifyDetachedNative(
+                Stodium.ensureUsableByteBuffer(srcCipher),
+                Stodium.ensureUsableByteBuffer(srcMac),
+                ad == null ? null : Stodium.ensureUsableByteBuffer(ad),
+                Stodium.ensureUsableByteBuffer(nonce),
+                Stodium.ensureUsableByteBuffer(key));
+    }
+
+    /**
+     * verify checks the tag of srcCipher, a ciphertext followed by its tag as
+     * written by {@link #encrypt}, without writing any plaintext. See
+     * {@link #verifyDetached}.
+     *
+     * @param srcCipher the ciphertext, including its tag
+     * @param ad        additional data, may be null
+     * @param nonce
+     * @param key
+     * @return true if the tag is valid
+     * @throws StodiumException
+     */
+    public final boolean verify(final @NotNull  ByteBuffer srcCipher,
+                                final @Nullable ByteBuffer ad,
+                                final @NotNull  ByteBuffer nonce,
+                                final @NotNull  ByteBuffer key)
+            throws StodiumException {
+        Stodium.checkSizeMin(srcCipher.remaining(), ABYTES);
+
+        final ByteBuffer cipher = srcCipher.duplicate();
+        final ByteBuffer mac    = srcCipher.duplicate();
+        cipher.limit(srcCipher.limit() - ABYTES);
+        mac.position(srcCipher.limit() - ABYTES);
+        return verifyDetached(cipher, mac, ad, nonce, key);
+    }
+
+    /**
+     * encryptDetached encrypts the concatenation of the remaining bytes of
+     * srcPlain, and scatters the ciphertext over dstCipher, which may be split
+     * up differently but must have room for all of it. The fragments are
+     * never concatenated: the ChaCha20-Poly1305 constructions run the stream
+     * and Poly1305 over them piece by piece. AES-256-GCM gathers them into a
+     * native scratch buffer, which is wiped afterwards. As with the other
+     * one-shot methods, the positions of the buffers are not moved.
+     * <p>
+     * dstCipher may share memory with srcPlain only exactly in place, with
+     * every shared byte at the same offset in the message; other overlaps
+     * are rejected (see {@link Stodium#checkAlias(ByteBuffer[], ByteBuffer[])}).
+     *
+     * @param dstCipher receives the ciphertext
+     * @param dstMac    receives the aBytes() bytes of the tag
+     * @param srcPlain  the fragments of the message
+     * @param ad        additional data, may be null
+     * @param nonce
+     * @param key
+     * @throws StodiumException
+     */
+    public final void encryptDetached(final @NotNull  ByteBuffer[] dstCipher,
+                                      final @NotNull  ByteBuffer   dstMac,
+                                      final @NotNull  ByteBuffer[] srcPlain,
+                                      final @Nullable ByteBuffer   ad,
+                                      final @NotNull  ByteBuffer   nonce,
+                                      final @NotNull  ByteBuffer   key)
+            throws StodiumException {
+        Stodium.checkDestinationWritable(dstCipher);
+        Stodium.checkDestinationWritable(dstMac);
+
+        Stodium.checkSizeMin(Stodium.remaining(dstCipher), Stodium.remaining(srcPlain));
+        Stodium.checkAlias(dstCipher, srcPlain);
+        Stodium.checkSizeMin(dstMac.remaining(), ABYTES);
+        Stodium.checkSizeMin(nonce.remaining(), NPUBBYTES);
+        Stodium.checkSize(key.remaining(), KEYBYTES);
+
+        Stodium.checkStatus(encryptDetachedGatherNative(
+                Stodium.ensureUsableByteBuffers(dstCipher),
+                Stodium.ensureUsableByteBuffer(dstMac),
+                Stodium.ensureUsableByteBuffers(srcPlain),
+                ad == null ? null : Stodium.ensureUsableByteBuffer(ad),
+                Stodium.ensureUsableByteBuffer(nonce),
+                Stodium.ensureUsableByteBuffer(key)));
+    }
+
+    /**
+     * decryptDetached verifies the concatenation of the remaining bytes of
+     * srcCipher against srcMac, and only then decrypts it, scattering the
+     * message over dstPlain. See
+     * {@link #encryptDetached(ByteBuffer[], ByteBuffer, ByteBuffer[], ByteBuffer, ByteBuffer, ByteBuffer)}.
+     * Nothing is written to dstPlain if the verification fails. As for
+     * encryption, dstPlain and srcCipher may only overlap exactly in place;
+     * false is returned for other overlaps between direct fragments.
+     *
+     * @param dstPlain  receives the message
+     * @param srcCipher the fragments of the ciphertext
+     * @param srcMac    the tag of the ciphertext
+     * @param ad        additional data, may be null
+     * @param nonce
+     * @param key
+     * @return true if the message was decrypted, false if it was forged
+     * @throws StodiumException
+     */
+    public final boolean decryptDetached(final @NotNull  ByteBuffer[] dstPlain,
+                                         final @NotNull  ByteBuffer[] srcCipher,
+                                         final @NotNull  ByteBuffer   srcMac,
+                                         final @Nullable ByteBuffer   ad,
+                                         final @NotNull  ByteBuffer   nonce,
+                                         final @NotNull  ByteBuffer   key)
+            throws StodiumException {
+        Stodium.checkDestinationWritable(dstPlain);
+
+        Stodium.checkSizeMin(Stodium.remaining(dstPlain), Stodium.remaining(srcCipher));
+        Stodium.checkAlias(dstPlain, srcCipher);
+        Stodium.checkSizeMin(srcMac.remaining(), ABYTES);
+        Stodium.checkSizeMin(nonce.remaining(), NPUBBYTES);
+        Stodium.checkSize(key.remaining(), KEYBYTES);
+
+        return StodiumJNI.NOERR == decryptDetachedGatherNative(
+                Stodium.ensureUsableByteBuffers(dstPlain),
+                Stodium.ensureUsableByteBuffers(srcCipher),
+                Stodium.ensureUsableByteBuffer(srcMac),
+                ad == null ? null : Stodium.ensureUsableByteBuffer(ad),
+                Stodium.ensureUsableByteBuffer(nonce),
+                Stodium.ensureUsableByteBuffer(key));
+    }
+
+    /**
+     * encryptBatch encrypts a batch of messages with the same key in a single
+     * call to the native code, which is considerably cheaper than encrypting
+     * the messages one by one when they are small.
+     * <p>
+     * The table holds an (offset, length) pair for every message in srcPlain,
+     * with the offsets relative to {@code srcPlain.position()}. The ciphertexts
+     * (including the authentication tag) are written back to back to
+     * dstCipher, in the order of the table.
+     *
+     * @param dstCipher receives the ciphertexts
+     * @param srcPlain  holds the messages
+     * @param table     the (offset, length) pair of every message
+     * @param ad        additional data shared by every message, may be null
+     * @param nonces    the nonce of every message, or the base nonce
+     * @param nonceMode either {@link #NONCE_EACH} or {@link #NONCE_COUNTER}
+     * @param key       the key shared by every message
+     * @param status    receives the status of every message, which is
+     *                  {@link eu.artemisc.stodium.StodiumJNI#NOERR} on success
+     * @return the number of messages that failed
+     * @throws StodiumException
+     */
+    public final int encryptBatch(final @NotNull  ByteBuffer dstCipher,
+                                  final @NotNull  ByteBuffer srcPlain,
+                                  final @NotNull  int[]      table,
+                                  final @Nullable ByteBuffer ad,
+                                  final @NotNull  ByteBuffer nonces,
+                                  final           int        nonceMode,
+                                  final @NotNull  ByteBuffer key,
+                                  final @NotNull  int[]      status)
+            throws StodiumException {
+        Stodium.checkDestinationWritable(dstCipher);
+
+        final int count = checkBatch(srcPlain, table, nonces, nonceMode, key, status);
+        Stodium.checkSizeMin(dstCipher.remaining(), batchLength(table) + (long) count * ABYTES);
+
+        final int failed = encryptBatchNative(
+                Stodium.ensureUsableByteBuffer(dstCipher),
+                Stodium.ensureUsableByteBuffer(srcPlain),
+                table,
+                ad == null ? null : Stodium.ensureUsableByteBuffer(ad),
+                Stodium.ensureUsableByteBuffer(nonces),
+                nonceMode,
+                Stodium.ensureUsableByteBuffer(key),
+                status);
+        if (failed < 0) {
+            Stodium.checkStatus(failed);
+        }
+        return failed;
+    }
+
+    /**
+     * decryptBatch decrypts and verifies a batch of messages with the same key
+     * in a single call to the native code. A message that fails verification
+     * does not abort the batch: its status is set to a non-zero value, and its
+     * output is zeroed.
+     * <p>
+     * The table holds an (offset, length) pair for every ciphertext in
+     * srcCipher, with the offsets relative to {@code srcCipher.position()}.
+     * The plaintexts are written back to back to dstPlain, in the order of the
+     * table.
+     *
+     * @param dstPlain  receives the plaintexts
+     * @param srcCipher holds the ciphertexts, including their tags
+     * @param table     the (offset, length) pair of every ciphertext
+     * @param ad        additional data shared by every message, may be null
+     * @param nonces    the nonce of every message, or the base nonce
+     * @param nonceMode either {@link #NONCE_EACH} or {@link #NONCE_COUNTER}
+     * @param key       the key shared by every message
+     * @param status    receives the status of every message, which is
+     *                  {@link eu.artemisc.stodium.StodiumJNI#NOERR} on success
+     * @return the number of messages that failed
+     * @throws StodiumException
+     */
+    public final int decryptBatch(final @NotNull  ByteBuffer dstPlain,
+                                  final @NotNull  ByteBuffer srcCipher,
+                                  final @NotNull  int[]      table,
+                                  final @Nullable ByteBuffer ad,
+                                  final @NotNull  ByteBuffer nonces,
+                                  final           int        nonceMode,
+                                  final @NotNull  ByteBuffer key,
+                                  final @NotNull  int[]      status)
+            throws StodiumException {
+        Stodium.checkDestinationWritable(dstPlain);
+
+        final int count = checkBatch(srcCipher, table, nonces, nonceMode, key, status);
+        for (int i = 0; i < count; i++) {
+            Stodium.checkSizeMin(table[2 * i + 1], ABYTES);
+        }
+        Stodium.checkSizeMin(dstPlain.remaining(), batchLength(table) - (long) count * ABYTES);
+
+        final int failed = decryptBatchNative(
+                Stodium.ensureUsableByteBuffer(dstPlain),
+                Stodium.ensureUsableByteBuffer(srcCipher),
+                table,
+                ad == null ? null : Stodium.ensureUsableByteBuffer(ad),
+                Stodium.ensureUsableByteBuffer(nonces),
+                nonceMode,
+                Stodium.ensureUsableByteBuffer(key),
+                status);
+        if (failed < 0) {
+            Stodium.checkStatus(failed);
+        }
+        return failed;
+    }
+
+    /**
+     * checkBatch verifies the arguments shared by the batch methods, and
+     * returns the number of messages in the batch.
+     */
+    private int checkBatch(final @NotNull ByteBuffer src,
+                           final @NotNull int[]      table,
+                           final @NotNull ByteBuffer nonces,
+                           final          int        nonceMode,
+                           final @NotNull ByteBuffer key,
+                           final @NotNull int[]      status)
+            throws ConstraintViolationException {
+        if ((table.length & 1) != 0) {
+            throw new ConstraintViolationException("Stodium: batch table should hold (offset, length) pairs");
+        }
+        final int count = table.length / 2;
+        Stodium.checkSizeMin(status.length, count);
+        Stodium.checkSize(key.remaining(), KEYBYTES);
+
+        switch (nonceMode) {
+        case NONCE_EACH:
+            Stodium.checkSizeMin(nonces.remaining(), (long) count * NPUBBYTES);
+            break;
+        case NONCE_COUNTER:
+            Stodium.checkSizeMin(nonces.remaining(), NPUBBYTES);
+            break;
+        default:
+            throw new ConstraintViolationException("Stodium: unknown nonce mode " + nonceMode);
+        }
+
+        for (int i = 0; i < count; i++) {
+            Stodium.checkOffsetParams(src.remaining(), table[2 * i], table[2 * i + 1]);
+        }
+        return count;
+    }
+
+    /**
+     * checkAlias throws an exception if dst and src are heap buffers over the
+     * same array whose regions overlap without starting at the same index.
+     * libsodium can encrypt and decrypt in place, but not to a region that is
+     * shifted against the source. The addresses of direct buffers are not
+     * visible from Java; for those, passing the same region is left to the
+     * caller, or the InPlace methods can be used.
+     */
+    static void checkAlias(final @NotNull ByteBuffer dst,
+                           final @NotNull ByteBuffer src)
+            throws ConstraintViolationException {
+        if (!dst.hasArray() || !src.hasArray() || dst.array() != src.array()) {
+            return;
+        }
+        final int d = dst.arrayOffset() + dst.position();
+        final int s = src.arrayOffset() + src.position();
+        if (d != s && d < s + src.remaining() && s < d + dst.remaining()) {
+            throw new ConstraintViolationException("Stodium: buffers overlap without being in place");
+        }
+    }
+
+    /**
+     * batchLength returns the sum of the message lengths in the table.
+     */
+    private static long batchLength(final @NotNull int[] table) {
+        long length = 0L;
+        for (int i = 1; i < table.length; i += 2) {
+            length += table[i];
+        }
+        return length;
+    }
+
+    abstract int encryptPrefixedNative(final @NotNull  ByteBuffer dstCipher,
+                                       final @NotNull  ByteBuffer srcPlain,
+                                       final @Nullable ByteBuffer ad,
+                                       final @NotNull  ByteBuffer nonce,
+                                       final @NotNull  ByteBuffer key);
+
+    abstract int decryptPrefixedNative(final @NotNull  ByteBuffer dstPlain,
+                                       final @NotNull  ByteBuffer srcCipher,
+                                       final @Nullable ByteBuffer ad,
+                                       final @NotNull  ByteBuffer key);
+
+    abstract int encryptInPlaceNative(final @NotNull  ByteBuffer buffer,
+                                      final           int        plainLength,
+                                      final @Nullable ByteBuffer ad,
+                                      final @NotNull  ByteBuffer nonce,
+                                      final @NotNull  ByteBuffer key);
+
+    abstract int decryptInPlaceNative(final @NotNull  ByteBuffer buffer,
+                                      final @Nullable ByteBuffer ad,
+                                      final @NotNull  ByteBuffer nonce,
+                                      final @NotNull  ByteBuffer key);
+
+    abstract int encryptDetachedInPlaceNative(final @NotNull  ByteBuffer buffer,
+                                              final @NotNull  ByteBuffer dstMac,
+                                              final @Nullable ByteBuffer ad,
+                                              final @NotNull  ByteBuffer nonce,
+                                              final @NotNull  ByteBuffer key);
+
+    abstract int decryptDetachedInPlaceNative(final @NotNull  ByteBuffer buffer,
+                                              final @NotNull  ByteBuffer srcMac,
+                                              final @Nullable ByteBuffer ad,
+                                              final @NotNull  ByteBuffer nonce,
+                                              final @NotNull  ByteBuffer key);
+
+    abstract int verifyDetachedNative(final @NotNull  ByteBuffer srcCipher,
+                                      final @NotNull  ByteBuffer srcMac,
+                                      final @Nullable ByteBuffer ad,
+                                      final @NotNull  ByteBuffer nonce,
+                                      final @NotNull  ByteBuffer key);
+
+    abstract int encryptDetachedGatherNative(final @NotNull  ByteBuffer[] dstCipher,
+                                             final @NotNull  ByteBuffer   dstMac,
+                                             final @NotNull  ByteBuffer[] srcPlain,
+                                             final @Nullable ByteBuffer   ad,
+                                             final @NotNull  ByteBuffer   nonce,
+                                             final @NotNull  ByteBuffer   key);
+
+    abstract int decryptDetachedGatherNative(final @NotNull  ByteBuffer[] dstPlain,
+                                             final @NotNull  ByteBuffer[] srcCipher,
+                                             final @NotNull  ByteBuffer   srcMac,
+                                             final @Nullable ByteBuffer   ad,
+                                             final @NotNull  ByteBuffer   nonce,
+                                             final @NotNull  ByteBuffer   key);
+
+    abstract int encryptBatchNative(final @NotNull  ByteBuffer dstCipher,
+                                    final @NotNull  ByteBuffer srcPlain,
+                                    final @NotNull  int[]      table,
+                                    final @Nullable ByteBuffer ad,
+                                    final @NotNull  ByteBuffer nonces,
+                                    final           int        nonceMode,
+                                    final @NotNull  ByteBuffer key,
+                                    final @NotNull  int[]      status);
+
+    abstract int decryptBatchNative(final @NotNull  ByteBuffer dstPlain,
+                                    final @NotNull  ByteBuffer srcCipher,
+                                    final @NotNull  int[]      table,
+                                    final @Nullable ByteBuffer ad,
+                                    final @NotNull  ByteBuffer nonces,
+                                    final           int        nonceMode,
+                                    final @NotNull  ByteBuffer key,
+                                    final @NotNull  int[]      status);
 }
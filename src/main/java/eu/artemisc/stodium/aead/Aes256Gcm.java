@@ -8,9 +8,11 @@
 package eu.artemisc.stodium.aead;
 
 import org.jetbrains.annotations.NotNull;
+import org.jetbrains.annotations.Nullable;
 
 import java.nio.ByteBuffer;
 
+import eu.artemisc.stodium.Constants;
 import eu.artemisc.stodium.Stodium;
 import eu.artemisc.stodium.StodiumJNI;
 import eu.artemisc.stodium.exceptions.StodiumException;
@@ -29,10 +31,10 @@ final class Aes256Gcm
     }
 
     Aes256Gcm() {
-        super(StodiumJNI.crypto_aead_aes256gcm_keybytes(),
-                StodiumJNI.crypto_aead_aes256gcm_nsecbytes(),
-                StodiumJNI.crypto_aead_aes256gcm_npubbytes(),
-                StodiumJNI.crypto_aead_aes256gcm_abytes());
+        super(Constants.AEAD_AES256GCM_KEYBYTES,
+                Constants.AEAD_AES256GCM_NSECBYTES,
+                Constants.AEAD_AES256GCM_NPUBBYTES,
+                Constants.AEAD_AES256GCM_ABYTES);
     }
 
     @Override
@@ -49,6 +51,7 @@ final class Aes256Gcm
         Stodium.checkSizeMin(dstCipher.remaining(), srcPlain.remaining());
         Stodium.checkSizeMin(nonce.remaining(), NPUBBYTES);
         Stodium.checkSize(key.remaining(), KEYBYTES);
+        checkAlias(dstCipher, srcPlain);
 
         Stodium.checkStatus(StodiumJNI.crypto_aead_aes256gcm_encrypt_detached(
                 Stodium.ensureUsableByteBuffer(dstCipher),
@@ -71,6 +74,7 @@ final class Aes256Gcm
         Stodium.checkSizeMin(dstCipher.remaining(), srcPlain.remaining() + ABYTES);
         Stodium.checkSizeMin(nonce.remaining(), NPUBBYTES);
         Stodium.checkSize(key.remaining(), KEYBYTES);
+        checkAlias(dstCipher, srcPlain);
 
         Stodium.checkStatus(StodiumJNI.crypto_aead_aes256gcm_encrypt(
                 Stodium.ensureUsableByteBuffer(dstCipher),
@@ -93,6 +97,7 @@ final class Aes256Gcm
         Stodium.checkSizeMin(dstPlain.remaining(), srcCipher.remaining());
         Stodium.checkSizeMin(nonce.remaining(), NPUBBYTES);
         Stodium.checkSize(key.remaining(), KEYBYTES);
+        checkAlias(dstPlain, srcCipher);
 
         return StodiumJNI.NOERR == StodiumJNI.crypto_aead_aes256gcm_decrypt_detached(
                 Stodium.ensureUsableByteBuffer(dstPlain),
@@ -115,6 +120,7 @@ final class Aes256Gcm
         Stodium.checkSizeMin(srcCipher.remaining(), dstPlain.remaining() + ABYTES);
         Stodium.checkSizeMin(nonce.remaining(), NPUBBYTES);
         Stodium.checkSize(key.remaining(), KEYBYTES);
+        checkAlias(dstPlain, srcCipher);
 
         return StodiumJNI.NOERR == StodiumJNI.crypto_aead_aes256gcm_decrypt(
                 Stodium.ensureUsableByteBuffer(dstPlain),
@@ -123,4 +129,120 @@ final class Aes256Gcm
                 Stodium.ensureUsableByteBuffer(nonce),
                 Stodium.ensureUsableByteBuffer(key));
     }
+
+    @Override
+    int encryptPrefixedNative(final @NotNull  ByteBuffer dstCipher,
+                              final @NotNull  ByteBuffer srcPlain,
+                              final @Nullable ByteBuffer ad,
+                              final @NotNull  ByteBuffer nonce,
+                              final @NotNull  ByteBuffer key) {
+        return StodiumJNI.crypto_aead_aes256gcm_encrypt_prefixed(
+                dstCipher, srcPlain, ad, nonce, key);
+    }
+
+    @Override
+    int decryptPrefixedNative(final @NotNull  ByteBuffer dstPlain,
+                              final @NotNull  ByteBuffer srcCipher,
+                              final @Nullable ByteBuffer ad,
+                              final @NotNull  ByteBuffer key) {
+        return StodiumJNI.crypto_aead_aes256gcm_decrypt_prefixed(
+                dstPlain, srcCipher, ad, key);
+    }
+
+    @Override
+    int encryptInPlaceNative(final @NotNull  ByteBuffer buffer,
+                             final           int        plainLength,
+                             final @Nullable ByteBuffer ad,
+                             final @NotNull  ByteBuffer nonce,
+                             final @NotNull  ByteBuffer key) {
+        return StodiumJNI.crypto_aead_aes256gcm_encrypt_inplace(
+                buffer, plainLength, ad, nonce, key);
+    }
+
+    @Override
+    int decryptInPlaceNative(final @NotNull  ByteBuffer buffer,
+                             final @Nullable ByteBuffer ad,
+                             final @NotNull  ByteBuffer nonce,
+                             final @NotNull  ByteBuffer key) {
+        return StodiumJNI.crypto_aead_aes256gcm_decrypt_inplace(
+                buffer, ad, nonce, key);
+    }
+
+    @Override
+    int encryptDetachedInPlaceNative(final @NotNull  ByteBuffer buffer,
+                                     final @NotNull  ByteBuffer dstMac,
+                                     final @Nullable ByteBuffer ad,
+                                     final @NotNull  ByteBuffer nonce,
+                                     final @NotNull  ByteBuffer key) {
+        return StodiumJNI.crypto_aead_aes256gcm_encrypt_detached_inplace(
+                buffer, dstMac, ad, nonce, key);
+    }
+
+    @Override
+    int decryptDetachedInPlaceNative(final @NotNull  ByteBuffer buffer,
+                                     final @NotNull  ByteBuffer srcMac,
+                                     final @Nullable ByteBuffer ad,
+                                     final @NotNull  ByteBuffer nonce,
+                                     final @NotNull  ByteBuffer key) {
+        return StodiumJNI.crypto_aead_aes256gcm_decrypt_detached_inplace(
+                buffer, srcMac, ad, nonce, key);
+    }
+
+    @Override
+    int verifyDetachedNative(final @NotNull  ByteBuffer srcCipher,
+                             final @NotNull  ByteBuffer srcMac,
+                             final @Nullable ByteBuffer ad,
+                             final @NotNull  ByteBuffer nonce,
+                             final @NotNull  ByteBuffer key) {
+        return StodiumJNI.crypto_aead_aes256gcm_verify_detached(
+                srcCipher, srcMac, ad, nonce, key);
+    }
+
+    @Override
+    int encryptDetachedGatherNative(final @NotNull  ByteBuffer[] dstCipher,
+                                    final @NotNull  ByteBuffer   dstMac,
+                                    final @NotNull  ByteBuffer[] srcPlain,
+                                    final @Nullable ByteBuffer   ad,
+                                    final @NotNull  ByteBuffer   nonce,
+                                    final @NotNull  ByteBuffer   key) {
+        return StodiumJNI.crypto_aead_aes256gcm_encrypt_detached_gather(
+                dstCipher, dstMac, srcPlain, ad, nonce, key);
+    }
+
+    @Override
+    int decryptDetachedGatherNative(final @NotNull  ByteBuffer[] dstPlain,
+                                    final @NotNull  ByteBuffer[] srcCipher,
+                                    final @NotNull  ByteBuffer   srcMac,
+                                    final @Nullable ByteBuffer   ad,
+                                    final @NotNull  ByteBuffer   nonce,
+                                    final @NotNull  ByteBuffer   key) {
+        return StodiumJNI.crypto_aead_aes256gcm_decrypt_detached_gather(
+                dstPlain, srcCipher, srcMac, ad, nonce, key);
+    }
+
+    @Override
+    int encryptBatchNative(final @NotNull  ByteBuffer dstCipher,
+                           final @NotNull  ByteBuffer srcPlain,
+                           final @NotNull  int[]      table,
+                           final @Nullable ByteBuffer ad,
+                           final @NotNull  ByteBuffer nonces,
+                           final           int        nonceMode,
+                           final @NotNull  ByteBuffer key,
+                           final @NotNull  int[]      status) {
+        return StodiumJNI.crypto_aead_aes256gcm_encrypt_batch(
+                dstCipher, srcPlain, table, ad, nonces, nonceMode, key, status);
+    }
+
+    @Override
+    int decryptBatchNative(final @NotNull  ByteBuffer dstPlain,
+                           final @NotNull  ByteBuffer srcCipher,
+                           final @NotNull  int[]      table,
+                           final @Nullable ByteBuffer ad,
+                           final @NotNull  ByteBuffer nonces,
+                           final           int        nonceMode,
+                           final @NotNull  ByteBuffer key,
+                           final @NotNull  int[]      status) {
+        return StodiumJNI.crypto_aead_aes256gcm_decrypt_batch(
+                dstPlain, srcCipher, table, ad, nonces, nonceMode, key, status);
+    }
 }
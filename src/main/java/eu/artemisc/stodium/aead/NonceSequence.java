@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2017 Project ArteMisc
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+package eu.artemisc.stodium.aead;
+
+import org.jetbrains.annotations.NotNull;
+
+import java.nio.ByteBuffer;
+
+import eu.artemisc.stodium.Stodium;
+import eu.artemisc.stodium.exceptions.ConstraintViolationException;
+import eu.artemisc.stodium.random.BufferedRandom;
+
+/**
+ * NonceSequence holds the nonce of the next message encrypted with
+ * {@link AEAD#encryptPrefixed(ByteBuffer, ByteBuffer, ByteBuffer, NonceSequence, ByteBuffer)}.
+ * The native code writes the nonce in front of the ciphertext and increments
+ * it (with sodium_increment) in the same call, so a message costs a single
+ * JNI call and no separate nonce buffer.
+ * <p>
+ * A sequence must only be used with a single key, and must not be used by
+ * multiple threads at once.
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+public final class NonceSequence {
+    private final @NotNull ByteBuffer nonce;
+
+    /**
+     * Starts a sequence at a random nonce.
+     *
+     * @param aead the construction the sequence is used with
+     */
+    public NonceSequence(final @NotNull AEAD aead) {
+        nonce = ByteBuffer.allocateDirect(aead.NPUBBYTES);
+        BufferedRandom.nextBytes(nonce);
+    }
+
+    /**
+     * Starts a sequence at the remaining bytes of start, which are copied.
+     *
+     * @param aead  the construction the sequence is used with
+     * @param start the first nonce of the sequence
+     * @throws ConstraintViolationException
+     */
+    public NonceSequence(final @NotNull AEAD       aead,
+                         final @NotNull ByteBuffer start)
+            throws ConstraintViolationException {
+        Stodium.checkSize(start.remaining(), aead.NPUBBYTES);
+        nonce = ByteBuffer.allocateDirect(aead.NPUBBYTES);
+        nonce.duplicate().put(start.duplicate());
+    }
+
+    /**
+     * current returns a read-only view of the nonce of the next message.
+     *
+     * @return
+     */
+    @NotNull
+    public ByteBuffer current() {
+        return nonce.asReadOnlyBuffer();
+    }
+
+    /**
+     *
+     * @return the number of bytes in a nonce of this sequence
+     */
+    public int nonceBytes() {
+        return nonce.capacity();
+    }
+
+    /**
+     * buffer returns the buffer that is incremented by the native code.
+     */
+    @NotNull
+    ByteBuffer buffer() {
+        return nonce;
+    }
+}
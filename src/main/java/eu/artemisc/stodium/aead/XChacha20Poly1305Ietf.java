@@ -8,9 +8,11 @@
 package eu.artemisc.stodium.aead;
 
 import org.jetbrains.annotations.NotNull;
+import org.jetbrains.annotations.Nullable;
 
 import java.nio.ByteBuffer;
 
+import eu.artemisc.stodium.Constants;
 import eu.artemisc.stodium.Stodium;
 import eu.artemisc.stodium.StodiumJNI;
 import eu.artemisc.stodium.exceptions.StodiumException;
@@ -21,10 +23,10 @@ import eu.artemisc.stodium.exceptions.StodiumException;
 final class XChacha20Poly1305Ietf
         extends AEAD {
     XChacha20Poly1305Ietf() {
-        super(StodiumJNI.crypto_aead_xchacha20poly1305_ietf_keybytes(),
-                StodiumJNI.crypto_aead_xchacha20poly1305_ietf_nsecbytes(),
-                StodiumJNI.crypto_aead_xchacha20poly1305_ietf_npubbytes(),
-                StodiumJNI.crypto_aead_xchacha20poly1305_ietf_abytes());
+        super(Constants.AEAD_XCHACHA20POLY1305_IETF_KEYBYTES,
+                Constants.AEAD_XCHACHA20POLY1305_IETF_NSECBYTES,
+                Constants.AEAD_XCHACHA20POLY1305_IETF_NPUBBYTES,
+                Constants.AEAD_XCHACHA20POLY1305_IETF_ABYTES);
     }
 
     @Override
@@ -41,6 +43,7 @@ final class XChacha20Poly1305Ietf
         Stodium.checkSizeMin(dstCipher.remaining(), srcPlain.remaining());
         Stodium.checkSizeMin(nonce.remaining(), NPUBBYTES);
         Stodium.checkSize(key.remaining(), KEYBYTES);
+        checkAlias(dstCipher, srcPlain);
 
         Stodium.checkStatus(StodiumJNI.crypto_aead_xchacha20poly1305_ietf_encrypt_detached(
                 Stodium.ensureUsableByteBuffer(dstCipher),
@@ -63,6 +66,7 @@ final class XChacha20Poly1305Ietf
         Stodium.checkSizeMin(dstCipher.remaining(), srcPlain.remaining() + ABYTES);
         Stodium.checkSizeMin(nonce.remaining(), NPUBBYTES);
         Stodium.checkSize(key.remaining(), KEYBYTES);
+        checkAlias(dstCipher, srcPlain);
 
         Stodium.checkStatus(StodiumJNI.crypto_aead_xchacha20poly1305_ietf_encrypt(
                 Stodium.ensureUsableByteBuffer(dstCipher),
@@ -85,6 +89,7 @@ final class XChacha20Poly1305Ietf
         Stodium.checkSizeMin(dstPlain.remaining(), srcCipher.remaining());
         Stodium.checkSizeMin(nonce.remaining(), NPUBBYTES);
         Stodium.checkSize(key.remaining(), KEYBYTES);
+        checkAlias(dstPlain, srcCipher);
 
         return StodiumJNI.NOERR == StodiumJNI.crypto_aead_xchacha20poly1305_ietf_decrypt_detached(
                 Stodium.ensureUsableByteBuffer(dstPlain),
@@ -107,6 +112,7 @@ final class XChacha20Poly1305Ietf
         Stodium.checkSizeMin(srcCipher.remaining(), dstPlain.remaining() + ABYTES);
         Stodium.checkSizeMin(nonce.remaining(), NPUBBYTES);
         Stodium.checkSize(key.remaining(), KEYBYTES);
+        checkAlias(dstPlain, srcCipher);
 
         return StodiumJNI.NOERR == StodiumJNI.crypto_aead_xchacha20poly1305_ietf_decrypt(
                 Stodium.ensureUsableByteBuffer(dstPlain),
@@ -115,4 +121,120 @@ final class XChacha20Poly1305Ietf
                 Stodium.ensureUsableByteBuffer(nonce),
                 Stodium.ensureUsableByteBuffer(key));
     }
+
+    @Override
+    int encryptPrefixedNative(final @NotNull  ByteBuffer dstCipher,
+                              final @NotNull  ByteBuffer srcPlain,
+                              final @Nullable ByteBuffer ad,
+                              final @NotNull  ByteBuffer nonce,
+                              final @NotNull  ByteBuffer key) {
+        return StodiumJNI.crypto_aead_xchacha20poly1305_ietf_encrypt_prefixed(
+                dstCipher, srcPlain, ad, nonce, key);
+    }
+
+    @Override
+    int decryptPrefixedNative(final @NotNull  ByteBuffer dstPlain,
+                              final @NotNull  ByteBuffer srcCipher,
+                              final @Nullable ByteBuffer ad,
+                              final @NotNull  ByteBuffer key) {
+        return StodiumJNI.crypto_aead_xchacha20poly1305_ietf_decrypt_prefixed(
+                dstPlain, srcCipher, ad, key);
+    }
+
+    @Override
+    int encryptInPlaceNative(final @NotNull  ByteBuffer buffer,
+                             final           int        plainLength,
+                             final @Nullable ByteBuffer ad,
+                             final @NotNull  ByteBuffer nonce,
+                             final @NotNull  ByteBuffer key) {
+        return StodiumJNI.crypto_aead_xchacha20poly1305_ietf_encrypt_inplace(
+                buffer, plainLength, ad, nonce, key);
+    }
+
+    @Override
+    int decryptInPlaceNative(final @NotNull  ByteBuffer buffer,
+                             final @Nullable ByteBuffer ad,
+                             final @NotNull  ByteBuffer nonce,
+                             final @NotNull  ByteBuffer key) {
+        return StodiumJNI.crypto_aead_xchacha20poly1305_ietf_decrypt_inplace(
+                buffer, ad, nonce, key);
+    }
+
+    @Override
+    int encryptDetachedInPlaceNative(final @NotNull  ByteBuffer buffer,
+                                     final @NotNull  ByteBuffer dstMac,
+                                     final @Nullable ByteBuffer ad,
+                                     final @NotNull  ByteBuffer nonce,
+                                     final @NotNull  ByteBuffer key) {
+        return StodiumJNI.crypto_aead_xchacha20poly1305_ietf_encrypt_detached_inplace(
+                buffer, dstMac, ad, nonce, key);
+    }
+
+    @Override
+    int decryptDetachedInPlaceNative(final @NotNull  ByteBuffer buffer,
+                                     final @NotNull  ByteBuffer srcMac,
+                                     final @Nullable ByteBuffer ad,
+                                     final @NotNull  ByteBuffer nonce,
+                                     final @NotNull  ByteBuffer key) {
+        return StodiumJNI.crypto_aead_xchacha20poly1305_ietf_decrypt_detached_inplace(
+                buffer, srcMac, ad, nonce, key);
+    }
+
+    @Override
+    int verifyDetachedNative(final @NotNull  ByteBuffer srcCipher,
+                             final @NotNull  ByteBuffer srcMac,
+                             final @Nullable ByteBuffer ad,
+                             final @NotNull  ByteBuffer nonce,
+                             final @NotNull  ByteBuffer key) {
+        return StodiumJNI.crypto_aead_xchacha20poly1305_ietf_verify_detached(
+                srcCipher, srcMac, ad, nonce, key);
+    }
+
+    @Override
+    int encryptDetachedGatherNative(final @NotNull  ByteBuffer[] dstCipher,
+                                    final @NotNull  ByteBuffer   dstMac,
+                                    final @NotNull  ByteBuffer[] srcPlain,
+                                    final @Nullable ByteBuffer   ad,
+                                    final @NotNull  ByteBuffer   nonce,
+                                    final @NotNull  ByteBuffer   key) {
+        return StodiumJNI.crypto_aead_xchacha20poly1305_ietf_encrypt_detached_gather(
+                dstCipher, dstMac, srcPlain, ad, nonce, key);
+    }
+
+    @Override
+    int decryptDetachedGatherNative(final @NotNull  ByteBuffer[] dstPlain,
+                                    final @NotNull  ByteBuffer[] srcCipher,
+                                    final @NotNull  ByteBuffer   srcMac,
+                                    final @Nullable ByteBuffer   ad,
+                                    final @NotNull  ByteBuffer   nonce,
+                                    final @NotNull  ByteBuffer   key) {
+        return StodiumJNI.crypto_aead_xchacha20poly1305_ietf_decrypt_detached_gather(
+                dstPlain, srcCipher, srcMac, ad, nonce, key);
+    }
+
+    @Override
+    int encryptBatchNative(final @NotNull  ByteBuffer dstCipher,
+                           final @NotNull  ByteBuffer srcPlain,
+                           final @NotNull  int[]      table,
+                           final @Nullable ByteBuffer ad,
+                           final @NotNull  ByteBuffer nonces,
+                           final           int        nonceMode,
+                           final @NotNull  ByteBuffer key,
+                           final @NotNull  int[]      status) {
+        return StodiumJNI.crypto_aead_xchacha20poly1305_ietf_encrypt_batch(
+                dstCipher, srcPlain, table, ad, nonces, nonceMode, key, status);
+    }
+
+    @Override
+    int decryptBatchNative(final @NotNull  ByteBuffer dstPlain,
+                           final @NotNull  ByteBuffer srcCipher,
+                           final @NotNull  int[]      table,
+                           final @Nullable ByteBuffer ad,
+                           final @NotNull  ByteBuffer nonces,
+                           final           int        nonceMode,
+                           final @NotNull  ByteBuffer key,
+                           final @NotNull  int[]      status) {
+        return StodiumJNI.crypto_aead_xchacha20poly1305_ietf_decrypt_batch(
+                dstPlain, srcCipher, table, ad, nonces, nonceMode, key, status);
+    }
 }
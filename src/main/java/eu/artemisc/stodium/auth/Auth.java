@@ -9,9 +9,11 @@ package eu.artemisc.stodium.auth;
 
 import org.jetbrains.annotations.NotNull;
 
+import java.io.FileDescriptor;
 import java.nio.ByteBuffer;
 
 import eu.artemisc.stodium.Multipart;
+import eu.artemisc.stodium.NativeMultipart;
 import eu.artemisc.stodium.Singleton;
 import eu.artemisc.stodium.exceptions.StodiumException;
 
@@ -140,4 +142,67 @@ public abstract class Auth {
     @NotNull
     public abstract Multipart<Auth> init(final @NotNull ByteBuffer key)
             throws StodiumException;
+
+    /**
+     * initNative does the same as {@link #init(ByteBuffer)}, but keeps the
+     * state in native memory. See {@link eu.artemisc.stodium.NativeState}.
+     *
+     * @param key
+     * @return
+     * @throws StodiumException
+     */
+    @NotNull
+    public abstract NativeMultipart<Auth> initNative(final @NotNull ByteBuffer key)
+            throws StodiumException;
+
+    /**
+     * macFile authenticates length bytes of an open file, starting at offset,
+     * or the rest of the file if length is negative. The file is read and
+     * authenticated by the native code in a single call, see
+     * {@link NativeMultipart#updateFile(FileDescriptor, long, long)}.
+     *
+     * @param dstMac
+     * @param fd     the descriptor of a file opened for reading
+     * @param offset
+     * @param length
+     * @param key
+     * @throws StodiumException
+     */
+    public final void macFile(final @NotNull ByteBuffer     dstMac,
+                              final @NotNull FileDescriptor fd,
+                              final          long           offset,
+                              final          long           length,
+                              final @NotNull ByteBuffer     key)
+            throws StodiumException {
+        final NativeMultipart<Auth> state = initNative(key);
+        try {
+            state.updateFile(fd, offset, length);
+            state.doFinal(dstMac);
+        } finally {
+            state.close();
+        }
+    }
+
+    /**
+     * macMapped authenticates the remaining bytes of a mapped (or other
+     * direct) buffer in a single native call, see
+     * {@link NativeMultipart#updateMapped(ByteBuffer)}.
+     *
+     * @param dstMac
+     * @param src
+     * @param key
+     * @throws StodiumException
+     */
+    public final void macMapped(final @NotNull ByteBuffer dstMac,
+                                final @NotNull ByteBuffer src,
+                                final @NotNull ByteBuffer key)
+            throws StodiumException {
+        final NativeMultipart<Auth> state = initNative(key);
+        try {
+            state.updateMapped(src);
+            state.doFinal(dstMac);
+        } finally {
+            state.close();
+        }
+    }
 }
@@ -4,7 +4,11 @@ import org.jetbrains.annotations.NotNull;
 
 import java.nio.ByteBuffer;
 
+import eu.artemisc.stodium.Constants;
 import eu.artemisc.stodium.Multipart;
+import eu.artemisc.stodium.NativeMultipart;
+import eu.artemisc.stodium.NativeState;
+import eu.artemisc.stodium.StatePool;
 import eu.artemisc.stodium.Stodium;
 import eu.artemisc.stodium.StodiumJNI;
 import eu.artemisc.stodium.exceptions.StodiumException;
@@ -17,9 +21,9 @@ final class HmacSha512
         implements Multipart.Spec {
 
     HmacSha512() {
-        super(StodiumJNI.crypto_auth_hmacsha512_bytes(),
-                StodiumJNI.crypto_auth_hmacsha512_keybytes(),
-                StodiumJNI.crypto_auth_hmacsha512_statebytes());
+        super(Constants.AUTH_HMACSHA512_BYTES,
+                Constants.AUTH_HMACSHA512_KEYBYTES,
+                Constants.AUTH_HMACSHA512_STATEBYTES);
     }
 
     @Override
@@ -59,7 +63,7 @@ final class HmacSha512
         final ByteBuffer state;
 
         Stodium.checkSize(key.remaining(), KEYBYTES);
-        state = ByteBuffer.allocateDirect(STATEBYTES);
+        state = StatePool.acquire(STATEBYTES);
 
         Stodium.checkStatus(StodiumJNI.crypto_auth_hmacsha512_init(
                 state, Stodium.ensureUsableByteBuffer(key)));
@@ -67,6 +71,16 @@ final class HmacSha512
         return new Multipart<>(this, state);
     }
 
+    @NotNull
+    @Override
+    public NativeMultipart<Auth> initNative(final @NotNull ByteBuffer key)
+            throws StodiumException {
+        Stodium.checkSize(key.remaining(), KEYBYTES);
+
+        return new NativeMultipart<Auth>(NativeState.wrap(StodiumJNI.stodium_state_hmacsha512_init(
+                Stodium.ensureUsableByteBuffer(key))));
+    }
+
     @Override
     public void update(final @NotNull ByteBuffer state,
                        final @NotNull ByteBuffer in)
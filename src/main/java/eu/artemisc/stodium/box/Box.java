@@ -296,4 +296,25 @@ public abstract class Box {
                                      final @NotNull ByteBuffer localPubKey,
                                      final @NotNull ByteBuffer localPrivKey)
             throws StodiumException;
+
+    //
+    // shared key cache, used by BoxSession with buffers that were already
+    // checked and made usable
+    //
+
+    abstract int keysBeforenm(final          long       keys,
+                              final          int        slot,
+                              final @NotNull ByteBuffer remotePubKey);
+
+    abstract int keysEasy(final          long       keys,
+                          final          int        slot,
+                          final @NotNull ByteBuffer dstCipher,
+                          final @NotNull ByteBuffer srcPlain,
+                          final @NotNull ByteBuffer nonce);
+
+    abstract int keysOpenEasy(final          long       keys,
+                              final          int        slot,
+                              final @NotNull ByteBuffer dstPlain,
+                              final @NotNull ByteBuffer srcCipher,
+                              final @NotNull ByteBuffer nonce);
 }
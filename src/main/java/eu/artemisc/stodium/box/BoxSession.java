@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) 2017 Project ArteMisc
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+package eu.artemisc.stodium.box;
+
+import org.jetbrains.annotations.NotNull;
+
+import java.io.Closeable;
+import java.nio.ByteBuffer;
+import java.util.ArrayDeque;
+import java.util.Iterator;
+import java.util.LinkedHashMap;
+import java.util.Map;
+
+import eu.artemisc.stodium.Stodium;
+import eu.artemisc.stodium.StodiumJNI;
+import eu.artemisc.stodium.exceptions.OperationFailedException;
+import eu.artemisc.stodium.exceptions.StodiumException;
+
+/**
+ * BoxSession encrypts and decrypts Box messages for a single local keypair,
+ * keeping the shared keys of the most recent peers. The first message to or
+ * from a peer computes the shared key with {@link Box#beforenm}; the messages
+ * that follow use the afternm variants, skipping the X25519 scalar
+ * multiplication.
+ * <p>
+ * The shared keys and the local secret key are kept in guarded native memory
+ * (sodium_malloc). When the cache is full, the key of the least recently used
+ * peer is replaced. The memory is wiped and released by {@link #close()}, or
+ * when the BoxSession is garbage collected.
+ * <p>
+ * A BoxSession is not safe for use by multiple threads at once.
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+public final class BoxSession
+        implements Closeable {
+    /**
+     * DEFAULT_CAPACITY is the number of peers kept by
+     * {@link #BoxSession(Box, ByteBuffer)}.
+     */
+    public static final int DEFAULT_CAPACITY = 64;
+
+    private final @NotNull Box                               box;
+    private final @NotNull LinkedHashMap<ByteBuffer, Integer> peers;
+    private final @NotNull ArrayDeque<Integer>               free;
+    private final          int                               capacity;
+
+    private long keys;
+
+    /**
+     *
+     * @param box          the Box construction used by the session
+     * @param localPrivKey the secret key of the local keypair
+     * @throws StodiumException
+     */
+    public BoxSession(final @NotNull Box        box,
+                      final @NotNull ByteBuffer localPrivKey)
+            throws StodiumException {
+        this(box, localPrivKey, DEFAULT_CAPACITY);
+    }
+
+    /**
+     *
+     * @param box          the Box construction used by the session
+     * @param localPrivKey the secret key of the local keypair
+     * @param capacity     the maximum number of peers to keep a shared key for
+     * @throws StodiumException
+     */
+    public BoxSession(final @NotNull Box        box,
+                      final @NotNull ByteBuffer localPrivKey,
+                      final          int        capacity)
+            throws StodiumException {
+        Stodium.checkSizeMin(capacity, 1);
+        Stodium.checkSize(localPrivKey.remaining(), box.SECRETKEYBYTES);
+
+        this.box      = box;
+        this.capacity = capacity;
+        this.peers    = new LinkedHashMap<ByteBuffer, Integer>(16, 0.75f, true);
+        this.free     = new ArrayDeque<Integer>(capacity);
+        for (int slot = 0; slot < capacity; slot++) {
+            free.add(slot);
+        }
+
+        keys = StodiumJNI.stodium_box_keys_create(capacity,
+                Stodium.ensureUsableByteBuffer(localPrivKey));
+        if (keys == 0L) {
+            throw new OperationFailedException("Stodium: could not allocate shared keys");
+        }
+    }
+
+    /**
+     *
+     * @param dstCipher
+     * @param srcPlain
+     * @param nonce
+     * @param remotePubKey
+     * @throws StodiumException
+     */
+    public void easy(final @NotNull ByteBuffer dstCipher,
+                     final @NotNull ByteBuffer srcPlain,
+                     final @NotNull ByteBuffer nonce,
+                     final @NotNull ByteBuffer remotePubKey)
+            throws StodiumException {
+        Stodium.checkDestinationWritable(dstCipher);
+
+        Stodium.checkSize(nonce.remaining(), box.NONCEBYTES);
+        Stodium.checkSizeMin(dstCipher.remaining(), srcPlain.remaining() + box.MACBYTES);
+
+        Stodium.checkStatus(box.keysEasy(keys, slotOf(remotePubKey),
+                Stodium.ensureUsableByteBuffer(dstCipher),
+                Stodium.ensureUsableByteBuffer(srcPlain),
+                Stodium.ensureUsableByteBuffer(nonce)));
+    }
+
+    /**
+     *
+     * @param dstPlain
+     * @param srcCipher
+     * @param nonce
+     * @param remotePubKey
+     * @return true if the message was decrypted, false if it was forged
+     * @throws StodiumException
+     */
+    public boolean openEasy(final @NotNull ByteBuffer dstPlain,
+                            final @NotNull ByteBuffer srcCipher,
+                            final @NotNull ByteBuffer nonce,
+                            final @NotNull ByteBuffer remotePubKey)
+            throws StodiumException {
+        Stodium.checkDestinationWritable(dstPlain);
+
+        Stodium.checkSize(nonce.remaining(), box.NONCEBYTES);
+        Stodium.checkPositive(srcCipher.remaining() - box.MACBYTES);
+        Stodium.checkSizeMin(dstPlain.remaining(), srcCipher.remaining() - box.MACBYTES);
+
+        return 0 == box.keysOpenEasy(keys, slotOf(remotePubKey),
+                Stodium.ensureUsableByteBuffer(dstPlain),
+                Stodium.ensureUsableByteBuffer(srcCipher),
+                Stodium.ensureUsableByteBuffer(nonce));
+    }
+
+    /**
+     * forget drops the shared key of a peer, if it is in the cache.
+     *
+     * @param remotePubKey
+     */
+    public void forget(final @NotNull ByteBuffer remotePubKey) {
+        final Integer slot = peers.remove(remotePubKey);
+        if (slot != null) {
+            free.push(slot);
+        }
+    }
+
+    /**
+     *
+     * @return the number of peers a shared key is kept for
+     */
+    public int size() {
+        return peers.size();
+    }
+
+    /**
+     *
+     * @return the maximum number of peers a shared key is kept for
+     */
+    public int capacity() {
+        return capacity;
+    }
+
+    /**
+     * slotOf returns the slot holding the key shared with remotePubKey,
+     * computing it if the peer is not in the cache.
+     *
+     * @param remotePubKey
+     * @return
+     * @throws StodiumException
+     */
+    private int slotOf(final @NotNull ByteBuffer remotePubKey)
+            throws StodiumException {
+        if (keys == 0L) {
+            throw new IllegalStateException("Stodium: BoxSession is closed");
+        }
+        Stodium.checkSize(remotePubKey.remaining(), box.PUBLICKEYBYTES);
+
+        final Integer cached = peers.get(remotePubKey);
+        if (cached != null) {
+            return cached;
+        }
+
+        if (free.isEmpty()) {
+            final Iterator<Map.Entry<ByteBuffer, Integer>> eldest = peers.entrySet().iterator();
+            free.push(eldest.next().getValue());
+            eldest.remove();
+        }
+
+        final int slot = free.pop();
+        try {
+            Stodium.checkStatus(box.keysBeforenm(keys, slot,
+                    Stodium.ensureUsableByteBuffer(remotePubKey)));
+        } catch (final StodiumException e) {
+            free.push(slot);
+            throw e;
+        }
+
+        // copy the key, the caller is free to reuse its buffer
+        final ByteBuffer peer = ByteBuffer.allocate(box.PUBLICKEYBYTES);
+        peer.put(remotePubKey.duplicate());
+        peer.flip();
+        peers.put(peer, slot);
+        return slot;
+    }
+
+    /**
+     * close wipes and releases the shared keys and the local secret key.
+     */
+    @Override
+    public void close() {
+        if (keys != 0L) {
+            StodiumJNI.stodium_box_keys_free(keys);
+            keys = 0L;
+        }
+        peers.clear();
+    }
+
+    @Override
+    protected void finalize()
+            throws Throwable {
+        try {
+            close();
+        } finally {
+            super.finalize();
+        }
+    }
+}
@@ -4,6 +4,7 @@ import org.jetbrains.annotations.NotNull;
 
 import java.nio.ByteBuffer;
 
+import eu.artemisc.stodium.Constants;
 import eu.artemisc.stodium.Stodium;
 import eu.artemisc.stodium.StodiumJNI;
 import eu.artemisc.stodium.exceptions.StodiumException;
@@ -17,13 +18,13 @@ final class Curve25519XSalsa20Poly1305
     private static final @NotNull ScalarMult CURVE = ScalarMult.curve25519Instance();
 
     Curve25519XSalsa20Poly1305() {
-        super(StodiumJNI.crypto_box_curve25519xsalsa20poly1305_seedbytes(),
-                StodiumJNI.crypto_box_curve25519xsalsa20poly1305_publickeybytes(),
-                StodiumJNI.crypto_box_curve25519xsalsa20poly1305_secretkeybytes(),
-                StodiumJNI.crypto_box_curve25519xsalsa20poly1305_beforenmbytes(),
-                StodiumJNI.crypto_box_curve25519xsalsa20poly1305_noncebytes(),
-                StodiumJNI.crypto_box_curve25519xsalsa20poly1305_macbytes(),
-                StodiumJNI.crypto_box_sealbytes());
+        super(Constants.BOX_CURVE25519XSALSA20POLY1305_SEEDBYTES,
+                Constants.BOX_CURVE25519XSALSA20POLY1305_PUBLICKEYBYTES,
+                Constants.BOX_CURVE25519XSALSA20POLY1305_SECRETKEYBYTES,
+                Constants.BOX_CURVE25519XSALSA20POLY1305_BEFORENMBYTES,
+                Constants.BOX_CURVE25519XSALSA20POLY1305_NONCEBYTES,
+                Constants.BOX_CURVE25519XSALSA20POLY1305_MACBYTES,
+                Constants.BOX_SEALBYTES);
     }
 
     //
@@ -206,4 +207,29 @@ final class Curve25519XSalsa20Poly1305
                 Stodium.ensureUsableByteBuffer(localPubKey),
                 Stodium.ensureUsableByteBuffer(localPrivKey));
     }
+
+    @Override
+    int keysBeforenm(final          long       keys,
+                     final          int        slot,
+                     final @NotNull ByteBuffer remotePubKey) {
+        return StodiumJNI.stodium_box_keys_curve25519xsalsa20poly1305_beforenm(keys, slot, remotePubKey);
+    }
+
+    @Override
+    int keysEasy(final          long       keys,
+                 final          int        slot,
+                 final @NotNull ByteBuffer dstCipher,
+                 final @NotNull ByteBuffer srcPlain,
+                 final @NotNull ByteBuffer nonce) {
+        return StodiumJNI.stodium_box_keys_curve25519xsalsa20poly1305_easy(keys, slot, dstCipher, srcPlain, nonce);
+    }
+
+    @Override
+    int keysOpenEasy(final          long       keys,
+                     final          int        slot,
+                     final @NotNull ByteBuffer dstPlain,
+                     final @NotNull ByteBuffer srcCipher,
+                     final @NotNull ByteBuffer nonce) {
+        return StodiumJNI.stodium_box_keys_curve25519xsalsa20poly1305_open_easy(keys, slot, dstPlain, srcCipher, nonce);
+    }
 }
@@ -1,53 +1,30 @@
 package eu.artemisc.stodium.codecs;
 
-import org.jetbrains.annotations.NotNull;
-
-import java.nio.ByteBuffer;
-
-import eu.artemisc.stodium.Stodium;
-import eu.artemisc.stodium.StodiumJNI;
-import eu.artemisc.stodium.exceptions.StodiumException;
-
 /**
  * @author Jan van de Molengraft [jan@artemisc.eu]
  */
 public class Base64
         extends Codec {
 
-    private final int variant;
+    /**
+     * NO_PADDING is the bit of the libsodium variants that have no padding.
+     */
+    private static final int NO_PADDING = 0x2;
 
     Base64(final int variant) {
-        this.variant = variant;
+        super(variant, 3, 4);
     }
 
     @Override
     public int encodedLength(final int input) {
-        return StodiumJNI.sodium_base64_encoded_len(input, variant);
+        if ((variant & NO_PADDING) == 0) {
+            return (input + 2) / 3 * 4;
+        }
+        return input / 3 * 4 + (input % 3 == 0 ? 0 : input % 3 + 1);
     }
 
     @Override
-    public void encode(final @NotNull ByteBuffer dst,
-                       final @NotNull ByteBuffer src)
-            throws StodiumException {
-        Stodium.checkDestinationWritable(dst);
-
-        Stodium.checkSizeMin(dst.remaining(), encodedLength(src.remaining()));
-
-        Stodium.checkStatus(StodiumJNI.sodium_bin2base64(
-                Stodium.ensureUsableByteBuffer(dst),
-                Stodium.ensureUsableByteBuffer(src),
-                variant));
-    }
-
-    @Override
-    public void decode(final @NotNull ByteBuffer dst,
-                       final @NotNull ByteBuffer src)
-            throws StodiumException {
-        Stodium.checkDestinationWritable(dst);
-
-        Stodium.checkStatus(StodiumJNI.sodium_base642bin(
-                Stodium.ensureUsableByteBuffer(dst),
-                Stodium.ensureUsableByteBuffer(src),
-                variant));
+    public int decodedLength(final int input) {
+        return input / 4 * 3 + (input % 4 == 0 ? 0 : input % 4 - 1);
     }
 }
@@ -2,13 +2,28 @@ package eu.artemisc.stodium.codecs;
 
 import org.jetbrains.annotations.NotNull;
 
+import java.nio.Buffer;
 import java.nio.ByteBuffer;
+import java.nio.CharBuffer;
+import java.util.Arrays;
 
 import eu.artemisc.stodium.Singleton;
+import eu.artemisc.stodium.Stodium;
 import eu.artemisc.stodium.StodiumJNI;
+import eu.artemisc.stodium.exceptions.ConstraintViolationException;
+import eu.artemisc.stodium.exceptions.ReadOnlyBufferException;
 import eu.artemisc.stodium.exceptions.StodiumException;
 
 /**
+ * Codec encodes binary data as hex or Base64 text and back, in constant time.
+ * <p>
+ * The encode and decode methods write straight into the destination (a
+ * ByteBuffer, byte[] or char[]-backed CharBuffer) and return the number of
+ * bytes or characters written; like the other primitives, they do not move
+ * the position of their buffers. {@link #newEncoder()} and
+ * {@link #newDecoder()} return streaming stages for data that arrives in
+ * pieces.
+ *
  * @author Jan van de Molengraft [jan@artemisc.eu]
  */
 public abstract class Codec {
@@ -78,22 +93,128 @@ public abstract class Codec {
         return BASE64_URL_NOPAD.get();
     }
 
+    /**
+     * VARIANT_HEX is the variant passed to the native code for hex, next to
+     * the libsodium Base64 variants.
+     */
+    static final int VARIANT_HEX = 0;
+
+    // constants
+    final int variant;
+    final int GROUP_BYTES;
+    final int GROUP_CHARS;
+
+    /**
+     *
+     * @param variant
+     * @param groupBytes the number of bytes encoded as one group
+     * @param groupChars the number of characters of an encoded group
+     */
+    Codec(final int variant,
+          final int groupBytes,
+          final int groupChars) {
+        this.variant     = variant;
+        this.GROUP_BYTES = groupBytes;
+        this.GROUP_CHARS = groupChars;
+    }
+
     /**
      *
      * @param input
-     * @return
+     * @return the number of characters of the encoding of input bytes
      */
     public abstract int encodedLength(final int input);
 
+    /**
+     *
+     * @param input
+     * @return the largest number of bytes the encoding of input characters
+     *         decodes to
+     */
+    public abstract int decodedLength(final int input);
+
     /**
      *
      * @param dst
      * @param src
+     * @return the number of bytes written to dst
      * @throws StodiumException
      */
-    public abstract void encode(final @NotNull ByteBuffer dst,
-                                final @NotNull ByteBuffer src)
-            throws StodiumException;
+    public final int encode(final @NotNull ByteBuffer dst,
+                            final @NotNull ByteBuffer src)
+            throws StodiumException {
+        Stodium.checkDestinationWritable(dst);
+        Stodium.checkSizeMin(dst.remaining(), encodedLength(src.remaining()));
+
+        return checkLength(StodiumJNI.stodium_codec_encode(
+                Stodium.ensureUsableByteBuffer(dst),
+                Stodium.ensureUsableByteBuffer(src),
+                variant));
+    }
+
+    /**
+     *
+     * @param dst
+     * @param offset the index in dst of the first character
+     * @param src
+     * @return the number of bytes written to dst
+     * @throws StodiumException
+     */
+    public final int encode(final @NotNull byte[]     dst,
+                            final          int        offset,
+                            final @NotNull ByteBuffer src)
+            throws StodiumException {
+        Stodium.checkOffsetParams(dst.length, offset, 0);
+        return encode(ByteBuffer.wrap(dst, offset, dst.length - offset), src);
+    }
+
+    /**
+     * encode writes the characters to dst from its position. The native code
+     * writes straight into the backing array of a heap CharBuffer; any other
+     * CharBuffer is filled from a temporary array.
+     *
+     * @param dst
+     * @param src
+     * @return the number of characters written to dst
+     * @throws StodiumException
+     */
+    public final int encode(final @NotNull CharBuffer dst,
+                            final @NotNull ByteBuffer src)
+            throws StodiumException {
+        if (dst.isReadOnly()) {
+            throw new ReadOnlyBufferException("Stodium: output buffer is readonly");
+        }
+        Stodium.checkSizeMin(dst.remaining(), encodedLength(src.remaining()));
+
+        if (dst.hasArray()) {
+            return encode(dst.array(), dst.arrayOffset() + dst.position(), src);
+        }
+        final char[] chars = new char[encodedLength(src.remaining())];
+        encode(chars, 0, src);
+        dst.duplicate().put(chars);
+        return chars.length;
+    }
+
+    /**
+     *
+     * @param dst
+     * @param offset the index in dst of the first character
+     * @param src
+     * @return the number of characters written to dst
+     * @throws StodiumException
+     */
+    public final int encode(final @NotNull char[]     dst,
+                            final          int        offset,
+                            final @NotNull ByteBuffer src)
+            throws StodiumException {
+        Stodium.checkOffsetParams(dst.length, offset, encodedLength(src.remaining()));
+
+        return checkLength(StodiumJNI.stodium_codec_encode_chars(
+                dst,
+                offset,
+                Stodium.ensureUsableByteBuffer(src),
+                variant));
+    }
 
     /**
      *
@@ -104,31 +225,322 @@ public abstract class Codec {
     @NotNull
     public final String encode(final @NotNull ByteBuffer src)
             throws StodiumException {
-        final byte[] dst;
-        dst = new byte[encodedLength(src.remaining())];
-        encode(ByteBuffer.wrap(dst), src);
+        final char[] dst = new char[encodedLength(src.remaining())];
+        encode(dst, 0, src);
         return new String(dst);
     }
 
     /**
      *
      * @param dst
-     * @param src
-     * @throws StodiumException
+     * @param src the encoded characters, as ASCII bytes
+     * @return the number of bytes written to dst
+     * @throws StodiumException if src is not a valid encoding
      */
-    public abstract void decode(final @NotNull ByteBuffer dst,
-                                final @NotNull ByteBuffer src)
-            throws StodiumException;
+    public final int decode(final @NotNull ByteBuffer dst,
+                            final @NotNull ByteBuffer src)
+            throws StodiumException {
+        Stodium.checkDestinationWritable(dst);
+
+        return checkLength(StodiumJNI.stodium_codec_decode(
+                Stodium.ensureUsableByteBuffer(dst),
+                Stodium.ensureUsableByteBuffer(src),
+                variant));
+    }
 
     /**
+     * decode reads the characters of a heap CharBuffer from its backing
+     * array; those of a String or any other CharSequence are copied once.
      *
      * @param dst
      * @param src
-     * @throws StodiumException
+     * @return the number of bytes written to dst
+     * @throws StodiumException if src is not a valid encoding
      */
-    public final void decode(final @NotNull ByteBuffer dst,
-                             final @NotNull String     src)
+    public final int decode(final @NotNull ByteBuffer   dst,
+                            final @NotNull CharSequence src)
             throws StodiumException {
-        decode(dst, ByteBuffer.wrap(src.getBytes()));
+        Stodium.checkDestinationWritable(dst);
+
+        final char[] chars;
+        final int    offset;
+        if (src instanceof CharBuffer && ((CharBuffer) src).hasArray()) {
+            final CharBuffer buffer = (CharBuffer) src;
+            chars  = buffer.array();
+            offset = buffer.arrayOffset() + buffer.position();
+        } else {
+            chars  = new char[src.length()];
+            offset = 0;
+            if (src instanceof String) {
+                ((String) src).getChars(0, chars.length, chars, 0);
+            } else {
+                for (int i = 0; i < chars.length; i++) {
+                    chars[i] = src.charAt(i);
+                }
+            }
+        }
+
+        return checkLength(StodiumJNI.stodium_codec_decode_chars(
+                Stodium.ensureUsableByteBuffer(dst),
+                chars,
+                offset,
+                src.length(),
+                variant));
+    }
+
+    /**
+     *
+     * @return a streaming encoder for this codec
+     */
+    @NotNull
+    public final Encoder newEncoder() {
+        return new Encoder(this);
+    }
+
+    /**
+     *
+     * @return a streaming decoder for this codec
+     */
+    @NotNull
+    public final Decoder newDecoder() {
+        return new Decoder(this);
+    }
+
+    /**
+     * checkLength returns the length returned by a native call, or throws if
+     * the call failed.
+     */
+    private static int checkLength(final int length)
+            throws StodiumException {
+        if (length < 0) {
+            Stodium.checkStatus(length);
+        }
+        return length;
+    }
+
+    /**
+     * checkTextBuffer checks that the encoded side of a streaming stage is a
+     * ByteBuffer or a CharBuffer.
+     */
+    private static void checkTextBuffer(final @NotNull Buffer buffer)
+            throws ConstraintViolationException {
+        if (!(buffer instanceof ByteBuffer) && !(buffer instanceof CharBuffer)) {
+            throw new ConstraintViolationException("Stodium: expected a ByteBuffer or a CharBuffer");
+        }
+    }
+
+    /**
+     * Encoder encodes a stream of bytes that arrives in pieces. Every update
+     * encodes the whole groups of its input and carries the rest (at most 2
+     * bytes) over to the next call; {@link #doFinal(Buffer)} encodes the
+     * carried bytes, with padding where the codec has it.
+     * <p>
+     * Unlike the one-shot methods, the stages consume their input and advance
+     * the positions of both buffers. An Encoder is not thread-safe.
+     */
+    public static final class Encoder {
+        private final @NotNull Codec  codec;
+        private final @NotNull byte[] carry;
+        private                int    carried;
+
+        Encoder(final @NotNull Codec codec) {
+            this.codec = codec;
+            this.carry = new byte[codec.GROUP_BYTES];
+        }
+
+        /**
+         *
+         * @param input
+         * @return the number of characters an update with input bytes writes
+         */
+        public int updateLength(final int input) {
+            return (carried + input) / codec.GROUP_BYTES * codec.GROUP_CHARS;
+        }
+
+        /**
+         * update encodes src to dst, which is a ByteBuffer or a CharBuffer and
+         * must have room for {@link #updateLength(int)} of src.remaining().
+         *
+         * @param dst
+         * @param src
+         * @return the number of bytes or characters written to dst
+         * @throws StodiumException
+         */
+        public int update(final @NotNull Buffer     dst,
+                          final @NotNull ByteBuffer src)
+                throws StodiumException {
+            checkTextBuffer(dst);
+            Stodium.checkSizeMin(dst.remaining(), updateLength(src.remaining()));
+
+            int written = 0;
+            if (carried > 0) {
+                final int take = Math.min(codec.GROUP_BYTES - carried, src.remaining());
+                src.get(carry, carried, take);
+                carried += take;
+                if (carried < codec.GROUP_BYTES) {
+                    return 0;
+                }
+                written += put(dst, ByteBuffer.wrap(carry));
+                carried  = 0;
+            }
+
+            final ByteBuffer groups = src.duplicate();
+            groups.limit(groups.position() + src.remaining() / codec.GROUP_BYTES * codec.GROUP_BYTES);
+            written += put(dst, groups);
+            src.position(groups.limit());
+
+            carried = src.remaining();
+            src.get(carry, 0, carried);
+            return written;
+        }
+
+        /**
+         * doFinal encodes the carried bytes to dst, and resets the encoder.
+         *
+         * @param dst
+         * @return the number of bytes or characters written to dst
+         * @throws StodiumException
+         */
+        public int doFinal(final @NotNull Buffer dst)
+                throws StodiumException {
+            checkTextBuffer(dst);
+            try {
+                return put(dst, ByteBuffer.wrap(carry, 0, carried));
+            } finally {
+                Arrays.fill(carry, (byte) 0);
+                carried = 0;
+            }
+        }
+
+        private int put(final @NotNull Buffer     dst,
+                        final @NotNull ByteBuffer src)
+                throws StodiumException {
+            final int written = dst instanceof ByteBuffer
+                    ? codec.encode((ByteBuffer) dst, src)
+                    : codec.encode((CharBuffer) dst, src);
+            dst.position(dst.position() + written);
+            return written;
+        }
+    }
+
+    /**
+     * Decoder decodes a stream of characters that arrives in pieces. Every
+     * update decodes the whole groups of its input and carries the rest (at
+     * most 3 characters) over to the next call; {@link #doFinal(ByteBuffer)}
+     * decodes the carried characters, which must then complete the encoding.
+     * <p>
+     * Unlike the one-shot methods, the stages consume their input and advance
+     * the positions of both buffers. A Decoder is not thread-safe.
+     */
+    public static final class Decoder {
+        private final @NotNull Codec   codec;
+        private final @NotNull char[]  carry;
+        private                int     carried;
+        private                boolean finished;
+
+        Decoder(final @NotNull Codec codec) {
+            this.codec = codec;
+            this.carry = new char[codec.GROUP_CHARS];
+        }
+
+        /**
+         *
+         * @param input
+         * @return the largest number of bytes an update with input characters
+         *         writes
+         */
+        public int updateLength(final int input) {
+            return (carried + input) / codec.GROUP_CHARS * codec.GROUP_BYTES;
+        }
+
+        /**
+         * update decodes src, which is a CharBuffer or a ByteBuffer of ASCII
+         * characters, to dst, which must have room for
+         * {@link #updateLength(int)} of src.remaining().
+         *
+         * @param dst
+         * @param src
+         * @return the number of bytes written to dst
+         * @throws StodiumException if src is not a valid part of the encoding
+         */
+        public int update(final @NotNull ByteBuffer dst,
+                          final @NotNull Buffer     src)
+                throws StodiumException {
+            Stodium.checkDestinationWritable(dst);
+            checkTextBuffer(src);
+            Stodium.checkSizeMin(dst.remaining(), updateLength(src.remaining()));
+
+            int written = 0;
+            if (carried > 0) {
+                while (carried < codec.GROUP_CHARS && src.hasRemaining()) {
+                    carry[carried++] = get(src);
+                }
+                if (carried < codec.GROUP_CHARS) {
+                    return 0;
+                }
+                written += take(dst, CharBuffer.wrap(carry), codec.GROUP_CHARS);
+                carried  = 0;
+            }
+
+            final int groups = src.remaining() / codec.GROUP_CHARS * codec.GROUP_CHARS;
+            if (groups > 0) {
+                final Buffer part = src instanceof ByteBuffer
+                        ? ((ByteBuffer) src).duplicate()
+                        : ((CharBuffer) src).duplicate();
+                part.limit(part.position() + groups);
+                written += take(dst, part, groups);
+                src.position(part.limit());
+            }
+
+            while (src.hasRemaining()) {
+                carry[carried++] = get(src);
+            }
+            return written;
+        }
+
+        /**
+         * doFinal decodes the carried characters to dst, and resets the
+         * decoder.
+         *
+         * @param dst
+         * @return the number of bytes written to dst
+         * @throws StodiumException if the characters do not complete the
+         *         encoding
+         */
+        public int doFinal(final @NotNull ByteBuffer dst)
+                throws StodiumException {
+            try {
+                return carried == 0 ? 0 : take(dst, CharBuffer.wrap(carry, 0, carried), carried);
+            } finally {
+                Arrays.fill(carry, (char) 0);
+                carried  = 0;
+                finished = false;
+            }
+        }
+
+        /**
+         * take decodes the chars characters of src, advances dst and checks
+         * that no group follows a padded one.
+         */
+        private int take(final @NotNull ByteBuffer dst,
+                         final @NotNull Buffer     src,
+                         final          int        chars)
+                throws StodiumException {
+            if (finished) {
+                throw new ConstraintViolationException("Stodium: data after the padding");
+            }
+            final int written = src instanceof ByteBuffer
+                    ? codec.decode(dst, (ByteBuffer) src)
+                    : codec.decode(dst, (CharBuffer) src);
+            finished = written < chars / codec.GROUP_CHARS * codec.GROUP_BYTES;
+            dst.position(dst.position() + written);
+            return written;
+        }
+
+        private static char get(final @NotNull Buffer src) {
+            return src instanceof ByteBuffer
+                    ? (char) (((ByteBuffer) src).get() & 0xFF)
+                    : ((CharBuffer) src).get();
+        }
     }
 }
@@ -12,6 +12,7 @@ import org.jetbrains.annotations.Nullable;
 
 import java.nio.ByteBuffer;
 
+import eu.artemisc.stodium.Constants;
 import eu.artemisc.stodium.Stodium;
 import eu.artemisc.stodium.StodiumJNI;
 import eu.artemisc.stodium.exceptions.StodiumException;
@@ -23,10 +24,10 @@ final class HChacha20
         extends Core {
 
     HChacha20() {
-        super(StodiumJNI.crypto_core_hchacha20_inputbytes(),
-              StodiumJNI.crypto_core_hchacha20_outputbytes(),
-              StodiumJNI.crypto_core_hchacha20_constbytes(),
-              StodiumJNI.crypto_core_hchacha20_keybytes());
+        super(Constants.CORE_HCHACHA20_INPUTBYTES,
+              Constants.CORE_HCHACHA20_OUTPUTBYTES,
+              Constants.CORE_HCHACHA20_CONSTBYTES,
+              Constants.CORE_HCHACHA20_KEYBYTES);
     }
 
     @Override
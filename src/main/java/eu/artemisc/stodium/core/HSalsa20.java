@@ -12,6 +12,7 @@ import org.jetbrains.annotations.Nullable;
 
 import java.nio.ByteBuffer;
 
+import eu.artemisc.stodium.Constants;
 import eu.artemisc.stodium.Stodium;
 import eu.artemisc.stodium.StodiumJNI;
 import eu.artemisc.stodium.exceptions.StodiumException;
@@ -23,10 +24,10 @@ final class HSalsa20
         extends Core {
 
     HSalsa20() {
-        super(StodiumJNI.crypto_core_hsalsa20_inputbytes(),
-              StodiumJNI.crypto_core_hsalsa20_outputbytes(),
-              StodiumJNI.crypto_core_hsalsa20_constbytes(),
-              StodiumJNI.crypto_core_hsalsa20_keybytes());
+        super(Constants.CORE_HSALSA20_INPUTBYTES,
+              Constants.CORE_HSALSA20_OUTPUTBYTES,
+              Constants.CORE_HSALSA20_CONSTBYTES,
+              Constants.CORE_HSALSA20_KEYBYTES);
     }
 
     @Override
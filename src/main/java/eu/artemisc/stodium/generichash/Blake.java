@@ -5,9 +5,14 @@ import org.jetbrains.annotations.Nullable;
 
 import java.nio.ByteBuffer;
 
+import eu.artemisc.stodium.Constants;
 import eu.artemisc.stodium.Multipart;
+import eu.artemisc.stodium.NativeMultipart;
+import eu.artemisc.stodium.NativeState;
+import eu.artemisc.stodium.StatePool;
 import eu.artemisc.stodium.Stodium;
 import eu.artemisc.stodium.StodiumJNI;
+import eu.artemisc.stodium.exceptions.ConstraintViolationException;
 import eu.artemisc.stodium.exceptions.StodiumException;
 import eu.artemisc.stodium.hash.Hash;
 
@@ -19,13 +24,13 @@ final class Blake
         implements Multipart.Spec {
 
     Blake() {
-        super(StodiumJNI.crypto_generichash_blake2b_bytes(),
-                StodiumJNI.crypto_generichash_blake2b_bytes_min(),
-                StodiumJNI.crypto_generichash_blake2b_bytes_max(),
-                StodiumJNI.crypto_generichash_blake2b_keybytes(),
-                StodiumJNI.crypto_generichash_blake2b_keybytes_min(),
-                StodiumJNI.crypto_generichash_blake2b_keybytes_max(),
-                StodiumJNI.crypto_generichash_blake2b_statebytes());
+        super(Constants.GENERICHASH_BLAKE2B_BYTES,
+                Constants.GENERICHASH_BLAKE2B_BYTES_MIN,
+                Constants.GENERICHASH_BLAKE2B_BYTES_MAX,
+                Constants.GENERICHASH_BLAKE2B_KEYBYTES,
+                Constants.GENERICHASH_BLAKE2B_KEYBYTES_MIN,
+                Constants.GENERICHASH_BLAKE2B_KEYBYTES_MAX,
+                Constants.GENERICHASH_BLAKE2B_STATEBYTES);
     }
 
     @Override
@@ -52,6 +57,35 @@ final class Blake
                 key == null ? null : Stodium.ensureUsableByteBuffer(key)));
     }
 
+    @Override
+    public void hashBatch(final @NotNull  ByteBuffer dstHash,
+                          final           int        outlen,
+                          final @NotNull  ByteBuffer src,
+                          final @NotNull  int[]      table,
+                          final @Nullable ByteBuffer key)
+            throws StodiumException {
+        Stodium.checkDestinationWritable(dstHash);
+
+        if ((table.length & 1) != 0) {
+            throw new ConstraintViolationException("Stodium: batch table should hold (offset, length) pairs");
+        }
+        if (key != null) {
+            Stodium.checkSize(key.remaining(), KEYBYTES_MIN, KEYBYTES_MAX);
+        }
+        Stodium.checkSize(outlen, BYTES_MIN, BYTES_MAX);
+        Stodium.checkSizeMin(dstHash.remaining(), (long) (table.length / 2) * outlen);
+        for (int i = 0; i < table.length; i += 2) {
+            Stodium.checkOffsetParams(src.remaining(), table[i], table[i + 1]);
+        }
+
+        Stodium.checkStatus(StodiumJNI.crypto_generichash_blake2b_batch(
+                Stodium.ensureUsableByteBuffer(dstHash),
+                outlen,
+                Stodium.ensureUsableByteBuffer(src),
+                table,
+                key == null ? null : Stodium.ensureUsableByteBuffer(key)));
+    }
+
     @NotNull
     @Override
     public Multipart<Hash> init()
@@ -77,7 +111,7 @@ final class Blake
             Stodium.checkSize(key.remaining(), KEYBYTES_MIN, KEYBYTES_MAX);
         }
         Stodium.checkSize(outlen, BYTES_MIN, BYTES_MAX);
-        state = ByteBuffer.allocateDirect(STATEBYTES);
+        state = StatePool.acquire(STATEBYTES);
 
         Stodium.checkStatus(StodiumJNI.crypto_generichash_blake2b_init(
                 state, key == null ? null : Stodium.ensureUsableByteBuffer(key), outlen));
@@ -85,6 +119,27 @@ final class Blake
         return new Multipart<>(this, state);
     }
 
+    @NotNull
+    @Override
+    public NativeMultipart<Hash> initNative()
+            throws StodiumException {
+        return initNative(null, BYTES);
+    }
+
+    @NotNull
+    @Override
+    public NativeMultipart<Hash> initNative(final @Nullable ByteBuffer key,
+                                            final           int        outlen)
+            throws StodiumException {
+        if (key != null) {
+            Stodium.checkSize(key.remaining(), KEYBYTES_MIN, KEYBYTES_MAX);
+        }
+        Stodium.checkSize(outlen, BYTES_MIN, BYTES_MAX);
+
+        return new NativeMultipart<Hash>(NativeState.wrap(StodiumJNI.stodium_state_blake2b_init(
+                key == null ? null : Stodium.ensureUsableByteBuffer(key), outlen)));
+    }
+
     @Override
     public void update(final @NotNull ByteBuffer state,
                        final @NotNull ByteBuffer in)
@@ -10,8 +10,11 @@ package eu.artemisc.stodium.generichash;
 import org.jetbrains.annotations.NotNull;
 import org.jetbrains.annotations.Nullable;
 
+import java.io.Closeable;
 import java.nio.ByteBuffer;
 
+import eu.artemisc.stodium.Constants;
+import eu.artemisc.stodium.StatePool;
 import eu.artemisc.stodium.Stodium;
 import eu.artemisc.stodium.exceptions.ConstraintViolationException;
 import eu.artemisc.stodium.exceptions.StodiumException;
@@ -20,18 +23,19 @@ import eu.artemisc.stodium.StodiumJNI;
 /**
  * @author Jan van de Molengraft [jan@artemisc.eu]
  */
-public class Blake2b {
+public class Blake2b
+        implements Closeable {
 
     // constants
-    public static final int BYTES         = StodiumJNI.crypto_generichash_blake2b_bytes();
-    public static final int BYTES_MIN     = StodiumJNI.crypto_generichash_blake2b_bytes_min();
-    public static final int BYTES_MAX     = StodiumJNI.crypto_generichash_blake2b_bytes_max();
-    public static final int KEYBYTES      = StodiumJNI.crypto_generichash_blake2b_keybytes();
-    public static final int KEYBYTES_MIN  = StodiumJNI.crypto_generichash_blake2b_keybytes_min();
-    public static final int KEYBYTES_MAX  = StodiumJNI.crypto_generichash_blake2b_keybytes_max();
-    public static final int SALTBYTES     = StodiumJNI.crypto_generichash_blake2b_saltbytes();
-    public static final int PERSONALBYTES = StodiumJNI.crypto_generichash_blake2b_personalbytes();
-    public static final int STATE_BYTES   = StodiumJNI.crypto_generichash_blake2b_statebytes();
+    public static final int BYTES         = Constants.GENERICHASH_BLAKE2B_BYTES;
+    public static final int BYTES_MIN     = Constants.GENERICHASH_BLAKE2B_BYTES_MIN;
+    public static final int BYTES_MAX     = Constants.GENERICHASH_BLAKE2B_BYTES_MAX;
+    public static final int KEYBYTES      = Constants.GENERICHASH_BLAKE2B_KEYBYTES;
+    public static final int KEYBYTES_MIN  = Constants.GENERICHASH_BLAKE2B_KEYBYTES_MIN;
+    public static final int KEYBYTES_MAX  = Constants.GENERICHASH_BLAKE2B_KEYBYTES_MAX;
+    public static final int SALTBYTES     = Constants.GENERICHASH_BLAKE2B_SALTBYTES;
+    public static final int PERSONALBYTES = Constants.GENERICHASH_BLAKE2B_PERSONALBYTES;
+    public static final int STATE_BYTES   = Constants.GENERICHASH_BLAKE2B_STATEBYTES;
 
     // Implementation of the stream API
 
@@ -48,6 +52,12 @@ public class Blake2b {
      */
     private final int outlen;
 
+    /**
+     * closed is set by {@link #close()}, after which the state belongs to the
+     * pool.
+     */
+    private boolean closed;
+
     /**
      * State allocates a byte array that holds the raw packed value of the C
      * crypto_generichash_state bytes. This constructor does NOT call
@@ -59,7 +69,7 @@ public class Blake2b {
     public Blake2b(final int outlen)
             throws StodiumException {
         Stodium.checkSize(outlen, BYTES_MIN, BYTES_MAX);
-        this.state  = ByteBuffer.allocateDirect(STATE_BYTES);
+        this.state  = StatePool.acquire(STATE_BYTES);
         this.outlen = outlen;
     }
 
@@ -86,12 +96,15 @@ public class Blake2b {
      * @param original The original State that should be copied
      */
     public Blake2b(final @NotNull Blake2b original) {
-        this.state  = ByteBuffer.allocateDirect(STATE_BYTES);
+        original.checkOpen();
+        this.state  = StatePool.copyOf(original.state);
         this.outlen = original.outlen;
+    }
 
-        this.state.put(original.state);
-        this.state.position(0);
-        original.state.position(0);
+    private void checkOpen() {
+        if (closed) {
+            throw new IllegalStateException("Stodium: multipart state was closed");
+        }
     }
 
     /**
@@ -111,6 +124,7 @@ public class Blake2b {
      */
     public void init(final @Nullable ByteBuffer key)
             throws StodiumException {
+        checkOpen();
         if (key != null) {
             Stodium.checkSize(key.remaining(), KEYBYTES_MIN, KEYBYTES_MAX
             );
@@ -118,7 +132,7 @@ public class Blake2b {
 
         Stodium.checkStatus(StodiumJNI.crypto_generichash_blake2b_init(
                 state,
-                key == null ? ByteBuffer.allocateDirect(0) : Stodium.ensureUsableByteBuffer(key),
+                key == null ? null : Stodium.ensureUsableByteBuffer(key),
                 outlen));
     }
 
@@ -130,6 +144,7 @@ public class Blake2b {
      */
     public void update(final @NotNull ByteBuffer in)
             throws StodiumException {
+        checkOpen();
         Stodium.checkStatus(StodiumJNI.crypto_generichash_blake2b_update(
                 state, Stodium.ensureUsableByteBuffer(in)));
     }
@@ -141,12 +156,26 @@ public class Blake2b {
      */
     public void doFinal(final @NotNull ByteBuffer out)
             throws StodiumException {
+        checkOpen();
         Stodium.checkSize(out.remaining(), 1, outlen);
         Stodium.checkDestinationWritable(out);
         Stodium.checkStatus(StodiumJNI.crypto_generichash_blake2b_final(
                 state, Stodium.ensureUsableByteBuffer(out)));
     }
 
+    /**
+     * close wipes the state and returns it to the {@link StatePool}. The
+     * object must not be used afterwards; closing it again has no effect.
+     */
+    @Override
+    public void close() {
+        if (closed) {
+            return;
+        }
+        closed = true;
+        StatePool.release(state);
+    }
+
     // wrappers
 
     //
@@ -168,8 +197,12 @@ public class Blake2b {
                                    final @Nullable ByteBuffer srcKey)
             throws StodiumException {
         final Blake2b blake2b = new Blake2b(dstHash.remaining(), srcKey);
-        blake2b.update(srcInput);
-        blake2b.doFinal(dstHash);
+        try {
+            blake2b.update(srcInput);
+            blake2b.doFinal(dstHash);
+        } finally {
+            blake2b.close();
+        }
     }
 
     /**
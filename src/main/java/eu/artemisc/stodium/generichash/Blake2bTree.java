@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2017 Project ArteMisc
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+package eu.artemisc.stodium.generichash;
+
+import org.jetbrains.annotations.NotNull;
+import org.jetbrains.annotations.Nullable;
+
+import java.io.Closeable;
+import java.nio.ByteBuffer;
+
+import eu.artemisc.stodium.SecureBuffer;
+import eu.artemisc.stodium.Stodium;
+import eu.artemisc.stodium.StodiumJNI;
+import eu.artemisc.stodium.exceptions.ConstraintViolationException;
+import eu.artemisc.stodium.exceptions.StodiumException;
+
+/**
+ * Blake2bTree is a binary Merkle tree of Blake2b digests over the fixed-size
+ * leaves of a message, for hashing large messages on several cores and
+ * re-hashing them after a few leaves changed.
+ * <p>
+ * Every leaf is the Blake2b of {@code 0x00 || leaf}, every parent the Blake2b
+ * of {@code 0x01 || left || right} (or {@code 0x01 || left} for the last node
+ * of an odd level). All digests are outlen bytes and use the same optional
+ * key. The root therefore depends on the leaf size and outlen, and is not the
+ * Blake2b of the message itself.
+ * <p>
+ * The leaves are hashed with {@link #update(long, ByteBuffer)}, spread over
+ * the native worker pool if one was started with
+ * {@link Stodium#startWorkerPool(int)}. {@link #root(ByteBuffer)} then only
+ * re-hashes the parents of the leaves that were updated since the previous
+ * root. A Blake2bTree is not thread-safe.
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+public final class Blake2bTree
+        implements Closeable {
+
+    private final           long         length;
+    private final           int          leafSize;
+    private final           int          leaves;
+    private final           int          outlen;
+    private final @NotNull  ByteBuffer   tree;
+    private final @Nullable SecureBuffer key;
+
+    /**
+     *
+     * @param length   the length of the message
+     * @param leafSize the length of every leaf but the last
+     * @param outlen   the length of every digest, and of the root
+     * @param key      the key of every digest, may be null
+     * @throws ConstraintViolationException if the message has more than
+     *         {@link Integer#MAX_VALUE} leaves, or its tree does not fit in a
+     *         single buffer
+     * @throws StodiumException
+     */
+    public Blake2bTree(final           long       length,
+                       final           int        leafSize,
+                       final           int        outlen,
+                       final @Nullable ByteBuffer key)
+            throws StodiumException {
+        if (length < 0) {
+            throw new ConstraintViolationException("Stodium: negative message length");
+        }
+        Stodium.checkSizeMin(leafSize, 1);
+        Stodium.checkSize(outlen, Blake2b.BYTES_MIN, Blake2b.BYTES_MAX);
+        if (key != null) {
+            Stodium.checkSize(key.remaining(), Blake2b.KEYBYTES_MIN, Blake2b.KEYBYTES_MAX);
+        }
+
+        final long leafCount = Math.max(1L, (length + leafSize - 1) / leafSize);
+        if (leafCount > Integer.MAX_VALUE) {
+            throw new ConstraintViolationException("Stodium: too many leaves [" + leafCount + "]");
+        }
+        final long bytes = StodiumJNI.crypto_generichash_blake2b_tree_bytes((int) leafCount, outlen);
+        if (bytes <= 0 || bytes > Integer.MAX_VALUE) {
+            throw new ConstraintViolationException("Stodium: tree too large [" + bytes + "]");
+        }
+
+        this.length   = length;
+        this.leafSize = leafSize;
+        this.leaves   = (int) leafCount;
+        this.outlen   = outlen;
+        this.tree     = ByteBuffer.allocateDirect((int) bytes);
+        if (key == null) {
+            this.key = null;
+        } else {
+            this.key = SecureBuffer.allocate(key.remaining());
+            this.key.buffer().duplicate().put(key.duplicate());
+        }
+    }
+
+    /**
+     *
+     * @return
+     */
+    public long length() {
+        return length;
+    }
+
+    /**
+     *
+     * @return
+     */
+    public int leafSize() {
+        return leafSize;
+    }
+
+    /**
+     *
+     * @return
+     */
+    public int leaves() {
+        return leaves;
+    }
+
+    /**
+     *
+     * @return
+     */
+    public int outlen() {
+        return outlen;
+    }
+
+    /**
+     * update hashes the leaves of the message in src, which starts at offset
+     * in the message. Offset must be at a leaf boundary, and src must hold
+     * whole leaves, or run up to the end of the message.
+     *
+     * @param offset the offset of src in the message
+     * @param src    one or more consecutive leaves
+     * @throws ConstraintViolationException
+     * @throws StodiumException
+     */
+    public void update(final          long       offset,
+                       final @NotNull ByteBuffer src)
+            throws StodiumException {
+        final long end = offset + src.remaining();
+        if (offset < 0 || offset % leafSize != 0 || end > length) {
+            throw new ConstraintViolationException("Stodium: leaves out of range");
+        }
+        if ((src.remaining() == 0 && length != 0)
+                || (end != length && src.remaining() % leafSize != 0)) {
+            throw new ConstraintViolationException("Stodium: src should hold whole leaves");
+        }
+
+        Stodium.checkStatus(StodiumJNI.crypto_generichash_blake2b_tree_leaves(
+                tree,
+                leaves,
+                outlen,
+                (int) (offset / leafSize),
+                leafSize,
+                Stodium.ensureUsableByteBuffer(src),
+                keyBuffer()));
+    }
+
+    /**
+     * root re-hashes the parents of the leaves updated since the previous call
+     * and writes the root of the tree to dst. Every leaf must have been
+     * updated at least once.
+     *
+     * @param dst receives the outlen bytes of the root
+     * @throws ConstraintViolationException
+     * @throws StodiumException if a leaf was never updated
+     */
+    public void root(final @NotNull ByteBuffer dst)
+            throws StodiumException {
+        Stodium.checkDestinationWritable(dst);
+        Stodium.checkSizeMin(dst.remaining(), outlen);
+
+        Stodium.checkStatus(StodiumJNI.crypto_generichash_blake2b_tree_root(
+                tree,
+                leaves,
+                outlen,
+                Stodium.ensureUsableByteBuffer(dst),
+                keyBuffer()));
+    }
+
+    @Nullable
+    private ByteBuffer keyBuffer() {
+        return key == null ? null : key.buffer();
+    }
+
+    /**
+     * close wipes the copy of the key. The tree must not be used afterwards.
+     */
+    @Override
+    public void close() {
+        if (key != null) {
+            key.close();
+        }
+    }
+}
@@ -10,9 +10,11 @@ package eu.artemisc.stodium.generichash;
 import org.jetbrains.annotations.NotNull;
 import org.jetbrains.annotations.Nullable;
 
+import java.io.FileDescriptor;
 import java.nio.ByteBuffer;
 
 import eu.artemisc.stodium.Multipart;
+import eu.artemisc.stodium.NativeMultipart;
 import eu.artemisc.stodium.Singleton;
 import eu.artemisc.stodium.exceptions.StodiumException;
 import eu.artemisc.stodium.hash.Hash;
@@ -126,6 +128,30 @@ public abstract class GenericHash
                               final @Nullable ByteBuffer key)
             throws StodiumException;
 
+    /**
+     * hashBatch hashes a batch of messages with the same key in a single call
+     * to the native code. The messages are spread over the native worker pool
+     * if one was started with {@link eu.artemisc.stodium.Stodium#startWorkerPool(int)}.
+     * <p>
+     * The table holds an (offset, length) pair for every message in src, with
+     * the offsets relative to {@code src.position()}. The digests of outlen
+     * bytes each are written back to back to dstHash, in the order of the
+     * table.
+     *
+     * @param dstHash receives the digests
+     * @param outlen  the length of every digest
+     * @param src     holds the messages
+     * @param table   the (offset, length) pair of every message
+     * @param key     the key shared by every message, may be null
+     * @throws StodiumException
+     */
+    public abstract void hashBatch(final @NotNull  ByteBuffer dstHash,
+                                   final           int        outlen,
+                                   final @NotNull  ByteBuffer src,
+                                   final @NotNull  int[]      table,
+                                   final @Nullable ByteBuffer key)
+            throws StodiumException;
+
     /**
      *
      * @param key
@@ -147,4 +173,91 @@ public abstract class GenericHash
     public abstract Multipart<Hash> init(final @Nullable ByteBuffer key,
                                          final           int        outlen)
             throws StodiumException;
+
+    /**
+     * initNative does the same as {@link #init(ByteBuffer, int)}, but keeps
+     * the state in native memory. See {@link eu.artemisc.stodium.NativeState}.
+     *
+     * @param key
+     * @param outlen
+     * @return
+     * @throws StodiumException
+     */
+    @NotNull
+    public abstract NativeMultipart<Hash> initNative(final @Nullable ByteBuffer key,
+                                                     final           int        outlen)
+            throws StodiumException;
+
+    /**
+     * hashFile hashes length bytes of an open file, starting at offset, or
+     * the rest of the file if length is negative. The file is read and
+     * hashed by the native code in a single call, see
+     * {@link NativeMultipart#updateFile(FileDescriptor, long, long)}.
+     *
+     * @param dstHash
+     * @param fd     the descriptor of a file opened for reading
+     * @param offset
+     * @param length
+     * @param key
+     * @throws StodiumException
+     */
+    public final void hashFile(final @NotNull  ByteBuffer     dstHash,
+                               final @NotNull  FileDescriptor fd,
+                               final           long           offset,
+                               final           long           length,
+                               final @Nullable ByteBuffer     key)
+            throws StodiumException {
+        final NativeMultipart<Hash> state = initNative(key, dstHash.remaining());
+        try {
+            state.updateFile(fd, offset, length);
+            state.doFinal(dstHash);
+        } finally {
+            state.close();
+        }
+    }
+
+    /**
+     * hashMapped hashes the remaining bytes of a mapped (or other direct)
+     * buffer in a single native call, see
+     * {@link NativeMultipart#updateMapped(ByteBuffer)}.
+     *
+     * @param dstHash
+     * @param src
+     * @param key
+     * @throws StodiumException
+     */
+    public final void hashMapped(final @NotNull  ByteBuffer dstHash,
+                                 final @NotNull  ByteBuffer src,
+                                 final @Nullable ByteBuffer key)
+            throws StodiumException {
+        final NativeMultipart<Hash> state = initNative(key, dstHash.remaining());
+        try {
+            state.updateMapped(src);
+            state.doFinal(dstHash);
+        } finally {
+            state.close();
+        }
+    }
+
+    /**
+     * hash hashes the concatenation of the remaining bytes of the buffers of
+     * src, without concatenating them, in a single native update.
+     *
+     * @param dstHash
+     * @param src     the fragments of the message
+     * @param key
+     * @throws StodiumException
+     */
+    public final void hash(final @NotNull  ByteBuffer   dstHash,
+                           final @NotNull  ByteBuffer[] src,
+                           final @Nullable ByteBuffer   key)
+            throws StodiumException {
+        final NativeMultipart<Hash> state = initNative(key, dstHash.remaining());
+        try {
+            state.update(src);
+            state.doFinal(dstHash);
+        } finally {
+            state.close();
+        }
+    }
 }
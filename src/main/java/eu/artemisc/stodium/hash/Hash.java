@@ -9,9 +9,11 @@ package eu.artemisc.stodium.hash;
 
 import org.jetbrains.annotations.NotNull;
 
+import java.io.FileDescriptor;
 import java.nio.ByteBuffer;
 
 import eu.artemisc.stodium.Multipart;
+import eu.artemisc.stodium.NativeMultipart;
 import eu.artemisc.stodium.Singleton;
 import eu.artemisc.stodium.exceptions.StodiumException;
 
@@ -99,4 +101,82 @@ public abstract class Hash {
     @NotNull
     public abstract Multipart<Hash> init()
             throws StodiumException;
+
+    /**
+     * initNative does the same as {@link #init()}, but keeps the state in
+     * native memory. See {@link eu.artemisc.stodium.NativeState}.
+     *
+     * @return
+     * @throws StodiumException
+     */
+    @NotNull
+    public abstract NativeMultipart<Hash> initNative()
+            throws StodiumException;
+
+    /**
+     * hashFile hashes length bytes of an open file, starting at offset, or
+     * the rest of the file if length is negative. The file is read and
+     * hashed by the native code in a single call, see
+     * {@link NativeMultipart#updateFile(FileDescriptor, long, long)}.
+     *
+     * @param dstHash
+     * @param fd     the descriptor of a file opened for reading
+     * @param offset
+     * @param length
+     * @throws StodiumException
+     */
+    public final void hashFile(final @NotNull ByteBuffer     dstHash,
+                               final @NotNull FileDescriptor fd,
+                               final          long           offset,
+                               final          long           length)
+            throws StodiumException {
+        final NativeMultipart<Hash> state = initNative();
+        try {
+            state.updateFile(fd, offset, length);
+            state.doFinal(dstHash);
+        } finally {
+            state.close();
+        }
+    }
+
+    /**
+     * hashMapped hashes the remaining bytes of a mapped (or other direct)
+     * buffer in a single native call, see
+     * {@link NativeMultipart#updateMapped(ByteBuffer)}.
+     *
+     * @param dstHash
+     * @param src
+     * @throws StodiumException
+     */
+    public final void hashMapped(final @NotNull ByteBuffer dstHash,
+                                 final @NotNull ByteBuffer src)
+            throws StodiumException {
+        final NativeMultipart<Hash> state = initNative();
+        try {
+            state.updateMapped(src);
+            state.doFinal(dstHash);
+        } finally {
+            state.close();
+        }
+    }
+
+    /**
+     * hash hashes the concatenation of the remaining bytes of the buffers of
+     * src, without concatenating them, in a single native update.
+     *
+     * @param dstHash
+     * @param src     the fragments of the message
+     * @throws StodiumException
+     */
+    public final void hash(final @NotNull ByteBuffer   dstHash,
+                           final @NotNull ByteBuffer[] src)
+            throws StodiumException {
+        final NativeMultipart<Hash> state = initNative();
+        try {
+            state.update(src);
+            state.doFinal(dstHash);
+        } finally {
+            state.close();
+        }
+    }
 }
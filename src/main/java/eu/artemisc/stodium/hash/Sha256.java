@@ -4,7 +4,11 @@ import org.jetbrains.annotations.NotNull;
 
 import java.nio.ByteBuffer;
 
+import eu.artemisc.stodium.Constants;
 import eu.artemisc.stodium.Multipart;
+import eu.artemisc.stodium.NativeMultipart;
+import eu.artemisc.stodium.NativeState;
+import eu.artemisc.stodium.StatePool;
 import eu.artemisc.stodium.Stodium;
 import eu.artemisc.stodium.StodiumJNI;
 import eu.artemisc.stodium.exceptions.StodiumException;
@@ -17,8 +21,8 @@ final class Sha256
         implements Multipart.Spec {
 
     Sha256() {
-        super(StodiumJNI.crypto_hash_sha256_bytes(),
-                StodiumJNI.crypto_hash_sha256_statebytes());
+        super(Constants.HASH_SHA256_BYTES,
+                Constants.HASH_SHA256_STATEBYTES);
     }
 
     @Override
@@ -40,12 +44,19 @@ final class Sha256
             throws StodiumException {
         final ByteBuffer state;
 
-        state = ByteBuffer.allocateDirect(STATEBYTES);
+        state = StatePool.acquire(STATEBYTES);
         Stodium.checkStatus(StodiumJNI.crypto_hash_sha256_init(state));
 
         return new Multipart<>(this, state);
     }
 
+    @NotNull
+    @Override
+    public NativeMultipart<Hash> initNative()
+            throws StodiumException {
+        return new NativeMultipart<Hash>(NativeState.wrap(StodiumJNI.stodium_state_sha256_init()));
+    }
+
     @Override
     public void update(final @NotNull ByteBuffer state,
                        final @NotNull ByteBuffer in)
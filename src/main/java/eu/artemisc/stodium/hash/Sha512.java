@@ -4,7 +4,11 @@ import org.jetbrains.annotations.NotNull;
 
 import java.nio.ByteBuffer;
 
+import eu.artemisc.stodium.Constants;
 import eu.artemisc.stodium.Multipart;
+import eu.artemisc.stodium.NativeMultipart;
+import eu.artemisc.stodium.NativeState;
+import eu.artemisc.stodium.StatePool;
 import eu.artemisc.stodium.Stodium;
 import eu.artemisc.stodium.StodiumJNI;
 import eu.artemisc.stodium.exceptions.StodiumException;
@@ -17,8 +21,8 @@ final class Sha512
         implements Multipart.Spec {
 
     Sha512() {
-        super(StodiumJNI.crypto_hash_sha512_bytes(),
-                StodiumJNI.crypto_hash_sha512_statebytes());
+        super(Constants.HASH_SHA512_BYTES,
+                Constants.HASH_SHA512_STATEBYTES);
     }
 
     @Override
@@ -40,12 +44,19 @@ final class Sha512
             throws StodiumException {
         final ByteBuffer state;
 
-        state = ByteBuffer.allocateDirect(STATEBYTES);
+        state = StatePool.acquire(STATEBYTES);
         Stodium.checkStatus(StodiumJNI.crypto_hash_sha512_init(state));
 
         return new Multipart<>(this, state);
     }
 
+    @NotNull
+    @Override
+    public NativeMultipart<Hash> initNative()
+            throws StodiumException {
+        return new NativeMultipart<Hash>(NativeState.wrap(StodiumJNI.stodium_state_sha512_init()));
+    }
+
     @Override
     public void update(final @NotNull ByteBuffer state,
                        final @NotNull ByteBuffer in)
@@ -4,6 +4,8 @@ import org.jetbrains.annotations.NotNull;
 
 import java.nio.ByteBuffer;
 
+import eu.artemisc.stodium.Constants;
+import eu.artemisc.stodium.SecureBuffer;
 import eu.artemisc.stodium.Stodium;
 import eu.artemisc.stodium.StodiumJNI;
 import eu.artemisc.stodium.exceptions.StodiumException;
@@ -14,10 +16,10 @@ import eu.artemisc.stodium.exceptions.StodiumException;
 public final class Blake2b
         extends Kdf {
     Blake2b() {
-        super(StodiumJNI.crypto_kdf_blake2b_bytes_min(),
-                StodiumJNI.crypto_kdf_blake2b_bytes_max(),
-                StodiumJNI.crypto_kdf_blake2b_contextbytes(),
-                StodiumJNI.crypto_kdf_blake2b_keybytes());
+        super(Constants.KDF_BLAKE2B_BYTES_MIN,
+                Constants.KDF_BLAKE2B_BYTES_MAX,
+                Constants.KDF_BLAKE2B_CONTEXTBYTES,
+                Constants.KDF_BLAKE2B_KEYBYTES);
     }
 
     @Override
@@ -38,4 +40,93 @@ public final class Blake2b
                 Stodium.ensureUsableByteBuffer(context),
                 Stodium.ensureUsableByteBuffer(key)));
     }
+
+    @Override
+    public void deriveRange(final @NotNull ByteBuffer dst,
+                            final          int        subKeyLength,
+                            final          long       firstSubKeyId,
+                            final          int        count,
+                            final @NotNull ByteBuffer context,
+                            final @NotNull ByteBuffer key)
+            throws StodiumException {
+        checkRange(dst, subKeyLength, count);
+        Stodium.checkSize(context.remaining(), CONTEXTBYTES);
+        Stodium.checkSize(key.remaining(), KEYBYTES);
+
+        Stodium.checkStatus(StodiumJNI.crypto_kdf_blake2b_derive_range(
+                Stodium.ensureUsableByteBuffer(dst),
+                subKeyLength,
+                firstSubKeyId,
+                count,
+                Stodium.ensureUsableByteBuffer(context),
+                Stodium.ensureUsableByteBuffer(key)));
+    }
+
+    @NotNull
+    @Override
+    public KdfContext prepare(final @NotNull ByteBuffer context,
+                              final @NotNull ByteBuffer key)
+            throws StodiumException {
+        Stodium.checkSize(context.remaining(), CONTEXTBYTES);
+        Stodium.checkSize(key.remaining(), KEYBYTES);
+
+        final SecureBuffer prepared = SecureBuffer.allocate(
+                StodiumJNI.crypto_kdf_blake2b_preparedbytes());
+        try {
+            Stodium.checkStatus(StodiumJNI.crypto_kdf_blake2b_prepare(
+                    prepared.buffer(),
+                    Stodium.ensureUsableByteBuffer(context),
+                    Stodium.ensureUsableByteBuffer(key)));
+        } catch (final StodiumException e) {
+            prepared.close();
+            throw e;
+        }
+        return new Prepared(this, prepared);
+    }
+
+    /**
+     * Prepared keeps the master key and the context, padded to the Blake2b
+     * personalisation, in a SecureBuffer; only the salt holding the subkey id
+     * is set per subkey.
+     */
+    private static final class Prepared
+            extends KdfContext {
+        private final @NotNull Blake2b      kdf;
+        private final @NotNull SecureBuffer prepared;
+
+        Prepared(final @NotNull Blake2b      kdf,
+                 final @NotNull SecureBuffer prepared) {
+            this.kdf      = kdf;
+            this.prepared = prepared;
+        }
+
+        @Override
+        public void deriveFromKey(final @NotNull ByteBuffer subKey,
+                                  final          long       subKeyId)
+                throws StodiumException {
+            Stodium.checkSize(subKey.remaining(), kdf.BYTES_MIN, kdf.BYTES_MAX);
+            deriveRange(subKey, subKey.remaining(), subKeyId, 1);
+        }
+
+        @Override
+        public void deriveRange(final @NotNull ByteBuffer dst,
+                                final          int        subKeyLength,
+                                final          long       firstSubKeyId,
+                                final          int        count)
+                throws StodiumException {
+            kdf.checkRange(dst, subKeyLength, count);
+
+            Stodium.checkStatus(StodiumJNI.crypto_kdf_blake2b_derive_prepared(
+                    Stodium.ensureUsableByteBuffer(dst),
+                    subKeyLength,
+                    firstSubKeyId,
+                    count,
+                    prepared.buffer()));
+        }
+
+        @Override
+        public void close() {
+            prepared.close();
+        }
+    }
 }
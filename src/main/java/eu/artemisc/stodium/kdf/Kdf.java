@@ -5,6 +5,7 @@ import org.jetbrains.annotations.NotNull;
 import java.nio.ByteBuffer;
 
 import eu.artemisc.stodium.Singleton;
+import eu.artemisc.stodium.Stodium;
 import eu.artemisc.stodium.exceptions.StodiumException;
 
 /**
@@ -90,4 +91,54 @@ public abstract class Kdf {
                                        final @NotNull ByteBuffer context,
                                        final @NotNull ByteBuffer key)
             throws StodiumException;
+
+    /**
+     * deriveRange derives the count subkeys with ids firstSubKeyId up to
+     * firstSubKeyId + count - 1 in a single native call, and writes them back
+     * to back to dst. Subkey i is the one {@link #deriveFromKey} derives for
+     * id firstSubKeyId + i.
+     *
+     * @param dst           receives count * subKeyLength bytes
+     * @param subKeyLength  the length of every subkey
+     * @param firstSubKeyId the id of the first subkey
+     * @param count         the number of subkeys
+     * @param context
+     * @param key
+     * @throws StodiumException
+     */
+    public abstract void deriveRange(final @NotNull ByteBuffer dst,
+                                     final          int        subKeyLength,
+                                     final          long       firstSubKeyId,
+                                     final          int        count,
+                                     final @NotNull ByteBuffer context,
+                                     final @NotNull ByteBuffer key)
+            throws StodiumException;
+
+    /**
+     * prepare returns a KdfContext that derives the subkeys of key in
+     * context, with the parameters of the hash set up once.
+     *
+     * @param context
+     * @param key
+     * @return the prepared context, to be closed after use
+     * @throws StodiumException
+     */
+    @NotNull
+    public abstract KdfContext prepare(final @NotNull ByteBuffer context,
+                                       final @NotNull ByteBuffer key)
+            throws StodiumException;
+
+    /**
+     * checkRange checks the arguments of a deriveRange call.
+     */
+    final void checkRange(final @NotNull ByteBuffer dst,
+                          final          int        subKeyLength,
+                          final          int        count)
+            throws StodiumException {
+        Stodium.checkDestinationWritable(dst);
+
+        Stodium.checkSize(subKeyLength, BYTES_MIN, BYTES_MAX);
+        Stodium.checkPositive(count);
+        Stodium.checkSizeMin(dst.remaining(), (long) subKeyLength * count);
+    }
 }
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2017 Project ArteMisc
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+package eu.artemisc.stodium.kdf;
+
+import org.jetbrains.annotations.NotNull;
+
+import java.io.Closeable;
+import java.nio.ByteBuffer;
+
+import eu.artemisc.stodium.exceptions.StodiumException;
+
+/**
+ * KdfContext derives the subkeys of a single master key and context, as
+ * returned by {@link Kdf#prepare(ByteBuffer, ByteBuffer)}. The context and
+ * key are checked and laid out as hash parameters once, so every subkey
+ * costs only its hash, without the checks and copies of
+ * {@link Kdf#deriveFromKey}.
+ * <p>
+ * The copy of the master key is kept in guarded native memory, and wiped by
+ * {@link #close()}. A KdfContext can be used by several threads at once.
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+public abstract class KdfContext
+        implements Closeable {
+
+    KdfContext() {
+    }
+
+    /**
+     *
+     * @param subKey   receives the subkey
+     * @param subKeyId
+     * @throws StodiumException
+     */
+    public abstract void deriveFromKey(final @NotNull ByteBuffer subKey,
+                                       final          long       subKeyId)
+            throws StodiumException;
+
+    /**
+     * deriveRange derives count subkeys back to back, as
+     * {@link Kdf#deriveRange} does.
+     *
+     * @param dst           receives count * subKeyLength bytes
+     * @param subKeyLength  the length of every subkey
+     * @param firstSubKeyId the id of the first subkey
+     * @param count         the number of subkeys
+     * @throws StodiumException
+     */
+    public abstract void deriveRange(final @NotNull ByteBuffer dst,
+                                     final          int        subKeyLength,
+                                     final          long       firstSubKeyId,
+                                     final          int        count)
+            throws StodiumException;
+
+    /**
+     * close wipes the copy of the master key. The context must not be used
+     * afterwards.
+     */
+    @Override
+    public abstract void close();
+}
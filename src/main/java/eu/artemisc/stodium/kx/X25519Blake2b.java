@@ -4,6 +4,7 @@ import org.jetbrains.annotations.NotNull;
 
 import java.nio.ByteBuffer;
 
+import eu.artemisc.stodium.Constants;
 import eu.artemisc.stodium.Stodium;
 import eu.artemisc.stodium.StodiumJNI;
 import eu.artemisc.stodium.exceptions.StodiumException;
@@ -14,10 +15,10 @@ import eu.artemisc.stodium.exceptions.StodiumException;
 public final class X25519Blake2b
         extends Kx {
     X25519Blake2b() {
-        super(StodiumJNI.crypto_kx_publickeybytes(),
-                StodiumJNI.crypto_kx_secretkeybytes(),
-                StodiumJNI.crypto_kx_seedbytes(),
-                StodiumJNI.crypto_kx_sessionkeybytes());
+        super(Constants.KX_PUBLICKEYBYTES,
+                Constants.KX_SECRETKEYBYTES,
+                Constants.KX_SEEDBYTES,
+                Constants.KX_SESSIONKEYBYTES);
     }
 
     @Override
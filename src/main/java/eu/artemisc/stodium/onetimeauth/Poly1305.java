@@ -4,7 +4,11 @@ import org.jetbrains.annotations.NotNull;
 
 import java.nio.ByteBuffer;
 
+import eu.artemisc.stodium.Constants;
 import eu.artemisc.stodium.Multipart;
+import eu.artemisc.stodium.NativeMultipart;
+import eu.artemisc.stodium.NativeState;
+import eu.artemisc.stodium.StatePool;
 import eu.artemisc.stodium.Stodium;
 import eu.artemisc.stodium.StodiumJNI;
 import eu.artemisc.stodium.auth.Auth;
@@ -18,9 +22,9 @@ final class Poly1305
         implements Multipart.Spec {
 
     Poly1305() {
-        super(StodiumJNI.crypto_onetimeauth_poly1305_bytes(),
-                StodiumJNI.crypto_onetimeauth_poly1305_keybytes(),
-                StodiumJNI.crypto_onetimeauth_poly1305_statebytes());
+        super(Constants.ONETIMEAUTH_POLY1305_BYTES,
+                Constants.ONETIMEAUTH_POLY1305_KEYBYTES,
+                Constants.ONETIMEAUTH_POLY1305_STATEBYTES);
     }
 
     @Override
@@ -60,7 +64,7 @@ final class Poly1305
         final ByteBuffer state;
 
         Stodium.checkSize(key.remaining(), KEYBYTES);
-        state = ByteBuffer.allocateDirect(STATEBYTES);
+        state = StatePool.acquire(STATEBYTES);
 
         Stodium.checkStatus(StodiumJNI.crypto_onetimeauth_poly1305_init(
                 state, Stodium.ensureUsableByteBuffer(key)));
@@ -68,6 +72,16 @@ final class Poly1305
         return new Multipart<>(this, state);
     }
 
+    @NotNull
+    @Override
+    public NativeMultipart<Auth> initNative(final @NotNull ByteBuffer key)
+            throws StodiumException {
+        Stodium.checkSize(key.remaining(), KEYBYTES);
+
+        return new NativeMultipart<Auth>(NativeState.wrap(StodiumJNI.stodium_state_poly1305_init(
+                Stodium.ensureUsableByteBuffer(key))));
+    }
+
     @Override
     public void update(final @NotNull ByteBuffer state,
                        final @NotNull ByteBuffer in)
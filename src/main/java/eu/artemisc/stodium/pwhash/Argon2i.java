@@ -4,6 +4,7 @@ import org.jetbrains.annotations.NotNull;
 
 import java.nio.ByteBuffer;
 
+import eu.artemisc.stodium.Constants;
 import eu.artemisc.stodium.Stodium;
 import eu.artemisc.stodium.StodiumJNI;
 import eu.artemisc.stodium.exceptions.StodiumException;
@@ -15,23 +16,23 @@ final class Argon2i
         extends PwHash {
 
     Argon2i() {
-        super(StodiumJNI.crypto_pwhash_argon2i_bytes_min(),
-                StodiumJNI.crypto_pwhash_argon2i_bytes_max(),
-                StodiumJNI.crypto_pwhash_argon2i_passwd_min(),
-                StodiumJNI.crypto_pwhash_argon2i_passwd_max(),
-                StodiumJNI.crypto_pwhash_argon2i_saltbytes(),
-                StodiumJNI.crypto_pwhash_argon2i_strbytes(),
+        super(Constants.PWHASH_ARGON2I_BYTES_MIN,
+                Constants.PWHASH_ARGON2I_BYTES_MAX,
+                Constants.PWHASH_ARGON2I_PASSWD_MIN,
+                Constants.PWHASH_ARGON2I_PASSWD_MAX,
+                Constants.PWHASH_ARGON2I_SALTBYTES,
+                Constants.PWHASH_ARGON2I_STRBYTES,
                 StodiumJNI.crypto_pwhash_argon2i_strprefix(),
-                StodiumJNI.crypto_pwhash_argon2i_opslimit_min(),
-                StodiumJNI.crypto_pwhash_argon2i_opslimit_max(),
-                StodiumJNI.crypto_pwhash_argon2i_memlimit_min(),
-                StodiumJNI.crypto_pwhash_argon2i_memlimit_max(),
-                StodiumJNI.crypto_pwhash_argon2i_opslimit_interactive(),
-                StodiumJNI.crypto_pwhash_argon2i_memlimit_interactive(),
-                StodiumJNI.crypto_pwhash_argon2i_opslimit_interactive(),
-                StodiumJNI.crypto_pwhash_argon2i_memlimit_interactive(),
-                StodiumJNI.crypto_pwhash_argon2i_opslimit_sensitive(),
-                StodiumJNI.crypto_pwhash_argon2i_memlimit_sensitive());
+                Constants.PWHASH_ARGON2I_OPSLIMIT_MIN,
+                Constants.PWHASH_ARGON2I_OPSLIMIT_MAX,
+                Constants.PWHASH_ARGON2I_MEMLIMIT_MIN,
+                Constants.PWHASH_ARGON2I_MEMLIMIT_MAX,
+                Constants.PWHASH_ARGON2I_OPSLIMIT_INTERACTIVE,
+                Constants.PWHASH_ARGON2I_MEMLIMIT_INTERACTIVE,
+                Constants.PWHASH_ARGON2I_OPSLIMIT_MODERATE,
+                Constants.PWHASH_ARGON2I_MEMLIMIT_MODERATE,
+                Constants.PWHASH_ARGON2I_OPSLIMIT_SENSITIVE,
+                Constants.PWHASH_ARGON2I_MEMLIMIT_SENSITIVE);
     }
 
     @Override
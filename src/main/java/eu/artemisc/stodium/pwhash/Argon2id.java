@@ -0,0 +1,96 @@
+package eu.artemisc.stodium.pwhash;
+
+import org.jetbrains.annotations.NotNull;
+
+import java.nio.ByteBuffer;
+
+import eu.artemisc.stodium.Constants;
+import eu.artemisc.stodium.Stodium;
+import eu.artemisc.stodium.StodiumJNI;
+import eu.artemisc.stodium.exceptions.StodiumException;
+
+/**
+ * Argon2id mixes the data independent passes of Argon2i with the data
+ * dependent passes of Argon2d, and is the recommended variant for new
+ * password hashes.
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+final class Argon2id
+        extends PwHash {
+
+    Argon2id() {
+        super(Constants.PWHASH_ARGON2ID_BYTES_MIN,
+                Constants.PWHASH_ARGON2ID_BYTES_MAX,
+                Constants.PWHASH_ARGON2ID_PASSWD_MIN,
+                Constants.PWHASH_ARGON2ID_PASSWD_MAX,
+                Constants.PWHASH_ARGON2ID_SALTBYTES,
+                Constants.PWHASH_ARGON2ID_STRBYTES,
+                StodiumJNI.crypto_pwhash_argon2id_strprefix(),
+                Constants.PWHASH_ARGON2ID_OPSLIMIT_MIN,
+                Constants.PWHASH_ARGON2ID_OPSLIMIT_MAX,
+                Constants.PWHASH_ARGON2ID_MEMLIMIT_MIN,
+                Constants.PWHASH_ARGON2ID_MEMLIMIT_MAX,
+                Constants.PWHASH_ARGON2ID_OPSLIMIT_INTERACTIVE,
+                Constants.PWHASH_ARGON2ID_MEMLIMIT_INTERACTIVE,
+                Constants.PWHASH_ARGON2ID_OPSLIMIT_MODERATE,
+                Constants.PWHASH_ARGON2ID_MEMLIMIT_MODERATE,
+                Constants.PWHASH_ARGON2ID_OPSLIMIT_SENSITIVE,
+                Constants.PWHASH_ARGON2ID_MEMLIMIT_SENSITIVE);
+    }
+
+    @Override
+    public void hash(final @NotNull ByteBuffer dstKey,
+                     final @NotNull ByteBuffer srcPw,
+                     final @NotNull ByteBuffer srcSalt,
+                     final          long       opsLimit,
+                     final          long       memLimit)
+            throws StodiumException {
+        Stodium.checkDestinationWritable(dstKey);
+
+        Stodium.checkSize(dstKey.remaining(), BYTES_MIN, BYTES_MAX);
+        Stodium.checkSize(srcPw.remaining(), PASSWD_MIN, PASSWD_MAX);
+        Stodium.checkSize(srcSalt.remaining(), SALTBYTES);
+        Stodium.checkPow2(memLimit);
+        Stodium.checkSize(memLimit, MEMLIMIT_MIN, MEMLIMIT_MAX);
+        Stodium.checkSize(opsLimit, OPSLIMIT_MIN, OPSLIMIT_MAX);
+
+        Stodium.checkStatus(StodiumJNI.crypto_pwhash_argon2id(
+                Stodium.ensureUsableByteBuffer(dstKey),
+                Stodium.ensureUsableByteBuffer(srcPw),
+                Stodium.ensureUsableByteBuffer(srcSalt),
+                opsLimit, memLimit));
+    }
+
+    @Override
+    public void strHash(final @NotNull ByteBuffer dstString,
+                        final @NotNull ByteBuffer srcPw,
+                        final          long       opsLimit,
+                        final          long       memLimit)
+            throws StodiumException {
+        Stodium.checkDestinationWritable(dstString);
+
+        Stodium.checkSize(dstString.remaining(), STRBYTES);
+        Stodium.checkSize(srcPw.remaining(), PASSWD_MIN, PASSWD_MAX);
+        Stodium.checkPow2(memLimit);
+        Stodium.checkSize(memLimit, MEMLIMIT_MIN, MEMLIMIT_MAX);
+        Stodium.checkSize(opsLimit, OPSLIMIT_MIN, OPSLIMIT_MAX);
+
+        Stodium.checkStatus(StodiumJNI.crypto_pwhash_argon2id_str(
+                Stodium.ensureUsableByteBuffer(dstString),
+                Stodium.ensureUsableByteBuffer(srcPw),
+                opsLimit, memLimit));
+    }
+
+    @Override
+    public boolean strVerify(final @NotNull ByteBuffer str,
+                             final @NotNull ByteBuffer pw)
+            throws StodiumException {
+        Stodium.checkSize(str.remaining(), STRBYTES);
+        Stodium.checkSize(pw.remaining(), PASSWD_MIN, PASSWD_MAX);
+
+        return StodiumJNI.NOERR == StodiumJNI.crypto_pwhash_argon2id_str_verify(
+                Stodium.ensureUsableByteBuffer(str),
+                Stodium.ensureUsableByteBuffer(pw));
+    }
+}
@@ -10,8 +10,13 @@ package eu.artemisc.stodium.pwhash;
 import org.jetbrains.annotations.NotNull;
 
 import java.nio.ByteBuffer;
+import java.util.concurrent.ConcurrentHashMap;
+import java.util.concurrent.ConcurrentMap;
+import java.util.concurrent.TimeUnit;
 
 import eu.artemisc.stodium.Singleton;
+import eu.artemisc.stodium.Stodium;
+import eu.artemisc.stodium.exceptions.OperationFailedException;
 import eu.artemisc.stodium.exceptions.StodiumException;
 
 /**
@@ -27,6 +32,14 @@ public abstract class PwHash {
         }
     };
 
+    private static final @NotNull Singleton<PwHash> ARGON2ID = new Singleton<PwHash>() {
+        @NotNull
+        @Override
+        protected PwHash initialize() {
+            return new Argon2id();
+        }
+    };
+
     private static final @NotNull Singleton<PwHash> SCRYPT = new Singleton<PwHash>() {
         @NotNull
         @Override
@@ -45,6 +58,11 @@ public abstract class PwHash {
         return ARGON2I.get();
     }
 
+    @NotNull
+    public static PwHash argon2idInstance() {
+        return ARGON2ID.get();
+    }
+
     @NotNull
     public static PwHash scryptInstance() {
         return SCRYPT.get();
@@ -69,6 +87,13 @@ public abstract class PwHash {
     final          long   OPSLIMIT_SENSITIVE;
     final          long   MEMLIMIT_SENSITIVE;
 
+    /**
+     * calibrated caches the results of {@link #calibrate(long, long)}, by
+     * target and memory budget.
+     */
+    private final @NotNull ConcurrentMap<String, PwHashParams> calibrated
+            = new ConcurrentHashMap<String, PwHashParams>();
+
     /**
      *
      * @param bytesMin
@@ -292,6 +317,36 @@ public abstract class PwHash {
                               final          long       memLimit)
             throws StodiumException;
 
+    /**
+     *
+     * @param dstHash
+     * @param srcPw
+     * @param srcSalt
+     * @param params the limits, e.g. from {@link #calibrate(long, long)}
+     * @throws StodiumException
+     */
+    public final void hash(final @NotNull ByteBuffer   dstHash,
+                           final @NotNull ByteBuffer   srcPw,
+                           final @NotNull ByteBuffer   srcSalt,
+                           final @NotNull PwHashParams params)
+            throws StodiumException {
+        hash(dstHash, srcPw, srcSalt, params.opsLimit(), params.memLimit());
+    }
+
+    /**
+     *
+     * @param srcPw
+     * @param params the limits, e.g. from {@link #calibrate(long, long)}
+     * @return
+     * @throws StodiumException
+     */
+    @NotNull
+    public final String strHash(final @NotNull ByteBuffer   srcPw,
+                                final @NotNull PwHashParams params)
+            throws StodiumException {
+        return strHash(srcPw, params.opsLimit(), params.memLimit());
+    }
+
     /**
      *
      * @param srcPw
@@ -350,4 +405,116 @@ public abstract class PwHash {
         buff = ByteBuffer.wrap(str.getBytes());
         return strVerify(buff, pw);
     }
+
+    /**
+     * calibrate times a few hashes on this device, to find the strongest
+     * limits for which a hash takes at most targetMillis, using at most
+     * maxMemLimit bytes.
+     * <p>
+     * The memLimit is the largest power of 2 within maxMemLimit for which a
+     * hash at the minimal opsLimit fits the target, after which the opsLimit is
+     * raised to fill the rest of the target. The result is cached for the
+     * lifetime of the process; see {@link PwHashParams#encode()} to keep it
+     * across restarts. Calibrating takes a few times targetMillis, and should
+     * not be done on the main thread.
+     *
+     * @param targetMillis the time a single hash may take
+     * @param maxMemLimit  the memory a single hash may use
+     * @return the calibrated limits
+     * @throws StodiumException if maxMemLimit is below the minimal memLimit, or
+     *                          no memory could be allocated for the hash
+     */
+    @NotNull
+    public final PwHashParams calibrate(final long targetMillis,
+                                        final long maxMemLimit)
+            throws StodiumException {
+        Stodium.checkSizeMin(targetMillis, 1L);
+        Stodium.checkSizeMin(maxMemLimit, MEMLIMIT_MIN);
+
+        final String key = targetMillis + ":" + maxMemLimit;
+        PwHashParams params = calibrated.get(key);
+        if (params == null) {
+            params = probe(TimeUnit.MILLISECONDS.toNanos(targetMillis), maxMemLimit);
+            final PwHashParams existing = calibrated.putIfAbsent(key, params);
+            if (existing != null) {
+                params = existing;
+            }
+        }
+        return params;
+    }
+
+    /**
+     *
+     * @param target
+     * @param maxMemLimit
+     * @return
+     * @throws StodiumException
+     */
+    @NotNull
+    private PwHashParams probe(final long target,
+                               final long maxMemLimit)
+            throws StodiumException {
+        final ByteBuffer dst  = ByteBuffer.allocateDirect((int) Math.max(BYTES_MIN, 16L));
+        final ByteBuffer pw   = ByteBuffer.allocateDirect((int) Math.max(PASSWD_MIN, 16L));
+        final ByteBuffer salt = ByteBuffer.allocateDirect(SALTBYTES);
+
+        // the largest memLimit that fits the target at the lowest opsLimit
+        long mem     = Long.highestOneBit(Math.min(maxMemLimit, MEMLIMIT_MAX));
+        long elapsed = time(dst, pw, salt, OPSLIMIT_MIN, mem);
+        while ((elapsed < 0L || elapsed > target) && mem / 2L >= MEMLIMIT_MIN) {
+            mem    /= 2L;
+            elapsed = time(dst, pw, salt, OPSLIMIT_MIN, mem);
+        }
+        if (elapsed < 0L) {
+            throw new OperationFailedException("Stodium: could not allocate memory for calibration");
+        }
+
+        // the time of a hash grows linearly with the opsLimit
+        long ops = OPSLIMIT_MIN;
+        if (elapsed < target) {
+            ops     = Math.min(OPSLIMIT_MAX, scale(OPSLIMIT_MIN, target, Math.max(elapsed, 1L)));
+            elapsed = time(dst, pw, salt, ops, mem);
+            while ((elapsed < 0L || elapsed > target) && ops > OPSLIMIT_MIN) {
+                ops     = Math.max(OPSLIMIT_MIN, Math.min(ops - 1L, scale(ops, target, Math.max(elapsed, target + 1L))));
+                elapsed = time(dst, pw, salt, ops, mem);
+            }
+        }
+
+        return new PwHashParams(ops, mem, TimeUnit.NANOSECONDS.toMillis(Math.max(elapsed, 0L)));
+    }
+
+    /**
+     * scale returns ops * target / elapsed, without overflowing for the large
+     * opsLimits of scrypt.
+     */
+    private static long scale(final long ops,
+                              final long target,
+                              final long elapsed) {
+        return (long) ((double) ops * target / elapsed);
+    }
+
+    /**
+     * time returns the duration of a hash in nanoseconds, or -1 if the hash
+     * failed (e.g. as the memory could not be allocated).
+     *
+     * @param dst
+     * @param pw
+     * @param salt
+     * @param opsLimit
+     * @param memLimit
+     * @return
+     */
+    private long time(final @NotNull ByteBuffer dst,
+                      final @NotNull ByteBuffer pw,
+                      final @NotNull ByteBuffer salt,
+                      final          long       opsLimit,
+                      final          long       memLimit) {
+        final long start = System.nanoTime();
+        try {
+            hash(dst, pw, salt, opsLimit, memLimit);
+        } catch (final StodiumException e) {
+            return -1L;
+        }
+        return System.nanoTime() - start;
+    }
 }
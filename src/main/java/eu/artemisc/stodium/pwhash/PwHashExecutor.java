@@ -0,0 +1,452 @@
+/*
+ * Copyright (c) 2017 Project ArteMisc
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+package eu.artemisc.stodium.pwhash;
+
+import org.jetbrains.annotations.NotNull;
+import org.jetbrains.annotations.Nullable;
+
+import java.io.Closeable;
+import java.nio.ByteBuffer;
+import java.nio.charset.Charset;
+import java.util.concurrent.ArrayBlockingQueue;
+import java.util.concurrent.Callable;
+import java.util.concurrent.CancellationException;
+import java.util.concurrent.ExecutionException;
+import java.util.concurrent.Future;
+import java.util.concurrent.FutureTask;
+import java.util.concurrent.RejectedExecutionException;
+import java.util.concurrent.Semaphore;
+import java.util.concurrent.ThreadFactory;
+import java.util.concurrent.ThreadPoolExecutor;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.atomic.AtomicBoolean;
+import java.util.concurrent.atomic.AtomicInteger;
+
+import eu.artemisc.stodium.SecureBuffer;
+import eu.artemisc.stodium.Singleton;
+import eu.artemisc.stodium.Stodium;
+import eu.artemisc.stodium.exceptions.StodiumException;
+
+/**
+ * PwHashExecutor runs {@link PwHash} operations on a bounded pool of threads
+ * of its own, so a burst of password hashes neither blocks the threads that
+ * submit them nor allocates more memory than the process can spare.
+ * <p>
+ * Every operation is admitted against a memory budget: it starts only once its
+ * memLimit fits in the budget next to the operations that are running, and
+ * waits in a bounded queue until then. When the queue is full, operations are
+ * rejected with a {@link RejectedExecutionException}.
+ * <p>
+ * The password, salt and hash string are copied into guarded memory (see
+ * {@link SecureBuffer}) when the operation is submitted, so the caller's
+ * buffers may be reused right away, and heap arrays are never pinned while
+ * the hash runs. The output is written to the caller's buffer once the
+ * operation completes, which must not be touched until then.
+ * <p>
+ * An operation that is cancelled before it started is dropped. The native
+ * call of an operation that has started can not be interrupted; its output
+ * is wiped instead of delivered.
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+public final class PwHashExecutor
+        implements Closeable {
+    /**
+     * Callback receives the outcome of an operation, on the thread that ran
+     * it. It is not called for operations that were cancelled.
+     *
+     * @param <T>
+     */
+    public interface Callback<T> {
+        void onSuccess(final @NotNull T result);
+        void onFailure(final @NotNull Throwable cause);
+    }
+
+    /**
+     * DEFAULT_MEMORY_BUDGET is the memory budget of {@link #shared()}, enough
+     * for a few interactive hashes at once.
+     */
+    public static final long DEFAULT_MEMORY_BUDGET = 256L * 1024L * 1024L;
+
+    /**
+     * DEFAULT_QUEUE_SIZE is the number of operations that may wait for a thread
+     * (or for memory) in {@link #shared()}.
+     */
+    public static final int DEFAULT_QUEUE_SIZE = 256;
+
+    /**
+     * The budget is counted in KiB, so it fits the int permits of a Semaphore.
+     */
+    private static final long KIB = 1024L;
+
+    private static final @NotNull Charset ASCII = Charset.forName("US-ASCII");
+
+    private static final @NotNull AtomicInteger THREAD_IDS = new AtomicInteger();
+
+    private static final @NotNull Singleton<PwHashExecutor> SHARED = new Singleton<PwHashExecutor>() {
+        @NotNull
+        @Override
+        protected PwHashExecutor initialize() {
+            return new PwHashExecutor(Runtime.getRuntime().availableProcessors(),
+                    DEFAULT_QUEUE_SIZE, DEFAULT_MEMORY_BUDGET);
+        }
+    };
+
+    private final @NotNull ThreadPoolExecutor executor;
+    private final @NotNull Semaphore          memory;
+    private final          long               budget;
+
+    /**
+     *
+     * @param threads      the number of operations that may run at once
+     * @param queueSize    the number of operations that may wait for a thread
+     *                     or for memory
+     * @param memoryBudget the total memLimit, in bytes, of the operations that
+     *                     may run at once
+     */
+    public PwHashExecutor(final int  threads,
+                          final int  queueSize,
+                          final long memoryBudget) {
+        if (threads < 1 || queueSize < 1 || memoryBudget < KIB) {
+            throw new IllegalArgumentException("Stodium: invalid PwHashExecutor limits");
+        }
+
+        final int permits = (int) Math.min(Integer.MAX_VALUE, memoryBudget / KIB);
+        this.budget   = permits * KIB;
+        this.memory   = new Semaphore(permits, true);
+        this.executor = new ThreadPoolExecutor(threads, threads,
+                0L, TimeUnit.MILLISECONDS,
+                new ArrayBlockingQueue<Runnable>(queueSize),
+                new ThreadFactory() {
+                    @Override
+                    public Thread newThread(final @NotNull Runnable r) {
+                        final Thread thread = new Thread(r, "stodium-pwhash-" + THREAD_IDS.incrementAndGet());
+                        thread.setDaemon(true);
+                        return thread;
+                    }
+                },
+                new ThreadPoolExecutor.AbortPolicy());
+    }
+
+    /**
+     * shared returns an executor with a thread per core and the default
+     * limits. It must not be closed, as it is shared by the whole process.
+     *
+     * @return the shared executor
+     */
+    @NotNull
+    public static PwHashExecutor shared() {
+        return SHARED.get();
+    }
+
+    /**
+     *
+     * @return the memory budget, in bytes
+     */
+    public long memoryBudget() {
+        return budget;
+    }
+
+    /**
+     * hash derives a key from a password, as {@link PwHash#hash(ByteBuffer,
+     * ByteBuffer, ByteBuffer, long, long)}, and writes it to the remaining
+     * bytes of dstHash once done.
+     *
+     * @param pwhash
+     * @param dstHash
+     * @param srcPw
+     * @param srcSalt
+     * @param opsLimit
+     * @param memLimit
+     * @param callback may be null
+     * @return a Future completing with dstHash
+     * @throws StodiumException if a size or limit is invalid, or the inputs could
+     *                          not be copied to guarded memory
+     * @throws RejectedExecutionException if the queue is full
+     */
+    @NotNull
+    public Future<ByteBuffer> hash(final @NotNull  PwHash               pwhash,
+                                   final @NotNull  ByteBuffer           dstHash,
+                                   final @NotNull  ByteBuffer           srcPw,
+                                   final @NotNull  ByteBuffer           srcSalt,
+                                   final           long                 opsLimit,
+                                   final           long                 memLimit,
+                                   final @Nullable Callback<ByteBuffer> callback)
+            throws StodiumException {
+        Stodium.checkDestinationWritable(dstHash);
+        Stodium.checkSize(dstHash.remaining(), pwhash.BYTES_MIN, pwhash.BYTES_MAX);
+        Stodium.checkSize(srcPw.remaining(), pwhash.PASSWD_MIN, pwhash.PASSWD_MAX);
+        Stodium.checkSize(srcSalt.remaining(), pwhash.SALTBYTES);
+        checkMemLimit(pwhash, memLimit);
+
+        final SecureBuffer out  = SecureBuffer.allocate(dstHash.remaining());
+        final SecureBuffer pw   = copyOf(srcPw);
+        final SecureBuffer salt = copyOf(srcSalt);
+
+        return submit(new Operation<ByteBuffer>(memLimit, callback, out, pw, salt) {
+            @NotNull
+            @Override
+            ByteBuffer compute()
+                    throws StodiumException {
+                pwhash.hash(out.buffer(), pw.buffer(), salt.buffer(), opsLimit, memLimit);
+                if (!isCancelled()) {
+                    dstHash.duplicate().put(out.buffer().duplicate());
+                }
+                return dstHash;
+            }
+        });
+    }
+
+    /**
+     * strHash computes a hash string of a password, as
+     * {@link PwHash#strHash(ByteBuffer, long, long)}.
+     *
+     * @param pwhash
+     * @param srcPw
+     * @param opsLimit
+     * @param memLimit
+     * @param callback may be null
+     * @return a Future completing with the hash string
+     * @throws StodiumException if a size or limit is invalid, or the inputs could
+     *                          not be copied to guarded memory
+     * @throws RejectedExecutionException if the queue is full
+     */
+    @NotNull
+    public Future<String> strHash(final @NotNull  PwHash           pwhash,
+                                  final @NotNull  ByteBuffer       srcPw,
+                                  final           long             opsLimit,
+                                  final           long             memLimit,
+                                  final @Nullable Callback<String> callback)
+            throws StodiumException {
+        Stodium.checkSize(srcPw.remaining(), pwhash.PASSWD_MIN, pwhash.PASSWD_MAX);
+        checkMemLimit(pwhash, memLimit);
+
+        final SecureBuffer out = SecureBuffer.allocate(pwhash.STRBYTES);
+        final SecureBuffer pw  = copyOf(srcPw);
+
+        return submit(new Operation<String>(memLimit, callback, out, pw) {
+            @NotNull
+            @Override
+            String compute()
+                    throws StodiumException {
+                pwhash.strHash(out.buffer(), pw.buffer(), opsLimit, memLimit);
+
+                final ByteBuffer str = out.buffer().duplicate();
+                int length = 0;
+                while (length < str.limit() && str.get(length) != 0) {
+                    length++;
+                }
+                final byte[] chars = new byte[length];
+                str.get(chars);
+                return new String(chars, ASCII);
+            }
+        });
+    }
+
+    /**
+     * strVerify verifies a password against a hash string, as
+     * {@link PwHash#strVerify(String, ByteBuffer)}. The memLimit the string was
+     * computed with is not known before it is parsed by the native code, so
+     * the caller passes the memLimit to count against the budget (e.g. the one
+     * its strings are created with).
+     *
+     * @param pwhash
+     * @param str
+     * @param srcPw
+     * @param memLimit
+     * @param callback may be null
+     * @return a Future completing with the result of the verification
+     * @throws StodiumException if a size or limit is invalid, or the inputs could
+     *                          not be copied to guarded memory
+     * @throws RejectedExecutionException if the queue is full
+     */
+    @NotNull
+    public Future<Boolean> strVerify(final @NotNull  PwHash            pwhash,
+                                     final @NotNull  String            str,
+                                     final @NotNull  ByteBuffer        srcPw,
+                                     final           long              memLimit,
+                                     final @Nullable Callback<Boolean> callback)
+            throws StodiumException {
+        final byte[] chars = str.getBytes(ASCII);
+        Stodium.checkSize(chars.length, 1, pwhash.STRBYTES - 1);
+        Stodium.checkSize(srcPw.remaining(), pwhash.PASSWD_MIN, pwhash.PASSWD_MAX);
+        checkMemLimit(pwhash, memLimit);
+
+        final SecureBuffer hashed = SecureBuffer.allocate(pwhash.STRBYTES);
+        hashed.buffer().put(chars).clear();
+        final SecureBuffer pw = copyOf(srcPw);
+
+        return submit(new Operation<Boolean>(memLimit, callback, hashed, pw) {
+            @NotNull
+            @Override
+            Boolean compute()
+                    throws StodiumException {
+                return pwhash.strVerify(hashed.buffer(), pw.buffer());
+            }
+        });
+    }
+
+    /**
+     * close stops accepting operations. Operations that were already submitted
+     * still run.
+     */
+    @Override
+    public void close() {
+        executor.shutdown();
+    }
+
+    /**
+     *
+     * @param pwhash
+     * @param memLimit
+     * @throws StodiumException
+     */
+    private void checkMemLimit(final @NotNull PwHash pwhash,
+                               final          long   memLimit)
+            throws StodiumException {
+        Stodium.checkSize(memLimit, pwhash.MEMLIMIT_MIN, Math.min(pwhash.MEMLIMIT_MAX, budget));
+    }
+
+    /**
+     *
+     * @param operation
+     * @param <T>
+     * @return
+     */
+    @NotNull
+    private <T> Future<T> submit(final @NotNull Operation<T> operation) {
+        try {
+            executor.execute(operation);
+        } catch (final RejectedExecutionException e) {
+            operation.cancel(false);
+            throw e;
+        }
+        return operation;
+    }
+
+    /**
+     * copyOf copies the remaining bytes of src into a new SecureBuffer, without
+     * moving the position of src.
+     *
+     * @param src
+     * @return
+     * @throws StodiumException
+     */
+    @NotNull
+    private static SecureBuffer copyOf(final @NotNull ByteBuffer src)
+            throws StodiumException {
+        final SecureBuffer copy = SecureBuffer.allocate(Math.max(src.remaining(), 1));
+        copy.buffer().put(src.duplicate()).flip();
+        return copy;
+    }
+
+    /**
+     * Operation is a queued password hash. Its SecureBuffers are closed once
+     * the native call is done, or when the operation is cancelled before it
+     * started, whichever comes first.
+     *
+     * @param <T>
+     */
+    private abstract class Operation<T>
+            extends FutureTask<T> {
+        private final @NotNull  AtomicBoolean  started = new AtomicBoolean();
+        private final           int            permits;
+        private final @Nullable Callback<T>    callback;
+        private final @NotNull  SecureBuffer[] secrets;
+
+        Operation(final           long            memLimit,
+                  final @Nullable Callback<T>     callback,
+                  final @NotNull  SecureBuffer... secrets) {
+            this(new Body<T>(), memLimit, callback, secrets);
+        }
+
+        private Operation(final @NotNull  Body<T>        body,
+                          final           long           memLimit,
+                          final @Nullable Callback<T>    callback,
+                          final @NotNull  SecureBuffer[] secrets) {
+            super(body);
+            body.operation = this;
+            this.permits   = (int) ((memLimit + KIB - 1) / KIB);
+            this.callback  = callback;
+            this.secrets   = secrets;
+        }
+
+        /**
+         * compute runs the native call.
+         *
+         * @return
+         * @throws StodiumException
+         */
+        @NotNull
+        abstract T compute()
+                throws StodiumException;
+
+        /**
+         *
+         * @return
+         * @throws Exception
+         */
+        @Nullable
+        T execute()
+                throws Exception {
+            if (!started.compareAndSet(false, true)) {
+                return null; // cancelled before it started
+            }
+            try {
+                memory.acquire(permits);
+                try {
+                    return compute();
+                } finally {
+                    memory.release(permits);
+                }
+            } finally {
+                wipe();
+            }
+        }
+
+        private void wipe() {
+            for (final SecureBuffer secret : secrets) {
+                secret.close();
+            }
+        }
+
+        @Override
+        protected void done() {
+            if (started.compareAndSet(false, true)) {
+                wipe();
+            }
+            if (callback == null || isCancelled()) {
+                return;
+            }
+            try {
+                callback.onSuccess(get());
+            } catch (final ExecutionException e) {
+                callback.onFailure(e.getCause());
+            } catch (final InterruptedException | CancellationException e) {
+                callback.onFailure(e);
+            }
+        }
+    }
+
+    /**
+     * Body is the Callable of an Operation, which can not pass itself to the
+     * FutureTask constructor.
+     *
+     * @param <T>
+     */
+    private static final class Body<T>
+            implements Callable<T> {
+        private Operation<T> operation;
+
+        @Override
+        public T call()
+                throws Exception {
+            return operation.execute();
+        }
+    }
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2017 Project ArteMisc
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+package eu.artemisc.stodium.pwhash;
+
+import org.jetbrains.annotations.NotNull;
+
+import java.util.Locale;
+
+/**
+ * PwHashParams is a pair of opsLimit and memLimit, as found by
+ * {@link PwHash#calibrate(long, long)}, that can be passed to
+ * {@link PwHash#hash(java.nio.ByteBuffer, java.nio.ByteBuffer, java.nio.ByteBuffer, PwHashParams)}
+ * and {@link PwHash#strHash(java.nio.ByteBuffer, PwHashParams)}.
+ * <p>
+ * Calibrating takes a few seconds, so the result is meant to be stored on the
+ * device (e.g. in the shared preferences) with {@link #encode()}, and read back
+ * with {@link #decode(String)} on the next start.
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+public final class PwHashParams {
+    private final long opsLimit;
+    private final long memLimit;
+    private final long millis;
+
+    /**
+     *
+     * @param opsLimit
+     * @param memLimit
+     * @param millis   the time a hash with these limits took, or 0 if unknown
+     */
+    public PwHashParams(final long opsLimit,
+                        final long memLimit,
+                        final long millis) {
+        this.opsLimit = opsLimit;
+        this.memLimit = memLimit;
+        this.millis   = millis;
+    }
+
+    /**
+     *
+     * @return
+     */
+    public long opsLimit() {
+        return opsLimit;
+    }
+
+    /**
+     *
+     * @return
+     */
+    public long memLimit() {
+        return memLimit;
+    }
+
+    /**
+     *
+     * @return the time a hash with these limits took during calibration, in
+     *         milliseconds
+     */
+    public long millis() {
+        return millis;
+    }
+
+    /**
+     * encode returns the parameters as a short string, "opsLimit:memLimit:millis".
+     *
+     * @return
+     */
+    @NotNull
+    public String encode() {
+        return String.format(Locale.ENGLISH, "%d:%d:%d", opsLimit, memLimit, millis);
+    }
+
+    /**
+     * decode parses a string created by {@link #encode()}.
+     *
+     * @param encoded
+     * @return
+     * @throws IllegalArgumentException if encoded is not a valid encoding
+     */
+    @NotNull
+    public static PwHashParams decode(final @NotNull String encoded) {
+        final String[] parts = encoded.split(":");
+        if (parts.length != 3) {
+            throw new IllegalArgumentException("Stodium: invalid PwHashParams encoding");
+        }
+        try {
+            return new PwHashParams(
+                    Long.parseLong(parts[0]),
+                    Long.parseLong(parts[1]),
+                    Long.parseLong(parts[2]));
+        } catch (final NumberFormatException e) {
+            throw new IllegalArgumentException("Stodium: invalid PwHashParams encoding", e);
+        }
+    }
+
+    @Override
+    public boolean equals(final Object o) {
+        if (!(o instanceof PwHashParams)) {
+            return false;
+        }
+        final PwHashParams other = (PwHashParams) o;
+        return opsLimit == other.opsLimit && memLimit == other.memLimit;
+    }
+
+    @Override
+    public int hashCode() {
+        return (int) (opsLimit * 31 + memLimit);
+    }
+
+    @Override
+    public String toString() {
+        return encode();
+    }
+}
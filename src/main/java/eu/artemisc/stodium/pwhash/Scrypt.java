@@ -4,6 +4,7 @@ import org.jetbrains.annotations.NotNull;
 
 import java.nio.ByteBuffer;
 
+import eu.artemisc.stodium.Constants;
 import eu.artemisc.stodium.Stodium;
 import eu.artemisc.stodium.StodiumJNI;
 import eu.artemisc.stodium.exceptions.StodiumException;
@@ -15,23 +16,23 @@ final class Scrypt
         extends PwHash {
 
     Scrypt() {
-        super(StodiumJNI.crypto_pwhash_scryptsalsa208sha256_bytes_min(),
-                StodiumJNI.crypto_pwhash_scryptsalsa208sha256_bytes_max(),
-                StodiumJNI.crypto_pwhash_scryptsalsa208sha256_passwd_min(),
-                StodiumJNI.crypto_pwhash_scryptsalsa208sha256_passwd_max(),
-                StodiumJNI.crypto_pwhash_scryptsalsa208sha256_saltbytes(),
-                StodiumJNI.crypto_pwhash_scryptsalsa208sha256_strbytes(),
+        super(Constants.PWHASH_SCRYPTSALSA208SHA256_BYTES_MIN,
+                Constants.PWHASH_SCRYPTSALSA208SHA256_BYTES_MAX,
+                Constants.PWHASH_SCRYPTSALSA208SHA256_PASSWD_MIN,
+                Constants.PWHASH_SCRYPTSALSA208SHA256_PASSWD_MAX,
+                Constants.PWHASH_SCRYPTSALSA208SHA256_SALTBYTES,
+                Constants.PWHASH_SCRYPTSALSA208SHA256_STRBYTES,
                 StodiumJNI.crypto_pwhash_scryptsalsa208sha256_strprefix(),
-                StodiumJNI.crypto_pwhash_scryptsalsa208sha256_opslimit_min(),
-                StodiumJNI.crypto_pwhash_scryptsalsa208sha256_opslimit_max(),
-                StodiumJNI.crypto_pwhash_scryptsalsa208sha256_memlimit_min(),
-                StodiumJNI.crypto_pwhash_scryptsalsa208sha256_memlimit_max(),
-                StodiumJNI.crypto_pwhash_scryptsalsa208sha256_opslimit_interactive(),
-                StodiumJNI.crypto_pwhash_scryptsalsa208sha256_memlimit_interactive(),
-                StodiumJNI.crypto_pwhash_scryptsalsa208sha256_opslimit_interactive(),
-                StodiumJNI.crypto_pwhash_scryptsalsa208sha256_memlimit_interactive(),
-                StodiumJNI.crypto_pwhash_scryptsalsa208sha256_opslimit_sensitive(),
-                StodiumJNI.crypto_pwhash_scryptsalsa208sha256_memlimit_sensitive());
+                Constants.PWHASH_SCRYPTSALSA208SHA256_OPSLIMIT_MIN,
+                Constants.PWHASH_SCRYPTSALSA208SHA256_OPSLIMIT_MAX,
+                Constants.PWHASH_SCRYPTSALSA208SHA256_MEMLIMIT_MIN,
+                Constants.PWHASH_SCRYPTSALSA208SHA256_MEMLIMIT_MAX,
+                Constants.PWHASH_SCRYPTSALSA208SHA256_OPSLIMIT_INTERACTIVE,
+                Constants.PWHASH_SCRYPTSALSA208SHA256_MEMLIMIT_INTERACTIVE,
+                Constants.PWHASH_SCRYPTSALSA208SHA256_OPSLIMIT_INTERACTIVE,
+                Constants.PWHASH_SCRYPTSALSA208SHA256_MEMLIMIT_INTERACTIVE,
+                Constants.PWHASH_SCRYPTSALSA208SHA256_OPSLIMIT_SENSITIVE,
+                Constants.PWHASH_SCRYPTSALSA208SHA256_MEMLIMIT_SENSITIVE);
     }
 
     @Override
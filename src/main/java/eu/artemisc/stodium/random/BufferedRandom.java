@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2017 Project ArteMisc
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+package eu.artemisc.stodium.random;
+
+import org.jetbrains.annotations.NotNull;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+
+import eu.artemisc.stodium.Stodium;
+import eu.artemisc.stodium.StodiumJNI;
+import eu.artemisc.stodium.exceptions.ReadOnlyBufferException;
+
+/**
+ * BufferedRandom serves small random values, such as nonces, from a per-thread
+ * buffer of {@link #CHUNK_SIZE} random bytes, so most calls do not cross into
+ * native code. The buffer is refilled with the ChaCha20 keystream of
+ * randombytes_buf_deterministic, under a key taken from randombytes_buf for
+ * every refill.
+ * <p>
+ * Bytes are wiped from the buffer as soon as they are handed out. The buffer
+ * is thrown away when the process has forked since it was filled, so a parent
+ * and child (e.g. Android's zygote and an app) never share random bytes.
+ * Requests larger than CHUNK_SIZE are passed to {@link RandomBytes}.
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+public final class BufferedRandom {
+    /**
+     * CHUNK_SIZE is the number of random bytes buffered by every thread.
+     */
+    public static final int CHUNK_SIZE = 4096;
+
+    private static final @NotNull byte[] ZEROS = new byte[CHUNK_SIZE];
+
+    /**
+     * FORK holds the fork generation maintained by the native code, which
+     * changes in the child process after every fork.
+     */
+    private static final @NotNull ByteBuffer FORK =
+            StodiumJNI.stodium_fork_generation().order(ByteOrder.nativeOrder());
+
+    private static final @NotNull ThreadLocal<BufferedRandom> LOCAL = new ThreadLocal<BufferedRandom>() {
+        @Override
+        protected BufferedRandom initialValue() {
+            return new BufferedRandom();
+        }
+    };
+
+    private final @NotNull ByteBuffer pool;
+    private                int        generation;
+
+    private BufferedRandom() {
+        pool = ByteBuffer.allocateDirect(CHUNK_SIZE);
+        pool.position(CHUNK_SIZE); // empty, filled on first use
+    }
+
+    /**
+     * nextBytes fills the remaining bytes of dst with random bytes, without
+     * moving its position. This is meant for nonces and other short values.
+     *
+     * @param dst
+     * @throws ReadOnlyBufferException
+     */
+    public static void nextBytes(final @NotNull ByteBuffer dst) {
+        Stodium.checkDestinationWritable(dst);
+        if (dst.remaining() > CHUNK_SIZE) {
+            RandomBytes.nextBytes(dst);
+            return;
+        }
+        LOCAL.get().take(dst);
+    }
+
+    /**
+     *
+     * @return a random int
+     */
+    public static int nextInt() {
+        return LOCAL.get().takeInt();
+    }
+
+    /**
+     *
+     * @return a random long
+     */
+    public static long nextLong() {
+        return LOCAL.get().takeLong();
+    }
+
+    /**
+     * uniform returns a uniformly distributed value between 0 and upperBound
+     * (excluded), like randombytes_uniform. upperBound is treated as an
+     * unsigned value.
+     *
+     * @param upperBound
+     * @return a random value in [0, upperBound)
+     */
+    public static int uniform(final int upperBound) {
+        final long upper = upperBound & 0xffffffffL;
+        if (upper < 2) {
+            return 0;
+        }
+
+        // reject the values below 2^32 mod upper, to avoid the modulo bias
+        final BufferedRandom random = LOCAL.get();
+        final long           min    = (0x100000000L - upper) % upper;
+        long r;
+        do {
+            r = random.takeInt() & 0xffffffffL;
+        } while (r < min);
+        return (int) (r % upper);
+    }
+
+    /**
+     * ensure refills the pool if it holds fewer than n bytes, or if the
+     * process forked since it was filled.
+     *
+     * @param n
+     */
+    private void ensure(final int n) {
+        final int current = FORK.getInt(0);
+        if (pool.remaining() >= n && current == generation) {
+            return;
+        }
+
+        pool.clear();
+        if (StodiumJNI.stodium_random_refill(pool) != StodiumJNI.NOERR) {
+            throw new IllegalStateException("Stodium: could not refill the random pool");
+        }
+        generation = current;
+    }
+
+    private void take(final @NotNull ByteBuffer dst) {
+        final int n = dst.remaining();
+        ensure(n);
+
+        final int from = pool.position();
+        final int at   = dst.position();
+        pool.limit(from + n);
+        dst.put(pool);
+        dst.position(at);
+
+        pool.limit(CHUNK_SIZE);
+        pool.position(from);
+        pool.put(ZEROS, 0, n);
+    }
+
+    private int takeInt() {
+        ensure(4);
+        final int from  = pool.position();
+        final int value = pool.getInt();
+        pool.putInt(from, 0);
+        return value;
+    }
+
+    private long takeLong() {
+        ensure(8);
+        final int  from  = pool.position();
+        final long value = pool.getLong();
+        pool.putLong(from, 0L);
+        return value;
+    }
+}
@@ -11,6 +11,7 @@ import org.jetbrains.annotations.NotNull;
 
 import java.nio.ByteBuffer;
 
+import eu.artemisc.stodium.Constants;
 import eu.artemisc.stodium.Stodium;
 import eu.artemisc.stodium.StodiumJNI;
 import eu.artemisc.stodium.exceptions.StodiumException;
@@ -22,8 +23,8 @@ final class Curve25519
         extends ScalarMult {
 
     Curve25519() {
-        super(StodiumJNI.crypto_scalarmult_curve25519_bytes(),
-                StodiumJNI.crypto_scalarmult_curve25519_scalarbytes());
+        super(Constants.SCALARMULT_CURVE25519_BYTES,
+                Constants.SCALARMULT_CURVE25519_SCALARBYTES);
     }
 
     @Override
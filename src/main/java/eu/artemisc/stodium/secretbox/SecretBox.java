@@ -5,6 +5,8 @@ import org.jetbrains.annotations.NotNull;
 import java.nio.ByteBuffer;
 
 import eu.artemisc.stodium.Singleton;
+import eu.artemisc.stodium.Stodium;
+import eu.artemisc.stodium.StodiumJNI;
 import eu.artemisc.stodium.exceptions.StodiumException;
 
 /**
@@ -147,4 +149,92 @@ public abstract class SecretBox {
                                          final @NotNull ByteBuffer nonce,
                                          final @NotNull ByteBuffer key)
             throws StodiumException;
+
+    /**
+     * detached encrypts the concatenation of the remaining bytes of srcPlain,
+     * and scatters the ciphertext over dstCipher, which may be split up
+     * differently but must have room for all of it. The stream and Poly1305
+     * run over the fragments piece by piece, without concatenating them. As
+     * with the other one-shot methods, the positions of the buffers are not
+     * moved. dstCipher may share memory with srcPlain only exactly in place
+     * (see {@link Stodium#checkAlias(ByteBuffer[], ByteBuffer[])}).
+     *
+     * @param dstCipher receives the ciphertext
+     * @param dstMac    receives the macBytes() bytes of the tag
+     * @param srcPlain  the fragments of the message
+     * @param nonce
+     * @param key
+     * @throws StodiumException
+     */
+    public final void detached(final @NotNull ByteBuffer[] dstCipher,
+                               final @NotNull ByteBuffer   dstMac,
+                               final @NotNull ByteBuffer[] srcPlain,
+                               final @NotNull ByteBuffer   nonce,
+                               final @NotNull ByteBuffer   key)
+            throws StodiumException {
+        Stodium.checkDestinationWritable(dstCipher);
+        Stodium.checkDestinationWritable(dstMac);
+
+        Stodium.checkSizeMin(Stodium.remaining(dstCipher), Stodium.remaining(srcPlain));
+        Stodium.checkAlias(dstCipher, srcPlain);
+        Stodium.checkSizeMin(dstMac.remaining(), MACBYTES);
+        Stodium.checkSizeMin(nonce.remaining(), NONCEBYTES);
+        Stodium.checkSize(key.remaining(), KEYBYTES);
+
+        Stodium.checkStatus(detachedGatherNative(
+                Stodium.ensureUsableByteBuffers(dstCipher),
+                Stodium.ensureUsableByteBuffer(dstMac),
+                Stodium.ensureUsableByteBuffers(srcPlain),
+                Stodium.ensureUsableByteBuffer(nonce),
+                Stodium.ensureUsableByteBuffer(key)));
+    }
+
+    /**
+     * detachedOpen verifies the concatenation of the remaining bytes of
+     * srcCipher against srcMac, and only then decrypts it, scattering the
+     * message over dstPlain. Nothing is written to dstPlain if the
+     * verification fails. dstPlain and srcCipher may only overlap exactly in
+     * place; false is returned for other overlaps between direct fragments.
+     *
+     * @param dstPlain  receives the message
+     * @param srcCipher the fragments of the ciphertext
+     * @param srcMac    the tag of the ciphertext
+     * @param nonce
+     * @param key
+     * @return true if the message was decrypted, false if it was forged
+     * @throws StodiumException
+     */
+    public final boolean detachedOpen(final @NotNull ByteBuffer[] dstPlain,
+                                      final @NotNull ByteBuffer[] srcCipher,
+                                      final @NotNull ByteBuffer   srcMac,
+                                      final @NotNull ByteBuffer   nonce,
+                                      final @NotNull ByteBuffer   key)
+            throws StodiumException {
+        Stodium.checkDestinationWritable(dstPlain);
+
+        Stodium.checkSizeMin(Stodium.remaining(dstPlain), Stodium.remaining(srcCipher));
+        Stodium.checkAlias(dstPlain, srcCipher);
+        Stodium.checkSizeMin(srcMac.remaining(), MACBYTES);
+        Stodium.checkSizeMin(nonce.remaining(), NONCEBYTES);
+        Stodium.checkSize(key.remaining(), KEYBYTES);
+
+        return StodiumJNI.NOERR == detachedOpenGatherNative(
+                Stodium.ensureUsableByteBuffers(dstPlain),
+                Stodium.ensureUsableByteBuffers(srcCipher),
+                Stodium.ensureUsableByteBuffer(srcMac),
+                Stodium.ensureUsableByteBuffer(nonce),
+                Stodium.ensureUsableByteBuffer(key));
+    }
+
+    abstract int detachedGatherNative(final @NotNull ByteBuffer[] dstCipher,
+                                      final @NotNull ByteBuffer   dstMac,
+                                      final @NotNull ByteBuffer[] srcPlain,
+                                      final @NotNull ByteBuffer   nonce,
+                                      final @NotNull ByteBuffer   key);
+
+    abstract int detachedOpenGatherNative(final @NotNull ByteBuffer[] dstPlain,
+                                          final @NotNull ByteBuffer[] srcCipher,
+                                          final @NotNull ByteBuffer   srcMac,
+                                          final @NotNull ByteBuffer   nonce,
+                                          final @NotNull ByteBuffer   key);
 }
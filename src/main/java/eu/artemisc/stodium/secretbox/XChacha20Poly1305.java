@@ -4,6 +4,7 @@ import org.jetbrains.annotations.NotNull;
 
 import java.nio.ByteBuffer;
 
+import eu.artemisc.stodium.Constants;
 import eu.artemisc.stodium.Stodium;
 import eu.artemisc.stodium.StodiumJNI;
 import eu.artemisc.stodium.exceptions.StodiumException;
@@ -15,9 +16,9 @@ final class XChacha20Poly1305
         extends SecretBox {
 
     XChacha20Poly1305() {
-        super(StodiumJNI.crypto_secretbox_xchacha20poly1305_keybytes(),
-                StodiumJNI.crypto_secretbox_xchacha20poly1305_macbytes(),
-                StodiumJNI.crypto_secretbox_xchacha20poly1305_noncebytes());
+        super(Constants.SECRETBOX_XCHACHA20POLY1305_KEYBYTES,
+                Constants.SECRETBOX_XCHACHA20POLY1305_MACBYTES,
+                Constants.SECRETBOX_XCHACHA20POLY1305_NONCEBYTES);
     }
 
     @Override
@@ -103,4 +104,24 @@ final class XChacha20Poly1305
                 Stodium.ensureUsableByteBuffer(nonce),
                 Stodium.ensureUsableByteBuffer(key));
     }
+
+    @Override
+    int detachedGatherNative(final @NotNull ByteBuffer[] dstCipher,
+                             final @NotNull ByteBuffer   dstMac,
+                             final @NotNull ByteBuffer[] srcPlain,
+                             final @NotNull ByteBuffer   nonce,
+                             final @NotNull ByteBuffer   key) {
+        return StodiumJNI.crypto_secretbox_xchacha20poly1305_detached_gather(
+                dstCipher, dstMac, srcPlain, nonce, key);
+    }
+
+    @Override
+    int detachedOpenGatherNative(final @NotNull ByteBuffer[] dstPlain,
+                                 final @NotNull ByteBuffer[] srcCipher,
+                                 final @NotNull ByteBuffer   srcMac,
+                                 final @NotNull ByteBuffer   nonce,
+                                 final @NotNull ByteBuffer   key) {
+        return StodiumJNI.crypto_secretbox_xchacha20poly1305_open_detached_gather(
+                dstPlain, srcCipher, srcMac, nonce, key);
+    }
 }
@@ -0,0 +1,380 @@
+/*
+ * Copyright (c) 2017 Project ArteMisc
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+package eu.artemisc.stodium.secretstream;
+
+import org.jetbrains.annotations.NotNull;
+import org.jetbrains.annotations.Nullable;
+
+import java.nio.ByteBuffer;
+
+import eu.artemisc.stodium.Singleton;
+import eu.artemisc.stodium.Stodium;
+import eu.artemisc.stodium.StodiumJNI;
+import eu.artemisc.stodium.exceptions.OperationFailedException;
+import eu.artemisc.stodium.exceptions.StodiumException;
+
+/**
+ * SecretStream encrypts a sequence of messages with a single key, such that
+ * messages can not be reordered, dropped or truncated without being detected.
+ * The state of a stream is held by a {@link Push} (encryption) or a
+ * {@link Pull} (decryption) object.
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+public abstract class SecretStream {
+
+    private static final @NotNull Singleton<SecretStream> XCHACHA20POLY1305 = new Singleton<SecretStream>() {
+        @NotNull
+        @Override
+        protected SecretStream initialize() {
+            return new XChacha20Poly1305();
+        }
+    };
+
+    @NotNull
+    public static SecretStream instance() {
+        return xchacha20poly1305Instance();
+    }
+
+    @NotNull
+    public static SecretStream xchacha20poly1305Instance() {
+        return XCHACHA20POLY1305.get();
+    }
+
+    // constants
+    final int  ABYTES;
+    final int  HEADERBYTES;
+    final int  KEYBYTES;
+    final int  STATEBYTES;
+    final long MESSAGEBYTES_MAX;
+    final int  TAG_MESSAGE;
+    final int  TAG_PUSH;
+    final int  TAG_REKEY;
+    final int  TAG_FINAL;
+
+    /**
+     *
+     * @param abytes
+     * @param headerBytes
+     * @param keyBytes
+     * @param stateBytes
+     * @param messageBytesMax
+     * @param tagMessage
+     * @param tagPush
+     * @param tagRekey
+     * @param tagFinal
+     */
+    SecretStream(final int  abytes,
+                 final int  headerBytes,
+                 final int  keyBytes,
+                 final int  stateBytes,
+                 final long messageBytesMax,
+                 final int  tagMessage,
+                 final int  tagPush,
+                 final int  tagRekey,
+                 final int  tagFinal) {
+        this.ABYTES           = abytes;
+        this.HEADERBYTES      = headerBytes;
+        this.KEYBYTES         = keyBytes;
+        this.STATEBYTES       = stateBytes;
+        this.MESSAGEBYTES_MAX = messageBytesMax;
+        this.TAG_MESSAGE      = tagMessage;
+        this.TAG_PUSH         = tagPush;
+        this.TAG_REKEY        = tagRekey;
+        this.TAG_FINAL        = tagFinal;
+    }
+
+    /**
+     *
+     * @return
+     */
+    public final int abytes() {
+        return ABYTES;
+    }
+
+    /**
+     *
+     * @return
+     */
+    public final int headerBytes() {
+        return HEADERBYTES;
+    }
+
+    /**
+     *
+     * @return
+     */
+    public final int keyBytes() {
+        return KEYBYTES;
+    }
+
+    /**
+     *
+     * @return
+     */
+    public final long messageBytesMax() {
+        return MESSAGEBYTES_MAX;
+    }
+
+    /**
+     * tagMessage returns the tag of a regular message in the stream.
+     *
+     * @return
+     */
+    public final int tagMessage() {
+        return TAG_MESSAGE;
+    }
+
+    /**
+     * tagPush returns the tag that marks the end of a set of messages, without
+     * ending the stream.
+     *
+     * @return
+     */
+    public final int tagPush() {
+        return TAG_PUSH;
+    }
+
+    /**
+     * tagRekey returns the tag that makes both sides of the stream derive a
+     * new key after the message.
+     *
+     * @return
+     */
+    public final int tagRekey() {
+        return TAG_REKEY;
+    }
+
+    /**
+     * tagFinal returns the tag of the last message in the stream.
+     *
+     * @return
+     */
+    public final int tagFinal() {
+        return TAG_FINAL;
+    }
+
+    /**
+     * initPush starts a new stream, and writes the header that the receiving
+     * side needs to {@link #initPull(ByteBuffer, ByteBuffer)} to dstHeader.
+     *
+     * @param dstHeader
+     * @param key
+     * @return the state of the new stream
+     * @throws StodiumException
+     */
+    @NotNull
+    public final Push initPush(final @NotNull ByteBuffer dstHeader,
+                               final @NotNull ByteBuffer key)
+            throws StodiumException {
+        Stodium.checkDestinationWritable(dstHeader);
+
+        Stodium.checkSizeMin(dstHeader.remaining(), HEADERBYTES);
+        Stodium.checkSize(key.remaining(), KEYBYTES);
+
+        final ByteBuffer state = ByteBuffer.allocateDirect(STATEBYTES);
+        Stodium.checkStatus(initPushNative(
+                state,
+                Stodium.ensureUsableByteBuffer(dstHeader),
+                Stodium.ensureUsableByteBuffer(key)));
+        return new Push(this, state);
+    }
+
+    /**
+     * initPull starts decrypting the stream that was started with the given
+     * header.
+     *
+     * @param header
+     * @param key
+     * @return the state of the stream
+     * @throws StodiumException
+     */
+    @NotNull
+    public final Pull initPull(final @NotNull ByteBuffer header,
+                               final @NotNull ByteBuffer key)
+            throws StodiumException {
+        Stodium.checkSizeMin(header.remaining(), HEADERBYTES);
+        Stodium.checkSize(key.remaining(), KEYBYTES);
+
+        final ByteBuffer state = ByteBuffer.allocateDirect(STATEBYTES);
+        Stodium.checkStatus(initPullNative(
+                state,
+                Stodium.ensureUsableByteBuffer(header),
+                Stodium.ensureUsableByteBuffer(key)));
+        return new Pull(this, state);
+    }
+
+    abstract int initPushNative(final @NotNull ByteBuffer state,
+                                final @NotNull ByteBuffer header,
+                                final @NotNull ByteBuffer key);
+
+    abstract int pushNative(final @NotNull  ByteBuffer state,
+                            final @NotNull  ByteBuffer dstCipher,
+                            final @NotNull  ByteBuffer srcPlain,
+                            final @Nullable ByteBuffer ad,
+                            final           int        tag);
+
+    abstract int initPullNative(final @NotNull ByteBuffer state,
+                                final @NotNull ByteBuffer header,
+                                final @NotNull ByteBuffer key);
+
+    abstract int pullNative(final @NotNull  ByteBuffer state,
+                            final @NotNull  ByteBuffer dstPlain,
+                            final @NotNull  ByteBuffer srcCipher,
+                            final @Nullable ByteBuffer ad);
+
+    abstract void rekeyNative(final @NotNull ByteBuffer state);
+
+    /**
+     * Push holds the state of a stream that is being encrypted. A Push is not
+     * safe for use by multiple threads at once.
+     */
+    public static final class Push {
+        private final @NotNull SecretStream spec;
+        private final @NotNull ByteBuffer   state;
+
+        Push(final @NotNull SecretStream spec,
+             final @NotNull ByteBuffer   state) {
+            this.spec  = spec;
+            this.state = state;
+        }
+
+        /**
+         *
+         * @param dstCipher
+         * @param srcPlain
+         * @param tag
+         * @throws StodiumException
+         */
+        public void push(final @NotNull ByteBuffer dstCipher,
+                         final @NotNull ByteBuffer srcPlain,
+                         final          int        tag)
+                throws StodiumException {
+            push(dstCipher, srcPlain, null, tag);
+        }
+
+        /**
+         * push encrypts the next message of the stream to dstCipher, which
+         * receives {@code srcPlain.remaining() + abytes()} bytes.
+         *
+         * @param dstCipher
+         * @param srcPlain
+         * @param ad
+         * @param tag
+         * @throws StodiumException
+         */
+        public void push(final @NotNull  ByteBuffer dstCipher,
+                         final @NotNull  ByteBuffer srcPlain,
+                         final @Nullable ByteBuffer ad,
+                         final           int        tag)
+                throws StodiumException {
+            Stodium.checkDestinationWritable(dstCipher);
+
+            Stodium.checkSizeMin(dstCipher.remaining(), (long) srcPlain.remaining() + spec.ABYTES);
+            Stodium.checkSize(srcPlain.remaining(), 0L, spec.MESSAGEBYTES_MAX);
+
+            Stodium.checkStatus(spec.pushNative(
+                    state,
+                    Stodium.ensureUsableByteBuffer(dstCipher),
+                    Stodium.ensureUsableByteBuffer(srcPlain),
+                    ad == null ? null : Stodium.ensureUsableByteBuffer(ad),
+                    tag));
+        }
+
+        /**
+         * rekey derives a new key for the following messages. The receiving
+         * side has to call {@link Pull#rekey()} at the same point.
+         */
+        public void rekey() {
+            spec.rekeyNative(state);
+        }
+
+        /**
+         * wipe clears the state of the stream.
+         */
+        public void wipe() {
+            Stodium.wipeBytes(state.duplicate());
+        }
+    }
+
+    /**
+     * Pull holds the state of a stream that is being decrypted. A Pull is not
+     * safe for use by multiple threads at once.
+     */
+    public static final class Pull {
+        private final @NotNull SecretStream spec;
+        private final @NotNull ByteBuffer   state;
+
+        Pull(final @NotNull SecretStream spec,
+             final @NotNull ByteBuffer   state) {
+            this.spec  = spec;
+            this.state = state;
+        }
+
+        /**
+         *
+         * @param dstPlain
+         * @param srcCipher
+         * @return the tag of the message
+         * @throws StodiumException
+         */
+        public int pull(final @NotNull ByteBuffer dstPlain,
+                        final @NotNull ByteBuffer srcCipher)
+                throws StodiumException {
+            return pull(dstPlain, srcCipher, null);
+        }
+
+        /**
+         * pull decrypts and verifies the next message of the stream to
+         * dstPlain, which receives {@code srcCipher.remaining() - abytes()}
+         * bytes.
+         *
+         * @param dstPlain
+         * @param srcCipher
+         * @param ad
+         * @return the tag of the message
+         * @throws OperationFailedException if the message could not be
+         *         verified
+         * @throws StodiumException
+         */
+        public int pull(final @NotNull  ByteBuffer dstPlain,
+                        final @NotNull  ByteBuffer srcCipher,
+                        final @Nullable ByteBuffer ad)
+                throws StodiumException {
+            Stodium.checkDestinationWritable(dstPlain);
+
+            Stodium.checkSizeMin(srcCipher.remaining(), spec.ABYTES);
+            Stodium.checkSizeMin(dstPlain.remaining(), srcCipher.remaining() - spec.ABYTES);
+
+            final int tag = spec.pullNative(
+                    state,
+                    Stodium.ensureUsableByteBuffer(dstPlain),
+                    Stodium.ensureUsableByteBuffer(srcCipher),
+                    ad == null ? null : Stodium.ensureUsableByteBuffer(ad));
+            if (tag < 0) {
+                throw new OperationFailedException("Stodium: secretstream message could not be verified");
+            }
+            return tag;
+        }
+
+        /**
+         * rekey derives a new key for the following messages, at the same
+         * point where the sending side called {@link Push#rekey()}.
+         */
+        public void rekey() {
+            spec.rekeyNative(state);
+        }
+
+        /**
+         * wipe clears the state of the stream.
+         */
+        public void wipe() {
+            Stodium.wipeBytes(state.duplicate());
+        }
+    }
+}
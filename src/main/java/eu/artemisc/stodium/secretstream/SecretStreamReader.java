@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2017 Project ArteMisc
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+package eu.artemisc.stodium.secretstream;
+
+import org.jetbrains.annotations.NotNull;
+
+import java.io.EOFException;
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.nio.channels.ClosedChannelException;
+import java.nio.channels.ReadableByteChannel;
+
+import eu.artemisc.stodium.Stodium;
+import eu.artemisc.stodium.exceptions.StodiumException;
+
+/**
+ * SecretStreamReader is a ReadableByteChannel that decrypts a stream written
+ * by {@link SecretStreamWriter} from another channel. Every chunk is verified
+ * before any of its bytes are returned, and a stream that ends without the
+ * final tag results in an EOFException instead of a silent end of stream.
+ * <p>
+ * The chunkSize has to be at least the chunk size used by the writer. Chunks
+ * are decrypted straight into direct buffers with room for a whole chunk.
+ * <p>
+ * The source channel should be in blocking mode. A SecretStreamReader is not
+ * safe for use by multiple threads at once.
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+public final class SecretStreamReader
+        implements ReadableByteChannel {
+
+    private final @NotNull SecretStream        stream;
+    private final @NotNull SecretStream.Pull   pull;
+    private final @NotNull ReadableByteChannel source;
+    private final @NotNull ByteBuffer          length;
+    private final @NotNull ByteBuffer          plain;
+    private final @NotNull ByteBuffer          cipher;
+
+    private boolean open     = true;
+    private boolean finished = false;
+
+    /**
+     *
+     * @param stream
+     * @param source
+     * @param key
+     * @throws IOException
+     * @throws StodiumException
+     */
+    public SecretStreamReader(final @NotNull SecretStream        stream,
+                              final @NotNull ReadableByteChannel source,
+                              final @NotNull ByteBuffer          key)
+            throws IOException, StodiumException {
+        this(stream, source, key, SecretStreamWriter.DEFAULT_CHUNK_SIZE);
+    }
+
+    /**
+     * Reads the header of the stream from the source channel.
+     *
+     * @param stream
+     * @param source
+     * @param key
+     * @param chunkSize
+     * @throws IOException
+     * @throws StodiumException
+     */
+    public SecretStreamReader(final @NotNull SecretStream        stream,
+                              final @NotNull ReadableByteChannel source,
+                              final @NotNull ByteBuffer          key,
+                              final          int                 chunkSize)
+            throws IOException, StodiumException {
+        Stodium.checkSize(chunkSize, 1, Integer.MAX_VALUE - stream.ABYTES);
+
+        this.stream = stream;
+        this.source = source;
+        this.length = ByteBuffer.allocateDirect(4);
+        this.plain  = ByteBuffer.allocateDirect(chunkSize);
+        this.cipher = ByteBuffer.allocateDirect(chunkSize + stream.ABYTES);
+        this.plain.limit(0);
+
+        final ByteBuffer header = ByteBuffer.allocateDirect(stream.HEADERBYTES);
+        if (!readFully(header)) {
+            throw new EOFException("Stodium: secretstream header is missing");
+        }
+        header.flip();
+        this.pull = stream.initPull(header, key);
+    }
+
+    @Override
+    public int read(final @NotNull ByteBuffer dst)
+            throws IOException {
+        if (!open) {
+            throw new ClosedChannelException();
+        }
+
+        while (!plain.hasRemaining()) {
+            if (finished) {
+                return -1;
+            }
+
+            // Whole chunks fit in direct destinations without a copy
+            if (dst.isDirect() && dst.remaining() >= plain.capacity()) {
+                final int read = readChunk(dst);
+                dst.position(dst.position() + read);
+                if (read > 0) {
+                    return read;
+                }
+                continue;
+            }
+
+            plain.clear();
+            plain.limit(readChunk(plain));
+        }
+
+        final int read  = Math.min(plain.remaining(), dst.remaining());
+        final int limit = plain.limit();
+        plain.limit(plain.position() + read);
+        dst.put(plain);
+        plain.limit(limit);
+        return read;
+    }
+
+    @Override
+    public boolean isOpen() {
+        return open;
+    }
+
+    @Override
+    public void close()
+            throws IOException {
+        if (!open) {
+            return;
+        }
+        open = false;
+
+        try {
+            plain.clear();
+            Stodium.wipeBytes(plain);
+            pull.wipe();
+        } finally {
+            source.close();
+        }
+    }
+
+    /**
+     * readChunk reads and decrypts the next chunk of the stream to out, and
+     * returns the length of its plaintext.
+     */
+    private int readChunk(final @NotNull ByteBuffer out)
+            throws IOException {
+        length.clear();
+        if (!readFully(length)) {
+            throw new EOFException("Stodium: secretstream ended before the final chunk");
+        }
+
+        final int chunk = length.getInt(0);
+        if (chunk < stream.ABYTES || chunk > cipher.capacity()) {
+            throw new IOException("Stodium: invalid secretstream chunk length " + chunk);
+        }
+
+        cipher.clear();
+        cipher.limit(chunk);
+        if (!readFully(cipher)) {
+            throw new EOFException("Stodium: secretstream ended before the final chunk");
+        }
+        cipher.flip();
+
+        final int tag;
+        try {
+            tag = pull.pull(out, cipher);
+        } catch (StodiumException e) {
+            throw new IOException("Stodium: could not decrypt chunk", e);
+        }
+        if (tag == stream.TAG_FINAL) {
+            finished = true;
+        }
+        return chunk - stream.ABYTES;
+    }
+
+    /**
+     * readFully fills dst from the source channel, and returns false if the
+     * source ended first.
+     */
+    private boolean readFully(final @NotNull ByteBuffer dst)
+            throws IOException {
+        while (dst.hasRemaining()) {
+            if (source.read(dst) < 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2017 Project ArteMisc
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+package eu.artemisc.stodium.secretstream;
+
+import org.jetbrains.annotations.NotNull;
+
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.nio.channels.ClosedChannelException;
+import java.nio.channels.WritableByteChannel;
+
+import eu.artemisc.stodium.Stodium;
+import eu.artemisc.stodium.exceptions.StodiumException;
+
+/**
+ * SecretStreamWriter is a WritableByteChannel that encrypts everything written
+ * to it with a {@link SecretStream}, and writes the result to another channel.
+ * Plaintext is encrypted in chunks of at most chunkSize bytes, so the memory
+ * used does not depend on the length of the stream.
+ * <p>
+ * The output starts with the stream header, followed by every chunk as a
+ * 4-byte big-endian length and the encrypted chunk. Closing the writer
+ * encrypts the last chunk with the final tag, which allows
+ * {@link SecretStreamReader} to detect truncated streams. Direct buffers of at
+ * least chunkSize bytes are encrypted without being copied first.
+ * <p>
+ * The target channel should be in blocking mode. A SecretStreamWriter is not
+ * safe for use by multiple threads at once.
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+public final class SecretStreamWriter
+        implements WritableByteChannel {
+
+    /**
+     * DEFAULT_CHUNK_SIZE is the chunk size used by the constructor without a
+     * chunkSize argument.
+     */
+    public static final int DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+    private final @NotNull SecretStream        stream;
+    private final @NotNull SecretStream.Push   push;
+    private final @NotNull WritableByteChannel target;
+    private final @NotNull ByteBuffer          plain;
+    private final @NotNull ByteBuffer          cipher;
+
+    private boolean open = true;
+
+    /**
+     *
+     * @param stream
+     * @param target
+     * @param key
+     * @throws IOException
+     * @throws StodiumException
+     */
+    public SecretStreamWriter(final @NotNull SecretStream        stream,
+                              final @NotNull WritableByteChannel target,
+                              final @NotNull ByteBuffer          key)
+            throws IOException, StodiumException {
+        this(stream, target, key, DEFAULT_CHUNK_SIZE);
+    }
+
+    /**
+     * Starts a new stream with the given key, and writes its header to the
+     * target channel.
+     *
+     * @param stream
+     * @param target
+     * @param key
+     * @param chunkSize
+     * @throws IOException
+     * @throws StodiumException
+     */
+    public SecretStreamWriter(final @NotNull SecretStream        stream,
+                              final @NotNull WritableByteChannel target,
+                              final @NotNull ByteBuffer          key,
+                              final          int                 chunkSize)
+            throws IOException, StodiumException {
+        Stodium.checkSize(chunkSize, 1, Integer.MAX_VALUE - 4 - stream.ABYTES);
+
+        this.stream = stream;
+        this.target = target;
+        this.plain  = ByteBuffer.allocateDirect(chunkSize);
+        this.cipher = ByteBuffer.allocateDirect(4 + chunkSize + stream.ABYTES);
+
+        final ByteBuffer header = ByteBuffer.allocateDirect(stream.HEADERBYTES);
+        this.push = stream.initPush(header, key);
+        writeFully(header);
+    }
+
+    @Override
+    public int write(final @NotNull ByteBuffer src)
+            throws IOException {
+        if (!open) {
+            throw new ClosedChannelException();
+        }
+
+        final int length = src.remaining();
+        final int limit  = src.limit();
+        while (src.hasRemaining()) {
+            // Full chunks of direct buffers are encrypted in place
+            if (plain.position() == 0 && src.isDirect() && src.remaining() >= plain.capacity()) {
+                src.limit(src.position() + plain.capacity());
+                writeChunk(src, stream.TAG_MESSAGE);
+                src.position(src.limit());
+                src.limit(limit);
+                continue;
+            }
+
+            src.limit(src.position() + Math.min(src.remaining(), plain.remaining()));
+            plain.put(src);
+            src.limit(limit);
+
+            if (!plain.hasRemaining()) {
+                plain.flip();
+                writeChunk(plain, stream.TAG_MESSAGE);
+                plain.clear();
+            }
+        }
+        return length;
+    }
+
+    @Override
+    public boolean isOpen() {
+        return open;
+    }
+
+    /**
+     * close encrypts the buffered plaintext as the final message of the
+     * stream, and closes the target channel.
+     *
+     * @throws IOException
+     */
+    @Override
+    public void close()
+            throws IOException {
+        if (!open) {
+            return;
+        }
+        open = false;
+
+        try {
+            plain.flip();
+            writeChunk(plain, stream.TAG_FINAL);
+        } finally {
+            plain.clear();
+            Stodium.wipeBytes(plain);
+            push.wipe();
+            target.close();
+        }
+    }
+
+    /**
+     * writeChunk encrypts the remaining bytes of in as a single message, and
+     * writes it to the target channel.
+     */
+    private void writeChunk(final @NotNull ByteBuffer in,
+                            final          int        tag)
+            throws IOException {
+        final int length = in.remaining() + stream.ABYTES;
+
+        cipher.clear();
+        cipher.putInt(length);
+        cipher.limit(4 + length);
+        try {
+            push.push(cipher, in, tag);
+        } catch (StodiumException e) {
+            throw new IOException("Stodium: could not encrypt chunk", e);
+        }
+
+        cipher.position(0);
+        writeFully(cipher);
+    }
+
+    private void writeFully(final @NotNull ByteBuffer src)
+            throws IOException {
+        while (src.hasRemaining()) {
+            target.write(src);
+        }
+    }
+}
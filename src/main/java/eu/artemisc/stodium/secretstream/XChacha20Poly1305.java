@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2017 Project ArteMisc
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+package eu.artemisc.stodium.secretstream;
+
+import org.jetbrains.annotations.NotNull;
+import org.jetbrains.annotations.Nullable;
+
+import java.nio.ByteBuffer;
+
+import eu.artemisc.stodium.Constants;
+import eu.artemisc.stodium.StodiumJNI;
+
+/**
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+final class XChacha20Poly1305
+        extends SecretStream {
+
+    XChacha20Poly1305() {
+        super(Constants.SECRETSTREAM_XCHACHA20POLY1305_ABYTES,
+                Constants.SECRETSTREAM_XCHACHA20POLY1305_HEADERBYTES,
+                Constants.SECRETSTREAM_XCHACHA20POLY1305_KEYBYTES,
+                Constants.SECRETSTREAM_XCHACHA20POLY1305_STATEBYTES,
+                Constants.SECRETSTREAM_XCHACHA20POLY1305_MESSAGEBYTES_MAX,
+                Constants.SECRETSTREAM_XCHACHA20POLY1305_TAG_MESSAGE,
+                Constants.SECRETSTREAM_XCHACHA20POLY1305_TAG_PUSH,
+                Constants.SECRETSTREAM_XCHACHA20POLY1305_TAG_REKEY,
+                Constants.SECRETSTREAM_XCHACHA20POLY1305_TAG_FINAL);
+    }
+
+    @Override
+    int initPushNative(final @NotNull ByteBuffer state,
+                       final @NotNull ByteBuffer header,
+                       final @NotNull ByteBuffer key) {
+        return StodiumJNI.crypto_secretstream_xchacha20poly1305_init_push(state, header, key);
+    }
+
+    @Override
+    int pushNative(final @NotNull  ByteBuffer state,
+                   final @NotNull  ByteBuffer dstCipher,
+                   final @NotNull  ByteBuffer srcPlain,
+                   final @Nullable ByteBuffer ad,
+                   final           int        tag) {
+        return StodiumJNI.crypto_secretstream_xchacha20poly1305_push(state, dstCipher, srcPlain, ad, tag);
+    }
+
+    @Override
+    int initPullNative(final @NotNull ByteBuffer state,
+                       final @NotNull ByteBuffer header,
+                       final @NotNull ByteBuffer key) {
+        return StodiumJNI.crypto_secretstream_xchacha20poly1305_init_pull(state, header, key);
+    }
+
+    @Override
+    int pullNative(final @NotNull  ByteBuffer state,
+                   final @NotNull  ByteBuffer dstPlain,
+                   final @NotNull  ByteBuffer srcCipher,
+                   final @Nullable ByteBuffer ad) {
+        return StodiumJNI.crypto_secretstream_xchacha20poly1305_pull(state, dstPlain, srcCipher, ad);
+    }
+
+    @Override
+    void rekeyNative(final @NotNull ByteBuffer state) {
+        StodiumJNI.crypto_secretstream_xchacha20poly1305_rekey(state);
+    }
+}
@@ -10,8 +10,12 @@ package eu.artemisc.stodium.shorthash;
 import org.jetbrains.annotations.NotNull;
 
 import java.nio.ByteBuffer;
+import java.nio.LongBuffer;
 
 import eu.artemisc.stodium.Singleton;
+import eu.artemisc.stodium.Stodium;
+import eu.artemisc.stodium.exceptions.ConstraintViolationException;
+import eu.artemisc.stodium.exceptions.ReadOnlyBufferException;
 import eu.artemisc.stodium.exceptions.StodiumException;
 
 /**
@@ -92,4 +96,89 @@ public abstract class ShortHash {
                               final @NotNull ByteBuffer in,
                               final @NotNull ByteBuffer key)
             throws StodiumException;
+
+    /**
+     * hashBatch hashes a batch of messages with the same key in a single call
+     * to the native code, e.g. all keys of a hash table that is rebuilt. The
+     * native code hashes several messages at once in the lanes of the vector
+     * unit (AVX2, SSE2 or NEON) where available, and spreads large batches
+     * over the native worker pool if one was started with
+     * {@link eu.artemisc.stodium.Stodium#startWorkerPool(int)}.
+     * <p>
+     * The table holds an (offset, length) pair for every message in src, with
+     * the offsets relative to {@code src.position()}. Every hash is written to
+     * dst as {@code bytes() / 8} longs, starting at dstOffset and in the order
+     * of the table; a long holds 8 bytes of the output of
+     * {@link #hash(ByteBuffer, ByteBuffer, ByteBuffer)}, read little-endian.
+     *
+     * @param dst       receives the hashes
+     * @param dstOffset the index in dst of the first hash
+     * @param src       holds the messages
+     * @param table     the (offset, length) pair of every message
+     * @param key       the key shared by every message
+     * @throws StodiumException
+     */
+    public abstract void hashBatch(final @NotNull long[]     dst,
+                                   final          int        dstOffset,
+                                   final @NotNull ByteBuffer src,
+                                   final @NotNull int[]      table,
+                                   final @NotNull ByteBuffer key)
+            throws StodiumException;
+
+    /**
+     * hashBatch is {@link #hashBatch(long[], int, ByteBuffer, int[], ByteBuffer)}
+     * for a LongBuffer, with the hashes written from {@code dst.position()}.
+     * The position of dst is not changed.
+     *
+     * @param dst   receives the hashes
+     * @param src   holds the messages
+     * @param table the (offset, length) pair of every message
+     * @param key   the key shared by every message
+     * @throws StodiumException
+     */
+    public final void hashBatch(final @NotNull LongBuffer dst,
+                                final @NotNull ByteBuffer src,
+                                final @NotNull int[]      table,
+                                final @NotNull ByteBuffer key)
+            throws StodiumException {
+        if (dst.isReadOnly()) {
+            throw new ReadOnlyBufferException("Stodium: output buffer is readonly");
+        }
+        Stodium.checkSizeMin(dst.remaining(), (long) (table.length / 2) * (BYTES / 8));
+
+        if (dst.hasArray()) {
+            hashBatch(dst.array(), dst.arrayOffset() + dst.position(), src, table, key);
+            return;
+        }
+
+        final long[] hashes = new long[(table.length / 2) * (BYTES / 8)];
+        hashBatch(hashes, 0, src, table, key);
+        dst.duplicate().put(hashes);
+    }
+
+    /**
+     * checkBatch checks the arguments of a hashBatch call.
+     *
+     * @param dst
+     * @param dstOffset
+     * @param src
+     * @param table
+     * @param key
+     * @throws StodiumException
+     */
+    final void checkBatch(final @NotNull long[]     dst,
+                          final          int        dstOffset,
+                          final @NotNull ByteBuffer src,
+                          final @NotNull int[]      table,
+                          final @NotNull ByteBuffer key)
+            throws StodiumException {
+        if ((table.length & 1) != 0) {
+            throw new ConstraintViolationException("Stodium: batch table should hold (offset, length) pairs");
+        }
+        Stodium.checkSize(key.remaining(), KEYBYTES);
+        Stodium.checkOffsetParams(dst.length, dstOffset, (table.length / 2) * (BYTES / 8));
+        for (int i = 0; i < table.length; i += 2) {
+            Stodium.checkOffsetParams(src.remaining(), table[i], table[i + 1]);
+        }
+    }
 }
@@ -4,6 +4,7 @@ import org.jetbrains.annotations.NotNull;
 
 import java.nio.ByteBuffer;
 
+import eu.artemisc.stodium.Constants;
 import eu.artemisc.stodium.Stodium;
 import eu.artemisc.stodium.StodiumJNI;
 import eu.artemisc.stodium.exceptions.StodiumException;
@@ -15,8 +16,8 @@ final class SipHash24
         extends ShortHash {
 
     SipHash24() {
-        super(StodiumJNI.crypto_shorthash_siphash24_bytes(),
-                StodiumJNI.crypto_shorthash_siphash24_keybytes());
+        super(Constants.SHORTHASH_SIPHASH24_BYTES,
+                Constants.SHORTHASH_SIPHASH24_KEYBYTES);
     }
 
     @Override
@@ -34,4 +35,21 @@ final class SipHash24
                 Stodium.ensureUsableByteBuffer(in),
                 Stodium.ensureUsableByteBuffer(key)));
     }
+
+    @Override
+    public void hashBatch(final @NotNull long[]     dst,
+                          final          int        dstOffset,
+                          final @NotNull ByteBuffer src,
+                          final @NotNull int[]      table,
+                          final @NotNull ByteBuffer key)
+            throws StodiumException {
+        checkBatch(dst, dstOffset, src, table, key);
+
+        Stodium.checkStatus(StodiumJNI.crypto_shorthash_siphash24_batch(
+                dst,
+                dstOffset,
+                Stodium.ensureUsableByteBuffer(src),
+                table,
+                Stodium.ensureUsableByteBuffer(key)));
+    }
 }
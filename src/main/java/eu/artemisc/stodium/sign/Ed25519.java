@@ -4,8 +4,12 @@ import org.jetbrains.annotations.NotNull;
 
 import java.nio.ByteBuffer;
 
+import eu.artemisc.stodium.Constants;
+import eu.artemisc.stodium.NativeState;
+import eu.artemisc.stodium.StatePool;
 import eu.artemisc.stodium.Stodium;
 import eu.artemisc.stodium.StodiumJNI;
+import eu.artemisc.stodium.exceptions.ConstraintViolationException;
 import eu.artemisc.stodium.exceptions.StodiumException;
 
 /**
@@ -16,11 +20,11 @@ final class Ed25519
         implements MultipartSign.Spec {
 
     Ed25519() {
-        super(StodiumJNI.crypto_sign_ed25519_publickeybytes(),
-                StodiumJNI.crypto_sign_ed25519_secretkeybytes(),
-                StodiumJNI.crypto_sign_ed25519_bytes(),
-                StodiumJNI.crypto_sign_ed25519_seedbytes(),
-                StodiumJNI.crypto_sign_ed25519ph_statebytes());
+        super(Constants.SIGN_ED25519_PUBLICKEYBYTES,
+                Constants.SIGN_ED25519_SECRETKEYBYTES,
+                Constants.SIGN_ED25519_BYTES,
+                Constants.SIGN_ED25519_SEEDBYTES,
+                Constants.SIGN_ED25519PH_STATEBYTES);
     }
 
     @Override
@@ -76,12 +80,12 @@ final class Ed25519
     @Override
     public boolean open(final @NotNull ByteBuffer dstMsg,
                         final @NotNull ByteBuffer srcSigned,
-                        final @NotNull ByteBuffer priv)
+                        final @NotNull ByteBuffer pub)
             throws StodiumException {
         Stodium.checkDestinationWritable(dstMsg);
 
         Stodium.checkSizeMin(srcSigned.remaining(), dstMsg.remaining() + BYTES);
-        Stodium.checkSize(priv.remaining(), SECRETKEYBYTES);
+        Stodium.checkSize(pub.remaining(), PUBLICKEYBYTES);
 
         return StodiumJNI.NOERR == StodiumJNI.crypto_sign_ed25519_open(
                 Stodium.ensureUsableByteBuffer(dstMsg),
@@ -102,16 +106,16 @@ final class Ed25519
         Stodium.checkStatus(StodiumJNI.crypto_sign_ed25519_detached(
                 Stodium.ensureUsableByteBuffer(dstSig),
                 Stodium.ensureUsableByteBuffer(srcMsg),
-                Stodium.ensureUsableByteBuffer(priv)));
+                Stodium.ensureUsableByteBuffer(pub)));
     }
 
     @Override
     public boolean verifyDetached(final @NotNull ByteBuffer srcSig,
                                   final @NotNull ByteBuffer srcMsg,
-                                  final @NotNull ByteBuffer priv)
+                                  final @NotNull ByteBuffer pub)
             throws StodiumException {
         Stodium.checkSizeMin(srcSig.remaining(), BYTES);
-        Stodium.checkSize(priv.remaining(), SECRETKEYBYTES);
+        Stodium.checkSize(pub.remaining(), PUBLICKEYBYTES);
 
         return StodiumJNI.NOERR == StodiumJNI.crypto_sign_ed25519_verify_detached(
                 Stodium.ensureUsableByteBuffer(srcSig),
@@ -119,18 +123,62 @@ final class Ed25519
                 Stodium.ensureUsableByteBuffer(priv));
     }
 
+    @Override
+    public int verifyDetachedBatch(final @NotNull ByteBuffer srcSigs,
+                                   final @NotNull ByteBuffer srcMsgs,
+                                   final @NotNull int[]      table,
+                                   final @NotNull ByteBuffer pubs,
+                                   final @NotNull int[]      keys,
+                                   final @NotNull byte[]     results)
+            throws StodiumException {
+        if ((table.length & 1) != 0) {
+            throw new ConstraintViolationException("Stodium: batch table should hold (offset, length) pairs");
+        }
+        final int count = table.length / 2;
+        final int pubCount = pubs.remaining() / PUBLICKEYBYTES;
+
+        Stodium.checkSize(keys.length, count);
+        Stodium.checkSizeMin(results.length, (count + 7) / 8);
+        Stodium.checkSizeMin(srcSigs.remaining(), (long) count * BYTES);
+        for (int i = 0; i < count; i++) {
+            Stodium.checkOffsetParams(srcMsgs.remaining(), table[2 * i], table[2 * i + 1]);
+            if (keys[i] < 0 || keys[i] >= pubCount) {
+                throw new ConstraintViolationException("Stodium: batch key index out of range");
+            }
+        }
+
+        final int failed = StodiumJNI.crypto_sign_ed25519_verify_detached_batch(
+                Stodium.ensureUsableByteBuffer(srcSigs),
+                Stodium.ensureUsableByteBuffer(srcMsgs),
+                table,
+                Stodium.ensureUsableByteBuffer(pubs),
+                keys,
+                results);
+        if (failed < 0) {
+            Stodium.checkStatus(failed);
+        }
+        return failed;
+    }
+
     @NotNull
     @Override
     public MultipartSign init()
             throws StodiumException {
         final ByteBuffer state;
 
-        state = ByteBuffer.allocateDirect(STATEBYTES);
+        state = StatePool.acquire(STATEBYTES);
         Stodium.checkStatus(StodiumJNI.crypto_sign_ed25519ph_init(state));
 
         return new MultipartSign(this, state);
     }
 
+    @NotNull
+    @Override
+    public NativeMultipartSign initNative()
+            throws StodiumException {
+        return new NativeMultipartSign(NativeState.wrap(StodiumJNI.stodium_state_ed25519ph_init()));
+    }
+
     @Override
     public void update(final @NotNull ByteBuffer state,
                        final @NotNull ByteBuffer in)
@@ -159,7 +207,7 @@ final class Ed25519
         Stodium.checkStatus(StodiumJNI.crypto_sign_ed25519ph_final_create(
                 Stodium.ensureUsableByteBuffer(state),
                 Stodium.ensureUsableByteBuffer(dst),
-                Stodium.ensureUsableByteBuffer(priv)));
+                Stodium.ensureUsableByteBuffer(pub)));
     }
 
     @Override
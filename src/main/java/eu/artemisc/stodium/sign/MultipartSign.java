@@ -2,14 +2,22 @@ package eu.artemisc.stodium.sign;
 
 import org.jetbrains.annotations.NotNull;
 
+import java.io.Closeable;
 import java.nio.ByteBuffer;
 
+import eu.artemisc.stodium.StatePool;
 import eu.artemisc.stodium.exceptions.StodiumException;
 
 /**
+ * MultipartSign holds the state of a multipart (Ed25519ph) signature. Like
+ * {@link eu.artemisc.stodium.Multipart}, it can be reset to the state right
+ * after initialization, and returns its buffers to the
+ * {@link eu.artemisc.stodium.StatePool} when closed.
+ *
  * @author Jan van de Molengraft [jan@artemisc.eu]
  */
-public final class MultipartSign {
+public class MultipartSign
+        implements Closeable {
 
     /**
      *
@@ -52,24 +60,71 @@ public final class MultipartSign {
      */
     private final @NotNull ByteBuffer state;
 
+    /**
+     * initial holds a copy of the state as it was right after initialization.
+     */
+    private final @NotNull ByteBuffer initial;
+
+    /**
+     *
+     */
+    private boolean closed;
+
     /**
      *
      * @param spec
-     * @param state
+     * @param state the initialized state
      */
     public MultipartSign(final @NotNull Spec       spec,
                          final @NotNull ByteBuffer state) {
-        this.spec  = spec;
-        this.state = state;
+        this(spec, state, StatePool.copyOf(state));
+    }
+
+    /**
+     *
+     * @param spec
+     * @param state
+     * @param initial
+     */
+    private MultipartSign(final @NotNull Spec       spec,
+                          final @NotNull ByteBuffer state,
+                          final @NotNull ByteBuffer initial) {
+        this.spec    = spec;
+        this.state   = state;
+        this.initial = initial;
+    }
+
+    /**
+     *
+     */
+    private void checkOpen() {
+        if (closed) {
+            throw new IllegalStateException("Stodium: multipart state was closed");
+        }
     }
 
     /**
+     * duplicate returns an independent copy of the current state.
      *
      * @return
      */
     @NotNull
     public MultipartSign duplicate() {
-        throw new UnsupportedOperationException();
+        checkOpen();
+        return new MultipartSign(spec, StatePool.copyOf(state), StatePool.copyOf(initial));
+    }
+
+    /**
+     * reset brings the state back to the point right after initialization,
+     * also after one of the final methods was called.
+     *
+     * @return
+     */
+    @NotNull
+    public MultipartSign reset() {
+        checkOpen();
+        state.duplicate().put(initial.duplicate());
+        return this;
     }
 
     /**
@@ -81,6 +136,7 @@ public final class MultipartSign {
     @NotNull
     public MultipartSign update(final @NotNull ByteBuffer src)
             throws StodiumException {
+        checkOpen();
         spec.update(state, src);
         return this;
     }
@@ -94,6 +150,7 @@ public final class MultipartSign {
     public void doFinal(final @NotNull ByteBuffer dst,
                         final @NotNull ByteBuffer priv)
             throws StodiumException {
+        checkOpen();
         spec.doFinal(state, dst, priv);
     }
 
@@ -107,6 +164,20 @@ public final class MultipartSign {
     public boolean doFinalVerify(final @NotNull ByteBuffer sign,
                                  final @NotNull ByteBuffer priv)
             throws StodiumException {
+        checkOpen();
         return spec.doFinalVerify(state, sign, priv);
     }
+
+    /**
+     * close wipes the state and returns its buffers to the {@link StatePool}.
+     */
+    @Override
+    public void close() {
+        if (closed) {
+            return;
+        }
+        closed = true;
+        StatePool.release(state);
+        StatePool.release(initial);
+    }
 }
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2017 Project ArteMisc
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+package eu.artemisc.stodium.sign;
+
+import org.jetbrains.annotations.NotNull;
+
+import eu.artemisc.stodium.NativeState;
+
+/**
+ * NativeMultipartSign is a {@link MultipartSign} whose state is kept in native
+ * memory, see {@link NativeState}. Its doFinalVerify method takes the public
+ * key.
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+public final class NativeMultipartSign
+        extends MultipartSign {
+
+    /**
+     *
+     */
+    private final @NotNull NativeState state;
+
+    /**
+     * initial holds a copy of the state as it was right after initialization.
+     */
+    private final @NotNull NativeState initial;
+
+    /**
+     *
+     * @param state the initialized state
+     */
+    public NativeMultipartSign(final @NotNull NativeState state) {
+        this(state, state.copy());
+    }
+
+    /**
+     *
+     * @param state
+     * @param initial
+     */
+    private NativeMultipartSign(final @NotNull NativeState state,
+                                final @NotNull NativeState initial) {
+        super(state, NativeState.NO_STATE);
+        this.state   = state;
+        this.initial = initial;
+    }
+
+    @NotNull
+    @Override
+    public MultipartSign duplicate() {
+        return new NativeMultipartSign(state.copy(), initial.copy());
+    }
+
+    @NotNull
+    @Override
+    public MultipartSign reset() {
+        state.restore(initial);
+        return this;
+    }
+
+    /**
+     * close releases the native states without finalizing them.
+     */
+    @Override
+    public void close() {
+        state.close();
+        initial.close();
+        super.close();
+    }
+}
@@ -133,13 +133,13 @@ public abstract class Sign {
      *
      * @param dstMsg
      * @param srcSigned
-     * @param priv
+     * @param pub
      * @return
      * @throws StodiumException
      */
     public abstract boolean open(final @NotNull ByteBuffer dstMsg,
                                  final @NotNull ByteBuffer srcSigned,
-                                 final @NotNull ByteBuffer priv)
+                                 final @NotNull ByteBuffer pub)
             throws StodiumException;
 
     /**
@@ -158,15 +158,61 @@ public abstract class Sign {
      *
      * @param srcSig
      * @param srcMsg
-     * @param priv
+     * @param pub
      * @return
      * @throws StodiumException
      */
     public abstract boolean verifyDetached(final @NotNull ByteBuffer srcSig,
                                            final @NotNull ByteBuffer srcMsg,
-                                           final @NotNull ByteBuffer priv)
+                                           final @NotNull ByteBuffer pub)
+            throws StodiumException;
+
+    /**
+     * verifyDetachedBatch verifies a batch of detached signatures in a single
+     * call to the native code. The signatures are spread over the native
+     * worker pool if one was started with
+     * {@link eu.artemisc.stodium.Stodium#startWorkerPool(int)}.
+     * <p>
+     * The table holds an (offset, length) pair for every message in srcMsgs,
+     * with the offsets relative to {@code srcMsgs.position()}. srcSigs holds
+     * the signatures back to back, in the order of the table. Every distinct
+     * public key is stored once in pubs; keys holds the index in pubs of the
+     * key of every message, so a log signed by a few keys passes only those.
+     * <p>
+     * Bit {@code i % 8} of {@code results[i / 8]} is set if the signature of
+     * message i is valid, see {@link #isVerified(byte[], int)}.
+     *
+     * @param srcSigs the signatures
+     * @param srcMsgs holds the messages
+     * @param table   the (offset, length) pair of every message
+     * @param pubs    the distinct public keys
+     * @param keys    the index in pubs of the key of every message
+     * @param results receives the result of every message, of at least
+     *                {@code (count + 7) / 8} bytes
+     * @return the number of signatures that failed verification
+     * @throws StodiumException
+     */
+    public abstract int verifyDetachedBatch(final @NotNull ByteBuffer srcSigs,
+                                            final @NotNull ByteBuffer srcMsgs,
+                                            final @NotNull int[]      table,
+                                            final @NotNull ByteBuffer pubs,
+                                            final @NotNull int[]      keys,
+                                            final @NotNull byte[]     results)
             throws StodiumException;
 
+    /**
+     * isVerified reads the result of a single message from the results of
+     * {@link #verifyDetachedBatch}.
+     *
+     * @param results the results of the batch
+     * @param index   the index of the message in the batch
+     * @return true if the signature of the message is valid
+     */
+    public static boolean isVerified(final @NotNull byte[] results,
+                                     final          int    index) {
+        return (results[index >>> 3] & (1 << (index & 7))) != 0;
+    }
+
     /**
      *
      * @return
@@ -175,4 +221,16 @@ public abstract class Sign {
     @NotNull
     public abstract MultipartSign init()
             throws StodiumException;
+
+    /**
+     * initNative does the same as {@link #init()}, but keeps the state in
+     * native memory. See {@link eu.artemisc.stodium.NativeState}. The
+     * doFinalVerify method of the returned object takes the public key.
+     *
+     * @return
+     * @throws StodiumException
+     */
+    @NotNull
+    public abstract NativeMultipartSign initNative()
+            throws StodiumException;
 }
@@ -0,0 +1,111 @@
+package eu.artemisc.stodium;
+
+import org.jetbrains.annotations.NotNull;
+
+import java.nio.ByteBuffer;
+
+/**
+ * Fragments splits messages over a ByteBuffer[] for the gather/scatter tests.
+ * The fragments alternate between direct buffers and heap buffers that do not
+ * start at the beginning of their array (read-only ones, for input).
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+public final class Fragments {
+
+    /**
+     * Groups of splits of the same length. Any split of a group can be
+     * gathered and scattered into any other, which puts fragment boundaries
+     * at and next to the 16, 32 and 64 byte block boundaries, with empty
+     * fragments in between.
+     */
+    public static final @NotNull int[][][] SPLITS = new int[][][] {
+            { { 0, 1, 63, 64, 65 }, { 65, 64, 63, 1, 0 }, { 64, 0, 65, 1, 63 }, { 1, 64, 63, 65 }, { 193 } },
+            { { 64 }, { 1, 63 }, { 0, 64, 0 }, { 63, 1 } },
+            { { 65 }, { 64, 1 }, { 1, 64 }, { 0, 65 } },
+            { { 33 }, { 32, 1 }, { 31, 2 }, { 1, 32 } },
+            { { 1 }, { 0, 1 } },
+            { { 0 }, { 0, 0 } },
+    };
+
+    private static final byte BLANK = (byte) 0x5a;
+
+    private Fragments() {
+    }
+
+    /**
+     * length returns the sum of the lengths of a split.
+     */
+    public static int length(final @NotNull int[] lengths) {
+        int length = 0;
+        for (final int fragment : lengths) {
+            length += fragment;
+        }
+        return length;
+    }
+
+    /**
+     * split copies the remaining bytes of src to fragments of the given
+     * lengths.
+     */
+    public static @NotNull ByteBuffer[] split(final @NotNull ByteBuffer src,
+                                              final @NotNull int[]      lengths) {
+        final ByteBuffer[] fragments = blank(lengths);
+        int offset = 0;
+        for (int i = 0; i < fragments.length; i++) {
+            final ByteBuffer part = src.duplicate();
+            part.position(src.position() + offset);
+            part.limit(part.position() + lengths[i]);
+            fragments[i].duplicate().put(part);
+            offset += lengths[i];
+
+            if (!fragments[i].isDirect()) {
+                fragments[i] = fragments[i].asReadOnlyBuffer();
+            }
+        }
+        return fragments;
+    }
+
+    /**
+     * blank returns writable fragments of the given lengths, filled with a
+     * marker byte.
+     */
+    public static @NotNull ByteBuffer[] blank(final @NotNull int[] lengths) {
+        final ByteBuffer[] fragments = new ByteBuffer[lengths.length];
+        for (int i = 0; i < lengths.length; i++) {
+            fragments[i] = i % 2 == 0
+                    ? ByteBuffer.allocateDirect(lengths[i])
+                    : ByteBuffer.wrap(new byte[lengths[i] + 7], 7, lengths[i]);
+            for (int j = fragments[i].position(); j < fragments[i].limit(); j++) {
+                fragments[i].put(j, BLANK);
+            }
+        }
+        return fragments;
+    }
+
+    /**
+     * isBlank returns true if no fragment was written since blank().
+     */
+    public static boolean isBlank(final @NotNull ByteBuffer[] fragments) {
+        for (final ByteBuffer fragment : fragments) {
+            for (int j = fragment.position(); j < fragment.limit(); j++) {
+                if (fragment.get(j) != BLANK) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    /**
+     * join returns the concatenation of the remaining bytes of the fragments.
+     */
+    public static @NotNull ByteBuffer join(final @NotNull ByteBuffer[] fragments) {
+        final ByteBuffer joined = ByteBuffer.allocateDirect((int) Stodium.remaining(fragments));
+        for (final ByteBuffer fragment : fragments) {
+            joined.put(fragment.duplicate());
+        }
+        joined.flip();
+        return joined;
+    }
+}
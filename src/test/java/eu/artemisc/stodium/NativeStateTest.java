@@ -0,0 +1,45 @@
+package eu.artemisc.stodium;
+
+import org.junit.Assert;
+import org.junit.Test;
+
+import java.nio.ByteBuffer;
+
+/**
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+public class NativeStateTest {
+
+    @Test
+    public void staleHandle() {
+        final long handle = StodiumJNI.stodium_state_sha256_init();
+        Assert.assertNotEquals(0L, handle);
+        Assert.assertEquals(0, StodiumJNI.stodium_state_update(handle, ByteBuffer.wrap("abc".getBytes())));
+
+        final long copy = StodiumJNI.stodium_state_copy(handle);
+        Assert.assertNotEquals(0L, copy);
+
+        StodiumJNI.stodium_state_free(handle);
+        StodiumJNI.stodium_state_free(handle);
+
+        // the freed handle is rejected, also once its slot is reused
+        final long reused = StodiumJNI.stodium_state_sha256_init();
+        Assert.assertNotEquals(0L, reused);
+        Assert.assertNotEquals(handle, reused);
+        Assert.assertEquals(-1, StodiumJNI.stodium_state_update(handle, ByteBuffer.allocateDirect(1)));
+        Assert.assertEquals(0L, StodiumJNI.stodium_state_copy(handle));
+        Assert.assertEquals(-1, StodiumJNI.stodium_state_final(handle, ByteBuffer.allocateDirect(32)));
+
+        // the copy and the new handle are untouched
+        final ByteBuffer digest = ByteBuffer.allocateDirect(32);
+        Assert.assertEquals(0, StodiumJNI.stodium_state_final(copy, digest));
+        Assert.assertEquals(ByteBuffer.wrap(new byte[] {
+                (byte) 0xba, (byte) 0x78, (byte) 0x16, (byte) 0xbf, (byte) 0x8f, (byte) 0x01, (byte) 0xcf, (byte) 0xea,
+                (byte) 0x41, (byte) 0x41, (byte) 0x40, (byte) 0xde, (byte) 0x5d, (byte) 0xae, (byte) 0x22, (byte) 0x23,
+                (byte) 0xb0, (byte) 0x03, (byte) 0x61, (byte) 0xa3, (byte) 0x96, (byte) 0x17, (byte) 0x7a, (byte) 0x9c,
+                (byte) 0xb4, (byte) 0x10, (byte) 0xff, (byte) 0x61, (byte) 0xf2, (byte) 0x00, (byte) 0x15, (byte) 0xad,
+        }), digest);
+        Assert.assertEquals(-1, StodiumJNI.stodium_state_final(copy, digest));
+        Assert.assertEquals(0, StodiumJNI.stodium_state_final(reused, digest));
+    }
+}
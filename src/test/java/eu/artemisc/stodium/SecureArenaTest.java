@@ -0,0 +1,66 @@
+package eu.artemisc.stodium;
+
+import org.junit.Assert;
+import org.junit.Test;
+
+import java.nio.ByteBuffer;
+
+import eu.artemisc.stodium.exceptions.StodiumException;
+
+/**
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+public class SecureArenaTest {
+
+    @Test
+    public void reuse()
+            throws StodiumException {
+        final SecureArena arena = new SecureArena(256);
+        try {
+            final SecureBuffer first = arena.allocate(32);
+            first.buffer().put(0, (byte) 0x42);
+            first.close();
+            first.close();
+
+            // the block is wiped, and handed out once
+            final SecureBuffer a = arena.allocate(32);
+            final SecureBuffer b = arena.allocate(32);
+            Assert.assertEquals(0, a.buffer().get(0));
+            a.buffer().put(0, (byte) 1);
+            b.buffer().put(0, (byte) 2);
+            Assert.assertEquals(1, a.buffer().get(0));
+            Assert.assertEquals(2, b.buffer().get(0));
+        } finally {
+            arena.close();
+        }
+    }
+
+    @Test
+    public void doubleRelease() {
+        final long slab = StodiumJNI.stodium_secure_slab_create(256);
+        Assert.assertNotEquals(0L, slab);
+        try {
+            final ByteBuffer a = StodiumJNI.stodium_secure_alloc(slab, 32);
+            final ByteBuffer b = StodiumJNI.stodium_secure_alloc(slab, 32);
+            Assert.assertNotNull(a);
+            Assert.assertNotNull(b);
+
+            Assert.assertEquals(0, StodiumJNI.stodium_secure_release(slab, a));
+            Assert.assertEquals(-1, StodiumJNI.stodium_secure_release(slab, a));
+
+            // a's block is on the free list once: the next two blocks differ
+            final ByteBuffer c = StodiumJNI.stodium_secure_alloc(slab, 32);
+            final ByteBuffer d = StodiumJNI.stodium_secure_alloc(slab, 32);
+            Assert.assertNotNull(c);
+            Assert.assertNotNull(d);
+            c.put(0, (byte) 1);
+            d.put(0, (byte) 2);
+            Assert.assertEquals(1, c.get(0));
+
+            Assert.assertEquals(0, StodiumJNI.stodium_secure_release(slab, b));
+            Assert.assertEquals(-1, StodiumJNI.stodium_secure_release(slab, b));
+        } finally {
+            StodiumJNI.stodium_secure_slab_free(slab);
+        }
+    }
+}
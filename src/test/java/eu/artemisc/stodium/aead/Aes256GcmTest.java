@@ -100,6 +100,41 @@ public class Aes256GcmTest {
                         i, codec.encode(ciphertext)));
             }
 
+            Assert.assertTrue(aead.verify(ciphertext, ad, nonce, key));
+            Assert.assertTrue(aead.verifyDetached(detached_ciphertext, mac, ad, nonce, key));
+
+            final ByteBuffer forged = ByteBuffer.allocateDirect(ciphertext_len);
+            forged.duplicate().put(ciphertext.duplicate());
+            forged.put(ciphertext_len - 1, (byte) (forged.get(ciphertext_len - 1) ^ 1));
+            Assert.assertFalse(aead.verify(forged, ad, nonce, key));
+
+            decrypted = ByteBuffer.allocateDirect(ciphertext_len);
+            decrypted.duplicate().put(message.duplicate());
+            aead.encryptInPlace(decrypted, message_len, ad, nonce, key);
+            Assert.assertTrue(Stodium.isEqual(decrypted, expected_ciphertext));
+            Assert.assertTrue(aead.decryptInPlace(decrypted, ad, nonce, key));
+            Assert.assertTrue(Stodium.isEqual((ByteBuffer) decrypted.slice().limit(message_len), message));
+
+            final int split = message_len / 3;
+            final ByteBuffer[] srcFragments = new ByteBuffer[] {
+                    (ByteBuffer) message.slice().limit(split),
+                    (ByteBuffer) message.slice().position(split)
+            };
+            final ByteBuffer gathered = ByteBuffer.allocate(message_len);
+            final ByteBuffer[] dstFragments = new ByteBuffer[] {
+                    (ByteBuffer) gathered.slice().limit(message_len - split),
+                    (ByteBuffer) gathered.slice().position(message_len - split)
+            };
+            final ByteBuffer gatheredMac = ByteBuffer.allocateDirect(aead.aBytes());
+            aead.encryptDetached(dstFragments, gatheredMac, srcFragments, ad, nonce, key);
+            Assert.assertTrue(Stodium.isEqual(gathered, (ByteBuffer) expected_ciphertext.slice().limit(message_len)));
+            Assert.assertTrue(Stodium.isEqual(gatheredMac, (ByteBuffer) expected_ciphertext.slice().position(message_len)));
+
+            final ByteBuffer scattered = ByteBuffer.allocateDirect(message_len);
+            Assert.assertTrue(aead.decryptDetached(
+                    new ByteBuffer[] { scattered }, dstFragments, gatheredMac, ad, nonce, key));
+            Assert.assertTrue(Stodium.isEqual(scattered, message));
+
 /*            ####################################################            */
 
 //            decrypted = (unsigned char *) sodium_malloc(message_len);
@@ -0,0 +1,152 @@
+package eu.artemisc.stodium.aead;
+
+import org.jetbrains.annotations.NotNull;
+import org.junit.Assert;
+import org.junit.Test;
+
+import java.nio.ByteBuffer;
+
+import eu.artemisc.stodium.StodiumJNI;
+import eu.artemisc.stodium.exceptions.ConstraintViolationException;
+import eu.artemisc.stodium.exceptions.StodiumException;
+
+import static eu.artemisc.stodium.aead.Chacha20Poly1305Test.constructions;
+import static eu.artemisc.stodium.aead.Chacha20Poly1305Test.encrypt;
+import static eu.artemisc.stodium.aead.Chacha20Poly1305Test.pattern;
+import static eu.artemisc.stodium.aead.Chacha20Poly1305Test.slice;
+
+/**
+ * Checks encryptBatch and decryptBatch, in both nonce modes, against the
+ * messages encrypted one by one. The batches hold more messages than a single
+ * chunk of the native worker pool.
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+public class BatchTest {
+
+    private static final int COUNT = 37;
+
+    @Test
+    public void each()
+            throws StodiumException {
+        for (final AEAD aead : constructions()) {
+            roundTrip(aead, AEAD.NONCE_EACH, pattern(COUNT * aead.npubBytes(), 41));
+        }
+    }
+
+    @Test
+    public void counter()
+            throws StodiumException {
+        for (final AEAD aead : constructions()) {
+            // 0xff bytes, so the counter carries over into the next byte
+            final ByteBuffer base = pattern(aead.npubBytes(), 43);
+            base.put(0, (byte) 0xf0);
+            base.put(1, (byte) 0xff);
+            roundTrip(aead, AEAD.NONCE_COUNTER, base);
+        }
+    }
+
+    @Test
+    public void unknownMode()
+            throws StodiumException {
+        final AEAD       aead   = AEAD.chachaIetfInstance();
+        final int[]      table  = { 0, 1 };
+        final int[]      status = new int[1];
+        final ByteBuffer nonces = pattern(aead.npubBytes(), 3);
+        final ByteBuffer key    = pattern(aead.keyBytes(), 5);
+        try {
+            aead.encryptBatch(ByteBuffer.allocateDirect(1 + aead.aBytes()), pattern(1, 7), table,
+                    null, nonces, 2, key, status);
+            Assert.fail("accepted nonce mode 2");
+        } catch (final ConstraintViolationException e) {
+            // expected
+        }
+    }
+
+    private static void roundTrip(final @NotNull AEAD       aead,
+                                  final          int        nonceMode,
+                                  final @NotNull ByteBuffer nonces)
+            throws StodiumException {
+        final ByteBuffer key = pattern(aead.keyBytes(), 47);
+        final ByteBuffer ad  = pattern(9, 53);
+        final int        tag = aead.aBytes();
+
+        // messages of 0 to 72 bytes, carved out of one buffer
+        final int[] table = new int[2 * COUNT];
+        int plainLength = 0;
+        for (int i = 0; i < COUNT; i++) {
+            table[2 * i]     = 3 * i;
+            table[2 * i + 1] = 2 * i;
+            plainLength += 2 * i;
+        }
+        final ByteBuffer src = pattern(3 * COUNT + 2 * COUNT, 59);
+
+        final ByteBuffer cipher = ByteBuffer.allocateDirect(plainLength + COUNT * tag);
+        final int[]      status = new int[COUNT];
+        Assert.assertEquals(0, aead.encryptBatch(cipher, src, table, ad, nonces, nonceMode, key, status));
+
+        final int[] cipherTable = new int[2 * COUNT];
+        int offset = 0;
+        for (int i = 0; i < COUNT; i++) {
+            Assert.assertEquals(StodiumJNI.NOERR, status[i]);
+            final ByteBuffer expected = encrypt(aead,
+                    slice(src, table[2 * i], table[2 * i + 1]), ad, nonce(aead, nonces, nonceMode, i), key);
+            Assert.assertEquals(expected, slice(cipher, offset, expected.remaining()));
+
+            cipherTable[2 * i]     = offset;
+            cipherTable[2 * i + 1] = expected.remaining();
+            offset += expected.remaining();
+        }
+
+        // the forged messages fail on their own, with their output zeroed
+        final int[] forged = { 0, 5, COUNT - 1 };
+        for (final int i : forged) {
+            final int last = cipherTable[2 * i] + cipherTable[2 * i + 1] - 1;
+            cipher.put(last, (byte) (cipher.get(last) ^ 1));
+        }
+
+        final ByteBuffer plain = ByteBuffer.allocateDirect(plainLength);
+        for (int i = 0; i < plainLength; i++) {
+            plain.put(i, (byte) 0x5a);
+        }
+        Assert.assertEquals(forged.length,
+                aead.decryptBatch(plain, cipher, cipherTable, ad, nonces, nonceMode, key, status));
+
+        offset = 0;
+        for (int i = 0; i < COUNT; i++) {
+            final int        length = table[2 * i + 1];
+            final ByteBuffer opened = slice(plain, offset, length);
+            if (i == forged[0] || i == forged[1] || i == forged[2]) {
+                Assert.assertNotEquals(StodiumJNI.NOERR, status[i]);
+                Assert.assertEquals(ByteBuffer.allocateDirect(length), opened);
+            } else {
+                Assert.assertEquals(StodiumJNI.NOERR, status[i]);
+                Assert.assertEquals(slice(src, table[2 * i], length), opened);
+            }
+            offset += length;
+        }
+    }
+
+    /**
+     * nonce returns the nonce of message i: the i-th nonce, or the base nonce
+     * plus i as a little-endian number.
+     */
+    private static @NotNull ByteBuffer nonce(final @NotNull AEAD       aead,
+                                             final @NotNull ByteBuffer nonces,
+                                             final          int        nonceMode,
+                                             final          int        i) {
+        final int npub = aead.npubBytes();
+        if (nonceMode == AEAD.NONCE_EACH) {
+            return slice(nonces, i * npub, npub);
+        }
+
+        final ByteBuffer nonce = ByteBuffer.allocateDirect(npub);
+        int carry = i;
+        for (int j = 0; j < npub; j++) {
+            carry += nonces.get(nonces.position() + j) & 0xff;
+            nonce.put(j, (byte) carry);
+            carry >>>= 8;
+        }
+        return nonce;
+    }
+}
@@ -0,0 +1,343 @@
+package eu.artemisc.stodium.aead;
+
+import org.jetbrains.annotations.NotNull;
+import org.junit.Assert;
+import org.junit.Test;
+
+import java.nio.ByteBuffer;
+
+import eu.artemisc.stodium.Fragments;
+import eu.artemisc.stodium.codecs.Codec;
+import eu.artemisc.stodium.exceptions.ConstraintViolationException;
+import eu.artemisc.stodium.exceptions.StodiumException;
+
+/**
+ * Tests the methods that the ChaCha20-Poly1305 constructions implement in the
+ * native layer instead of libsodium (verify and verifyDetached, which compute
+ * the Poly1305 tag themselves), and the in-place calls, against libsodium's
+ * own encrypt. The lengths cross the 16 byte Poly1305 and the 64 byte ChaCha20
+ * block boundaries. The gather/scatter calls, which run the stream and
+ * Poly1305 over the fragments one by one, are checked against the contiguous
+ * detached calls.
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+public class Chacha20Poly1305Test {
+
+    private static final @NotNull int[] lengths   = new int[] { 0, 1, 15, 16, 17, 63, 64, 65, 300 };
+    private static final @NotNull int[] adLengths = new int[] { 0, 1, 13, 16, 17 };
+
+    @Test
+    public void rfc8439()
+            throws StodiumException {
+        final AEAD  aead  = AEAD.chachaIetfInstance();
+        final Codec codec = Codec.hex();
+
+        final ByteBuffer key = ByteBuffer.allocateDirect(aead.keyBytes());
+        for (int i = 0; i < aead.keyBytes(); i++) {
+            key.put(i, (byte) (0x80 + i));
+        }
+        final ByteBuffer nonce = ByteBuffer.allocateDirect(aead.npubBytes());
+        codec.decode(nonce, "070000004041424344454647");
+        final ByteBuffer ad = ByteBuffer.allocateDirect(12);
+        codec.decode(ad, "50515253c0c1c2c3c4c5c6c7");
+        final ByteBuffer message = ByteBuffer.wrap(("Ladies and Gentlemen of the class of '99: If I could "
+                + "offer you only one tip for the future, sunscreen would be it.").getBytes());
+        final ByteBuffer cipher = ByteBuffer.allocateDirect(message.remaining() + aead.aBytes());
+        codec.decode(cipher, rfc8439Cipher + rfc8439Mac);
+
+        final int length = message.remaining();
+        Assert.assertTrue(aead.verify(cipher, ad, nonce, key));
+        Assert.assertTrue(aead.verifyDetached(slice(cipher, 0, length),
+                slice(cipher, length, aead.aBytes()), ad, nonce, key));
+        Assert.assertFalse(aead.verify(flipped(cipher, 0), ad, nonce, key));
+
+        final ByteBuffer buffer = copy(cipher);
+        Assert.assertTrue(aead.decryptInPlace(buffer, ad, nonce, key));
+        Assert.assertEquals(message, slice(buffer, 0, length));
+
+        aead.encryptInPlace(buffer, length, ad, nonce, key);
+        Assert.assertEquals(cipher, buffer);
+    }
+
+    @Test
+    public void verify()
+            throws StodiumException {
+        for (final AEAD aead : constructions()) {
+            final ByteBuffer key   = pattern(aead.keyBytes(), 1);
+            final ByteBuffer nonce = pattern(aead.npubBytes(), 2);
+            final int        tag   = aead.aBytes();
+
+            for (final int length : lengths) {
+                for (final int adLength : adLengths) {
+                    final ByteBuffer ad     = pattern(adLength, 5);
+                    final ByteBuffer cipher = encrypt(aead, pattern(length, 3), ad, nonce, key);
+                    final ByteBuffer body   = slice(cipher, 0, length);
+                    final ByteBuffer mac    = slice(cipher, length, tag);
+
+                    Assert.assertTrue(aead.verify(cipher, ad, nonce, key));
+                    Assert.assertTrue(aead.verifyDetached(body, mac, ad, nonce, key));
+                    Assert.assertEquals(adLength == 0, aead.verify(cipher, null, nonce, key));
+
+                    if (length > 0) {
+                        Assert.assertFalse(aead.verify(flipped(cipher, length - 1), ad, nonce, key));
+                        Assert.assertFalse(aead.verifyDetached(flipped(body, 0), mac, ad, nonce, key));
+                    }
+                    if (adLength > 0) {
+                        Assert.assertFalse(aead.verify(cipher, flipped(ad, adLength - 1), nonce, key));
+                        Assert.assertFalse(aead.verifyDetached(body, mac, flipped(ad, 0), nonce, key));
+                    }
+                    Assert.assertFalse(aead.verify(flipped(cipher, length), ad, nonce, key));
+                    Assert.assertFalse(aead.verifyDetached(body, flipped(mac, tag - 1), ad, nonce, key));
+                }
+            }
+        }
+    }
+
+    @Test
+    public void inPlace()
+            throws StodiumException {
+        for (final AEAD aead : constructions()) {
+            final ByteBuffer key   = pattern(aead.keyBytes(), 7);
+            final ByteBuffer nonce = pattern(aead.npubBytes(), 11);
+            final int        tag   = aead.aBytes();
+
+            for (final int length : lengths) {
+                for (final int adLength : adLengths) {
+                    final ByteBuffer ad       = pattern(adLength, 13);
+                    final ByteBuffer message  = pattern(length, 17);
+                    final ByteBuffer expected = encrypt(aead, message, ad, nonce, key);
+
+                    // combined: the tag follows the ciphertext in the buffer
+                    final ByteBuffer buffer = ByteBuffer.allocateDirect(length + tag);
+                    buffer.duplicate().put(message.duplicate());
+                    aead.encryptInPlace(buffer, length, ad, nonce, key);
+                    Assert.assertEquals(expected, buffer);
+                    Assert.assertTrue(aead.decryptInPlace(buffer, ad, nonce, key));
+                    Assert.assertEquals(message, slice(buffer, 0, length));
+
+                    if (length > 0) {
+                        final ByteBuffer forged = flipped(expected, 0);
+                        Assert.assertFalse(aead.decryptInPlace(forged, ad, nonce, key));
+                        Assert.assertTrue(isZero(slice(forged, 0, length)));
+                    }
+                    if (adLength > 0) {
+                        final ByteBuffer forged = copy(expected);
+                        Assert.assertFalse(aead.decryptInPlace(forged, flipped(ad, 0), nonce, key));
+                        Assert.assertTrue(isZero(slice(forged, 0, length)));
+                    }
+                    final ByteBuffer forgedMac = flipped(expected, length + tag - 1);
+                    Assert.assertFalse(aead.decryptInPlace(forgedMac, ad, nonce, key));
+                    Assert.assertTrue(isZero(slice(forgedMac, 0, length)));
+
+                    // detached: the buffer holds the ciphertext alone
+                    final ByteBuffer detached = copy(message);
+                    final ByteBuffer mac      = ByteBuffer.allocateDirect(tag);
+                    aead.encryptDetachedInPlace(detached, mac, ad, nonce, key);
+                    Assert.assertEquals(slice(expected, 0, length), detached);
+                    Assert.assertEquals(slice(expected, length, tag), mac);
+                    Assert.assertTrue(aead.decryptDetachedInPlace(detached, mac, ad, nonce, key));
+                    Assert.assertEquals(message, detached);
+
+                    if (length > 0) {
+                        final ByteBuffer forged = flipped(slice(expected, 0, length), length - 1);
+                        Assert.assertFalse(aead.decryptDetachedInPlace(forged, mac, ad, nonce, key));
+                        Assert.assertTrue(isZero(forged));
+                    }
+                    if (adLength > 0) {
+                        final ByteBuffer forged = copy(slice(expected, 0, length));
+                        Assert.assertFalse(aead.decryptDetachedInPlace(forged, mac, flipped(ad, adLength - 1), nonce, key));
+                        Assert.assertTrue(isZero(forged));
+                    }
+                    final ByteBuffer forged = copy(slice(expected, 0, length));
+                    Assert.assertFalse(aead.decryptDetachedInPlace(forged, flipped(mac, 0), ad, nonce, key));
+                    Assert.assertTrue(isZero(forged));
+                }
+            }
+        }
+    }
+
+    @Test
+    public void gather()
+            throws StodiumException {
+        for (final AEAD aead : constructions()) {
+            final ByteBuffer key   = pattern(aead.keyBytes(), 19);
+            final ByteBuffer nonce = pattern(aead.npubBytes(), 23);
+            final ByteBuffer ad    = pattern(13, 29);
+            final int        tag   = aead.aBytes();
+
+            for (final int[][] group : Fragments.SPLITS) {
+                final int        length  = Fragments.length(group[0]);
+                final ByteBuffer message = pattern(length, 31);
+                final ByteBuffer body    = ByteBuffer.allocateDirect(length);
+                final ByteBuffer mac     = ByteBuffer.allocateDirect(tag);
+                aead.encryptDetached(body, mac, message, ad, nonce, key);
+
+                for (final int[] srcSplit : group) {
+                    for (final int[] dstSplit : group) {
+                        final ByteBuffer[] cipher   = Fragments.blank(dstSplit);
+                        final ByteBuffer   gathered = ByteBuffer.allocateDirect(tag);
+                        aead.encryptDetached(cipher, gathered, Fragments.split(message, srcSplit), ad, nonce, key);
+                        Assert.assertEquals(body, Fragments.join(cipher));
+                        Assert.assertEquals(mac, gathered);
+
+                        final ByteBuffer[] plain = Fragments.blank(srcSplit);
+                        Assert.assertTrue(aead.decryptDetached(plain, cipher, mac, ad, nonce, key));
+                        Assert.assertEquals(message, Fragments.join(plain));
+
+                        // nothing may be written for a forged message
+                        final ByteBuffer[] forged = Fragments.blank(srcSplit);
+                        Assert.assertFalse(aead.decryptDetached(forged, cipher, flipped(mac, tag - 1), ad, nonce, key));
+                        Assert.assertFalse(aead.decryptDetached(forged, cipher, mac, flipped(ad, 0), nonce, key));
+                        if (length > 0) {
+                            Assert.assertFalse(aead.decryptDetached(forged,
+                                    Fragments.split(flipped(body, length - 1), dstSplit), mac, ad, nonce, key));
+                        }
+                        Assert.assertTrue(Fragments.isBlank(forged));
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * The fragments of the output may only share memory with those of the
+     * input exactly in place (each byte at the same offset in the message),
+     * however both are split up.
+     */
+    @Test
+    public void overlap()
+            throws StodiumException {
+        final int length = 130;
+        for (final AEAD aead : constructions()) {
+            final ByteBuffer key     = pattern(aead.keyBytes(), 19);
+            final ByteBuffer nonce   = pattern(aead.npubBytes(), 23);
+            final ByteBuffer ad      = pattern(13, 29);
+            final ByteBuffer message = pattern(length, 31);
+            final ByteBuffer body    = ByteBuffer.allocateDirect(length);
+            final ByteBuffer mac     = ByteBuffer.allocateDirect(aead.aBytes());
+            aead.encryptDetached(body, mac, message, ad, nonce, key);
+
+            // in place, split up differently
+            final ByteBuffer work = ByteBuffer.allocateDirect(2 * length + 20);
+            work.duplicate().put(message.duplicate());
+            final ByteBuffer[] inPlace = { slice(work, 0, 64), slice(work, 64, length - 64) };
+            final ByteBuffer[] resplit = { slice(work, 0, 30), slice(work, 30, length - 30) };
+            final ByteBuffer   gathered = ByteBuffer.allocateDirect(aead.aBytes());
+            aead.encryptDetached(resplit, gathered, inPlace, ad, nonce, key);
+            Assert.assertEquals(body, slice(work, 0, length));
+            Assert.assertEquals(mac, gathered);
+            Assert.assertTrue(aead.decryptDetached(inPlace, resplit, mac, ad, nonce, key));
+            Assert.assertEquals(message, slice(work, 0, length));
+
+            // disjoint regions of one buffer
+            final ByteBuffer[] apart = { slice(work, length + 20, length) };
+            aead.encryptDetached(apart, gathered, inPlace, ad, nonce, key);
+            Assert.assertEquals(body, apart[0]);
+
+            // shifted by one byte: rejected natively, nothing is decrypted
+            final ByteBuffer[] shifted = { slice(work, 1, 64), slice(work, 65, length - 64) };
+            try {
+                aead.encryptDetached(shifted, gathered, inPlace, ad, nonce, key);
+                Assert.fail("shifted direct fragments were accepted");
+            } catch (final StodiumException e) {
+                // expected
+            }
+            work.duplicate().put(body.duplicate());
+            Assert.assertFalse(aead.decryptDetached(shifted, inPlace, mac, ad, nonce, key));
+            Assert.assertEquals(body, slice(work, 0, length));
+
+            // and for heap fragments already in Java
+            final byte[]       array = new byte[length + 1];
+            final ByteBuffer[] from  = { ByteBuffer.wrap(array, 0, length) };
+            final ByteBuffer[] to    = { ByteBuffer.wrap(array, 1, length) };
+            try {
+                aead.encryptDetached(to, gathered, from, ad, nonce, key);
+                Assert.fail("shifted heap fragments were accepted");
+            } catch (final ConstraintViolationException e) {
+                // expected
+            }
+            try {
+                aead.decryptDetached(to, from, mac, ad, nonce, key);
+                Assert.fail("shifted heap fragments were accepted");
+            } catch (final ConstraintViolationException e) {
+                // expected
+            }
+        }
+    }
+
+    static @NotNull AEAD[] constructions() {
+        return new AEAD[] {
+                AEAD.chachaInstance(),
+                AEAD.chachaIetfInstance(),
+                AEAD.xchachaIetfInstance()
+        };
+    }
+
+    /**
+     * encrypt returns the ciphertext and tag of message, as computed by
+     * libsodium's own encrypt.
+     */
+    static @NotNull ByteBuffer encrypt(final @NotNull AEAD       aead,
+                                       final @NotNull ByteBuffer message,
+                                       final @NotNull ByteBuffer ad,
+                                       final @NotNull ByteBuffer nonce,
+                                       final @NotNull ByteBuffer key)
+            throws StodiumException {
+        final ByteBuffer cipher = ByteBuffer.allocateDirect(message.remaining() + aead.aBytes());
+        aead.encrypt(cipher, message, ad, nonce, key);
+        return cipher;
+    }
+
+    static @NotNull ByteBuffer pattern(final int length,
+                                       final int seed) {
+        final ByteBuffer buffer = ByteBuffer.allocateDirect(length);
+        for (int i = 0; i < length; i++) {
+            buffer.put(i, (byte) (i * seed + (i >> 8) + seed));
+        }
+        return buffer;
+    }
+
+    static @NotNull ByteBuffer slice(final @NotNull ByteBuffer src,
+                                     final          int        offset,
+                                     final          int        length) {
+        final ByteBuffer view = src.duplicate();
+        view.position(src.position() + offset);
+        view.limit(src.position() + offset + length);
+        return view.slice();
+    }
+
+    static @NotNull ByteBuffer copy(final @NotNull ByteBuffer src) {
+        final ByteBuffer copy = ByteBuffer.allocateDirect(src.remaining());
+        copy.duplicate().put(src.duplicate());
+        return copy;
+    }
+
+    /**
+     * flipped returns a copy of src with the lowest bit of the byte at index
+     * flipped.
+     */
+    static @NotNull ByteBuffer flipped(final @NotNull ByteBuffer src,
+                                       final          int        index) {
+        final ByteBuffer copy = copy(src);
+        copy.put(index, (byte) (copy.get(index) ^ 1));
+        return copy;
+    }
+
+    static boolean isZero(final @NotNull ByteBuffer src) {
+        for (int i = src.position(); i < src.limit(); i++) {
+            if (src.get(i) != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    private static final @NotNull String rfc8439Cipher =
+            "d31a8d34648e60db7b86afbc53ef7ec2a4aded51296e08fea9e2b5a736ee62d6" +
+            "3dbea45e8ca9671282fafb69da92728b1a71de0a9e060b2905d6a5b67ecd3b36" +
+            "92ddbd7f2d778b8c9803aee328091b58fab324e4fad675945585808b4831d7bc" +
+            "3ff4def08e4b7a9de576d26586cec64b6116";
+
+    private static final @NotNull String rfc8439Mac = "1ae10b594f09e26a7e902ecbd0600691";
+}
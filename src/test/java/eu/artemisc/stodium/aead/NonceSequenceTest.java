@@ -0,0 +1,103 @@
+package eu.artemisc.stodium.aead;
+
+import org.jetbrains.annotations.NotNull;
+import org.junit.Assert;
+import org.junit.Test;
+
+import java.nio.ByteBuffer;
+
+import eu.artemisc.stodium.exceptions.ConstraintViolationException;
+import eu.artemisc.stodium.exceptions.StodiumException;
+
+import static eu.artemisc.stodium.aead.Chacha20Poly1305Test.constructions;
+import static eu.artemisc.stodium.aead.Chacha20Poly1305Test.copy;
+import static eu.artemisc.stodium.aead.Chacha20Poly1305Test.encrypt;
+import static eu.artemisc.stodium.aead.Chacha20Poly1305Test.flipped;
+import static eu.artemisc.stodium.aead.Chacha20Poly1305Test.pattern;
+import static eu.artemisc.stodium.aead.Chacha20Poly1305Test.slice;
+
+/**
+ * Checks encryptPrefixed and decryptPrefixed against encrypt, and the
+ * increments of a NonceSequence.
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+public class NonceSequenceTest {
+
+    @Test
+    public void prefixed()
+            throws StodiumException {
+        for (final AEAD aead : constructions()) {
+            final int        npub = aead.npubBytes();
+            final ByteBuffer key  = pattern(aead.keyBytes(), 3);
+            final ByteBuffer ad   = pattern(11, 5);
+
+            // 0xff bytes, so the increment carries over into the next bytes
+            final ByteBuffer start = pattern(npub, 7);
+            start.put(0, (byte) 0xfe);
+            start.put(1, (byte) 0xff);
+            final NonceSequence nonces = new NonceSequence(aead, start);
+            Assert.assertEquals(npub, nonces.nonceBytes());
+            Assert.assertEquals(start, nonces.current());
+
+            ByteBuffer expected = copy(start);
+            for (int i = 0; i < 3; i++) {
+                final ByteBuffer message = pattern(17 * i, 13 + i);
+                final ByteBuffer cipher  = ByteBuffer.allocateDirect(npub + message.remaining() + aead.aBytes());
+                aead.encryptPrefixed(cipher, message, ad, nonces, key);
+
+                Assert.assertEquals(expected, slice(cipher, 0, npub));
+                Assert.assertEquals(encrypt(aead, message, ad, expected, key),
+                        slice(cipher, npub, cipher.remaining() - npub));
+
+                final ByteBuffer plain = ByteBuffer.allocateDirect(message.remaining());
+                Assert.assertTrue(aead.decryptPrefixed(plain, cipher, ad, key));
+                Assert.assertEquals(message, plain);
+                Assert.assertFalse(aead.decryptPrefixed(plain, flipped(cipher, 0), ad, key));
+                Assert.assertFalse(aead.decryptPrefixed(plain, flipped(cipher, cipher.remaining() - 1), ad, key));
+
+                expected = increment(expected);
+                Assert.assertEquals(expected, nonces.current());
+            }
+            // 0xfe 0xff + 3 carries into the third byte
+            Assert.assertEquals(1, expected.get(0));
+            Assert.assertEquals(0, expected.get(1));
+            Assert.assertEquals((byte) (start.get(2) + 1), expected.get(2));
+        }
+    }
+
+    @Test
+    public void start()
+            throws StodiumException {
+        final AEAD aead = AEAD.chachaIetfInstance();
+        Assert.assertNotEquals(new NonceSequence(aead).current(), new NonceSequence(aead).current());
+        try {
+            new NonceSequence(aead, pattern(aead.npubBytes() + 1, 1));
+            Assert.fail("accepted a nonce of the wrong size");
+        } catch (final ConstraintViolationException e) {
+            // expected
+        }
+        try {
+            aead.encryptPrefixed(ByteBuffer.allocateDirect(64), pattern(8, 1), null,
+                    new NonceSequence(AEAD.xchachaIetfInstance()), pattern(aead.keyBytes(), 1));
+            Assert.fail("accepted a sequence of another construction");
+        } catch (final ConstraintViolationException e) {
+            // expected
+        }
+    }
+
+    /**
+     * increment returns nonce plus one, as a little-endian number, like
+     * sodium_increment.
+     */
+    private static @NotNull ByteBuffer increment(final @NotNull ByteBuffer nonce) {
+        final ByteBuffer next  = copy(nonce);
+        int              carry = 1;
+        for (int i = 0; i < next.capacity(); i++) {
+            carry += next.get(i) & 0xff;
+            next.put(i, (byte) carry);
+            carry >>>= 8;
+        }
+        return next;
+    }
+}
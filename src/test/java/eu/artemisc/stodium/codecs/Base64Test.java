@@ -1,15 +1,126 @@
 package eu.artemisc.stodium.codecs;
 
+import org.jetbrains.annotations.NotNull;
+import org.junit.Assert;
 import org.junit.Test;
 
+import java.nio.ByteBuffer;
+import java.nio.CharBuffer;
+
+import eu.artemisc.stodium.exceptions.StodiumException;
+
 /**
  * @author Jan van de Molengraft [jan@artemisc.eu]
  */
 public class Base64Test {
 
     @Test
-    public void tv() {
+    public void tv()
+            throws StodiumException {
+        for (final String[] vector : vectors) {
+            final ByteBuffer bin = ByteBuffer.wrap(vector[0].getBytes());
+            Assert.assertEquals(vector[1], Codec.base64Original().encode(bin));
+            Assert.assertEquals(vector[2], Codec.base64OriginalNoPadding().encode(bin));
+
+            final ByteBuffer dst = ByteBuffer.allocate(bin.remaining());
+            Assert.assertEquals(bin.remaining(), Codec.base64Original().decode(dst, vector[1]));
+            Assert.assertEquals(bin, dst);
+            dst.clear();
+            Assert.assertEquals(bin.remaining(), Codec.base64OriginalNoPadding().decode(dst, vector[2]));
+            Assert.assertEquals(bin, dst);
+        }
+    }
+
+    @Test
+    public void urlSafe()
+            throws StodiumException {
+        final ByteBuffer bin = ByteBuffer.wrap(new byte[] { (byte) 0xfb, (byte) 0xff });
+        Assert.assertEquals("+/8=", Codec.base64Original().encode(bin));
+        Assert.assertEquals("-_8=", Codec.base64UrlSafe().encode(bin));
+        Assert.assertEquals("-_8", Codec.base64UrlSafeNoPadding().encode(bin));
+    }
+
+    @Test
+    public void invalid() {
+        final String[] invalid = { "Zg=", "Zh==", "Zm9=", "Z===", "Zg==Zg==", "Zm9v!g==" };
+        for (final String encoded : invalid) {
+            try {
+                Codec.base64Original().decode(ByteBuffer.allocate(8), encoded);
+                Assert.fail("accepted " + encoded);
+            } catch (final StodiumException e) {
+                // expected
+            }
+        }
+    }
+
+    /**
+     * The bits of the last character that do not make up a whole byte must be
+     * zero, as in sodium_base642bin: "AE==" and "AAB=" are rejected.
+     */
+    @Test
+    public void canonical() {
+        final String alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        Assert.assertFalse(decodes(Codec.base64Original(), "AE=="));
+        Assert.assertFalse(decodes(Codec.base64Original(), "AAB="));
+
+        for (int value = 0; value < alphabet.length(); value++) {
+            final char c = alphabet.charAt(value);
+            Assert.assertEquals("A" + c + "==", (value & 0x0F) == 0,
+                    decodes(Codec.base64Original(), "A" + c + "=="));
+            Assert.assertEquals("AA" + c + "=", (value & 0x03) == 0,
+                    decodes(Codec.base64Original(), "AA" + c + "="));
+            Assert.assertEquals("Zm9vA" + c, (value & 0x0F) == 0,
+                    decodes(Codec.base64OriginalNoPadding(), "Zm9vA" + c));
+            Assert.assertEquals("Zm9vAA" + c, (value & 0x03) == 0,
+                    decodes(Codec.base64OriginalNoPadding(), "Zm9vAA" + c));
+        }
+    }
+
+    @Test
+    public void stream()
+            throws StodiumException {
+        final Codec.Encoder encoder = Codec.base64Original().newEncoder();
+        final CharBuffer    text    = CharBuffer.allocate(8);
+
+        encoder.update(text, ByteBuffer.wrap("fo".getBytes()));
+        encoder.update(text, ByteBuffer.wrap("oba".getBytes()));
+        encoder.doFinal(text);
+        text.flip();
+        Assert.assertEquals("Zm9vYmE=", text.toString());
+
+        final Codec.Decoder decoder = Codec.base64Original().newDecoder();
+        final ByteBuffer    bin     = ByteBuffer.allocate(5);
+        decoder.update(bin, CharBuffer.wrap("Zm9v"));
+        decoder.update(bin, CharBuffer.wrap("Ym"));
+        decoder.update(bin, CharBuffer.wrap("E="));
+        decoder.doFinal(bin);
+        bin.flip();
+        Assert.assertEquals(ByteBuffer.wrap("fooba".getBytes()), bin);
+    }
 
+    private static boolean decodes(final @NotNull Codec  codec,
+                                   final @NotNull String encoded) {
+        try {
+            codec.decode(ByteBuffer.allocate(8), encoded);
+            return true;
+        } catch (final StodiumException e) {
+            return false;
+        }
     }
 
+    /**
+     * The test vectors of RFC 4648, section 10:
+     * [0] : data
+     * [1] : base64
+     * [2] : base64 without padding
+     */
+    private static final @NotNull String[][] vectors = new String[][] {
+        { "",       "",         ""         },
+        { "f",      "Zg==",     "Zg"       },
+        { "fo",     "Zm8=",     "Zm8"      },
+        { "foo",    "Zm9v",     "Zm9v"     },
+        { "foob",   "Zm9vYg==", "Zm9vYg"   },
+        { "fooba",  "Zm9vYmE=", "Zm9vYmE"  },
+        { "foobar", "Zm9vYmFy", "Zm9vYmFy" },
+    };
 }
@@ -1,14 +1,53 @@
 package eu.artemisc.stodium.codecs;
 
+import org.junit.Assert;
 import org.junit.Test;
 
+import java.nio.ByteBuffer;
+import java.nio.CharBuffer;
+
+import eu.artemisc.stodium.exceptions.StodiumException;
+
 /**
  * @author Jan van de Molengraft [jan@artemisc.eu]
  */
 public class HexTest {
 
     @Test
-    public void tv() {
+    public void tv()
+            throws StodiumException {
+        final Codec codec = Codec.hex();
+        final ByteBuffer bin = ByteBuffer.wrap(new byte[] {
+                (byte) 0x00, (byte) 0x1f, (byte) 0xa0, (byte) 0xff, (byte) 0x5c });
+
+        Assert.assertEquals("001fa0ff5c", codec.encode(bin));
+
+        final ByteBuffer dst = ByteBuffer.allocateDirect(5);
+        Assert.assertEquals(5, codec.decode(dst, "001FA0ff5C"));
+        Assert.assertEquals(bin, dst);
+
+        final CharBuffer chars = CharBuffer.allocate(10);
+        Assert.assertEquals(10, codec.encode(chars, bin));
+        Assert.assertEquals("001fa0ff5c", new String(chars.array()));
+    }
+
+    @Test(expected = StodiumException.class)
+    public void invalid()
+            throws StodiumException {
+        Codec.hex().decode(ByteBuffer.allocate(2), "0g1f");
+    }
+
+    @Test
+    public void stream()
+            throws StodiumException {
+        final Codec.Decoder decoder = Codec.hex().newDecoder();
+        final ByteBuffer    dst     = ByteBuffer.allocate(5);
 
+        decoder.update(dst, CharBuffer.wrap("001"));
+        decoder.update(dst, ByteBuffer.wrap("fa0ff".getBytes()));
+        decoder.update(dst, CharBuffer.wrap("5c"));
+        decoder.doFinal(dst);
+        dst.flip();
+        Assert.assertEquals("001fa0ff5c", Codec.hex().encode(dst));
     }
 }
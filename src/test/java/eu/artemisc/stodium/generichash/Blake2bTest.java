@@ -1,8 +1,13 @@
 package eu.artemisc.stodium.generichash;
 
 import org.jetbrains.annotations.NotNull;
+import org.junit.Assert;
 import org.junit.Test;
 
+import java.nio.ByteBuffer;
+
+import eu.artemisc.stodium.exceptions.StodiumException;
+
 /**
  * @author Jan van de Molengraft [jan@artemisc.eu]
  */
@@ -13,6 +18,80 @@ public class Blake2bTest {
         //Assert.assertArrayEquals();
     }
 
+    @Test
+    public void closed()
+            throws StodiumException {
+        final Blake2b blake2b = new Blake2b(Blake2b.BYTES, null);
+        blake2b.close();
+        blake2b.close();
+
+        try {
+            blake2b.update(ByteBuffer.allocateDirect(1));
+            Assert.fail("update after close");
+        } catch (final IllegalStateException e) {
+            // expected
+        }
+        try {
+            new Blake2b(blake2b);
+            Assert.fail("copy after close");
+        } catch (final IllegalStateException e) {
+            // expected
+        }
+
+        // the state was pooled once, so two new states do not share it
+        final Blake2b a = new Blake2b(Blake2b.BYTES, null);
+        final Blake2b b = new Blake2b(Blake2b.BYTES, null);
+        final ByteBuffer outA = ByteBuffer.allocateDirect(Blake2b.BYTES);
+        final ByteBuffer outB = ByteBuffer.allocateDirect(Blake2b.BYTES);
+        a.update(ByteBuffer.allocateDirect(1));
+        a.doFinal(outA);
+        b.doFinal(outB);
+        Assert.assertNotEquals(outA, outB);
+        a.close();
+        b.close();
+    }
+
+    @Test
+    public void hashBatch()
+            throws StodiumException {
+        final GenericHash hash = GenericHash.blake2bInstance();
+        final ByteBuffer  src  = ByteBuffer.allocateDirect(3000);
+        final ByteBuffer  key  = ByteBuffer.allocateDirect(Blake2b.KEYBYTES);
+        for (int i = 0; i < src.capacity(); i++) {
+            src.put(i, (byte) (i * 7 + (i >> 8)));
+        }
+        for (int i = 0; i < key.capacity(); i++) {
+            key.put(i, (byte) (i * 3 + 1));
+        }
+
+        final int   count = 37;
+        final int[] table = new int[2 * count];
+        for (int i = 0; i < count; i++) {
+            table[2 * i]     = 11 * i;
+            table[2 * i + 1] = 7 * i * i % 300;
+        }
+
+        for (final int outlen : new int[] { Blake2b.BYTES_MIN, Blake2b.BYTES, Blake2b.BYTES_MAX }) {
+            for (final ByteBuffer k : new ByteBuffer[] { null, key }) {
+                final ByteBuffer dst = ByteBuffer.allocateDirect(count * outlen);
+                hash.hashBatch(dst, outlen, src, table, k);
+
+                for (int i = 0; i < count; i++) {
+                    final ByteBuffer message = src.duplicate();
+                    message.position(table[2 * i]);
+                    message.limit(table[2 * i] + table[2 * i + 1]);
+                    final ByteBuffer expected = ByteBuffer.allocateDirect(outlen);
+                    hash.hash(expected, message, k);
+
+                    final ByteBuffer digest = dst.duplicate();
+                    digest.position(i * outlen);
+                    digest.limit((i + 1) * outlen);
+                    Assert.assertEquals(expected, digest);
+                }
+            }
+        }
+    }
+
     /**
      * For each triplet:
      * [0] : in_hex
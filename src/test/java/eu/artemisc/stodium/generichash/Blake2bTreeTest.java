@@ -0,0 +1,154 @@
+package eu.artemisc.stodium.generichash;
+
+import org.jetbrains.annotations.NotNull;
+import org.jetbrains.annotations.Nullable;
+import org.junit.Assert;
+import org.junit.Test;
+
+import java.nio.ByteBuffer;
+
+import eu.artemisc.stodium.exceptions.ConstraintViolationException;
+import eu.artemisc.stodium.exceptions.StodiumException;
+
+/**
+ * Checks the roots of Blake2bTree against a tree built from GenericHash.hash,
+ * before and after a few leaves changed.
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+public class Blake2bTreeTest {
+
+    private static final int LEAF = 64;
+
+    @Test
+    public void root()
+            throws StodiumException {
+        final ByteBuffer key = ByteBuffer.allocateDirect(Blake2b.KEYBYTES);
+        for (int i = 0; i < key.capacity(); i++) {
+            key.put(i, (byte) i);
+        }
+
+        // one leaf, an odd number of leaves with a short last leaf, and a power of two
+        for (final int length : new int[] { 0, 1, LEAF, 11 * LEAF + 5, 16 * LEAF }) {
+            for (final ByteBuffer k : new ByteBuffer[] { null, key }) {
+                final ByteBuffer  message = pattern(length, 3);
+                final Blake2bTree tree    = new Blake2bTree(length, LEAF, Blake2b.BYTES, k);
+                try {
+                    tree.update(0, message.duplicate());
+                    Assert.assertEquals(reference(message, k), root(tree));
+
+                    // change the first and the last leaf, and update just those
+                    final int last = (tree.leaves() - 1) * LEAF;
+                    if (length > 0) {
+                        message.put(0, (byte) ~message.get(0));
+                    }
+                    if (length > LEAF) {
+                        message.put(length - 1, (byte) ~message.get(length - 1));
+                    }
+                    tree.update(0, slice(message, 0, Math.min(LEAF, length)));
+                    tree.update(last, slice(message, last, length - last));
+                    Assert.assertEquals(reference(message, k), root(tree));
+
+                    // the root is stable without changes
+                    Assert.assertEquals(reference(message, k), root(tree));
+                } finally {
+                    tree.close();
+                }
+            }
+        }
+    }
+
+    @Test
+    public void unset()
+            throws StodiumException {
+        final Blake2bTree tree = new Blake2bTree(4 * LEAF, LEAF, Blake2b.BYTES, null);
+        try {
+            tree.update(LEAF, pattern(3 * LEAF, 5));
+            try {
+                root(tree);
+                Assert.fail("root of a tree with a leaf that was never updated");
+            } catch (final StodiumException e) {
+                // expected
+            }
+            try {
+                tree.update(LEAF + 1, pattern(LEAF, 5));
+                Assert.fail("update at an offset inside a leaf");
+            } catch (final ConstraintViolationException e) {
+                // expected
+            }
+        } finally {
+            tree.close();
+        }
+    }
+
+    private static @NotNull ByteBuffer root(final @NotNull Blake2bTree tree)
+            throws StodiumException {
+        final ByteBuffer dst = ByteBuffer.allocateDirect(tree.outlen());
+        tree.root(dst);
+        return dst;
+    }
+
+    /**
+     * reference returns the root of the tree of message, hashing one node at
+     * a time.
+     */
+    private static @NotNull ByteBuffer reference(final @NotNull  ByteBuffer message,
+                                                 final @Nullable ByteBuffer key)
+            throws StodiumException {
+        final int    length = message.remaining();
+        final int    leaves = Math.max(1, (length + LEAF - 1) / LEAF);
+        ByteBuffer[] level  = new ByteBuffer[leaves];
+        for (int i = 0; i < leaves; i++) {
+            level[i] = node(0x00, key, slice(message, i * LEAF, Math.min(LEAF, length - i * LEAF)));
+        }
+
+        while (level.length > 1) {
+            final ByteBuffer[] parents = new ByteBuffer[(level.length + 1) / 2];
+            for (int i = 0; i < parents.length; i++) {
+                parents[i] = 2 * i + 1 < level.length
+                        ? node(0x01, key, level[2 * i], level[2 * i + 1])
+                        : node(0x01, key, level[2 * i]);
+            }
+            level = parents;
+        }
+        return level[0];
+    }
+
+    private static @NotNull ByteBuffer node(final           int          prefix,
+                                            final @Nullable ByteBuffer   key,
+                                            final @NotNull  ByteBuffer... parts)
+            throws StodiumException {
+        int length = 1;
+        for (final ByteBuffer part : parts) {
+            length += part.remaining();
+        }
+        final ByteBuffer input = ByteBuffer.allocateDirect(length);
+        input.put((byte) prefix);
+        for (final ByteBuffer part : parts) {
+            input.put(part.duplicate());
+        }
+        input.flip();
+
+        final ByteBuffer digest = ByteBuffer.allocateDirect(Blake2b.BYTES);
+        GenericHash.blake2bInstance().hash(digest, input, key);
+        return digest;
+    }
+
+    private static @NotNull ByteBuffer pattern(final int length,
+                                               final int seed) {
+        final ByteBuffer buffer = ByteBuffer.allocateDirect(length);
+        for (int i = 0; i < length; i++) {
+            buffer.put(i, (byte) (i * seed + (i >> 8) + seed));
+        }
+        return buffer;
+    }
+
+    private static @NotNull ByteBuffer slice(final @NotNull ByteBuffer src,
+                                             final          int        offset,
+                                             final          int        length) {
+        final ByteBuffer view = src.duplicate();
+        view.position(src.position() + offset);
+        view.limit(src.position() + offset + length);
+        return view.slice();
+    }
+}
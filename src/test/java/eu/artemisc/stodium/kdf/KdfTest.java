@@ -0,0 +1,159 @@
+package eu.artemisc.stodium.kdf;
+
+import org.jetbrains.annotations.NotNull;
+import org.junit.Assert;
+import org.junit.Test;
+
+import java.nio.ByteBuffer;
+
+import eu.artemisc.stodium.exceptions.ConstraintViolationException;
+import eu.artemisc.stodium.exceptions.StodiumException;
+
+/**
+ * Checks deriveRange and prepared contexts against deriveFromKey, and all of
+ * them against subkeys of crypto_kdf_blake2b_derive_from_key.
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+public class KdfTest {
+
+    @Test
+    public void tv()
+            throws StodiumException {
+        final Kdf        kdf      = Kdf.blake2b();
+        final ByteBuffer context  = context();
+        final ByteBuffer key      = key();
+        final KdfContext prepared = kdf.prepare(context, key);
+        try {
+            for (final String[] vector : vectors) {
+                final long       id       = Long.parseLong(vector[0]);
+                final ByteBuffer expected = hex(vector[1]);
+                final int        length   = expected.capacity();
+
+                final ByteBuffer subKey = ByteBuffer.allocateDirect(length);
+                kdf.deriveFromKey(subKey, id, context, key);
+                Assert.assertEquals(expected, subKey);
+
+                final ByteBuffer range = ByteBuffer.allocateDirect(length);
+                kdf.deriveRange(range, length, id, 1, context, key);
+                Assert.assertEquals(expected, range);
+
+                final ByteBuffer fromPrepared = ByteBuffer.allocateDirect(length);
+                prepared.deriveFromKey(fromPrepared, id);
+                Assert.assertEquals(expected, fromPrepared);
+            }
+        } finally {
+            prepared.close();
+        }
+    }
+
+    /**
+     * A range of more subkeys than a single slice of the worker pool, starting
+     * below 2^32 so the ids carry into the upper half of the salt.
+     */
+    @Test
+    public void range()
+            throws StodiumException {
+        final Kdf        kdf     = Kdf.blake2b();
+        final ByteBuffer context = context();
+        final ByteBuffer key     = key();
+        final int        count   = 2500;
+        final long       first   = 0xffffff00L;
+
+        for (final int length : new int[] { kdf.bytesMin(), kdf.bytesMax() }) {
+            final ByteBuffer range        = ByteBuffer.allocateDirect(count * length);
+            final ByteBuffer fromPrepared = ByteBuffer.allocateDirect(count * length);
+            kdf.deriveRange(range, length, first, count, context, key);
+
+            final KdfContext prepared = kdf.prepare(context, key);
+            try {
+                prepared.deriveRange(fromPrepared, length, first, count);
+            } finally {
+                prepared.close();
+            }
+            Assert.assertEquals(range, fromPrepared);
+
+            final ByteBuffer subKey = ByteBuffer.allocateDirect(length);
+            for (int i = 0; i < count; i += 97) {
+                kdf.deriveFromKey(subKey, first + i, context, key);
+                Assert.assertEquals("subkey " + i, subKey, slice(range, i * length, length));
+            }
+        }
+    }
+
+    @Test
+    public void invalid()
+            throws StodiumException {
+        final Kdf        kdf     = Kdf.blake2b();
+        final ByteBuffer context = context();
+        final ByteBuffer key     = key();
+        try {
+            kdf.deriveRange(ByteBuffer.allocateDirect(63), 32, 0, 2, context, key);
+            Assert.fail("accepted a destination shorter than the range");
+        } catch (final ConstraintViolationException e) {
+            // expected
+        }
+        try {
+            kdf.deriveRange(ByteBuffer.allocateDirect(64), kdf.bytesMin() - 1, 0, 1, context, key);
+            Assert.fail("accepted a subkey shorter than bytesMin");
+        } catch (final ConstraintViolationException e) {
+            // expected
+        }
+        try {
+            kdf.prepare(context, ByteBuffer.allocateDirect(kdf.keyBytes() - 1));
+            Assert.fail("accepted a short master key");
+        } catch (final ConstraintViolationException e) {
+            // expected
+        }
+    }
+
+    /**
+     * context returns the context "KDF test".
+     */
+    private static @NotNull ByteBuffer context() {
+        final ByteBuffer context = ByteBuffer.allocateDirect(Kdf.blake2b().contextBytes());
+        context.put("KDF test".getBytes()).flip();
+        return context;
+    }
+
+    /**
+     * key returns the master key 00 01 02 ... 1f.
+     */
+    private static @NotNull ByteBuffer key() {
+        final ByteBuffer key = ByteBuffer.allocateDirect(Kdf.blake2b().keyBytes());
+        for (int i = 0; i < key.capacity(); i++) {
+            key.put(i, (byte) i);
+        }
+        return key;
+    }
+
+    private static @NotNull ByteBuffer slice(final @NotNull ByteBuffer src,
+                                             final          int        offset,
+                                             final          int        length) {
+        final ByteBuffer view = src.duplicate();
+        view.position(src.position() + offset);
+        view.limit(src.position() + offset + length);
+        return view.slice();
+    }
+
+    private static @NotNull ByteBuffer hex(final @NotNull String hex) {
+        final ByteBuffer buffer = ByteBuffer.allocateDirect(hex.length() / 2);
+        for (int i = 0; i < buffer.capacity(); i++) {
+            buffer.put(i, (byte) Integer.parseInt(hex.substring(2 * i, 2 * i + 2), 16));
+        }
+        return buffer;
+    }
+
+    /**
+     * Subkeys of the master key 00 01 ... 1f in the context "KDF test", as
+     * derived by crypto_kdf_blake2b_derive_from_key:
+     * [0] : subkey id
+     * [1] : subkey
+     */
+    private static final @NotNull String[][] vectors = new String[][] {
+        { "0",                 "c13fcc2e6cd0cd0f82d93b163a5696c5105378f8c629d36baf3ae0239de9c280" },
+        { "1",                 "3c387fab802aae447033073e76ee002c" },
+        { "72623859790382856", "895852fb41c7ce41894bf30c1612552d9cdf631021c16fa325515044e9ccf580"
+                             + "ae5335315be4507be533d3a49a23c8d597166d6f6c993338fec6d1ea74193841" },
+    };
+}
@@ -0,0 +1,82 @@
+package eu.artemisc.stodium.secretbox;
+
+import org.junit.Assert;
+import org.junit.Test;
+
+import java.nio.ByteBuffer;
+
+import eu.artemisc.stodium.Fragments;
+import eu.artemisc.stodium.exceptions.StodiumException;
+
+/**
+ * Checks the gather/scatter calls, which run the stream (after the 32 bytes
+ * of the first block that key Poly1305) and Poly1305 over the fragments one
+ * by one, against the contiguous detached calls.
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+public class SecretBoxTest {
+
+    @Test
+    public void gather()
+            throws StodiumException {
+        for (final SecretBox box : new SecretBox[] {
+                SecretBox.xsalsa20poly1305Instance(), SecretBox.xchacha20poly1305Instance() }) {
+            final ByteBuffer key   = pattern(box.keyBytes(), 3);
+            final ByteBuffer nonce = pattern(box.nonceBytes(), 5);
+            final int        tag   = box.macBytes();
+
+            for (final int[][] group : Fragments.SPLITS) {
+                final int        length  = Fragments.length(group[0]);
+                final ByteBuffer message = pattern(length, 7);
+                final ByteBuffer body    = ByteBuffer.allocateDirect(length);
+                final ByteBuffer mac     = ByteBuffer.allocateDirect(tag);
+                box.detached(body, mac, message, nonce, key);
+
+                final ByteBuffer opened = ByteBuffer.allocateDirect(length);
+                Assert.assertTrue(box.detachedOpen(opened, body, mac, nonce, key));
+                Assert.assertEquals(message, opened);
+
+                for (final int[] srcSplit : group) {
+                    for (final int[] dstSplit : group) {
+                        final ByteBuffer[] cipher   = Fragments.blank(dstSplit);
+                        final ByteBuffer   gathered = ByteBuffer.allocateDirect(tag);
+                        box.detached(cipher, gathered, Fragments.split(message, srcSplit), nonce, key);
+                        Assert.assertEquals(body, Fragments.join(cipher));
+                        Assert.assertEquals(mac, gathered);
+
+                        final ByteBuffer[] plain = Fragments.blank(srcSplit);
+                        Assert.assertTrue(box.detachedOpen(plain, cipher, mac, nonce, key));
+                        Assert.assertEquals(message, Fragments.join(plain));
+
+                        // nothing may be written for a forged message
+                        final ByteBuffer[] forged = Fragments.blank(srcSplit);
+                        Assert.assertFalse(box.detachedOpen(forged, cipher, flipped(mac, 0), nonce, key));
+                        if (length > 0) {
+                            Assert.assertFalse(box.detachedOpen(forged,
+                                    Fragments.split(flipped(body, length - 1), dstSplit), mac, nonce, key));
+                        }
+                        Assert.assertTrue(Fragments.isBlank(forged));
+                    }
+                }
+            }
+        }
+    }
+
+    private static ByteBuffer pattern(final int length,
+                                      final int seed) {
+        final ByteBuffer buffer = ByteBuffer.allocateDirect(length);
+        for (int i = 0; i < length; i++) {
+            buffer.put(i, (byte) (i * seed + seed));
+        }
+        return buffer;
+    }
+
+    private static ByteBuffer flipped(final ByteBuffer src,
+                                      final int        index) {
+        final ByteBuffer copy = ByteBuffer.allocateDirect(src.remaining());
+        copy.duplicate().put(src.duplicate());
+        copy.put(index, (byte) (copy.get(index) ^ 1));
+        return copy;
+    }
+}
@@ -0,0 +1,62 @@
+package eu.artemisc.stodium.secretstream;
+
+import org.junit.Assert;
+import org.junit.Test;
+
+import java.io.ByteArrayInputStream;
+import java.io.ByteArrayOutputStream;
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.nio.channels.Channels;
+
+import eu.artemisc.stodium.exceptions.StodiumException;
+
+/**
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+public class SecretStreamTest {
+
+    @Test
+    public void channelRoundTrip()
+            throws IOException, StodiumException {
+        final SecretStream stream = SecretStream.instance();
+        final ByteBuffer   key    = ByteBuffer.allocateDirect(stream.keyBytes());
+        final byte[]       plain  = new byte[10000];
+        for (int i = 0; i < plain.length; i++) {
+            plain[i] = (byte) i;
+        }
+
+        final ByteArrayOutputStream out = new ByteArrayOutputStream();
+        final SecretStreamWriter writer = new SecretStreamWriter(stream, Channels.newChannel(out), key, 1024);
+        writer.write(ByteBuffer.wrap(plain, 0, 3000));
+        final ByteBuffer direct = ByteBuffer.allocateDirect(plain.length - 3000);
+        direct.put(plain, 3000, plain.length - 3000).flip();
+        writer.write(direct);
+        writer.close();
+
+        final byte[] cipher = out.toByteArray();
+        final SecretStreamReader reader = new SecretStreamReader(stream,
+                Channels.newChannel(new ByteArrayInputStream(cipher)), key.duplicate(), 1024);
+        final ByteBuffer result = ByteBuffer.allocate(plain.length);
+        while (result.hasRemaining() && reader.read(result) >= 0) {
+            // fill result
+        }
+        Assert.assertEquals(-1, reader.read(ByteBuffer.allocate(1)));
+        reader.close();
+        Assert.assertArrayEquals(plain, result.array());
+
+        // Dropping the final chunk has to be detected
+        final byte[] truncated = new byte[cipher.length - 4 - stream.abytes() - plain.length % 1024];
+        System.arraycopy(cipher, 0, truncated, 0, truncated.length);
+        final SecretStreamReader truncatedReader = new SecretStreamReader(stream,
+                Channels.newChannel(new ByteArrayInputStream(truncated)), key.duplicate(), 1024);
+        try {
+            while (truncatedReader.read(ByteBuffer.allocate(4096)) >= 0) {
+                // drain
+            }
+            Assert.fail("expected truncation to be detected");
+        } catch (IOException e) {
+            // expected
+        }
+    }
+}
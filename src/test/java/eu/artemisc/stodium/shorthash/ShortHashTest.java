@@ -0,0 +1,192 @@
+package eu.artemisc.stodium.shorthash;
+
+import org.jetbrains.annotations.NotNull;
+import org.junit.Assert;
+import org.junit.Test;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.LongBuffer;
+
+import eu.artemisc.stodium.codecs.Codec;
+import eu.artemisc.stodium.exceptions.StodiumException;
+
+/**
+ * Checks that hashBatch, which runs its own SipHash rounds in the vector
+ * lanes, matches libsodium. The batch sizes are no multiple of any lane width
+ * (4 with AVX2, 2 with SSE2 or NEON).
+ *
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+public class ShortHashTest {
+
+    @Test
+    public void tv()
+            throws StodiumException {
+        final ByteBuffer key = ByteBuffer.allocateDirect(16);
+        final ByteBuffer src = ByteBuffer.allocateDirect(64);
+        for (int i = 0; i < 64; i++) {
+            src.put(i, (byte) i);
+            if (i < 16) {
+                key.put(i, (byte) i);
+            }
+        }
+
+        // all vectors in one batch: mixed lengths, including the empty message
+        final int[] table = new int[2 * lengths.length];
+        for (int i = 0; i < lengths.length; i++) {
+            table[2 * i + 1] = lengths[i];
+        }
+
+        checkVectors(ShortHash.siphash24Instance(), 0, src, table, key);
+        checkVectors(ShortHash.siphashx24Instance(), 1, src, table, key);
+    }
+
+    @Test
+    public void equalLength()
+            throws StodiumException {
+        final ByteBuffer key = pattern(16, 3);
+        final ByteBuffer src = pattern(1024, 11);
+        final int[] sizes = { 0, 1, 7, 8, 15, 16, 24, 63 };
+
+        for (final ShortHash hash : new ShortHash[] {
+                ShortHash.siphash24Instance(), ShortHash.siphashx24Instance() }) {
+            for (final int size : sizes) {
+                for (int count = 1; count <= 9; count++) {
+                    final int[] table = new int[2 * count];
+                    for (int i = 0; i < count; i++) {
+                        table[2 * i]     = 97 * i;
+                        table[2 * i + 1] = size;
+                    }
+                    checkBatch(hash, src, table, key);
+                }
+            }
+        }
+    }
+
+    @Test
+    public void mixedLength()
+            throws StodiumException {
+        final ByteBuffer key = pattern(16, 5);
+        final ByteBuffer src = pattern(1024, 13);
+
+        for (final ShortHash hash : new ShortHash[] {
+                ShortHash.siphash24Instance(), ShortHash.siphashx24Instance() }) {
+            for (int count = 1; count <= 11; count++) {
+                final int[] table = new int[2 * count];
+                for (int i = 0; i < count; i++) {
+                    table[2 * i]     = 61 * i;
+                    table[2 * i + 1] = (i * 37 + count) % 70;
+                }
+                // an empty message between the others
+                table[2 * (count / 2) + 1] = 0;
+                checkBatch(hash, src, table, key);
+            }
+        }
+    }
+
+    /**
+     * checkVectors compares the hashes of the vectors in the given column
+     * with both hash() and hashBatch().
+     */
+    private static void checkVectors(final @NotNull ShortHash  hash,
+                                     final          int        column,
+                                     final @NotNull ByteBuffer src,
+                                     final @NotNull int[]      table,
+                                     final @NotNull ByteBuffer key)
+            throws StodiumException {
+        final int    words    = hash.bytes() / 8;
+        final long[] expected = new long[lengths.length * words];
+        for (int i = 0; i < lengths.length; i++) {
+            final ByteBuffer bytes = ByteBuffer.allocate(hash.bytes()).order(ByteOrder.LITTLE_ENDIAN);
+            Codec.hex().decode(bytes, vectors[i][column]);
+            for (int w = 0; w < words; w++) {
+                expected[i * words + w] = bytes.getLong(8 * w);
+            }
+        }
+
+        Assert.assertArrayEquals(expected, reference(hash, src, table, key));
+        checkBatch(hash, src, table, key);
+
+        final long[] offset = new long[expected.length + 3];
+        hash.hashBatch(offset, 3, src, table, key);
+        for (int i = 0; i < expected.length; i++) {
+            Assert.assertEquals(expected[i], offset[i + 3]);
+        }
+    }
+
+    /**
+     * checkBatch compares hashBatch(), into an array and into a direct
+     * LongBuffer, with hash() on every message.
+     */
+    private static void checkBatch(final @NotNull ShortHash  hash,
+                                   final @NotNull ByteBuffer src,
+                                   final @NotNull int[]      table,
+                                   final @NotNull ByteBuffer key)
+            throws StodiumException {
+        final long[] expected = reference(hash, src, table, key);
+
+        final long[] batch = new long[expected.length];
+        hash.hashBatch(batch, 0, src, table, key);
+        Assert.assertArrayEquals(expected, batch);
+
+        final LongBuffer direct = ByteBuffer.allocateDirect(8 * expected.length)
+                .order(ByteOrder.nativeOrder()).asLongBuffer();
+        hash.hashBatch(direct, src, table, key);
+        final long[] copied = new long[expected.length];
+        direct.get(copied);
+        Assert.assertArrayEquals(expected, copied);
+    }
+
+    private static long[] reference(final @NotNull ShortHash  hash,
+                                    final @NotNull ByteBuffer src,
+                                    final @NotNull int[]      table,
+                                    final @NotNull ByteBuffer key)
+            throws StodiumException {
+        final int        words  = hash.bytes() / 8;
+        final long[]     hashes = new long[(table.length / 2) * words];
+        final ByteBuffer out    = ByteBuffer.allocate(hash.bytes()).order(ByteOrder.LITTLE_ENDIAN);
+
+        for (int i = 0; i < table.length; i += 2) {
+            final ByteBuffer in = src.duplicate();
+            in.position(src.position() + table[i]);
+            in.limit(in.position() + table[i + 1]);
+            hash.hash(out, in, key);
+            for (int w = 0; w < words; w++) {
+                hashes[(i / 2) * words + w] = out.getLong(8 * w);
+            }
+        }
+        return hashes;
+    }
+
+    private static ByteBuffer pattern(final int length,
+                                      final int seed) {
+        final ByteBuffer buffer = ByteBuffer.allocateDirect(length);
+        for (int i = 0; i < length; i++) {
+            buffer.put(i, (byte) (i * seed + (i >> 8)));
+        }
+        return buffer;
+    }
+
+    /**
+     * The lengths of the vectors: SipHash-2-4 and SipHash-x-2-4 of the bytes
+     * 0, 1, ..., length - 1 under the key 00 01 ... 0f, as in the SipHash
+     * paper and the libsodium tests.
+     */
+    private static final @NotNull int[] lengths = new int[] {
+            0, 1, 7, 8, 9, 15, 16, 17, 31, 63
+    };
+
+    private static final @NotNull String[][] vectors = new String[][] {
+            { "310e0edd47db6f72", "a3817f04ba25a8e66df67214c7550293" },
+            { "fd67dc93c539f874", "da87c1d86b99af44347659119b22fc45" },
+            { "37d1018bf50002ab", "a1f1ebbed8dbc153c0b84aa61ff08239" },
+            { "6224939a79f5f593", "3b62a9ba6258f5610f83e264f31497b4" },
+            { "b0e4a90bdf82009e", "264499060ad9baabc47f8b02bb6d71ed" },
+            { "e545be4961ca29a1", "5493e99933b0a8117e08ec0f97cfc3d9" },
+            { "db9bc2577fcc2a3f", "6ee2a4ca67b054bbfd3315bf85230577" },
+            { "9447be2cf5e99a69", "473d06e8738db89854c066c47ae47740" },
+            { "42c341d8fa92d832", "2939b0183223fafc1723de4f52c43d35" },
+            { "724506eb4c328a95", "5150d1772f50834a503e069a973fbd7c" },
+    };
+}
@@ -0,0 +1,160 @@
+package eu.artemisc.stodium.sign;
+
+import org.jetbrains.annotations.NotNull;
+import org.junit.Assert;
+import org.junit.Test;
+
+import java.nio.ByteBuffer;
+
+import eu.artemisc.stodium.exceptions.ConstraintViolationException;
+import eu.artemisc.stodium.exceptions.StodiumException;
+
+/**
+ * @author Jan van de Molengraft [jan@artemisc.eu]
+ */
+public class Ed25519Test {
+
+    private static final int COUNT = 37;
+
+    /**
+     * The batch accepts the signatures of RFC 8032, section 7.1, tests 1 and
+     * 2, and rejects them under the other key.
+     */
+    @Test
+    public void batchTv()
+            throws StodiumException {
+        final Sign sign = Sign.ed25519Instance();
+        final ByteBuffer sigs = ByteBuffer.allocateDirect(4 * sign.BYTES);
+        sigs.put(hex(vectors[0][2])).put(hex(vectors[1][2])).put(hex(vectors[0][2])).put(hex(vectors[1][2]));
+        sigs.flip();
+        final ByteBuffer pubs = ByteBuffer.allocateDirect(2 * sign.PUBLICKEYBYTES);
+        pubs.put(hex(vectors[0][1])).put(hex(vectors[1][1]));
+        pubs.flip();
+
+        final ByteBuffer msgs    = hex(vectors[1][3]);
+        final int[]      table   = { 0, 0, 0, 1, 0, 0, 0, 1 };
+        final int[]      keys    = { 0, 1, 1, 0 };
+        final byte[]     results = new byte[1];
+        Assert.assertEquals(2, sign.verifyDetachedBatch(sigs, msgs, table, pubs, keys, results));
+        Assert.assertTrue(Sign.isVerified(results, 0));
+        Assert.assertTrue(Sign.isVerified(results, 1));
+        Assert.assertFalse(Sign.isVerified(results, 2));
+        Assert.assertFalse(Sign.isVerified(results, 3));
+    }
+
+    /**
+     * The batch agrees with verifyDetached for messages signed by three keys,
+     * with a few signatures and messages forged.
+     */
+    @Test
+    public void batch()
+            throws StodiumException {
+        final Sign sign = Sign.ed25519Instance();
+        final ByteBuffer   pubs  = ByteBuffer.allocateDirect(3 * sign.PUBLICKEYBYTES);
+        final ByteBuffer[] privs = new ByteBuffer[3];
+        for (int k = 0; k < privs.length; k++) {
+            privs[k] = ByteBuffer.allocateDirect(sign.SECRETKEYBYTES);
+            sign.keypair(slice(pubs, k * sign.PUBLICKEYBYTES, sign.PUBLICKEYBYTES), privs[k],
+                    pattern(sign.SEEDBYTES, 3 + k));
+        }
+
+        // messages of 0 to 72 bytes, back to back in one buffer
+        final int[] table = new int[2 * COUNT];
+        final int[] keys  = new int[COUNT];
+        int length = 0;
+        for (int i = 0; i < COUNT; i++) {
+            table[2 * i]     = length;
+            table[2 * i + 1] = 2 * i;
+            keys[i]          = i % 3;
+            length += 2 * i;
+        }
+        final ByteBuffer msgs = pattern(length, 7);
+        final ByteBuffer sigs = ByteBuffer.allocateDirect(COUNT * sign.BYTES);
+        for (int i = 0; i < COUNT; i++) {
+            sign.signDetached(slice(sigs, i * sign.BYTES, sign.BYTES),
+                    slice(msgs, table[2 * i], table[2 * i + 1]), privs[keys[i]]);
+        }
+
+        // forge a signature, a message after signing, and use the wrong key
+        sigs.put(5 * sign.BYTES, (byte) (sigs.get(5 * sign.BYTES) ^ 1));
+        msgs.put(table[2 * 20], (byte) (msgs.get(table[2 * 20]) ^ 1));
+        keys[COUNT - 1] = (keys[COUNT - 1] + 1) % 3;
+
+        final byte[] results = new byte[(COUNT + 7) / 8];
+        int failed = 0;
+        for (int i = 0; i < COUNT; i++) {
+            if (!sign.verifyDetached(slice(sigs, i * sign.BYTES, sign.BYTES),
+                    slice(msgs, table[2 * i], table[2 * i + 1]),
+                    slice(pubs, keys[i] * sign.PUBLICKEYBYTES, sign.PUBLICKEYBYTES))) {
+                failed++;
+            }
+        }
+        Assert.assertEquals(3, failed);
+        Assert.assertEquals(failed, sign.verifyDetachedBatch(sigs, msgs, table, pubs, keys, results));
+        for (int i = 0; i < COUNT; i++) {
+            Assert.assertEquals("message " + i, i != 5 && i != 20 && i != COUNT - 1,
+                    Sign.isVerified(results, i));
+        }
+    }
+
+    @Test
+    public void batchKeyIndex()
+            throws StodiumException {
+        final Sign sign = Sign.ed25519Instance();
+        try {
+            sign.verifyDetachedBatch(ByteBuffer.allocateDirect(sign.BYTES), pattern(4, 1), new int[] { 0, 4 },
+                    ByteBuffer.allocateDirect(sign.PUBLICKEYBYTES), new int[] { 1 }, new byte[1]);
+            Assert.fail("accepted key index 1 of 1 key");
+        } catch (final ConstraintViolationException e) {
+            // expected
+        }
+    }
+
+    private static @NotNull ByteBuffer pattern(final int length,
+                                               final int seed) {
+        final ByteBuffer buffer = ByteBuffer.allocateDirect(length);
+        for (int i = 0; i < length; i++) {
+            buffer.put(i, (byte) (i * seed + seed));
+        }
+        return buffer;
+    }
+
+    private static @NotNull ByteBuffer slice(final @NotNull ByteBuffer src,
+                                             final          int        offset,
+                                             final          int        length) {
+        final ByteBuffer view = src.duplicate();
+        view.position(src.position() + offset);
+        view.limit(src.position() + offset + length);
+        return view.slice();
+    }
+
+    private static @NotNull ByteBuffer hex(final @NotNull String hex) {
+        final ByteBuffer buffer = ByteBuffer.allocateDirect(hex.length() / 2);
+        for (int i = 0; i < buffer.capacity(); i++) {
+            buffer.put(i, (byte) Integer.parseInt(hex.substring(2 * i, 2 * i + 2), 16));
+        }
+        return buffer;
+    }
+
+    /**
+     * RFC 8032, section 7.1, tests 1 and 2:
+     * [0] : secret key (seed)
+     * [1] : public key
+     * [2] : signature
+     * [3] : message
+     */
+    private static final @NotNull String[][] vectors = new String[][] {
+        {
+            "9d61b19deffd5a60ba844af492ec2cc44449c5697b326919703bac031cae7f60",
+            "d75a980182b10ab7d54bfed3c964073a0ee172f3daa62325af021a68f707511a",
+            "e5564300c360ac729086e2cc806e828a84877f1eb8e5d974d873e065224901555fb8821590a33bacc61e39701cf9b46bd25bf5f0595bbe24655141438e7a100b",
+            "",
+        },
+        {
+            "4ccd089b28ff96da9db6c346ec114e0f5b8a319f35aba624da8cf6ed4fb8a6fb",
+            "3d4017c3e843895a92b70aa74d1b7ebc9c982ccf2ec4968cc0cd55f12af4660c",
+            "92a009a9f0d4cab8720e820b5f642540a2b27b5416503f8fb3762223ebdb69da085ac1e43e15996e458f3613d0f11d8c387b2eaeb4302aeeb00d291612bb0c00",
+            "72",
+        },
+    };
+}